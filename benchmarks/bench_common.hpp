@@ -0,0 +1,72 @@
+#pragma once
+
+// Shared helpers for the Lucid benchmark suite.
+
+#include <lucid/backend/bytecode.hpp>
+#include <lucid/backend/compiler.hpp>
+#include <lucid/backend/constant_folder.hpp>
+#include <lucid/backend/inliner.hpp>
+#include <lucid/frontend/lexer.hpp>
+#include <lucid/frontend/parser.hpp>
+#include <lucid/semantic/type_checker.hpp>
+#include <fmt/format.h>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+
+namespace lucid::bench {
+
+// Run the full front end and code generator over a Lucid program, with
+// lucidc -O's inlining and the constant folding after it if asked.
+inline auto compile_source(const std::string& source, bool inline_calls = false)
+    -> backend::Bytecode {
+    Lexer lexer(source, "bench");
+    Parser parser(lexer);
+    auto parse_result = parser.parse();
+    if (!parse_result.is_ok()) {
+        throw std::runtime_error("benchmark program failed to parse");
+    }
+
+    semantic::TypeChecker checker;
+    auto type_result = checker.check_program(*parse_result.program.value());
+    if (!type_result.errors.empty()) {
+        throw std::runtime_error("benchmark program failed to type check: " +
+                                 type_result.errors.front().message);
+    }
+
+    if (inline_calls) {
+        backend::inline_functions(*parse_result.program.value());
+        backend::fold_constants(*parse_result.program.value());
+    }
+    backend::Compiler compiler;
+    return compiler.compile(parse_result.program.value().get());
+}
+
+// A well-typed program of `functions` functions in the shape generated
+// code takes: each has lets, a tuple pattern, list callbacks, string
+// methods and an if, and calls the one before it.
+inline auto generated_program(size_t functions) -> std::string {
+    std::string source;
+    for (size_t i = 0; i < functions; ++i) {
+        const std::string next = i == 0
+            ? std::string("weight")
+            : fmt::format("step_{}(xs.tail(), label, scale * 0.5)", i - 1);
+        source += fmt::format(R"(
+# Generated step {0}
+function step_{0}(xs: List[Int], label: String, scale: Float) returns Int {{
+    let (first, count) = (xs.head(), xs.length())
+    let kept = xs.map(lambda x: x * 2 + first).filter(lambda x: x % 3 != 0)
+    let name = label.trim().to_upper()
+    let weight = if scale > 1.5 and count > {0} {{ 3 }} else {{ count - 1 }}
+    return if name.is_empty() {{
+        weight
+    }} else {{
+        kept.fold(weight, lambda acc, x: acc + x) + {1}
+    }}
+}}
+)", i, next);
+    }
+    return source;
+}
+
+} // namespace lucid::bench
@@ -0,0 +1,87 @@
+// Embedding benchmarks: many small calls into one loaded program.
+//
+// A host evaluating rules calls the same tiny function with different
+// inputs. BM_Rule_CallFunction pays a name lookup and an argument vector
+// per call; BM_Rule_CallBatch resolves the function once and runs the whole
+// batch on one stack. BM_Rule_PoolBatch spreads the batch over a ThreadPool
+// and VMPool; its "calls" rate should grow with the thread count.
+
+#include "bench_common.hpp"
+
+#include <lucid/backend/thread_pool.hpp>
+#include <lucid/backend/vm.hpp>
+#include <lucid/backend/vm_pool.hpp>
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <vector>
+
+using namespace lucid;
+using namespace lucid::backend;
+
+namespace {
+
+constexpr const char* kRule = R"(
+    function rule(amount: Int, limit: Int) returns Bool {
+        return amount > 0 and amount * 3 < limit
+    }
+)";
+
+constexpr size_t kBatch = 4096;
+
+auto batch_args() -> std::vector<Value> {
+    std::vector<Value> args;
+    args.reserve(kBatch * 2);
+    for (size_t i = 0; i < kBatch; ++i) {
+        args.emplace_back(static_cast<int64_t>(i % 97));
+        args.emplace_back(int64_t{200});
+    }
+    return args;
+}
+
+auto count_calls(benchmark::State& state) -> void {
+    state.counters["calls"] = benchmark::Counter(
+        static_cast<double>(state.iterations()) * static_cast<double>(kBatch), benchmark::Counter::kIsRate);
+}
+
+} // namespace
+
+static void BM_Rule_CallFunction(benchmark::State& state) {
+    auto bytecode = bench::compile_source(kRule);
+    auto args = batch_args();
+    VM vm;
+    for (auto _ : state) {
+        for (size_t i = 0; i < kBatch; ++i) {
+            auto result = vm.call_function(bytecode, "rule", {args[2 * i], args[2 * i + 1]});
+            benchmark::DoNotOptimize(result);
+        }
+    }
+    count_calls(state);
+}
+BENCHMARK(BM_Rule_CallFunction);
+
+static void BM_Rule_CallBatch(benchmark::State& state) {
+    VM vm;
+    vm.load(std::make_shared<const Bytecode>(bench::compile_source(kRule)));
+    auto rule = vm.function("rule");
+    auto args = batch_args();
+    for (auto _ : state) {
+        auto results = vm.call_batch(rule, args);
+        benchmark::DoNotOptimize(results);
+    }
+    count_calls(state);
+}
+BENCHMARK(BM_Rule_CallBatch);
+
+static void BM_Rule_PoolBatch(benchmark::State& state) {
+    const auto threads = static_cast<size_t>(state.range(0));
+    VMPool pool(std::make_shared<const Bytecode>(bench::compile_source(kRule)), threads);
+    ThreadPool workers(threads);
+    auto rule = pool.function("rule");
+    auto args = batch_args();
+    for (auto _ : state) {
+        auto results = pool.call_batch(rule, args, workers);
+        benchmark::DoNotOptimize(results);
+    }
+    count_calls(state);
+}
+BENCHMARK(BM_Rule_PoolBatch)->Arg(1)->Arg(2)->Arg(4)->UseRealTime();
@@ -0,0 +1,96 @@
+// End-to-end runs of examples/*.lucid: lex, parse, type check, compile and
+// run main(), as `lucidc file.lucid` does.
+//
+// The examples are small, so each is scaled up by concatenating renamed
+// copies of it (every function gets a _<copy> suffix) under a main() that
+// calls every copy's main. The argument is the number of copies; the
+// "items" rate counts copies run. Examples that do not compile or run are
+// listed with their error.
+
+#include "bench_common.hpp"
+
+#include <lucid/backend/vm.hpp>
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <regex>
+#include <sstream>
+#include <vector>
+
+using namespace lucid;
+using namespace lucid::backend;
+
+namespace {
+
+auto scale_example(const std::string& source, int copies) -> std::string {
+    static const std::regex declaration(R"(function\s+(\w+)\s*\()");
+    std::vector<std::string> names;
+    for (auto it = std::sregex_iterator(source.begin(), source.end(), declaration);
+         it != std::sregex_iterator(); ++it) {
+        names.push_back((*it)[1]);
+    }
+
+    std::string scaled;
+    std::string calls;
+    for (int copy = 0; copy < copies; ++copy) {
+        std::string text = source;
+        for (const auto& name : names) {
+            text = std::regex_replace(text, std::regex("\\b" + name + "\\("),
+                                      fmt::format("{}_{}(", name, copy));
+        }
+        scaled += text;
+        calls += fmt::format("main_{}() + ", copy);
+    }
+    return scaled + fmt::format("\nfunction main() returns Int {{\n    return {}0\n}}\n", calls);
+}
+
+auto run_example(benchmark::State& state, const std::string& source) -> void {
+    const auto scaled = scale_example(source, static_cast<int>(state.range(0)));
+    VM vm;
+    vm.use_output_buffer();
+    try {
+        // Examples the current compiler rejects are reported, not timed
+        vm.call_function(bench::compile_source(scaled), "main", {});
+    } catch (const std::exception& e) {
+        state.SkipWithError(e.what());
+        return;
+    }
+    for (auto _ : state) {
+        auto bytecode = bench::compile_source(scaled);
+        auto result = vm.call_function(bytecode, "main", {});
+        benchmark::DoNotOptimize(result);
+        vm.clear_output();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(scaled.size()));
+}
+
+auto register_examples() -> bool {
+    std::error_code ec;
+    std::vector<std::filesystem::path> files;
+    for (const auto& entry : std::filesystem::directory_iterator(LUCID_EXAMPLES_DIR, ec)) {
+        if (entry.path().extension() == ".lucid") {
+            files.push_back(entry.path());
+        }
+    }
+    std::sort(files.begin(), files.end());
+
+    for (const auto& file : files) {
+        std::ifstream in(file);
+        std::stringstream buffer;
+        buffer << in.rdbuf();
+        benchmark::RegisterBenchmark(("BM_Example/" + file.stem().string()).c_str(),
+                                     [source = buffer.str()](benchmark::State& state) {
+                                         run_example(state, source);
+                                     })
+            ->Arg(1)
+            ->Arg(64)
+            ->Unit(benchmark::kMicrosecond);
+    }
+    return true;
+}
+
+const bool kExamplesRegistered = register_examples();
+
+} // namespace
@@ -0,0 +1,126 @@
+// Front end and code generator throughput over generated programs.
+//
+// Each phase is timed on its own: BM_Parse lexes and parses, BM_TypeCheck
+// checks an already parsed program, BM_Compile generates bytecode for an
+// already checked one. Rates are source bytes/s and functions/s, for
+// programs of 100 and 2000 functions (see bench::generated_program).
+// BM_ServerEdit times a compile server round after a one-character edit in
+// the middle function. One function is parsed, checked and compiled; what
+// still grows with the program is escape analysis and linking.
+// BM_ManyLocals checks and compiles one function binding hundreds of
+// locals, each read by the next; items are locals.
+
+#include "bench_common.hpp"
+
+#include <lucid/backend/compile_server.hpp>
+
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <memory>
+
+using namespace lucid;
+
+namespace {
+
+auto parse_source(const std::string& source) -> std::unique_ptr<ast::Program> {
+    Lexer lexer(source, "bench");
+    Parser parser(lexer);
+    auto parse_result = parser.parse();
+    if (!parse_result.is_ok()) {
+        throw std::runtime_error("benchmark program failed to parse");
+    }
+    return std::move(parse_result.program.value());
+}
+
+// One function binding `locals` names, each read by the next
+auto many_locals(size_t locals) -> std::string {
+    std::string source = "function main() returns Int {\n    let v0 = 1\n";
+    for (size_t i = 1; i < locals; ++i) {
+        source += fmt::format("    let v{} = v{} + v{} * 2\n", i, i - 1, i / 2);
+    }
+    source += fmt::format("    return v{}\n}}\n", locals - 1);
+    return source;
+}
+
+auto set_rates(benchmark::State& state, const std::string& source) -> void {
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(source.size()));
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+} // namespace
+
+static void BM_Parse(benchmark::State& state) {
+    const auto source = bench::generated_program(static_cast<size_t>(state.range(0)));
+    for (auto _ : state) {
+        auto program = parse_source(source);
+        benchmark::DoNotOptimize(program);
+    }
+    set_rates(state, source);
+}
+BENCHMARK(BM_Parse)->Arg(100)->Arg(2000)->Unit(benchmark::kMillisecond);
+
+static void BM_TypeCheck(benchmark::State& state) {
+    const auto source = bench::generated_program(static_cast<size_t>(state.range(0)));
+    auto program = parse_source(source);
+    for (auto _ : state) {
+        semantic::TypeChecker checker;
+        auto result = checker.check_program(*program);
+        if (result.has_errors()) {
+            state.SkipWithError(result.errors.front().message.c_str());
+            return;
+        }
+    }
+    set_rates(state, source);
+}
+BENCHMARK(BM_TypeCheck)->Arg(100)->Arg(2000)->Unit(benchmark::kMillisecond);
+
+static void BM_Compile(benchmark::State& state) {
+    const auto source = bench::generated_program(static_cast<size_t>(state.range(0)));
+    auto program = parse_source(source);
+    semantic::TypeChecker checker;
+    if (checker.check_program(*program).has_errors()) {
+        state.SkipWithError("benchmark program failed to type check");
+        return;
+    }
+    for (auto _ : state) {
+        backend::Compiler compiler;
+        auto bytecode = compiler.compile(program.get());
+        benchmark::DoNotOptimize(bytecode);
+    }
+    set_rates(state, source);
+}
+BENCHMARK(BM_Compile)->Arg(100)->Arg(2000)->Unit(benchmark::kMillisecond);
+
+static void BM_ServerEdit(benchmark::State& state) {
+    const auto functions = static_cast<size_t>(state.range(0));
+    auto source = bench::generated_program(functions);
+    backend::CompileServer server("bench");
+    if (!server.update(source).bytecode) {
+        state.SkipWithError("benchmark program failed to compile");
+        return;
+    }
+
+    const size_t edit = source.find("1.5", source.find(fmt::format("function step_{}(", functions / 2)));
+    for (auto _ : state) {
+        source[edit] = source[edit] == '1' ? '2' : '1';
+        auto update = server.update(source);
+        benchmark::DoNotOptimize(update);
+    }
+}
+BENCHMARK(BM_ServerEdit)->Arg(100)->Arg(2000)->Unit(benchmark::kMillisecond);
+
+static void BM_ManyLocals(benchmark::State& state) {
+    auto program = parse_source(many_locals(static_cast<size_t>(state.range(0))));
+    for (auto _ : state) {
+        semantic::TypeChecker checker;
+        if (checker.check_program(*program).has_errors()) {
+            state.SkipWithError("benchmark program failed to type check");
+            return;
+        }
+        backend::Compiler compiler;
+        auto bytecode = compiler.compile(program.get());
+        benchmark::DoNotOptimize(bytecode);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ManyLocals)->Arg(100)->Arg(1000);
@@ -0,0 +1,140 @@
+// JIT benchmarks.
+//
+// Each numeric kernel runs once interpreted (threaded dispatch, peephole
+// optimised as with lucidc -O) and once with the JIT compiling every
+// function on its second call. The _Jit runs are skipped in builds without
+// the JIT (-DLUCID_JIT=OFF or a non-x86-64 target).
+
+#include "bench_common.hpp"
+
+#include <lucid/backend/optimizer.hpp>
+#include <lucid/backend/vm.hpp>
+#include <benchmark/benchmark.h>
+
+using namespace lucid;
+using namespace lucid::backend;
+
+namespace {
+
+constexpr const char* kFibonacci = R"(
+    function fib(n: Int) returns Int {
+        return if n <= 1 { n } else { fib(n - 1) + fib(n - 2) }
+    }
+
+    function main() returns Int {
+        return fib(25)
+    }
+)";
+
+// Integer division, modulo and branches, tail-recursive
+constexpr const char* kCollatz = R"(
+    function steps(n: Int, count: Int) returns Int {
+        return if n == 1 { count } else {
+            if n % 2 == 0 { steps(n / 2, count + 1) } else { steps(3 * n + 1, count + 1) }
+        }
+    }
+
+    function longest(n: Int, best: Int) returns Int {
+        return if n == 0 { best } else {
+            let s = steps(n, 0)
+            longest(n - 1, if s > best { s } else { best })
+        }
+    }
+
+    function main() returns Int {
+        return longest(3000, 0)
+    }
+)";
+
+// Float arithmetic in a self tail-call loop
+constexpr const char* kHarmonic = R"(
+    function harmonic(n: Int, acc: Float) returns Float {
+        return if n == 0 { acc } else { harmonic(n - 1, acc + 1.0 / (acc + 1.0)) }
+    }
+
+    function main() returns Float {
+        return harmonic(200000, 0.0)
+    }
+)";
+
+// Mixed Int/Float calls into a small Float function
+constexpr const char* kNewton = R"(
+    function sqrt(x: Float, guess: Float, steps: Int) returns Float {
+        return if steps == 0 { guess } else { sqrt(x, (guess + x / guess) / 2.0, steps - 1) }
+    }
+
+    function total(n: Int, acc: Float) returns Float {
+        return if n == 0 { acc } else { total(n - 1, acc + sqrt(n * 1.0, 1.0, 20)) }
+    }
+
+    function main() returns Float {
+        return total(5000, 0.0)
+    }
+)";
+
+auto run_kernel(benchmark::State& state, const char* source, bool jit) -> void {
+    if (jit && !VM::jit_available()) {
+        state.SkipWithError("JIT not available in this build");
+        return;
+    }
+
+    auto bytecode = bench::compile_source(source);
+    optimize(bytecode);
+    VM vm;
+    if (jit) {
+        vm.set_jit_threshold(2);
+    }
+
+    for (auto _ : state) {
+        auto result = vm.call_function(bytecode, "main", {});
+        benchmark::DoNotOptimize(result);
+    }
+
+    if (jit) {
+        state.counters["native_calls"] = benchmark::Counter(
+            static_cast<double>(vm.jit_stats().native_calls), benchmark::Counter::kAvgIterations);
+        state.counters["deopts"] = benchmark::Counter(static_cast<double>(vm.jit_stats().deopts));
+    }
+}
+
+} // namespace
+
+static void BM_JitFibonacci_Interpreted(benchmark::State& state) {
+    run_kernel(state, kFibonacci, false);
+}
+BENCHMARK(BM_JitFibonacci_Interpreted)->Unit(benchmark::kMillisecond);
+
+static void BM_JitFibonacci_Jit(benchmark::State& state) {
+    run_kernel(state, kFibonacci, true);
+}
+BENCHMARK(BM_JitFibonacci_Jit)->Unit(benchmark::kMillisecond);
+
+static void BM_JitCollatz_Interpreted(benchmark::State& state) {
+    run_kernel(state, kCollatz, false);
+}
+BENCHMARK(BM_JitCollatz_Interpreted)->Unit(benchmark::kMillisecond);
+
+static void BM_JitCollatz_Jit(benchmark::State& state) {
+    run_kernel(state, kCollatz, true);
+}
+BENCHMARK(BM_JitCollatz_Jit)->Unit(benchmark::kMillisecond);
+
+static void BM_JitHarmonic_Interpreted(benchmark::State& state) {
+    run_kernel(state, kHarmonic, false);
+}
+BENCHMARK(BM_JitHarmonic_Interpreted)->Unit(benchmark::kMillisecond);
+
+static void BM_JitHarmonic_Jit(benchmark::State& state) {
+    run_kernel(state, kHarmonic, true);
+}
+BENCHMARK(BM_JitHarmonic_Jit)->Unit(benchmark::kMillisecond);
+
+static void BM_JitNewton_Interpreted(benchmark::State& state) {
+    run_kernel(state, kNewton, false);
+}
+BENCHMARK(BM_JitNewton_Interpreted)->Unit(benchmark::kMillisecond);
+
+static void BM_JitNewton_Jit(benchmark::State& state) {
+    run_kernel(state, kNewton, true);
+}
+BENCHMARK(BM_JitNewton_Jit)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,98 @@
+// Lexer benchmarks, reported as source throughput (bytes/s).
+//
+// Sources are generated from templates the way our larger programs are:
+// BM_LexGenerated mixes everything, the others stress one scanning path
+// each (identifiers and keywords, comments and indentation, string bodies).
+
+#include <lucid/frontend/lexer.hpp>
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <string>
+
+using namespace lucid;
+
+namespace {
+
+constexpr int kCopies = 2000;
+
+auto repeat(const std::string& text, int copies) -> std::string {
+    std::string source;
+    source.reserve(text.size() * static_cast<size_t>(copies));
+    for (int i = 0; i < copies; ++i) {
+        source += text;
+    }
+    return source;
+}
+
+auto generated_source() -> std::string {
+    return repeat(R"(
+# Generated accessor for one record field
+function record_field_accessor(records: List[(Int, String)], index: Int) returns String {
+    let (identifier, description) = records[index]
+    let trimmed_description = description.trim().to_lower()
+    return if identifier > 0 and not trimmed_description.is_empty() {
+        trimmed_description
+    } else {
+        "missing description for record"
+    }
+}
+
+function scaled_total(values: List[Float], factor: Float) returns Float {
+    #[ Multiplies the first value; the template emits one of these
+       per numeric column ]#
+    return values.head() * factor + 1_000.25 - values.length() * 2.0e-3
+}
+)", kCopies);
+}
+
+auto identifier_source() -> std::string {
+    return repeat("let customer_account_balance = previous_account_balance + "
+                  "pending_transaction_amount * exchange_rate_multiplier\n"
+                  "return if is_valid and not is_suspended or has_override { true } else { false }\n",
+                  kCopies * 4);
+}
+
+auto comment_source() -> std::string {
+    return repeat("        # Validation step generated from the schema; see the field list above\n"
+                  "        #[ Long block comment describing the generated code\n"
+                  "           spanning more than one line of the template ]#\n"
+                  "                        x\n",
+                  kCopies * 4);
+}
+
+auto string_source() -> std::string {
+    return repeat("println(\"Generated report line with a fairly long message body, "
+                  "value \\\"quoted\\\" and a tab\\t in it\")\n",
+                  kCopies * 4);
+}
+
+auto lex(benchmark::State& state, const std::string& source) -> void {
+    for (auto _ : state) {
+        Lexer lexer(source, "bench");
+        auto tokens = lexer.tokenize();
+        benchmark::DoNotOptimize(tokens);
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(source.size()));
+}
+
+} // namespace
+
+static void BM_LexGenerated(benchmark::State& state) {
+    lex(state, generated_source());
+}
+BENCHMARK(BM_LexGenerated)->Unit(benchmark::kMillisecond);
+
+static void BM_LexIdentifiers(benchmark::State& state) {
+    lex(state, identifier_source());
+}
+BENCHMARK(BM_LexIdentifiers)->Unit(benchmark::kMillisecond);
+
+static void BM_LexComments(benchmark::State& state) {
+    lex(state, comment_source());
+}
+BENCHMARK(BM_LexComments)->Unit(benchmark::kMillisecond);
+
+static void BM_LexStrings(benchmark::State& state) {
+    lex(state, string_source());
+}
+BENCHMARK(BM_LexStrings)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,116 @@
+// List benchmarks over 1e5-1e6 elements.
+//
+// These drive the persistent vector through the same Value API the VM uses
+// for List.append, indexing and head/tail recursion. BM_CopyingTailWalk
+// reproduces the old copy-the-rest List.tail on a std::vector for scale.
+
+#include <lucid/backend/persistent_vector.hpp>
+#include <lucid/backend/value.hpp>
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <vector>
+
+using namespace lucid::backend;
+
+namespace {
+
+auto make_list(int64_t n) -> Value {
+    Value list{PersistentVector{}};
+    for (int64_t i = 0; i < n; ++i) {
+        list.as_list_mut().push_back(Value(i));
+    }
+    return list;
+}
+
+} // namespace
+
+static void BM_ListAppend(benchmark::State& state) {
+    for (auto _ : state) {
+        auto list = make_list(state.range(0));
+        benchmark::DoNotOptimize(list);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ListAppend)->RangeMultiplier(10)->Range(100'000, 1'000'000)->Unit(benchmark::kMillisecond);
+
+// Every intermediate version stays alive, so each append path-copies
+static void BM_ListAppendPersistent(benchmark::State& state) {
+    for (auto _ : state) {
+        std::vector<Value> versions;
+        versions.reserve(static_cast<size_t>(state.range(0)));
+        Value list{PersistentVector{}};
+        for (int64_t i = 0; i < state.range(0); ++i) {
+            list.as_list_mut().push_back(Value(i));
+            versions.push_back(list);
+        }
+        benchmark::DoNotOptimize(versions);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ListAppendPersistent)->RangeMultiplier(10)->Range(100'000, 1'000'000)->Unit(benchmark::kMillisecond);
+
+static void BM_ListIndex(benchmark::State& state) {
+    auto list = make_list(state.range(0));
+    const auto& vec = list.as_list();
+    const auto n = static_cast<uint64_t>(state.range(0));
+    for (auto _ : state) {
+        int64_t sum = 0;
+        uint64_t index = 0;
+        for (uint64_t i = 0; i < n; ++i) {
+            index = (index * 6364136223846793005ULL + 1442695040888963407ULL);
+            sum += vec[static_cast<size_t>(index % n)].as_int();
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ListIndex)->RangeMultiplier(10)->Range(100'000, 1'000'000)->Unit(benchmark::kMillisecond);
+
+static void BM_ListIterate(benchmark::State& state) {
+    auto list = make_list(state.range(0));
+    for (auto _ : state) {
+        int64_t sum = 0;
+        for (const auto& value : list.as_list()) {
+            sum += value.as_int();
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ListIterate)->RangeMultiplier(10)->Range(100'000, 1'000'000)->Unit(benchmark::kMillisecond);
+
+// head/tail recursion: sum = xs.head() + sum(xs.tail())
+static void BM_ListTailWalk(benchmark::State& state) {
+    auto list = make_list(state.range(0));
+    for (auto _ : state) {
+        int64_t sum = 0;
+        Value rest = list;
+        while (!rest.as_list().empty()) {
+            sum += rest.as_list().front().as_int();
+            rest.as_list_mut().pop_front();
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ListTailWalk)->RangeMultiplier(10)->Range(100'000, 1'000'000)->Unit(benchmark::kMillisecond);
+
+// Previous behaviour: every tail() copies the remaining elements (O(n^2)),
+// so this only runs at sizes where it finishes
+static void BM_CopyingTailWalk(benchmark::State& state) {
+    std::vector<Value> list;
+    for (int64_t i = 0; i < state.range(0); ++i) {
+        list.emplace_back(i);
+    }
+    for (auto _ : state) {
+        int64_t sum = 0;
+        std::vector<Value> rest = list;
+        while (!rest.empty()) {
+            sum += rest.front().as_int();
+            rest = std::vector<Value>(rest.begin() + 1, rest.end());
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_CopyingTailWalk)->Arg(10'000)->Arg(30'000)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,395 @@
+// VM dispatch benchmarks.
+//
+// Each workload runs under both dispatch strategies so the switch loop and
+// the computed-goto loop can be compared side by side. The "time/insn"
+// counter is wall time divided by the number of bytecode instructions
+// executed; the _Optimized variants run the peephole pass first, and
+// BM_Fibonacci_Memoized caches fib's results (VM::set_memoized). Build once
+// with -DLUCID_COMPACT_VALUE=ON and once without to compare Value layouts;
+// the label records which one was measured.
+
+#include "bench_common.hpp"
+
+#include <lucid/backend/optimizer.hpp>
+#include <lucid/backend/vm.hpp>
+#include <benchmark/benchmark.h>
+#include <ostream>
+#include <streambuf>
+
+using namespace lucid;
+using namespace lucid::backend;
+
+namespace {
+
+constexpr const char* kFibonacci = R"(
+    function fib(n: Int) returns Int {
+        return if n <= 1 { n } else { fib(n - 1) + fib(n - 2) }
+    }
+
+    function main() returns Int {
+        return fib(20)
+    }
+)";
+
+constexpr const char* kArithmetic = R"(
+    function poly(x: Int) returns Int {
+        return ((x * 3 + 7) * (x - 2) + x * x) % 1009
+    }
+
+    function sum(n: Int, acc: Int) returns Int {
+        return if n == 0 { acc } else { sum(n - 1, acc + poly(n) - poly(n - 1) * 2) }
+    }
+
+    function main() returns Int {
+        return sum(2000, 0)
+    }
+)";
+
+constexpr const char* kStrings = R"(
+    function walk(n: Int, tag: String, label: String) returns Int {
+        return if n == 0 {
+            tag.length() + label.length()
+        } else {
+            walk(n - 1, label, tag) + 1
+        }
+    }
+
+    function main() returns Int {
+        return walk(2000, "short", "a somewhat longer label")
+    }
+)";
+
+constexpr const char* kListBuild = R"(
+    function build(n: Int) returns List[Int] {
+        return if n == 0 { [0] } else { build(n - 1).append(n) }
+    }
+
+    function main() returns Int {
+        let xs = build(2000)
+        return xs.length()
+    }
+)";
+
+constexpr const char* kMethods = R"(
+    function count(n: Int, s: String, xs: List[Int], acc: Int) returns Int {
+        return if n == 0 {
+            acc
+        } else {
+            count(n - 1, s, xs, acc + s.length() + xs.length() + xs.head() + n.abs())
+        }
+    }
+
+    function main() returns Int {
+        return count(2000, "method", [3, 1, 2], 0)
+    }
+)";
+
+// One call and return per iteration of the loop around it
+constexpr const char* kCalls = R"(
+    function identity(x: Int) returns Int {
+        return x
+    }
+
+    function loop(n: Int, acc: Int) returns Int {
+        return if n == 0 { acc } else { loop(n - 1, acc + identity(n)) }
+    }
+
+    function main() returns Int {
+        return loop(5000, 0)
+    }
+)";
+
+constexpr const char* kListWalk = R"(
+    function build(n: Int, xs: List[Int]) returns List[Int] {
+        return if n == 0 { xs } else { build(n - 1, xs.append(n)) }
+    }
+
+    function walk(xs: List[Int], acc: Int) returns Int {
+        return if xs.is_empty() { acc } else { walk(xs.tail(), acc + xs.head()) }
+    }
+
+    function main() returns Int {
+        return walk(build(2000, [0]), 0)
+    }
+)";
+
+// String methods that allocate a new String per call
+constexpr const char* kStringOps = R"(
+    function shout(n: Int, acc: Int) returns Int {
+        return if n == 0 {
+            acc
+        } else {
+            shout(n - 1, acc + n.to_string().to_upper().trim().length())
+        }
+    }
+
+    function main() returns Int {
+        return shout(2000, 0)
+    }
+)";
+
+// A 20000-piece string built with `+`, then joined from a list
+constexpr const char* kStringConcat = R"(
+    function build(n: Int, acc: String) returns String {
+        return if n == 0 { acc } else { build(n - 1, acc + n.to_string()) }
+    }
+
+    function pieces(n: Int, acc: List[String]) returns List[String] {
+        return if n == 0 { acc } else { pieces(n - 1, acc.append(n.to_string())) }
+    }
+
+    function main() returns Int {
+        return build(20000, "").length() + pieces(2000, ["0"]).join(",").length()
+    }
+)";
+
+// A pair returned and taken apart on each of 5000 iterations
+constexpr const char* kTuples = R"(
+    function step(a: Int, b: Int) returns (Int, Int) {
+        return (b, (a + b) % 1000)
+    }
+
+    function loop(n: Int, a: Int, b: Int) returns Int {
+        if n == 0 { return a }
+        let (x, y) = step(a, b)
+        return loop(n - 1, x, y)
+    }
+
+    function main() returns Int {
+        return loop(5000, 0, 1)
+    }
+)";
+
+// Idiomatic helpers: one-line functions called from a loop
+constexpr const char* kHelpers = R"(
+    function square(x: Int) returns Int {
+        x * x
+    }
+
+    function clamp(x: Int, limit: Int) returns Int {
+        if x > limit { limit } else { x }
+    }
+
+    function mix(a: Int, b: Int) returns Int {
+        clamp(square(a) + b, 1000)
+    }
+
+    function loop(n: Int, acc: Int) returns Int {
+        if n == 0 { return acc }
+        return loop(n - 1, mix(n % 40, acc % 7))
+    }
+
+    function main() returns Int {
+        return loop(5000, 0)
+    }
+)";
+
+// 2000 println calls of Ints, Floats and Strings
+constexpr const char* kPrintLines = R"(
+    function emit(n: Int) returns Int {
+        if n == 0 { return 0 }
+        println(n)
+        println(1.5 * 2.0)
+        println("line")
+        return emit(n - 1)
+    }
+
+    function main() returns Int {
+        return emit(2000)
+    }
+)";
+
+// Discards its input, so print benchmarks measure the VM's side only
+class NullBuffer : public std::streambuf {
+protected:
+    auto xsputn(const char*, std::streamsize count) -> std::streamsize override { return count; }
+    auto overflow(int c) -> int override { return c; }
+};
+
+auto run_workload(benchmark::State& state, const char* source, DispatchMode mode,
+                  bool optimized = false, bool inline_calls = false) -> void {
+    if (mode == DispatchMode::Threaded && !VM::threaded_dispatch_available()) {
+        state.SkipWithError("threaded dispatch not available in this build");
+        return;
+    }
+
+    auto bytecode = bench::compile_source(source, inline_calls);
+    if (optimized) {
+        optimize(bytecode);
+    }
+    VM vm;
+    vm.set_dispatch_mode(mode);
+
+    for (auto _ : state) {
+        auto result = vm.call_function(bytecode, "main", {});
+        benchmark::DoNotOptimize(result);
+    }
+
+    state.counters["insns"] = benchmark::Counter(
+        static_cast<double>(vm.instructions_executed()), benchmark::Counter::kAvgIterations);
+    state.counters["time/insn"] = benchmark::Counter(
+        static_cast<double>(vm.instructions_executed()),
+        benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+    state.SetLabel(LUCID_COMPACT_VALUE ? "compact Value" : "wide Value");
+}
+
+} // namespace
+
+static void BM_Fibonacci_Switch(benchmark::State& state) {
+    run_workload(state, kFibonacci, DispatchMode::Switch);
+}
+BENCHMARK(BM_Fibonacci_Switch);
+
+static void BM_Fibonacci_Threaded(benchmark::State& state) {
+    run_workload(state, kFibonacci, DispatchMode::Threaded);
+}
+BENCHMARK(BM_Fibonacci_Threaded);
+
+static void BM_Fibonacci_Memoized(benchmark::State& state) {
+    auto bytecode = bench::compile_source(kFibonacci);
+    VM vm;
+    vm.set_memoized({"fib"});
+    for (auto _ : state) {
+        auto result = vm.call_function(bytecode, "main", {});
+        benchmark::DoNotOptimize(result);
+    }
+    state.counters["insns"] = benchmark::Counter(
+        static_cast<double>(vm.instructions_executed()), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_Fibonacci_Memoized);
+
+static void BM_Arithmetic_Switch(benchmark::State& state) {
+    run_workload(state, kArithmetic, DispatchMode::Switch);
+}
+BENCHMARK(BM_Arithmetic_Switch);
+
+static void BM_Arithmetic_Threaded(benchmark::State& state) {
+    run_workload(state, kArithmetic, DispatchMode::Threaded);
+}
+BENCHMARK(BM_Arithmetic_Threaded);
+
+static void BM_Strings_Switch(benchmark::State& state) {
+    run_workload(state, kStrings, DispatchMode::Switch);
+}
+BENCHMARK(BM_Strings_Switch);
+
+static void BM_Strings_Threaded(benchmark::State& state) {
+    run_workload(state, kStrings, DispatchMode::Threaded);
+}
+BENCHMARK(BM_Strings_Threaded);
+
+static void BM_ListBuild_Switch(benchmark::State& state) {
+    run_workload(state, kListBuild, DispatchMode::Switch);
+}
+BENCHMARK(BM_ListBuild_Switch);
+
+static void BM_ListBuild_Threaded(benchmark::State& state) {
+    run_workload(state, kListBuild, DispatchMode::Threaded);
+}
+BENCHMARK(BM_ListBuild_Threaded);
+
+static void BM_Methods_Switch(benchmark::State& state) {
+    run_workload(state, kMethods, DispatchMode::Switch);
+}
+BENCHMARK(BM_Methods_Switch);
+
+static void BM_Methods_Threaded(benchmark::State& state) {
+    run_workload(state, kMethods, DispatchMode::Threaded);
+}
+BENCHMARK(BM_Methods_Threaded);
+
+static void BM_Calls_Switch(benchmark::State& state) {
+    run_workload(state, kCalls, DispatchMode::Switch);
+}
+BENCHMARK(BM_Calls_Switch);
+
+static void BM_Calls_Threaded(benchmark::State& state) {
+    run_workload(state, kCalls, DispatchMode::Threaded);
+}
+BENCHMARK(BM_Calls_Threaded);
+
+static void BM_ListWalk_Switch(benchmark::State& state) {
+    run_workload(state, kListWalk, DispatchMode::Switch);
+}
+BENCHMARK(BM_ListWalk_Switch);
+
+static void BM_ListWalk_Threaded(benchmark::State& state) {
+    run_workload(state, kListWalk, DispatchMode::Threaded);
+}
+BENCHMARK(BM_ListWalk_Threaded);
+
+static void BM_StringOps_Switch(benchmark::State& state) {
+    run_workload(state, kStringOps, DispatchMode::Switch);
+}
+BENCHMARK(BM_StringOps_Switch);
+
+static void BM_StringOps_Threaded(benchmark::State& state) {
+    run_workload(state, kStringOps, DispatchMode::Threaded);
+}
+BENCHMARK(BM_StringOps_Threaded);
+
+static void BM_StringConcat_Switch(benchmark::State& state) {
+    run_workload(state, kStringConcat, DispatchMode::Switch);
+}
+BENCHMARK(BM_StringConcat_Switch);
+
+static void BM_StringConcat_Threaded(benchmark::State& state) {
+    run_workload(state, kStringConcat, DispatchMode::Threaded);
+}
+BENCHMARK(BM_StringConcat_Threaded);
+
+static void BM_Tuples_Switch(benchmark::State& state) {
+    run_workload(state, kTuples, DispatchMode::Switch);
+}
+BENCHMARK(BM_Tuples_Switch);
+
+static void BM_Tuples_Threaded(benchmark::State& state) {
+    run_workload(state, kTuples, DispatchMode::Threaded);
+}
+BENCHMARK(BM_Tuples_Threaded);
+
+// Arg: output buffer size in bytes (0 = every print written through)
+static void BM_Println(benchmark::State& state) {
+    auto bytecode = bench::compile_source(kPrintLines);
+    NullBuffer sink;
+    std::ostream out(&sink);
+    VM vm;
+    vm.set_output_stream(out);
+    vm.set_output_buffer_size(static_cast<size_t>(state.range(0)));
+
+    for (auto _ : state) {
+        auto result = vm.call_function(bytecode, "main", {});
+        benchmark::DoNotOptimize(result);
+    }
+    state.SetItemsProcessed(state.iterations() * 6000);
+}
+BENCHMARK(BM_Println)->Arg(0)->Arg(64 * 1024);
+
+// Peephole-optimised bytecode (lucidc -O), threaded dispatch
+static void BM_Fibonacci_Optimized(benchmark::State& state) {
+    run_workload(state, kFibonacci, DispatchMode::Threaded, true);
+}
+BENCHMARK(BM_Fibonacci_Optimized);
+
+static void BM_Arithmetic_Optimized(benchmark::State& state) {
+    run_workload(state, kArithmetic, DispatchMode::Threaded, true);
+}
+BENCHMARK(BM_Arithmetic_Optimized);
+
+static void BM_Methods_Optimized(benchmark::State& state) {
+    run_workload(state, kMethods, DispatchMode::Threaded, true);
+}
+BENCHMARK(BM_Methods_Optimized);
+
+static void BM_Helpers_Optimized(benchmark::State& state) {
+    run_workload(state, kHelpers, DispatchMode::Threaded, true);
+}
+BENCHMARK(BM_Helpers_Optimized);
+
+// As lucidc -O compiles it: small functions inlined before folding
+static void BM_Helpers_Inlined(benchmark::State& state) {
+    run_workload(state, kHelpers, DispatchMode::Threaded, true, true);
+}
+BENCHMARK(BM_Helpers_Inlined);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,192 @@
+#pragma once
+
+// Support code for the C++ that CppEmitter generates (lucidc --emit-cpp,
+// lucidc -c --aot). Not used by the compiler or the VM themselves.
+//
+// Generated code keeps Int, Float and Bool in native int64_t, double and
+// bool variables and calls the unboxed overloads below, which compile down
+// to plain machine arithmetic. Strings, lists and tuples stay Values; any
+// operation involving one goes through the VM's own generic operations, so
+// results and error messages match the interpreter exactly.
+
+#include <lucid/backend/builtin_methods.hpp>
+#include <lucid/backend/file_io.hpp>
+#include <lucid/backend/value.hpp>
+#include <lucid/backend/vm.hpp>
+#include <fmt/core.h>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace lucid::aot {
+
+using backend::Value;
+using backend::VM;
+
+// ===== Boxing =====
+
+inline auto box(int64_t value) -> Value { return Value(value); }
+inline auto box(double value) -> Value { return Value(value); }
+inline auto box(bool value) -> Value { return Value(value); }
+inline auto box(Value value) -> Value { return value; }
+
+// Value::is_truthy for unboxed operands
+inline auto truthy(int64_t value) -> bool { return value != 0; }
+inline auto truthy(double value) -> bool { return value != 0.0; }
+inline auto truthy(bool value) -> bool { return value; }
+inline auto truthy(const Value& value) -> bool { return value.is_truthy(); }
+
+// ===== Arithmetic =====
+//
+// Int arithmetic is VM::int_add and friends, as in every backend: it wraps
+// on overflow, and INT64_MIN / -1 is INT64_MIN.
+
+inline auto add(int64_t a, int64_t b) -> int64_t { return VM::int_add(a, b); }
+inline auto sub(int64_t a, int64_t b) -> int64_t { return VM::int_sub(a, b); }
+inline auto mul(int64_t a, int64_t b) -> int64_t { return VM::int_mul(a, b); }
+inline auto add(double a, double b) -> double { return a + b; }
+inline auto sub(double a, double b) -> double { return a - b; }
+inline auto mul(double a, double b) -> double { return a * b; }
+
+// Mixed Int and Float operands promote to Float
+inline auto add(int64_t a, double b) -> double { return static_cast<double>(a) + b; }
+inline auto add(double a, int64_t b) -> double { return a + static_cast<double>(b); }
+inline auto sub(int64_t a, double b) -> double { return static_cast<double>(a) - b; }
+inline auto sub(double a, int64_t b) -> double { return a - static_cast<double>(b); }
+inline auto mul(int64_t a, double b) -> double { return static_cast<double>(a) * b; }
+inline auto mul(double a, int64_t b) -> double { return a * static_cast<double>(b); }
+
+inline auto div(int64_t a, int64_t b) -> int64_t {
+    if (b == 0) {
+        throw std::runtime_error("Division by zero");
+    }
+    return VM::int_div(a, b);
+}
+inline auto div(double a, double b) -> double {
+    if (b == 0.0) {
+        throw std::runtime_error("Division by zero");
+    }
+    return a / b;
+}
+inline auto div(int64_t a, double b) -> double { return div(static_cast<double>(a), b); }
+inline auto div(double a, int64_t b) -> double {
+    if (b == 0) {
+        throw std::runtime_error("Division by zero");
+    }
+    return a / static_cast<double>(b);
+}
+
+inline auto mod(int64_t a, int64_t b) -> int64_t {
+    if (b == 0) {
+        throw std::runtime_error("Modulo by zero");
+    }
+    return VM::int_mod(a, b);
+}
+
+// Anything involving another type: the VM's generic operation
+template <typename A, typename B> auto add(const A& a, const B& b) -> Value { return VM::binary_add(box(a), box(b)); }
+template <typename A, typename B> auto sub(const A& a, const B& b) -> Value { return VM::binary_sub(box(a), box(b)); }
+template <typename A, typename B> auto mul(const A& a, const B& b) -> Value { return VM::binary_mul(box(a), box(b)); }
+template <typename A, typename B> auto div(const A& a, const B& b) -> Value { return VM::binary_div(box(a), box(b)); }
+template <typename A, typename B> auto mod(const A& a, const B& b) -> Value { return VM::binary_mod(box(a), box(b)); }
+template <typename A, typename B> auto pow(const A& a, const B& b) -> Value { return VM::binary_pow(box(a), box(b)); }
+
+inline auto negate(int64_t a) -> int64_t { return VM::int_negate(a); }
+inline auto negate(double a) -> double { return -a; }
+inline auto negate(const Value& a) -> Value { return VM::unary_negate(a); }
+inline auto positive(int64_t a) -> int64_t { return a; }
+inline auto positive(double a) -> double { return a; }
+inline auto positive(const Value& a) -> Value { return VM::unary_positive(a); }
+
+// ===== Comparison =====
+
+inline auto eq(int64_t a, int64_t b) -> bool { return a == b; }
+inline auto eq(double a, double b) -> bool { return a == b; }
+inline auto eq(bool a, bool b) -> bool { return a == b; }
+inline auto ne(int64_t a, int64_t b) -> bool { return a != b; }
+inline auto ne(double a, double b) -> bool { return a != b; }
+inline auto ne(bool a, bool b) -> bool { return a != b; }
+inline auto lt(int64_t a, int64_t b) -> bool { return a < b; }
+inline auto lt(double a, double b) -> bool { return a < b; }
+inline auto gt(int64_t a, int64_t b) -> bool { return a > b; }
+inline auto gt(double a, double b) -> bool { return a > b; }
+inline auto le(int64_t a, int64_t b) -> bool { return a <= b; }
+inline auto le(double a, double b) -> bool { return a <= b; }
+inline auto ge(int64_t a, int64_t b) -> bool { return a >= b; }
+inline auto ge(double a, double b) -> bool { return a >= b; }
+
+template <typename A, typename B> auto eq(const A& a, const B& b) -> bool { return VM::binary_eq(box(a), box(b)).as_bool(); }
+template <typename A, typename B> auto ne(const A& a, const B& b) -> bool { return VM::binary_ne(box(a), box(b)).as_bool(); }
+template <typename A, typename B> auto lt(const A& a, const B& b) -> bool { return VM::binary_lt(box(a), box(b)).as_bool(); }
+template <typename A, typename B> auto gt(const A& a, const B& b) -> bool { return VM::binary_gt(box(a), box(b)).as_bool(); }
+template <typename A, typename B> auto le(const A& a, const B& b) -> bool { return VM::binary_le(box(a), box(b)).as_bool(); }
+template <typename A, typename B> auto ge(const A& a, const B& b) -> bool { return VM::binary_ge(box(a), box(b)).as_bool(); }
+
+// ===== Values =====
+
+inline auto list(std::vector<Value> elements) -> Value { return Value(std::move(elements), false); }
+inline auto tuple(std::vector<Value> elements) -> Value { return Value(std::move(elements), true); }
+
+inline auto index(const Value& collection, const Value& index) -> Value {
+    return VM::index_value(collection, index);
+}
+
+inline auto call_method(std::string_view name, Value receiver, std::vector<Value> args) -> Value {
+    auto id = backend::method_id_from_name(name);
+    backend::MethodFn method = id ? backend::lookup_method(receiver.type(), *id) : nullptr;
+    if (method == nullptr) {
+        backend::throw_unknown_method(name, receiver);
+    }
+    return method(receiver, args);
+}
+
+// print/println output, buffered as in the VM and written out by run()
+inline auto output() -> backend::OutputBuffer& {
+    static backend::OutputBuffer buffer(std::cout.rdbuf());
+    return buffer;
+}
+
+inline auto call_builtin(backend::BuiltinId id, std::vector<Value> args) -> Value {
+    return VM::call_builtin(static_cast<uint16_t>(id), std::move(args), output());
+}
+
+// ===== Calls =====
+
+// Depth of generated function frames, limited like the VM's call stack
+inline thread_local size_t call_depth = 0;
+
+class Frame {
+public:
+    Frame() {
+        if (++call_depth > VM::kMaxCallDepth) {
+            --call_depth;
+            throw std::runtime_error("Call stack overflow");
+        }
+    }
+    ~Frame() { --call_depth; }
+
+    Frame(const Frame&) = delete;
+    auto operator=(const Frame&) -> Frame& = delete;
+};
+
+// Process entry: runs main() with lucid-run's exit code and error report
+template <typename Main>
+auto run(Main main) -> int {
+    try {
+        Value result = box(main());
+        output().flush();
+        backend::flush_appended_files();
+        return result.is_int() ? static_cast<int>(result.as_int()) : 0;
+    } catch (const std::exception& e) {
+        output().flush();
+        backend::flush_appended_files();
+        fmt::print(stderr, "Runtime error: {}\n", e.what());
+        return 1;
+    }
+}
+
+} // namespace lucid::aot
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <lucid/backend/value.hpp>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string_view>
+
+namespace lucid::backend {
+
+// Built-in method identifiers. Method names in CALL_METHOD are resolved to
+// these once per Bytecode so the VM never compares strings at run time.
+enum class MethodId : uint8_t {
+    LENGTH,
+    APPEND,
+    HEAD,
+    TAIL,
+    IS_EMPTY,
+    REVERSE,
+    CONCAT,
+    CONTAINS,
+    STARTS_WITH,
+    ENDS_WITH,
+    TO_UPPER,
+    TO_LOWER,
+    TRIM,
+    TO_STRING,
+    ABS,
+    FLOOR,
+    CEIL,
+    ROUND,
+    SUM,
+    JOIN,
+    // Methods taking a function argument. They call back into the program,
+    // so the VM runs them itself (VM::call_list_method) and the table below
+    // has no entry for them.
+    MAP,
+    FILTER,
+    FOLD,
+    // Like map and filter, and a reduce with an associative combiner, but
+    // spread over worker VMs for long lists (see VM::set_parallelism)
+    PAR_MAP,
+    PAR_FILTER,
+    PAR_REDUCE,
+};
+
+inline constexpr size_t kMethodCount = static_cast<size_t>(MethodId::PAR_REDUCE) + 1;
+inline constexpr size_t kValueTypeCount = static_cast<size_t>(ValueType::Function) + 1;
+
+// Whether the VM, rather than lookup_method, runs this method
+inline constexpr auto is_callback_method(MethodId id) -> bool { return id >= MethodId::MAP; }
+
+// Receiver is the operand-stack slot and may be consumed (moved from or
+// updated in place when uniquely owned); so may the arguments.
+using MethodFn = auto (*)(Value& receiver, std::span<Value> args) -> Value;
+
+// Name <-> id mapping
+auto method_id_from_name(std::string_view name) -> std::optional<MethodId>;
+auto method_name(MethodId id) -> std::string_view;
+
+// Dispatch table lookup: nullptr if the receiver type has no such method
+auto lookup_method(ValueType receiver, MethodId id) -> MethodFn;
+
+// Slow path for names that did not resolve or types without the method;
+// always throws with the user-facing error message.
+[[noreturn]] auto throw_unknown_method(std::string_view name, const Value& receiver) -> void;
+
+} // namespace lucid::backend
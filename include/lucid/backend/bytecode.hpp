@@ -2,13 +2,18 @@
 
 #include <lucid/frontend/token.hpp>
 #include <cstdint>
+#include <memory>
+#include <span>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
 namespace lucid::backend {
 
-// Forward declaration
+// Forward declarations
 class Value;
+class MappedFile;  // Read-only view of a bytecode file (file_io.hpp)
 
 // Bytecode operation codes
 enum class OpCode : uint8_t {
@@ -20,7 +25,7 @@ enum class OpCode : uint8_t {
     // Variables
     LOAD_LOCAL,      // Load local variable by index [index: uint16_t]
     STORE_LOCAL,     // Store to local variable by index [index: uint16_t]
-    LOAD_GLOBAL,     // Load global function [index: uint16_t]
+    LOAD_GLOBAL,     // Push a function value [index: uint16_t]
 
     // Arithmetic (binary)
     ADD,             // Add: pop b, pop a, push a + b
@@ -47,9 +52,32 @@ enum class OpCode : uint8_t {
     NEGATE,          // Negate: pop a, push -a
     POSITIVE,        // Unary plus: pop a, push +a
 
+    // Type-specialised binary operations, emitted when the type checker
+    // knows both operand types. Same stack effect as the generic opcode.
+    ADD_INT,         // Add two Ints
+    SUB_INT,         // Subtract two Ints
+    MUL_INT,         // Multiply two Ints
+    DIV_INT,         // Divide two Ints
+    MOD_INT,         // Modulo of two Ints
+    ADD_FLOAT,       // Add two Floats
+    SUB_FLOAT,       // Subtract two Floats
+    MUL_FLOAT,       // Multiply two Floats
+    DIV_FLOAT,       // Divide two Floats
+    EQ_INT,          // Int equal
+    NE_INT,          // Int not equal
+    LT_INT,          // Int less than
+    GT_INT,          // Int greater than
+    LE_INT,          // Int less or equal
+    GE_INT,          // Int greater or equal
+    LT_FLOAT,        // Float less than
+    GT_FLOAT,        // Float greater than
+    LE_FLOAT,        // Float less or equal
+    GE_FLOAT,        // Float greater or equal
+
     // Collections
     BUILD_LIST,      // Build list from N stack items [count: uint16_t]
     BUILD_TUPLE,     // Build tuple from N stack items [count: uint16_t]
+    UNPACK_TUPLE,    // Pop a tuple of N elements, push them in order [count: uint16_t]
     INDEX,           // Index: pop index, pop object, push object[index]
 
     // Methods and built-ins
@@ -64,15 +92,27 @@ enum class OpCode : uint8_t {
     // Functions
     CALL,            // Call function [func_index: uint16_t, arg_count: uint8_t]
     RETURN,          // Return from function (value on stack)
+    RETURN_TUPLE,    // Return the top N values unpacked, for a destructuring caller [count: uint16_t]
+    TAIL_CALL,       // Call reusing the current frame [func_index: uint16_t, arg_count: uint8_t]
+    MAKE_CLOSURE,    // Pop N captured values, push a function value [func_index: uint16_t, count: uint8_t]
+    CALL_VALUE,      // Pop a function value, call it with the args below [arg_count: uint8_t]
 
     // Stack manipulation
     POP,             // Pop and discard top of stack
     DUP,             // Duplicate top of stack
 
+    // Superinstructions, formed only by the peephole optimiser (optimizer.hpp)
+    LOAD_LOCAL2,     // Push two locals [a: uint16_t, b: uint16_t]
+    LOAD_LOCAL_CONST,  // Push a local, then a constant [local: uint16_t, const: uint16_t]
+    POP_JUMP_IF_FALSE,  // Pop condition, jump if false [offset: int16_t]
+    COMPARE_JUMP_IF_FALSE,  // Pop b, pop a, jump unless a <compare> b [offset: int16_t, compare: OpCode]
+
     // Special
     HALT,            // Stop execution
 };
 
+inline constexpr size_t kOpCodeCount = static_cast<size_t>(OpCode::HALT) + 1;
+
 // Built-in function identifiers
 enum class BuiltinId : uint16_t {
     PRINT = 0,       // print(value) -> Unit
@@ -82,6 +122,8 @@ enum class BuiltinId : uint16_t {
     WRITE_FILE = 4,  // write_file(path: String, content: String) -> Bool
     APPEND_FILE = 5, // append_file(path: String, content: String) -> Bool
     FILE_EXISTS = 6, // file_exists(path: String) -> Bool
+    READ_LINES = 7,  // read_lines(path: String) -> List[String]
+    FOR_EACH_LINE = 8, // for_each_line(path: String, f: (String) -> T) -> Int (lines read)
 };
 
 // Get human-readable name for opcode
@@ -93,9 +135,12 @@ auto builtin_name(BuiltinId id) -> std::string_view;
 // Check if opcode has operands
 auto opcode_has_operand(OpCode opcode) -> bool;
 
-// Get operand size in bytes (0, 1, 2, or 3)
+// Get operand size in bytes (0, 1, 2, 3 or 4)
 auto opcode_operand_size(OpCode opcode) -> size_t;
 
+// Version of the save_to_file container; bumped on any layout change
+inline constexpr uint32_t kBytecodeFormatVersion = 4;
+
 // Bytecode program structure
 class Bytecode {
 public:
@@ -116,7 +161,8 @@ public:
     };
     std::vector<FunctionInfo> functions;
 
-    // Debug information (optional)
+    // Debug information (optional): empty, or the source location of the
+    // instruction covering each byte of code()
     std::vector<SourceLocation> debug_locations;
 
     // Bytecode building methods
@@ -124,8 +170,10 @@ public:
     auto emit(OpCode opcode, uint8_t operand) -> void;
     auto emit(OpCode opcode, uint16_t operand) -> void;
     auto emit(OpCode opcode, uint16_t operand1, uint8_t operand2) -> void;
+    auto emit(OpCode opcode, uint16_t operand1, uint16_t operand2) -> void;
 
-    // Add constant to pool, return index
+    // Add constant to pool, return index. Identical constants (same type and
+    // representation, so Int 1 and Float 1.0 stay distinct) share one slot.
     auto add_constant(Value value) -> uint16_t;
 
     // Add function to table
@@ -148,12 +196,49 @@ public:
     auto function_count() const -> size_t { return functions.size(); }
     auto has_function(const std::string& name) const -> bool { return find_function(name) >= 0; }
 
-    // Serialization
-    auto save_to_file(const std::string& filename) const -> void;
-    static auto load_from_file(const std::string& filename) -> Bytecode;
-
-    // Generate standalone executable source
-    auto generate_executable_source() const -> std::string;
+    // Serialization to a versioned, checksummed binary container. Loading
+    // maps the file and executes its instruction section in place; only the
+    // constant pool and tables are decoded. Throws std::runtime_error on a
+    // missing, truncated, corrupt or incompatible file.
+    //
+    // `tag` is stored with the program as opaque bytes; loading throws unless
+    // the file holds exactly the `tag` asked for (CompileCache keeps its
+    // full key there)
+    auto save_to_file(const std::string& filename, std::string_view tag = {}) const -> void;
+    static auto load_from_file(const std::string& filename, std::string_view tag = {}) -> Bytecode;
+
+    // Instruction stream to execute: the mapped section of a loaded file,
+    // otherwise `instructions`
+    auto code() const -> std::span<const uint8_t> {
+        return mapping_ ? mapped_code_ : std::span<const uint8_t>(instructions);
+    }
+    auto is_mapped() const -> bool { return mapping_ != nullptr; }
+
+    // Copy a mapped instruction stream into `instructions` so it can be
+    // edited (the optimiser does this); no-op for in-memory bytecode
+    auto unmap() -> void;
+
+    // Standalone executables: a copy of the lucid-run stub at `runner` with
+    // this program appended (see bytecode.cpp for the layout). The stub maps
+    // itself and runs the program in place, so building one is a file copy.
+    auto save_as_executable(const std::string& runner, const std::string& filename) const -> void;
+    static auto has_appended_program(const std::string& filename) -> bool;
+    static auto load_from_executable(const std::string& filename) -> Bytecode;
+
+private:
+    // add_constant's dedup index: constant_key(value) -> pool slot
+    std::unordered_map<std::string, uint16_t> constant_index_;
+
+    // Decodes a serialized image that lies inside `mapping`, whose tag must
+    // be `tag`
+    static auto from_image(std::shared_ptr<const MappedFile> mapping,
+                           std::span<const uint8_t> image, std::string_view tag) -> Bytecode;
+
+    // Set by load_from_file: the mapping code() points into, and the
+    // filenames debug_locations refer to. Shared by copies.
+    std::shared_ptr<const MappedFile> mapping_;
+    std::span<const uint8_t> mapped_code_;
+    std::shared_ptr<const std::vector<std::string>> filenames_;
 };
 
 } // namespace lucid::backend
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <lucid/backend/bytecode.hpp>
+#include <lucid/backend/value.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace lucid::backend {
+
+// On-disk cache of compiled programs, so lucidc can skip lexing, parsing,
+// type checking and code generation when a source file has not changed.
+//
+// Each entry is a bytecode file (see Bytecode::save_to_file) named after a
+// hash of the key: the compiler identity, the source filename and the source
+// text. Any change to one of them selects a different entry, so nothing is
+// ever invalidated explicitly; stale entries are simply never read again.
+// Each store removes the least recently used entries (by file mtime, which
+// a hit refreshes) beyond the entry and byte limits, so they do not pile up.
+// The hash is not collision-resistant, so the full key is stored in the
+// entry as its tag and an entry holding another key is a miss.
+//
+// Safe to share between concurrent lucidc processes: entries are written to
+// a unique temporary file and renamed into place, readers only ever see a
+// complete file, and a damaged or unreadable entry is treated as a miss.
+class CompileCache {
+public:
+    static constexpr size_t kDefaultMaxEntries = 512;
+    static constexpr uintmax_t kDefaultMaxBytes = uintmax_t{256} << 20;
+
+    // `identity` should change whenever the same source could compile to
+    // different bytecode: compiler build, format version, code-gen options
+    CompileCache(std::filesystem::path directory, std::string identity);
+
+    // $LUCID_CACHE_DIR, else $XDG_CACHE_HOME/lucid, else $HOME/.cache/lucid;
+    // nullopt when none of them is set
+    static auto default_directory() -> std::optional<std::filesystem::path>;
+
+    // Version, bytecode format and the running executable's size and mtime,
+    // so rebuilding lucidc retires every entry it wrote
+    static auto compiler_identity() -> std::string;
+
+    // Entries kept by store; the one it just wrote is kept regardless
+    auto set_limits(size_t max_entries, uintmax_t max_bytes) -> void {
+        max_entries_ = max_entries;
+        max_bytes_ = max_bytes;
+    }
+
+    auto directory() const -> const std::filesystem::path& { return directory_; }
+    auto entry_path(std::string_view filename, std::string_view source) const -> std::filesystem::path;
+
+    // The cached program for this source, or nullopt on a miss
+    auto load(std::string_view filename, std::string_view source) const -> std::optional<Bytecode>;
+
+    // Throws std::runtime_error if the entry cannot be written
+    auto store(std::string_view filename, std::string_view source, const Bytecode& bytecode) const -> void;
+
+private:
+    auto entry_key(std::string_view filename, std::string_view source) const -> std::string;
+    auto prune(const std::filesystem::path& keep) const -> void;
+
+    std::filesystem::path directory_;
+    std::string identity_;
+    size_t max_entries_ = kDefaultMaxEntries;
+    uintmax_t max_bytes_ = kDefaultMaxBytes;
+};
+
+} // namespace lucid::backend
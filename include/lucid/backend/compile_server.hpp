@@ -0,0 +1,111 @@
+#pragma once
+
+#include <lucid/frontend/ast.hpp>
+#include <lucid/frontend/parser.hpp>
+#include <lucid/semantic/type_checker.hpp>
+#include <lucid/backend/bytecode.hpp>
+#include <lucid/backend/compiler.hpp>
+#include <lucid/backend/escape_analysis.hpp>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace lucid::backend {
+
+// What one CompileServer::update did
+struct CompileUpdate {
+    std::vector<ParseError> parse_errors;
+    std::vector<semantic::TypeError> type_errors;  // In program order
+    std::optional<Bytecode> bytecode;              // Set when there were no errors
+    size_t reparsed = 0;    // Functions lexed, parsed and checked again
+    size_t recompiled = 0;  // Chunks compiled again
+    size_t functions = 0;   // In the program
+};
+
+// Keeps one source file compiled across edits (lucidc --serve).
+//
+// The program is held as one unit per function: its checked and folded
+// tree, its bytecode chunk (Compiler::compile_chunk) and where its text
+// starts. A unit's text runs to the start of the next one, and the first
+// unit's from the start of the file.
+//
+// update() compares the new source with the last one that compiled. Only
+// the units the changed bytes touch are lexed, parsed and checked again,
+// from their text in the new source. Units after the edit keep their trees
+// and chunks; the chunks' locations move with the edit, the trees' stay
+// as they were parsed. When a function's signature changes, appears or
+// disappears, the units that name it are parsed and checked again too.
+// Signatures stay declared in one TypeChecker between updates.
+//
+// Chunks are compiled again for the units parsed again and for the callers
+// of a function whose result changed between built and unpacked tuples.
+// That is decided as find_unpacked_results decides it, from each unit's
+// ResultUses, kept per unit and combined again only for the names the edit
+// touched. When the list of function names changes, the other chunks'
+// calls are renumbered in place. link_chunks then joins every chunk, so
+// the bytecode is the same that Compiler::compile makes of the whole
+// source; that copy is the one step whose cost grows with the program
+// rather than with the edit.
+//
+// When the new source fails to parse or check, the errors are reported and
+// the server keeps the last program that compiled; the next update is
+// compared with that. The inliner (inliner.hpp) is not run, as it would
+// make callers' chunks depend on their callees' bodies.
+class CompileServer {
+public:
+    explicit CompileServer(std::string filename);
+
+    // Locations refer to the filename held here
+    CompileServer(const CompileServer&) = delete;
+    CompileServer& operator=(const CompileServer&) = delete;
+
+    auto update(std::string source) -> CompileUpdate;
+
+private:
+    struct Unit {
+        size_t offset = 0;        // Where its text starts in source_
+        size_t line = 1;          // The line that is on
+        std::string signature;    // Text from `function` to the body's `{`
+        std::unordered_set<std::string> references;  // Names the body mentions
+        ResultUses uses;          // Of its folded tree
+        Bytecode chunk;
+        ptrdiff_t offset_shift = 0;  // How far the text moved since it was parsed,
+        ptrdiff_t line_shift = 0;    // which the chunk's locations account for
+    };
+
+    // A unit parsed from the new source, not yet committed
+    struct Parsed {
+        std::unique_ptr<ast::FunctionDef> function;
+        Unit unit;
+    };
+
+    // Compiles `source` from scratch, as the first update does
+    auto rebuild(std::string source) -> CompileUpdate;
+
+    // Parses the units of `source` from `begin` up to `end`, the first one
+    // starting at `begin` on `line`
+    auto parse_units(const std::string& source, size_t begin, size_t end, size_t line,
+                     std::vector<Parsed>& parsed) const -> std::vector<ParseError>;
+
+    // Folds the units at `dirty` and compiles them and any others that need
+    // it: callers of a function in `touched` or the dirty units' uses whose
+    // result moved between built and unpacked. Returns the chunks compiled.
+    auto relink(const std::vector<size_t>& dirty, bool renamed, std::unordered_set<std::string> touched) -> size_t;
+
+    // Joins every unit's chunk into one program
+    auto link() const -> Bytecode;
+
+    std::string filename_;
+    std::string source_;  // The last source that compiled
+    std::unique_ptr<ast::Program> program_;  // One function per unit, in order
+    std::vector<Unit> units_;
+    std::unique_ptr<semantic::TypeChecker> globals_;  // Every signature declared
+    Compiler::FunctionTable functions_;
+    ProgramUses uses_;  // Every unit's uses
+    UnpackedResults unpacked_;
+};
+
+} // namespace lucid::backend
@@ -2,6 +2,7 @@
 
 #include <lucid/frontend/ast.hpp>
 #include <lucid/backend/bytecode.hpp>
+#include <lucid/backend/escape_analysis.hpp>
 #include <lucid/backend/value.hpp>
 #include <string>
 #include <vector>
@@ -19,6 +20,19 @@ public:
     // Main compilation entry point
     auto compile(ast::Program* program) -> Bytecode;
 
+    // Function name -> index in Bytecode::functions, as compile() numbers them
+    using FunctionTable = std::unordered_map<std::string, size_t>;
+    static auto function_table(const ast::Program& program) -> FunctionTable;
+
+    // Compiles one function into a chunk of its own (see link_chunks in
+    // parallel_compiler.hpp): code starting at offset 0 and ending in RETURN,
+    // its own constant pool and debug locations, and `functions` holding only
+    // this function followed by the lambdas it contains. Calls index
+    // `functions`, which must outlive the call; MAKE_CLOSURE indexes the
+    // chunk's own table. `unpacked` is find_unpacked_results of the program.
+    auto compile_chunk(ast::FunctionDef* function, const FunctionTable& functions,
+                       const UnpackedResults& unpacked = {}) -> Bytecode;
+
     // Expression visitors
     auto visit_int_literal(ast::IntLiteralExpr* expr) -> void override;
     auto visit_float_literal(ast::FloatLiteralExpr* expr) -> void override;
@@ -45,12 +59,17 @@ private:
     // Bytecode being built
     Bytecode bytecode_;
 
-    // Local variable scope tracking
-    struct Scope {
-        std::unordered_map<std::string, size_t> locals;  // name -> index
-        size_t local_count = 0;
+    // Locals of the function or lambda being compiled. Once the type
+    // checker has resolved it (a local_count is set), identifiers and
+    // patterns carry their slots and nothing is looked up here; a tree that
+    // was never checked is resolved by name, innermost declaration last.
+    struct Local {
+        std::string_view name;
+        size_t slot;
     };
-    std::vector<Scope> scopes_;
+    std::vector<Local> locals_;
+    size_t local_count_ = 0;
+    bool resolved_ = false;
 
     // Current function being compiled
     struct FunctionContext {
@@ -60,14 +79,41 @@ private:
     };
     FunctionContext* current_function_ = nullptr;
 
+    // Source location attributed to emitted instructions
+    SourceLocation current_location_{"", 0, 0, 0, 0};
+    class LocationScope;  // Sets current_location_ for the duration of a node
+
     // Function table (for Pass 1)
-    std::unordered_map<std::string, size_t> function_indices_;  // name -> index in bytecode.functions
+    FunctionTable function_indices_;  // name -> index in bytecode.functions
+    const FunctionTable* function_table_ = &function_indices_;  // Used to resolve calls
+
+    // Functions that return their tuple with RETURN_TUPLE (escape_analysis.hpp),
+    // and the size of that tuple while compiling one of them (0 otherwise)
+    UnpackedResults unpacked_results_;
+    size_t unpacked_result_ = 0;
+
+    // The body of the function or lambda being compiled. Values a `let`
+    // leaves on the stack there are discarded by the return; in any other
+    // block they would end up under the block's value.
+    const ast::Expr* function_body_ = nullptr;
+
+    // A lambda met while compiling a function. Its body is compiled into a
+    // function of its own once the enclosing function is done.
+    struct PendingLambda {
+        ast::LambdaExpr* lambda;
+        size_t func_idx;                     // Reserved in bytecode.functions
+        std::vector<std::string> captures;  // Enclosing locals, in parameter order,
+                                            // when resolved by name
+    };
+    std::vector<PendingLambda> pending_lambdas_;
 
     // Scope management
-    auto enter_scope() -> void;
-    auto exit_scope() -> void;
+    auto enter_scope(uint32_t local_count) -> void;  // A frame; kNoSlot if unresolved
+    auto exit_scope() -> size_t;                      // Returns the frame's local count
     auto declare_local(const std::string& name) -> size_t;  // Returns local index
+    auto declare_local(const ast::IdentifierPattern& pattern) -> size_t;
     auto resolve_local(const std::string& name) -> int;     // Returns -1 if not found
+    auto resolve_local(const ast::IdentifierExpr& identifier) -> int;
     auto resolve_function(const std::string& name) -> int;  // Returns -1 if not found
 
     // Bytecode emission helpers
@@ -75,6 +121,7 @@ private:
     auto emit(OpCode opcode, uint8_t operand) -> void;
     auto emit(OpCode opcode, uint16_t operand) -> void;
     auto emit(OpCode opcode, uint16_t operand1, uint8_t operand2) -> void;
+    auto record_location() -> void;  // Extend debug_locations over new bytes
 
     // Constant pool helpers
     auto add_constant(Value value) -> uint16_t;
@@ -85,10 +132,27 @@ private:
 
     // Two-pass compilation
     auto collect_functions(ast::Program* program) -> void;  // Pass 1
-    auto compile_function(ast::FunctionDef* function) -> void;  // Pass 2
+    auto compile_function(ast::FunctionDef* function, size_t func_idx) -> void;  // Pass 2
+    auto compile_lambda(const PendingLambda& pending) -> void;
 
     // Pattern compilation (for let statements)
     auto compile_pattern(ast::Pattern* pattern, bool is_declaration) -> void;
+
+    // Destructuring without a tuple: a tuple literal, or a call to a function
+    // in unpacked_results_, leaves its elements on the stack for the pattern
+    using SpreadValues = std::vector<const ast::Expr*>;
+    auto spreads(const ast::Expr* value, const ast::Pattern* pattern) -> bool;
+    auto push_spread(ast::Expr* value, ast::Pattern* pattern, SpreadValues& spread) -> void;
+    auto store_spread(ast::Expr* value, ast::Pattern* pattern, bool is_declaration,
+                      const SpreadValues& spread) -> void;
+    auto emit_return() -> void;  // RETURN, or RETURN_TUPLE in an unpacked function
+
+    // Tail position (the value of a `return`, through `if` branches and the
+    // last expression of a block): direct calls there become TAIL_CALL
+    auto compile_tail(ast::Expr* expr) -> void;
+    auto compile_call(ast::CallExpr* expr, bool tail) -> void;
+    auto compile_if(ast::IfExpr* expr, bool tail) -> void;
+    auto compile_block(ast::BlockExpr* expr, bool tail) -> void;
 };
 
 } // namespace lucid::backend
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <lucid/frontend/ast.hpp>
+#include <cstddef>
+
+namespace lucid::backend {
+
+// What a folding pass changed
+struct FoldStats {
+    size_t folded = 0;            // Operator expressions replaced by a literal
+    size_t branches_pruned = 0;   // `if`s with a literal condition resolved
+    size_t constant_literals = 0; // Tuple/list literals compiled as one constant
+};
+
+// AST-level constant folding, run between TypeChecker::check_program and
+// Compiler::compile.
+//
+// Rewrites the program in place:
+//   * unary and binary operators over literals become a literal, using the
+//     VM's arithmetic and comparison rules
+//   * `if` with a literal condition becomes the branch that is taken
+//   * tuple and list literals whose elements are all literals are marked
+//     is_constant, so the compiler loads them from the constant pool
+//
+// Anything the VM would reject or that is not exactly reproducible here
+// (division by zero, an out-of-range Int power, mixed-type ordering) is
+// left for run time, so folded programs fail the same way unfolded ones
+// do. Int arithmetic wraps on overflow, as VM::int_add and friends do.
+// Folded nodes keep the static type the checker recorded.
+auto fold_constants(ast::Program& program) -> FoldStats;
+
+// The same for one function, which touches nothing outside its body
+auto fold_constants(ast::FunctionDef& function) -> FoldStats;
+
+} // namespace lucid::backend
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <lucid/frontend/ast.hpp>
+#include <cstddef>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace lucid::backend {
+
+// Ahead-of-time backend: lowers a type-checked (and optionally constant
+// folded) program to a C++ translation unit, for lucidc --emit-cpp and
+// lucidc -c --aot.
+//
+// Parameters, locals and results the type checker proved Int, Float or Bool
+// become int64_t, double and bool variables, and arithmetic on them is plain
+// C++ arithmetic; calls between Lucid functions are direct C++ calls, and a
+// function's self tail calls become a loop. Strings, lists and tuples stay
+// runtime Values handled by the VM's own operations (aot_runtime.hpp), so a
+// program prints, fails and exits the same way it does under lucid-run.
+//
+// Lambdas and function values are not supported; emit() throws for them.
+class CppEmitter {
+public:
+    // C++ source for `program`, including an int main() when it has main()
+    auto emit(const ast::Program& program) -> std::string;
+
+    // Compiles emitted C++ into an executable at `output` with the C++
+    // compiler and lucid-core library of this build. Throws if the compiler
+    // cannot be run or fails.
+    static auto build_executable(const std::string& cpp_source, const std::string& output,
+                                 bool verbose) -> void;
+
+    // How the C++ compiler is invoked for `cpp_file` (for diagnostics)
+    static auto build_command(const std::string& cpp_file, const std::string& output) -> std::string;
+
+private:
+    // C++ representation of a Lucid value
+    enum class CType { Int, Float, Bool, Value };
+
+    // A C++ expression without side effects: a literal, variable or temporary
+    struct Operand {
+        std::string code;
+        CType type;
+    };
+
+    // Where the value of an if or block goes
+    struct Destination {
+        enum class Kind { Discard, Assign, Return } kind;
+        std::string variable;  // Assign
+        CType type;            // Assign, Return
+    };
+
+    struct Signature {
+        std::vector<CType> parameters;
+        CType result;
+    };
+
+    std::unordered_map<std::string, Signature> functions_;
+
+    // Per-function state
+    const ast::FunctionDef* current_ = nullptr;
+    std::vector<std::unordered_map<std::string, Operand>> scopes_;
+    std::ostringstream body_;
+    size_t indent_ = 0;
+    size_t next_temp_ = 0;
+    bool self_tail_call_ = false;
+
+    auto emit_function(const ast::FunctionDef& function) -> std::string;
+    auto signature(const ast::FunctionDef& function) -> std::string;
+    auto is_self_call(const ast::Expr& expr) const -> bool;
+
+    // Statements and control flow
+    auto line(const std::string& code) -> void;
+    auto emit_block(const ast::BlockExpr& block, const Destination& destination) -> void;
+    auto emit_if(const ast::IfExpr& expr, const Destination& destination) -> void;
+    auto emit_into(const ast::Expr& expr, const Destination& destination) -> void;
+    auto emit_stmt(const ast::Stmt& stmt) -> void;
+    auto emit_let(const ast::LetStmt& stmt) -> Operand;
+    auto emit_self_tail_call(const ast::CallExpr& expr) -> void;
+    auto bind_pattern(const ast::Pattern& pattern, const Operand& value) -> void;
+    auto deliver(const Operand& value, const Destination& destination) -> void;
+
+    // Expressions, lowered so every subexpression is evaluated into a
+    // temporary in source order
+    auto emit_expr(const ast::Expr& expr) -> Operand;
+    auto emit_binary(const ast::BinaryExpr& expr) -> Operand;
+    auto emit_unary(const ast::UnaryExpr& expr) -> Operand;
+    auto emit_call(const ast::CallExpr& expr) -> Operand;
+    auto emit_method_call(const ast::MethodCallExpr& expr) -> Operand;
+    auto emit_values(const std::vector<std::unique_ptr<ast::Expr>>& exprs) -> std::string;
+
+    static auto type_name(CType type) -> const char*;
+    auto temp(CType type, const std::string& init) -> Operand;
+    auto convert(const Operand& value, CType type) -> std::string;
+    auto unboxed(const std::string& value_code, const ast::Expr& expr) -> Operand;
+};
+
+} // namespace lucid::backend
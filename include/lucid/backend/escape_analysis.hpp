@@ -0,0 +1,56 @@
+#pragma once
+
+#include <lucid/frontend/ast.hpp>
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace lucid::backend {
+
+// Function name -> number of elements of the tuple it returns unpacked
+using UnpackedResults = std::unordered_map<std::string, size_t>;
+
+// Finds the functions whose tuple result never escapes, so the compiler can
+// return its elements on the operand stack (RETURN_TUPLE) instead of
+// building a tuple only for the caller to take it apart again.
+//
+// A function qualifies when
+//   * every value it returns is a tuple literal of the same size, whether
+//     through `return`, `if` branches or the last expression of a block, and
+//   * its name appears only as the callee of `let (a, b, ...) = f(...)`,
+//     with a pattern of that size: never passed, stored, returned or called
+//     in any other position, where a tuple value would be needed.
+//
+// The analysis looks at names only, so a local that shadows a function
+// counts as a use of it; that can only keep a function out.
+auto find_unpacked_results(const ast::Program& program) -> UnpackedResults;
+
+// What find_unpacked_results learns from one function, so CompileServer can
+// keep it per function and redo only the functions an edit touches
+struct ResultUses {
+    size_t result_size = 0;  // Of the tuple literals it returns, or zero
+    std::unordered_map<std::string, size_t> spread;  // Callee -> pattern size
+    std::unordered_set<std::string> escaping;        // Names used any other way
+};
+
+auto result_uses(const ast::FunctionDef& function) -> ResultUses;
+
+// The ResultUses of a whole program, combined as find_unpacked_results does
+class ProgramUses {
+public:
+    auto add(const ResultUses& uses) -> void { count(uses, 1); }
+    auto remove(const ResultUses& uses) -> void { count(uses, -1); }
+
+    // How a function with these uses returns its result: the elements
+    // unpacked (the tuple size), or zero for a tuple built as usual
+    auto unpacked_size(const std::string& name, const ResultUses& uses) const -> size_t;
+
+private:
+    auto count(const ResultUses& uses, int delta) -> void;
+
+    std::unordered_map<std::string, std::unordered_map<size_t, size_t>> spread_;  // Name -> size -> functions
+    std::unordered_map<std::string, size_t> escaping_;  // Name -> functions
+};
+
+} // namespace lucid::backend
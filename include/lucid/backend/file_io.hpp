@@ -0,0 +1,88 @@
+#pragma once
+
+#include <lucid/backend/value.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+namespace lucid::backend {
+
+// Keeps a file's bytes addressable for as long as anything refers to it:
+// Bytecode loaded from a file, or a String read_file returned. The bytes are
+// a read-only private mapping where the platform has mmap, so they cost no
+// copy and are paged in (and out) by the kernel as they are read.
+//
+// A mapping stays valid if the file is replaced (write_file renames a new
+// file over it) or appended to, but not if another process truncates it.
+class MappedFile {
+public:
+    // Throws std::runtime_error naming `what` ("bytecode file") on failure
+    explicit MappedFile(const std::string& filename, std::string_view what = "file");
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    auto operator=(const MappedFile&) -> MappedFile& = delete;
+
+    auto bytes() const -> std::span<const uint8_t> { return {data_, size_}; }
+    auto text() const -> std::string_view { return {reinterpret_cast<const char*>(data_), size_}; }
+
+private:
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+    std::vector<uint8_t> buffer_;  // Without mmap
+};
+
+struct FileCloser {
+    auto operator()(std::FILE* file) const -> void { std::fclose(file); }
+};
+
+// Reads a file a chunk at a time and splits it into lines, so a file of any
+// size is scanned in constant memory. Lines exclude their "\n" or "\r\n";
+// a last line without a newline still counts.
+class LineReader {
+public:
+    static constexpr size_t kChunkSize = 64 * 1024;
+
+    explicit LineReader(const std::string& filename);
+
+    auto is_open() const -> bool { return file_ != nullptr; }
+
+    // The next line, valid until the following call; false at end of file
+    auto next(std::string_view& line) -> bool;
+
+private:
+    std::unique_ptr<std::FILE, FileCloser> file_;
+    std::vector<char> buffer_;
+    size_t begin_ = 0;  // Unread bytes are buffer_[begin_, end_)
+    size_t end_ = 0;
+    bool at_eof_ = false;
+};
+
+// Writes `bytes` beside `filename` and renames the result over it, so a
+// reader never sees a half-written file and existing mappings keep the old
+// contents. On error the target is left as it was.
+auto replace_file(const std::string& filename, std::span<const uint8_t> bytes,
+                  bool executable = false) -> std::error_code;
+
+// ===== Builtins =====
+
+// read_file: the whole file, mapped rather than copied once it is large
+// enough for that to pay off. An empty String if it cannot be read.
+inline constexpr size_t kMapThreshold = 64 * 1024;
+auto read_file_value(const std::string& path) -> Value;
+
+// append_file keeps each file it appends to open, behind one buffer, until
+// something in this process reads or replaces a file, or until
+// flush_appended_files runs; the VM calls it when a top-level call returns,
+// and it runs at exit. Thread-safe, as worker VMs append too.
+inline constexpr size_t kMaxAppendedFiles = 16;
+auto append_to_file(const std::string& path, std::string_view content) -> bool;
+auto flush_appended_files() -> void;
+
+} // namespace lucid::backend
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <lucid/frontend/ast.hpp>
+#include <cstddef>
+
+namespace lucid::backend {
+
+// What an inlining pass changed
+struct InlineStats {
+    size_t inlined = 0;  // Calls replaced by the callee's body
+};
+
+// Callees of at most this many AST nodes are inlined
+inline constexpr size_t kMaxInlineNodes = 16;
+
+// AST-level inlining, run between TypeChecker::check_program and
+// fold_constants, so the folder sees through the calls it removes:
+// square(3) becomes 3 * 3 and then 9. lucidc runs it with -O, whose
+// peephole pass then fuses the inlined code with the caller's.
+//
+// A call by name is replaced by the callee's body when the callee
+//   * is small (kMaxInlineNodes) and does not call itself,
+//   * is a run of `let`s ending in its result, with no other `return`,
+//   * contains no lambdas,
+// and the caller declares none of the names the body refers to, so they
+// still mean what they meant in the callee. Literal and variable arguments
+// are substituted; any other argument is bound by a `let` first, in order,
+// so each is evaluated once. The callee's locals are renamed apart
+// ("square$1$x") and become locals of the caller's frame.
+//
+// Calls destructured by `let (a, b) = f()` are left to the escape analysis
+// (escape_analysis.hpp). Arguments whose static type differs from what the
+// callee recorded for the parameter are left alone too, as the compiler
+// picks type-specialised opcodes from those types. Inlined nodes keep the
+// static types the checker recorded.
+auto inline_functions(ast::Program& program) -> InlineStats;
+
+} // namespace lucid::backend
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <lucid/backend/bytecode.hpp>
+#include <lucid/backend/value.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace lucid::backend {
+
+// What the JIT did during VM::call_function
+struct JitStats {
+    size_t compiled = 0;        // Functions translated to native code
+    size_t rejected = 0;        // Hot functions the JIT cannot translate
+    uint64_t native_calls = 0;  // Interpreted calls that ran native code instead
+    uint64_t deopts = 0;        // Native calls abandoned and re-run by the interpreter
+};
+
+// Baseline JIT tier for the VM (x86-64, LUCID_JIT CMake option).
+//
+// The VM reports every interpreted CALL and TAIL_CALL here. Once a function
+// has been called `threshold` times it is compiled, specialised to the
+// argument types of that call, together with every function it calls. The
+// translation covers Int/Float/Bool constants and arithmetic, comparisons,
+// locals, jumps, direct calls and tail calls; a type analysis over the
+// bytecode proves every value is one of those scalars. Anything else
+// (collections, strings, methods, built-ins) leaves the function to the
+// interpreter.
+//
+// Compiled code has no side effects, so whenever it gets into a situation
+// the interpreter reports as an error (division by zero) or runs out of
+// native stack, it abandons the whole native call. The interpreter then runs
+// the call again from the start and produces the exact same result or error;
+// the function is not called natively again.
+//
+// Native execution is not counted by VM::instructions_executed() or the
+// opcode pair profile.
+class Jit {
+public:
+    static constexpr uint32_t kDefaultThreshold = 100;
+
+    Jit(const Bytecode& bytecode, uint32_t threshold, JitStats& stats);
+    ~Jit();
+
+    Jit(const Jit&) = delete;
+    auto operator=(const Jit&) -> Jit& = delete;
+
+    // Whether this build can generate native code
+    static auto available() -> bool;
+
+    // Count a call of functions[function_index] with `args`, compiling it once
+    // it is hot. Returns the result if native code ran the call, or nullopt
+    // if the interpreter has to. `frames_left` and `slots_left` are how many
+    // more frames and value stack slots (counting the arguments) the VM has.
+    auto call(size_t function_index, std::span<const Value> args, size_t frames_left, size_t slots_left)
+        -> std::optional<Value>;
+
+private:
+    struct Function;   // Per-function counters and native entry point
+    class CodeBlock;   // One mapping of executable memory
+
+    const Bytecode& bytecode_;
+    uint32_t threshold_;
+    JitStats& stats_;
+    std::vector<Function> functions_;
+    std::vector<std::unique_ptr<CodeBlock>> blocks_;
+
+    auto compile(size_t function_index, std::span<const Value> args) -> void;
+};
+
+} // namespace lucid::backend
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <lucid/backend/bytecode.hpp>
+#include <lucid/backend/value.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <span>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace lucid::backend {
+
+// The effectful builtin each function of `program` can reach, or an empty
+// view for the pure ones, indexed like program.functions (VM::set_memoized).
+//
+// print, println and the file builtins are effectful. A function reaches
+// what it calls with CALL or TAIL_CALL, and what the functions it names
+// with LOAD_GLOBAL or MAKE_CLOSURE reach, as it may call those values
+// through CALL_VALUE or a list method. The walk is over bytecode, so it
+// holds however the program was compiled or loaded. Function values that
+// come in as arguments are not covered: calls passing one are not cached.
+auto find_effects(const Bytecode& program) -> std::vector<std::string_view>;
+
+// Results of one function by argument values, least recently used first
+// to go once `capacity` are held.
+//
+// Arguments are hashed and compared by content: Ints, Bools and strings by
+// value, Floats by bit pattern (so 0.0 and -0.0 stay apart), lists and
+// tuples element by element.
+class MemoTable {
+public:
+    static constexpr size_t kDefaultCapacity = size_t{1} << 16;
+
+    struct Entry {
+        uint64_t hash;
+        std::vector<Value> args;
+        Value result;
+        bool unpacked;  // result holds the values of a RETURN_TUPLE
+    };
+
+    explicit MemoTable(size_t capacity = kDefaultCapacity) : capacity_(capacity) {}
+
+    // Whether calls with `args` can be cached: not when a function value is
+    // among them, at any depth
+    static auto cacheable(std::span<const Value> args) -> bool;
+
+    // The entry for `args`, which becomes the most recently used, or null
+    auto find(std::span<const Value> args) -> const Entry*;
+
+    // Caches `result` for `args` unless they are not cacheable
+    auto insert(std::span<const Value> args, Value result, bool unpacked) -> void;
+
+    auto size() const -> size_t { return entries_.size(); }
+    auto capacity() const -> size_t { return capacity_; }
+    auto clear() -> void;
+
+private:
+    using Entries = std::list<Entry>;  // Most recently used first
+
+    size_t capacity_;
+    Entries entries_;
+    std::unordered_multimap<uint64_t, Entries::iterator> index_;
+};
+
+} // namespace lucid::backend
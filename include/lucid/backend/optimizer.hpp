@@ -0,0 +1,38 @@
+#pragma once
+
+#include <lucid/backend/bytecode.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+
+namespace lucid::backend {
+
+// What a peephole pass changed
+struct OptimizeStats {
+    size_t bytes_before = 0;
+    size_t bytes_after = 0;
+    size_t fused = 0;           // Superinstructions formed
+    size_t removed = 0;         // Redundant or unreachable instructions dropped
+    size_t jumps_threaded = 0;  // Jumps retargeted past other jumps
+};
+
+// Peephole optimiser over compiled bytecode (lucidc -O).
+//
+// Rewrites the instruction stream in place:
+//   * threads jumps to jumps, and turns a jump to RETURN into RETURN
+//   * fuses the `JUMP_IF_FALSE; POP ... POP` shape emitted for `if` into
+//     POP_JUMP_IF_FALSE, and a comparison feeding it into
+//     COMPARE_JUMP_IF_FALSE
+//   * fuses LOAD_LOCAL pairs and LOAD_LOCAL; CONSTANT
+//   * drops DUP; POP and push-then-POP pairs, and unreachable code
+//
+// Never fuses across a jump target or function entry. Function offsets and
+// debug_locations are rewritten to match the new stream.
+auto optimize(Bytecode& bytecode) -> OptimizeStats;
+
+// The `limit` most frequent opcode pairs in a VM pair profile (see
+// VM::set_opcode_pair_profiling), one per line, most frequent first
+auto format_opcode_pairs(std::span<const uint64_t> counts, size_t limit = 20) -> std::string;
+
+} // namespace lucid::backend
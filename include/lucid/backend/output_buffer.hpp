@@ -0,0 +1,64 @@
+#pragma once
+
+#include <lucid/backend/value.hpp>
+#include <cstddef>
+#include <streambuf>
+#include <string>
+#include <string_view>
+
+namespace lucid::backend {
+
+// Where print and println write. Text collects in a buffer and reaches the
+// stream in large writes: when the buffer is full, on flush(), and when the
+// VM returns from a call into the program. Ints, floats and bools are
+// formatted straight into the buffer, without a temporary string.
+//
+// Writing to a terminal, the buffer is also flushed after every println, so
+// interactive output appears line by line.
+class OutputBuffer {
+public:
+    static constexpr size_t kDefaultCapacity = 64 * 1024;
+
+    explicit OutputBuffer(std::streambuf* sink, size_t capacity = kDefaultCapacity);
+    ~OutputBuffer() { flush(); }
+
+    OutputBuffer(const OutputBuffer&) = delete;
+    auto operator=(const OutputBuffer&) -> OutputBuffer& = delete;
+
+    // Flushes what is buffered for the old sink first
+    auto set_sink(std::streambuf* sink) -> void;
+    auto sink() const -> std::streambuf* { return sink_; }
+
+    // 0 writes every print through at once
+    auto set_capacity(size_t capacity) -> void;
+    auto capacity() const -> size_t { return capacity_; }
+
+    // Flush after every println; true by default exactly when the sink is a terminal
+    auto set_line_buffered(bool enabled) -> void { line_buffered_ = enabled; }
+    auto line_buffered() const -> bool { return line_buffered_; }
+
+    // print(value): strings without quotes, anything else as to_string()
+    auto print(const Value& value) -> void;
+    auto println(const Value& value) -> void;
+    auto write(std::string_view text) -> void;
+
+    auto flush() -> void;
+
+private:
+    std::streambuf* sink_;
+    std::string buffer_;
+    size_t capacity_;
+    bool line_buffered_;
+
+    // Into the buffer, without flushing it
+    auto append(const Value& value) -> void;
+    auto append_text(std::string_view text) -> void;
+
+    auto flush_if_full() -> void {
+        if (buffer_.size() >= capacity_) {
+            flush();
+        }
+    }
+};
+
+} // namespace lucid::backend
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <lucid/frontend/ast.hpp>
+#include <lucid/semantic/type_checker.hpp>
+#include <lucid/backend/bytecode.hpp>
+#include <lucid/backend/constant_folder.hpp>
+#include <lucid/backend/inliner.hpp>
+#include <lucid/backend/thread_pool.hpp>
+#include <optional>
+#include <vector>
+
+namespace lucid::backend {
+
+// What compile_parallel produced
+struct ParallelCompileResult {
+    std::vector<semantic::TypeError> errors;  // In the order check_program reports them
+    std::optional<Bytecode> bytecode;         // Set when there were no errors
+    FoldStats fold_stats;
+    InlineStats inline_stats;
+};
+
+// Phases 3-4 with one task per function (lucidc -j).
+//
+// Signatures are declared up front on the calling thread; after that each
+// function body is independent, so a task type-checks it against the shared
+// signatures. With `inline_calls`, inline_functions then runs over the whole
+// program on the calling thread. A second round of tasks folds each
+// function's constants; the escape analysis (find_unpacked_results) runs
+// over the whole program, and a third round compiles each function into a
+// chunk of its own (Compiler::compile_chunk). link_chunks then joins the
+// chunks in program order. The result is the same bytecode
+// TypeChecker::check_program, inline_functions, fold_constants and
+// Compiler::compile produce one after the other.
+auto compile_parallel(ast::Program& program, ThreadPool& pool, bool inline_calls = false)
+    -> ParallelCompileResult;
+
+// Concatenates chunks in program order into one program ending in HALT.
+// Function offsets are rebased and each chunk's constants are merged into
+// the shared pool, rewriting the indices that refer to them. Calls need no
+// patching: chunks index the program-wide function table already. Lambdas
+// are numbered after all named functions and MAKE_CLOSURE is renumbered.
+auto link_chunks(std::vector<Bytecode>& chunks) -> Bytecode;
+
+} // namespace lucid::backend
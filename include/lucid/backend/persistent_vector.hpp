@@ -0,0 +1,135 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+namespace lucid::backend {
+
+class Value;
+
+// Persistent vector backing Lucid's List type.
+//
+// A 32-way trie of full leaves plus a tail buffer holding the last 1..32
+// elements (the Clojure/Bagwell layout). Copies share all nodes; mutating
+// operations path-copy any node that is still shared with another vector and
+// update uniquely owned nodes in place, so:
+//
+//   * copy                      O(1)
+//   * push_back                 O(1) amortised
+//   * operator[]                O(log32 n)
+//   * pop_front (List.tail)     O(1), by advancing a start offset
+//   * append (List.concat)      O(m) in the length of the appended vector
+//
+// pop_front only hides the leading elements; their storage is released once
+// the whole vector is.
+class PersistentVector {
+public:
+    static constexpr unsigned kBits = 5;
+    static constexpr size_t kWidth = size_t{1} << kBits;  // 32
+    static constexpr size_t kMask = kWidth - 1;
+
+    class const_iterator;
+
+    PersistentVector() = default;
+    explicit PersistentVector(std::vector<Value> elements);
+    ~PersistentVector();
+
+    PersistentVector(const PersistentVector& other) noexcept;
+    PersistentVector(PersistentVector&& other) noexcept;
+    auto operator=(const PersistentVector& other) noexcept -> PersistentVector&;
+    auto operator=(PersistentVector&& other) noexcept -> PersistentVector&;
+
+    // Size
+    auto size() const -> size_t { return count_ - offset_; }
+    auto empty() const -> bool { return size() == 0; }
+
+    // Element access (unchecked)
+    auto operator[](size_t index) const -> const Value&;
+    auto front() const -> const Value& { return (*this)[0]; }
+    auto back() const -> const Value& { return (*this)[size() - 1]; }
+
+    // Modifiers
+    auto push_back(Value value) -> void;
+    auto pop_front() -> void;
+    auto append(const PersistentVector& other) -> void;
+    auto reverse() -> void;
+    auto clear() -> void;
+
+    // Iteration
+    auto begin() const -> const_iterator;
+    auto end() const -> const_iterator;
+
+    auto to_vector() const -> std::vector<Value>;
+
+    // Whether any node is shared with another vector (elements not included)
+    auto shares_storage() const -> bool;
+
+    auto operator==(const PersistentVector& other) const -> bool;
+    auto operator!=(const PersistentVector& other) const -> bool { return !(*this == other); }
+
+private:
+    struct Node;   // Refcount header shared by inner nodes and leaves
+    struct Inner;  // kWidth child pointers
+    struct Leaf;   // Up to kWidth values, stored inline after the header
+
+    size_t count_ = 0;        // Physical element count, including hidden ones
+    size_t offset_ = 0;       // Leading elements hidden by pop_front()
+    unsigned shift_ = kBits;  // Bit shift of the root level
+    Inner* root_ = nullptr;   // Trie of full leaves
+    Leaf* tail_ = nullptr;    // Last 1..kWidth physical elements
+
+    auto tail_offset() const -> size_t;
+    auto leaf_for(size_t physical) const -> const Leaf*;
+    auto push_tail(unsigned level, Inner* parent, Leaf* leaf) -> Inner*;
+
+    static auto new_path(unsigned level, Node* node) -> Node*;
+    static auto unique_inner(Inner* node) -> Inner*;
+    static auto release(Node* node, unsigned level) -> void;
+    static auto shares_node(const Node* node, unsigned level) -> bool;
+
+    static auto make_leaf(size_t capacity) -> Leaf*;
+    static auto copy_leaf(const Leaf* leaf, size_t capacity) -> Leaf*;
+    static auto destroy_leaf(Leaf* leaf) -> void;
+    static auto leaf_values(const Leaf* leaf) -> const Value*;
+
+    friend class const_iterator;
+};
+
+// Forward iterator that walks one leaf at a time
+class PersistentVector::const_iterator {
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Value;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const Value*;
+    using reference = const Value&;
+
+    const_iterator() = default;
+
+    auto operator*() const -> const Value& { return *current_; }
+    auto operator->() const -> const Value* { return current_; }
+    auto operator++() -> const_iterator&;
+    auto operator++(int) -> const_iterator {
+        auto copy = *this;
+        ++*this;
+        return copy;
+    }
+
+    auto operator==(const const_iterator& other) const -> bool { return index_ == other.index_; }
+    auto operator!=(const const_iterator& other) const -> bool { return index_ != other.index_; }
+
+private:
+    friend class PersistentVector;
+
+    const_iterator(const PersistentVector* vec, size_t index);
+    auto load_leaf() -> void;
+
+    const PersistentVector* vec_ = nullptr;
+    size_t index_ = 0;  // Logical index
+    const Value* current_ = nullptr;
+    const Value* leaf_end_ = nullptr;
+};
+
+} // namespace lucid::backend
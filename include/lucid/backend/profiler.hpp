@@ -0,0 +1,102 @@
+#pragma once
+
+#include <lucid/backend/bytecode.hpp>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace lucid::backend {
+
+// What VM::enable_profiling records
+struct ProfileOptions {
+    bool timing = true;            // Call counts, inclusive/exclusive time, opcode counts
+    uint32_t sample_interval = 0;  // Record the call stack every this many instructions (0 = never)
+};
+
+// Totals for one function of the profiled program
+struct FunctionProfile {
+    uint64_t calls = 0;
+    std::chrono::nanoseconds inclusive{0};  // With callees; recursive calls counted once
+    std::chrono::nanoseconds exclusive{0};  // In the function's own instructions
+};
+
+// Profile of the bytecode a VM runs (lucidc --profile, --profile-folded).
+//
+// The VM reports frame entries and exits, executed opcodes and sampling
+// points from a separate instantiation of its dispatch loop, so none of
+// this costs anything while profiling is off; the LUCID_PROFILER CMake
+// option removes it from the build. Time spent in built-ins and list
+// methods counts towards the function that called them. Samples are
+// taken every `sample_interval` instructions rather than on a timer, so
+// they need no signal handler and repeat exactly from run to run.
+class Profiler {
+public:
+    // Instructions between samples for lucidc --profile-folded
+    static constexpr uint32_t kDefaultSampleInterval = 1000;
+
+    explicit Profiler(ProfileOptions options);
+
+    auto options() const -> const ProfileOptions& { return options_; }
+
+    // Results, indexed like Bytecode::functions and OpCode
+    auto functions() const -> const std::vector<FunctionProfile>& { return functions_; }
+    auto opcode_counts() const -> const std::array<uint64_t, kOpCodeCount>& { return opcodes_; }
+    auto sample_count() const -> uint64_t { return sample_count_; }
+
+    // Per-function and per-opcode tables, hottest first
+    auto report(const Bytecode& bytecode, size_t limit = 20) const -> std::string;
+
+    // One "frame;frame;frame count" line per distinct sampled stack, outermost
+    // frame first, as flamegraph.pl and speedscope read them
+    auto folded_stacks() const -> std::string;
+
+    // ===== Recording (VM) =====
+
+    auto enter(size_t function) -> void;
+    auto leave() -> void;
+    // TAIL_CALL: the running function is replaced by `function`
+    auto replace(size_t function) -> void;
+    // Leave the open frames down to `depth` after an error unwound them
+    auto unwind(size_t depth) -> void;
+    auto depth() const -> size_t { return open_.size(); }
+
+    auto count(uint8_t opcode) -> void {
+        if (opcode < kOpCodeCount) {
+            ++opcodes_[opcode];
+        }
+    }
+
+    // Whether the instruction about to run is a sampling point
+    auto tick() -> bool {
+        if (options_.sample_interval == 0 || --until_sample_ > 0) {
+            return false;
+        }
+        until_sample_ = options_.sample_interval;
+        return true;
+    }
+    auto add_sample(const std::string& stack) -> void;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct OpenFrame {
+        size_t function;
+        Clock::time_point start;
+        std::chrono::nanoseconds callees{0};
+    };
+
+    ProfileOptions options_;
+    std::vector<FunctionProfile> functions_;
+    std::vector<uint32_t> active_;  // Open frames per function, for inclusive time
+    std::vector<OpenFrame> open_;
+    std::array<uint64_t, kOpCodeCount> opcodes_{};
+    uint32_t until_sample_;
+    uint64_t sample_count_ = 0;
+    std::unordered_map<std::string, uint64_t> samples_;
+};
+
+} // namespace lucid::backend
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace lucid::backend {
+
+// Work-stealing pool for data-parallel loops.
+//
+// parallel_for splits the index range into one contiguous run per thread.
+// Each thread takes indices from the front of its own run; a thread whose
+// run is empty steals from the back of another's, so uneven task costs
+// (one huge function among many small ones) still keep every core busy.
+// The calling thread works too, so a pool of size 1 has no threads of its
+// own and runs everything inline.
+class ThreadPool {
+public:
+    // `threads` workers including the caller; 0 means one per hardware thread
+    explicit ThreadPool(size_t threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    auto size() const -> size_t { return queues_.size(); }
+
+    // Runs task(i) for every i in [0, count) and returns when all are done.
+    // If tasks throw, the rest still run and the first exception is rethrown
+    // here. Not reentrant: tasks must not call parallel_for on this pool.
+    auto parallel_for(size_t count, const std::function<void(size_t)>& task) -> void;
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<size_t> indices;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues_;  // One per worker; 0 is the caller
+    std::vector<std::thread> threads_;
+
+    std::mutex mutex_;                 // Guards everything below
+    std::condition_variable wake_;     // A job started, or the pool is stopping
+    std::condition_variable done_;     // The job finished
+    const std::function<void(size_t)>* task_ = nullptr;
+    uint64_t generation_ = 0;          // Bumped per job
+    size_t active_ = 0;                // Workers inside the current job
+    std::exception_ptr error_;
+    bool stopping_ = false;
+    std::atomic<size_t> remaining_{0};  // Tasks of the current job not yet finished
+
+    auto worker_loop(size_t queue) -> void;
+    auto run_tasks(size_t queue, const std::function<void(size_t)>& task) -> void;
+    auto next_index(size_t queue, size_t& index) -> bool;
+};
+
+} // namespace lucid::backend
@@ -1,18 +1,29 @@
 #pragma once
 
+#include <lucid/backend/persistent_vector.hpp>
 #include <cstdint>
+#include <cstring>
 #include <memory>
+#include <span>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <variant>
 
+// Compact 16-byte Value layout with inline small strings. Selected with the
+// LUCID_COMPACT_VALUE CMake option; every translation unit must agree.
+#ifndef LUCID_COMPACT_VALUE
+#define LUCID_COMPACT_VALUE 0
+#endif
+
 namespace lucid::backend {
 
-// Forward declaration
+// Forward declarations
 class Value;
+class MappedFile;
 
-// Runtime value types
-enum class ValueType {
+// Runtime value types. Every type from String onwards may live on the heap.
+enum class ValueType : uint8_t {
     Int,
     Float,
     Bool,
@@ -22,27 +33,109 @@ enum class ValueType {
     Function,
 };
 
+// ===== Heap Objects =====
+//
+// Strings, lists, tuples and function references are immutable once shared,
+// so Values point at reference-counted heap objects and copying a Value is a
+// refcount bump. An object with a refcount of 1 has a single owner and may be
+// updated in place (see Value::is_unique()).
+
+struct HeapObject {
+    uint32_t refcount = 1;
+};
+
+// A flat string, or a rope node: the concatenation of two strings, held as
+// references to both halves and flattened into `value` the first time its
+// characters are read. Building a string piece by piece with `+` then costs
+// one node per piece and a single copy of the text at the end.
+//
+// read_file's Strings are a third kind: read-only views of a mapped file.
+struct StringObject : HeapObject {
+    mutable std::string value;             // The text, once flat
+    mutable StringObject* left = nullptr;  // Rope node: one reference to each half
+    mutable StringObject* right = nullptr;
+    std::shared_ptr<const MappedFile> mapping;  // Mapped: the text is the whole file
+    size_t length;                         // In bytes, flat or not
+
+    explicit StringObject(std::string v) : value(std::move(v)), length(value.size()) {}
+    // Takes over a reference to each half
+    StringObject(StringObject* l, StringObject* r) : left(l), right(r), length(l->length + r->length) {}
+    explicit StringObject(std::shared_ptr<const MappedFile> file);
+
+    StringObject(const StringObject&) = delete;
+    auto operator=(const StringObject&) -> StringObject& = delete;
+
+    auto is_rope() const -> bool { return left != nullptr; }
+
+    // The text; a rope node is flattened in place and lets go of its halves
+    auto text() const -> std::string_view;
+
+    // Appends the text without flattening or touching a refcount, so any
+    // number of threads may read the same rope this way at once
+    auto append_to(std::string& out) const -> void;
+
+    // Makes `value` hold the text, so it can be edited in place
+    auto own() -> std::string&;
+
+    // Frees an object whose refcount reached 0, and every half it was the
+    // last owner of. Iterative, as ropes can be millions of nodes deep.
+    static auto destroy(StringObject* object) -> void;
+};
+
+// Tuple storage
+struct ArrayObject : HeapObject {
+    std::vector<Value> elements;
+
+    explicit ArrayObject(std::vector<Value> elems);
+};
+
+// List storage: a persistent vector, so even shared lists copy in O(1)
+struct ListObject : HeapObject {
+    PersistentVector elements;
+
+    explicit ListObject(PersistentVector elems) : elements(std::move(elems)) {}
+};
+
+// A function reference. A closure also carries the values it captured; they
+// are passed after the call's own arguments (see Compiler::visit_lambda).
+struct FunctionObject : HeapObject {
+    size_t index;
+    std::string name;
+    std::vector<Value> captures;
+
+    FunctionObject(size_t idx, std::string n, std::vector<Value> captured);
+};
+
 // Runtime value representation
 class Value {
 public:
     // Constructors
-    Value();  // Default: Int(0)
-    explicit Value(int64_t value);
-    explicit Value(double value);
-    explicit Value(bool value);
+    Value() : type_(ValueType::Int), int_val(0) {}  // Default: Int(0)
+    explicit Value(int64_t value) : type_(ValueType::Int), int_val(value) {}
+    explicit Value(double value) : type_(ValueType::Float), float_val(value) {}
+    explicit Value(bool value) : type_(ValueType::Bool), bool_val(value) {}
     explicit Value(std::string value);
     explicit Value(std::vector<Value> elements, bool is_tuple = false);
+    explicit Value(PersistentVector elements);  // List
 
-    // Function value constructor
+    // Function value constructors
     static auto make_function(size_t function_index, std::string name) -> Value;
+    static auto make_closure(size_t function_index, std::string name, std::vector<Value> captures) -> Value;
+
+    // String `+`. Short results are copied; longer ones are a rope node
+    // sharing both operands (see StringObject).
+    static auto concat(const Value& a, const Value& b) -> Value;
+
+    // A String viewing a mapped file's bytes without copying them
+    static auto from_mapping(std::shared_ptr<const MappedFile> file) -> Value;
 
     // Destructor
-    ~Value();
+    ~Value() { release(); }
 
-    // Copy and move semantics
-    Value(const Value& other);
+    // Copy and move semantics. Copies share the heap object.
+    Value(const Value& other) noexcept;
     Value(Value&& other) noexcept;
-    auto operator=(const Value& other) -> Value&;
+    auto operator=(const Value& other) noexcept -> Value&;
     auto operator=(Value&& other) noexcept -> Value&;
 
     // Type checking
@@ -56,18 +149,42 @@ public:
     auto is_function() const -> bool { return type_ == ValueType::Function; }
 
     // Type conversions (with runtime checking)
-    auto as_int() const -> int64_t;
-    auto as_float() const -> double;
-    auto as_bool() const -> bool;
-    auto as_string() const -> const std::string&;
-    auto as_list() const -> const std::vector<Value>&;
+    auto as_int() const -> int64_t {
+        if (type_ != ValueType::Int) [[unlikely]] type_error("Int");
+        return int_val;
+    }
+    auto as_float() const -> double {
+        if (type_ != ValueType::Float) [[unlikely]] type_error("Float");
+        return float_val;
+    }
+    auto as_bool() const -> bool {
+        if (type_ != ValueType::Bool) [[unlikely]] type_error("Bool");
+        return bool_val;
+    }
+    auto as_string() const -> std::string_view;
+    auto string_length() const -> size_t;  // Without flattening a rope
+    auto as_list() const -> const PersistentVector&;
     auto as_tuple() const -> const std::vector<Value>&;
     auto as_function_index() const -> size_t;
-    auto as_function_name() const -> const std::string&;
+    auto as_function_name() const -> std::string_view;
+    auto as_captures() const -> std::span<const Value>;
 
-    // Mutable accessors (for collections)
-    auto as_list_mut() -> std::vector<Value>&;
+    // Mutable accessors (copy-on-write: a shared object is cloned first)
+    auto as_list_mut() -> PersistentVector&;
     auto as_tuple_mut() -> std::vector<Value>&;
+    auto as_string_mut() -> std::string&;
+
+    // A copy that shares no heap objects with this Value, for handing a
+    // value to another thread
+    auto deep_copy() const -> Value;
+
+    // Whether this Value, or anything it contains, shares a heap object
+    // with some other Value
+    auto shares_heap() const -> bool;
+
+    // Whether this Value is the only reference to its heap object.
+    // Inline values are always unique.
+    auto is_unique() const -> bool { return !owns_heap() || heap_->refcount == 1; }
 
     // Equality and comparison
     auto operator==(const Value& other) const -> bool;
@@ -84,26 +201,120 @@ public:
     auto to_string() const -> std::string;
     auto type_name() const -> std::string_view;
 
+    // Longest concatenation copied into a flat string rather than roped
+    static constexpr size_t kFlatConcatLength = 64;
+
+    // Longest string stored inline without a heap allocation
+#if LUCID_COMPACT_VALUE
+    static constexpr size_t kSmallStringCapacity = 14;
+#else
+    static constexpr size_t kSmallStringCapacity = 0;
+#endif
+    auto is_small_string() const -> bool;
+
 private:
+#if LUCID_COMPACT_VALUE
+    // 16-byte cell. Short strings are stored in the 14 bytes after the tag
+    // (small_head_ followed by the payload union); everything else uses the
+    // 8-byte payload. small_len_ is kHeapString for every non-inline string
+    // and for all other types.
+    //
+    //   [type_:1][small_len_:1][small_head_:6][payload:8]
+    static constexpr uint8_t kHeapString = 0xFF;
+    static constexpr size_t kSmallStringOffset = 2;
+
     ValueType type_;
+    uint8_t small_len_ = kHeapString;
+    char small_head_[6] = {};
+
+    auto small_data() -> char* { return reinterpret_cast<char*>(this) + kSmallStringOffset; }
+    auto small_data() const -> const char* {
+        return reinterpret_cast<const char*>(this) + kSmallStringOffset;
+    }
+#else
+    ValueType type_;
+#endif
 
     // Tagged union for value storage
     union {
         int64_t int_val;
         double float_val;
         bool bool_val;
-        std::string* string_val;              // Heap allocated
-        std::vector<Value>* list_val;         // Heap allocated
-        std::vector<Value>* tuple_val;        // Heap allocated
-        struct {
-            size_t index;
-            std::string* name;
-        } function_val;                       // Function reference
+        HeapObject* heap_;  // StringObject, ListObject, ArrayObject or FunctionObject
     };
 
-    // Helper methods
-    auto clear() -> void;  // Clean up heap-allocated data
-    auto copy_from(const Value& other) -> void;
+    auto owns_heap() const -> bool {
+#if LUCID_COMPACT_VALUE
+        return type_ >= ValueType::String && small_len_ == kHeapString;
+#else
+        return type_ >= ValueType::String;
+#endif
+    }
+
+    auto retain() const -> void {
+        if (owns_heap()) {
+            ++heap_->refcount;
+        }
+    }
+
+    auto release() -> void {
+        if (owns_heap() && --heap_->refcount == 0) {
+            destroy_heap();
+        }
+    }
+
+    // Bitwise copy of the whole cell; ownership is handled by the caller
+    auto raw_copy_from(const Value& other) -> void {
+        std::memcpy(static_cast<void*>(this), static_cast<const void*>(&other), sizeof(Value));
+    }
+
+    // Leave a moved-from Value as an inline Int that owns nothing
+    auto disown() -> void { type_ = ValueType::Int; }
+
+    [[noreturn]] auto type_error(std::string_view expected) const -> void;
+    auto destroy_heap() -> void;
+    auto make_unique_heap() -> void;
+    auto string_data() const -> std::string_view;
+    auto string_object() const -> StringObject*;  // A new reference; promotes inline strings
+    auto list() const -> const PersistentVector& { return static_cast<ListObject*>(heap_)->elements; }
+    auto tuple() const -> const std::vector<Value>& { return static_cast<ArrayObject*>(heap_)->elements; }
 };
 
+#if LUCID_COMPACT_VALUE
+static_assert(sizeof(Value) == 16, "compact Value must fit in 16 bytes");
+#endif
+
+inline ArrayObject::ArrayObject(std::vector<Value> elems) : elements(std::move(elems)) {}
+
+inline FunctionObject::FunctionObject(size_t idx, std::string n, std::vector<Value> captured)
+    : index(idx), name(std::move(n)), captures(std::move(captured)) {}
+
+inline Value::Value(const Value& other) noexcept {
+    raw_copy_from(other);
+    retain();
+}
+
+inline Value::Value(Value&& other) noexcept {
+    raw_copy_from(other);
+    other.disown();
+}
+
+inline auto Value::operator=(const Value& other) noexcept -> Value& {
+    if (this != &other) {
+        other.retain();
+        release();
+        raw_copy_from(other);
+    }
+    return *this;
+}
+
+inline auto Value::operator=(Value&& other) noexcept -> Value& {
+    if (this != &other) {
+        release();
+        raw_copy_from(other);
+        other.disown();
+    }
+    return *this;
+}
+
 } // namespace lucid::backend
@@ -1,7 +1,14 @@
 #pragma once
 
+#include <lucid/backend/builtin_methods.hpp>
 #include <lucid/backend/bytecode.hpp>
+#include <lucid/backend/jit.hpp>
+#include <lucid/backend/memo_table.hpp>
+#include <lucid/backend/output_buffer.hpp>
+#include <lucid/backend/profiler.hpp>
 #include <lucid/backend/value.hpp>
+#include <memory>
+#include <span>
 #include <vector>
 #include <string>
 #include <stdexcept>
@@ -10,29 +17,157 @@
 
 namespace lucid::backend {
 
-// Call frame for function invocations
+// Call frame for function invocations.
+//
+// Frames are windows into the VM's single value stack: the caller's
+// arguments become the first locals in place, the remaining locals are
+// reserved above them, and the operand stack of the frame grows on top.
+//
+//   stack_: [ ...caller... | arg0 .. argN-1 | local .. | operands .. ]
+//                            ^ stack_base
 struct CallFrame {
     size_t function_index;        // Index in bytecode function table
     size_t instruction_pointer;   // Current instruction offset in bytecode
-    size_t stack_base;            // Base of this frame's operands in stack
-    std::vector<Value> locals;    // Local variable storage
+    size_t stack_base;            // Stack slot of local 0
 
-    CallFrame(size_t func_idx, size_t ip, size_t base, size_t local_count)
+    CallFrame(size_t func_idx, size_t ip, size_t base)
         : function_index(func_idx)
         , instruction_pointer(ip)
         , stack_base(base)
-        , locals(local_count, Value(int64_t{0}))  // Initialize locals to 0
     {}
 };
 
+// A function of a loaded program, looked up once by VM::function() and then
+// called without a name lookup. Valid for every VM that loaded the program.
+struct FunctionHandle {
+    const Bytecode* program = nullptr;
+    size_t index = 0;
+    size_t param_count = 0;
+};
+
+// Instruction dispatch strategy used by VM::run()
+enum class DispatchMode : uint8_t {
+    Switch,    // Portable `switch` loop
+    Threaded,  // Computed-goto threaded code (GCC/Clang only)
+};
+
 // Stack-based virtual machine for bytecode execution
 class VM {
 public:
+    // Value stack slots, shared by all frames. Allocated once per VM.
+    static constexpr size_t kStackCapacity = size_t{1} << 16;
+    // Maximum call depth before "Call stack overflow" is raised.
+    static constexpr size_t kMaxCallDepth = size_t{1} << 14;
+
+    // List length from which par_map, par_filter and par_reduce use workers
+    static constexpr size_t kDefaultParallelThreshold = 4096;
+
     VM();
+    ~VM();
+
+    VM(const VM&) = delete;
+    VM& operator=(const VM&) = delete;
+
+    /**
+     * Whether this build supports threaded (computed-goto) dispatch.
+     * Controlled by the LUCID_THREADED_DISPATCH CMake option.
+     */
+    static auto threaded_dispatch_available() -> bool;
+
+    /**
+     * Select the dispatch strategy. Defaults to Threaded when available.
+     * @throws std::runtime_error if Threaded is requested but unavailable
+     */
+    auto set_dispatch_mode(DispatchMode mode) -> void;
+    auto dispatch_mode() const -> DispatchMode { return dispatch_mode_; }
+
+    /**
+     * Number of instructions executed since construction or the last reset.
+     */
+    auto instructions_executed() const -> uint64_t { return instructions_executed_; }
+    auto reset_instruction_count() -> void { instructions_executed_ = 0; }
+
+    /**
+     * Count how often each opcode is directly followed by another at run
+     * time, to choose superinstructions from real workloads. While enabled
+     * the VM uses the switch loop. Enabling clears previous counts.
+     */
+    auto set_opcode_pair_profiling(bool enabled) -> void;
+
+    /**
+     * Pair counts indexed by [first * kOpCodeCount + second]; empty unless
+     * profiling is enabled.
+     */
+    auto opcode_pair_counts() const -> std::span<const uint64_t> { return opcode_pairs_; }
+
+    /**
+     * Whether this build can compile hot functions to native code.
+     * Controlled by the LUCID_JIT CMake option (x86-64 only).
+     */
+    static auto jit_available() -> bool { return Jit::available(); }
+
+    /**
+     * Compile a function to native code once it has been called `threshold`
+     * times within one call_function (see jit.hpp). 0, the default, turns
+     * the JIT off.
+     * @throws std::runtime_error if a threshold is set but the JIT is unavailable
+     */
+    auto set_jit_threshold(uint32_t threshold) -> void;
+    auto jit_threshold() const -> uint32_t { return jit_threshold_; }
+
+    /**
+     * JIT activity since construction, summed over call_function calls.
+     */
+    auto jit_stats() const -> const JitStats& { return jit_stats_; }
+
+    /**
+     * Whether this build can profile programs.
+     * Controlled by the LUCID_PROFILER CMake option.
+     */
+    static auto profiling_available() -> bool;
+
+    /**
+     * Profile the following calls until disabled (see profiler.hpp). While
+     * enabled the VM uses the switch loop, the JIT stays off and par_* list
+     * methods run sequentially, so all time is spent in bytecode functions
+     * the profile can see. Enabling starts a fresh profile.
+     * @throws std::runtime_error if the build has no profiler
+     */
+    auto enable_profiling(ProfileOptions options = {}) -> void;
+    auto disable_profiling() -> void { profiler_.reset(); }
+    auto profiler() const -> const Profiler* { return profiler_.get(); }
+
+    /**
+     * List.par_map, par_filter and par_reduce split lists of at least
+     * `threshold` elements over `threads` worker VMs (0 = one per hardware
+     * thread), which start on first use and share this VM's program.
+     * Shorter lists, and all lists when `threshold` is 0, run sequentially
+     * like map and filter. Output the callbacks print is written in list
+     * order once all workers are done.
+     */
+    auto set_parallelism(size_t threshold, size_t threads = 0) -> void;
+    auto parallel_threshold() const -> size_t { return parallel_threshold_; }
+
+    /**
+     * Cache the results of the named functions, each in a MemoTable of
+     * `capacity` entries, so recursive definitions stop recomputing the
+     * same calls. Every one must be pure: reach no print, println or file
+     * builtin (find_effects). The caches last for one call into the
+     * program. The JIT stays off while functions are memoized, as its
+     * native code calls functions directly, and the par_* workers do not
+     * cache. An empty list turns memoisation off.
+     * @throws std::runtime_error from the next call if a name is not a
+     *         pure function of the program
+     */
+    auto set_memoized(std::vector<std::string> functions,
+                      size_t capacity = MemoTable::kDefaultCapacity) -> void;
+    auto memoized() const -> const std::vector<std::string>& { return memo_names_; }
 
     /**
      * Execute a specific function by name with arguments.
-     * This is the main entry point for execution.
+     * This is the main entry point for execution. The VM uses `bytecode`'s
+     * constants in place, so it must not run on several threads at once;
+     * load() it into a VM per thread instead.
      *
      * @param bytecode The bytecode to execute
      * @param function_name Name of function to call
@@ -44,83 +179,287 @@ public:
                       const std::string& function_name,
                       std::vector<Value> args) -> Value;
 
+    /**
+     * Bind a program for call(). The VM keeps `program` alive and copies
+     * its constant pool, so VMs that load the same Bytecode share nothing
+     * mutable and may run it on different threads at once without locks
+     * (see VMPool). The stacks are allocated once per VM and reused.
+     */
+    auto load(std::shared_ptr<const Bytecode> program) -> void;
+    auto program() const -> const std::shared_ptr<const Bytecode>& { return program_; }
+
+    /**
+     * Execute a function of the loaded program; otherwise like call_function.
+     * Built-in method names are resolved once per load rather than per call.
+     * @throws std::runtime_error if no program is loaded, or on execution errors
+     */
+    auto call(const std::string& function_name, std::vector<Value> args) -> Value;
+
+    /**
+     * Resolve a function of `program` (or of the loaded program) for the
+     * calls below.
+     * @throws std::runtime_error if there is no such function
+     */
+    static auto function(const Bytecode& program, const std::string& function_name) -> FunctionHandle;
+    auto function(const std::string& function_name) const -> FunctionHandle;
+
+    /**
+     * Call a resolved function of the loaded program. The arguments are
+     * copied straight onto the stack.
+     * @throws std::runtime_error if `function` belongs to another program,
+     *         or on execution errors
+     */
+    auto call(FunctionHandle function, std::span<const Value> args) -> Value;
+
+    /**
+     * Call `function` once per argument set and return the results in
+     * order. `args` holds the sets back to back, param_count values each.
+     * The stacks are reset and the JIT set up once for the whole batch, so
+     * each call costs little more than running the function's body. The
+     * first error stops the batch.
+     * @throws std::runtime_error as call(), or if `args` is not a whole
+     *         number of sets
+     */
+    auto call_batch(FunctionHandle function, std::span<const Value> args) -> std::vector<Value>;
+
     /**
      * Set custom output stream for print/println.
      * Defaults to std::cout.
      */
-    auto set_output_stream(std::ostream& os) -> void { output_stream_.rdbuf(os.rdbuf()); }
+    auto set_output_stream(std::ostream& os) -> void { output_.set_sink(os.rdbuf()); }
+
+    /**
+     * Bytes of print/println output held back before they are written
+     * (default OutputBuffer::kDefaultCapacity; 0 = write every call through).
+     * Whatever the size, output is written out when a call into the program
+     * returns, and after each println when the output is a terminal.
+     */
+    auto set_output_buffer_size(size_t bytes) -> void { output_.set_capacity(bytes); }
+
+    /**
+     * Write out buffered print/println output now.
+     */
+    auto flush_output() -> void { output_.flush(); }
 
     /**
      * Get captured output (for testing).
-     * Only works if a stringstream was set as output.
+     * Only works if use_output_buffer() was called.
      */
-    auto get_output() const -> std::string { return output_buffer_.str(); }
+    auto get_output() -> std::string {
+        output_.flush();
+        return output_buffer_.str();
+    }
 
     /**
      * Clear captured output buffer.
      */
-    auto clear_output() -> void { output_buffer_.str(""); output_buffer_.clear(); }
+    auto clear_output() -> void {
+        output_.flush();
+        output_buffer_.str("");
+        output_buffer_.clear();
+    }
 
     /**
      * Use internal buffer for output (for testing).
      */
-    auto use_output_buffer() -> void { output_stream_.rdbuf(output_buffer_.rdbuf()); }
+    auto use_output_buffer() -> void { output_.set_sink(output_buffer_.rdbuf()); }
+
+    // ===== Operations =====
+    //
+    // Semantics and error messages of the generic opcodes, for any operand
+    // types. Also used by the C++ that CppEmitter generates, so compiled
+    // programs behave exactly like interpreted ones.
+
+    // Int arithmetic, shared by every backend and the constant folder: it
+    // wraps on overflow, and x / -1 is -x and x % -1 is 0, so INT64_MIN / -1
+    // is INT64_MIN. The divisor of int_div and int_mod must not be zero.
+    static auto int_add(int64_t a, int64_t b) -> int64_t {
+        return static_cast<int64_t>(static_cast<uint64_t>(a) + static_cast<uint64_t>(b));
+    }
+    static auto int_sub(int64_t a, int64_t b) -> int64_t {
+        return static_cast<int64_t>(static_cast<uint64_t>(a) - static_cast<uint64_t>(b));
+    }
+    static auto int_mul(int64_t a, int64_t b) -> int64_t {
+        return static_cast<int64_t>(static_cast<uint64_t>(a) * static_cast<uint64_t>(b));
+    }
+    static auto int_negate(int64_t a) -> int64_t { return int_sub(0, a); }
+    static auto int_div(int64_t a, int64_t b) -> int64_t { return b == -1 ? int_negate(a) : a / b; }
+    static auto int_mod(int64_t a, int64_t b) -> int64_t { return b == -1 ? 0 : a % b; }
+
+    // Arithmetic operations
+    static auto binary_add(const Value& a, const Value& b) -> Value;
+    static auto binary_sub(const Value& a, const Value& b) -> Value;
+    static auto binary_mul(const Value& a, const Value& b) -> Value;
+    static auto binary_div(const Value& a, const Value& b) -> Value;
+    static auto binary_mod(const Value& a, const Value& b) -> Value;
+    static auto binary_pow(const Value& a, const Value& b) -> Value;
+
+    // Comparison operations
+    static auto binary_eq(const Value& a, const Value& b) -> Value;
+    static auto binary_ne(const Value& a, const Value& b) -> Value;
+    static auto binary_lt(const Value& a, const Value& b) -> Value;
+    static auto binary_gt(const Value& a, const Value& b) -> Value;
+    static auto binary_le(const Value& a, const Value& b) -> Value;
+    static auto binary_ge(const Value& a, const Value& b) -> Value;
+
+    // Logical operations
+    static auto binary_and(const Value& a, const Value& b) -> Value;
+    static auto binary_or(const Value& a, const Value& b) -> Value;
+    static auto unary_not(const Value& a) -> Value;
+
+    // Unary operations
+    static auto unary_negate(const Value& a) -> Value;
+    static auto unary_positive(const Value& a) -> Value;
+
+    // INDEX
+    static auto index_value(const Value& collection, const Value& index) -> Value;
+
+    // CALL_BUILTIN; print and println write to `out`. for_each_line needs
+    // a VM to run its callback and is not handled here.
+    static auto call_builtin(uint16_t builtin_id, std::vector<Value> args, OutputBuffer& out) -> Value;
 
 private:
     // Execution state
     const Bytecode* bytecode_;
-    std::vector<Value> stack_;        // Operand stack
+    const Value* constants_ = nullptr;  // bytecode_'s pool, or program_constants_
+    std::vector<Value> stack_;        // Locals and operands, never reallocated
     std::vector<CallFrame> call_stack_;  // Call frames
+    size_t return_depth_ = 0;         // run() returns once call_stack_ is this deep
+    DispatchMode dispatch_mode_;
+    uint64_t instructions_executed_ = 0;
+
+    // MethodId per constant index for CALL_METHOD (see builtin_methods.hpp)
+    static constexpr uint8_t kUnresolvedMethod = 0xFF;
+    static constexpr uint8_t kUnknownMethod = 0xFE;
+    std::vector<uint8_t> method_cache_;
+
+    // Opcode pair profile (empty when disabled)
+    std::vector<uint64_t> opcode_pairs_;
+
+    // Profile of the calls since enable_profiling (null when disabled)
+    std::unique_ptr<Profiler> profiler_;
+
+    // Native code tier; created per call_function when the threshold is set
+    uint32_t jit_threshold_ = 0;
+    std::unique_ptr<Jit> jit_;
+    JitStats jit_stats_;
+
+    // Memoized functions by name, and a cache per function of bytecode_
+    // for this call, null for the others; empty while memoisation is off
+    std::vector<std::string> memo_names_;
+    size_t memo_capacity_ = MemoTable::kDefaultCapacity;
+    const Bytecode* memo_bytecode_ = nullptr;  // What memo_ was resolved for
+    std::vector<std::unique_ptr<MemoTable>> memo_;
 
-    // Output stream for print/println (defaults to cout)
-    std::ostream output_stream_{std::cout.rdbuf()};
+    // Output of print/println (defaults to cout)
     std::stringstream output_buffer_;  // For testing
+    OutputBuffer output_{std::cout.rdbuf()};  // Declared after its possible sink
+
+    // Program bound by load(), with the VM's own copy of its constants
+    std::shared_ptr<const Bytecode> program_;
+    std::vector<Value> program_constants_;
+
+    // Calls the named function of bytecode_ with the stacks reset
+    auto execute(const std::string& function_name, std::vector<Value> args) -> Value;
+
+    // Bind program_ for a call() and check that `function` belongs to it
+    auto use_program() -> void;
+    auto use_program(const FunctionHandle& function) -> void;
+
+    // Empty the stacks and start a fresh JIT for a new top-level call
+    auto reset_execution() -> void;
+
+    // Drop what a failed call left on the stacks. The loaded-program entry
+    // points do this before rethrowing, so no copies of the caller's
+    // arguments or of this VM's constants outlive the call.
+    auto discard_stacks() -> void;
+
+    // A result of the loaded program for the caller, who may keep it after
+    // this VM moved to another thread: values sharing heap objects with
+    // program_constants_ are copied, as their refcounts belong to this VM
+    auto detach(Value result) const -> Value;
 
     // Main execution loop
     auto run() -> void;
+    template <bool Threaded, bool Profiled>
+    auto run_dispatch() -> void;
+
+    // Folded call stack for a profiler sample taken at `offset` in the
+    // current frame
+    auto sample_stack(size_t offset) -> std::string;
 
     // Current frame accessors
     auto current_frame() -> CallFrame&;
-    auto ip() -> size_t&;  // Instruction pointer reference
+
+    // Frame management
+    auto enter_frame(size_t func_idx, size_t arg_count) -> void;
+    auto reuse_frame(size_t func_idx, size_t arg_count) -> void;
+
+    // Offer a call to the JIT. On true, native code ran it and the result
+    // has replaced the arguments on the stack.
+    auto jit_call(size_t func_idx, size_t arg_count) -> bool;
+
+    // Resolve memo_names_ for bytecode_ if needed and empty the caches
+    auto reset_memo() -> void;
+
+    // Offer a call to func_idx's cache. On true, the cached result has
+    // replaced the arguments on the stack; with `spread`, as the values of a
+    // tuple the callee returned unpacked.
+    auto memo_lookup(size_t func_idx, size_t arg_count, bool spread) -> bool;
+
+    // Cache the current frame's result, about to be returned: the top value,
+    // or the top `unpacked` values for RETURN_TUPLE
+    auto memo_store(size_t unpacked) -> void;
+
+    // Calls through a function value (CALL_VALUE and the list methods). The
+    // arguments are on the stack; push_captures checks them against the
+    // callee, pushes its captured values after them and returns its index.
+    auto push_captures(const Value& callee, size_t arg_count) -> size_t;
+
+    // Runs `callee` on the arguments on top of the stack to completion in a
+    // nested run() and returns its result. Used from inside an instruction.
+    auto invoke(const Value& callee, size_t arg_count) -> Value;
+    auto invoke(size_t func_idx, size_t arg_count) -> Value;
+
+    // List.map, List.filter, List.fold and the par_* forms (see is_callback_method)
+    auto call_list_method(MethodId id, Value& receiver, std::span<Value> args) -> Value;
+
+    // The for_each_line builtin, which also calls back into the program
+    auto for_each_line(std::vector<Value>& args) -> Value;
+
+    // At the end of every call into the program, successful or not: write
+    // out buffered output and appended files
+    auto finish_call() -> void;
+
+    // Parallel list methods. Worker VMs never share a Value with this one or
+    // with each other: each share deep-copies the elements, the callback and
+    // the constants it uses, and results come back detached.
+    struct ParallelRuntime;
+    std::unique_ptr<ParallelRuntime> parallel_;
+    size_t parallel_threshold_ = kDefaultParallelThreshold;
+    size_t parallel_threads_ = 0;
+    bool is_worker_ = false;         // Runs shares; its own par_* stay sequential
+    uint64_t generation_ = 0;        // Bumped per top-level call
+    uint64_t bound_generation_ = 0;  // Worker: parent generation of program_constants_
+
+    auto call_list_parallel(MethodId id, const PersistentVector& elements, const Value& callback)
+        -> Value;
+    // On a worker: elements [begin, end) of a par_* call made by `parent`
+    auto run_share(const VM& parent, MethodId id, const Value& callback,
+                   const PersistentVector& elements, size_t begin, size_t end) -> std::vector<Value>;
 
     // Stack operations
     auto push(Value val) -> void;
     auto pop() -> Value;
     auto peek() const -> const Value&;
 
-    // Instruction reading
-    auto read_byte() -> uint8_t;
-    auto read_uint16() -> uint16_t;
+    // Fused compare-and-branch
+    static auto compare_ints(OpCode compare, int64_t a, int64_t b) -> bool;
+    static auto compare_values(OpCode compare, const Value& a, const Value& b) -> bool;
 
-    // Arithmetic operations
-    auto binary_add(const Value& a, const Value& b) -> Value;
-    auto binary_sub(const Value& a, const Value& b) -> Value;
-    auto binary_mul(const Value& a, const Value& b) -> Value;
-    auto binary_div(const Value& a, const Value& b) -> Value;
-    auto binary_mod(const Value& a, const Value& b) -> Value;
-    auto binary_pow(const Value& a, const Value& b) -> Value;
-
-    // Comparison operations
-    auto binary_eq(const Value& a, const Value& b) -> Value;
-    auto binary_ne(const Value& a, const Value& b) -> Value;
-    auto binary_lt(const Value& a, const Value& b) -> Value;
-    auto binary_gt(const Value& a, const Value& b) -> Value;
-    auto binary_le(const Value& a, const Value& b) -> Value;
-    auto binary_ge(const Value& a, const Value& b) -> Value;
-
-    // Logical operations
-    auto binary_and(const Value& a, const Value& b) -> Value;
-    auto binary_or(const Value& a, const Value& b) -> Value;
-    auto unary_not(const Value& a) -> Value;
-
-    // Unary operations
-    auto unary_negate(const Value& a) -> Value;
-    auto unary_positive(const Value& a) -> Value;
 
     // Built-in methods
-    auto call_builtin_method(const std::string& method,
-                            Value& object,
-                            std::vector<Value> args) -> Value;
+    auto resolve_method(uint16_t name_idx) -> uint8_t;
 };
 
 } // namespace lucid::backend
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <lucid/backend/bytecode.hpp>
+#include <lucid/backend/thread_pool.hpp>
+#include <lucid/backend/vm.hpp>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace lucid::backend {
+
+// A fixed set of VMs with one program loaded, for embedding Lucid in a
+// multi-threaded host.
+//
+// A worker thread acquires a VM, makes as many calls on it as it likes and
+// hands it back by dropping the Lease. Only acquiring and releasing take the
+// pool's lock; calls run on the leased VM alone (see VM::load), so call
+// throughput grows with the number of threads.
+class VMPool {
+public:
+    // `size` VMs, created up front; 0 means one per hardware thread
+    explicit VMPool(std::shared_ptr<const Bytecode> program, size_t size = 0);
+
+    VMPool(const VMPool&) = delete;
+    VMPool& operator=(const VMPool&) = delete;
+
+    // Exclusive use of one VM until destroyed
+    class Lease {
+    public:
+        Lease(Lease&& other) noexcept;
+        Lease& operator=(Lease&& other) noexcept;
+        ~Lease();
+
+        auto operator*() const -> VM& { return *vm_; }
+        auto operator->() const -> VM* { return vm_.get(); }
+
+    private:
+        friend class VMPool;
+        Lease(VMPool* pool, std::unique_ptr<VM> vm) : pool_(pool), vm_(std::move(vm)) {}
+
+        VMPool* pool_;
+        std::unique_ptr<VM> vm_;
+    };
+
+    // Takes an idle VM, waiting until another thread releases one if all
+    // are leased. The pool must outlive its leases.
+    auto acquire() -> Lease;
+
+    // A function of the pool's program, valid for all of its VMs
+    auto function(const std::string& function_name) const -> FunctionHandle {
+        return VM::function(*program_, function_name);
+    }
+
+    // VM::call_batch with the argument sets divided among `threads`. Each
+    // task copies its share of `args` (see Value::deep_copy), so the
+    // caller's values are never touched from two threads, and runs it on a
+    // leased VM. Results are in argument order.
+    auto call_batch(FunctionHandle function, std::span<const Value> args, ThreadPool& threads)
+        -> std::vector<Value>;
+
+    auto size() const -> size_t { return size_; }
+    auto program() const -> const std::shared_ptr<const Bytecode>& { return program_; }
+
+private:
+    std::shared_ptr<const Bytecode> program_;
+    size_t size_;
+
+    std::mutex mutex_;                  // Guards idle_
+    std::condition_variable released_;  // A VM came back to idle_
+    std::vector<std::unique_ptr<VM>> idle_;
+
+    auto release(std::unique_ptr<VM> vm) -> void;
+};
+
+} // namespace lucid::backend
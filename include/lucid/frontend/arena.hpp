@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace lucid {
+
+// ===== Arena =====
+
+// Bump allocator for the nodes of one compilation. Allocation is a pointer
+// increment into the current chunk; nothing is freed until the arena itself
+// is destroyed, which releases every chunk at once.
+class Arena {
+public:
+    Arena() = default;
+    ~Arena();
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    // `size` bytes aligned for any scalar type
+    auto allocate(size_t size) -> void*;
+
+    // Bytes handed out so far, and the chunks backing them
+    auto bytes_allocated() const -> size_t { return bytes_allocated_; }
+    auto chunk_count() const -> size_t { return chunks_.size(); }
+
+    // The arena ArenaNode allocations on this thread come from, if any
+    static auto current() -> Arena*;
+
+    static constexpr size_t kChunkSize = 64 * 1024;
+
+private:
+    friend class ArenaScope;
+
+    std::vector<std::unique_ptr<std::byte[]>> chunks_;
+    std::byte* next_ = nullptr;
+    std::byte* end_ = nullptr;
+    size_t bytes_allocated_ = 0;
+};
+
+// Makes `arena` current on this thread for the lifetime of the scope.
+// Everything allocated from it must be destroyed before the arena is.
+class ArenaScope {
+public:
+    explicit ArenaScope(Arena& arena);
+    ~ArenaScope();
+
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+
+private:
+    Arena* previous_;
+};
+
+// ===== Arena Nodes =====
+
+// Base for the AST nodes and semantic types. While an ArenaScope is active,
+// `new` places them in its arena and `delete` only runs the destructor;
+// outside one they come from the heap as usual. Either way they are owned
+// through std::unique_ptr, so code building or walking the tree does not
+// need to know which.
+class ArenaNode {
+public:
+    static auto operator new(size_t size) -> void*;
+    static auto operator delete(void* pointer) noexcept -> void;
+};
+
+} // namespace lucid
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <lucid/frontend/arena.hpp>
 #include <lucid/frontend/token.hpp>
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
@@ -58,11 +60,23 @@ enum class UnaryOp {
     Not, Neg, Pos
 };
 
+// Static type of an expression, recorded by the type checker so the code
+// generator can pick type-specialised opcodes. Only scalar types are tracked.
+enum class StaticType : uint8_t {
+    Unknown, Int, Float, Bool, String
+};
+
+// Slot of a local in the frame of the function or lambda that declares it,
+// recorded by the type checker so the code generator need not look names
+// up again. kNoSlot before checking, and for names that are not locals.
+inline constexpr uint32_t kNoSlot = UINT32_MAX;
+
 // Base class for all expressions
-class Expr {
+class Expr : public ArenaNode {
 public:
     ExprKind kind;
     SourceLocation location;
+    StaticType static_type = StaticType::Unknown;  // Set by the type checker
 
     explicit Expr(ExprKind kind, SourceLocation location)
         : kind(kind), location(location) {}
@@ -127,6 +141,8 @@ public:
 class IdentifierExpr : public Expr {
 public:
     std::string name;
+    NameId id = kNoName;      // Set by the parser
+    uint32_t slot = kNoSlot;  // Set by the type checker
 
     IdentifierExpr(std::string name, SourceLocation location)
         : Expr(ExprKind::Identifier, location), name(std::move(name)) {}
@@ -138,6 +154,7 @@ public:
 class TupleExpr : public Expr {
 public:
     std::vector<std::unique_ptr<Expr>> elements;
+    bool is_constant = false;  // Only literals inside; set by the constant folder
 
     TupleExpr(std::vector<std::unique_ptr<Expr>> elements, SourceLocation location)
         : Expr(ExprKind::Tuple, location), elements(std::move(elements)) {}
@@ -149,6 +166,7 @@ public:
 class ListExpr : public Expr {
 public:
     std::vector<std::unique_ptr<Expr>> elements;
+    bool is_constant = false;  // Only literals inside; set by the constant folder
 
     ListExpr(std::vector<std::unique_ptr<Expr>> elements, SourceLocation location)
         : Expr(ExprKind::List, location), elements(std::move(elements)) {}
@@ -232,8 +250,14 @@ public:
 class LambdaExpr : public Expr {
 public:
     std::vector<std::string> parameters;  // Untyped parameter names
+    std::vector<NameId> parameter_ids;    // Set by the parser
     std::unique_ptr<Expr> body;  // Expression or BlockExpr
 
+    // Set by the type checker: the enclosing slots copied into the closure,
+    // which follow the parameters in its frame, and the frame's size
+    std::vector<uint32_t> captures;
+    uint32_t local_count = kNoSlot;
+
     LambdaExpr(std::vector<std::string> parameters,
                std::unique_ptr<Expr> body, SourceLocation location)
         : Expr(ExprKind::Lambda, location), parameters(std::move(parameters)),
@@ -276,7 +300,7 @@ enum class StmtKind {
     ExprStmt,
 };
 
-class Stmt {
+class Stmt : public ArenaNode {
 public:
     StmtKind kind;
     SourceLocation location;
@@ -341,7 +365,7 @@ enum class PatternKind {
     Tuple,
 };
 
-class Pattern {
+class Pattern : public ArenaNode {
 public:
     PatternKind kind;
     SourceLocation location;
@@ -364,6 +388,8 @@ public:
 class IdentifierPattern : public Pattern {
 public:
     std::string name;
+    NameId id = kNoName;      // Set by the parser
+    uint32_t slot = kNoSlot;  // Set by the type checker
 
     IdentifierPattern(std::string name, SourceLocation location)
         : Pattern(PatternKind::Identifier, location), name(std::move(name)) {}
@@ -390,7 +416,7 @@ enum class TypeKind {
     Tuple,
 };
 
-class Type {
+class Type : public ArenaNode {
 public:
     TypeKind kind;
     SourceLocation location;
@@ -445,9 +471,10 @@ public:
 // ===== Function Definition =====
 
 // Function parameter
-class Parameter {
+class Parameter : public ArenaNode {
 public:
     std::string name;
+    NameId id = kNoName;  // Set by the parser
     std::unique_ptr<Type> type;
     SourceLocation location;
 
@@ -456,13 +483,14 @@ public:
 };
 
 // Function definition
-class FunctionDef {
+class FunctionDef : public ArenaNode {
 public:
     std::string name;
     std::vector<std::unique_ptr<Parameter>> parameters;
     std::unique_ptr<Type> return_type;
     std::unique_ptr<BlockExpr> body;
     SourceLocation location;
+    uint32_t local_count = kNoSlot;  // Frame size, set by the type checker
 
     FunctionDef(std::string name,
                 std::vector<std::unique_ptr<Parameter>> parameters,
@@ -476,7 +504,7 @@ public:
 
 // ===== Program (Top-level) =====
 
-class Program {
+class Program : public ArenaNode {
 public:
     std::vector<std::unique_ptr<FunctionDef>> functions;
     SourceLocation location;
@@ -542,4 +570,8 @@ auto unary_op_from_token(TokenType type) -> std::optional<UnaryOp>;
 auto binary_op_name(BinaryOp op) -> std::string_view;
 auto unary_op_name(UnaryOp op) -> std::string_view;
 
+// Every identifier `expr` mentions, the first of each name, in order of use.
+// Lambda bodies inside are included: what they capture, `expr` must hold.
+auto collect_identifiers(const Expr& expr, std::vector<const IdentifierExpr*>& identifiers) -> void;
+
 } // namespace lucid::ast
@@ -2,6 +2,7 @@
 
 #include <lucid/frontend/token.hpp>
 #include <string_view>
+#include <unordered_map>
 #include <vector>
 
 namespace lucid {
@@ -15,10 +16,18 @@ public:
      * @param filename The filename for error messages (default: "<input>")
      */
     explicit Lexer(std::string_view source, std::string_view filename = "<input>");
+
+    /**
+     * Construct a lexer that starts at byte `begin` of `source`, on line
+     * `line`. Tokens carry their locations in the whole source, so part of
+     * a file can be lexed again on its own (CompileServer).
+     */
+    Lexer(std::string_view source, std::string_view filename, size_t begin, size_t line);
     
     /**
      * Tokenize the entire source and return all tokens.
-     * Includes an EOF token at the end.
+     * Includes an EOF token at the end. The Parser pulls tokens through
+     * next_token() instead; this is for tests and tools.
      * 
      * @return Vector of all tokens
      */
@@ -39,10 +48,34 @@ public:
      * @return true if at end, false otherwise
      */
     auto is_at_end() const -> bool;
+    
+    // ===== Token details =====
+    
+    /**
+     * The source text of a token made by this lexer.
+     */
+    auto lexeme(const Token& token) const -> std::string_view;
+    
+    /**
+     * The full source location of a token made by this lexer.
+     */
+    auto location(const Token& token) const -> SourceLocation;
+    
+    /**
+     * The parsed value of a literal or Error token (token.has_literal()).
+     */
+    auto literal(const Token& token) const -> const Literal&;
+
+    /**
+     * The interned name of an Identifier token, kNoName for any other.
+     */
+    auto name(const Token& token) const -> NameId;
 
 private:
     std::string_view source_;
     std::string_view filename_;
+    std::vector<Literal> literals_;  // Side table indexed by Token::literal
+    std::unordered_map<std::string_view, NameId> names_;  // Identifiers seen, by text
     size_t current_ = 0;      // Current position in source
     size_t line_ = 1;         // Current line number (1-based)
     size_t line_start_ = 0;   // Byte offset of current line start
@@ -86,9 +119,9 @@ private:
     auto error_token(std::string_view message) -> Token;
     
     /**
-     * Get current source location for a token.
+     * Store a literal value, returning its index.
      */
-    auto current_location(size_t start_offset, size_t length) -> SourceLocation;
+    auto add_literal(Literal value) -> uint32_t;
     
     // ===== Scanning methods =====
     
@@ -3,6 +3,7 @@
 #include <lucid/frontend/ast.hpp>
 #include <lucid/frontend/lexer.hpp>
 #include <lucid/frontend/token.hpp>
+#include <array>
 #include <memory>
 #include <optional>
 #include <string>
@@ -37,11 +38,12 @@ public:
 class Parser {
 public:
     /**
-     * Construct a parser from a token stream.
+     * Construct a parser that pulls tokens from a lexer as it goes.
+     * Lexer errors are reported as parse errors.
      *
-     * @param tokens Token vector (must include EOF token at end)
+     * @param lexer Token source (must outlive the parser)
      */
-    explicit Parser(std::vector<Token> tokens);
+    explicit Parser(Lexer& lexer);
 
     /**
      * Parse the token stream into an AST.
@@ -58,41 +60,62 @@ public:
     auto parse_expression() -> std::unique_ptr<ast::Expr>;
 
 private:
-    std::vector<Token> tokens_;
-    size_t current_ = 0;
+    // Tokens are pulled on demand into a small ring holding the previous
+    // token, the current one and the lookahead
+    static constexpr size_t kTokenRingSize = 4;
+
+    Lexer& lexer_;
+    std::array<Token, kTokenRingSize> ring_{};
+    size_t current_ = 0;   // Index of the current token in the stream
+    size_t pulled_ = 0;    // Number of tokens pulled from the lexer so far
+    bool lexer_done_ = false;
+    bool lexer_failed_ = false;
     std::vector<ParseError> errors_;
 
     // ===== Token Stream Management =====
 
+    /**
+     * Pull tokens from the lexer until the token at `index` is in the ring.
+     * After an Eof or Error token the lexer is not called again.
+     */
+    auto fill(size_t index) -> void;
+
     /**
      * Get current token without consuming.
      */
-    auto peek() const -> const Token&;
+    auto peek() -> Token;
 
     /**
-     * Get token at offset from current without consuming.
+     * Get token at offset from current without consuming
+     * (offset < kTokenRingSize - 1).
      */
-    auto peek_ahead(size_t offset) const -> const Token&;
+    auto peek_ahead(size_t offset) -> Token;
 
     /**
      * Get previous token (already consumed).
      */
-    auto previous() const -> const Token&;
+    auto previous() const -> Token;
 
     /**
      * Consume and return current token.
      */
-    auto advance() -> const Token&;
+    auto advance() -> Token;
+
+    /**
+     * Source text and location of a token.
+     */
+    auto lexeme(const Token& token) const -> std::string_view;
+    auto location(const Token& token) const -> SourceLocation;
 
     /**
      * Check if current token matches type.
      */
-    auto check(TokenType type) const -> bool;
+    auto check(TokenType type) -> bool;
 
     /**
      * Check if current token matches any of the given types.
      */
-    auto check_any(std::initializer_list<TokenType> types) const -> bool;
+    auto check_any(std::initializer_list<TokenType> types) -> bool;
 
     /**
      * If current token matches, consume and return true.
@@ -107,7 +130,7 @@ private:
     /**
      * Check if at end of token stream.
      */
-    auto is_at_end() const -> bool;
+    auto is_at_end() -> bool;
 
     /**
      * Consume token and verify it matches expected type.
@@ -1,14 +1,14 @@
 #pragma once
 
 #include <cstddef>
-#include <optional>
+#include <cstdint>
 #include <string>
 #include <string_view>
 #include <variant>
 
 namespace lucid {
 
-enum class TokenType {
+enum class TokenType : uint8_t {
     // Keywords
     Function,
     Returns,
@@ -85,30 +85,35 @@ struct SourceLocation {
           offset(offset), length(length) {}
 };
 
+// Parsed value of a literal token, kept in the lexer's side table
+// - IntLiteral: int64_t
+// - FloatLiteral: double
+// - StringLiteral: std::string (after escape processing)
+// - Error: std::string (error message)
+using Literal = std::variant<int64_t, double, std::string>;
+
+// An identifier interned by the lexer: equal names lexed by one Lexer have
+// equal ids, so later passes compare them as integers
+using NameId = uint32_t;
+inline constexpr NameId kNoName = UINT32_MAX;
+
+// A token is a span of the source plus its position; its text, full
+// location and literal value are looked up through the Lexer that made it
+// (Lexer::lexeme, Lexer::location, Lexer::literal)
 struct Token {
-    TokenType type;
-    std::string_view lexeme;  // Zero-copy: points into source buffer
-    SourceLocation location;
-    
-    // For literals that need parsed values
-    // - IntLiteral: int64_t
-    // - FloatLiteral: double
-    // - StringLiteral: std::string (after escape processing)
-    // - Error: std::string (error message)
-    std::optional<std::variant<int64_t, double, std::string>> value;
-    
-    // Constructors
-    Token(TokenType type, std::string_view lexeme, SourceLocation location)
-        : type(type), lexeme(lexeme), location(location) {}
-    
-    Token(TokenType type, std::string_view lexeme, SourceLocation location, int64_t val)
-        : type(type), lexeme(lexeme), location(location), value(val) {}
-    
-    Token(TokenType type, std::string_view lexeme, SourceLocation location, double val)
-        : type(type), lexeme(lexeme), location(location), value(val) {}
-    
-    Token(TokenType type, std::string_view lexeme, SourceLocation location, std::string val)
-        : type(type), lexeme(lexeme), location(location), value(std::move(val)) {}
+    static constexpr uint32_t kNoLiteral = UINT32_MAX;
+
+    TokenType type = TokenType::Eof;
+    uint32_t offset = 0;               // Byte offset in source
+    uint32_t length = 0;               // Length of token in bytes
+    uint32_t line = 0;                 // 1-based
+    uint32_t column = 0;               // 1-based
+    uint32_t literal = kNoLiteral;     // Index into the lexer's literal table,
+                                       // or an Identifier's NameId
+
+    auto has_literal() const -> bool {
+        return literal != kNoLiteral && type != TokenType::Identifier;
+    }
 };
 
 // Utility function to get token type name for debugging/error messages
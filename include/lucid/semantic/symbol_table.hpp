@@ -1,6 +1,7 @@
 #pragma once
 
 #include <lucid/semantic/type_system.hpp>
+#include <lucid/frontend/ast.hpp>
 #include <lucid/frontend/token.hpp>
 #include <memory>
 #include <string>
@@ -25,14 +26,24 @@ class Symbol {
 public:
     std::string name;
     SymbolKind kind;
-    std::unique_ptr<SemanticType> type;
+    const SemanticType* type;
     SourceLocation location;
     bool is_mutable;  // For variables (let vs var - future feature)
+    NameId id = kNoName;           // Interned name, when the declaration had one
+    uint32_t slot = ast::kNoSlot;  // A local's slot in its frame (see SymbolTable)
 
+    // A symbol owning its type
     Symbol(std::string name, SymbolKind kind,
            std::unique_ptr<SemanticType> type,
            SourceLocation location, bool is_mutable = false)
-        : name(std::move(name)), kind(kind), type(std::move(type)),
+        : name(std::move(name)), kind(kind), type(type.get()),
+          location(location), is_mutable(is_mutable), owned_type_(std::move(type)) {}
+
+    // A symbol whose type lives elsewhere, usually in a TypeContext
+    Symbol(std::string name, SymbolKind kind,
+           const SemanticType* type,
+           SourceLocation location, bool is_mutable = false)
+        : name(std::move(name)), kind(kind), type(type),
           location(location), is_mutable(is_mutable) {}
 
     // Delete copy, allow move
@@ -40,6 +51,9 @@ public:
     Symbol& operator=(const Symbol&) = delete;
     Symbol(Symbol&&) = default;
     Symbol& operator=(Symbol&&) = default;
+
+private:
+    std::unique_ptr<SemanticType> owned_type_;
 };
 
 // ===== Scope =====
@@ -71,6 +85,13 @@ public:
                  std::unique_ptr<SemanticType> type,
                  SourceLocation location,
                  bool is_mutable = false) -> bool;
+    auto declare(std::string name, SymbolKind kind,
+                 const SemanticType* type,
+                 SourceLocation location,
+                 bool is_mutable = false) -> bool;
+
+    // Remove a symbol from this scope; false if it was not declared here
+    auto remove(const std::string& name) -> bool;
 
     // Lookup symbol in this scope only (no parent search)
     auto lookup_local(const std::string& name) -> Symbol*;
@@ -81,25 +102,48 @@ public:
 };
 
 // ===== Symbol Table =====
-
+//
+// Globals live in a Scope, found by hash. Locals live in one flat vector,
+// innermost last, and each scope entered records where its own begin;
+// leaving a scope truncates the vector. A local with an interned id is
+// found through a vector indexed by id, holding the innermost local of
+// each; one without, or a lookup by name alone, scans back by name.
+//
+// Each local takes the next slot of its frame, the innermost function or
+// lambda scope. Slots are not reused when a block ends.
 class SymbolTable {
 public:
     SymbolTable();
 
+    // A table whose outermost scope is `globals`, owned elsewhere. Scopes
+    // entered here are this table's own; `globals` is only searched.
+    explicit SymbolTable(Scope* globals);
+
     // Scope management
     auto enter_scope(Scope::ScopeKind kind) -> void;
     auto exit_scope() -> void;
-    auto current_scope() -> Scope*;
-    auto current_scope() const -> const Scope*;
+    auto current_kind() const -> Scope::ScopeKind;
+    auto globals() -> Scope*;
 
-    // Symbol operations
+    // Symbol operations; in the global scope these declare globals
     auto declare(std::string name, SymbolKind kind,
                  std::unique_ptr<SemanticType> type,
                  SourceLocation location,
                  bool is_mutable = false) -> bool;
+    auto declare(std::string name, SymbolKind kind,
+                 const SemanticType* type,
+                 SourceLocation location,
+                 bool is_mutable = false) -> bool;
+
+    // Declare a local in the current scope, which is not the global one.
+    // Null if the scope already has it; otherwise valid until the next
+    // declaration.
+    auto declare_local(std::string name, NameId id, SymbolKind kind,
+                       const SemanticType* type, SourceLocation location) -> const Symbol*;
 
     auto lookup(const std::string& name) -> Symbol*;
     auto lookup(const std::string& name) const -> const Symbol*;
+    auto lookup(NameId id, const std::string& name) const -> const Symbol*;
 
     // Check if symbol exists in current or parent scopes
     auto exists(const std::string& name) const -> bool;
@@ -110,9 +154,33 @@ public:
     // Get scope depth (0 = global, 1 = first nested scope, etc.)
     auto scope_depth() const -> size_t;
 
+    // Slots taken so far in the innermost function or lambda
+    auto frame_size() const -> uint32_t { return frame_size_; }
+
 private:
-    std::vector<std::unique_ptr<Scope>> scopes_;
-    Scope* current_;
+    struct Mark {
+        Scope::ScopeKind kind;
+        size_t first;         // Index of its first local in locals_
+        uint32_t frame_size;  // The enclosing frame's, restored on exit
+    };
+
+    static constexpr uint32_t kNone = UINT32_MAX;
+
+    struct Local {
+        Symbol symbol;
+        uint32_t shadowed;  // The innermost local with its id before it
+    };
+
+    auto find_local(NameId id, const std::string& name, size_t first) const -> const Symbol*;
+    auto push_local(Symbol symbol) -> Symbol*;
+
+    std::unique_ptr<Scope> owned_globals_;
+    Scope* globals_;
+    std::vector<Local> locals_;
+    std::vector<uint32_t> innermost_;  // By id: index in locals_, or kNone
+    size_t unnamed_ = 0;               // Locals in scope without an id
+    std::vector<Mark> marks_;
+    uint32_t frame_size_ = 0;
 };
 
 // ===== Symbol Table Utilities =====
@@ -7,6 +7,7 @@
 #include <vector>
 #include <string>
 #include <optional>
+#include <span>
 
 namespace lucid {
 namespace semantic {
@@ -43,11 +44,26 @@ class TypeChecker : public ast::ExprVisitor, public ast::StmtVisitor {
 public:
     TypeChecker();
 
+    // A checker for function bodies that runs alongside others: it sees the
+    // functions `globals` declared (declare_functions) and interns new types
+    // in a context of its own. `globals` must not change while it is in use.
+    explicit TypeChecker(TypeChecker* globals);
+
     // Main entry point - type check a program
     auto check_program(ast::Program& program) -> TypeCheckResult;
 
+    // First pass of check_program: declare every function's signature
+    auto declare_functions(ast::Program& program) -> void;
+
+    // One signature at a time, for a checker kept across edits
+    // (CompileServer). declare_function reports a name already declared and
+    // returns false; undeclare_function forgets one.
+    auto declare_function(ast::FunctionDef& func) -> bool;
+    auto undeclare_function(const std::string& name) -> void;
+
     // Type check individual nodes
-    auto check_expression(ast::Expr& expr) -> std::unique_ptr<SemanticType>;
+    // Returns the expression's type, interned in this checker's TypeContext
+    auto check_expression(ast::Expr& expr) -> const SemanticType*;
     auto check_statement(ast::Stmt& stmt) -> void;
     auto check_function(ast::FunctionDef& func) -> void;
 
@@ -76,16 +92,21 @@ public:
     // Get errors collected during type checking
     auto get_errors() const -> const std::vector<TypeError>& { return result_.errors; }
 
+    // Hands over the errors collected so far, leaving none
+    auto take_errors() -> std::vector<TypeError>;
+
 private:
+    TypeContext types_;
     SymbolTable symbol_table_;
     TypeEnvironment type_env_;
     TypeCheckResult result_;
 
     // Current expression type (set by visit methods)
-    std::unique_ptr<SemanticType> current_type_;
+    const SemanticType* current_type_ = nullptr;
 
     // Current function return type (for checking return statements)
-    SemanticType* current_function_return_type_;
+    const SemanticType* current_function_return_type_;
+    bool in_lambda_ = false;  // Checking a lambda body
 
     // Helper methods
     auto error(SourceLocation location, std::string message) -> void;
@@ -94,17 +115,26 @@ private:
                              const SemanticType& actual) -> void;
 
     // Convert AST type to semantic type
-    auto ast_type_to_semantic(const ast::Type& ast_type) -> std::unique_ptr<SemanticType>;
+    auto ast_type_to_semantic(const ast::Type& ast_type) -> const SemanticType*;
 
     // Type checking helpers
-    auto check_binary_arithmetic(ast::BinaryExpr* expr) -> std::unique_ptr<SemanticType>;
-    auto check_binary_comparison(ast::BinaryExpr* expr) -> std::unique_ptr<SemanticType>;
-    auto check_binary_logical(ast::BinaryExpr* expr) -> std::unique_ptr<SemanticType>;
-    auto check_unary_arithmetic(ast::UnaryExpr* expr) -> std::unique_ptr<SemanticType>;
-    auto check_unary_logical(ast::UnaryExpr* expr) -> std::unique_ptr<SemanticType>;
+    auto check_binary_arithmetic(ast::BinaryExpr* expr) -> const SemanticType*;
+    auto check_binary_comparison(ast::BinaryExpr* expr) -> const SemanticType*;
+    auto check_binary_logical(ast::BinaryExpr* expr) -> const SemanticType*;
+    auto check_unary_arithmetic(ast::UnaryExpr* expr) -> const SemanticType*;
+    auto check_unary_logical(ast::UnaryExpr* expr) -> const SemanticType*;
+    auto is_numeric(const SemanticType* type) const -> bool;
+
+    // Lambdas and function arguments. check_callback returns the result
+    // type of a function passed to a list method that calls it with
+    // arguments of `param_types`.
+    auto check_lambda(ast::LambdaExpr* expr, std::span<const SemanticType* const> param_types)
+        -> const SemanticType*;
+    auto check_callback(ast::Expr& argument, std::span<const SemanticType* const> param_types,
+                        const std::string& method) -> const SemanticType*;
 
     // Pattern checking
-    auto check_pattern(ast::Pattern& pattern, const SemanticType& expected_type) -> void;
+    auto check_pattern(ast::Pattern& pattern, const SemanticType* expected_type) -> void;
 };
 
 } // namespace semantic
@@ -1,7 +1,11 @@
 #pragma once
 
+#include <lucid/frontend/arena.hpp>
+#include <array>
 #include <memory>
+#include <span>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <optional>
 
@@ -24,7 +28,7 @@ enum class TypeKind {
 
 // ===== Base Type Class =====
 
-class SemanticType {
+class SemanticType : public ArenaNode {
 public:
     TypeKind kind;
 
@@ -170,6 +174,91 @@ auto types_compatible(const SemanticType& t1, const SemanticType& t2) -> bool;
 auto unify_types(const SemanticType& t1, const SemanticType& t2)
     -> std::optional<std::unique_ptr<SemanticType>>;
 
+// ===== Type Context =====
+
+// Interns the types of one compilation (hash-consing): structurally equal
+// types are the same object, so building a type allocates only the first
+// time its shape is seen, and comparing two interned types is a pointer
+// comparison. Interned types are immutable and live as long as the context.
+//
+// A context may extend a parent: types the parent already has are returned
+// from it and only new shapes are interned locally, so types from both stay
+// comparable by pointer. The parent is only read, so several children can
+// be used on different threads while it does not change.
+class TypeContext {
+public:
+    TypeContext();
+    explicit TypeContext(const TypeContext* parent);
+    ~TypeContext();
+
+    TypeContext(const TypeContext&) = delete;
+    TypeContext& operator=(const TypeContext&) = delete;
+
+    auto primitive(PrimitiveKind kind) const -> const SemanticType* {
+        return primitives_[static_cast<size_t>(kind)];
+    }
+    auto unknown() const -> const SemanticType* { return unknown_; }
+    auto list(const SemanticType* element) -> const SemanticType*;
+    auto tuple(std::span<const SemanticType* const> elements) -> const SemanticType*;
+    auto function(std::span<const SemanticType* const> params, const SemanticType* result)
+        -> const SemanticType*;
+    auto type_variable(const std::string& name) -> const SemanticType*;
+
+    // The interned type structurally equal to `type`
+    auto intern(const SemanticType& type) -> const SemanticType*;
+
+    // Components of an interned list, tuple or function type
+    static auto element_type(const SemanticType* list) -> const SemanticType*;
+    static auto element_types(const SemanticType* tuple) -> std::span<const SemanticType* const>;
+    static auto param_types(const SemanticType* function) -> std::span<const SemanticType* const>;
+    static auto return_type(const SemanticType* function) -> const SemanticType*;
+
+    // types_compatible and unify_types for interned types. Unknown still
+    // equals nothing, so a type containing it is never compatible; unify()
+    // returns nullptr where unify_types returns nullopt.
+    static auto compatible(const SemanticType* t1, const SemanticType* t2) -> bool;
+    auto unify(const SemanticType* t1, const SemanticType* t2) const -> const SemanticType*;
+
+    // Number of distinct types interned so far
+    auto size() const -> size_t { return types_.size(); }
+
+private:
+    // Tuples and functions, by kind and interned components (a function's
+    // result last)
+    struct Key {
+        TypeKind kind;
+        std::vector<const SemanticType*> components;
+    };
+    struct KeyView {
+        TypeKind kind;
+        std::span<const SemanticType* const> components;
+    };
+    struct KeyHash {
+        using is_transparent = void;
+        auto operator()(const KeyView& key) const -> size_t;
+        auto operator()(const Key& key) const -> size_t { return (*this)(view(key)); }
+    };
+    struct KeyEqual {
+        using is_transparent = void;
+        auto operator()(const KeyView& a, const KeyView& b) const -> bool;
+        auto operator()(const Key& a, const KeyView& b) const -> bool { return (*this)(view(a), b); }
+        auto operator()(const KeyView& a, const Key& b) const -> bool { return (*this)(a, view(b)); }
+        auto operator()(const Key& a, const Key& b) const -> bool { return (*this)(view(a), view(b)); }
+    };
+    static auto view(const Key& key) -> KeyView { return {key.kind, key.components}; }
+
+    const TypeContext* parent_ = nullptr;
+    std::vector<std::unique_ptr<SemanticType>> types_;
+    std::array<const SemanticType*, 4> primitives_{};
+    const SemanticType* unknown_ = nullptr;
+    std::unordered_map<const SemanticType*, const SemanticType*> lists_;
+    std::unordered_map<Key, const SemanticType*, KeyHash, KeyEqual> composites_;
+    std::unordered_map<std::string, const SemanticType*> variables_;
+
+    auto composite(TypeKind kind, std::span<const SemanticType* const> components)
+        -> const SemanticType*;
+};
+
 // ===== Type Environment =====
 
 class TypeEnvironment {
@@ -182,6 +271,9 @@ public:
     // Check if a name is a builtin type
     auto is_builtin(const std::string& name) const -> bool;
 
+    // The primitive a builtin type name denotes
+    auto builtin_kind(const std::string& name) const -> std::optional<PrimitiveKind>;
+
 private:
     // Store builtin type names (Int, Float, String, Bool)
     std::vector<std::string> builtin_names_;
@@ -0,0 +1,363 @@
+#include <lucid/backend/builtin_methods.hpp>
+#include <lucid/backend/vm.hpp>
+#include <fmt/format.h>
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cmath>
+#include <initializer_list>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace lucid::backend {
+
+namespace {
+
+// Indexed by MethodId
+constexpr std::array<std::string_view, kMethodCount> kMethodNames = {
+    "length", "append", "head", "tail", "is_empty", "reverse", "concat",
+    "contains", "starts_with", "ends_with", "to_upper", "to_lower", "trim",
+    "to_string", "abs", "floor", "ceil", "round", "sum", "join", "map", "filter", "fold",
+    "par_map", "par_filter", "par_reduce",
+};
+
+auto expect_no_args(std::span<Value> args, const char* method) -> void {
+    if (!args.empty()) {
+        throw std::runtime_error(fmt::format("{}() takes no arguments", method));
+    }
+}
+
+auto expect_string_arg(std::span<Value> args, const char* method) -> std::string_view {
+    if (args.size() != 1 || !args[0].is_string()) {
+        throw std::runtime_error(fmt::format("{}() takes 1 string argument", method));
+    }
+    return args[0].as_string();
+}
+
+// ===== List Methods =====
+
+auto list_length(Value& object, std::span<Value> args) -> Value {
+    expect_no_args(args, "List.length");
+    return Value(static_cast<int64_t>(object.as_list().size()));
+}
+
+auto list_append(Value& object, std::span<Value> args) -> Value {
+    if (args.size() != 1) {
+        throw std::runtime_error("List.append() takes exactly 1 argument");
+    }
+    // Lists are persistent: a shared receiver shares all but the updated
+    // path, a uniquely owned one is extended in place
+    object.as_list_mut().push_back(std::move(args[0]));
+    return std::move(object);
+}
+
+auto list_head(Value& object, std::span<Value> args) -> Value {
+    expect_no_args(args, "List.head");
+    const auto& list = object.as_list();
+    if (list.empty()) {
+        throw std::runtime_error("List.head() on empty list");
+    }
+    return list[0];
+}
+
+auto list_tail(Value& object, std::span<Value> args) -> Value {
+    expect_no_args(args, "List.tail");
+    if (object.as_list().empty()) {
+        throw std::runtime_error("List.tail() on empty list");
+    }
+    object.as_list_mut().pop_front();  // O(1) offset view
+    return std::move(object);
+}
+
+auto list_is_empty(Value& object, std::span<Value> args) -> Value {
+    expect_no_args(args, "List.is_empty");
+    return Value(object.as_list().empty());
+}
+
+auto list_reverse(Value& object, std::span<Value> args) -> Value {
+    expect_no_args(args, "List.reverse");
+    object.as_list_mut().reverse();
+    return std::move(object);
+}
+
+auto list_concat(Value& object, std::span<Value> args) -> Value {
+    if (args.size() != 1 || !args[0].is_list()) {
+        throw std::runtime_error("List.concat() takes 1 list argument");
+    }
+    if (object.as_list().empty()) {
+        return std::move(args[0]);
+    }
+    object.as_list_mut().append(args[0].as_list());
+    return std::move(object);
+}
+
+[[noreturn]] auto throw_sum_element(const Value& element) -> void {
+    throw std::runtime_error(fmt::format(
+        "List.sum() expects Int or Float elements, got {}", element.type_name()
+    ));
+}
+
+// sum(start) is what the compiler emits for `xs.sum()`: `start` is the zero
+// of the element type, so an empty List[Float] sums to 0.0. The running
+// total stays an unboxed int64_t or double for the whole loop.
+auto list_sum(Value& object, std::span<Value> args) -> Value {
+    if (args.size() > 1) {
+        throw std::runtime_error("List.sum() takes no arguments");
+    }
+    const auto& list = object.as_list();
+    const Value* start = args.empty() ? nullptr : &args[0];
+    const Value* first = start ? start : (list.empty() ? nullptr : &list.front());
+
+    if (first != nullptr && first->is_float()) {
+        double total = start ? start->as_float() : 0.0;
+        for (const Value& element : list) {
+            if (!element.is_float()) [[unlikely]] {
+                throw_sum_element(element);
+            }
+            total += element.as_float();
+        }
+        return Value(total);
+    }
+    if (first != nullptr && !first->is_int()) {
+        throw_sum_element(*first);
+    }
+    int64_t total = start ? start->as_int() : 0;
+    for (const Value& element : list) {
+        if (!element.is_int()) [[unlikely]] {
+            throw_sum_element(element);
+        }
+        total = VM::int_add(total, element.as_int());
+    }
+    return Value(total);
+}
+
+// join(separator) -> String: the elements with `separator` between them,
+// copied once into a buffer of the final size
+auto list_join(Value& object, std::span<Value> args) -> Value {
+    std::string_view separator = expect_string_arg(args, "List.join");
+    const auto& list = object.as_list();
+
+    size_t length = 0;
+    for (const Value& element : list) {
+        if (!element.is_string()) [[unlikely]] {
+            throw std::runtime_error(fmt::format(
+                "List.join() expects String elements, got {}", element.type_name()
+            ));
+        }
+        length += element.string_length() + separator.size();
+    }
+
+    std::string result;
+    result.reserve(length);
+    bool first = true;
+    for (const Value& element : list) {
+        if (!first) {
+            result += separator;
+        }
+        first = false;
+        result += element.as_string();
+    }
+    return Value(std::move(result));
+}
+
+// ===== Tuple Methods =====
+
+auto tuple_length(Value& object, std::span<Value> args) -> Value {
+    expect_no_args(args, "Tuple.length");
+    return Value(static_cast<int64_t>(object.as_tuple().size()));
+}
+
+// ===== String Methods =====
+
+auto string_length(Value& object, std::span<Value> args) -> Value {
+    expect_no_args(args, "String.length");
+    return Value(static_cast<int64_t>(object.string_length()));
+}
+
+auto string_is_empty(Value& object, std::span<Value> args) -> Value {
+    expect_no_args(args, "String.is_empty");
+    return Value(object.string_length() == 0);
+}
+
+auto string_contains(Value& object, std::span<Value> args) -> Value {
+    std::string_view needle = expect_string_arg(args, "String.contains");
+    return Value(object.as_string().find(needle) != std::string_view::npos);
+}
+
+auto string_starts_with(Value& object, std::span<Value> args) -> Value {
+    std::string_view prefix = expect_string_arg(args, "String.starts_with");
+    return Value(object.as_string().starts_with(prefix));
+}
+
+auto string_ends_with(Value& object, std::span<Value> args) -> Value {
+    std::string_view suffix = expect_string_arg(args, "String.ends_with");
+    return Value(object.as_string().ends_with(suffix));
+}
+
+auto string_to_upper(Value& object, std::span<Value> args) -> Value {
+    expect_no_args(args, "String.to_upper");
+    std::string result(object.as_string());
+    std::transform(result.begin(), result.end(), result.begin(),
+                  [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+    return Value(std::move(result));
+}
+
+auto string_to_lower(Value& object, std::span<Value> args) -> Value {
+    expect_no_args(args, "String.to_lower");
+    std::string result(object.as_string());
+    std::transform(result.begin(), result.end(), result.begin(),
+                  [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return Value(std::move(result));
+}
+
+auto string_trim(Value& object, std::span<Value> args) -> Value {
+    expect_no_args(args, "String.trim");
+    std::string_view str = object.as_string();
+    // Trim leading whitespace
+    auto start = str.find_first_not_of(" \t\n\r");
+    if (start == std::string_view::npos) {
+        return Value(std::string{});
+    }
+    // Trim trailing whitespace
+    auto end = str.find_last_not_of(" \t\n\r");
+    return Value(std::string(str.substr(start, end - start + 1)));
+}
+
+// ===== Int Methods =====
+
+auto int_to_string(Value& object, std::span<Value> args) -> Value {
+    expect_no_args(args, "Int.to_string");
+    return Value(std::to_string(object.as_int()));
+}
+
+auto int_abs(Value& object, std::span<Value> args) -> Value {
+    expect_no_args(args, "Int.abs");
+    int64_t val = object.as_int();
+    return Value(val < 0 ? -val : val);
+}
+
+// ===== Float Methods =====
+
+auto float_to_string(Value& object, std::span<Value> args) -> Value {
+    expect_no_args(args, "Float.to_string");
+    return Value(fmt::format("{}", object.as_float()));
+}
+
+auto float_abs(Value& object, std::span<Value> args) -> Value {
+    expect_no_args(args, "Float.abs");
+    return Value(std::abs(object.as_float()));
+}
+
+auto float_floor(Value& object, std::span<Value> args) -> Value {
+    expect_no_args(args, "Float.floor");
+    return Value(static_cast<int64_t>(std::floor(object.as_float())));
+}
+
+auto float_ceil(Value& object, std::span<Value> args) -> Value {
+    expect_no_args(args, "Float.ceil");
+    return Value(static_cast<int64_t>(std::ceil(object.as_float())));
+}
+
+auto float_round(Value& object, std::span<Value> args) -> Value {
+    expect_no_args(args, "Float.round");
+    return Value(static_cast<int64_t>(std::round(object.as_float())));
+}
+
+// ===== Dispatch Table =====
+
+using MethodRow = std::array<MethodFn, kMethodCount>;
+
+constexpr auto make_row(std::initializer_list<std::pair<MethodId, MethodFn>> entries) -> MethodRow {
+    MethodRow row{};
+    for (const auto& [id, fn] : entries) {
+        row[static_cast<size_t>(id)] = fn;
+    }
+    return row;
+}
+
+// Indexed by [ValueType][MethodId]; nullptr means "no such method"
+constexpr std::array<MethodRow, kValueTypeCount> kMethodTable = {
+    // Int
+    make_row({
+        {MethodId::TO_STRING, int_to_string},
+        {MethodId::ABS, int_abs},
+    }),
+    // Float
+    make_row({
+        {MethodId::TO_STRING, float_to_string},
+        {MethodId::ABS, float_abs},
+        {MethodId::FLOOR, float_floor},
+        {MethodId::CEIL, float_ceil},
+        {MethodId::ROUND, float_round},
+    }),
+    // Bool
+    MethodRow{},
+    // String
+    make_row({
+        {MethodId::LENGTH, string_length},
+        {MethodId::IS_EMPTY, string_is_empty},
+        {MethodId::CONTAINS, string_contains},
+        {MethodId::STARTS_WITH, string_starts_with},
+        {MethodId::ENDS_WITH, string_ends_with},
+        {MethodId::TO_UPPER, string_to_upper},
+        {MethodId::TO_LOWER, string_to_lower},
+        {MethodId::TRIM, string_trim},
+    }),
+    // List
+    make_row({
+        {MethodId::LENGTH, list_length},
+        {MethodId::APPEND, list_append},
+        {MethodId::HEAD, list_head},
+        {MethodId::TAIL, list_tail},
+        {MethodId::IS_EMPTY, list_is_empty},
+        {MethodId::REVERSE, list_reverse},
+        {MethodId::CONCAT, list_concat},
+        {MethodId::SUM, list_sum},
+        {MethodId::JOIN, list_join},
+    }),
+    // Tuple
+    make_row({
+        {MethodId::LENGTH, tuple_length},
+    }),
+    // Function
+    MethodRow{},
+};
+
+// Whether a receiver type has any methods at all (affects the error message)
+auto has_methods(ValueType type) -> bool {
+    const auto& row = kMethodTable[static_cast<size_t>(type)];
+    return std::any_of(row.begin(), row.end(), [](MethodFn fn) { return fn != nullptr; });
+}
+
+} // namespace
+
+auto method_id_from_name(std::string_view name) -> std::optional<MethodId> {
+    for (size_t i = 0; i < kMethodCount; ++i) {
+        if (kMethodNames[i] == name) {
+            return static_cast<MethodId>(i);
+        }
+    }
+    return std::nullopt;
+}
+
+auto method_name(MethodId id) -> std::string_view {
+    return kMethodNames[static_cast<size_t>(id)];
+}
+
+auto lookup_method(ValueType receiver, MethodId id) -> MethodFn {
+    return kMethodTable[static_cast<size_t>(receiver)][static_cast<size_t>(id)];
+}
+
+auto throw_unknown_method(std::string_view name, const Value& receiver) -> void {
+    if (has_methods(receiver.type())) {
+        throw std::runtime_error(fmt::format(
+            "Unknown method '{}' on {}", name, receiver.type_name()
+        ));
+    }
+    throw std::runtime_error(fmt::format(
+        "Cannot call method '{}' on {}", name, receiver.type_name()
+    ));
+}
+
+} // namespace lucid::backend
@@ -1,6 +1,13 @@
 #include <lucid/backend/bytecode.hpp>
+#include <lucid/backend/file_io.hpp>
 #include <lucid/backend/value.hpp>
 #include <fmt/format.h>
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <optional>
 #include <stdexcept>
 
 namespace lucid::backend {
@@ -31,8 +38,28 @@ auto opcode_name(OpCode opcode) -> std::string_view {
         case OpCode::NOT: return "NOT";
         case OpCode::NEGATE: return "NEGATE";
         case OpCode::POSITIVE: return "POSITIVE";
+        case OpCode::ADD_INT: return "ADD_INT";
+        case OpCode::SUB_INT: return "SUB_INT";
+        case OpCode::MUL_INT: return "MUL_INT";
+        case OpCode::DIV_INT: return "DIV_INT";
+        case OpCode::MOD_INT: return "MOD_INT";
+        case OpCode::ADD_FLOAT: return "ADD_FLOAT";
+        case OpCode::SUB_FLOAT: return "SUB_FLOAT";
+        case OpCode::MUL_FLOAT: return "MUL_FLOAT";
+        case OpCode::DIV_FLOAT: return "DIV_FLOAT";
+        case OpCode::EQ_INT: return "EQ_INT";
+        case OpCode::NE_INT: return "NE_INT";
+        case OpCode::LT_INT: return "LT_INT";
+        case OpCode::GT_INT: return "GT_INT";
+        case OpCode::LE_INT: return "LE_INT";
+        case OpCode::GE_INT: return "GE_INT";
+        case OpCode::LT_FLOAT: return "LT_FLOAT";
+        case OpCode::GT_FLOAT: return "GT_FLOAT";
+        case OpCode::LE_FLOAT: return "LE_FLOAT";
+        case OpCode::GE_FLOAT: return "GE_FLOAT";
         case OpCode::BUILD_LIST: return "BUILD_LIST";
         case OpCode::BUILD_TUPLE: return "BUILD_TUPLE";
+        case OpCode::UNPACK_TUPLE: return "UNPACK_TUPLE";
         case OpCode::INDEX: return "INDEX";
         case OpCode::CALL_METHOD: return "CALL_METHOD";
         case OpCode::CALL_BUILTIN: return "CALL_BUILTIN";
@@ -41,8 +68,16 @@ auto opcode_name(OpCode opcode) -> std::string_view {
         case OpCode::JUMP_IF_TRUE: return "JUMP_IF_TRUE";
         case OpCode::CALL: return "CALL";
         case OpCode::RETURN: return "RETURN";
+        case OpCode::RETURN_TUPLE: return "RETURN_TUPLE";
+        case OpCode::TAIL_CALL: return "TAIL_CALL";
+        case OpCode::MAKE_CLOSURE: return "MAKE_CLOSURE";
+        case OpCode::CALL_VALUE: return "CALL_VALUE";
         case OpCode::POP: return "POP";
         case OpCode::DUP: return "DUP";
+        case OpCode::LOAD_LOCAL2: return "LOAD_LOCAL2";
+        case OpCode::LOAD_LOCAL_CONST: return "LOAD_LOCAL_CONST";
+        case OpCode::POP_JUMP_IF_FALSE: return "POP_JUMP_IF_FALSE";
+        case OpCode::COMPARE_JUMP_IF_FALSE: return "COMPARE_JUMP_IF_FALSE";
         case OpCode::HALT: return "HALT";
     }
     return "UNKNOWN";
@@ -58,6 +93,8 @@ auto builtin_name(BuiltinId id) -> std::string_view {
         case BuiltinId::WRITE_FILE: return "write_file";
         case BuiltinId::APPEND_FILE: return "append_file";
         case BuiltinId::FILE_EXISTS: return "file_exists";
+        case BuiltinId::READ_LINES: return "read_lines";
+        case BuiltinId::FOR_EACH_LINE: return "for_each_line";
     }
     return "UNKNOWN_BUILTIN";
 }
@@ -90,6 +127,25 @@ auto opcode_operand_size(OpCode opcode) -> size_t {
         case OpCode::NOT:
         case OpCode::NEGATE:
         case OpCode::POSITIVE:
+        case OpCode::ADD_INT:
+        case OpCode::SUB_INT:
+        case OpCode::MUL_INT:
+        case OpCode::DIV_INT:
+        case OpCode::MOD_INT:
+        case OpCode::ADD_FLOAT:
+        case OpCode::SUB_FLOAT:
+        case OpCode::MUL_FLOAT:
+        case OpCode::DIV_FLOAT:
+        case OpCode::EQ_INT:
+        case OpCode::NE_INT:
+        case OpCode::LT_INT:
+        case OpCode::GT_INT:
+        case OpCode::LE_INT:
+        case OpCode::GE_INT:
+        case OpCode::LT_FLOAT:
+        case OpCode::GT_FLOAT:
+        case OpCode::LE_FLOAT:
+        case OpCode::GE_FLOAT:
         case OpCode::INDEX:
         case OpCode::RETURN:
         case OpCode::POP:
@@ -97,6 +153,10 @@ auto opcode_operand_size(OpCode opcode) -> size_t {
         case OpCode::HALT:
             return 0;
 
+        // 1-byte operand (uint8_t)
+        case OpCode::CALL_VALUE:
+            return 1;
+
         // 2-byte operand (uint16_t)
         case OpCode::CONSTANT:
         case OpCode::LOAD_LOCAL:
@@ -104,16 +164,27 @@ auto opcode_operand_size(OpCode opcode) -> size_t {
         case OpCode::LOAD_GLOBAL:
         case OpCode::BUILD_LIST:
         case OpCode::BUILD_TUPLE:
+        case OpCode::UNPACK_TUPLE:
+        case OpCode::RETURN_TUPLE:
         case OpCode::JUMP:
         case OpCode::JUMP_IF_FALSE:
         case OpCode::JUMP_IF_TRUE:
+        case OpCode::POP_JUMP_IF_FALSE:
             return 2;
 
         // 3-byte operand (uint16_t + uint8_t)
         case OpCode::CALL_METHOD:
         case OpCode::CALL_BUILTIN:
         case OpCode::CALL:
+        case OpCode::TAIL_CALL:
+        case OpCode::MAKE_CLOSURE:
+        case OpCode::COMPARE_JUMP_IF_FALSE:
             return 3;
+
+        // 4-byte operand (uint16_t + uint16_t)
+        case OpCode::LOAD_LOCAL2:
+        case OpCode::LOAD_LOCAL_CONST:
+            return 4;
     }
     return 0;
 }
@@ -143,13 +214,72 @@ auto Bytecode::emit(OpCode opcode, uint16_t operand1, uint8_t operand2) -> void
     instructions.push_back(operand2);
 }
 
+auto Bytecode::emit(OpCode opcode, uint16_t operand1, uint16_t operand2) -> void {
+    instructions.push_back(static_cast<uint8_t>(opcode));
+    // Little-endian encoding for both operands
+    instructions.push_back(static_cast<uint8_t>(operand1 & 0xFF));
+    instructions.push_back(static_cast<uint8_t>((operand1 >> 8) & 0xFF));
+    instructions.push_back(static_cast<uint8_t>(operand2 & 0xFF));
+    instructions.push_back(static_cast<uint8_t>((operand2 >> 8) & 0xFF));
+}
+
 // Add constant to pool
+namespace {
+
+// Exact identity of a constant: type tag plus representation. Floats use
+// their bit pattern so 0.0 and -0.0 stay apart and NaN matches itself.
+auto append_constant_key(std::string& key, const Value& value) -> void {
+    key += static_cast<char>(value.type());
+    auto append_u64 = [&key](uint64_t bits) {
+        key.append(reinterpret_cast<const char*>(&bits), sizeof(bits));
+    };
+    switch (value.type()) {
+        case ValueType::Int:
+            append_u64(static_cast<uint64_t>(value.as_int()));
+            break;
+        case ValueType::Float:
+            append_u64(std::bit_cast<uint64_t>(value.as_float()));
+            break;
+        case ValueType::Bool:
+            key += value.as_bool() ? '1' : '0';
+            break;
+        case ValueType::String:
+            append_u64(value.as_string().size());
+            key += value.as_string();
+            break;
+        case ValueType::List:
+        case ValueType::Tuple: {
+            size_t size = value.is_list() ? value.as_list().size() : value.as_tuple().size();
+            append_u64(size);
+            for (size_t i = 0; i < size; ++i) {
+                append_constant_key(key, value.is_list() ? value.as_list()[i] : value.as_tuple()[i]);
+            }
+            break;
+        }
+        case ValueType::Function:
+            append_u64(value.as_function_index());
+            break;
+    }
+}
+
+} // namespace
+
 auto Bytecode::add_constant(Value value) -> uint16_t {
+    std::string key;
+    append_constant_key(key, value);
+    // The pool is public; only trust an index entry that still matches
+    if (auto it = constant_index_.find(key); it != constant_index_.end()
+        && it->second < constants.size() && constants[it->second] == value) {
+        return it->second;
+    }
+
     constants.push_back(std::move(value));
     if (constants.size() > UINT16_MAX) {
         throw std::runtime_error("Too many constants");
     }
-    return static_cast<uint16_t>(constants.size() - 1);
+    auto index = static_cast<uint16_t>(constants.size() - 1);
+    constant_index_.insert_or_assign(std::move(key), index);
+    return index;
 }
 
 // Add function to table
@@ -204,12 +334,12 @@ auto Bytecode::disassemble(std::string_view name) const -> std::string {
     // Print instructions
     result += "\n=== Instructions ===\n";
     size_t offset = 0;
-    while (offset < instructions.size()) {
+    while (offset < code().size()) {
         auto line = disassemble_instruction(offset);
         result += line + "\n";
 
         // Advance offset
-        auto opcode = static_cast<OpCode>(instructions[offset]);
+        auto opcode = static_cast<OpCode>(code()[offset]);
         offset += 1 + opcode_operand_size(opcode);
     }
 
@@ -218,11 +348,12 @@ auto Bytecode::disassemble(std::string_view name) const -> std::string {
 
 // Disassemble single instruction
 auto Bytecode::disassemble_instruction(size_t offset) const -> std::string {
-    if (offset >= instructions.size()) {
+    const std::span<const uint8_t> bytes = code();
+    if (offset >= bytes.size()) {
         return fmt::format("{:04d}  ERROR: offset out of bounds", offset);
     }
 
-    auto opcode = static_cast<OpCode>(instructions[offset]);
+    auto opcode = static_cast<OpCode>(bytes[offset]);
     auto name = opcode_name(opcode);
 
     // Check if this is a function entry point
@@ -241,22 +372,30 @@ auto Bytecode::disassemble_instruction(size_t offset) const -> std::string {
         return fmt::format("{}{:04d}  {}", func_label, offset, name);
     }
 
+    if (operand_size == 1) {
+        if (offset + 1 >= bytes.size()) {
+            return fmt::format("{}{:04d}  {} ERROR: incomplete operand", func_label, offset, name);
+        }
+        return fmt::format("{}{:04d}  {} args: {}", func_label, offset, name, bytes[offset + 1]);
+    }
+
     if (operand_size == 2) {
-        if (offset + 2 >= instructions.size()) {
+        if (offset + 2 >= bytes.size()) {
             return fmt::format("{}{:04d}  {} ERROR: incomplete operand", func_label, offset, name);
         }
 
         // Read uint16_t operand (little-endian)
         uint16_t operand = static_cast<uint16_t>(
-            static_cast<uint16_t>(instructions[offset + 1]) |
-            (static_cast<uint16_t>(instructions[offset + 2]) << 8)
+            static_cast<uint16_t>(bytes[offset + 1]) |
+            (static_cast<uint16_t>(bytes[offset + 2]) << 8)
         );
 
         // Special formatting for specific opcodes
         if (opcode == OpCode::CONSTANT && operand < constants.size()) {
             return fmt::format("{}{:04d}  {} {} ({})",
                                func_label, offset, name, operand, constants[operand].to_string());
-        } else if (opcode == OpCode::JUMP || opcode == OpCode::JUMP_IF_FALSE || opcode == OpCode::JUMP_IF_TRUE) {
+        } else if (opcode == OpCode::JUMP || opcode == OpCode::JUMP_IF_FALSE || opcode == OpCode::JUMP_IF_TRUE ||
+                   opcode == OpCode::POP_JUMP_IF_FALSE) {
             // Interpret as signed offset
             int16_t signed_offset = static_cast<int16_t>(operand);
             int64_t target = static_cast<int64_t>(offset) + 3 + signed_offset;
@@ -268,16 +407,16 @@ auto Bytecode::disassemble_instruction(size_t offset) const -> std::string {
     }
 
     if (operand_size == 3) {
-        if (offset + 3 >= instructions.size()) {
+        if (offset + 3 >= bytes.size()) {
             return fmt::format("{}{:04d}  {} ERROR: incomplete operand", func_label, offset, name);
         }
 
         // Read uint16_t + uint8_t operands
         uint16_t operand1 = static_cast<uint16_t>(
-            static_cast<uint16_t>(instructions[offset + 1]) |
-            (static_cast<uint16_t>(instructions[offset + 2]) << 8)
+            static_cast<uint16_t>(bytes[offset + 1]) |
+            (static_cast<uint16_t>(bytes[offset + 2]) << 8)
         );
-        uint8_t operand2 = instructions[offset + 3];
+        uint8_t operand2 = bytes[offset + 3];
 
         if (opcode == OpCode::CALL_METHOD && operand1 < constants.size()) {
             return fmt::format("{}{:04d}  {} {} ({}), args: {}",
@@ -285,111 +424,640 @@ auto Bytecode::disassemble_instruction(size_t offset) const -> std::string {
         } else if (opcode == OpCode::CALL_BUILTIN) {
             return fmt::format("{}{:04d}  {} {} ({}), args: {}",
                                func_label, offset, name, operand1, builtin_name(static_cast<BuiltinId>(operand1)), operand2);
-        } else if (opcode == OpCode::CALL && operand1 < functions.size()) {
+        } else if ((opcode == OpCode::CALL || opcode == OpCode::TAIL_CALL) && operand1 < functions.size()) {
             return fmt::format("{}{:04d}  {} {} ({}), args: {}",
                                func_label, offset, name, operand1, functions[operand1].name, operand2);
+        } else if (opcode == OpCode::MAKE_CLOSURE && operand1 < functions.size()) {
+            return fmt::format("{}{:04d}  {} {} ({}), captures: {}",
+                               func_label, offset, name, operand1, functions[operand1].name, operand2);
+        } else if (opcode == OpCode::COMPARE_JUMP_IF_FALSE) {
+            int16_t signed_offset = static_cast<int16_t>(operand1);
+            int64_t target = static_cast<int64_t>(offset) + 4 + signed_offset;
+            return fmt::format("{}{:04d}  {} {} {} (to {})",
+                               func_label, offset, name, opcode_name(static_cast<OpCode>(operand2)),
+                               signed_offset, target);
         } else {
             return fmt::format("{}{:04d}  {} {}, {}", func_label, offset, name, operand1, operand2);
         }
     }
 
+    if (operand_size == 4) {
+        if (offset + 4 >= bytes.size()) {
+            return fmt::format("{}{:04d}  {} ERROR: incomplete operand", func_label, offset, name);
+        }
+
+        // Read two uint16_t operands
+        uint16_t operand1 = static_cast<uint16_t>(
+            static_cast<uint16_t>(bytes[offset + 1]) |
+            (static_cast<uint16_t>(bytes[offset + 2]) << 8)
+        );
+        uint16_t operand2 = static_cast<uint16_t>(
+            static_cast<uint16_t>(bytes[offset + 3]) |
+            (static_cast<uint16_t>(bytes[offset + 4]) << 8)
+        );
+
+        if (opcode == OpCode::LOAD_LOCAL_CONST && operand2 < constants.size()) {
+            return fmt::format("{}{:04d}  {} {}, {} ({})",
+                               func_label, offset, name, operand1, operand2, constants[operand2].to_string());
+        }
+        return fmt::format("{}{:04d}  {} {}, {}", func_label, offset, name, operand1, operand2);
+    }
+
     return fmt::format("{}{:04d}  {} UNKNOWN_OPERAND", func_label, offset, name);
 }
 
-// Generate C++ source code with embedded bytecode
-auto Bytecode::generate_executable_source() const -> std::string {
-    std::string source;
-
-    // Header
-    source += "#include <lucid/backend/vm.hpp>\n";
-    source += "#include <lucid/backend/value.hpp>\n";
-    source += "#include <lucid/backend/bytecode.hpp>\n";
-    source += "#include <vector>\n";
-    source += "#include <string>\n";
-    source += "#include <cstdint>\n";
-    source += "#include <iostream>\n\n";
-
-    source += "// Auto-generated LUCID bytecode executable\n\n";
-
-    // Embedded bytecode instructions
-    source += "static const uint8_t BYTECODE_INSTRUCTIONS[] = {\n    ";
-    for (size_t i = 0; i < instructions.size(); ++i) {
-        source += fmt::format("0x{:02x}", instructions[i]);
-        if (i < instructions.size() - 1) {
-            source += ", ";
-            if ((i + 1) % 16 == 0) source += "\n    ";
-        }
-    }
-    source += "\n};\n\n";
-
-    // Embedded constants
-    source += "static void init_constants(lucid::backend::Bytecode& bc) {\n";
-    for (const auto& constant : constants) {
-        if (constant.is_int()) {
-            source += fmt::format("    bc.add_constant(lucid::backend::Value(int64_t{{{}}}));\n",
-                                constant.as_int());
-        } else if (constant.is_float()) {
-            source += fmt::format("    bc.add_constant(lucid::backend::Value(double{{{}}}));\n",
-                                constant.as_float());
-        } else if (constant.is_string()) {
-            // Escape string properly
-            std::string escaped;
-            for (char c : constant.as_string()) {
-                if (c == '"') escaped += "\\\"";
-                else if (c == '\\') escaped += "\\\\";
-                else if (c == '\n') escaped += "\\n";
-                else if (c == '\t') escaped += "\\t";
-                else if (c == '\r') escaped += "\\r";
-                else escaped += c;
+// ===== Serialization =====
+//
+// File layout, all integers little-endian:
+//
+//   Header     "LUCIDBC\0", u32 format version, u32 reserved, u64 file size,
+//              u64 FNV-1a checksum of every byte after the header, then
+//              { u64 offset, u64 size } for each section below
+//   Code       the raw instruction stream, 64-byte aligned so it is
+//              executed straight out of the mapping
+//   Constants  u32 count, then values as { u8 ValueType, payload }
+//   Functions  u32 count, then { str name, u64 offset, u64 params, u64 locals }
+//   Debug      u32 count, str filenames, then u32 count runs of
+//              { u64 bytes, u32 filename, u64 line, u64 column, u64 offset,
+//              u64 length } covering the code; empty without debug info
+//   Tag        the raw bytes passed to save_to_file, often empty
+//
+// `str` is a u32 length followed by the bytes.
+//
+// save_as_executable appends an image to a copy of the lucid-run stub:
+//
+//   Stub       the runner executable, padded to kCodeAlignment
+//   Image      as above
+//   Trailer    u64 image offset, u64 image size, "LUCIDEXE"
+
+namespace {
+
+constexpr char kMagic[8] = {'L', 'U', 'C', 'I', 'D', 'B', 'C', '\0'};
+
+constexpr size_t kSectionCount = 5;  // Code, constants, functions, debug, tag
+constexpr size_t kHeaderSize = 8 + 4 + 4 + 8 + 8 + kSectionCount * 16;
+constexpr size_t kCodeAlignment = 64;
+
+constexpr char kPayloadMagic[8] = {'L', 'U', 'C', 'I', 'D', 'E', 'X', 'E'};
+constexpr size_t kTrailerSize = 8 + 8 + sizeof(kPayloadMagic);
+
+struct Payload {
+    size_t offset;
+    size_t size;
+};
+
+auto load_u64(const uint8_t* bytes) -> uint64_t {
+    uint64_t value = 0;
+    for (size_t i = 0; i < 8; ++i) {
+        value |= static_cast<uint64_t>(bytes[i]) << (8 * i);
+    }
+    return value;
+}
+
+// Where the trailer of an executable says its image is, if it has one
+auto find_payload(std::span<const uint8_t> file) -> std::optional<Payload> {
+    if (file.size() < kTrailerSize) {
+        return std::nullopt;
+    }
+    const uint8_t* trailer = file.data() + file.size() - kTrailerSize;
+    if (std::memcmp(trailer + 16, kPayloadMagic, sizeof(kPayloadMagic)) != 0) {
+        return std::nullopt;
+    }
+    uint64_t offset = load_u64(trailer);
+    uint64_t size = load_u64(trailer + 8);
+    const size_t limit = file.size() - kTrailerSize;
+    if (offset > limit || size != limit - offset) {
+        return std::nullopt;
+    }
+    return Payload{static_cast<size_t>(offset), static_cast<size_t>(size)};
+}
+
+auto fnv1a(std::span<const uint8_t> bytes) -> uint64_t {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (uint8_t byte : bytes) {
+        hash ^= byte;
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+class ImageWriter {
+public:
+    auto u8(uint8_t value) -> void { bytes_.push_back(value); }
+    auto u32(uint32_t value) -> void { put(value, 4); }
+    auto u64(uint64_t value) -> void { put(value, 8); }
+
+    auto str(std::string_view text) -> void {
+        if (text.size() > std::numeric_limits<uint32_t>::max()) {
+            throw std::runtime_error("String too long to serialize");
+        }
+        u32(static_cast<uint32_t>(text.size()));
+        bytes_.insert(bytes_.end(), text.begin(), text.end());
+    }
+
+    auto raw(std::span<const uint8_t> data) -> void {
+        bytes_.insert(bytes_.end(), data.begin(), data.end());
+    }
+
+    auto align(size_t alignment) -> void {
+        bytes_.resize((bytes_.size() + alignment - 1) / alignment * alignment, 0);
+    }
+
+    auto patch_u64(size_t offset, uint64_t value) -> void {
+        for (size_t i = 0; i < 8; ++i) {
+            bytes_[offset + i] = static_cast<uint8_t>(value >> (8 * i));
+        }
+    }
+
+    auto size() const -> size_t { return bytes_.size(); }
+    auto bytes() -> std::vector<uint8_t>& { return bytes_; }
+
+private:
+    std::vector<uint8_t> bytes_;
+
+    auto put(uint64_t value, size_t width) -> void {
+        for (size_t i = 0; i < width; ++i) {
+            bytes_.push_back(static_cast<uint8_t>(value >> (8 * i)));
+        }
+    }
+};
+
+// Bounds-checked cursor over one section
+class ImageReader {
+public:
+    ImageReader(std::span<const uint8_t> bytes, const char* section)
+        : bytes_(bytes), section_(section) {}
+
+    auto u8() -> uint8_t { return take(1)[0]; }
+    auto u32() -> uint32_t { return static_cast<uint32_t>(get(4)); }
+    auto u64() -> uint64_t { return get(8); }
+
+    auto str() -> std::string_view {
+        auto data = take(u32());
+        return {reinterpret_cast<const char*>(data.data()), data.size()};
+    }
+
+    auto size() -> size_t {
+        uint64_t value = u64();
+        if (value > std::numeric_limits<size_t>::max()) {
+            fail();
+        }
+        return static_cast<size_t>(value);
+    }
+
+    auto at_end() const -> bool { return position_ == bytes_.size(); }
+
+    [[noreturn]] auto fail() const -> void {
+        throw std::runtime_error(fmt::format("truncated or malformed {} section", section_));
+    }
+
+private:
+    std::span<const uint8_t> bytes_;
+    const char* section_;
+    size_t position_ = 0;
+
+    auto take(size_t count) -> std::span<const uint8_t> {
+        if (count > bytes_.size() - position_) {
+            fail();
+        }
+        auto data = bytes_.subspan(position_, count);
+        position_ += count;
+        return data;
+    }
+
+    auto get(size_t width) -> uint64_t {
+        auto data = take(width);
+        uint64_t value = 0;
+        for (size_t i = 0; i < width; ++i) {
+            value |= static_cast<uint64_t>(data[i]) << (8 * i);
+        }
+        return value;
+    }
+};
+
+auto write_value(ImageWriter& out, const Value& value) -> void {
+    out.u8(static_cast<uint8_t>(value.type()));
+    switch (value.type()) {
+        case ValueType::Int:
+            out.u64(static_cast<uint64_t>(value.as_int()));
+            break;
+        case ValueType::Float:
+            out.u64(std::bit_cast<uint64_t>(value.as_float()));
+            break;
+        case ValueType::Bool:
+            out.u8(value.as_bool() ? 1 : 0);
+            break;
+        case ValueType::String:
+            out.str(value.as_string());
+            break;
+        case ValueType::List:
+        case ValueType::Tuple: {
+            bool is_tuple = value.is_tuple();
+            size_t size = is_tuple ? value.as_tuple().size() : value.as_list().size();
+            out.u32(static_cast<uint32_t>(size));
+            for (size_t i = 0; i < size; ++i) {
+                write_value(out, is_tuple ? value.as_tuple()[i] : value.as_list()[i]);
             }
-            source += fmt::format("    bc.add_constant(lucid::backend::Value(std::string{{\"{}\"}}));\n",
-                                escaped);
-        } else if (constant.is_bool()) {
-            source += fmt::format("    bc.add_constant(lucid::backend::Value({}));\n",
-                                constant.as_bool() ? "true" : "false");
+            break;
         }
+        case ValueType::Function:
+            out.u64(value.as_function_index());
+            break;
     }
-    source += "}\n\n";
+}
 
-    // Embedded functions
-    source += "static void init_functions(lucid::backend::Bytecode& bc) {\n";
-    for (const auto& func : functions) {
-        // Escape function name
-        std::string escaped_name;
-        for (char c : func.name) {
-            if (c == '"') escaped_name += "\\\"";
-            else if (c == '\\') escaped_name += "\\\\";
-            else escaped_name += c;
-        }
-        source += fmt::format("    bc.add_function(\"{}\", {}, {}, {});\n",
-                            escaped_name, func.offset, func.param_count, func.local_count);
-    }
-    source += "}\n\n";
-
-    // Main function
-    source += "int main() {\n";
-    source += "    try {\n";
-    source += "        // Reconstruct bytecode\n";
-    source += "        lucid::backend::Bytecode bytecode;\n";
-    source += "        bytecode.instructions.assign(BYTECODE_INSTRUCTIONS, \n";
-    source += "                                    BYTECODE_INSTRUCTIONS + sizeof(BYTECODE_INSTRUCTIONS));\n";
-    source += "        init_constants(bytecode);\n";
-    source += "        init_functions(bytecode);\n\n";
-    source += "        // Execute main function\n";
-    source += "        lucid::backend::VM vm;\n";
-    source += "        auto result = vm.call_function(bytecode, \"main\", {});\n\n";
-    source += "        // Return exit code\n";
-    source += "        if (result.is_int()) {\n";
-    source += "            return static_cast<int>(result.as_int());\n";
-    source += "        }\n";
-    source += "        return 0;\n";
-    source += "    } catch (const std::exception& e) {\n";
-    source += "        std::cerr << \"Runtime error: \" << e.what() << std::endl;\n";
-    source += "        return 1;\n";
-    source += "    }\n";
-    source += "}\n";
-
-    return source;
+// Deeper constants are rejected rather than risk the reader's stack
+constexpr size_t kMaxConstantDepth = 256;
+
+auto read_value(ImageReader& in, size_t depth = 0) -> Value {
+    uint8_t tag = in.u8();
+    switch (static_cast<ValueType>(tag)) {
+        case ValueType::Int:
+            return Value(static_cast<int64_t>(in.u64()));
+        case ValueType::Float:
+            return Value(std::bit_cast<double>(in.u64()));
+        case ValueType::Bool:
+            return Value(in.u8() != 0);
+        case ValueType::String:
+            return Value(std::string(in.str()));
+        case ValueType::List:
+        case ValueType::Tuple: {
+            if (depth == kMaxConstantDepth) {
+                throw std::runtime_error(fmt::format("constant nested deeper than {} levels", kMaxConstantDepth));
+            }
+            uint32_t size = in.u32();
+            std::vector<Value> elements;
+            for (uint32_t i = 0; i < size; ++i) {
+                elements.push_back(read_value(in, depth + 1));
+            }
+            return Value(std::move(elements), static_cast<ValueType>(tag) == ValueType::Tuple);
+        }
+        case ValueType::Function: {
+            size_t index = in.size();
+            return Value::make_function(index, fmt::format("<function {}>", index));
+        }
+    }
+    throw std::runtime_error(fmt::format("unknown constant type {}", tag));
+}
+
+auto is_jump(OpCode op) -> bool {
+    switch (op) {
+        case OpCode::JUMP:
+        case OpCode::JUMP_IF_FALSE:
+        case OpCode::JUMP_IF_TRUE:
+        case OpCode::POP_JUMP_IF_FALSE:
+        case OpCode::COMPARE_JUMP_IF_FALSE:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// The VM trusts operands, so a loaded stream is checked once up front:
+// known opcodes, whole operands, and pool and table indices in range. Jumps
+// and function entries must land on an instruction of the same function,
+// never inside an operand, and local slots must lie in the frame.
+auto validate_code(const Bytecode& bytecode) -> void {
+    const auto bytes = bytecode.code();
+    auto u16_at = [&bytes](size_t offset) {
+        return static_cast<uint16_t>(bytes[offset] | (bytes[offset + 1] << 8));
+    };
+
+    std::vector<bool> starts(bytes.size(), false);
+    for (size_t offset = 0; offset < bytes.size();) {
+        if (bytes[offset] >= kOpCodeCount) {
+            throw std::runtime_error(fmt::format("unknown opcode {} at offset {}", bytes[offset], offset));
+        }
+        auto op = static_cast<OpCode>(bytes[offset]);
+        size_t next = offset + 1 + opcode_operand_size(op);
+        if (next > bytes.size()) {
+            throw std::runtime_error(fmt::format("incomplete {} at offset {}", opcode_name(op), offset));
+        }
+        starts[offset] = true;
+        offset = next;
+    }
+
+    // Each function's code runs up to the next one's entry; code before the
+    // first entry belongs to none and may use no locals
+    std::map<size_t, size_t> frames;  // Entry offset -> local slots
+    for (const auto& function : bytecode.functions) {
+        if (function.offset >= bytes.size() || !starts[function.offset]) {
+            throw std::runtime_error(fmt::format("function '{}' does not start at an instruction", function.name));
+        }
+        if (function.param_count > function.local_count) {
+            throw std::runtime_error(fmt::format("function '{}' has more parameters than locals", function.name));
+        }
+        auto [it, inserted] = frames.emplace(function.offset, function.local_count);
+        if (!inserted) {
+            it->second = std::min(it->second, function.local_count);
+        }
+    }
+
+    auto next_frame = frames.begin();
+    size_t frame_start = 0;
+    size_t frame_end = next_frame == frames.end() ? bytes.size() : next_frame->first;
+    size_t locals = 0;
+    for (size_t offset = 0; offset < bytes.size();) {
+        if (offset == frame_end) {
+            frame_start = offset;
+            locals = next_frame->second;
+            ++next_frame;
+            frame_end = next_frame == frames.end() ? bytes.size() : next_frame->first;
+        }
+        auto op = static_cast<OpCode>(bytes[offset]);
+        size_t next = offset + 1 + opcode_operand_size(op);
+
+        bool in_range = true;
+        switch (op) {
+            case OpCode::CONSTANT:
+            case OpCode::CALL_METHOD:
+                in_range = u16_at(offset + 1) < bytecode.constants.size();
+                break;
+            case OpCode::LOAD_LOCAL:
+            case OpCode::STORE_LOCAL:
+                in_range = u16_at(offset + 1) < locals;
+                break;
+            case OpCode::LOAD_LOCAL2:
+                in_range = u16_at(offset + 1) < locals && u16_at(offset + 3) < locals;
+                break;
+            case OpCode::LOAD_LOCAL_CONST:
+                in_range = u16_at(offset + 1) < locals && u16_at(offset + 3) < bytecode.constants.size();
+                break;
+            case OpCode::LOAD_GLOBAL:
+            case OpCode::CALL:
+            case OpCode::TAIL_CALL:
+            case OpCode::MAKE_CLOSURE:
+                in_range = u16_at(offset + 1) < bytecode.functions.size();
+                break;
+            default:
+                if (is_jump(op)) {
+                    auto target = static_cast<int64_t>(next) + static_cast<int16_t>(u16_at(offset + 1));
+                    in_range = target >= static_cast<int64_t>(frame_start) && target < static_cast<int64_t>(frame_end) &&
+                               starts[static_cast<size_t>(target)];
+                }
+                break;
+        }
+        if (!in_range) {
+            throw std::runtime_error(fmt::format("{} operand out of range at offset {}", opcode_name(op), offset));
+        }
+        offset = next;
+    }
+}
+
+// Appends the serialized image of `bytecode` to `out`, which must end on a
+// kCodeAlignment boundary so the code section stays aligned
+auto write_image(ImageWriter& out, const Bytecode& bytecode, std::string_view tag) -> void {
+    const size_t base = out.size();
+    out.raw(std::span(reinterpret_cast<const uint8_t*>(kMagic), sizeof(kMagic)));
+    out.u32(kBytecodeFormatVersion);
+    out.u32(0);
+    out.u64(0);  // File size, patched below
+    out.u64(0);  // Checksum, patched below
+    const size_t section_table = out.size();
+    for (size_t i = 0; i < kSectionCount * 2; ++i) {
+        out.u64(0);
+    }
+
+    size_t section = 0;
+    auto end_section = [&out, &section, section_table, base](size_t start) {
+        out.patch_u64(section_table + section * 16, start - base);
+        out.patch_u64(section_table + section * 16 + 8, out.size() - start);
+        ++section;
+    };
+
+    // Code
+    out.align(kCodeAlignment);
+    size_t start = out.size();
+    out.raw(bytecode.code());
+    end_section(start);
+
+    // Constants
+    start = out.size();
+    out.u32(static_cast<uint32_t>(bytecode.constants.size()));
+    for (const auto& constant : bytecode.constants) {
+        write_value(out, constant);
+    }
+    end_section(start);
+
+    // Functions
+    start = out.size();
+    out.u32(static_cast<uint32_t>(bytecode.functions.size()));
+    for (const auto& function : bytecode.functions) {
+        out.str(function.name);
+        out.u64(function.offset);
+        out.u64(function.param_count);
+        out.u64(function.local_count);
+    }
+    end_section(start);
+
+    // Debug locations, run-length encoded
+    start = out.size();
+    if (bytecode.debug_locations.size() == bytecode.code().size() && !bytecode.debug_locations.empty()) {
+        std::vector<std::string_view> names;
+        std::unordered_map<std::string_view, uint32_t> name_index;
+        for (const auto& location : bytecode.debug_locations) {
+            if (name_index.emplace(location.filename, static_cast<uint32_t>(names.size())).second) {
+                names.push_back(location.filename);
+            }
+        }
+        out.u32(static_cast<uint32_t>(names.size()));
+        for (auto name : names) {
+            out.str(name);
+        }
+
+        auto same = [](const SourceLocation& a, const SourceLocation& b) {
+            return a.filename == b.filename && a.line == b.line && a.column == b.column &&
+                   a.offset == b.offset && a.length == b.length;
+        };
+        std::vector<std::pair<size_t, size_t>> runs;  // First byte, byte count
+        for (size_t i = 0; i < bytecode.debug_locations.size(); ++i) {
+            if (runs.empty() || !same(bytecode.debug_locations[runs.back().first], bytecode.debug_locations[i])) {
+                runs.emplace_back(i, 0);
+            }
+            ++runs.back().second;
+        }
+        out.u32(static_cast<uint32_t>(runs.size()));
+        for (const auto& [first, count] : runs) {
+            const auto& location = bytecode.debug_locations[first];
+            out.u64(count);
+            out.u32(name_index.at(location.filename));
+            out.u64(location.line);
+            out.u64(location.column);
+            out.u64(location.offset);
+            out.u64(location.length);
+        }
+    }
+    end_section(start);
+
+    // Tag
+    start = out.size();
+    out.raw(std::span(reinterpret_cast<const uint8_t*>(tag.data()), tag.size()));
+    end_section(start);
+
+    auto image = std::span(out.bytes()).subspan(base);
+    out.patch_u64(base + 16, image.size());
+    out.patch_u64(base + 24, fnv1a(image.subspan(kHeaderSize)));
+}
+
+// Replaced rather than rewritten in place, so running programs keep their
+// old mapping
+auto write_bytecode_file(const std::string& filename, std::span<const uint8_t> bytes, bool executable) -> void {
+    if (auto error = replace_file(filename, bytes, executable)) {
+        throw std::runtime_error(fmt::format("Cannot write bytecode file: {}: {}", filename, error.message()));
+    }
+}
+
+} // namespace
+
+auto Bytecode::save_to_file(const std::string& filename, std::string_view tag) const -> void {
+    ImageWriter out;
+    write_image(out, *this, tag);
+    write_bytecode_file(filename, out.bytes(), false);
+}
+
+auto Bytecode::save_as_executable(const std::string& runner, const std::string& filename) const -> void {
+    MappedFile stub(runner, "bytecode file");
+    auto bytes = stub.bytes();
+    // Building from a runner that already carries a program replaces it
+    if (auto payload = find_payload(bytes)) {
+        bytes = bytes.first(payload->offset);
+    }
+
+    ImageWriter out;
+    out.raw(bytes);
+    out.align(kCodeAlignment);
+    const size_t offset = out.size();
+    write_image(out, *this, {});
+    const size_t size = out.size() - offset;
+    out.u64(offset);
+    out.u64(size);
+    out.raw(std::span(reinterpret_cast<const uint8_t*>(kPayloadMagic), sizeof(kPayloadMagic)));
+    write_bytecode_file(filename, out.bytes(), true);
+}
+
+auto Bytecode::load_from_file(const std::string& filename, std::string_view tag) -> Bytecode {
+    auto mapping = std::make_shared<const MappedFile>(filename, "bytecode file");
+    try {
+        auto image = mapping->bytes();
+        return from_image(std::move(mapping), image, tag);
+    } catch (const std::runtime_error& e) {
+        throw std::runtime_error(fmt::format("Invalid bytecode file '{}': {}", filename, e.what()));
+    }
+}
+
+auto Bytecode::has_appended_program(const std::string& filename) -> bool {
+    return find_payload(MappedFile(filename, "bytecode file").bytes()).has_value();
+}
+
+auto Bytecode::load_from_executable(const std::string& filename) -> Bytecode {
+    auto mapping = std::make_shared<const MappedFile>(filename, "bytecode file");
+    auto payload = find_payload(mapping->bytes());
+    if (!payload) {
+        throw std::runtime_error(fmt::format("No Lucid program is appended to '{}'", filename));
+    }
+    try {
+        auto image = mapping->bytes().subspan(payload->offset, payload->size);
+        return from_image(std::move(mapping), image, {});
+    } catch (const std::runtime_error& e) {
+        throw std::runtime_error(fmt::format("Invalid program appended to '{}': {}", filename, e.what()));
+    }
+}
+
+auto Bytecode::from_image(std::shared_ptr<const MappedFile> mapping,
+                          std::span<const uint8_t> image, std::string_view tag) -> Bytecode {
+    if (image.size() < kHeaderSize || std::memcmp(image.data(), kMagic, sizeof(kMagic)) != 0) {
+        throw std::runtime_error("not a Lucid bytecode file");
+    }
+
+    ImageReader fields(image.subspan(sizeof(kMagic), kHeaderSize - sizeof(kMagic)), "header");
+    uint32_t version = fields.u32();
+    if (version != kBytecodeFormatVersion) {
+        throw std::runtime_error(fmt::format(
+            "format version {} is not supported (expected {})", version, kBytecodeFormatVersion
+        ));
+    }
+    fields.u32();  // Reserved
+    if (fields.size() != image.size()) {
+        throw std::runtime_error("file size does not match its header (truncated?)");
+    }
+    if (fields.u64() != fnv1a(image.subspan(kHeaderSize))) {
+        throw std::runtime_error("checksum mismatch");
+    }
+
+    std::span<const uint8_t> sections[kSectionCount];
+    for (auto& section : sections) {
+        size_t offset = fields.size();
+        size_t size = fields.size();
+        if (offset < kHeaderSize || offset > image.size() || size > image.size() - offset) {
+            throw std::runtime_error("section outside the file");
+        }
+        section = image.subspan(offset, size);
+    }
+    if (std::string_view(reinterpret_cast<const char*>(sections[4].data()), sections[4].size()) != tag) {
+        throw std::runtime_error("tag does not match");
+    }
+
+    Bytecode bytecode;
+    bytecode.mapped_code_ = sections[0];
+    bytecode.mapping_ = std::move(mapping);
+
+    ImageReader constants(sections[1], "constants");
+    uint32_t constant_count = constants.u32();
+    bytecode.constants.reserve(constant_count);
+    for (uint32_t i = 0; i < constant_count; ++i) {
+        bytecode.constants.push_back(read_value(constants));
+    }
+
+    ImageReader functions(sections[2], "functions");
+    uint32_t function_count = functions.u32();
+    for (uint32_t i = 0; i < function_count; ++i) {
+        std::string name(functions.str());
+        size_t offset = functions.size();
+        size_t param_count = functions.size();
+        size_t local_count = functions.size();
+        bytecode.add_function(std::move(name), offset, param_count, local_count);
+    }
+
+    if (!sections[3].empty()) {
+        ImageReader debug(sections[3], "debug");
+        auto names = std::make_shared<std::vector<std::string>>();
+        uint32_t name_count = debug.u32();
+        for (uint32_t i = 0; i < name_count; ++i) {
+            names->emplace_back(debug.str());
+        }
+
+        bytecode.debug_locations.reserve(bytecode.mapped_code_.size());
+        uint32_t run_count = debug.u32();
+        for (uint32_t i = 0; i < run_count; ++i) {
+            size_t count = debug.size();
+            uint32_t name = debug.u32();
+            size_t line = debug.size();
+            size_t column = debug.size();
+            size_t offset = debug.size();
+            size_t length = debug.size();
+            if (name >= names->size() || count > bytecode.mapped_code_.size() - bytecode.debug_locations.size()) {
+                debug.fail();
+            }
+            bytecode.debug_locations.insert(bytecode.debug_locations.end(), count,
+                                            SourceLocation{(*names)[name], line, column, offset, length});
+        }
+        if (bytecode.debug_locations.size() != bytecode.mapped_code_.size()) {
+            debug.fail();
+        }
+        bytecode.filenames_ = std::move(names);
+    }
+
+    validate_code(bytecode);
+    return bytecode;
+}
+
+auto Bytecode::unmap() -> void {
+    if (!mapping_) {
+        return;
+    }
+    instructions.assign(mapped_code_.begin(), mapped_code_.end());
+    mapped_code_ = {};
+    mapping_.reset();
 }
 
 } // namespace lucid::backend
@@ -0,0 +1,167 @@
+#include <lucid/backend/compile_cache.hpp>
+#include <fmt/format.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <initializer_list>
+#include <stdexcept>
+#include <system_error>
+#include <vector>
+
+#ifndef LUCID_VERSION
+#define LUCID_VERSION "unknown"
+#endif
+
+namespace lucid::backend {
+
+namespace {
+
+// Length-prefixed fields, so ("ab", "c") and ("a", "bc") differ
+auto make_key(std::initializer_list<std::string_view> fields) -> std::string {
+    std::string key;
+    for (auto field : fields) {
+        for (int shift = 0; shift < 64; shift += 8) {
+            key += static_cast<char>(static_cast<uint64_t>(field.size()) >> shift);
+        }
+        key += field;
+    }
+    return key;
+}
+
+// Named after the key's FNV-1a hash. That picks the file, not the program:
+// distinct keys can share it, so the key itself is stored inside
+auto entry_file(const std::filesystem::path& directory, std::string_view key) -> std::filesystem::path {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (char c : key) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 0x100000001b3ULL;
+    }
+    return directory / fmt::format("{:016x}.lbc", hash);
+}
+
+auto env_path(const char* name) -> std::optional<std::filesystem::path> {
+    const char* value = std::getenv(name);
+    if (value == nullptr || *value == '\0') {
+        return std::nullopt;
+    }
+    return std::filesystem::path(value);
+}
+
+} // namespace
+
+CompileCache::CompileCache(std::filesystem::path directory, std::string identity)
+    : directory_(std::move(directory)), identity_(std::move(identity)) {}
+
+auto CompileCache::default_directory() -> std::optional<std::filesystem::path> {
+    if (auto dir = env_path("LUCID_CACHE_DIR")) {
+        return dir;
+    }
+    if (auto dir = env_path("XDG_CACHE_HOME")) {
+        return *dir / "lucid";
+    }
+    if (auto home = env_path("HOME")) {
+        return *home / ".cache" / "lucid";
+    }
+    return std::nullopt;
+}
+
+auto CompileCache::compiler_identity() -> std::string {
+    std::string identity = fmt::format("lucid {} bytecode v{}", LUCID_VERSION, kBytecodeFormatVersion);
+
+    // A rebuilt compiler may generate different code under the same version
+    std::error_code ec;
+    const std::filesystem::path self = std::filesystem::read_symlink("/proc/self/exe", ec);
+    if (!ec) {
+        auto size = std::filesystem::file_size(self, ec);
+        auto mtime = std::filesystem::last_write_time(self, ec);
+        if (!ec) {
+            identity += fmt::format(" exe {}:{}", size, mtime.time_since_epoch().count());
+        }
+    }
+    return identity;
+}
+
+auto CompileCache::entry_key(std::string_view filename, std::string_view source) const -> std::string {
+    return make_key({identity_, filename, source});
+}
+
+auto CompileCache::entry_path(std::string_view filename, std::string_view source) const -> std::filesystem::path {
+    return entry_file(directory_, entry_key(filename, source));
+}
+
+auto CompileCache::load(std::string_view filename, std::string_view source) const -> std::optional<Bytecode> {
+    const auto key = entry_key(filename, source);
+    const auto path = entry_file(directory_, key);
+    std::error_code ec;
+    if (!std::filesystem::is_regular_file(path, ec)) {
+        return std::nullopt;
+    }
+
+    try {
+        auto bytecode = Bytecode::load_from_file(path.string(), key);
+        // Marks the entry as recently used, for prune
+        std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), ec);
+        return bytecode;
+    } catch (const std::runtime_error&) {
+        // Damaged, from an incompatible build, or another key with the same
+        // hash; the next store replaces it
+        return std::nullopt;
+    }
+}
+
+auto CompileCache::store(std::string_view filename, std::string_view source, const Bytecode& bytecode) const -> void {
+    std::error_code ec;
+    std::filesystem::create_directories(directory_, ec);  // Another process may race us here
+    if (!std::filesystem::is_directory(directory_)) {
+        throw std::runtime_error(fmt::format(
+            "Cannot create cache directory '{}': {}", directory_.string(), ec.message()));
+    }
+    const auto key = entry_key(filename, source);
+    const auto path = entry_file(directory_, key);
+    bytecode.save_to_file(path.string(), key);
+    prune(path);
+}
+
+// Other processes may add and remove entries meanwhile, so every failure
+// here just skips the entry
+auto CompileCache::prune(const std::filesystem::path& keep) const -> void {
+    struct Entry {
+        std::filesystem::path path;
+        std::filesystem::file_time_type used;
+        uintmax_t size;
+    };
+    std::vector<Entry> entries;
+    uintmax_t total = 0;
+    std::error_code ec;
+    for (std::filesystem::directory_iterator it(directory_, ec), end; !ec && it != end; it.increment(ec)) {
+        if (it->path().extension() != ".lbc") {
+            continue;  // Including another store's temporary file
+        }
+        std::error_code entry_ec;
+        auto size = it->file_size(entry_ec);
+        auto used = it->last_write_time(entry_ec);
+        if (!entry_ec) {
+            entries.push_back({it->path(), used, size});
+            total += size;
+        }
+    }
+    if (entries.size() <= max_entries_ && total <= max_bytes_) {
+        return;
+    }
+
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.used < b.used; });
+    size_t count = entries.size();
+    for (const auto& entry : entries) {
+        if (count <= max_entries_ && total <= max_bytes_) {
+            break;
+        }
+        if (entry.path == keep) {
+            continue;
+        }
+        std::filesystem::remove(entry.path, ec);
+        --count;
+        total -= entry.size;
+    }
+}
+
+} // namespace lucid::backend
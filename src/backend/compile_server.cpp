@@ -0,0 +1,516 @@
+#include <lucid/backend/compile_server.hpp>
+#include <lucid/backend/constant_folder.hpp>
+#include <lucid/backend/parallel_compiler.hpp>
+#include <lucid/frontend/lexer.hpp>
+#include <algorithm>
+#include <string_view>
+#include <unordered_map>
+
+namespace lucid::backend {
+
+namespace {
+
+using Names = std::unordered_set<std::string>;
+
+auto collect_references(const ast::Expr& expr, Names& names) -> void;
+
+auto collect_references(const ast::Stmt& stmt, Names& names) -> void {
+    switch (stmt.kind) {
+        case ast::StmtKind::Let:
+            collect_references(*static_cast<const ast::LetStmt&>(stmt).initializer, names);
+            break;
+        case ast::StmtKind::Return:
+            collect_references(*static_cast<const ast::ReturnStmt&>(stmt).value, names);
+            break;
+        case ast::StmtKind::ExprStmt:
+            collect_references(*static_cast<const ast::ExprStmt&>(stmt).expression, names);
+            break;
+    }
+}
+
+// Every name `expr` mentions: callees, and locals too, which can only make
+// a unit depend on more than it does
+auto collect_references(const ast::Expr& expr, Names& names) -> void {
+    auto all = [&](const std::vector<std::unique_ptr<ast::Expr>>& exprs) {
+        for (const auto& element : exprs) {
+            collect_references(*element, names);
+        }
+    };
+    switch (expr.kind) {
+        case ast::ExprKind::Identifier:
+            names.insert(static_cast<const ast::IdentifierExpr&>(expr).name);
+            break;
+        case ast::ExprKind::Tuple:
+            all(static_cast<const ast::TupleExpr&>(expr).elements);
+            break;
+        case ast::ExprKind::List:
+            all(static_cast<const ast::ListExpr&>(expr).elements);
+            break;
+        case ast::ExprKind::Binary: {
+            const auto& binary = static_cast<const ast::BinaryExpr&>(expr);
+            collect_references(*binary.left, names);
+            collect_references(*binary.right, names);
+            break;
+        }
+        case ast::ExprKind::Unary:
+            collect_references(*static_cast<const ast::UnaryExpr&>(expr).operand, names);
+            break;
+        case ast::ExprKind::Call: {
+            const auto& call = static_cast<const ast::CallExpr&>(expr);
+            collect_references(*call.callee, names);
+            all(call.arguments);
+            break;
+        }
+        case ast::ExprKind::MethodCall: {
+            const auto& call = static_cast<const ast::MethodCallExpr&>(expr);
+            collect_references(*call.object, names);
+            all(call.arguments);
+            break;
+        }
+        case ast::ExprKind::Index: {
+            const auto& index = static_cast<const ast::IndexExpr&>(expr);
+            collect_references(*index.object, names);
+            collect_references(*index.index, names);
+            break;
+        }
+        case ast::ExprKind::Lambda:
+            collect_references(*static_cast<const ast::LambdaExpr&>(expr).body, names);
+            break;
+        case ast::ExprKind::If: {
+            const auto& if_expr = static_cast<const ast::IfExpr&>(expr);
+            collect_references(*if_expr.condition, names);
+            collect_references(*if_expr.then_branch, names);
+            if (if_expr.else_branch.has_value()) {
+                collect_references(**if_expr.else_branch, names);
+            }
+            break;
+        }
+        case ast::ExprKind::Block:
+            for (const auto& stmt : static_cast<const ast::BlockExpr&>(expr).statements) {
+                collect_references(*stmt, names);
+            }
+            break;
+        case ast::ExprKind::IntLiteral:
+        case ast::ExprKind::FloatLiteral:
+        case ast::ExprKind::StringLiteral:
+        case ast::ExprKind::BoolLiteral:
+            break;
+    }
+}
+
+auto moved(size_t value, ptrdiff_t delta) -> size_t {
+    return static_cast<size_t>(static_cast<ptrdiff_t>(value) + delta);
+}
+
+// Moves a chunk's locations along with its text
+auto shift(Bytecode& chunk, ptrdiff_t offset_delta, ptrdiff_t line_delta) -> void {
+    if (offset_delta == 0 && line_delta == 0) {
+        return;
+    }
+    for (auto& location : chunk.debug_locations) {
+        if (location.line != 0) {
+            location.offset = moved(location.offset, offset_delta);
+            location.line = moved(location.line, line_delta);
+        }
+    }
+}
+
+auto mentions(const std::unordered_set<std::string>& references, const Names& names) -> bool {
+    return std::any_of(names.begin(), names.end(),
+                       [&](const std::string& name) { return references.contains(name); });
+}
+
+// Bytes between `offset` and the start of its line
+auto column(std::string_view text, size_t offset) -> size_t {
+    const size_t newline = offset == 0 ? std::string_view::npos : text.rfind('\n', offset - 1);
+    return newline == std::string_view::npos ? offset : offset - newline - 1;
+}
+
+auto count_lines(std::string_view text) -> ptrdiff_t {
+    return std::count(text.begin(), text.end(), '\n');
+}
+
+// The names whose unpacked result `uses`, from the function `name`, bears on
+auto add_names(const std::string& name, const ResultUses& uses, Names& names) -> void {
+    names.insert(name);
+    for (const auto& [callee, size] : uses.spread) {
+        names.insert(callee);
+    }
+    names.insert(uses.escaping.begin(), uses.escaping.end());
+}
+
+// Points a chunk's references to named functions at their new indices,
+// which is all that renumbering the functions changes in its code
+auto renumber_calls(Bytecode& chunk, const std::vector<std::string>& old_names,
+                    const Compiler::FunctionTable& functions) -> void {
+    auto& code = chunk.instructions;
+    for (size_t offset = 0; offset < code.size();) {
+        auto opcode = static_cast<OpCode>(code[offset]);
+        if (opcode == OpCode::CALL || opcode == OpCode::TAIL_CALL || opcode == OpCode::LOAD_GLOBAL) {
+            const size_t old_index = code[offset + 1] | (code[offset + 2] << 8);
+            const size_t index = functions.at(old_names[old_index]);
+            code[offset + 1] = static_cast<uint8_t>(index & 0xFF);
+            code[offset + 2] = static_cast<uint8_t>(index >> 8);
+        }
+        offset += 1 + opcode_operand_size(opcode);
+    }
+}
+
+} // namespace
+
+CompileServer::CompileServer(std::string filename) : filename_(std::move(filename)) {}
+
+auto CompileServer::parse_units(const std::string& source, size_t begin, size_t end, size_t line,
+                                std::vector<Parsed>& parsed) const -> std::vector<ParseError> {
+    Lexer lexer(std::string_view(source).substr(0, end), filename_, begin, line);
+    Parser parser(lexer);
+    auto result = parser.parse();
+    if (!result.is_ok()) {
+        return std::move(result.errors);
+    }
+
+    const size_t first = parsed.size();
+    for (auto& function : result.program.value()->functions) {
+        Parsed unit;
+        const size_t start = function->location.offset;
+        unit.unit.offset = parsed.size() == first ? begin : start;
+        unit.unit.line = parsed.size() == first ? line : function->location.line;
+        unit.unit.signature = source.substr(start, function->body->location.offset - start);
+        collect_references(*function->body, unit.unit.references);
+        unit.function = std::move(function);
+        parsed.push_back(std::move(unit));
+    }
+    return {};
+}
+
+auto CompileServer::rebuild(std::string source) -> CompileUpdate {
+    CompileUpdate update;
+    std::vector<Parsed> parsed;
+    update.parse_errors = parse_units(source, 0, source.size(), 1, parsed);
+    if (!update.parse_errors.empty()) {
+        return update;
+    }
+
+    auto globals = std::make_unique<semantic::TypeChecker>();
+    for (auto& unit : parsed) {
+        globals->declare_function(*unit.function);
+    }
+    update.type_errors = globals->take_errors();
+    for (auto& unit : parsed) {
+        semantic::TypeChecker checker(globals.get());
+        checker.check_function(*unit.function);
+        const auto& errors = checker.get_errors();
+        update.type_errors.insert(update.type_errors.end(), errors.begin(), errors.end());
+    }
+    update.reparsed = parsed.size();
+    if (!update.type_errors.empty()) {
+        return update;
+    }
+
+    source_ = std::move(source);
+    globals_ = std::move(globals);
+    units_.clear();
+    uses_ = ProgramUses();
+    unpacked_.clear();
+    std::vector<std::unique_ptr<ast::FunctionDef>> functions;
+    for (auto& unit : parsed) {
+        functions.push_back(std::move(unit.function));
+        units_.push_back(std::move(unit.unit));
+    }
+    program_ = std::make_unique<ast::Program>(std::move(functions), SourceLocation(filename_, 1, 1, 0, 0));
+
+    std::vector<size_t> all(units_.size());
+    for (size_t i = 0; i < all.size(); ++i) {
+        all[i] = i;
+    }
+    update.recompiled = relink(all, true, {});
+    update.functions = units_.size();
+    update.bytecode = link();
+    return update;
+}
+
+auto CompileServer::update(std::string source) -> CompileUpdate {
+    if (units_.empty()) {
+        return rebuild(std::move(source));
+    }
+    CompileUpdate update;
+    update.functions = units_.size();
+    if (source == source_) {
+        update.bytecode = link();
+        return update;
+    }
+
+    // The edit: bytes [start, old_end) of the old source became
+    // [start, new_end) of the new one
+    const size_t common = std::min(source.size(), source_.size());
+    size_t start = static_cast<size_t>(
+        std::mismatch(source.begin(), source.begin() + static_cast<ptrdiff_t>(common), source_.begin()).first -
+        source.begin());
+    const size_t suffix = static_cast<size_t>(
+        std::mismatch(source.rbegin(), source.rbegin() + static_cast<ptrdiff_t>(common - start),
+                      source_.rbegin()).first -
+        source.rbegin());
+    size_t old_end = source_.size() - suffix;
+    size_t new_end = source.size() - suffix;
+
+    // Text inserted or deleted where it repeats could be placed anywhere in
+    // the repeat; whole lines are placed at a line start, which keeps
+    // "function f2 ... function " off the next unit
+    if (start == old_end || start == new_end) {
+        const std::string& text = start == old_end ? source : source_;
+        const size_t& text_end = start == old_end ? new_end : old_end;
+        while (start > 0 && text[start - 1] != '\n' && text[start - 1] == text[text_end - 1]) {
+            --start;
+            --old_end;
+            --new_end;
+        }
+    }
+    const ptrdiff_t offset_delta = static_cast<ptrdiff_t>(new_end) - static_cast<ptrdiff_t>(old_end);
+    const ptrdiff_t line_delta = count_lines(std::string_view(source).substr(start, new_end - start)) -
+                                 count_lines(std::string_view(source_).substr(start, old_end - start));
+
+    // The units it touches: from the one its start is in (or ends) to the
+    // last one starting before its end, and any after that whose first
+    // line it changes, as their columns move
+    const size_t n = units_.size();
+    auto after = std::lower_bound(units_.begin() + 1, units_.end(), start,
+                                  [](const Unit& unit, size_t offset) { return unit.offset < offset; });
+    const size_t first = static_cast<size_t>(after - units_.begin()) - 1;
+    auto past = std::lower_bound(units_.begin(), units_.end(), old_end,
+                                 [](const Unit& unit, size_t offset) { return unit.offset < offset; });
+    const auto before_end = static_cast<size_t>(past - units_.begin());
+    size_t last = before_end > first ? before_end - 1 : first;
+    while (last + 1 < n &&
+           column(source_, units_[last + 1].offset) != column(source, moved(units_[last + 1].offset, offset_delta))) {
+        ++last;
+    }
+
+    const size_t begin = units_[first].offset;
+    const size_t end = last + 1 < n ? moved(units_[last + 1].offset, offset_delta) : source.size();
+    std::vector<Parsed> parsed;
+    if (!parse_units(source, begin, end, units_[first].line, parsed).empty()) {
+        // Reported as a parse of the whole file reports them
+        return rebuild(std::move(source));
+    }
+
+    // Where a unit outside the edit starts now. With every function before
+    // it gone, the first one left takes over the start of the file.
+    const bool takes_start = first == 0 && parsed.empty();
+    auto new_offset = [&](size_t i) -> size_t {
+        if (i < first) {
+            return units_[i].offset;
+        }
+        return takes_start && i == last + 1 ? 0 : moved(units_[i].offset, offset_delta);
+    };
+    auto new_line = [&](size_t i) -> size_t {
+        if (i < first) {
+            return units_[i].line;
+        }
+        return takes_start && i == last + 1 ? 1 : moved(units_[i].line, line_delta);
+    };
+    auto new_end_of = [&](size_t i) -> size_t {
+        if (i + 1 == n) {
+            return source.size();
+        }
+        return i + 1 == first ? begin : new_offset(i + 1);
+    };
+
+    // Signatures that changed, appeared or disappeared
+    Names changed;
+    std::unordered_map<std::string, const std::string*> old_signatures;
+    std::vector<std::string> old_names;
+    for (size_t i = first; i <= last; ++i) {
+        old_names.push_back(program_->functions[i]->name);
+        old_signatures.emplace(old_names.back(), &units_[i].signature);
+    }
+    std::vector<std::string> new_names;
+    for (const auto& unit : parsed) {
+        new_names.push_back(unit.function->name);
+        auto old = old_signatures.find(new_names.back());
+        if (old == old_signatures.end() || *old->second != unit.unit.signature) {
+            changed.insert(new_names.back());
+        }
+    }
+    for (const auto& name : old_names) {
+        if (std::find(new_names.begin(), new_names.end(), name) == new_names.end()) {
+            changed.insert(name);
+        }
+    }
+    const bool renamed = old_names != new_names;
+
+    // Units elsewhere that name one of those are checked again, from their
+    // text, which has not changed
+    std::vector<std::pair<size_t, Parsed>> dependants;
+    if (!changed.empty()) {
+        for (size_t i = 0; i < n; ++i) {
+            if ((i >= first && i <= last) || !mentions(units_[i].references, changed)) {
+                continue;
+            }
+            std::vector<Parsed> again;
+            if (!parse_units(source, new_offset(i), new_end_of(i), new_line(i), again).empty() ||
+                again.size() != 1) {
+                return rebuild(std::move(source));
+            }
+            dependants.emplace_back(i, std::move(again.front()));
+        }
+    }
+
+    // Redeclare the edited signatures, then check the new units and the
+    // dependants in program order
+    auto& globals = *globals_;
+    for (const auto& name : old_names) {
+        globals.undeclare_function(name);
+    }
+    std::vector<const ast::FunctionDef*> declared;
+    for (auto& unit : parsed) {
+        if (globals.declare_function(*unit.function)) {
+            declared.push_back(unit.function.get());
+        }
+    }
+    update.type_errors = globals.take_errors();
+
+    std::vector<ast::FunctionDef*> checked;
+    auto dependant = dependants.begin();
+    for (; dependant != dependants.end() && dependant->first < first; ++dependant) {
+        checked.push_back(dependant->second.function.get());
+    }
+    for (auto& unit : parsed) {
+        checked.push_back(unit.function.get());
+    }
+    for (; dependant != dependants.end(); ++dependant) {
+        checked.push_back(dependant->second.function.get());
+    }
+    for (auto* function : checked) {
+        semantic::TypeChecker checker(globals_.get());
+        checker.check_function(*function);
+        const auto& errors = checker.get_errors();
+        update.type_errors.insert(update.type_errors.end(), errors.begin(), errors.end());
+    }
+    update.reparsed = checked.size();
+
+    if (!update.type_errors.empty()) {
+        // Back to the signatures of the program held
+        for (const auto* function : declared) {
+            globals.undeclare_function(function->name);
+        }
+        for (size_t i = first; i <= last; ++i) {
+            globals.declare_function(*program_->functions[i]);
+        }
+        globals.take_errors();
+        return update;
+    }
+
+    // Commit: units after the edit move, dependants are replaced, and the
+    // edited units are spliced in. What the old trees told
+    // find_unpacked_results goes; relink adds what the new ones tell.
+    Names retired;
+    auto retire = [&](size_t i) {
+        uses_.remove(units_[i].uses);
+        add_names(program_->functions[i]->name, units_[i].uses, retired);
+    };
+    for (size_t i = first; i <= last; ++i) {
+        retire(i);
+    }
+    for (const auto& [i, unit] : dependants) {
+        retire(i);
+    }
+    for (size_t i = last + 1; i < n; ++i) {
+        auto& unit = units_[i];
+        shift(unit.chunk, offset_delta, line_delta);
+        unit.offset_shift += offset_delta;
+        unit.line_shift += line_delta;
+        unit.offset = new_offset(i);
+        unit.line = new_line(i);
+    }
+    const size_t removed = last - first + 1;
+    std::vector<size_t> dirty;
+    for (auto& [i, unit] : dependants) {
+        program_->functions[i] = std::move(unit.function);
+        units_[i] = std::move(unit.unit);
+        dirty.push_back(i < first ? i : i - removed + parsed.size());
+    }
+
+    const auto at = static_cast<ptrdiff_t>(first);
+    units_.erase(units_.begin() + at, units_.begin() + at + static_cast<ptrdiff_t>(removed));
+    program_->functions.erase(program_->functions.begin() + at,
+                              program_->functions.begin() + at + static_cast<ptrdiff_t>(removed));
+    for (size_t k = 0; k < parsed.size(); ++k) {
+        const auto index = at + static_cast<ptrdiff_t>(k);
+        units_.insert(units_.begin() + index, std::move(parsed[k].unit));
+        program_->functions.insert(program_->functions.begin() + index, std::move(parsed[k].function));
+        dirty.push_back(first + k);
+    }
+    source_ = std::move(source);
+
+    update.recompiled = relink(dirty, renamed, std::move(retired));
+    update.functions = units_.size();
+    update.bytecode = link();
+    return update;
+}
+
+auto CompileServer::relink(const std::vector<size_t>& dirty, bool renamed, Names touched) -> size_t {
+    for (size_t i : dirty) {
+        auto& function = *program_->functions[i];
+        fold_constants(function);
+        units_[i].uses = result_uses(function);
+        uses_.add(units_[i].uses);
+        add_names(function.name, units_[i].uses, touched);
+    }
+    std::vector<std::string> old_names;
+    if (renamed) {
+        old_names.resize(functions_.size());
+        for (const auto& [name, index] : functions_) {
+            old_names[index] = name;
+        }
+        functions_ = Compiler::function_table(*program_);
+    }
+
+    // A function whose result is now built where it was unpacked, or the
+    // other way round, changes its own code and its callers'. Only the
+    // names the edit touched can have changed.
+    Names moved_results;
+    for (const auto& name : touched) {
+        auto function = functions_.find(name);
+        const size_t size = function == functions_.end() ? 0 : uses_.unpacked_size(name, units_[function->second].uses);
+        auto old = unpacked_.find(name);
+        if ((old == unpacked_.end() ? 0 : old->second) == size) {
+            continue;
+        }
+        moved_results.insert(name);
+        if (size == 0) {
+            unpacked_.erase(old);
+        } else {
+            unpacked_[name] = size;
+        }
+    }
+
+    std::vector<bool> stale(units_.size(), false);
+    for (size_t i : dirty) {
+        stale[i] = true;
+    }
+    size_t recompiled = 0;
+    for (size_t i = 0; i < units_.size(); ++i) {
+        auto& unit = units_[i];
+        auto* function = program_->functions[i].get();
+        if (stale[i] || moved_results.contains(function->name) || mentions(unit.references, moved_results)) {
+            Compiler compiler;
+            unit.chunk = compiler.compile_chunk(function, functions_, unpacked_);
+            shift(unit.chunk, unit.offset_shift, unit.line_shift);
+            ++recompiled;
+        } else if (renamed) {
+            renumber_calls(unit.chunk, old_names, functions_);
+        }
+    }
+    return recompiled;
+}
+
+auto CompileServer::link() const -> Bytecode {
+    std::vector<Bytecode> chunks;
+    chunks.reserve(units_.size());
+    for (const auto& unit : units_) {
+        chunks.push_back(unit.chunk);  // link_chunks rewrites them
+    }
+    return link_chunks(chunks);
+}
+
+} // namespace lucid::backend
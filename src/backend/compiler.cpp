@@ -1,9 +1,28 @@
 #include <lucid/backend/compiler.hpp>
 #include <fmt/format.h>
+#include <algorithm>
+#include <optional>
 #include <stdexcept>
 
 namespace lucid::backend {
 
+// Attributes the instructions emitted while compiling a node to its location
+class Compiler::LocationScope {
+public:
+    LocationScope(Compiler& compiler, SourceLocation location)
+        : compiler_(compiler), saved_(compiler.current_location_) {
+        compiler_.current_location_ = location;
+    }
+    ~LocationScope() { compiler_.current_location_ = saved_; }
+
+    LocationScope(const LocationScope&) = delete;
+    auto operator=(const LocationScope&) -> LocationScope& = delete;
+
+private:
+    Compiler& compiler_;
+    SourceLocation saved_;
+};
+
 // Constructor
 Compiler::Compiler() = default;
 
@@ -11,10 +30,11 @@ Compiler::Compiler() = default;
 auto Compiler::compile(ast::Program* program) -> Bytecode {
     // Pass 1: Collect all functions
     collect_functions(program);
+    unpacked_results_ = find_unpacked_results(*program);
 
     // Pass 2: Compile each function
     for (auto& function : program->functions) {
-        compile_function(function.get());
+        compile_function(function.get(), function_indices_[function->name]);
     }
 
     // Emit HALT at the end
@@ -23,6 +43,24 @@ auto Compiler::compile(ast::Program* program) -> Bytecode {
     return std::move(bytecode_);
 }
 
+auto Compiler::function_table(const ast::Program& program) -> FunctionTable {
+    FunctionTable functions;
+    for (size_t i = 0; i < program.functions.size(); ++i) {
+        functions[program.functions[i]->name] = i;
+    }
+    return functions;
+}
+
+auto Compiler::compile_chunk(ast::FunctionDef* function, const FunctionTable& functions,
+                             const UnpackedResults& unpacked) -> Bytecode {
+    function_table_ = &functions;
+    unpacked_results_ = unpacked;
+    size_t param_count = function->parameters.size();
+    compile_function(function, bytecode_.add_function(function->name, 0, param_count, param_count));
+    function_table_ = &function_indices_;
+    return std::move(bytecode_);
+}
+
 // ===== Two-Pass Compilation =====
 
 // Pass 1: Collect function signatures
@@ -45,79 +83,128 @@ auto Compiler::collect_functions(ast::Program* program) -> void {
 }
 
 // Pass 2: Compile function body
-auto Compiler::compile_function(ast::FunctionDef* function) -> void {
+auto Compiler::compile_function(ast::FunctionDef* function, size_t func_idx) -> void {
     // Update function offset to current position
-    size_t func_idx = function_indices_[function->name];
     bytecode_.functions[func_idx].offset = bytecode_.current_offset();
 
+    LocationScope location_scope(*this, function->location);
+
     // Create function context
     FunctionContext func_ctx{function->name, function->parameters.size(), bytecode_.current_offset()};
     current_function_ = &func_ctx;
-
-    // Enter function scope
-    enter_scope();
-
-    // Declare parameters as local variables
-    for (const auto& param : function->parameters) {
-        declare_local(param->name);
+    auto unpacked = unpacked_results_.find(function->name);
+    unpacked_result_ = unpacked == unpacked_results_.end() ? 0 : unpacked->second;
+
+    // Enter function scope; parameters take the first slots
+    enter_scope(function->local_count);
+    if (!resolved_) {
+        for (const auto& param : function->parameters) {
+            declare_local(param->name);
+        }
     }
 
-    // Compile function body
-    function->body->accept(*this);
+    // Compile function body; its value is returned, so it is a tail position
+    function_body_ = function->body.get();
+    compile_tail(function->body.get());
 
     // If body doesn't end with explicit RETURN, add implicit return
     // (This handles functions that end with expression-only blocks)
     // Note: Type checker ensures function returns correct type
-    if (bytecode_.instructions.empty() ||
+    // A RETURN_TUPLE's operand could end in any byte, so one is always added
+    if (unpacked_result_ > 0 || bytecode_.instructions.empty() ||
         bytecode_.instructions.back() != static_cast<uint8_t>(OpCode::RETURN)) {
-        emit(OpCode::RETURN);
+        emit_return();
     }
 
-    // Update local count
-    bytecode_.functions[func_idx].local_count = scopes_.back().local_count;
+    // Exit function scope, recording its local count
+    bytecode_.functions[func_idx].local_count = exit_scope();
+    current_function_ = nullptr;
+    unpacked_result_ = 0;
 
-    // Exit function scope
-    exit_scope();
+    // Then the lambdas it contains, and those nested in them, in the order
+    // they were met
+    for (size_t i = 0; i < pending_lambdas_.size(); ++i) {
+        PendingLambda pending = pending_lambdas_[i];  // compile_lambda may append
+        compile_lambda(pending);
+    }
+    pending_lambdas_.clear();
+}
+
+// A lambda is a function whose parameters are its own followed by the
+// enclosing locals it captured (see visit_lambda)
+auto Compiler::compile_lambda(const PendingLambda& pending) -> void {
+    ast::LambdaExpr* lambda = pending.lambda;
+    bytecode_.functions[pending.func_idx].offset = bytecode_.current_offset();
+
+    LocationScope location_scope(*this, lambda->location);
+
+    FunctionContext func_ctx{bytecode_.functions[pending.func_idx].name,
+                             bytecode_.functions[pending.func_idx].param_count,
+                             bytecode_.current_offset()};
+    current_function_ = &func_ctx;
+
+    enter_scope(lambda->local_count);
+    if (!resolved_) {
+        for (const auto& param : lambda->parameters) {
+            declare_local(param);
+        }
+        for (const auto& name : pending.captures) {
+            declare_local(name);
+        }
+    }
+
+    // The body is the lambda's value
+    function_body_ = lambda->body.get();
+    compile_tail(lambda->body.get());
+    emit(OpCode::RETURN);
+
+    bytecode_.functions[pending.func_idx].local_count = exit_scope();
     current_function_ = nullptr;
 }
 
 // ===== Scope Management =====
 
-auto Compiler::enter_scope() -> void {
-    scopes_.push_back(Scope{});
+auto Compiler::enter_scope(uint32_t local_count) -> void {
+    resolved_ = local_count != ast::kNoSlot;
+    local_count_ = resolved_ ? local_count : 0;
+    locals_.clear();
 }
 
-auto Compiler::exit_scope() -> void {
-    if (!scopes_.empty()) {
-        scopes_.pop_back();
-    }
+auto Compiler::exit_scope() -> size_t {
+    locals_.clear();
+    return local_count_;
 }
 
 auto Compiler::declare_local(const std::string& name) -> size_t {
-    if (scopes_.empty()) {
-        throw std::runtime_error("Cannot declare local outside of scope");
-    }
-
-    auto& scope = scopes_.back();
-    size_t index = scope.local_count++;
-    scope.locals[name] = index;
+    size_t index = local_count_++;
+    locals_.push_back(Local{name, index});
     return index;
 }
 
+auto Compiler::declare_local(const ast::IdentifierPattern& pattern) -> size_t {
+    return resolved_ ? pattern.slot : declare_local(pattern.name);
+}
+
 auto Compiler::resolve_local(const std::string& name) -> int {
-    // Search scopes from innermost to outermost
-    for (auto it = scopes_.rbegin(); it != scopes_.rend(); ++it) {
-        auto found = it->locals.find(name);
-        if (found != it->locals.end()) {
-            return static_cast<int>(found->second);
+    // Search from the latest declaration back
+    for (auto it = locals_.rbegin(); it != locals_.rend(); ++it) {
+        if (it->name == name) {
+            return static_cast<int>(it->slot);
         }
     }
     return -1;  // Not found
 }
 
+auto Compiler::resolve_local(const ast::IdentifierExpr& identifier) -> int {
+    if (resolved_) {
+        return identifier.slot == ast::kNoSlot ? -1 : static_cast<int>(identifier.slot);
+    }
+    return resolve_local(identifier.name);
+}
+
 auto Compiler::resolve_function(const std::string& name) -> int {
-    auto found = function_indices_.find(name);
-    if (found != function_indices_.end()) {
+    auto found = function_table_->find(name);
+    if (found != function_table_->end()) {
         return static_cast<int>(found->second);
     }
     return -1;  // Not found
@@ -127,18 +214,26 @@ auto Compiler::resolve_function(const std::string& name) -> int {
 
 auto Compiler::emit(OpCode opcode) -> void {
     bytecode_.emit(opcode);
+    record_location();
 }
 
 auto Compiler::emit(OpCode opcode, uint8_t operand) -> void {
     bytecode_.emit(opcode, operand);
+    record_location();
 }
 
 auto Compiler::emit(OpCode opcode, uint16_t operand) -> void {
     bytecode_.emit(opcode, operand);
+    record_location();
 }
 
 auto Compiler::emit(OpCode opcode, uint16_t operand1, uint8_t operand2) -> void {
     bytecode_.emit(opcode, operand1, operand2);
+    record_location();
+}
+
+auto Compiler::record_location() -> void {
+    bytecode_.debug_locations.resize(bytecode_.instructions.size(), current_location_);
 }
 
 auto Compiler::add_constant(Value value) -> uint16_t {
@@ -159,21 +254,25 @@ auto Compiler::patch_jump(size_t offset) -> void {
 // ===== Expression Visitors =====
 
 auto Compiler::visit_int_literal(ast::IntLiteralExpr* expr) -> void {
+    LocationScope location_scope(*this, expr->location);
     uint16_t const_idx = add_constant(Value(expr->value));
     emit(OpCode::CONSTANT, const_idx);
 }
 
 auto Compiler::visit_float_literal(ast::FloatLiteralExpr* expr) -> void {
+    LocationScope location_scope(*this, expr->location);
     uint16_t const_idx = add_constant(Value(expr->value));
     emit(OpCode::CONSTANT, const_idx);
 }
 
 auto Compiler::visit_string_literal(ast::StringLiteralExpr* expr) -> void {
+    LocationScope location_scope(*this, expr->location);
     uint16_t const_idx = add_constant(Value(expr->value));
     emit(OpCode::CONSTANT, const_idx);
 }
 
 auto Compiler::visit_bool_literal(ast::BoolLiteralExpr* expr) -> void {
+    LocationScope location_scope(*this, expr->location);
     if (expr->value) {
         emit(OpCode::TRUE);
     } else {
@@ -182,8 +281,9 @@ auto Compiler::visit_bool_literal(ast::BoolLiteralExpr* expr) -> void {
 }
 
 auto Compiler::visit_identifier(ast::IdentifierExpr* expr) -> void {
+    LocationScope location_scope(*this, expr->location);
     // Try to resolve as local variable
-    int local_idx = resolve_local(expr->name);
+    int local_idx = resolve_local(*expr);
     if (local_idx >= 0) {
         emit(OpCode::LOAD_LOCAL, static_cast<uint16_t>(local_idx));
         return;
@@ -200,11 +300,63 @@ auto Compiler::visit_identifier(ast::IdentifierExpr* expr) -> void {
     throw std::runtime_error(fmt::format("Undefined identifier: {}", expr->name));
 }
 
+namespace {
+
+// Type-specialised opcode for a binary expression, if both operands have the
+// same statically known numeric type
+auto specialised_binary_op(const ast::BinaryExpr* expr) -> std::optional<OpCode> {
+    using Op = ast::BinaryOp;
+    const ast::StaticType type = expr->left->static_type;
+    if (type != expr->right->static_type) {
+        return std::nullopt;
+    }
+
+    if (type == ast::StaticType::Int) {
+        switch (expr->op) {
+            case Op::Add: return OpCode::ADD_INT;
+            case Op::Sub: return OpCode::SUB_INT;
+            case Op::Mul: return OpCode::MUL_INT;
+            case Op::Div: return OpCode::DIV_INT;
+            case Op::Mod: return OpCode::MOD_INT;
+            case Op::Eq:  return OpCode::EQ_INT;
+            case Op::Ne:  return OpCode::NE_INT;
+            case Op::Lt:  return OpCode::LT_INT;
+            case Op::Gt:  return OpCode::GT_INT;
+            case Op::Le:  return OpCode::LE_INT;
+            case Op::Ge:  return OpCode::GE_INT;
+            default: return std::nullopt;
+        }
+    }
+    if (type == ast::StaticType::Float) {
+        switch (expr->op) {
+            case Op::Add: return OpCode::ADD_FLOAT;
+            case Op::Sub: return OpCode::SUB_FLOAT;
+            case Op::Mul: return OpCode::MUL_FLOAT;
+            case Op::Div: return OpCode::DIV_FLOAT;
+            case Op::Lt:  return OpCode::LT_FLOAT;
+            case Op::Gt:  return OpCode::GT_FLOAT;
+            case Op::Le:  return OpCode::LE_FLOAT;
+            case Op::Ge:  return OpCode::GE_FLOAT;
+            default: return std::nullopt;
+        }
+    }
+    return std::nullopt;
+}
+
+} // namespace
+
 auto Compiler::visit_binary(ast::BinaryExpr* expr) -> void {
+    LocationScope location_scope(*this, expr->location);
     // Compile operands (left then right for stack-based evaluation)
     expr->left->accept(*this);
     expr->right->accept(*this);
 
+    // Use a type-specialised opcode when the checker proved both operand types
+    if (auto specialised = specialised_binary_op(expr)) {
+        emit(*specialised);
+        return;
+    }
+
     // Emit operator
     switch (expr->op) {
         case ast::BinaryOp::Add: emit(OpCode::ADD); break;
@@ -225,6 +377,7 @@ auto Compiler::visit_binary(ast::BinaryExpr* expr) -> void {
 }
 
 auto Compiler::visit_unary(ast::UnaryExpr* expr) -> void {
+    LocationScope location_scope(*this, expr->location);
     // Compile operand
     expr->operand->accept(*this);
 
@@ -236,7 +389,47 @@ auto Compiler::visit_unary(ast::UnaryExpr* expr) -> void {
     }
 }
 
+namespace {
+
+// Value of a literal, or of a tuple/list the constant folder marked constant
+auto constant_value(const ast::Expr& expr) -> Value {
+    switch (expr.kind) {
+        case ast::ExprKind::IntLiteral:
+            return Value(static_cast<const ast::IntLiteralExpr&>(expr).value);
+        case ast::ExprKind::FloatLiteral:
+            return Value(static_cast<const ast::FloatLiteralExpr&>(expr).value);
+        case ast::ExprKind::BoolLiteral:
+            return Value(static_cast<const ast::BoolLiteralExpr&>(expr).value);
+        case ast::ExprKind::StringLiteral:
+            return Value(static_cast<const ast::StringLiteralExpr&>(expr).value);
+        case ast::ExprKind::Tuple:
+        case ast::ExprKind::List: {
+            bool is_tuple = expr.kind == ast::ExprKind::Tuple;
+            const auto& elements = is_tuple
+                ? static_cast<const ast::TupleExpr&>(expr).elements
+                : static_cast<const ast::ListExpr&>(expr).elements;
+            std::vector<Value> values;
+            values.reserve(elements.size());
+            for (const auto& element : elements) {
+                values.push_back(constant_value(*element));
+            }
+            return Value(std::move(values), is_tuple);
+        }
+        default:
+            throw std::runtime_error("Expression is not a constant");
+    }
+}
+
+} // namespace
+
 auto Compiler::visit_tuple(ast::TupleExpr* expr) -> void {
+    LocationScope location_scope(*this, expr->location);
+    // Folded tuples are built once, into the constant pool
+    if (expr->is_constant) {
+        emit(OpCode::CONSTANT, add_constant(constant_value(*expr)));
+        return;
+    }
+
     // Compile each element
     for (const auto& element : expr->elements) {
         element->accept(*this);
@@ -247,6 +440,13 @@ auto Compiler::visit_tuple(ast::TupleExpr* expr) -> void {
 }
 
 auto Compiler::visit_list(ast::ListExpr* expr) -> void {
+    LocationScope location_scope(*this, expr->location);
+    // Folded lists are shared with the pool; updates copy on write
+    if (expr->is_constant) {
+        emit(OpCode::CONSTANT, add_constant(constant_value(*expr)));
+        return;
+    }
+
     // Compile each element
     for (const auto& element : expr->elements) {
         element->accept(*this);
@@ -257,6 +457,7 @@ auto Compiler::visit_list(ast::ListExpr* expr) -> void {
 }
 
 auto Compiler::visit_index(ast::IndexExpr* expr) -> void {
+    LocationScope location_scope(*this, expr->location);
     // Compile object and index
     expr->object->accept(*this);
     expr->index->accept(*this);
@@ -266,6 +467,11 @@ auto Compiler::visit_index(ast::IndexExpr* expr) -> void {
 }
 
 auto Compiler::visit_call(ast::CallExpr* expr) -> void {
+    compile_call(expr, false);
+}
+
+auto Compiler::compile_call(ast::CallExpr* expr, bool tail) -> void {
+    LocationScope location_scope(*this, expr->location);
     // Check for built-in functions first
     if (auto* ident = dynamic_cast<ast::IdentifierExpr*>(expr->callee.get())) {
         // Check for builtin functions
@@ -328,6 +534,22 @@ auto Compiler::visit_call(ast::CallExpr* expr) -> void {
                  static_cast<uint8_t>(expr->arguments.size()));
             return;
         }
+        if (ident->name == "read_lines") {
+            for (const auto& arg : expr->arguments) {
+                arg->accept(*this);
+            }
+            emit(OpCode::CALL_BUILTIN, static_cast<uint16_t>(BuiltinId::READ_LINES),
+                 static_cast<uint8_t>(expr->arguments.size()));
+            return;
+        }
+        if (ident->name == "for_each_line") {
+            for (const auto& arg : expr->arguments) {
+                arg->accept(*this);
+            }
+            emit(OpCode::CALL_BUILTIN, static_cast<uint16_t>(BuiltinId::FOR_EACH_LINE),
+                 static_cast<uint8_t>(expr->arguments.size()));
+            return;
+        }
     }
 
     // Compile arguments (left to right)
@@ -338,27 +560,28 @@ auto Compiler::visit_call(ast::CallExpr* expr) -> void {
     // Compile callee to get function reference
     expr->callee->accept(*this);
 
-    // For now, we expect callee to be an identifier
-    // Extract function index if it's a direct call
+    // A function called by name (and not shadowed by a local) is a direct call
     if (auto* ident = dynamic_cast<ast::IdentifierExpr*>(expr->callee.get())) {
         int func_idx = resolve_function(ident->name);
-        if (func_idx >= 0) {
+        if (func_idx >= 0 && resolve_local(*ident) < 0) {
             // Pop the LOAD_GLOBAL we just emitted
             bytecode_.instructions.pop_back();
             bytecode_.instructions.pop_back();
             bytecode_.instructions.pop_back();
 
-            // Emit direct call
-            emit(OpCode::CALL, static_cast<uint16_t>(func_idx),
+            // Emit direct call; in tail position it replaces this frame
+            emit(tail ? OpCode::TAIL_CALL : OpCode::CALL, static_cast<uint16_t>(func_idx),
                  static_cast<uint8_t>(expr->arguments.size()));
             return;
         }
     }
 
-    throw std::runtime_error("Only direct function calls supported in Day 2");
+    // Anything else evaluates to a function value, called through it
+    emit(OpCode::CALL_VALUE, static_cast<uint8_t>(expr->arguments.size()));
 }
 
 auto Compiler::visit_method_call(ast::MethodCallExpr* expr) -> void {
+    LocationScope location_scope(*this, expr->location);
     // Compile object
     expr->object->accept(*this);
 
@@ -366,15 +589,30 @@ auto Compiler::visit_method_call(ast::MethodCallExpr* expr) -> void {
     for (const auto& arg : expr->arguments) {
         arg->accept(*this);
     }
+    size_t arg_count = expr->arguments.size();
+
+    // sum() starts from the zero of the element type, so an empty
+    // List[Float] sums to 0.0
+    if (expr->method_name == "sum" && arg_count == 0) {
+        emit(OpCode::CONSTANT, add_constant(expr->static_type == ast::StaticType::Float
+                                                ? Value(0.0)
+                                                : Value(int64_t{0})));
+        arg_count = 1;
+    }
 
     // Add method name to constants
     uint16_t name_idx = add_constant(Value(expr->method_name));
 
     // Emit method call
-    emit(OpCode::CALL_METHOD, name_idx, static_cast<uint8_t>(expr->arguments.size()));
+    emit(OpCode::CALL_METHOD, name_idx, static_cast<uint8_t>(arg_count));
 }
 
 auto Compiler::visit_if(ast::IfExpr* expr) -> void {
+    compile_if(expr, false);
+}
+
+auto Compiler::compile_if(ast::IfExpr* expr, bool tail) -> void {
+    LocationScope location_scope(*this, expr->location);
     // Compile condition
     expr->condition->accept(*this);
 
@@ -385,7 +623,11 @@ auto Compiler::visit_if(ast::IfExpr* expr) -> void {
     emit(OpCode::POP);
 
     // Compile then branch
-    expr->then_branch->accept(*this);
+    if (tail) {
+        compile_tail(expr->then_branch.get());
+    } else {
+        expr->then_branch->accept(*this);
+    }
 
     // Jump over else branch
     size_t end_jump = emit_jump(OpCode::JUMP);
@@ -398,7 +640,11 @@ auto Compiler::visit_if(ast::IfExpr* expr) -> void {
 
     // Compile else branch if present
     if (expr->else_branch.has_value()) {
-        expr->else_branch.value()->accept(*this);
+        if (tail) {
+            compile_tail(expr->else_branch.value().get());
+        } else {
+            expr->else_branch.value()->accept(*this);
+        }
     } else {
         // If no else, push false (or could be unit)
         emit(OpCode::FALSE);
@@ -409,6 +655,11 @@ auto Compiler::visit_if(ast::IfExpr* expr) -> void {
 }
 
 auto Compiler::visit_block(ast::BlockExpr* expr) -> void {
+    compile_block(expr, false);
+}
+
+auto Compiler::compile_block(ast::BlockExpr* expr, bool tail) -> void {
+    LocationScope location_scope(*this, expr->location);
     // Empty block - push unit/false
     if (expr->statements.empty()) {
         emit(OpCode::FALSE);
@@ -421,6 +672,9 @@ auto Compiler::visit_block(ast::BlockExpr* expr) -> void {
     // Compile all statements except the last
     for (size_t i = 0; i < expr->statements.size() - 1; ++i) {
         expr->statements[i]->accept(*this);
+        if (expr->statements[i]->kind == ast::StmtKind::Let && expr != function_body_) {
+            emit(OpCode::POP);  // The bound value STORE_LOCAL left behind
+        }
     }
 
     // Handle last statement specially
@@ -429,7 +683,11 @@ auto Compiler::visit_block(ast::BlockExpr* expr) -> void {
     // If last statement is an ExprStmt, compile the expression directly
     // without the POP (to leave the value on stack as block result)
     if (auto* expr_stmt = dynamic_cast<ast::ExprStmt*>(last_stmt.get())) {
-        expr_stmt->expression->accept(*this);
+        if (tail) {
+            compile_tail(expr_stmt->expression.get());
+        } else {
+            expr_stmt->expression->accept(*this);
+        }
     } else {
         // Other statements (let, return, etc.) compile normally
         last_stmt->accept(*this);
@@ -438,31 +696,72 @@ auto Compiler::visit_block(ast::BlockExpr* expr) -> void {
     // Block value is the value left on the stack by last statement
 }
 
+
+// A lambda evaluates to a closure. Captures are by value: each enclosing
+// local the body mentions is copied into the function value here and passed
+// to the lambda's function after its own arguments. A name the body only
+// rebinds with `let` is captured needlessly but harmlessly.
 auto Compiler::visit_lambda(ast::LambdaExpr* expr) -> void {
-    (void)expr;  // Unused in Day 2
-    // Lambdas not implemented in Day 2
-    throw std::runtime_error("Lambda expressions not yet implemented");
+    LocationScope location_scope(*this, expr->location);
+
+    // The type checker found them already (LambdaExpr::captures)
+    std::vector<std::string> captures;
+    size_t capture_count = expr->captures.size();
+    if (resolved_) {
+        for (uint32_t slot : expr->captures) {
+            emit(OpCode::LOAD_LOCAL, static_cast<uint16_t>(slot));
+        }
+    } else {
+        std::vector<const ast::IdentifierExpr*> mentioned;
+        ast::collect_identifiers(*expr->body, mentioned);
+        for (const auto* identifier : mentioned) {
+            const auto& name = identifier->name;
+            bool is_param = std::find(expr->parameters.begin(), expr->parameters.end(), name) !=
+                            expr->parameters.end();
+            int local_idx = is_param ? -1 : resolve_local(name);
+            if (local_idx >= 0) {
+                emit(OpCode::LOAD_LOCAL, static_cast<uint16_t>(local_idx));
+                captures.push_back(name);
+            }
+        }
+        capture_count = captures.size();
+    }
+    if (capture_count > UINT8_MAX) {
+        throw std::runtime_error("Lambda captures too many variables");
+    }
+
+    const size_t param_count = expr->parameters.size() + capture_count;
+    const size_t func_idx = bytecode_.add_function(
+        fmt::format("<lambda {}:{}>", expr->location.line, expr->location.column),
+        bytecode_.current_offset(),  // Set when the body is compiled
+        param_count, param_count);
+    emit(OpCode::MAKE_CLOSURE, static_cast<uint16_t>(func_idx), static_cast<uint8_t>(capture_count));
+    pending_lambdas_.push_back(PendingLambda{expr, func_idx, std::move(captures)});
 }
 
 // ===== Statement Visitors =====
 
 auto Compiler::visit_let(ast::LetStmt* stmt) -> void {
-    // Compile initializer
-    stmt->initializer->accept(*this);
+    LocationScope location_scope(*this, stmt->location);
+    // Compile initializer; a tuple the pattern takes apart at once is never built
+    SpreadValues spread;
+    push_spread(stmt->initializer.get(), stmt->pattern.get(), spread);
 
     // Compile pattern (handles variable declaration)
-    compile_pattern(stmt->pattern.get(), true);
+    store_spread(stmt->initializer.get(), stmt->pattern.get(), true, spread);
 }
 
 auto Compiler::visit_return(ast::ReturnStmt* stmt) -> void {
+    LocationScope location_scope(*this, stmt->location);
     // Compile return value
-    stmt->value->accept(*this);
+    compile_tail(stmt->value.get());
 
     // Emit return instruction
-    emit(OpCode::RETURN);
+    emit_return();
 }
 
 auto Compiler::visit_expr_stmt(ast::ExprStmt* stmt) -> void {
+    LocationScope location_scope(*this, stmt->location);
     // Compile expression
     stmt->expression->accept(*this);
 
@@ -470,6 +769,44 @@ auto Compiler::visit_expr_stmt(ast::ExprStmt* stmt) -> void {
     emit(OpCode::POP);
 }
 
+// Tail position: a call whose value is returned unchanged reuses the
+// caller's frame. The RETURN after it is then only reached by other paths.
+auto Compiler::compile_tail(ast::Expr* expr) -> void {
+    switch (expr->kind) {
+        case ast::ExprKind::Call:
+            compile_call(static_cast<ast::CallExpr*>(expr), true);
+            break;
+        case ast::ExprKind::If:
+            compile_if(static_cast<ast::IfExpr*>(expr), true);
+            break;
+        case ast::ExprKind::Block:
+            compile_block(static_cast<ast::BlockExpr*>(expr), true);
+            break;
+        case ast::ExprKind::Tuple:
+            if (unpacked_result_ > 0) {
+                // Left on the stack for RETURN_TUPLE
+                LocationScope location_scope(*this, expr->location);
+                for (const auto& element : static_cast<ast::TupleExpr*>(expr)->elements) {
+                    element->accept(*this);
+                }
+                break;
+            }
+            expr->accept(*this);
+            break;
+        default:
+            expr->accept(*this);
+            break;
+    }
+}
+
+auto Compiler::emit_return() -> void {
+    if (unpacked_result_ > 0) {
+        emit(OpCode::RETURN_TUPLE, static_cast<uint16_t>(unpacked_result_));
+    } else {
+        emit(OpCode::RETURN);
+    }
+}
+
 // ===== Pattern Compilation =====
 
 auto Compiler::compile_pattern(ast::Pattern* pattern, bool is_declaration) -> void {
@@ -479,11 +816,12 @@ auto Compiler::compile_pattern(ast::Pattern* pattern, bool is_declaration) -> vo
 
             if (is_declaration) {
                 // Declare new local variable
-                size_t local_idx = declare_local(id_pattern->name);
+                size_t local_idx = declare_local(*id_pattern);
                 emit(OpCode::STORE_LOCAL, static_cast<uint16_t>(local_idx));
             } else {
                 // Store to existing variable
-                int local_idx = resolve_local(id_pattern->name);
+                int local_idx = resolved_ ? static_cast<int>(id_pattern->slot)
+                                          : resolve_local(id_pattern->name);
                 if (local_idx >= 0) {
                     emit(OpCode::STORE_LOCAL, static_cast<uint16_t>(local_idx));
                 } else {
@@ -494,28 +832,90 @@ auto Compiler::compile_pattern(ast::Pattern* pattern, bool is_declaration) -> vo
         }
 
         case ast::PatternKind::Tuple: {
-            auto* tuple_pattern = static_cast<ast::TuplePattern*>(pattern);
-
-            // Tuple is on stack, we need to destructure it
-            // For each element, index into tuple and store
-            for (size_t i = 0; i < tuple_pattern->elements.size(); ++i) {
-                // Duplicate tuple on stack
-                emit(OpCode::DUP);
-
-                // Push index
-                uint16_t idx_const = add_constant(Value(static_cast<int64_t>(i)));
-                emit(OpCode::CONSTANT, idx_const);
-
-                // Index into tuple
-                emit(OpCode::INDEX);
+            auto& elements = static_cast<ast::TuplePattern*>(pattern)->elements;
+            if (elements.empty()) {
+                break;  // The tuple stays, as the value a pattern leaves
+            }
 
-                // Recursively compile pattern
-                compile_pattern(tuple_pattern->elements[i].get(), is_declaration);
+            // Tuple is on stack: replace it with its elements, the last on
+            // top, and store them from there. Each pattern leaves one value
+            // behind, as STORE_LOCAL does, so all but the first are popped.
+            emit(OpCode::UNPACK_TUPLE, static_cast<uint16_t>(elements.size()));
+            for (size_t i = elements.size(); i-- > 0;) {
+                compile_pattern(elements[i].get(), is_declaration);
+                if (i > 0) {
+                    emit(OpCode::POP);
+                }
             }
+            break;
+        }
+    }
+}
 
-            // Pop original tuple
+// A tuple literal of the pattern's size, or a direct call to a function
+// that returns its tuple unpacked
+auto Compiler::spreads(const ast::Expr* value, const ast::Pattern* pattern) -> bool {
+    if (pattern->kind != ast::PatternKind::Tuple) {
+        return false;
+    }
+    const size_t size = static_cast<const ast::TuplePattern*>(pattern)->elements.size();
+    if (size == 0) {
+        return false;
+    }
+    if (value->kind == ast::ExprKind::Tuple) {
+        return static_cast<const ast::TupleExpr*>(value)->elements.size() == size;
+    }
+    if (value->kind != ast::ExprKind::Call) {
+        return false;
+    }
+    const auto& callee = *static_cast<const ast::CallExpr*>(value)->callee;
+    if (callee.kind != ast::ExprKind::Identifier) {
+        return false;
+    }
+    const auto& identifier = static_cast<const ast::IdentifierExpr&>(callee);
+    auto unpacked = unpacked_results_.find(identifier.name);
+    return unpacked != unpacked_results_.end() && unpacked->second == size &&
+           resolve_function(identifier.name) >= 0 && resolve_local(identifier) < 0;
+}
+
+// Pushes every value before any is stored, so an element may still read a
+// name the pattern rebinds. `spread` records which values were pushed as
+// their elements, since storing can declare a local that changes spreads().
+auto Compiler::push_spread(ast::Expr* value, ast::Pattern* pattern, SpreadValues& spread) -> void {
+    if (!spreads(value, pattern)) {
+        value->accept(*this);
+        return;
+    }
+    spread.push_back(value);
+    if (value->kind == ast::ExprKind::Call) {
+        compile_call(static_cast<ast::CallExpr*>(value), false);
+        return;
+    }
+    LocationScope location_scope(*this, value->location);
+    auto& patterns = static_cast<ast::TuplePattern*>(pattern)->elements;
+    auto& elements = static_cast<ast::TupleExpr*>(value)->elements;
+    for (size_t i = 0; i < elements.size(); ++i) {
+        push_spread(elements[i].get(), patterns[i].get(), spread);
+    }
+}
+
+auto Compiler::store_spread(ast::Expr* value, ast::Pattern* pattern, bool is_declaration,
+                            const SpreadValues& spread) -> void {
+    if (std::find(spread.begin(), spread.end(), value) == spread.end()) {
+        compile_pattern(pattern, is_declaration);
+        return;
+    }
+    // As compile_pattern does after UNPACK_TUPLE
+    auto& patterns = static_cast<ast::TuplePattern*>(pattern)->elements;
+    for (size_t i = patterns.size(); i-- > 0;) {
+        if (value->kind == ast::ExprKind::Tuple) {
+            store_spread(static_cast<ast::TupleExpr*>(value)->elements[i].get(), patterns[i].get(),
+                         is_declaration, spread);
+        } else {
+            compile_pattern(patterns[i].get(), is_declaration);
+        }
+        if (i > 0) {
             emit(OpCode::POP);
-            break;
         }
     }
 }
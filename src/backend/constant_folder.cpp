@@ -0,0 +1,387 @@
+#include <lucid/backend/constant_folder.hpp>
+#include <lucid/backend/vm.hpp>
+#include <cmath>
+#include <memory>
+#include <optional>
+#include <string>
+#include <variant>
+
+namespace lucid::backend {
+
+namespace {
+
+// A literal operand: Int, Float, Bool or String
+using Literal = std::variant<int64_t, double, bool, std::string>;
+
+auto literal_of(const ast::Expr& expr) -> std::optional<Literal> {
+    switch (expr.kind) {
+        case ast::ExprKind::IntLiteral:
+            return Literal(static_cast<const ast::IntLiteralExpr&>(expr).value);
+        case ast::ExprKind::FloatLiteral:
+            return Literal(static_cast<const ast::FloatLiteralExpr&>(expr).value);
+        case ast::ExprKind::BoolLiteral:
+            return Literal(static_cast<const ast::BoolLiteralExpr&>(expr).value);
+        case ast::ExprKind::StringLiteral:
+            return Literal(static_cast<const ast::StringLiteralExpr&>(expr).value);
+        default:
+            return std::nullopt;
+    }
+}
+
+auto is_literal(const ast::Expr& expr) -> bool {
+    switch (expr.kind) {
+        case ast::ExprKind::IntLiteral:
+        case ast::ExprKind::FloatLiteral:
+        case ast::ExprKind::BoolLiteral:
+        case ast::ExprKind::StringLiteral:
+            return true;
+        case ast::ExprKind::Tuple:
+            return static_cast<const ast::TupleExpr&>(expr).is_constant;
+        case ast::ExprKind::List:
+            return static_cast<const ast::ListExpr&>(expr).is_constant;
+        default:
+            return false;
+    }
+}
+
+auto make_literal(const Literal& value, const ast::Expr& original) -> std::unique_ptr<ast::Expr> {
+    std::unique_ptr<ast::Expr> result;
+    if (const auto* i = std::get_if<int64_t>(&value)) {
+        result = std::make_unique<ast::IntLiteralExpr>(*i, original.location);
+    } else if (const auto* f = std::get_if<double>(&value)) {
+        result = std::make_unique<ast::FloatLiteralExpr>(*f, original.location);
+    } else if (const auto* b = std::get_if<bool>(&value)) {
+        result = std::make_unique<ast::BoolLiteralExpr>(*b, original.location);
+    } else {
+        result = std::make_unique<ast::StringLiteralExpr>(std::get<std::string>(value), original.location);
+    }
+    result->static_type = original.static_type;
+    return result;
+}
+
+// ===== Arithmetic =====
+// Mirrors VM::binary_* for the cases that cannot fail; anything else returns
+// nullopt and is left to the VM.
+
+auto as_double(const Literal& value) -> std::optional<double> {
+    if (const auto* i = std::get_if<int64_t>(&value)) {
+        return static_cast<double>(*i);
+    }
+    if (const auto* f = std::get_if<double>(&value)) {
+        return *f;
+    }
+    return std::nullopt;
+}
+
+auto fold_int_arithmetic(ast::BinaryOp op, int64_t a, int64_t b) -> std::optional<Literal> {
+    switch (op) {
+        case ast::BinaryOp::Add:
+            return Literal(VM::int_add(a, b));
+        case ast::BinaryOp::Sub:
+            return Literal(VM::int_sub(a, b));
+        case ast::BinaryOp::Mul:
+            return Literal(VM::int_mul(a, b));
+        case ast::BinaryOp::Div:
+            if (b == 0) return std::nullopt;  // "Division by zero" at run time
+            return Literal(VM::int_div(a, b));
+        case ast::BinaryOp::Mod:
+            if (b == 0) return std::nullopt;  // "Modulo by zero" at run time
+            return Literal(VM::int_mod(a, b));
+        case ast::BinaryOp::Pow: {
+            double power = std::pow(a, b);
+            // Only where the VM's conversion back to Int is well defined
+            if (!std::isfinite(power) || std::fabs(power) >= 9223372036854775808.0) {
+                return std::nullopt;
+            }
+            return Literal(static_cast<int64_t>(power));
+        }
+        default:
+            return std::nullopt;
+    }
+}
+
+auto fold_float_arithmetic(ast::BinaryOp op, double a, double b) -> std::optional<Literal> {
+    switch (op) {
+        case ast::BinaryOp::Add: return Literal(a + b);
+        case ast::BinaryOp::Sub: return Literal(a - b);
+        case ast::BinaryOp::Mul: return Literal(a * b);
+        case ast::BinaryOp::Div:
+            if (b == 0.0) return std::nullopt;  // "Division by zero" at run time
+            return Literal(a / b);
+        case ast::BinaryOp::Pow: return Literal(std::pow(a, b));
+        default:
+            return std::nullopt;  // Float modulo is a run-time error
+    }
+}
+
+// ===== Comparison =====
+// Value compares by type first: equality across types is false, ordering
+// across types throws, and Bool has no ordering.
+
+template <typename T>
+auto compare(ast::BinaryOp op, const T& a, const T& b) -> std::optional<Literal> {
+    switch (op) {
+        case ast::BinaryOp::Eq: return Literal(a == b);
+        case ast::BinaryOp::Ne: return Literal(a != b);
+        case ast::BinaryOp::Lt: return Literal(a < b);
+        case ast::BinaryOp::Gt: return Literal(a > b);
+        case ast::BinaryOp::Le: return Literal(a <= b);
+        case ast::BinaryOp::Ge: return Literal(a >= b);
+        default: return std::nullopt;
+    }
+}
+
+auto fold_comparison(ast::BinaryOp op, const Literal& a, const Literal& b) -> std::optional<Literal> {
+    bool is_equality = op == ast::BinaryOp::Eq || op == ast::BinaryOp::Ne;
+    if (a.index() != b.index()) {
+        if (!is_equality) {
+            return std::nullopt;
+        }
+        return Literal(op == ast::BinaryOp::Ne);
+    }
+    if (const auto* x = std::get_if<int64_t>(&a)) {
+        return compare(op, *x, std::get<int64_t>(b));
+    }
+    if (const auto* x = std::get_if<double>(&a)) {
+        return compare(op, *x, std::get<double>(b));
+    }
+    if (const auto* x = std::get_if<std::string>(&a)) {
+        return compare(op, *x, std::get<std::string>(b));
+    }
+    if (!is_equality) {
+        return std::nullopt;
+    }
+    return compare(op, std::get<bool>(a), std::get<bool>(b));
+}
+
+auto fold_binary(ast::BinaryOp op, const Literal& a, const Literal& b) -> std::optional<Literal> {
+    switch (op) {
+        case ast::BinaryOp::Eq: case ast::BinaryOp::Ne:
+        case ast::BinaryOp::Lt: case ast::BinaryOp::Gt:
+        case ast::BinaryOp::Le: case ast::BinaryOp::Ge:
+            return fold_comparison(op, a, b);
+        case ast::BinaryOp::And:
+        case ast::BinaryOp::Or: {
+            const auto* x = std::get_if<bool>(&a);
+            const auto* y = std::get_if<bool>(&b);
+            if (x == nullptr || y == nullptr) {
+                return std::nullopt;
+            }
+            return Literal(op == ast::BinaryOp::And ? (*x && *y) : (*x || *y));
+        }
+        default:
+            break;
+    }
+
+    const auto* x = std::get_if<int64_t>(&a);
+    const auto* y = std::get_if<int64_t>(&b);
+    if (x != nullptr && y != nullptr) {
+        return fold_int_arithmetic(op, *x, *y);
+    }
+    const auto* sx = std::get_if<std::string>(&a);
+    const auto* sy = std::get_if<std::string>(&b);
+    if (sx != nullptr && sy != nullptr) {
+        return op == ast::BinaryOp::Add ? std::optional<Literal>(*sx + *sy) : std::nullopt;
+    }
+    auto fx = as_double(a);
+    auto fy = as_double(b);
+    if (fx && fy) {
+        return fold_float_arithmetic(op, *fx, *fy);
+    }
+    return std::nullopt;
+}
+
+auto fold_unary(ast::UnaryOp op, const Literal& operand) -> std::optional<Literal> {
+    switch (op) {
+        case ast::UnaryOp::Not:
+            if (const auto* b = std::get_if<bool>(&operand)) {
+                return Literal(!*b);
+            }
+            return std::nullopt;
+        case ast::UnaryOp::Neg:
+            if (const auto* i = std::get_if<int64_t>(&operand)) {
+                return Literal(VM::int_negate(*i));
+            }
+            if (const auto* f = std::get_if<double>(&operand)) {
+                return Literal(-*f);
+            }
+            return std::nullopt;
+        case ast::UnaryOp::Pos:
+            if (std::holds_alternative<int64_t>(operand) || std::holds_alternative<double>(operand)) {
+                return operand;
+            }
+            return std::nullopt;
+    }
+    return std::nullopt;
+}
+
+// ===== Tree Walk =====
+
+class ConstantFolder {
+public:
+    auto run(ast::Program& program) -> FoldStats {
+        for (auto& function : program.functions) {
+            fold_block(*function->body);
+        }
+        return stats_;
+    }
+
+    auto run(ast::FunctionDef& function) -> FoldStats {
+        fold_block(*function.body);
+        return stats_;
+    }
+
+private:
+    FoldStats stats_;
+
+    auto fold_block(ast::BlockExpr& block) -> void {
+        for (auto& stmt : block.statements) {
+            fold_stmt(*stmt);
+        }
+    }
+
+    auto fold_stmt(ast::Stmt& stmt) -> void {
+        switch (stmt.kind) {
+            case ast::StmtKind::Let:
+                fold(static_cast<ast::LetStmt&>(stmt).initializer);
+                break;
+            case ast::StmtKind::Return:
+                fold(static_cast<ast::ReturnStmt&>(stmt).value);
+                break;
+            case ast::StmtKind::ExprStmt:
+                fold(static_cast<ast::ExprStmt&>(stmt).expression);
+                break;
+        }
+    }
+
+    auto fold_elements(std::vector<std::unique_ptr<ast::Expr>>& elements) -> bool {
+        bool all_literal = true;
+        for (auto& element : elements) {
+            fold(element);
+            all_literal = all_literal && is_literal(*element);
+        }
+        return all_literal;
+    }
+
+    // Folds `expr` bottom-up, replacing it when it reduces to a literal
+    auto fold(std::unique_ptr<ast::Expr>& expr) -> void {
+        switch (expr->kind) {
+            case ast::ExprKind::Binary: {
+                auto& binary = static_cast<ast::BinaryExpr&>(*expr);
+                fold(binary.left);
+                fold(binary.right);
+                auto left = literal_of(*binary.left);
+                auto right = literal_of(*binary.right);
+                if (left && right) {
+                    if (auto result = fold_binary(binary.op, *left, *right)) {
+                        expr = make_literal(*result, *expr);
+                        ++stats_.folded;
+                    }
+                }
+                break;
+            }
+            case ast::ExprKind::Unary: {
+                auto& unary = static_cast<ast::UnaryExpr&>(*expr);
+                fold(unary.operand);
+                if (auto operand = literal_of(*unary.operand)) {
+                    if (auto result = fold_unary(unary.op, *operand)) {
+                        expr = make_literal(*result, *expr);
+                        ++stats_.folded;
+                    }
+                }
+                break;
+            }
+            case ast::ExprKind::Tuple: {
+                auto& tuple = static_cast<ast::TupleExpr&>(*expr);
+                tuple.is_constant = fold_elements(tuple.elements);
+                if (tuple.is_constant) {
+                    ++stats_.constant_literals;
+                }
+                break;
+            }
+            case ast::ExprKind::List: {
+                auto& list = static_cast<ast::ListExpr&>(*expr);
+                list.is_constant = fold_elements(list.elements);
+                if (list.is_constant) {
+                    ++stats_.constant_literals;
+                }
+                break;
+            }
+            case ast::ExprKind::Call: {
+                auto& call = static_cast<ast::CallExpr&>(*expr);
+                fold(call.callee);
+                fold_elements(call.arguments);
+                break;
+            }
+            case ast::ExprKind::MethodCall: {
+                auto& call = static_cast<ast::MethodCallExpr&>(*expr);
+                fold(call.object);
+                fold_elements(call.arguments);
+                break;
+            }
+            case ast::ExprKind::Index: {
+                auto& index = static_cast<ast::IndexExpr&>(*expr);
+                fold(index.object);
+                fold(index.index);
+                break;
+            }
+            case ast::ExprKind::Lambda:
+                fold(static_cast<ast::LambdaExpr&>(*expr).body);
+                break;
+            case ast::ExprKind::If:
+                fold_if(expr);
+                break;
+            case ast::ExprKind::Block:
+                fold_block(static_cast<ast::BlockExpr&>(*expr));
+                break;
+            case ast::ExprKind::IntLiteral:
+            case ast::ExprKind::FloatLiteral:
+            case ast::ExprKind::StringLiteral:
+            case ast::ExprKind::BoolLiteral:
+            case ast::ExprKind::Identifier:
+                break;
+        }
+    }
+
+    // Blocks do not open a scope in the compiler, so the taken branch can
+    // stand in for the whole `if`
+    auto fold_if(std::unique_ptr<ast::Expr>& expr) -> void {
+        auto& if_expr = static_cast<ast::IfExpr&>(*expr);
+        fold(if_expr.condition);
+        fold(if_expr.then_branch);
+        if (if_expr.else_branch.has_value()) {
+            fold(if_expr.else_branch.value());
+        }
+
+        if (if_expr.condition->kind != ast::ExprKind::BoolLiteral) {
+            return;
+        }
+        bool condition = static_cast<const ast::BoolLiteralExpr&>(*if_expr.condition).value;
+        std::unique_ptr<ast::Expr> taken;
+        if (condition) {
+            taken = std::move(if_expr.then_branch);
+        } else if (if_expr.else_branch.has_value()) {
+            taken = std::move(if_expr.else_branch.value());
+        } else {
+            // A missing else evaluates to false
+            taken = std::make_unique<ast::BoolLiteralExpr>(false, if_expr.location);
+            taken->static_type = ast::StaticType::Bool;
+        }
+        expr = std::move(taken);
+        ++stats_.branches_pruned;
+    }
+};
+
+} // namespace
+
+auto fold_constants(ast::Program& program) -> FoldStats {
+    ConstantFolder folder;
+    return folder.run(program);
+}
+
+auto fold_constants(ast::FunctionDef& function) -> FoldStats {
+    ConstantFolder folder;
+    return folder.run(function);
+}
+
+} // namespace lucid::backend
@@ -0,0 +1,632 @@
+#include <lucid/backend/cpp_emitter.hpp>
+#include <lucid/backend/bytecode.hpp>
+#include <fmt/format.h>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <stdexcept>
+#include <unistd.h>
+
+namespace lucid::backend {
+
+namespace {
+
+auto unsupported(const SourceLocation& location, std::string_view what) -> std::runtime_error {
+    return std::runtime_error(fmt::format("{}:{}:{}: {} are not supported by the C++ backend",
+                                          location.filename, location.line, location.column, what));
+}
+
+// Built-in functions, resolved by name before user functions as in Compiler
+auto builtin_id(const std::string& name) -> std::optional<std::string_view> {
+    if (name == "print") return "PRINT";
+    if (name == "println") return "PRINTLN";
+    if (name == "to_string") return "TO_STRING";
+    if (name == "read_file") return "READ_FILE";
+    if (name == "write_file") return "WRITE_FILE";
+    if (name == "append_file") return "APPEND_FILE";
+    if (name == "file_exists") return "FILE_EXISTS";
+    if (name == "read_lines") return "READ_LINES";
+    if (name == "for_each_line") return "FOR_EACH_LINE";
+    return std::nullopt;
+}
+
+auto int_literal(int64_t value) -> std::string {
+    return value == INT64_MIN ? "INT64_MIN" : fmt::format("int64_t{{{}}}", value);
+}
+
+// Hexadecimal floats are exact
+auto float_literal(double value) -> std::string {
+    if (std::isnan(value)) {
+        return "std::numeric_limits<double>::quiet_NaN()";
+    }
+    if (std::isinf(value)) {
+        return value > 0 ? "std::numeric_limits<double>::infinity()"
+                         : "-std::numeric_limits<double>::infinity()";
+    }
+    return fmt::format("{:a}", value);
+}
+
+auto string_literal(const std::string& value) -> std::string {
+    std::string escaped;
+    for (char c : value) {
+        auto byte = static_cast<unsigned char>(c);
+        if (byte >= 0x20 && byte < 0x7f && c != '"' && c != '\\' && c != '?') {
+            escaped += c;
+        } else {
+            escaped += fmt::format("\\{:03o}", byte);
+        }
+    }
+    return fmt::format("rt::Value(std::string(\"{}\", {}))", escaped, value.size());
+}
+
+auto quote(const std::string& path) -> std::string {
+    std::string quoted = "'";
+    for (char c : path) {
+        quoted += c == '\'' ? std::string("'\\''") : std::string(1, c);
+    }
+    return quoted + "'";
+}
+
+} // namespace
+
+// ===== Types =====
+
+namespace {
+
+enum class Scalar { Int, Float, Bool, None };
+
+auto scalar_of(const ast::Type* type) -> Scalar {
+    if (type != nullptr && type->kind == ast::TypeKind::Named) {
+        const auto& name = static_cast<const ast::NamedType*>(type)->name;
+        if (name == "Int") return Scalar::Int;
+        if (name == "Float") return Scalar::Float;
+        if (name == "Bool") return Scalar::Bool;
+    }
+    return Scalar::None;
+}
+
+auto scalar_of(ast::StaticType type) -> Scalar {
+    switch (type) {
+        case ast::StaticType::Int: return Scalar::Int;
+        case ast::StaticType::Float: return Scalar::Float;
+        case ast::StaticType::Bool: return Scalar::Bool;
+        default: return Scalar::None;
+    }
+}
+
+} // namespace
+
+// ===== Program =====
+
+auto CppEmitter::emit(const ast::Program& program) -> std::string {
+    auto ctype = [](Scalar scalar) {
+        switch (scalar) {
+            case Scalar::Int: return CType::Int;
+            case Scalar::Float: return CType::Float;
+            case Scalar::Bool: return CType::Bool;
+            case Scalar::None: break;
+        }
+        return CType::Value;
+    };
+
+    functions_.clear();
+    for (const auto& function : program.functions) {
+        Signature sig;
+        for (const auto& param : function->parameters) {
+            sig.parameters.push_back(ctype(scalar_of(param->type.get())));
+        }
+        sig.result = ctype(scalar_of(function->return_type.get()));
+        functions_[function->name] = std::move(sig);
+    }
+
+    std::string out;
+    out += "// Generated by lucidc --emit-cpp. Build against lucid-core and fmt.\n\n";
+    out += "#include <lucid/backend/aot_runtime.hpp>\n";
+    out += "#include <cstdint>\n#include <limits>\n#include <string>\n#include <utility>\n\n";
+    out += "namespace rt = lucid::aot;\n\nnamespace {\n\n";
+
+    for (const auto& function : program.functions) {
+        out += signature(*function) + ";\n";
+    }
+    for (const auto& function : program.functions) {
+        out += fmt::format("\n{}", emit_function(*function));
+    }
+    out += "\n} // namespace\n";
+
+    auto main = functions_.find("main");
+    if (main != functions_.end()) {
+        if (!main->second.parameters.empty()) {
+            throw std::runtime_error("main() must not take parameters");
+        }
+        out += "\nint main() {\n    return rt::run([] { return f_main(); });\n}\n";
+    }
+    return out;
+}
+
+auto CppEmitter::signature(const ast::FunctionDef& function) -> std::string {
+    const auto& sig = functions_.at(function.name);
+    std::string params;
+    for (size_t i = 0; i < function.parameters.size(); ++i) {
+        params += fmt::format("{}{} v_{}", i == 0 ? "" : ", ",
+                              type_name(sig.parameters[i]), function.parameters[i]->name);
+    }
+    return fmt::format("auto f_{}({}) -> {}", function.name, params,
+                       type_name(sig.result));
+}
+
+auto CppEmitter::emit_function(const ast::FunctionDef& function) -> std::string {
+    const auto& sig = functions_.at(function.name);
+    current_ = &function;
+    scopes_.assign(1, {});
+    for (size_t i = 0; i < function.parameters.size(); ++i) {
+        const auto& name = function.parameters[i]->name;
+        scopes_.back()[name] = Operand{fmt::format("v_{}", name), sig.parameters[i]};
+    }
+    body_.str("");
+    indent_ = 1;
+    next_temp_ = 0;
+    self_tail_call_ = false;
+
+    // The body's value is returned, as in Compiler::compile_function
+    emit_block(*function.body, Destination{Destination::Kind::Return, "", sig.result});
+
+    std::string body = body_.str();
+    if (self_tail_call_) {
+        // Self tail calls reassign the parameters and start the body again
+        std::string looped = "    for (;;) {\n";
+        size_t start = 0;
+        while (start < body.size()) {
+            size_t end = body.find('\n', start);
+            looped += fmt::format("    {}", body.substr(start, end + 1 - start));
+            start = end + 1;
+        }
+        body = looped + "    }\n";
+    }
+
+    current_ = nullptr;
+    return fmt::format("{} {{\n    rt::Frame frame;\n{}}}\n", signature(function), body);
+}
+
+// ===== Statements =====
+
+auto CppEmitter::line(const std::string& code) -> void {
+    body_ << std::string(indent_ * 4, ' ') << code << '\n';
+}
+
+auto CppEmitter::emit_block(const ast::BlockExpr& block, const Destination& destination) -> void {
+    if (block.statements.empty()) {
+        deliver(Operand{"false", CType::Bool}, destination);
+        return;
+    }
+
+    scopes_.emplace_back();
+    for (size_t i = 0; i + 1 < block.statements.size(); ++i) {
+        emit_stmt(*block.statements[i]);
+    }
+
+    // The last statement gives the block its value; a trailing let leaves
+    // the bound value, as the VM does
+    const auto& last = *block.statements.back();
+    switch (last.kind) {
+        case ast::StmtKind::ExprStmt:
+            emit_into(*static_cast<const ast::ExprStmt&>(last).expression, destination);
+            break;
+        case ast::StmtKind::Let:
+            deliver(emit_let(static_cast<const ast::LetStmt&>(last)), destination);
+            break;
+        case ast::StmtKind::Return:
+            emit_stmt(last);
+            break;
+    }
+    scopes_.pop_back();
+}
+
+auto CppEmitter::emit_stmt(const ast::Stmt& stmt) -> void {
+    switch (stmt.kind) {
+        case ast::StmtKind::Let:
+            emit_let(static_cast<const ast::LetStmt&>(stmt));
+            break;
+        case ast::StmtKind::Return:
+            emit_into(*static_cast<const ast::ReturnStmt&>(stmt).value,
+                      Destination{Destination::Kind::Return, "", functions_.at(current_->name).result});
+            break;
+        case ast::StmtKind::ExprStmt:
+            emit_into(*static_cast<const ast::ExprStmt&>(stmt).expression,
+                      Destination{Destination::Kind::Discard, "", CType::Value});
+            break;
+    }
+}
+
+auto CppEmitter::emit_let(const ast::LetStmt& stmt) -> Operand {
+    Operand value = emit_expr(*stmt.initializer);
+    bind_pattern(*stmt.pattern, value);
+    return value;
+}
+
+auto CppEmitter::bind_pattern(const ast::Pattern& pattern, const Operand& value) -> void {
+    if (pattern.kind == ast::PatternKind::Identifier) {
+        const auto& name = static_cast<const ast::IdentifierPattern&>(pattern).name;
+        Operand local{fmt::format("l{}_{}", next_temp_++, name), value.type};
+        line(fmt::format("{} {} = {};", type_name(local.type), local.code, value.code));
+        scopes_.back()[name] = local;
+        return;
+    }
+
+    // Tuple elements are read back out of the tuple Value
+    const auto& tuple = static_cast<const ast::TuplePattern&>(pattern);
+    Operand source = temp(CType::Value, convert(value, CType::Value));
+    for (size_t i = 0; i < tuple.elements.size(); ++i) {
+        bind_pattern(*tuple.elements[i],
+                     Operand{fmt::format("rt::index({}, rt::Value({}))", source.code,
+                                         int_literal(static_cast<int64_t>(i))),
+                             CType::Value});
+    }
+}
+
+auto CppEmitter::deliver(const Operand& value, const Destination& destination) -> void {
+    switch (destination.kind) {
+        case Destination::Kind::Discard:
+            break;
+        case Destination::Kind::Assign:
+            line(fmt::format("{} = {};", destination.variable, convert(value, destination.type)));
+            break;
+        case Destination::Kind::Return:
+            line(fmt::format("return {};", convert(value, destination.type)));
+            break;
+    }
+}
+
+// ===== Control Flow =====
+
+auto CppEmitter::emit_into(const ast::Expr& expr, const Destination& destination) -> void {
+    switch (expr.kind) {
+        case ast::ExprKind::If:
+            emit_if(static_cast<const ast::IfExpr&>(expr), destination);
+            break;
+        case ast::ExprKind::Block:
+            emit_block(static_cast<const ast::BlockExpr&>(expr), destination);
+            break;
+        case ast::ExprKind::Call:
+            if (destination.kind == Destination::Kind::Return && is_self_call(expr)) {
+                emit_self_tail_call(static_cast<const ast::CallExpr&>(expr));
+                break;
+            }
+            [[fallthrough]];
+        default:
+            deliver(emit_expr(expr), destination);
+            break;
+    }
+}
+
+auto CppEmitter::emit_if(const ast::IfExpr& expr, const Destination& destination) -> void {
+    Operand condition = emit_expr(*expr.condition);
+    line(fmt::format("if ({}) {{", condition.type == CType::Bool ? condition.code
+                                                                  : fmt::format("rt::truthy({})", condition.code)));
+    ++indent_;
+    emit_into(*expr.then_branch, destination);
+    --indent_;
+
+    // Without an else the value is false, as in Compiler::compile_if
+    if (expr.else_branch.has_value() || destination.kind != Destination::Kind::Discard) {
+        line("} else {");
+        ++indent_;
+        if (expr.else_branch.has_value()) {
+            emit_into(**expr.else_branch, destination);
+        } else {
+            deliver(Operand{"false", CType::Bool}, destination);
+        }
+        --indent_;
+    }
+    line("}");
+}
+
+auto CppEmitter::is_self_call(const ast::Expr& expr) const -> bool {
+    const auto& call = static_cast<const ast::CallExpr&>(expr);
+    if (call.callee->kind != ast::ExprKind::Identifier) {
+        return false;
+    }
+    const auto& name = static_cast<const ast::IdentifierExpr&>(*call.callee).name;
+    return name == current_->name && !builtin_id(name);
+}
+
+auto CppEmitter::emit_self_tail_call(const ast::CallExpr& expr) -> void {
+    const auto& sig = functions_.at(current_->name);
+
+    // All arguments are evaluated before any parameter changes, so those
+    // that read a parameter are copied first
+    std::vector<Operand> args;
+    for (size_t i = 0; i < expr.arguments.size(); ++i) {
+        Operand arg = emit_expr(*expr.arguments[i]);
+        if (arg.type != sig.parameters[i] || arg.code.starts_with("v_")) {
+            arg = temp(sig.parameters[i], convert(arg, sig.parameters[i]));
+        }
+        args.push_back(arg);
+    }
+    for (size_t i = 0; i < args.size(); ++i) {
+        line(fmt::format("v_{} = std::move({});", current_->parameters[i]->name, args[i].code));
+    }
+    line("continue;");
+    self_tail_call_ = true;
+}
+
+// ===== Expressions =====
+
+auto CppEmitter::emit_expr(const ast::Expr& expr) -> Operand {
+    switch (expr.kind) {
+        case ast::ExprKind::IntLiteral:
+            return Operand{int_literal(static_cast<const ast::IntLiteralExpr&>(expr).value), CType::Int};
+        case ast::ExprKind::FloatLiteral:
+            return Operand{float_literal(static_cast<const ast::FloatLiteralExpr&>(expr).value), CType::Float};
+        case ast::ExprKind::BoolLiteral:
+            return Operand{static_cast<const ast::BoolLiteralExpr&>(expr).value ? "true" : "false", CType::Bool};
+        case ast::ExprKind::StringLiteral:
+            return Operand{string_literal(static_cast<const ast::StringLiteralExpr&>(expr).value), CType::Value};
+
+        case ast::ExprKind::Identifier: {
+            const auto& name = static_cast<const ast::IdentifierExpr&>(expr).name;
+            for (auto it = scopes_.rbegin(); it != scopes_.rend(); ++it) {
+                auto found = it->find(name);
+                if (found != it->end()) {
+                    return found->second;
+                }
+            }
+            if (functions_.count(name) != 0) {
+                throw unsupported(expr.location, "Function values");
+            }
+            throw std::runtime_error(fmt::format("Undefined identifier: {}", name));
+        }
+
+        case ast::ExprKind::Tuple:
+            return temp(CType::Value, fmt::format("rt::tuple({{{}}})",
+                emit_values(static_cast<const ast::TupleExpr&>(expr).elements)));
+        case ast::ExprKind::List:
+            return temp(CType::Value, fmt::format("rt::list({{{}}})",
+                emit_values(static_cast<const ast::ListExpr&>(expr).elements)));
+
+        case ast::ExprKind::Binary:
+            return emit_binary(static_cast<const ast::BinaryExpr&>(expr));
+        case ast::ExprKind::Unary:
+            return emit_unary(static_cast<const ast::UnaryExpr&>(expr));
+        case ast::ExprKind::Call:
+            return emit_call(static_cast<const ast::CallExpr&>(expr));
+        case ast::ExprKind::MethodCall:
+            return emit_method_call(static_cast<const ast::MethodCallExpr&>(expr));
+
+        case ast::ExprKind::Index: {
+            const auto& index = static_cast<const ast::IndexExpr&>(expr);
+            Operand object = emit_expr(*index.object);
+            Operand position = emit_expr(*index.index);
+            return unboxed(fmt::format("rt::index({}, {})", convert(object, CType::Value),
+                                       convert(position, CType::Value)), expr);
+        }
+
+        case ast::ExprKind::Lambda:
+            throw unsupported(expr.location, "Lambda expressions");
+
+        case ast::ExprKind::If:
+        case ast::ExprKind::Block: {
+            // An if without else may be false instead of its branch type
+            bool partial = expr.kind == ast::ExprKind::If &&
+                           !static_cast<const ast::IfExpr&>(expr).else_branch.has_value();
+            Operand result = unboxed("", expr);
+            if (partial) {
+                result.type = CType::Value;
+            }
+            line(fmt::format("{} {}{{}};", type_name(result.type), result.code));
+            emit_into(expr, Destination{Destination::Kind::Assign, result.code, result.type});
+            return result;
+        }
+    }
+    throw std::runtime_error("Unknown expression kind");
+}
+
+auto CppEmitter::emit_values(const std::vector<std::unique_ptr<ast::Expr>>& exprs) -> std::string {
+    std::vector<Operand> values;
+    for (const auto& expr : exprs) {
+        values.push_back(emit_expr(*expr));
+    }
+    std::string list;
+    for (size_t i = 0; i < values.size(); ++i) {
+        list += fmt::format("{}{}", i == 0 ? "" : ", ", convert(values[i], CType::Value));
+    }
+    return list;
+}
+
+auto CppEmitter::emit_binary(const ast::BinaryExpr& expr) -> Operand {
+    using Op = ast::BinaryOp;
+    Operand left = emit_expr(*expr.left);
+    Operand right = emit_expr(*expr.right);
+
+    // Both operands are evaluated, as with the VM's AND and OR
+    if (expr.op == Op::And || expr.op == Op::Or) {
+        auto truthy = [](const Operand& operand) {
+            return operand.type == CType::Bool ? operand.code : fmt::format("rt::truthy({})", operand.code);
+        };
+        return temp(CType::Bool, fmt::format("{} {} {}", truthy(left),
+                                             expr.op == Op::And ? "&&" : "||", truthy(right)));
+    }
+
+    // Result of the overload aot_runtime.hpp picks for these operand types
+    bool ints = left.type == CType::Int && right.type == CType::Int;
+    bool numbers = (left.type == CType::Int || left.type == CType::Float) &&
+                   (right.type == CType::Int || right.type == CType::Float);
+    CType type = CType::Value;
+    const char* name = "";
+    switch (expr.op) {
+        case Op::Add: name = "add"; break;
+        case Op::Sub: name = "sub"; break;
+        case Op::Mul: name = "mul"; break;
+        case Op::Div: name = "div"; break;
+        case Op::Mod: name = "mod"; break;
+        case Op::Pow: name = "pow"; break;
+        case Op::Eq: name = "eq"; break;
+        case Op::Ne: name = "ne"; break;
+        case Op::Lt: name = "lt"; break;
+        case Op::Gt: name = "gt"; break;
+        case Op::Le: name = "le"; break;
+        case Op::Ge: name = "ge"; break;
+        case Op::And:
+        case Op::Or: break;
+    }
+    switch (expr.op) {
+        case Op::Add:
+        case Op::Sub:
+        case Op::Mul:
+        case Op::Div:
+            type = ints ? CType::Int : numbers ? CType::Float : CType::Value;
+            break;
+        case Op::Mod:
+            type = ints ? CType::Int : CType::Value;
+            break;
+        case Op::Pow:
+            type = CType::Value;
+            break;
+        default:
+            type = CType::Bool;
+            break;
+    }
+    return temp(type, fmt::format("rt::{}({}, {})", name, left.code, right.code));
+}
+
+auto CppEmitter::emit_unary(const ast::UnaryExpr& expr) -> Operand {
+    Operand operand = emit_expr(*expr.operand);
+    if (expr.op == ast::UnaryOp::Not) {
+        return temp(CType::Bool, operand.type == CType::Bool ? fmt::format("!{}", operand.code)
+                                                             : fmt::format("!rt::truthy({})", operand.code));
+    }
+
+    const char* name = expr.op == ast::UnaryOp::Neg ? "negate" : "positive";
+    if (operand.type == CType::Int || operand.type == CType::Float) {
+        return temp(operand.type, fmt::format("rt::{}({})", name, operand.code));
+    }
+    return temp(CType::Value, fmt::format("rt::{}({})", name, convert(operand, CType::Value)));
+}
+
+auto CppEmitter::emit_call(const ast::CallExpr& expr) -> Operand {
+    if (expr.callee->kind != ast::ExprKind::Identifier) {
+        throw unsupported(expr.location, "Calls through function values");
+    }
+    const auto& name = static_cast<const ast::IdentifierExpr&>(*expr.callee).name;
+
+    if (auto id = builtin_id(name)) {
+        std::string args = emit_values(expr.arguments);
+        return unboxed(fmt::format("rt::call_builtin(lucid::backend::BuiltinId::{}, {{{}}})", *id, args), expr);
+    }
+
+    auto function = functions_.find(name);
+    if (function == functions_.end()) {
+        throw unsupported(expr.location, "Calls through function values");
+    }
+
+    std::vector<Operand> values;
+    for (const auto& arg : expr.arguments) {
+        values.push_back(emit_expr(*arg));
+    }
+    std::string args;
+    for (size_t i = 0; i < values.size(); ++i) {
+        args += fmt::format("{}{}", i == 0 ? "" : ", ", convert(values[i], function->second.parameters[i]));
+    }
+    return temp(function->second.result, fmt::format("f_{}({})", name, args));
+}
+
+auto CppEmitter::emit_method_call(const ast::MethodCallExpr& expr) -> Operand {
+    Operand receiver = emit_expr(*expr.object);
+    std::string args = emit_values(expr.arguments);
+    return unboxed(fmt::format("rt::call_method(\"{}\", {}, {{{}}})", expr.method_name,
+                               convert(receiver, CType::Value), args), expr);
+}
+
+// ===== Helpers =====
+
+auto CppEmitter::type_name(CType type) -> const char* {
+    switch (type) {
+        case CType::Int: return "int64_t";
+        case CType::Float: return "double";
+        case CType::Bool: return "bool";
+        case CType::Value: break;
+    }
+    return "rt::Value";
+}
+
+auto CppEmitter::temp(CType type, const std::string& init) -> Operand {
+    Operand operand{fmt::format("t{}", next_temp_++), type};
+    line(fmt::format("{} {} = {};", type_name(type), operand.code, init));
+    return operand;
+}
+
+auto CppEmitter::convert(const Operand& value, CType type) -> std::string {
+    if (value.type == type) {
+        return value.code;
+    }
+    if (type == CType::Value) {
+        return fmt::format("rt::Value({})", value.code);
+    }
+
+    // Unboxing checks the type like Value's accessors do
+    static constexpr const char* kAccessors[] = {"as_int", "as_float", "as_bool"};
+    const char* accessor = kAccessors[static_cast<size_t>(type)];
+    if (value.type == CType::Value) {
+        return fmt::format("{}.{}()", value.code, accessor);
+    }
+    return fmt::format("rt::box({}).{}()", value.code, accessor);
+}
+
+// `value_code` as the C++ type of the checker's static type for `expr`; with
+// no code, just names a new temporary of that type
+auto CppEmitter::unboxed(const std::string& value_code, const ast::Expr& expr) -> Operand {
+    CType type = CType::Value;
+    switch (scalar_of(expr.static_type)) {
+        case Scalar::Int: type = CType::Int; break;
+        case Scalar::Float: type = CType::Float; break;
+        case Scalar::Bool: type = CType::Bool; break;
+        case Scalar::None: break;
+    }
+    if (value_code.empty()) {
+        return Operand{fmt::format("t{}", next_temp_++), type};
+    }
+    return temp(type, convert(Operand{value_code, CType::Value}, type));
+}
+
+// ===== Native Build =====
+
+auto CppEmitter::build_command(const std::string& cpp_file, const std::string& output) -> std::string {
+#if defined(LUCID_AOT_CXX) && defined(LUCID_AOT_CXXFLAGS) && defined(LUCID_AOT_LIBS)
+    const char* cxx = std::getenv("CXX");
+    return fmt::format("{} {} -w -o {} {} {}", cxx != nullptr && *cxx != '\0' ? cxx : LUCID_AOT_CXX,
+                       LUCID_AOT_CXXFLAGS, quote(output), quote(cpp_file), LUCID_AOT_LIBS);
+#else
+    (void)cpp_file;
+    (void)output;
+    (void)quote;
+    throw std::runtime_error("This lucidc was built without native compilation support");
+#endif
+}
+
+auto CppEmitter::build_executable(const std::string& cpp_source, const std::string& output,
+                                  bool verbose) -> void {
+    static std::atomic<unsigned> counter{0};
+    auto cpp_file = std::filesystem::temp_directory_path() /
+                    fmt::format("lucid-aot-{}-{}.cpp", ::getpid(), counter++);
+    std::string command = build_command(cpp_file.string(), output);
+    {
+        std::ofstream file(cpp_file, std::ios::binary);
+        if (!file) {
+            throw std::runtime_error(fmt::format("Could not write {}", cpp_file.string()));
+        }
+        file << cpp_source;
+    }
+
+    if (verbose) fmt::print("{}\n", command);
+    int status = std::system(command.c_str());
+    std::error_code ec;
+    std::filesystem::remove(cpp_file, ec);
+    if (status != 0) {
+        throw std::runtime_error(fmt::format("C++ compiler failed (status {}): {}", status, command));
+    }
+}
+
+} // namespace lucid::backend
@@ -0,0 +1,277 @@
+#include <lucid/backend/escape_analysis.hpp>
+#include <lucid/backend/bytecode.hpp>
+#include <unordered_set>
+#include <vector>
+
+namespace lucid::backend {
+
+namespace {
+
+// Calls `on_expr` on each expression directly inside `expr`, and `on_stmt`
+// on each statement of a block
+template <typename OnExpr, typename OnStmt>
+auto for_each_child(const ast::Expr& expr, OnExpr&& on_expr, OnStmt&& on_stmt) -> void {
+    auto all = [&](const std::vector<std::unique_ptr<ast::Expr>>& exprs) {
+        for (const auto& element : exprs) {
+            on_expr(*element);
+        }
+    };
+    switch (expr.kind) {
+        case ast::ExprKind::Tuple:
+            all(static_cast<const ast::TupleExpr&>(expr).elements);
+            break;
+        case ast::ExprKind::List:
+            all(static_cast<const ast::ListExpr&>(expr).elements);
+            break;
+        case ast::ExprKind::Binary: {
+            const auto& binary = static_cast<const ast::BinaryExpr&>(expr);
+            on_expr(*binary.left);
+            on_expr(*binary.right);
+            break;
+        }
+        case ast::ExprKind::Unary:
+            on_expr(*static_cast<const ast::UnaryExpr&>(expr).operand);
+            break;
+        case ast::ExprKind::Call: {
+            const auto& call = static_cast<const ast::CallExpr&>(expr);
+            on_expr(*call.callee);
+            all(call.arguments);
+            break;
+        }
+        case ast::ExprKind::MethodCall: {
+            const auto& call = static_cast<const ast::MethodCallExpr&>(expr);
+            on_expr(*call.object);
+            all(call.arguments);
+            break;
+        }
+        case ast::ExprKind::Index: {
+            const auto& index = static_cast<const ast::IndexExpr&>(expr);
+            on_expr(*index.object);
+            on_expr(*index.index);
+            break;
+        }
+        case ast::ExprKind::Lambda:
+            on_expr(*static_cast<const ast::LambdaExpr&>(expr).body);
+            break;
+        case ast::ExprKind::If: {
+            const auto& if_expr = static_cast<const ast::IfExpr&>(expr);
+            on_expr(*if_expr.condition);
+            on_expr(*if_expr.then_branch);
+            if (if_expr.else_branch.has_value()) {
+                on_expr(**if_expr.else_branch);
+            }
+            break;
+        }
+        case ast::ExprKind::Block:
+            for (const auto& stmt : static_cast<const ast::BlockExpr&>(expr).statements) {
+                on_stmt(*stmt);
+            }
+            break;
+        case ast::ExprKind::IntLiteral:
+        case ast::ExprKind::FloatLiteral:
+        case ast::ExprKind::StringLiteral:
+        case ast::ExprKind::BoolLiteral:
+        case ast::ExprKind::Identifier:
+            break;
+    }
+}
+
+auto stmt_value(const ast::Stmt& stmt) -> const ast::Expr& {
+    switch (stmt.kind) {
+        case ast::StmtKind::Let:
+            return *static_cast<const ast::LetStmt&>(stmt).initializer;
+        case ast::StmtKind::Return:
+            return *static_cast<const ast::ReturnStmt&>(stmt).value;
+        case ast::StmtKind::ExprStmt:
+            break;
+    }
+    return *static_cast<const ast::ExprStmt&>(stmt).expression;
+}
+
+// The size of the tuple literals one function returns
+class Results {
+public:
+    explicit Results(const ast::FunctionDef& function) {
+        add_tail(*function.body);
+        add_returns(*function.body);
+    }
+
+    // Zero unless every result is a tuple literal of this size
+    auto size() const -> size_t { return escapes_ ? 0 : size_; }
+
+private:
+    auto add_size(size_t size) -> void {
+        if (size == 0 || (size_ != 0 && size_ != size)) {
+            escapes_ = true;
+        }
+        size_ = size;
+    }
+
+    // A value in tail position, walked as Compiler::compile_tail walks it
+    auto add_tail(const ast::Expr& expr) -> void {
+        switch (expr.kind) {
+            case ast::ExprKind::Tuple:
+                add_size(static_cast<const ast::TupleExpr&>(expr).elements.size());
+                break;
+            case ast::ExprKind::If: {
+                const auto& if_expr = static_cast<const ast::IfExpr&>(expr);
+                if (!if_expr.else_branch.has_value()) {
+                    escapes_ = true;  // The missing branch is a Bool
+                    break;
+                }
+                add_tail(*if_expr.then_branch);
+                add_tail(**if_expr.else_branch);
+                break;
+            }
+            case ast::ExprKind::Block: {
+                const auto& statements = static_cast<const ast::BlockExpr&>(expr).statements;
+                if (statements.empty()) {
+                    escapes_ = true;
+                } else if (statements.back()->kind == ast::StmtKind::ExprStmt) {
+                    add_tail(stmt_value(*statements.back()));
+                } else if (statements.back()->kind == ast::StmtKind::Let) {
+                    escapes_ = true;  // The block's value is the bound one
+                }
+                break;  // A last `return` is one of add_returns
+            }
+            default:
+                escapes_ = true;
+                break;
+        }
+    }
+
+    // Every `return` in the function, but not in its lambdas
+    auto add_returns(const ast::Expr& expr) -> void {
+        if (expr.kind == ast::ExprKind::Lambda) {
+            return;
+        }
+        for_each_child(
+            expr,
+            [this](const ast::Expr& child) { add_returns(child); },
+            [this](const ast::Stmt& stmt) {
+                if (stmt.kind == ast::StmtKind::Return) {
+                    add_tail(stmt_value(stmt));
+                }
+                add_returns(stmt_value(stmt));
+            });
+    }
+
+    size_t size_ = 0;
+    bool escapes_ = false;
+};
+
+// How each name is used in one function
+class Uses {
+public:
+    Uses(const ast::FunctionDef& function, ResultUses& uses) : uses_(uses) { visit(*function.body); }
+
+private:
+    auto visit(const ast::Expr& expr) -> void {
+        if (expr.kind == ast::ExprKind::Identifier) {
+            uses_.escaping.insert(static_cast<const ast::IdentifierExpr&>(expr).name);
+            return;
+        }
+        for_each_child(
+            expr,
+            [this](const ast::Expr& child) { visit(child); },
+            [this](const ast::Stmt& stmt) { visit(stmt); });
+    }
+
+    auto visit(const ast::Stmt& stmt) -> void {
+        const ast::Expr& value = stmt_value(stmt);
+        if (stmt.kind == ast::StmtKind::Let && value.kind == ast::ExprKind::Call) {
+            const auto& let = static_cast<const ast::LetStmt&>(stmt);
+            const auto& call = static_cast<const ast::CallExpr&>(value);
+            if (let.pattern->kind == ast::PatternKind::Tuple &&
+                call.callee->kind == ast::ExprKind::Identifier) {
+                const auto& name = static_cast<const ast::IdentifierExpr&>(*call.callee).name;
+                const size_t size = static_cast<const ast::TuplePattern&>(*let.pattern).elements.size();
+                auto [it, inserted] = uses_.spread.try_emplace(name, size);
+                if (!inserted && it->second != size) {
+                    uses_.escaping.insert(name);
+                }
+                for (const auto& arg : call.arguments) {
+                    visit(*arg);
+                }
+                return;
+            }
+        }
+        visit(value);
+    }
+
+    ResultUses& uses_;
+};
+
+// Calls to these compile to CALL_BUILTIN whatever the program defines
+auto is_builtin(const std::string& name) -> bool {
+    for (uint16_t id = 0;; ++id) {
+        const auto builtin = builtin_name(static_cast<BuiltinId>(id));
+        if (builtin == "UNKNOWN_BUILTIN") {
+            return false;
+        }
+        if (builtin == name) {
+            return true;
+        }
+    }
+}
+
+} // namespace
+
+auto find_unpacked_results(const ast::Program& program) -> UnpackedResults {
+    std::vector<ResultUses> uses;
+    ProgramUses program_uses;
+    for (const auto& function : program.functions) {
+        uses.push_back(result_uses(*function));
+        program_uses.add(uses.back());
+    }
+    UnpackedResults unpacked;
+    for (size_t i = 0; i < uses.size(); ++i) {
+        const auto& name = program.functions[i]->name;
+        if (size_t size = program_uses.unpacked_size(name, uses[i]); size > 0) {
+            unpacked.emplace(name, size);
+        }
+    }
+    return unpacked;
+}
+
+auto result_uses(const ast::FunctionDef& function) -> ResultUses {
+    ResultUses uses;
+    uses.result_size = Results(function).size();
+    Uses{function, uses};
+    return uses;
+}
+
+auto ProgramUses::unpacked_size(const std::string& name, const ResultUses& uses) const -> size_t {
+    // Every call destructures the result into a pattern of its size
+    if (uses.result_size == 0 || escaping_.contains(name) || is_builtin(name)) {
+        return 0;
+    }
+    auto found = spread_.find(name);
+    if (found == spread_.end() || found->second.size() != 1) {
+        return 0;
+    }
+    return found->second.begin()->first == uses.result_size ? uses.result_size : 0;
+}
+
+auto ProgramUses::count(const ResultUses& uses, int delta) -> void {
+    auto step = [delta](size_t& counter) {
+        counter = delta > 0 ? counter + 1 : counter - 1;
+        return counter == 0;
+    };
+    for (const auto& [name, size] : uses.spread) {
+        auto& sizes = spread_[name];
+        if (step(sizes[size])) {
+            sizes.erase(size);
+        }
+        if (sizes.empty()) {
+            spread_.erase(name);
+        }
+    }
+    for (const auto& name : uses.escaping) {
+        if (step(escaping_[name])) {
+            escaping_.erase(name);
+        }
+    }
+}
+
+} // namespace lucid::backend
@@ -0,0 +1,288 @@
+#include <lucid/backend/file_io.hpp>
+#include <fmt/format.h>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+
+#if __has_include(<sys/mman.h>)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define LUCID_HAS_MMAP 1
+#else
+#define LUCID_HAS_MMAP 0
+#endif
+
+namespace lucid::backend {
+
+// ===== MappedFile =====
+
+MappedFile::MappedFile(const std::string& filename, std::string_view what) {
+#if LUCID_HAS_MMAP
+    int fd = ::open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::runtime_error(fmt::format("Cannot open {}: {}", what, filename));
+    }
+    struct stat info {};
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        throw std::runtime_error(fmt::format("Cannot stat {}: {}", what, filename));
+    }
+    size_ = static_cast<size_t>(info.st_size);
+    if (size_ > 0) {
+        void* address = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (address == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error(fmt::format("Cannot map {}: {}", what, filename));
+        }
+        data_ = static_cast<const uint8_t*>(address);
+    }
+    ::close(fd);
+#else
+    std::ifstream file(filename, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error(fmt::format("Cannot open {}: {}", what, filename));
+    }
+    buffer_.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    data_ = buffer_.data();
+    size_ = buffer_.size();
+#endif
+}
+
+MappedFile::~MappedFile() {
+#if LUCID_HAS_MMAP
+    if (data_ != nullptr) {
+        ::munmap(const_cast<uint8_t*>(data_), size_);
+    }
+#endif
+}
+
+// ===== LineReader =====
+
+namespace {
+
+auto without_cr(std::string_view line) -> std::string_view {
+    if (!line.empty() && line.back() == '\r') {
+        line.remove_suffix(1);
+    }
+    return line;
+}
+
+} // namespace
+
+LineReader::LineReader(const std::string& filename)
+    : file_(std::fopen(filename.c_str(), "rb"))
+    , buffer_(kChunkSize)
+{
+    if (file_) {
+        // Reads are already a chunk at a time
+        std::setvbuf(file_.get(), nullptr, _IONBF, 0);
+    }
+}
+
+auto LineReader::next(std::string_view& line) -> bool {
+    if (!file_) {
+        return false;
+    }
+    for (;;) {
+        const char* start = buffer_.data() + begin_;
+        if (const void* newline = std::memchr(start, '\n', end_ - begin_)) {
+            const auto length = static_cast<size_t>(static_cast<const char*>(newline) - start);
+            begin_ += length + 1;
+            line = without_cr({start, length});
+            return true;
+        }
+        if (at_eof_) {
+            if (begin_ == end_) {
+                return false;
+            }
+            line = without_cr({start, end_ - begin_});
+            begin_ = end_;
+            return true;
+        }
+
+        // Keep the partial line at the front and read more after it
+        std::memmove(buffer_.data(), start, end_ - begin_);
+        end_ -= begin_;
+        begin_ = 0;
+        if (end_ == buffer_.size()) {
+            buffer_.resize(buffer_.size() * 2);  // A line longer than the buffer
+        }
+        const size_t read = std::fread(buffer_.data() + end_, 1, buffer_.size() - end_, file_.get());
+        end_ += read;
+        at_eof_ = read == 0;
+    }
+}
+
+// ===== Writing =====
+
+auto replace_file(const std::string& filename, std::span<const uint8_t> bytes, bool executable)
+    -> std::error_code {
+    namespace fs = std::filesystem;
+
+    // Replace what a symlink points to, not the link
+    std::error_code error;
+    fs::path target = filename;
+    if (fs::is_symlink(target, error)) {
+        target = fs::canonical(target, error);
+        if (error) {
+            return error;
+        }
+    }
+
+    // Unique per process and per call, so concurrent writers never share one
+    static std::atomic<uint64_t> temp_counter{0};
+#if LUCID_HAS_MMAP
+    const std::string temp = fmt::format("{}.{}.{}.tmp", target.string(), ::getpid(), temp_counter++);
+#else
+    const std::string temp = fmt::format("{}.{}.tmp", target.string(), temp_counter++);
+#endif
+    {
+        std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            return {errno, std::generic_category()};
+        }
+        file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        if (!file) {
+            std::remove(temp.c_str());
+            return std::make_error_code(std::errc::io_error);
+        }
+    }
+
+    using fs::perms;
+    const auto existing = fs::status(target, error);
+    error.clear();
+    if (executable) {
+        fs::permissions(temp, perms::owner_all | perms::group_read | perms::group_exec |
+                                  perms::others_read | perms::others_exec, error);
+    } else if (fs::exists(existing)) {
+        fs::permissions(temp, existing.permissions(), error);  // Keep the file's mode
+    }
+    if (!error) {
+        fs::rename(temp, target, error);
+    }
+    if (error) {
+        std::remove(temp.c_str());
+    }
+    return error;
+}
+
+// ===== Builtins =====
+
+namespace {
+
+using FilePtr = std::unique_ptr<std::FILE, FileCloser>;
+
+// The files append_file has open. Few programs append to more than a
+// handful, so they sit in a vector in the order they were opened, and the
+// oldest is closed to make room.
+class AppendedFiles {
+public:
+    static constexpr size_t kBufferSize = 64 * 1024;
+
+    ~AppendedFiles() { close_all(); }
+
+    auto append(const std::string& path, std::string_view content) -> bool {
+        std::lock_guard lock(mutex_);
+        std::FILE* file = find_or_open(path);
+        return file != nullptr &&
+               std::fwrite(content.data(), 1, content.size(), file) == content.size();
+    }
+
+    auto flush() -> void {
+        if (!any_open_.load(std::memory_order_acquire)) {
+            return;
+        }
+        std::lock_guard lock(mutex_);
+        close_all();
+    }
+
+private:
+    auto find_or_open(const std::string& path) -> std::FILE* {
+        for (auto& [name, file] : files_) {
+            if (name == path) {
+                return file.get();
+            }
+        }
+        FilePtr file(std::fopen(path.c_str(), "ab"));
+        if (!file) {
+            return nullptr;
+        }
+        std::setvbuf(file.get(), nullptr, _IOFBF, kBufferSize);
+        if (files_.size() == kMaxAppendedFiles) {
+            files_.erase(files_.begin());
+        }
+        files_.emplace_back(path, std::move(file));
+        any_open_.store(true, std::memory_order_release);
+        return files_.back().second.get();
+    }
+
+    // Closing, not just flushing: a file replaced by write_file must be
+    // reopened, or later appends would go to the old one
+    auto close_all() -> void {
+        files_.clear();
+        any_open_.store(false, std::memory_order_release);
+    }
+
+    std::mutex mutex_;
+    std::vector<std::pair<std::string, FilePtr>> files_;
+    std::atomic<bool> any_open_{false};
+};
+
+auto appended_files() -> AppendedFiles& {
+    static AppendedFiles files;
+    return files;
+}
+
+} // namespace
+
+auto read_file_value(const std::string& path) -> Value {
+    flush_appended_files();
+
+    std::error_code error;
+    const auto size = std::filesystem::file_size(path, error);
+    if (error) {
+        return Value(std::string{});
+    }
+    if (size >= kMapThreshold) {
+        try {
+            return Value::from_mapping(std::make_shared<const MappedFile>(path));
+        } catch (const std::runtime_error&) {
+            return Value(std::string{});
+        }
+    }
+
+    FilePtr file(std::fopen(path.c_str(), "rb"));
+    if (!file) {
+        return Value(std::string{});
+    }
+    // One byte spare, so a file of exactly `size` bytes ends the loop at once
+    std::string text(static_cast<size_t>(size) + 1, '\0');
+    size_t used = 0;
+    for (;;) {
+        used += std::fread(text.data() + used, 1, text.size() - used, file.get());
+        if (used < text.size()) {
+            break;
+        }
+        text.resize(text.size() * 2);  // Grew since it was measured
+    }
+    text.resize(used);
+    return Value(std::move(text));
+}
+
+auto append_to_file(const std::string& path, std::string_view content) -> bool {
+    return appended_files().append(path, content);
+}
+
+auto flush_appended_files() -> void {
+    appended_files().flush();
+}
+
+} // namespace lucid::backend
@@ -0,0 +1,553 @@
+#include <lucid/backend/inliner.hpp>
+#include <fmt/format.h>
+#include <algorithm>
+#include <optional>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace lucid::backend {
+
+namespace {
+
+using Names = std::unordered_set<std::string>;
+using Renames = std::unordered_map<std::string, std::string>;
+using Substitutions = std::unordered_map<std::string, const ast::Expr*>;
+
+// Calls `on_expr` on the slot of each expression directly inside `expr`,
+// and `on_stmt` on each statement of a block
+template <typename OnExpr, typename OnStmt>
+auto for_each_child(ast::Expr& expr, OnExpr&& on_expr, OnStmt&& on_stmt) -> void {
+    auto all = [&](std::vector<std::unique_ptr<ast::Expr>>& exprs) {
+        for (auto& element : exprs) {
+            on_expr(element);
+        }
+    };
+    switch (expr.kind) {
+        case ast::ExprKind::Tuple:
+            all(static_cast<ast::TupleExpr&>(expr).elements);
+            break;
+        case ast::ExprKind::List:
+            all(static_cast<ast::ListExpr&>(expr).elements);
+            break;
+        case ast::ExprKind::Binary: {
+            auto& binary = static_cast<ast::BinaryExpr&>(expr);
+            on_expr(binary.left);
+            on_expr(binary.right);
+            break;
+        }
+        case ast::ExprKind::Unary:
+            on_expr(static_cast<ast::UnaryExpr&>(expr).operand);
+            break;
+        case ast::ExprKind::Call: {
+            auto& call = static_cast<ast::CallExpr&>(expr);
+            on_expr(call.callee);
+            all(call.arguments);
+            break;
+        }
+        case ast::ExprKind::MethodCall: {
+            auto& call = static_cast<ast::MethodCallExpr&>(expr);
+            on_expr(call.object);
+            all(call.arguments);
+            break;
+        }
+        case ast::ExprKind::Index: {
+            auto& index = static_cast<ast::IndexExpr&>(expr);
+            on_expr(index.object);
+            on_expr(index.index);
+            break;
+        }
+        case ast::ExprKind::Lambda:
+            on_expr(static_cast<ast::LambdaExpr&>(expr).body);
+            break;
+        case ast::ExprKind::If: {
+            auto& if_expr = static_cast<ast::IfExpr&>(expr);
+            on_expr(if_expr.condition);
+            on_expr(if_expr.then_branch);
+            if (if_expr.else_branch.has_value()) {
+                on_expr(*if_expr.else_branch);
+            }
+            break;
+        }
+        case ast::ExprKind::Block:
+            for (auto& stmt : static_cast<ast::BlockExpr&>(expr).statements) {
+                on_stmt(*stmt);
+            }
+            break;
+        case ast::ExprKind::IntLiteral:
+        case ast::ExprKind::FloatLiteral:
+        case ast::ExprKind::StringLiteral:
+        case ast::ExprKind::BoolLiteral:
+        case ast::ExprKind::Identifier:
+            break;
+    }
+}
+
+auto stmt_value(ast::Stmt& stmt) -> std::unique_ptr<ast::Expr>& {
+    switch (stmt.kind) {
+        case ast::StmtKind::Let:
+            return static_cast<ast::LetStmt&>(stmt).initializer;
+        case ast::StmtKind::Return:
+            return static_cast<ast::ReturnStmt&>(stmt).value;
+        case ast::StmtKind::ExprStmt:
+            break;
+    }
+    return static_cast<ast::ExprStmt&>(stmt).expression;
+}
+
+auto collect_bound(const ast::Pattern& pattern, std::vector<std::string>& names) -> void {
+    if (pattern.kind == ast::PatternKind::Identifier) {
+        names.push_back(static_cast<const ast::IdentifierPattern&>(pattern).name);
+        return;
+    }
+    for (const auto& element : static_cast<const ast::TuplePattern&>(pattern).elements) {
+        collect_bound(*element, names);
+    }
+}
+
+// Every name `expr` binds: `let` patterns and lambda parameters
+auto collect_bound(ast::Expr& expr, std::vector<std::string>& names) -> void {
+    if (expr.kind == ast::ExprKind::Lambda) {
+        const auto& parameters = static_cast<ast::LambdaExpr&>(expr).parameters;
+        names.insert(names.end(), parameters.begin(), parameters.end());
+    }
+    for_each_child(
+        expr,
+        [&](std::unique_ptr<ast::Expr>& child) { collect_bound(*child, names); },
+        [&](ast::Stmt& stmt) {
+            if (stmt.kind == ast::StmtKind::Let) {
+                collect_bound(*static_cast<ast::LetStmt&>(stmt).pattern, names);
+            }
+            collect_bound(*stmt_value(stmt), names);
+        });
+}
+
+// ===== Cloning =====
+
+// Copies a callee's body into the caller: parameters become their
+// arguments (or the locals holding them) and locals get their new names.
+// Slots the type checker gave them move up by `base`, past the caller's
+// own; kNoSlot for a base leaves them unresolved.
+class Cloner {
+public:
+    Cloner(const Renames& renames, const Substitutions& arguments, uint32_t base)
+        : renames_(renames), arguments_(arguments), base_(base) {}
+
+    auto expr(const ast::Expr& expr) const -> std::unique_ptr<ast::Expr> {
+        auto copy = copy_expr(expr);
+        copy->static_type = expr.static_type;
+        return copy;
+    }
+
+    auto stmt(const ast::Stmt& stmt) const -> std::unique_ptr<ast::Stmt> {
+        switch (stmt.kind) {
+            case ast::StmtKind::Let: {
+                const auto& let = static_cast<const ast::LetStmt&>(stmt);
+                return std::make_unique<ast::LetStmt>(pattern(*let.pattern), std::nullopt,
+                                                      expr(*let.initializer), let.location);
+            }
+            case ast::StmtKind::Return: {
+                const auto& ret = static_cast<const ast::ReturnStmt&>(stmt);
+                return std::make_unique<ast::ReturnStmt>(expr(*ret.value), ret.location);
+            }
+            case ast::StmtKind::ExprStmt:
+                break;
+        }
+        const auto& expr_stmt = static_cast<const ast::ExprStmt&>(stmt);
+        return std::make_unique<ast::ExprStmt>(expr(*expr_stmt.expression), expr_stmt.location);
+    }
+
+private:
+    auto name(const std::string& original) const -> std::string {
+        auto renamed = renames_.find(original);
+        return renamed == renames_.end() ? original : renamed->second;
+    }
+
+    auto slot(uint32_t original) const -> uint32_t {
+        return original == ast::kNoSlot || base_ == ast::kNoSlot ? ast::kNoSlot : base_ + original;
+    }
+
+    // The new names were never interned
+    auto id(const std::string& original, NameId id) const -> NameId {
+        return renames_.contains(original) ? kNoName : id;
+    }
+
+    auto pattern(const ast::Pattern& pattern) const -> std::unique_ptr<ast::Pattern> {
+        if (pattern.kind == ast::PatternKind::Identifier) {
+            const auto& identifier = static_cast<const ast::IdentifierPattern&>(pattern);
+            auto copy = std::make_unique<ast::IdentifierPattern>(name(identifier.name), identifier.location);
+            copy->id = id(identifier.name, identifier.id);
+            copy->slot = slot(identifier.slot);
+            return copy;
+        }
+        std::vector<std::unique_ptr<ast::Pattern>> elements;
+        for (const auto& element : static_cast<const ast::TuplePattern&>(pattern).elements) {
+            elements.push_back(this->pattern(*element));
+        }
+        return std::make_unique<ast::TuplePattern>(std::move(elements), pattern.location);
+    }
+
+    auto all(const std::vector<std::unique_ptr<ast::Expr>>& exprs) const
+        -> std::vector<std::unique_ptr<ast::Expr>> {
+        std::vector<std::unique_ptr<ast::Expr>> copies;
+        copies.reserve(exprs.size());
+        for (const auto& element : exprs) {
+            copies.push_back(expr(*element));
+        }
+        return copies;
+    }
+
+    auto copy_expr(const ast::Expr& expr) const -> std::unique_ptr<ast::Expr> {
+        const auto location = expr.location;
+        switch (expr.kind) {
+            case ast::ExprKind::IntLiteral:
+                return std::make_unique<ast::IntLiteralExpr>(
+                    static_cast<const ast::IntLiteralExpr&>(expr).value, location);
+            case ast::ExprKind::FloatLiteral:
+                return std::make_unique<ast::FloatLiteralExpr>(
+                    static_cast<const ast::FloatLiteralExpr&>(expr).value, location);
+            case ast::ExprKind::StringLiteral:
+                return std::make_unique<ast::StringLiteralExpr>(
+                    static_cast<const ast::StringLiteralExpr&>(expr).value, location);
+            case ast::ExprKind::BoolLiteral:
+                return std::make_unique<ast::BoolLiteralExpr>(
+                    static_cast<const ast::BoolLiteralExpr&>(expr).value, location);
+            case ast::ExprKind::Identifier: {
+                const auto& identifier = static_cast<const ast::IdentifierExpr&>(expr);
+                if (auto argument = arguments_.find(identifier.name); argument != arguments_.end()) {
+                    return Cloner({}, {}, 0).expr(*argument->second);
+                }
+                auto copy = std::make_unique<ast::IdentifierExpr>(name(identifier.name), location);
+                copy->id = id(identifier.name, identifier.id);
+                copy->slot = slot(identifier.slot);
+                return copy;
+            }
+            case ast::ExprKind::Tuple: {
+                const auto& tuple = static_cast<const ast::TupleExpr&>(expr);
+                auto copy = std::make_unique<ast::TupleExpr>(all(tuple.elements), location);
+                copy->is_constant = tuple.is_constant;
+                return copy;
+            }
+            case ast::ExprKind::List: {
+                const auto& list = static_cast<const ast::ListExpr&>(expr);
+                auto copy = std::make_unique<ast::ListExpr>(all(list.elements), location);
+                copy->is_constant = list.is_constant;
+                return copy;
+            }
+            case ast::ExprKind::Binary: {
+                const auto& binary = static_cast<const ast::BinaryExpr&>(expr);
+                return std::make_unique<ast::BinaryExpr>(binary.op, this->expr(*binary.left),
+                                                         this->expr(*binary.right), location);
+            }
+            case ast::ExprKind::Unary: {
+                const auto& unary = static_cast<const ast::UnaryExpr&>(expr);
+                return std::make_unique<ast::UnaryExpr>(unary.op, this->expr(*unary.operand), location);
+            }
+            case ast::ExprKind::Call: {
+                const auto& call = static_cast<const ast::CallExpr&>(expr);
+                return std::make_unique<ast::CallExpr>(this->expr(*call.callee), all(call.arguments),
+                                                       location);
+            }
+            case ast::ExprKind::MethodCall: {
+                const auto& call = static_cast<const ast::MethodCallExpr&>(expr);
+                return std::make_unique<ast::MethodCallExpr>(this->expr(*call.object), call.method_name,
+                                                             all(call.arguments), location);
+            }
+            case ast::ExprKind::Index: {
+                const auto& index = static_cast<const ast::IndexExpr&>(expr);
+                return std::make_unique<ast::IndexExpr>(this->expr(*index.object),
+                                                        this->expr(*index.index), location);
+            }
+            case ast::ExprKind::If: {
+                const auto& if_expr = static_cast<const ast::IfExpr&>(expr);
+                std::optional<std::unique_ptr<ast::Expr>> else_branch;
+                if (if_expr.else_branch.has_value()) {
+                    else_branch = this->expr(**if_expr.else_branch);
+                }
+                return std::make_unique<ast::IfExpr>(this->expr(*if_expr.condition),
+                                                     this->expr(*if_expr.then_branch),
+                                                     std::move(else_branch), location);
+            }
+            case ast::ExprKind::Block: {
+                std::vector<std::unique_ptr<ast::Stmt>> statements;
+                for (const auto& statement : static_cast<const ast::BlockExpr&>(expr).statements) {
+                    statements.push_back(stmt(*statement));
+                }
+                return std::make_unique<ast::BlockExpr>(std::move(statements), location);
+            }
+            case ast::ExprKind::Lambda:
+                break;
+        }
+        throw std::logic_error("Lambdas are never inlined");
+    }
+
+    const Renames& renames_;
+    const Substitutions& arguments_;
+    uint32_t base_;
+};
+
+// ===== Callees =====
+
+// What a call site needs to know about a function it could inline
+struct Callee {
+    bool inlinable = false;
+    std::vector<std::string> locals;  // Names the body's `let`s bind
+    Names free_names;                 // Functions and built-ins it refers to
+    std::unordered_map<std::string, ast::StaticType> parameter_types;  // Of the used ones
+};
+
+auto analyse_callee(ast::FunctionDef& function) -> Callee {
+    Callee callee;
+    auto& statements = function.body->statements;
+    if (statements.empty() || statements.back()->kind == ast::StmtKind::Let) {
+        return callee;
+    }
+    for (size_t i = 0; i + 1 < statements.size(); ++i) {
+        if (statements[i]->kind != ast::StmtKind::Let) {
+            return callee;
+        }
+    }
+
+    Names parameters;
+    for (const auto& parameter : function.parameters) {
+        parameters.insert(parameter->name);
+    }
+
+    size_t nodes = 0;
+    bool fits = true;
+    auto visit = [&](auto& self, ast::Expr& expr) -> void {
+        ++nodes;
+        if (expr.kind == ast::ExprKind::Lambda) {
+            fits = false;
+            return;
+        }
+        if (expr.kind == ast::ExprKind::Identifier) {
+            const auto& name = static_cast<ast::IdentifierExpr&>(expr).name;
+            if (name == function.name) {
+                fits = false;  // Recursive
+            } else if (parameters.contains(name)) {
+                auto [type, inserted] = callee.parameter_types.try_emplace(name, expr.static_type);
+                fits = fits && type->second == expr.static_type;
+            } else {
+                callee.free_names.insert(name);
+            }
+            return;
+        }
+        for_each_child(
+            expr,
+            [&](std::unique_ptr<ast::Expr>& child) { self(self, *child); },
+            [&](ast::Stmt& stmt) {
+                fits = fits && stmt.kind != ast::StmtKind::Return;  // Would leave the caller
+                self(self, *stmt_value(stmt));
+            });
+    };
+    for (auto& statement : statements) {
+        if (statement->kind == ast::StmtKind::Let) {
+            collect_bound(*static_cast<ast::LetStmt&>(*statement).pattern, callee.locals);
+        }
+        collect_bound(*stmt_value(*statement), callee.locals);
+        visit(visit, *stmt_value(*statement));
+    }
+
+    // Each name bound once, so renaming cannot merge two of them
+    std::vector<std::string> bound = callee.locals;
+    bound.insert(bound.end(), parameters.begin(), parameters.end());
+    std::sort(bound.begin(), bound.end());
+    const bool distinct = std::adjacent_find(bound.begin(), bound.end()) == bound.end();
+    for (const auto& local : callee.locals) {
+        callee.free_names.erase(local);
+    }
+
+    callee.inlinable = fits && distinct && nodes <= kMaxInlineNodes;
+    return callee;
+}
+
+auto is_trivial(const ast::Expr& expr) -> bool {
+    switch (expr.kind) {
+        case ast::ExprKind::IntLiteral:
+        case ast::ExprKind::FloatLiteral:
+        case ast::ExprKind::StringLiteral:
+        case ast::ExprKind::BoolLiteral:
+        case ast::ExprKind::Identifier:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// ===== Rewriting =====
+
+class Inliner {
+public:
+    explicit Inliner(ast::Program& program) {
+        for (auto& function : program.functions) {
+            functions_.emplace(function->name, function.get());
+        }
+    }
+
+    auto run(ast::Program& program) -> InlineStats {
+        for (auto& function : program.functions) {
+            caller_ = function.get();
+            frame_ = &function->local_count;
+            declared_.clear();
+            for (const auto& parameter : function->parameters) {
+                declared_.insert(parameter->name);
+            }
+            std::vector<std::string> bound;
+            for (auto& statement : function->body->statements) {
+                if (statement->kind == ast::StmtKind::Let) {
+                    collect_bound(*static_cast<ast::LetStmt&>(*statement).pattern, bound);
+                }
+                collect_bound(*stmt_value(*statement), bound);
+            }
+            declared_.insert(bound.begin(), bound.end());
+
+            for (auto& statement : function->body->statements) {
+                rewrite(*statement);
+            }
+            callees_.erase(function->name);  // Its body has changed
+        }
+        return stats_;
+    }
+
+private:
+    auto rewrite(ast::Stmt& stmt) -> void {
+        auto& value = stmt_value(stmt);
+        if (stmt.kind == ast::StmtKind::Let && value->kind == ast::ExprKind::Call &&
+            static_cast<ast::LetStmt&>(stmt).pattern->kind == ast::PatternKind::Tuple) {
+            // Left to the escape analysis; only the arguments are rewritten
+            for (auto& argument : static_cast<ast::CallExpr&>(*value).arguments) {
+                rewrite(argument);
+            }
+            return;
+        }
+        rewrite(value);
+    }
+
+    auto rewrite(std::unique_ptr<ast::Expr>& slot) -> void {
+        uint32_t* const frame = frame_;
+        if (slot->kind == ast::ExprKind::Lambda) {
+            frame_ = &static_cast<ast::LambdaExpr&>(*slot).local_count;
+        }
+        for_each_child(
+            *slot,
+            [this](std::unique_ptr<ast::Expr>& child) { rewrite(child); },
+            [this](ast::Stmt& stmt) { rewrite(stmt); });
+        frame_ = frame;
+        if (slot->kind == ast::ExprKind::Call) {
+            if (auto replacement = expand(static_cast<ast::CallExpr&>(*slot))) {
+                slot = std::move(replacement);
+                ++stats_.inlined;
+            }
+        }
+    }
+
+    auto callee(const std::string& name) -> const Callee* {
+        auto function = functions_.find(name);
+        if (function == functions_.end() || function->second == caller_) {
+            return nullptr;
+        }
+        auto [callee, inserted] = callees_.try_emplace(name);
+        if (inserted) {
+            callee->second = analyse_callee(*function->second);
+        }
+        return callee->second.inlinable ? &callee->second : nullptr;
+    }
+
+    // The callee's body in place of `call`, or null to keep the call
+    auto expand(ast::CallExpr& call) -> std::unique_ptr<ast::Expr> {
+        if (call.callee->kind != ast::ExprKind::Identifier) {
+            return nullptr;
+        }
+        const auto& name = static_cast<ast::IdentifierExpr&>(*call.callee).name;
+        const Callee* callee = declared_.contains(name) ? nullptr : this->callee(name);
+        if (callee == nullptr) {
+            return nullptr;
+        }
+        const ast::FunctionDef& function = *functions_.at(name);
+        if (call.arguments.size() != function.parameters.size()) {
+            return nullptr;
+        }
+        if ((*frame_ == ast::kNoSlot) != (function.local_count == ast::kNoSlot)) {
+            return nullptr;  // Only one of them was checked
+        }
+        for (const auto& free_name : callee->free_names) {
+            if (declared_.contains(free_name)) {
+                return nullptr;  // Would mean the caller's local here
+            }
+        }
+        for (size_t i = 0; i < call.arguments.size(); ++i) {
+            auto type = callee->parameter_types.find(function.parameters[i]->name);
+            if (type != callee->parameter_types.end() && type->second != call.arguments[i]->static_type) {
+                return nullptr;
+            }
+        }
+
+        const size_t site = ++sites_;
+        const uint32_t base = *frame_;  // The callee's frame goes after the caller's
+        auto local_name = [&](const std::string& original) {
+            return fmt::format("{}${}${}", name, site, original);
+        };
+
+        // Arguments first, in order
+        std::vector<std::unique_ptr<ast::Stmt>> statements;
+        Substitutions arguments;
+        Renames renames;
+        for (size_t i = 0; i < call.arguments.size(); ++i) {
+            const auto& parameter = function.parameters[i]->name;
+            auto& argument = call.arguments[i];
+            if (is_trivial(*argument)) {
+                arguments.emplace(parameter, argument.get());
+                continue;
+            }
+            renames.emplace(parameter, local_name(parameter));
+            auto pattern = std::make_unique<ast::IdentifierPattern>(renames.at(parameter), argument->location);
+            if (base != ast::kNoSlot) {
+                pattern->slot = base + static_cast<uint32_t>(i);  // Parameters take the first slots
+            }
+            const auto location = argument->location;
+            statements.push_back(std::make_unique<ast::LetStmt>(std::move(pattern), std::nullopt,
+                                                                std::move(argument), location));
+        }
+        for (const auto& local : callee->locals) {
+            renames.emplace(local, local_name(local));
+        }
+
+        const Cloner cloner(renames, arguments, base);
+        const auto& body = function.body->statements;
+        for (size_t i = 0; i + 1 < body.size(); ++i) {
+            statements.push_back(cloner.stmt(*body[i]));
+        }
+        auto result = cloner.expr(*stmt_value(*body.back()));
+        for (const auto& local : renames) {
+            declared_.insert(local.second);
+        }
+        if (base != ast::kNoSlot) {
+            *frame_ += function.local_count;
+        }
+        if (statements.empty()) {
+            return result;
+        }
+        const auto location = result->location;
+        statements.push_back(std::make_unique<ast::ExprStmt>(std::move(result), location));
+        auto block = std::make_unique<ast::BlockExpr>(std::move(statements), call.location);
+        block->static_type = call.static_type;
+        return block;
+    }
+
+    std::unordered_map<std::string, ast::FunctionDef*> functions_;
+    std::unordered_map<std::string, Callee> callees_;
+    ast::FunctionDef* caller_ = nullptr;
+    uint32_t* frame_ = nullptr;  // Local count of the function or lambda being rewritten
+    Names declared_;  // Every name the caller binds
+    size_t sites_ = 0;
+    InlineStats stats_;
+};
+
+} // namespace
+
+auto inline_functions(ast::Program& program) -> InlineStats {
+    return Inliner(program).run(program);
+}
+
+} // namespace lucid::backend
@@ -0,0 +1,1206 @@
+#include <lucid/backend/jit.hpp>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+#include <map>
+
+#if defined(LUCID_JIT) && defined(__x86_64__) && __has_include(<sys/mman.h>)
+#include <sys/mman.h>
+#include <unistd.h>
+#define LUCID_HAS_JIT 1
+#else
+#define LUCID_HAS_JIT 0
+#endif
+
+namespace lucid::backend {
+
+namespace {
+
+// Native stack compiled code may use below the VM's own frame
+constexpr uintptr_t kNativeStackBytes = 256 * 1024;
+// Frame slots (locals plus operands) of one compiled function
+constexpr size_t kMaxSlots = 1024;
+// Rounds of return-kind propagation before giving up on a call graph
+constexpr size_t kMaxRounds = 16;
+
+// ===== Kinds =====
+
+// Static kind of a local or operand slot. Unset means no value has reached
+// the slot yet (or a callee's return kind is still unknown), Mixed that
+// values of different kinds do. Only Int, Float and Bool are compiled.
+enum class Kind : uint8_t { Unset, Int, Float, Bool, Mixed };
+
+auto join(Kind a, Kind b) -> Kind {
+    if (a == Kind::Unset) return b;
+    if (b == Kind::Unset) return a;
+    return a == b ? a : Kind::Mixed;
+}
+
+auto is_scalar(Kind kind) -> bool {
+    return kind == Kind::Int || kind == Kind::Float || kind == Kind::Bool;
+}
+
+auto kind_of(const Value& value) -> Kind {
+    switch (value.type()) {
+        case ValueType::Int: return Kind::Int;
+        case ValueType::Float: return Kind::Float;
+        case ValueType::Bool: return Kind::Bool;
+        default: return Kind::Mixed;
+    }
+}
+
+// Raised while analysing or emitting something the JIT cannot translate
+struct Unsupported {};
+
+enum class Status : uint8_t {
+    Cold,         // Interpreted, counting calls
+    Compiled,     // Has native code for `params`
+    Rejected,     // Hot but not translatable
+    Deoptimised,  // Native code gave up once; interpreted from now on
+};
+
+struct FunctionState {
+    uint32_t calls = 0;
+    Status status = Status::Cold;
+    std::vector<Kind> params;
+    Kind result = Kind::Unset;
+    const void* entry = nullptr;       // Compiled function
+    const void* trampoline = nullptr;  // C++ -> native entry of its block
+};
+
+// Shared by the trampoline and compiled code, which address it through r12
+struct NativeContext {
+    int64_t frames_left;    // Decremented on entry, incremented on return
+    uint64_t failed;        // Set to 1 when native code gives up
+    uintptr_t stack_limit;  // Lowest rsp compiled code may run at
+    int64_t slots_left;     // VM value stack slots left; frames reserve theirs
+};
+static_assert(offsetof(NativeContext, failed) == 8 && offsetof(NativeContext, stack_limit) == 16 &&
+              offsetof(NativeContext, slots_left) == 24);
+
+// trampoline(args, context, entry): runs a compiled function from C++
+using Trampoline = uint64_t (*)(const uint64_t*, NativeContext*, const void*);
+
+// ===== Analysis =====
+
+struct State {
+    std::vector<Kind> locals;
+    std::vector<Kind> stack;
+};
+
+// One function specialised to fixed parameter kinds
+struct Variant {
+    Variant(size_t function_index, std::vector<Kind> param_kinds)
+        : function(function_index), params(std::move(param_kinds)) {}
+
+    size_t function;
+    std::vector<Kind> params;
+    Kind result = Kind::Unset;
+    std::map<size_t, State> states;  // State before each reachable instruction
+    size_t slots = 0;                // Locals plus deepest operand stack
+};
+
+enum class Relation : uint8_t { Eq, Ne, Lt, Gt, Le, Ge };
+
+auto relation_of(OpCode op) -> std::optional<Relation> {
+    switch (op) {
+        case OpCode::EQ: case OpCode::EQ_INT: return Relation::Eq;
+        case OpCode::NE: case OpCode::NE_INT: return Relation::Ne;
+        case OpCode::LT: case OpCode::LT_INT: case OpCode::LT_FLOAT: return Relation::Lt;
+        case OpCode::GT: case OpCode::GT_INT: case OpCode::GT_FLOAT: return Relation::Gt;
+        case OpCode::LE: case OpCode::LE_INT: case OpCode::LE_FLOAT: return Relation::Le;
+        case OpCode::GE: case OpCode::GE_INT: case OpCode::GE_FLOAT: return Relation::Ge;
+        default: return std::nullopt;
+    }
+}
+
+// Whether comparing these kinds is defined (Value's ordering throws for
+// Bool and for mismatched kinds; equality of mismatched kinds is false)
+auto check_comparison(Relation relation, Kind a, Kind b) -> void {
+    if (!(a == Kind::Unset || is_scalar(a)) || !(b == Kind::Unset || is_scalar(b))) {
+        throw Unsupported{};
+    }
+    bool equality = relation == Relation::Eq || relation == Relation::Ne;
+    if (!equality && (a == Kind::Bool || b == Kind::Bool ||
+                      (a != Kind::Unset && b != Kind::Unset && a != b))) {
+        throw Unsupported{};
+    }
+}
+
+// ===== x86-64 Assembler =====
+
+enum Reg : uint8_t { RAX = 0, RCX = 1, RDX = 2, RBX = 3, RSP = 4, RBP = 5, RSI = 6, RDI = 7, R12 = 12 };
+enum Xmm : uint8_t { XMM0 = 0, XMM1 = 1 };
+enum Cond : uint8_t {
+    kBelow = 0x2, kAboveEqual = 0x3, kEqual = 0x4, kNotEqual = 0x5, kAbove = 0x7, kSign = 0x8,
+    kParity = 0xA, kNoParity = 0xB, kLess = 0xC, kGreaterEqual = 0xD, kLessEqual = 0xE, kGreater = 0xF,
+};
+
+class Assembler {
+public:
+    using Label = size_t;
+
+    auto new_label() -> Label {
+        labels_.push_back(kUnbound);
+        return labels_.size() - 1;
+    }
+    auto bind(Label label) -> void { labels_[label] = code_.size(); }
+
+    auto byte(uint8_t value) -> void { code_.push_back(value); }
+    auto bytes(std::initializer_list<uint8_t> values) -> void { code_.insert(code_.end(), values); }
+    auto imm32(uint32_t value) -> void {
+        for (int shift = 0; shift < 32; shift += 8) byte(static_cast<uint8_t>(value >> shift));
+    }
+    auto imm64(uint64_t value) -> void {
+        for (int shift = 0; shift < 64; shift += 8) byte(static_cast<uint8_t>(value >> shift));
+    }
+
+    // [prefix] [REX] opcode ModRM(reg, [base + disp])
+    auto mem(std::initializer_list<uint8_t> prefix, bool wide, std::initializer_list<uint8_t> opcode,
+             int reg, int base, int32_t disp) -> void {
+        bytes(prefix);
+        rex(wide, reg, base);
+        bytes(opcode);
+        bool short_disp = disp >= -128 && disp <= 127;
+        byte(static_cast<uint8_t>((short_disp ? 0x40 : 0x80) | ((reg & 7) << 3) | (base & 7)));
+        if ((base & 7) == RSP) {
+            byte(0x24);  // SIB: no index
+        }
+        if (short_disp) {
+            byte(static_cast<uint8_t>(disp));
+        } else {
+            imm32(static_cast<uint32_t>(disp));
+        }
+    }
+
+    // [prefix] [REX] opcode ModRM(reg, rm) with both operands registers
+    auto rr(std::initializer_list<uint8_t> prefix, bool wide, std::initializer_list<uint8_t> opcode,
+            int reg, int rm) -> void {
+        bytes(prefix);
+        rex(wide, reg, rm);
+        bytes(opcode);
+        byte(static_cast<uint8_t>(0xC0 | ((reg & 7) << 3) | (rm & 7)));
+    }
+
+    auto load(Reg dst, Reg base, int32_t disp) -> void { mem({}, true, {0x8B}, dst, base, disp); }
+    auto store(Reg base, int32_t disp, Reg src) -> void { mem({}, true, {0x89}, src, base, disp); }
+    auto store_imm(Reg base, int32_t disp, int32_t value) -> void {
+        mem({}, true, {0xC7}, 0, base, disp);
+        imm32(static_cast<uint32_t>(value));
+    }
+    auto load_sd(Xmm dst, Reg base, int32_t disp) -> void { mem({0xF2}, false, {0x0F, 0x10}, dst, base, disp); }
+    auto store_sd(Reg base, int32_t disp, Xmm src) -> void { mem({0xF2}, false, {0x0F, 0x11}, src, base, disp); }
+    auto convert_sd(Xmm dst, Reg base, int32_t disp) -> void { mem({0xF2}, true, {0x0F, 0x2A}, dst, base, disp); }
+    auto cmp_imm8(Reg base, int32_t disp, int8_t value) -> void {
+        mem({}, true, {0x83}, 7, base, disp);
+        byte(static_cast<uint8_t>(value));
+    }
+    auto mov_imm64(Reg dst, uint64_t value) -> void {
+        rex(true, 0, dst);
+        byte(static_cast<uint8_t>(0xB8 + (dst & 7)));
+        imm64(value);
+    }
+    auto setcc(Cond cond, Reg dst) -> void { rr({}, false, {0x0F, static_cast<uint8_t>(0x90 + cond)}, 0, dst); }
+    auto movzx_eax_al() -> void { bytes({0x0F, 0xB6, 0xC0}); }
+
+    auto jmp(Label label) -> void {
+        byte(0xE9);
+        fixup(label);
+    }
+    auto jcc(Cond cond, Label label) -> void {
+        bytes({0x0F, static_cast<uint8_t>(0x80 + cond)});
+        fixup(label);
+    }
+    auto call(Label label) -> void {
+        byte(0xE8);
+        fixup(label);
+    }
+
+    auto offset(Label label) const -> size_t { return labels_[label]; }
+
+    // Resolves every rel32 and returns the finished code
+    auto finish() -> std::vector<uint8_t> {
+        for (auto [position, label] : fixups_) {
+            if (labels_[label] == kUnbound) {
+                throw Unsupported{};
+            }
+            auto rel = static_cast<int64_t>(labels_[label]) - static_cast<int64_t>(position + 4);
+            for (size_t i = 0; i < 4; ++i) {
+                code_[position + i] = static_cast<uint8_t>(static_cast<uint64_t>(rel) >> (8 * i));
+            }
+        }
+        return std::move(code_);
+    }
+
+private:
+    static constexpr size_t kUnbound = static_cast<size_t>(-1);
+
+    std::vector<uint8_t> code_;
+    std::vector<size_t> labels_;
+    std::vector<std::pair<size_t, Label>> fixups_;
+
+    auto rex(bool wide, int reg, int rm) -> void {
+        auto prefix = static_cast<uint8_t>(0x40 | (wide ? 8 : 0) | ((reg & 8) ? 4 : 0) | ((rm & 8) ? 1 : 0));
+        if (prefix != 0x40) {
+            byte(prefix);
+        }
+    }
+
+    auto fixup(Label label) -> void {
+        fixups_.emplace_back(code_.size(), label);
+        imm32(0);
+    }
+};
+
+// ===== Translator =====
+//
+// Compiled frame layout: rbx points at the function's slots, locals first
+// and the operand stack above them, so the kind analysis turns every
+// operand into a fixed [rbx + 8 * slot]. Values are raw 64-bit words: the
+// Int, the Float's bits, or 0/1 for Bool.
+//
+// Calling convention between compiled functions: rdi points at the
+// arguments (the caller's top operand slots), the result comes back in rax,
+// r12 holds the NativeContext. After every call the caller checks
+// context->failed and, if set, unwinds straight to its own caller.
+
+class Translator {
+public:
+    Translator(const Bytecode& bytecode, std::vector<const FunctionState*> known)
+        : bytecode_(bytecode), code_(bytecode.code()), known_(std::move(known)) {}
+
+    // Kinds for `root` called with `params` and for everything it calls.
+    // Throws Unsupported if any of it cannot be compiled.
+    auto analyse(size_t root, std::vector<Kind> params) -> void {
+        variants_.emplace_back(root, std::move(params));
+        for (size_t round = 0;; ++round) {
+            if (round == kMaxRounds) {
+                throw Unsupported{};
+            }
+            bool changed = false;
+            for (size_t i = 0; i < variants_.size(); ++i) {  // Grows as calls are found
+                const size_t known_variants = variants_.size();
+                const Kind result = variants_[i].result;
+                analyse_variant(i);
+                changed |= variants_[i].result != result || variants_.size() != known_variants;
+            }
+            if (!changed) {
+                break;
+            }
+        }
+        for (const auto& variant : variants_) {
+            if (!is_scalar(variant.result)) {
+                throw Unsupported{};
+            }
+        }
+    }
+
+    auto variants() const -> const std::vector<Variant>& { return variants_; }
+
+    // Machine code for every variant, with the trampoline at offset 0;
+    // `entries` receives the offset of each variant
+    auto emit(std::vector<size_t>& entries) -> std::vector<uint8_t> {
+        // push rbx; push r12; push rbp; mov r12, rsi; call rdx; pop rbp; pop r12; pop rbx; ret
+        asm_.bytes({0x53, 0x41, 0x54, 0x55});
+        asm_.rr({}, true, {0x89}, RSI, R12);
+        asm_.rr({}, false, {0xFF}, 2, RDX);
+        asm_.bytes({0x5D, 0x41, 0x5C, 0x5B, 0xC3});
+
+        for (size_t i = 0; i < variants_.size(); ++i) {
+            entry_labels_.push_back(asm_.new_label());
+        }
+        for (size_t i = 0; i < variants_.size(); ++i) {
+            emit_variant(i);
+        }
+
+        auto code = asm_.finish();
+        for (auto label : entry_labels_) {
+            entries.push_back(asm_.offset(label));
+        }
+        return code;
+    }
+
+private:
+    const Bytecode& bytecode_;
+    std::span<const uint8_t> code_;
+    std::vector<const FunctionState*> known_;
+    std::vector<Variant> variants_;
+    Assembler asm_;
+    std::vector<Assembler::Label> entry_labels_;
+
+    auto u16_at(size_t offset) const -> uint16_t {
+        return static_cast<uint16_t>(code_[offset] | (code_[offset + 1] << 8));
+    }
+
+    auto jump_target(size_t offset, size_t next) const -> size_t {
+        auto target = static_cast<int64_t>(next) + static_cast<int16_t>(u16_at(offset + 1));
+        if (target < 0 || static_cast<size_t>(target) >= code_.size()) {
+            throw Unsupported{};
+        }
+        return static_cast<size_t>(target);
+    }
+
+    auto constant_kind(uint16_t index) const -> Kind {
+        if (index >= bytecode_.constants.size()) {
+            throw Unsupported{};
+        }
+        Kind kind = kind_of(bytecode_.constants[index]);
+        if (!is_scalar(kind)) {
+            throw Unsupported{};
+        }
+        return kind;
+    }
+
+    auto entry_state(const Variant& variant) const -> State {
+        const auto& info = bytecode_.functions[variant.function];
+        State state;
+        state.locals = variant.params;
+        // Other locals start out as Int(0), as in VM::enter_frame
+        state.locals.resize(std::max(info.local_count, variant.params.size()), Kind::Int);
+        return state;
+    }
+
+    // Return kind of `function` called with `args`; adds a variant for a
+    // callee that is not compiled yet
+    auto resolve_call(size_t function, const std::vector<Kind>& args) -> Kind {
+        for (Kind kind : args) {
+            if (kind == Kind::Unset) {
+                return Kind::Unset;  // Known in a later round
+            }
+        }
+        const FunctionState& state = *known_[function];
+        if (state.status == Status::Compiled) {
+            if (state.params != args) {
+                throw Unsupported{};
+            }
+            return state.result;
+        }
+        if (state.status != Status::Cold) {
+            throw Unsupported{};
+        }
+        for (const auto& variant : variants_) {
+            if (variant.function == function) {
+                if (variant.params != args) {
+                    throw Unsupported{};  // One specialisation per function
+                }
+                return variant.result;
+            }
+        }
+        variants_.emplace_back(function, args);
+        return Kind::Unset;
+    }
+
+    // Forward kind analysis of one variant. May append variants, so never
+    // holds a reference into variants_ across a call.
+    auto analyse_variant(size_t index) -> void {
+        const size_t function = variants_[index].function;
+        const std::vector<Kind> params = variants_[index].params;
+        const auto& info = bytecode_.functions[function];
+        Kind result = variants_[index].result;
+        size_t max_depth = 0;
+
+        std::map<size_t, State> states;
+        std::vector<size_t> work;
+        auto flow = [&](size_t target, const State& state) {
+            auto [it, inserted] = states.try_emplace(target, state);
+            if (!inserted) {
+                State& existing = it->second;
+                if (existing.stack.size() != state.stack.size()) {
+                    throw Unsupported{};
+                }
+                bool changed = false;
+                for (size_t i = 0; i < state.locals.size(); ++i) {
+                    Kind joined = join(existing.locals[i], state.locals[i]);
+                    changed |= joined != existing.locals[i];
+                    existing.locals[i] = joined;
+                }
+                for (size_t i = 0; i < state.stack.size(); ++i) {
+                    Kind joined = join(existing.stack[i], state.stack[i]);
+                    changed |= joined != existing.stack[i];
+                    existing.stack[i] = joined;
+                }
+                if (!changed) {
+                    return;
+                }
+            }
+            work.push_back(target);
+        };
+
+        flow(info.offset, entry_state(variants_[index]));
+        while (!work.empty()) {
+            const size_t offset = work.back();
+            work.pop_back();
+            State state = states.at(offset);
+
+            auto op = static_cast<OpCode>(code_[offset]);
+            if (static_cast<size_t>(op) >= kOpCodeCount ||
+                offset + 1 + opcode_operand_size(op) > code_.size()) {
+                throw Unsupported{};
+            }
+            const size_t next = offset + 1 + opcode_operand_size(op);
+
+            auto pop = [&state]() {
+                if (state.stack.empty()) {
+                    throw Unsupported{};
+                }
+                Kind kind = state.stack.back();
+                state.stack.pop_back();
+                return kind;
+            };
+            auto top = [&state]() {
+                if (state.stack.empty()) {
+                    throw Unsupported{};
+                }
+                return state.stack.back();
+            };
+            auto push = [&state, &max_depth](Kind kind) {
+                state.stack.push_back(kind);
+                max_depth = std::max(max_depth, state.stack.size());
+            };
+            auto local = [&state](uint16_t slot) -> Kind& {
+                if (slot >= state.locals.size()) {
+                    throw Unsupported{};
+                }
+                return state.locals[slot];
+            };
+            // Operand must be Unset or one of `allowed`
+            auto need = [](Kind kind, std::initializer_list<Kind> allowed) {
+                if (kind != Kind::Unset && std::find(allowed.begin(), allowed.end(), kind) == allowed.end()) {
+                    throw Unsupported{};
+                }
+                return kind;
+            };
+            auto binary = [&](Kind operand, Kind produces) {
+                need(pop(), {operand});
+                need(pop(), {operand});
+                push(produces);
+            };
+            auto call_args = [&](size_t callee, size_t count) {
+                if (callee >= bytecode_.functions.size() || count != bytecode_.functions[callee].param_count ||
+                    count > state.stack.size()) {
+                    throw Unsupported{};
+                }
+                std::vector<Kind> args(state.stack.end() - static_cast<std::ptrdiff_t>(count), state.stack.end());
+                state.stack.resize(state.stack.size() - count);
+                for (Kind kind : args) {
+                    need(kind, {Kind::Int, Kind::Float, Kind::Bool});
+                }
+                return args;
+            };
+
+            bool falls_through = true;
+            switch (op) {
+                case OpCode::CONSTANT: push(constant_kind(u16_at(offset + 1))); break;
+                case OpCode::TRUE:
+                case OpCode::FALSE: push(Kind::Bool); break;
+                case OpCode::LOAD_LOCAL: push(local(u16_at(offset + 1))); break;
+                case OpCode::STORE_LOCAL: {
+                    Kind value = top();
+                    local(u16_at(offset + 1)) = value;
+                    break;
+                }
+                case OpCode::LOAD_LOCAL2: {
+                    Kind first = local(u16_at(offset + 1));
+                    Kind second = local(u16_at(offset + 3));
+                    push(first);
+                    push(second);
+                    break;
+                }
+                case OpCode::LOAD_LOCAL_CONST: {
+                    Kind first = local(u16_at(offset + 1));
+                    push(first);
+                    push(constant_kind(u16_at(offset + 3)));
+                    break;
+                }
+                case OpCode::POP: pop(); break;
+                case OpCode::DUP: push(top()); break;
+
+                case OpCode::ADD_INT: case OpCode::SUB_INT: case OpCode::MUL_INT:
+                case OpCode::DIV_INT: case OpCode::MOD_INT:
+                    binary(Kind::Int, Kind::Int);
+                    break;
+                case OpCode::ADD_FLOAT: case OpCode::SUB_FLOAT: case OpCode::MUL_FLOAT: case OpCode::DIV_FLOAT:
+                    binary(Kind::Float, Kind::Float);
+                    break;
+                case OpCode::EQ_INT: case OpCode::NE_INT: case OpCode::LT_INT:
+                case OpCode::GT_INT: case OpCode::LE_INT: case OpCode::GE_INT:
+                    binary(Kind::Int, Kind::Bool);
+                    break;
+                case OpCode::LT_FLOAT: case OpCode::GT_FLOAT: case OpCode::LE_FLOAT: case OpCode::GE_FLOAT:
+                    binary(Kind::Float, Kind::Bool);
+                    break;
+
+                case OpCode::ADD: case OpCode::SUB: case OpCode::MUL: case OpCode::DIV: {
+                    Kind b = need(pop(), {Kind::Int, Kind::Float});
+                    Kind a = need(pop(), {Kind::Int, Kind::Float});
+                    if (a == Kind::Unset || b == Kind::Unset) {
+                        push(Kind::Unset);
+                    } else {
+                        push(a == Kind::Int && b == Kind::Int ? Kind::Int : Kind::Float);
+                    }
+                    break;
+                }
+                case OpCode::MOD: binary(Kind::Int, Kind::Int); break;
+                case OpCode::EQ: case OpCode::NE: case OpCode::LT:
+                case OpCode::GT: case OpCode::LE: case OpCode::GE: {
+                    Kind b = pop();
+                    Kind a = pop();
+                    check_comparison(*relation_of(op), a, b);
+                    push(Kind::Bool);
+                    break;
+                }
+                case OpCode::AND:
+                case OpCode::OR:
+                    need(pop(), {Kind::Int, Kind::Float, Kind::Bool});
+                    need(pop(), {Kind::Int, Kind::Float, Kind::Bool});
+                    push(Kind::Bool);
+                    break;
+                case OpCode::NOT:
+                    need(pop(), {Kind::Int, Kind::Float, Kind::Bool});
+                    push(Kind::Bool);
+                    break;
+                case OpCode::NEGATE:
+                case OpCode::POSITIVE:
+                    push(need(pop(), {Kind::Int, Kind::Float}));
+                    break;
+
+                case OpCode::JUMP:
+                    flow(jump_target(offset, next), state);
+                    falls_through = false;
+                    break;
+                case OpCode::JUMP_IF_FALSE:
+                case OpCode::JUMP_IF_TRUE:
+                    need(top(), {Kind::Int, Kind::Float, Kind::Bool});
+                    flow(jump_target(offset, next), state);
+                    break;
+                case OpCode::POP_JUMP_IF_FALSE:
+                    need(pop(), {Kind::Int, Kind::Float, Kind::Bool});
+                    flow(jump_target(offset, next), state);
+                    break;
+                case OpCode::COMPARE_JUMP_IF_FALSE: {
+                    auto relation = relation_of(static_cast<OpCode>(code_[offset + 3]));
+                    if (!relation) {
+                        throw Unsupported{};
+                    }
+                    Kind b = pop();
+                    Kind a = pop();
+                    check_comparison(*relation, a, b);
+                    flow(jump_target(offset, next), state);
+                    break;
+                }
+
+                case OpCode::CALL: {
+                    auto args = call_args(u16_at(offset + 1), code_[offset + 3]);
+                    push(resolve_call(u16_at(offset + 1), args));
+                    break;
+                }
+                case OpCode::TAIL_CALL: {
+                    const size_t callee = u16_at(offset + 1);
+                    auto args = call_args(callee, code_[offset + 3]);
+                    if (callee == function) {
+                        // Loops back to the entry, so the kinds must match it
+                        for (size_t i = 0; i < args.size(); ++i) {
+                            need(args[i], {params[i]});
+                        }
+                    } else {
+                        result = join(result, resolve_call(callee, args));
+                    }
+                    falls_through = false;
+                    break;
+                }
+                case OpCode::RETURN:
+                    result = join(result, need(top(), {Kind::Int, Kind::Float, Kind::Bool}));
+                    falls_through = false;
+                    break;
+
+                default:
+                    throw Unsupported{};
+            }
+
+            if (result == Kind::Mixed) {
+                throw Unsupported{};
+            }
+            if (falls_through) {
+                flow(next, state);
+            }
+        }
+
+        const size_t slots = std::max(info.local_count, params.size()) + max_depth;
+        if (slots > kMaxSlots) {
+            throw Unsupported{};
+        }
+        Variant& variant = variants_[index];
+        variant.result = result;
+        variant.states = std::move(states);
+        variant.slots = slots;
+    }
+
+    // ----- Code generation -----
+
+    static auto disp(size_t slot) -> int32_t { return static_cast<int32_t>(slot * 8); }
+
+    static auto concrete(Kind kind) -> Kind {
+        if (!is_scalar(kind)) {
+            throw Unsupported{};
+        }
+        return kind;
+    }
+
+    // ZF=1 when the scalar in `slot` is falsy (Value::is_truthy)
+    auto test_truthy(Kind kind, size_t slot) -> void {
+        if (concrete(kind) == Kind::Float) {
+            asm_.load(RAX, RBX, disp(slot));
+            asm_.rr({}, true, {0x01}, RAX, RAX);  // add rax, rax: drops the sign, so -0.0 is zero
+        } else {
+            asm_.cmp_imm8(RBX, disp(slot), 0);
+        }
+    }
+
+    auto load_double(Xmm dst, Kind kind, size_t slot) -> void {
+        if (kind == Kind::Int) {
+            asm_.convert_sd(dst, RBX, disp(slot));
+        } else {
+            asm_.load_sd(dst, RBX, disp(slot));
+        }
+    }
+
+    // al = `a relation b`. Value semantics (the generic opcodes and
+    // COMPARE_JUMP_IF_FALSE) define <= and >= on Floats as !(b < a) and
+    // !(a < b), which differs from the typed ones for NaN.
+    auto emit_compare(Relation relation, Kind a, Kind b, size_t slot_a, size_t slot_b, bool value_semantics) -> void {
+        a = concrete(a);
+        b = concrete(b);
+        if (a != b) {
+            // Only equality gets here: Values of different types are never equal
+            asm_.byte(0xB8);
+            asm_.imm32(relation == Relation::Ne ? 1 : 0);
+            return;
+        }
+        if (a != Kind::Float) {
+            asm_.load(RAX, RBX, disp(slot_a));
+            asm_.load(RCX, RBX, disp(slot_b));
+            asm_.rr({}, true, {0x39}, RCX, RAX);  // cmp rax, rcx
+            static constexpr Cond kConds[] = {kEqual, kNotEqual, kLess, kGreater, kLessEqual, kGreaterEqual};
+            asm_.setcc(kConds[static_cast<size_t>(relation)], RAX);
+            asm_.movzx_eax_al();
+            return;
+        }
+
+        asm_.load_sd(XMM0, RBX, disp(slot_a));
+        asm_.load_sd(XMM1, RBX, disp(slot_b));
+        auto ucomisd = [this](Xmm x, Xmm y) { asm_.rr({0x66}, false, {0x0F, 0x2E}, x, y); };
+        bool invert = false;
+        if (value_semantics && relation == Relation::Le) {
+            relation = Relation::Gt;
+            invert = true;
+        } else if (value_semantics && relation == Relation::Ge) {
+            relation = Relation::Lt;
+            invert = true;
+        }
+        // Unordered operands set ZF, PF and CF, so `above` forms are false for NaN
+        switch (relation) {
+            case Relation::Lt: ucomisd(XMM1, XMM0); asm_.setcc(kAbove, RAX); break;
+            case Relation::Gt: ucomisd(XMM0, XMM1); asm_.setcc(kAbove, RAX); break;
+            case Relation::Le: ucomisd(XMM1, XMM0); asm_.setcc(kAboveEqual, RAX); break;
+            case Relation::Ge: ucomisd(XMM0, XMM1); asm_.setcc(kAboveEqual, RAX); break;
+            case Relation::Eq:
+                ucomisd(XMM0, XMM1);
+                asm_.setcc(kEqual, RAX);
+                asm_.setcc(kNoParity, RCX);
+                asm_.bytes({0x20, 0xC8});  // and al, cl
+                break;
+            case Relation::Ne:
+                ucomisd(XMM0, XMM1);
+                asm_.setcc(kNotEqual, RAX);
+                asm_.setcc(kParity, RCX);
+                asm_.bytes({0x08, 0xC8});  // or al, cl
+                break;
+        }
+        if (invert) {
+            asm_.bytes({0x34, 0x01});  // xor al, 1
+        }
+        asm_.movzx_eax_al();
+    }
+
+    // result = a / b or a % b for Ints; division by zero gives up
+    auto emit_int_divide(bool modulo, size_t slot_a, size_t slot_b, Assembler::Label fail) -> void {
+        auto general = asm_.new_label();
+        auto done = asm_.new_label();
+        asm_.load(RAX, RBX, disp(slot_a));
+        asm_.load(RCX, RBX, disp(slot_b));
+        asm_.rr({}, true, {0x85}, RCX, RCX);  // test rcx, rcx
+        asm_.jcc(kEqual, fail);
+        // x / -1 is -x and x % -1 is 0; idiv would trap on INT64_MIN
+        asm_.cmp_imm8(RBX, disp(slot_b), -1);
+        asm_.jcc(kNotEqual, general);
+        if (modulo) {
+            asm_.rr({}, false, {0x31}, RAX, RAX);  // xor eax, eax
+        } else {
+            asm_.rr({}, true, {0xF7}, 3, RAX);  // neg rax
+        }
+        asm_.jmp(done);
+        asm_.bind(general);
+        asm_.bytes({0x48, 0x99});             // cqo
+        asm_.rr({}, true, {0xF7}, 7, RCX);    // idiv rcx
+        if (modulo) {
+            asm_.rr({}, true, {0x89}, RDX, RAX);  // mov rax, rdx
+        }
+        asm_.bind(done);
+        asm_.store(RBX, disp(slot_a), RAX);
+    }
+
+    // result = a op b as Floats, converting Int operands
+    auto emit_float_arith(OpCode op, Kind a, Kind b, size_t slot_a, size_t slot_b, Assembler::Label fail) -> void {
+        if (op == OpCode::DIV) {
+            if (b == Kind::Int) {
+                asm_.cmp_imm8(RBX, disp(slot_b), 0);
+            } else {
+                asm_.load(RCX, RBX, disp(slot_b));
+                asm_.rr({}, true, {0x01}, RCX, RCX);  // add rcx, rcx: zero for ±0.0
+            }
+            asm_.jcc(kEqual, fail);
+        }
+        load_double(XMM0, a, slot_a);
+        load_double(XMM1, b, slot_b);
+        uint8_t opcode = 0;
+        switch (op) {
+            case OpCode::ADD: opcode = 0x58; break;
+            case OpCode::MUL: opcode = 0x59; break;
+            case OpCode::SUB: opcode = 0x5C; break;
+            default: opcode = 0x5E; break;  // DIV
+        }
+        asm_.rr({0xF2}, false, {0x0F, opcode}, XMM0, XMM1);
+        asm_.store_sd(RBX, disp(slot_a), XMM0);
+    }
+
+    // Call `callee` with the `count` operands ending below `depth`; the
+    // result replaces them. Unwinds if the callee gave up.
+    auto emit_call(size_t callee, size_t locals, size_t depth, size_t count, Assembler::Label exit,
+                   const std::vector<Kind>& args) -> void {
+        const size_t base = locals + depth - count;
+        asm_.mem({}, true, {0x8D}, RDI, RBX, disp(base));  // lea rdi, [args]
+
+        const FunctionState& state = *known_[callee];
+        if (state.status == Status::Compiled) {
+            asm_.mov_imm64(RAX, reinterpret_cast<uintptr_t>(state.entry));
+            asm_.rr({}, false, {0xFF}, 2, RAX);  // call rax
+        } else {
+            size_t target = variants_.size();
+            for (size_t i = 0; i < variants_.size(); ++i) {
+                if (variants_[i].function == callee && variants_[i].params == args) {
+                    target = i;
+                }
+            }
+            if (target == variants_.size()) {
+                throw Unsupported{};
+            }
+            asm_.call(entry_labels_[target]);
+        }
+        asm_.mem({}, true, {0x83}, 7, R12, 8);  // cmp qword [r12 + failed], 0
+        asm_.byte(0);
+        asm_.jcc(kNotEqual, exit);
+        asm_.store(RBX, disp(base), RAX);
+    }
+
+    auto emit_return(size_t slot, uint32_t frame_bytes, uint32_t slots) -> void {
+        asm_.load(RAX, RBX, disp(slot));
+        asm_.mem({}, true, {0xFF}, 0, R12, 0);   // inc qword [r12 + frames_left]
+        asm_.mem({}, true, {0x81}, 0, R12, 24);  // add qword [r12 + slots_left], slots
+        asm_.imm32(slots);
+        asm_.rr({}, true, {0x81}, 0, RSP);       // add rsp, frame
+        asm_.imm32(frame_bytes);
+        asm_.byte(0x5B);                         // pop rbx
+        asm_.byte(0xC3);                         // ret
+    }
+
+    auto emit_variant(size_t index) -> void {
+        const Variant& variant = variants_[index];
+        const auto& info = bytecode_.functions[variant.function];
+        const size_t locals = std::max(info.local_count, variant.params.size());
+        const size_t params = variant.params.size();
+        // rsp is 16-byte aligned after `push rbx` and this, as on any call
+        const auto frame_bytes = static_cast<uint32_t>((variant.slots * 8 + 15) / 16 * 16);
+        const auto slots = static_cast<uint32_t>(variant.slots);
+
+        auto fail = asm_.new_label();
+        auto exit = asm_.new_label();
+        auto body = asm_.new_label();
+        std::map<size_t, Assembler::Label> at;
+        auto label_at = [&](size_t offset) {
+            auto [it, inserted] = at.try_emplace(offset, 0);
+            if (inserted) {
+                it->second = asm_.new_label();
+            }
+            return it->second;
+        };
+
+        // Prologue: frame, depth and native stack checks, then the arguments
+        asm_.bind(entry_labels_[index]);
+        asm_.byte(0x53);                         // push rbx
+        asm_.rr({}, true, {0x81}, 5, RSP);       // sub rsp, frame
+        asm_.imm32(frame_bytes);
+        asm_.rr({}, true, {0x89}, RSP, RBX);     // mov rbx, rsp
+        asm_.mem({}, true, {0xFF}, 1, R12, 0);   // dec qword [r12 + frames_left]
+        asm_.jcc(kSign, fail);
+        // The interpreter's frame never needs more value stack than this one
+        asm_.mem({}, true, {0x81}, 5, R12, 24);  // sub qword [r12 + slots_left], slots
+        asm_.imm32(slots);
+        asm_.jcc(kSign, fail);
+        asm_.mem({}, true, {0x3B}, RSP, R12, 16);  // cmp rsp, [r12 + stack_limit]
+        asm_.jcc(kBelow, fail);
+        for (size_t i = 0; i < params; ++i) {
+            asm_.load(RAX, RDI, disp(i));
+            asm_.store(RBX, disp(i), RAX);
+        }
+        for (size_t i = params; i < locals; ++i) {
+            asm_.store_imm(RBX, disp(i), 0);
+        }
+        asm_.bind(body);
+
+        for (const auto& [offset, state] : variant.states) {
+            asm_.bind(label_at(offset));
+            const auto op = static_cast<OpCode>(code_[offset]);
+            const size_t next = offset + 1 + opcode_operand_size(op);
+            const size_t depth = state.stack.size();
+            const size_t top = locals + depth - 1;  // Slot of the top operand
+            auto kind = [&](size_t from_top) { return concrete(state.stack[depth - 1 - from_top]); };
+
+            switch (op) {
+                case OpCode::CONSTANT:
+                case OpCode::LOAD_LOCAL_CONST: {
+                    size_t slot = locals + depth;
+                    if (op == OpCode::LOAD_LOCAL_CONST) {
+                        asm_.load(RAX, RBX, disp(u16_at(offset + 1)));
+                        asm_.store(RBX, disp(slot), RAX);
+                        ++slot;
+                    }
+                    const Value& constant = bytecode_.constants[u16_at(offset + (op == OpCode::CONSTANT ? 1 : 3))];
+                    uint64_t bits = constant.is_int() ? static_cast<uint64_t>(constant.as_int())
+                                  : constant.is_float() ? std::bit_cast<uint64_t>(constant.as_float())
+                                  : uint64_t{constant.as_bool()};
+                    auto as_signed = static_cast<int64_t>(bits);
+                    if (as_signed >= INT32_MIN && as_signed <= INT32_MAX) {
+                        asm_.store_imm(RBX, disp(slot), static_cast<int32_t>(as_signed));
+                    } else {
+                        asm_.mov_imm64(RAX, bits);
+                        asm_.store(RBX, disp(slot), RAX);
+                    }
+                    break;
+                }
+                case OpCode::TRUE:
+                case OpCode::FALSE:
+                    asm_.store_imm(RBX, disp(locals + depth), op == OpCode::TRUE ? 1 : 0);
+                    break;
+                case OpCode::LOAD_LOCAL:
+                    asm_.load(RAX, RBX, disp(u16_at(offset + 1)));
+                    asm_.store(RBX, disp(locals + depth), RAX);
+                    break;
+                case OpCode::LOAD_LOCAL2:
+                    asm_.load(RAX, RBX, disp(u16_at(offset + 1)));
+                    asm_.store(RBX, disp(locals + depth), RAX);
+                    asm_.load(RAX, RBX, disp(u16_at(offset + 3)));
+                    asm_.store(RBX, disp(locals + depth + 1), RAX);
+                    break;
+                case OpCode::STORE_LOCAL:
+                    asm_.load(RAX, RBX, disp(top));
+                    asm_.store(RBX, disp(u16_at(offset + 1)), RAX);
+                    break;
+                case OpCode::POP:
+                    break;
+                case OpCode::DUP:
+                    asm_.load(RAX, RBX, disp(top));
+                    asm_.store(RBX, disp(top + 1), RAX);
+                    break;
+
+                case OpCode::ADD_INT: case OpCode::SUB_INT: case OpCode::MUL_INT:
+                case OpCode::ADD: case OpCode::SUB: case OpCode::MUL: case OpCode::DIV: case OpCode::MOD:
+                case OpCode::DIV_INT: case OpCode::MOD_INT: {
+                    Kind a = kind(1);
+                    Kind b = kind(0);
+                    if (a != Kind::Int || b != Kind::Int) {
+                        emit_float_arith(op, a, b, top - 1, top, fail);
+                        break;
+                    }
+                    if (op == OpCode::DIV || op == OpCode::DIV_INT || op == OpCode::MOD || op == OpCode::MOD_INT) {
+                        emit_int_divide(op == OpCode::MOD || op == OpCode::MOD_INT, top - 1, top, fail);
+                        break;
+                    }
+                    asm_.load(RAX, RBX, disp(top - 1));
+                    asm_.load(RCX, RBX, disp(top));
+                    if (op == OpCode::ADD || op == OpCode::ADD_INT) {
+                        asm_.rr({}, true, {0x01}, RCX, RAX);        // add rax, rcx
+                    } else if (op == OpCode::SUB || op == OpCode::SUB_INT) {
+                        asm_.rr({}, true, {0x29}, RCX, RAX);        // sub rax, rcx
+                    } else {
+                        asm_.rr({}, true, {0x0F, 0xAF}, RAX, RCX);  // imul rax, rcx
+                    }
+                    asm_.store(RBX, disp(top - 1), RAX);
+                    break;
+                }
+                case OpCode::ADD_FLOAT: case OpCode::SUB_FLOAT: case OpCode::MUL_FLOAT: case OpCode::DIV_FLOAT: {
+                    static constexpr OpCode kGeneric[] = {OpCode::ADD, OpCode::SUB, OpCode::MUL, OpCode::DIV};
+                    auto generic = kGeneric[static_cast<size_t>(op) - static_cast<size_t>(OpCode::ADD_FLOAT)];
+                    emit_float_arith(generic, kind(1), kind(0), top - 1, top, fail);
+                    break;
+                }
+
+                case OpCode::EQ_INT: case OpCode::NE_INT: case OpCode::LT_INT:
+                case OpCode::GT_INT: case OpCode::LE_INT: case OpCode::GE_INT:
+                case OpCode::LT_FLOAT: case OpCode::GT_FLOAT: case OpCode::LE_FLOAT: case OpCode::GE_FLOAT:
+                case OpCode::EQ: case OpCode::NE: case OpCode::LT:
+                case OpCode::GT: case OpCode::LE: case OpCode::GE: {
+                    bool typed = op >= OpCode::EQ_INT && op <= OpCode::GE_FLOAT;
+                    emit_compare(*relation_of(op), kind(1), kind(0), top - 1, top, !typed);
+                    asm_.store(RBX, disp(top - 1), RAX);
+                    break;
+                }
+                case OpCode::AND:
+                case OpCode::OR:
+                    test_truthy(kind(1), top - 1);
+                    asm_.setcc(kNotEqual, RDX);
+                    test_truthy(kind(0), top);
+                    asm_.setcc(kNotEqual, RAX);
+                    asm_.bytes({static_cast<uint8_t>(op == OpCode::AND ? 0x20 : 0x08), 0xD0});  // and/or al, dl
+                    asm_.movzx_eax_al();
+                    asm_.store(RBX, disp(top - 1), RAX);
+                    break;
+                case OpCode::NOT:
+                    test_truthy(kind(0), top);
+                    asm_.setcc(kEqual, RAX);
+                    asm_.movzx_eax_al();
+                    asm_.store(RBX, disp(top), RAX);
+                    break;
+                case OpCode::NEGATE:
+                    asm_.load(RAX, RBX, disp(top));
+                    if (kind(0) == Kind::Int) {
+                        asm_.rr({}, true, {0xF7}, 3, RAX);        // neg rax
+                    } else {
+                        asm_.rr({}, true, {0x0F, 0xBA}, 7, RAX);  // btc rax, 63
+                        asm_.byte(63);
+                    }
+                    asm_.store(RBX, disp(top), RAX);
+                    break;
+                case OpCode::POSITIVE:
+                    break;
+
+                case OpCode::JUMP:
+                    asm_.jmp(label_at(jump_target(offset, next)));
+                    break;
+                case OpCode::JUMP_IF_FALSE:
+                case OpCode::JUMP_IF_TRUE:
+                case OpCode::POP_JUMP_IF_FALSE:
+                    test_truthy(kind(0), top);
+                    asm_.jcc(op == OpCode::JUMP_IF_TRUE ? kNotEqual : kEqual, label_at(jump_target(offset, next)));
+                    break;
+                case OpCode::COMPARE_JUMP_IF_FALSE: {
+                    auto compare = static_cast<OpCode>(code_[offset + 3]);
+                    // Int operands compare as Ints whatever the opcode's type (VM::compare_ints)
+                    emit_compare(*relation_of(compare), kind(1), kind(0), top - 1, top, true);
+                    asm_.bytes({0x84, 0xC0});  // test al, al
+                    asm_.jcc(kEqual, label_at(jump_target(offset, next)));
+                    break;
+                }
+
+                case OpCode::CALL:
+                case OpCode::TAIL_CALL: {
+                    const size_t callee = u16_at(offset + 1);
+                    const size_t count = code_[offset + 3];
+                    std::vector<Kind> args;
+                    for (size_t i = count; i > 0; --i) {
+                        args.push_back(kind(i - 1));
+                    }
+                    if (op == OpCode::TAIL_CALL && callee == variant.function) {
+                        if (args != variant.params) {
+                            throw Unsupported{};
+                        }
+                        // Arguments become the parameters; other locals restart at Int(0)
+                        for (size_t i = 0; i < count; ++i) {
+                            asm_.load(RAX, RBX, disp(locals + depth - count + i));
+                            asm_.store(RBX, disp(i), RAX);
+                        }
+                        for (size_t i = count; i < locals; ++i) {
+                            asm_.store_imm(RBX, disp(i), 0);
+                        }
+                        asm_.jmp(body);
+                        break;
+                    }
+                    emit_call(callee, locals, depth, count, exit, args);
+                    if (op == OpCode::TAIL_CALL) {
+                        emit_return(locals + depth - count, frame_bytes, slots);
+                    }
+                    break;
+                }
+                case OpCode::RETURN:
+                    kind(0);
+                    emit_return(top, frame_bytes, slots);
+                    break;
+
+                default:
+                    throw Unsupported{};
+            }
+        }
+
+        asm_.bind(fail);
+        asm_.mem({}, true, {0xC7}, 0, R12, 8);  // mov qword [r12 + failed], 1
+        asm_.imm32(1);
+        asm_.bind(exit);
+        asm_.rr({}, true, {0x81}, 0, RSP);      // add rsp, frame
+        asm_.imm32(frame_bytes);
+        asm_.byte(0x5B);                        // pop rbx
+        asm_.byte(0xC3);                        // ret
+    }
+};
+
+} // namespace
+
+// ===== Jit =====
+
+struct Jit::Function : FunctionState {};
+
+// Executable copy of one translation's machine code
+class Jit::CodeBlock {
+public:
+    explicit CodeBlock(const std::vector<uint8_t>& code) {
+#if LUCID_HAS_JIT
+        const auto page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+        size_ = (code.size() + page - 1) / page * page;
+        void* memory = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (memory == MAP_FAILED) {
+            throw Unsupported{};
+        }
+        std::memcpy(memory, code.data(), code.size());
+        if (::mprotect(memory, size_, PROT_READ | PROT_EXEC) != 0) {
+            ::munmap(memory, size_);
+            throw Unsupported{};
+        }
+        base_ = static_cast<const uint8_t*>(memory);
+#else
+        (void)code;
+        throw Unsupported{};
+#endif
+    }
+
+    ~CodeBlock() {
+#if LUCID_HAS_JIT
+        ::munmap(const_cast<uint8_t*>(base_), size_);
+#endif
+    }
+
+    CodeBlock(const CodeBlock&) = delete;
+    auto operator=(const CodeBlock&) -> CodeBlock& = delete;
+
+    auto address(size_t offset) const -> const void* { return base_ + offset; }
+
+private:
+    const uint8_t* base_ = nullptr;
+    size_t size_ = 0;
+};
+
+Jit::Jit(const Bytecode& bytecode, uint32_t threshold, JitStats& stats)
+    : bytecode_(bytecode), threshold_(threshold), stats_(stats), functions_(bytecode.functions.size()) {}
+
+Jit::~Jit() = default;
+
+auto Jit::available() -> bool {
+    return LUCID_HAS_JIT != 0;
+}
+
+auto Jit::call(size_t function_index, std::span<const Value> args, size_t frames_left, size_t slots_left)
+    -> std::optional<Value> {
+    Function& function = functions_[function_index];
+    if (function.status == Status::Cold) {
+        if (++function.calls < threshold_) {
+            return std::nullopt;
+        }
+        compile(function_index, args);
+    }
+    if (function.status != Status::Compiled || frames_left == 0) {
+        return std::nullopt;
+    }
+
+    std::array<uint64_t, 256> raw_args;  // CALL's argument count is a byte
+    for (size_t i = 0; i < args.size(); ++i) {
+        Kind kind = kind_of(args[i]);
+        if (kind != function.params[i]) {
+            return std::nullopt;  // Specialised for other argument types
+        }
+        raw_args[i] = kind == Kind::Int ? static_cast<uint64_t>(args[i].as_int())
+                    : kind == Kind::Float ? std::bit_cast<uint64_t>(args[i].as_float())
+                    : uint64_t{args[i].as_bool()};
+    }
+
+    auto here = reinterpret_cast<uintptr_t>(__builtin_frame_address(0));
+    NativeContext context{
+        static_cast<int64_t>(frames_left),
+        0,
+        here > kNativeStackBytes ? here - kNativeStackBytes : 0,
+        static_cast<int64_t>(slots_left),
+    };
+    auto trampoline = std::bit_cast<Trampoline>(function.trampoline);
+    uint64_t result = trampoline(raw_args.data(), &context, function.entry);
+    ++stats_.native_calls;
+
+    if (context.failed != 0) {
+        // The interpreter re-runs the call; never try this one again
+        ++stats_.deopts;
+        function.status = Status::Deoptimised;
+        return std::nullopt;
+    }
+    switch (function.result) {
+        case Kind::Int: return Value(static_cast<int64_t>(result));
+        case Kind::Float: return Value(std::bit_cast<double>(result));
+        default: return Value(result != 0);
+    }
+}
+
+auto Jit::compile(size_t function_index, std::span<const Value> args) -> void {
+    functions_[function_index].status = Status::Rejected;
+    if (!available()) {
+        ++stats_.rejected;
+        return;
+    }
+
+    std::vector<Kind> params;
+    for (const auto& arg : args) {
+        params.push_back(kind_of(arg));
+    }
+    std::vector<const FunctionState*> known;
+    for (const auto& function : functions_) {
+        known.push_back(&function);
+    }
+    // The root is analysed as not-yet-compiled
+    functions_[function_index].status = Status::Cold;
+
+    try {
+        for (Kind kind : params) {
+            if (!is_scalar(kind)) {
+                throw Unsupported{};
+            }
+        }
+        Translator translator(bytecode_, std::move(known));
+        translator.analyse(function_index, params);
+        std::vector<size_t> entries;
+        auto code = translator.emit(entries);
+        blocks_.push_back(std::make_unique<CodeBlock>(code));
+
+        const CodeBlock& block = *blocks_.back();
+        const auto& variants = translator.variants();
+        for (size_t i = 0; i < variants.size(); ++i) {
+            Function& compiled = functions_[variants[i].function];
+            compiled.status = Status::Compiled;
+            compiled.params = variants[i].params;
+            compiled.result = variants[i].result;
+            compiled.entry = block.address(entries[i]);
+            compiled.trampoline = block.address(0);
+        }
+        stats_.compiled += variants.size();
+    } catch (const Unsupported&) {
+        functions_[function_index].status = Status::Rejected;
+        ++stats_.rejected;
+    }
+}
+
+} // namespace lucid::backend
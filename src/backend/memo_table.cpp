@@ -0,0 +1,217 @@
+#include <lucid/backend/memo_table.hpp>
+#include <lucid/backend/persistent_vector.hpp>
+#include <algorithm>
+#include <bit>
+#include <functional>
+#include <optional>
+
+namespace lucid::backend {
+
+namespace {
+
+// SplitMix64 finaliser: small Ints differ in every bit of their hash
+auto mix(uint64_t x) -> uint64_t {
+    x += 0x9E3779B97F4A7C15;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EB;
+    return x ^ (x >> 31);
+}
+
+auto combine(uint64_t seed, uint64_t value) -> uint64_t {
+    return mix(seed ^ value);
+}
+
+// Null when `value` holds a function value
+auto hash_value(const Value& value) -> std::optional<uint64_t> {
+    const auto seed = static_cast<uint64_t>(value.type());
+    switch (value.type()) {
+        case ValueType::Int:
+            return combine(seed, static_cast<uint64_t>(value.as_int()));
+        case ValueType::Float:
+            return combine(seed, std::bit_cast<uint64_t>(value.as_float()));
+        case ValueType::Bool:
+            return combine(seed, value.as_bool() ? 1 : 0);
+        case ValueType::String:
+            return combine(seed, std::hash<std::string_view>{}(value.as_string()));
+        case ValueType::List: {
+            uint64_t hash = combine(seed, value.as_list().size());
+            for (const auto& element : value.as_list()) {
+                auto element_hash = hash_value(element);
+                if (!element_hash) {
+                    return std::nullopt;
+                }
+                hash = combine(hash, *element_hash);
+            }
+            return hash;
+        }
+        case ValueType::Tuple: {
+            uint64_t hash = combine(seed, value.as_tuple().size());
+            for (const auto& element : value.as_tuple()) {
+                auto element_hash = hash_value(element);
+                if (!element_hash) {
+                    return std::nullopt;
+                }
+                hash = combine(hash, *element_hash);
+            }
+            return hash;
+        }
+        case ValueType::Function:
+            return std::nullopt;
+    }
+    return std::nullopt;
+}
+
+auto hash_args(std::span<const Value> args) -> std::optional<uint64_t> {
+    uint64_t hash = mix(args.size());
+    for (const auto& arg : args) {
+        auto arg_hash = hash_value(arg);
+        if (!arg_hash) {
+            return std::nullopt;
+        }
+        hash = combine(hash, *arg_hash);
+    }
+    return hash;
+}
+
+// Value::operator== but for Floats, which must match bit for bit: 0.0 and
+// -0.0 print differently, and a NaN argument should still hit
+auto same_key(const Value& a, const Value& b) -> bool {
+    if (a.type() != b.type()) {
+        return false;
+    }
+    switch (a.type()) {
+        case ValueType::Float:
+            return std::bit_cast<uint64_t>(a.as_float()) == std::bit_cast<uint64_t>(b.as_float());
+        case ValueType::List:
+            return std::ranges::equal(a.as_list(), b.as_list(), same_key);
+        case ValueType::Tuple:
+            return std::ranges::equal(a.as_tuple(), b.as_tuple(), same_key);
+        default:
+            return a == b;
+    }
+}
+
+} // namespace
+
+auto find_effects(const Bytecode& program) -> std::vector<std::string_view> {
+    const auto code = program.code();
+    const size_t count = program.functions.size();
+
+    // Functions are laid out one after another, so each one's code runs up
+    // to the next offset
+    std::vector<size_t> starts;
+    starts.reserve(count);
+    for (const auto& function : program.functions) {
+        starts.push_back(function.offset);
+    }
+    std::ranges::sort(starts);
+
+    std::vector<std::string_view> effects(count);
+    std::vector<std::vector<size_t>> dependents(count);  // Callee -> the functions reaching it
+    for (size_t i = 0; i < count; ++i) {
+        const size_t begin = program.functions[i].offset;
+        const auto next = std::ranges::upper_bound(starts, begin);
+        const size_t end = next == starts.end() ? code.size() : std::min(*next, code.size());
+
+        for (size_t offset = begin; offset < end;) {
+            const auto opcode = static_cast<OpCode>(code[offset]);
+            const size_t operands = opcode_operand_size(opcode);
+            if (operands >= 2 && offset + 2 < code.size()) {
+                const size_t operand = size_t{code[offset + 1]} | size_t{code[offset + 2]} << 8;
+                switch (opcode) {
+                    case OpCode::CALL_BUILTIN:
+                        switch (static_cast<BuiltinId>(operand)) {
+                            case BuiltinId::TO_STRING:
+                                break;
+                            default:
+                                if (effects[i].empty()) {
+                                    effects[i] = builtin_name(static_cast<BuiltinId>(operand));
+                                }
+                                break;
+                        }
+                        break;
+                    case OpCode::CALL:
+                    case OpCode::TAIL_CALL:
+                    case OpCode::LOAD_GLOBAL:
+                    case OpCode::MAKE_CLOSURE:
+                        if (operand < count) {
+                            dependents[operand].push_back(i);
+                        }
+                        break;
+                    default:
+                        break;
+                }
+            }
+            offset += 1 + operands;
+        }
+    }
+
+    // Spread each effect to everything that reaches it
+    std::vector<size_t> pending;
+    for (size_t i = 0; i < count; ++i) {
+        if (!effects[i].empty()) {
+            pending.push_back(i);
+        }
+    }
+    while (!pending.empty()) {
+        const size_t callee = pending.back();
+        pending.pop_back();
+        for (size_t caller : dependents[callee]) {
+            if (effects[caller].empty()) {
+                effects[caller] = effects[callee];
+                pending.push_back(caller);
+            }
+        }
+    }
+    return effects;
+}
+
+auto MemoTable::cacheable(std::span<const Value> args) -> bool {
+    return hash_args(args).has_value();
+}
+
+auto MemoTable::find(std::span<const Value> args) -> const Entry* {
+    if (entries_.empty()) {
+        return nullptr;
+    }
+    auto hash = hash_args(args);
+    if (!hash) {
+        return nullptr;
+    }
+    auto [first, last] = index_.equal_range(*hash);
+    for (auto it = first; it != last; ++it) {
+        auto entry = it->second;
+        if (std::ranges::equal(entry->args, args, same_key)) {
+            entries_.splice(entries_.begin(), entries_, entry);
+            return &*entry;
+        }
+    }
+    return nullptr;
+}
+
+auto MemoTable::insert(std::span<const Value> args, Value result, bool unpacked) -> void {
+    auto hash = hash_args(args);
+    if (!hash || capacity_ == 0) {
+        return;
+    }
+    if (entries_.size() == capacity_) {
+        auto oldest = std::prev(entries_.end());
+        auto [first, last] = index_.equal_range(oldest->hash);
+        for (auto it = first; it != last; ++it) {
+            if (it->second == oldest) {
+                index_.erase(it);
+                break;
+            }
+        }
+        entries_.erase(oldest);
+    }
+    entries_.push_front(Entry{*hash, std::vector<Value>(args.begin(), args.end()), std::move(result), unpacked});
+    index_.emplace(*hash, entries_.begin());
+}
+
+auto MemoTable::clear() -> void {
+    index_.clear();
+    entries_.clear();
+}
+
+} // namespace lucid::backend
@@ -0,0 +1,404 @@
+#include <lucid/backend/optimizer.hpp>
+#include <fmt/format.h>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+namespace lucid::backend {
+
+namespace {
+
+constexpr size_t kNoTarget = std::numeric_limits<size_t>::max();
+constexpr size_t kMaxRounds = 8;
+constexpr size_t kMaxJumpChain = 16;
+
+// ===== Decoded Form =====
+
+struct Instr {
+    OpCode op;
+    uint16_t a = 0;             // First operand (unused for jumps, see target)
+    uint16_t b = 0;             // Second operand
+    size_t target = kNoTarget;  // Index of the jump target; size() means "end"
+    size_t origin = 0;          // Byte offset in the original stream
+};
+
+struct Program {
+    std::vector<Instr> code;
+    std::vector<size_t> entries;  // Function index -> instruction index
+};
+
+auto is_jump(OpCode op) -> bool {
+    switch (op) {
+        case OpCode::JUMP:
+        case OpCode::JUMP_IF_FALSE:
+        case OpCode::JUMP_IF_TRUE:
+        case OpCode::POP_JUMP_IF_FALSE:
+        case OpCode::COMPARE_JUMP_IF_FALSE:
+            return true;
+        default:
+            return false;
+    }
+}
+
+auto is_comparison(OpCode op) -> bool {
+    switch (op) {
+        case OpCode::EQ: case OpCode::NE: case OpCode::LT:
+        case OpCode::GT: case OpCode::LE: case OpCode::GE:
+        case OpCode::EQ_INT: case OpCode::NE_INT: case OpCode::LT_INT:
+        case OpCode::GT_INT: case OpCode::LE_INT: case OpCode::GE_INT:
+        case OpCode::LT_FLOAT: case OpCode::GT_FLOAT:
+        case OpCode::LE_FLOAT: case OpCode::GE_FLOAT:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Instructions that only push a value, so `<op>; POP` does nothing
+auto is_pure_push(OpCode op) -> bool {
+    switch (op) {
+        case OpCode::CONSTANT:
+        case OpCode::TRUE:
+        case OpCode::FALSE:
+        case OpCode::LOAD_LOCAL:
+        case OpCode::LOAD_GLOBAL:
+        case OpCode::DUP:
+            return true;
+        default:
+            return false;
+    }
+}
+
+auto ends_block(OpCode op) -> bool {
+    return op == OpCode::JUMP || op == OpCode::RETURN || op == OpCode::RETURN_TUPLE ||
+           op == OpCode::TAIL_CALL || op == OpCode::HALT;
+}
+
+auto instruction_size(OpCode op) -> size_t {
+    return 1 + opcode_operand_size(op);
+}
+
+auto read_u16(const std::vector<uint8_t>& bytes, size_t offset) -> uint16_t {
+    return static_cast<uint16_t>(
+        static_cast<uint16_t>(bytes[offset]) | (static_cast<uint16_t>(bytes[offset + 1]) << 8)
+    );
+}
+
+auto decode(const Bytecode& bytecode) -> Program {
+    const auto& bytes = bytecode.instructions;
+    Program program;
+    std::vector<size_t> index_at(bytes.size() + 1, kNoTarget);
+
+    for (size_t offset = 0; offset < bytes.size();) {
+        if (bytes[offset] >= kOpCodeCount) {
+            throw std::runtime_error(fmt::format(
+                "Cannot optimise unknown opcode {} at offset {}", bytes[offset], offset
+            ));
+        }
+        Instr instr{static_cast<OpCode>(bytes[offset])};
+        instr.origin = offset;
+        const size_t operand_size = opcode_operand_size(instr.op);
+        if (offset + operand_size >= bytes.size()) {
+            throw std::runtime_error(fmt::format("Truncated instruction at offset {}", offset));
+        }
+        switch (operand_size) {
+            case 1: instr.a = bytes[offset + 1]; break;
+            case 2: instr.a = read_u16(bytes, offset + 1); break;
+            case 3: instr.a = read_u16(bytes, offset + 1); instr.b = bytes[offset + 3]; break;
+            case 4: instr.a = read_u16(bytes, offset + 1); instr.b = read_u16(bytes, offset + 3); break;
+            default: break;
+        }
+        index_at[offset] = program.code.size();
+        program.code.push_back(instr);
+        offset += 1 + operand_size;
+    }
+    index_at[bytes.size()] = program.code.size();
+
+    // Resolve relative jump offsets to instruction indices
+    for (auto& instr : program.code) {
+        if (!is_jump(instr.op)) {
+            continue;
+        }
+        const auto destination = static_cast<int64_t>(instr.origin + instruction_size(instr.op)) +
+                                 static_cast<int16_t>(instr.a);
+        if (destination < 0 || static_cast<size_t>(destination) > bytes.size() ||
+            index_at[static_cast<size_t>(destination)] == kNoTarget) {
+            throw std::runtime_error(fmt::format(
+                "Jump at offset {} does not land on an instruction", instr.origin
+            ));
+        }
+        instr.target = index_at[static_cast<size_t>(destination)];
+    }
+
+    for (const auto& function : bytecode.functions) {
+        if (function.offset > bytes.size() || index_at[function.offset] == kNoTarget) {
+            throw std::runtime_error(fmt::format(
+                "Function '{}' does not start on an instruction", function.name
+            ));
+        }
+        program.entries.push_back(index_at[function.offset]);
+    }
+    return program;
+}
+
+// Instructions that control can reach from somewhere other than the one
+// before them
+auto find_labels(const Program& program) -> std::vector<bool> {
+    std::vector<bool> labels(program.code.size() + 1, false);
+    for (const auto& instr : program.code) {
+        if (instr.target != kNoTarget) {
+            labels[instr.target] = true;
+        }
+    }
+    for (size_t entry : program.entries) {
+        labels[entry] = true;
+    }
+    return labels;
+}
+
+// ===== Passes =====
+
+// Retarget jumps that land on unconditional jumps; a JUMP to RETURN (or
+// RETURN_TUPLE) becomes the return itself
+auto thread_jumps(Program& program, OptimizeStats& stats) -> bool {
+    auto& code = program.code;
+    bool changed = false;
+    for (auto& instr : code) {
+        if (instr.target == kNoTarget) {
+            continue;
+        }
+        size_t target = instr.target;
+        for (size_t hops = 0; hops < kMaxJumpChain && target < code.size() &&
+                              code[target].op == OpCode::JUMP; ++hops) {
+            target = code[target].target;
+        }
+        if (target != instr.target) {
+            instr.target = target;
+            ++stats.jumps_threaded;
+            changed = true;
+        }
+        if (instr.op == OpCode::JUMP && target < code.size() &&
+            (code[target].op == OpCode::RETURN || code[target].op == OpCode::RETURN_TUPLE)) {
+            instr.op = code[target].op;
+            instr.a = code[target].a;
+            instr.target = kNoTarget;
+            ++stats.jumps_threaded;
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+// One left-to-right rewrite: fusions, redundant pairs and unreachable code
+auto rewrite(Program& program, OptimizeStats& stats) -> bool {
+    const auto& code = program.code;
+    const size_t n = code.size();
+    const auto labels = find_labels(program);
+
+    std::vector<Instr> out;
+    out.reserve(n);
+    std::vector<size_t> remap(n + 1, kNoTarget);
+    bool changed = false;
+    bool reachable = true;
+
+    // Whether code[i + k] exists, is not a label and has the given opcode
+    auto followed_by = [&](size_t i, size_t k, OpCode op) {
+        return i + k < n && !labels[i + k] && code[i + k].op == op;
+    };
+    auto drop = [&](size_t first, size_t count) {
+        for (size_t j = first; j < first + count; ++j) {
+            remap[j] = out.size();
+        }
+        stats.removed += count;
+        changed = true;
+    };
+    auto fuse = [&](size_t first, size_t count, Instr fused) {
+        for (size_t j = first; j < first + count; ++j) {
+            remap[j] = out.size();
+        }
+        fused.origin = code[first].origin;
+        out.push_back(fused);
+        ++stats.fused;
+        changed = true;
+    };
+
+    for (size_t i = 0; i < n;) {
+        const Instr& cur = code[i];
+        if (labels[i]) {
+            reachable = true;
+        }
+
+        if (!reachable && cur.op != OpCode::HALT) {
+            drop(i, 1);
+            i += 1;
+            continue;
+        }
+        if (cur.op == OpCode::JUMP && cur.target == i + 1) {
+            drop(i, 1);
+            i += 1;
+            continue;
+        }
+        if (cur.op == OpCode::JUMP_IF_FALSE && followed_by(i, 1, OpCode::POP) &&
+            cur.target < n && code[cur.target].op == OpCode::POP) {
+            // Both paths pop the condition first: pop it in the branch
+            Instr fused{OpCode::POP_JUMP_IF_FALSE};
+            fused.target = cur.target + 1;
+            fuse(i, 2, fused);
+            i += 2;
+            continue;
+        }
+        if (is_comparison(cur.op) && followed_by(i, 1, OpCode::POP_JUMP_IF_FALSE)) {
+            Instr fused{OpCode::COMPARE_JUMP_IF_FALSE};
+            fused.b = static_cast<uint16_t>(cur.op);
+            fused.target = code[i + 1].target;
+            fuse(i, 2, fused);
+            i += 2;
+            continue;
+        }
+        if (is_pure_push(cur.op) && followed_by(i, 1, OpCode::POP)) {
+            drop(i, 2);
+            i += 2;
+            continue;
+        }
+        if (cur.op == OpCode::LOAD_LOCAL && followed_by(i, 1, OpCode::LOAD_LOCAL)) {
+            Instr fused{OpCode::LOAD_LOCAL2, cur.a, code[i + 1].a};
+            fuse(i, 2, fused);
+            i += 2;
+            continue;
+        }
+        if (cur.op == OpCode::LOAD_LOCAL && followed_by(i, 1, OpCode::CONSTANT)) {
+            Instr fused{OpCode::LOAD_LOCAL_CONST, cur.a, code[i + 1].a};
+            fuse(i, 2, fused);
+            i += 2;
+            continue;
+        }
+
+        remap[i] = out.size();
+        out.push_back(cur);
+        reachable = !ends_block(cur.op);
+        i += 1;
+    }
+    remap[n] = out.size();
+
+    for (auto& instr : out) {
+        if (instr.target != kNoTarget) {
+            instr.target = remap[instr.target];
+        }
+    }
+    for (auto& entry : program.entries) {
+        entry = remap[entry];
+    }
+    program.code = std::move(out);
+    return changed;
+}
+
+// ===== Encoding =====
+
+auto encode(const Program& program, Bytecode& bytecode) -> void {
+    const auto& code = program.code;
+    std::vector<size_t> offsets(code.size() + 1, 0);
+    for (size_t i = 0; i < code.size(); ++i) {
+        offsets[i + 1] = offsets[i] + instruction_size(code[i].op);
+    }
+
+    const bool has_debug = !bytecode.debug_locations.empty() &&
+                           bytecode.debug_locations.size() == bytecode.instructions.size();
+    std::vector<SourceLocation> locations;
+    if (has_debug) {
+        locations.reserve(offsets.back());
+    }
+
+    std::vector<uint8_t> bytes;
+    bytes.reserve(offsets.back());
+    auto put_u16 = [&bytes](uint16_t value) {
+        bytes.push_back(static_cast<uint8_t>(value & 0xFF));
+        bytes.push_back(static_cast<uint8_t>((value >> 8) & 0xFF));
+    };
+
+    for (size_t i = 0; i < code.size(); ++i) {
+        const Instr& instr = code[i];
+        uint16_t first = instr.a;
+        if (instr.target != kNoTarget) {
+            const auto jump = static_cast<int64_t>(offsets[instr.target]) -
+                              static_cast<int64_t>(offsets[i + 1]);
+            if (jump < std::numeric_limits<int16_t>::min() || jump > std::numeric_limits<int16_t>::max()) {
+                throw std::runtime_error("Jump offset out of range after optimisation");
+            }
+            first = static_cast<uint16_t>(static_cast<int16_t>(jump));
+        }
+
+        bytes.push_back(static_cast<uint8_t>(instr.op));
+        switch (opcode_operand_size(instr.op)) {
+            case 1: bytes.push_back(static_cast<uint8_t>(first)); break;
+            case 2: put_u16(first); break;
+            case 3: put_u16(first); bytes.push_back(static_cast<uint8_t>(instr.b)); break;
+            case 4: put_u16(first); put_u16(instr.b); break;
+            default: break;
+        }
+
+        if (has_debug) {
+            locations.insert(locations.end(), instruction_size(instr.op),
+                             bytecode.debug_locations[instr.origin]);
+        }
+    }
+
+    for (size_t f = 0; f < bytecode.functions.size(); ++f) {
+        bytecode.functions[f].offset = offsets[program.entries[f]];
+    }
+    bytecode.instructions = std::move(bytes);
+    if (has_debug) {
+        bytecode.debug_locations = std::move(locations);
+    }
+}
+
+} // namespace
+
+auto optimize(Bytecode& bytecode) -> OptimizeStats {
+    OptimizeStats stats;
+    bytecode.unmap();  // Rewrites go through `instructions`
+    stats.bytes_before = bytecode.instructions.size();
+
+    Program program = decode(bytecode);
+    for (size_t round = 0; round < kMaxRounds; ++round) {
+        bool changed = thread_jumps(program, stats);
+        changed = rewrite(program, stats) || changed;
+        if (!changed) {
+            break;
+        }
+    }
+    encode(program, bytecode);
+
+    stats.bytes_after = bytecode.instructions.size();
+    return stats;
+}
+
+auto format_opcode_pairs(std::span<const uint64_t> counts, size_t limit) -> std::string {
+    std::vector<std::tuple<uint64_t, size_t, size_t>> pairs;
+    uint64_t total = 0;
+    for (size_t first = 0; first < kOpCodeCount; ++first) {
+        for (size_t second = 0; second < kOpCodeCount; ++second) {
+            const size_t index = first * kOpCodeCount + second;
+            if (index < counts.size() && counts[index] > 0) {
+                pairs.emplace_back(counts[index], first, second);
+                total += counts[index];
+            }
+        }
+    }
+    std::sort(pairs.begin(), pairs.end(), [](const auto& lhs, const auto& rhs) {
+        return std::get<0>(lhs) > std::get<0>(rhs);
+    });
+
+    std::string result = fmt::format("=== Opcode pairs ({} total) ===\n", total);
+    for (size_t i = 0; i < pairs.size() && i < limit; ++i) {
+        const auto& [count, first, second] = pairs[i];
+        result += fmt::format("{:>12}  {:5.1f}%  {} -> {}\n",
+                              count, 100.0 * static_cast<double>(count) / static_cast<double>(total),
+                              opcode_name(static_cast<OpCode>(first)),
+                              opcode_name(static_cast<OpCode>(second)));
+    }
+    return result;
+}
+
+} // namespace lucid::backend
@@ -0,0 +1,115 @@
+#include <lucid/backend/output_buffer.hpp>
+#include <fmt/format.h>
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <iterator>
+
+#if __has_include(<unistd.h>)
+#include <unistd.h>
+#define LUCID_HAS_ISATTY 1
+#else
+#define LUCID_HAS_ISATTY 0
+#endif
+
+namespace lucid::backend {
+
+namespace {
+
+auto is_terminal(std::streambuf* sink) -> bool {
+#if LUCID_HAS_ISATTY
+    if (sink == std::cout.rdbuf()) {
+        return ::isatty(STDOUT_FILENO) != 0;
+    }
+    if (sink == std::cerr.rdbuf()) {
+        return ::isatty(STDERR_FILENO) != 0;
+    }
+#else
+    (void)sink;
+#endif
+    return false;
+}
+
+} // namespace
+
+OutputBuffer::OutputBuffer(std::streambuf* sink, size_t capacity)
+    : sink_(sink)
+    , capacity_(capacity)
+    , line_buffered_(is_terminal(sink))
+{
+    buffer_.reserve(capacity_);
+}
+
+auto OutputBuffer::set_sink(std::streambuf* sink) -> void {
+    flush();
+    sink_ = sink;
+    line_buffered_ = is_terminal(sink);
+}
+
+auto OutputBuffer::set_capacity(size_t capacity) -> void {
+    flush();
+    capacity_ = capacity;
+    buffer_.shrink_to_fit();
+    buffer_.reserve(capacity_);
+}
+
+auto OutputBuffer::print(const Value& value) -> void {
+    append(value);
+    flush_if_full();
+}
+
+auto OutputBuffer::println(const Value& value) -> void {
+    append(value);
+    buffer_ += '\n';
+    if (line_buffered_) {
+        flush();
+    } else {
+        flush_if_full();
+    }
+}
+
+auto OutputBuffer::write(std::string_view text) -> void {
+    append_text(text);
+    flush_if_full();
+}
+
+auto OutputBuffer::append(const Value& value) -> void {
+    switch (value.type()) {
+        case ValueType::String:
+            append_text(value.as_string());
+            break;
+        case ValueType::Int:
+            fmt::format_to(std::back_inserter(buffer_), "{}", value.as_int());
+            break;
+        case ValueType::Float:
+            fmt::format_to(std::back_inserter(buffer_), "{}", value.as_float());
+            break;
+        case ValueType::Bool:
+            buffer_ += value.as_bool() ? "true" : "false";
+            break;
+        default:
+            buffer_ += value.to_string();
+            break;
+    }
+}
+
+auto OutputBuffer::append_text(std::string_view text) -> void {
+    // Long text goes straight through rather than via the buffer
+    if (text.size() >= capacity_) {
+        flush();
+        sink_->sputn(text.data(), static_cast<std::streamsize>(text.size()));
+        return;
+    }
+    buffer_ += text;
+}
+
+auto OutputBuffer::flush() -> void {
+    if (buffer_.empty()) {
+        return;
+    }
+    sink_->sputn(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+    sink_->pubsync();
+    buffer_.clear();
+}
+
+} // namespace lucid::backend
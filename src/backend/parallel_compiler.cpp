@@ -0,0 +1,145 @@
+#include <lucid/backend/parallel_compiler.hpp>
+#include <lucid/backend/compiler.hpp>
+#include <lucid/backend/value.hpp>
+#include <stdexcept>
+
+namespace lucid::backend {
+
+auto compile_parallel(ast::Program& program, ThreadPool& pool, bool inline_calls)
+    -> ParallelCompileResult {
+    ParallelCompileResult result;
+
+    semantic::TypeChecker globals;
+    globals.declare_functions(program);
+    auto functions = Compiler::function_table(program);
+
+    size_t count = program.functions.size();
+    std::vector<std::vector<semantic::TypeError>> errors(count);
+    std::vector<FoldStats> folds(count);
+    std::vector<Bytecode> chunks(count);
+
+    pool.parallel_for(count, [&](size_t i) {
+        semantic::TypeChecker checker(&globals);
+        checker.check_function(*program.functions[i]);
+        errors[i] = checker.get_errors();
+    });
+
+    result.errors = globals.get_errors();
+    for (auto& function_errors : errors) {
+        result.errors.insert(result.errors.end(), function_errors.begin(), function_errors.end());
+    }
+    if (!result.errors.empty()) {
+        return result;
+    }
+
+    // Inlining reads callees while it rewrites callers, so it runs on this
+    // thread between the rounds
+    if (inline_calls) {
+        result.inline_stats = inline_functions(program);
+    }
+    pool.parallel_for(count, [&](size_t i) {
+        folds[i] = fold_constants(*program.functions[i]);
+    });
+
+    // Which tuples escape depends on every call site, so it waits for all
+    // functions to be folded, as it does in Compiler::compile
+    const auto unpacked = find_unpacked_results(program);
+    pool.parallel_for(count, [&](size_t i) {
+        Compiler compiler;
+        chunks[i] = compiler.compile_chunk(program.functions[i].get(), functions, unpacked);
+    });
+
+    for (const auto& fold : folds) {
+        result.fold_stats.folded += fold.folded;
+        result.fold_stats.branches_pruned += fold.branches_pruned;
+        result.fold_stats.constant_literals += fold.constant_literals;
+    }
+    result.bytecode = link_chunks(chunks);
+    return result;
+}
+
+namespace {
+
+auto read_u16(const std::vector<uint8_t>& code, size_t offset) -> uint16_t {
+    return static_cast<uint16_t>(code[offset] | (code[offset + 1] << 8));
+}
+
+auto write_u16(std::vector<uint8_t>& code, size_t offset, uint16_t value) -> void {
+    code[offset] = static_cast<uint8_t>(value & 0xFF);
+    code[offset + 1] = static_cast<uint8_t>((value >> 8) & 0xFF);
+}
+
+// Offset, within an instruction, of its constant pool operand
+auto constant_operand(OpCode opcode) -> std::optional<size_t> {
+    switch (opcode) {
+        case OpCode::CONSTANT:
+        case OpCode::CALL_METHOD:
+            return 1;
+        case OpCode::LOAD_LOCAL_CONST:
+            return 3;
+        default:
+            return std::nullopt;
+    }
+}
+
+} // namespace
+
+auto link_chunks(std::vector<Bytecode>& chunks) -> Bytecode {
+    Bytecode program;
+
+    // Named functions keep their program-wide indices; the lambdas of every
+    // chunk follow them, in chunk order, as Compiler::compile numbers them
+    std::vector<size_t> bases;
+    size_t lambda_index = chunks.size();
+    for (auto& chunk : chunks) {
+        if (chunk.functions.empty()) {
+            throw std::runtime_error("A chunk must hold its function");
+        }
+        size_t base = program.instructions.size();
+        bases.push_back(base);
+        const auto& function = chunk.functions.front();
+        program.add_function(function.name, base + function.offset,
+                             function.param_count, function.local_count);
+
+        // Constants join the pool in the order the code first uses them,
+        // which is the order a single Compiler would have added them in
+        std::vector<int32_t> remap(chunk.constants.size(), -1);
+        auto& code = chunk.instructions;
+        for (size_t offset = 0; offset < code.size();) {
+            auto opcode = static_cast<OpCode>(code[offset]);
+            if (auto operand = constant_operand(opcode)) {
+                uint16_t index = read_u16(code, offset + *operand);
+                if (remap[index] < 0) {
+                    remap[index] = program.add_constant(chunk.constants[index]);
+                }
+                write_u16(code, offset + *operand, static_cast<uint16_t>(remap[index]));
+            }
+            if (opcode == OpCode::MAKE_CLOSURE) {
+                // Chunk-local: 1 is the chunk's first lambda
+                size_t local = read_u16(code, offset + 1);
+                write_u16(code, offset + 1, static_cast<uint16_t>(lambda_index + local - 1));
+            }
+            offset += 1 + opcode_operand_size(opcode);
+        }
+        lambda_index += chunk.functions.size() - 1;
+
+        program.instructions.insert(program.instructions.end(), code.begin(), code.end());
+        program.debug_locations.insert(program.debug_locations.end(),
+                                       chunk.debug_locations.begin(), chunk.debug_locations.end());
+    }
+
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        for (size_t f = 1; f < chunks[i].functions.size(); ++f) {
+            const auto& lambda = chunks[i].functions[f];
+            program.add_function(lambda.name, bases[i] + lambda.offset,
+                                 lambda.param_count, lambda.local_count);
+        }
+    }
+
+    // As Compiler::compile does, attributed to no source location
+    program.emit(OpCode::HALT);
+    program.debug_locations.resize(program.instructions.size(), SourceLocation{"", 0, 0, 0, 0});
+    return program;
+}
+
+} // namespace lucid::backend
@@ -0,0 +1,357 @@
+#include <lucid/backend/persistent_vector.hpp>
+#include <lucid/backend/value.hpp>
+#include <algorithm>
+#include <array>
+#include <new>
+#include <utility>
+
+namespace lucid::backend {
+
+// ===== Nodes =====
+
+struct PersistentVector::Node {
+    uint32_t refcount = 1;
+};
+
+struct PersistentVector::Inner : Node {
+    std::array<Node*, kWidth> children{};
+};
+
+// Leaves are allocated with room for `capacity` Values directly after the
+// header. Trie leaves are always full; only the tail starts out smaller so
+// that short lists stay small.
+struct PersistentVector::Leaf : Node {
+    uint8_t size = 0;
+    uint8_t capacity = 0;
+};
+
+auto PersistentVector::leaf_values(const Leaf* leaf) -> const Value* {
+    return reinterpret_cast<const Value*>(leaf + 1);
+}
+
+namespace {
+
+auto mutable_values(const Value* values) -> Value* {
+    return const_cast<Value*>(values);
+}
+
+} // namespace
+
+auto PersistentVector::make_leaf(size_t capacity) -> Leaf* {
+    static_assert(sizeof(Leaf) % alignof(Value) == 0);
+    void* memory = ::operator new(sizeof(Leaf) + capacity * sizeof(Value));
+    auto* leaf = new (memory) Leaf();
+    leaf->capacity = static_cast<uint8_t>(capacity);
+    return leaf;
+}
+
+auto PersistentVector::copy_leaf(const Leaf* leaf, size_t capacity) -> Leaf* {
+    Leaf* copy = make_leaf(capacity);
+    Value* dst = mutable_values(leaf_values(copy));
+    const Value* src = leaf_values(leaf);
+    for (size_t i = 0; i < leaf->size; ++i) {
+        new (dst + i) Value(src[i]);
+    }
+    copy->size = leaf->size;
+    return copy;
+}
+
+auto PersistentVector::destroy_leaf(Leaf* leaf) -> void {
+    Value* values = mutable_values(leaf_values(leaf));
+    for (size_t i = 0; i < leaf->size; ++i) {
+        values[i].~Value();
+    }
+    leaf->~Leaf();
+    ::operator delete(static_cast<void*>(leaf));
+}
+
+// Drop one reference to a node at the given trie level (0 = leaf)
+auto PersistentVector::release(Node* node, unsigned level) -> void {
+    if (node == nullptr || --node->refcount != 0) {
+        return;
+    }
+    if (level == 0) {
+        destroy_leaf(static_cast<Leaf*>(node));
+        return;
+    }
+    auto* inner = static_cast<Inner*>(node);
+    for (Node* child : inner->children) {
+        release(child, level - kBits);
+    }
+    delete inner;
+}
+
+auto PersistentVector::shares_node(const Node* node, unsigned level) -> bool {
+    if (node == nullptr) {
+        return false;
+    }
+    if (node->refcount != 1) {
+        return true;
+    }
+    if (level == 0) {
+        return false;
+    }
+    for (const Node* child : static_cast<const Inner*>(node)->children) {
+        if (shares_node(child, level - kBits)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+auto PersistentVector::shares_storage() const -> bool {
+    return shares_node(tail_, 0) || shares_node(root_, shift_);
+}
+
+// ===== Construction =====
+
+PersistentVector::PersistentVector(std::vector<Value> elements) {
+    for (auto& element : elements) {
+        push_back(std::move(element));
+    }
+}
+
+PersistentVector::~PersistentVector() {
+    clear();
+}
+
+PersistentVector::PersistentVector(const PersistentVector& other) noexcept
+    : count_(other.count_)
+    , offset_(other.offset_)
+    , shift_(other.shift_)
+    , root_(other.root_)
+    , tail_(other.tail_)
+{
+    if (root_ != nullptr) ++root_->refcount;
+    if (tail_ != nullptr) ++tail_->refcount;
+}
+
+PersistentVector::PersistentVector(PersistentVector&& other) noexcept
+    : count_(std::exchange(other.count_, 0))
+    , offset_(std::exchange(other.offset_, 0))
+    , shift_(std::exchange(other.shift_, kBits))
+    , root_(std::exchange(other.root_, nullptr))
+    , tail_(std::exchange(other.tail_, nullptr))
+{}
+
+auto PersistentVector::operator=(const PersistentVector& other) noexcept -> PersistentVector& {
+    if (this != &other) {
+        PersistentVector copy(other);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+auto PersistentVector::operator=(PersistentVector&& other) noexcept -> PersistentVector& {
+    if (this != &other) {
+        clear();
+        count_ = std::exchange(other.count_, 0);
+        offset_ = std::exchange(other.offset_, 0);
+        shift_ = std::exchange(other.shift_, kBits);
+        root_ = std::exchange(other.root_, nullptr);
+        tail_ = std::exchange(other.tail_, nullptr);
+    }
+    return *this;
+}
+
+auto PersistentVector::clear() -> void {
+    release(root_, shift_);
+    release(tail_, 0);
+    count_ = 0;
+    offset_ = 0;
+    shift_ = kBits;
+    root_ = nullptr;
+    tail_ = nullptr;
+}
+
+// ===== Access =====
+
+auto PersistentVector::tail_offset() const -> size_t {
+    if (count_ < kWidth) {
+        return 0;
+    }
+    return ((count_ - 1) >> kBits) << kBits;
+}
+
+auto PersistentVector::leaf_for(size_t physical) const -> const Leaf* {
+    if (physical >= tail_offset()) {
+        return tail_;
+    }
+    const Node* node = root_;
+    for (unsigned level = shift_; level > 0; level -= kBits) {
+        node = static_cast<const Inner*>(node)->children[(physical >> level) & kMask];
+    }
+    return static_cast<const Leaf*>(node);
+}
+
+auto PersistentVector::operator[](size_t index) const -> const Value& {
+    const size_t physical = index + offset_;
+    const size_t base = physical >= tail_offset() ? tail_offset() : (physical & ~kMask);
+    return leaf_values(leaf_for(physical))[physical - base];
+}
+
+// ===== Modifiers =====
+
+// Return a node this vector may mutate, cloning it if it is shared
+auto PersistentVector::unique_inner(Inner* node) -> Inner* {
+    if (node->refcount == 1) {
+        return node;
+    }
+    auto* copy = new Inner(*node);
+    copy->refcount = 1;
+    for (Node* child : copy->children) {
+        if (child != nullptr) ++child->refcount;
+    }
+    --node->refcount;  // Still referenced by whoever shared it
+    return copy;
+}
+
+// Wrap a node in single-child inner nodes up to the given level
+auto PersistentVector::new_path(unsigned level, Node* node) -> Node* {
+    if (level == 0) {
+        return node;
+    }
+    auto* inner = new Inner();
+    inner->children[0] = new_path(level - kBits, node);
+    return inner;
+}
+
+// Insert a full leaf as the rightmost leaf under parent
+auto PersistentVector::push_tail(unsigned level, Inner* parent, Leaf* leaf) -> Inner* {
+    Inner* result = parent != nullptr ? unique_inner(parent) : new Inner();
+    const size_t subidx = ((count_ - 1) >> level) & kMask;
+
+    if (level == kBits) {
+        result->children[subidx] = leaf;
+    } else {
+        auto* child = static_cast<Inner*>(result->children[subidx]);
+        result->children[subidx] = child != nullptr
+            ? push_tail(level - kBits, child, leaf)
+            : new_path(level - kBits, leaf);
+    }
+    return result;
+}
+
+auto PersistentVector::push_back(Value value) -> void {
+    const size_t tail_size = count_ - tail_offset();
+
+    if (tail_ == nullptr || tail_size < kWidth) {
+        // Room in the tail: make sure we own it and it has capacity
+        if (tail_ == nullptr) {
+            tail_ = make_leaf(4);
+        } else if (tail_->refcount != 1 || tail_->size == tail_->capacity) {
+            const size_t capacity = tail_->size == tail_->capacity
+                ? std::min(kWidth, size_t{tail_->capacity} * 2)
+                : tail_->capacity;
+            Leaf* grown = copy_leaf(tail_, capacity);
+            release(tail_, 0);
+            tail_ = grown;
+        }
+        new (mutable_values(leaf_values(tail_)) + tail_->size) Value(std::move(value));
+        ++tail_->size;
+        ++count_;
+        return;
+    }
+
+    // Tail is full: move it into the trie and start a new one
+    Leaf* full = tail_;
+    if ((count_ >> kBits) > (size_t{1} << shift_)) {
+        // Root overflow: grow the trie by one level
+        auto* new_root = new Inner();
+        new_root->children[0] = root_;
+        new_root->children[1] = new_path(shift_, full);
+        root_ = new_root;
+        shift_ += kBits;
+    } else {
+        root_ = push_tail(shift_, root_, full);
+    }
+
+    tail_ = make_leaf(kWidth);
+    new (mutable_values(leaf_values(tail_))) Value(std::move(value));
+    tail_->size = 1;
+    ++count_;
+}
+
+auto PersistentVector::pop_front() -> void {
+    if (empty()) {
+        return;
+    }
+    ++offset_;
+    if (empty()) {
+        clear();  // Nothing visible is left; drop the storage
+    }
+}
+
+auto PersistentVector::append(const PersistentVector& other) -> void {
+    if (empty()) {
+        *this = other;
+        return;
+    }
+    const size_t n = other.size();
+    for (size_t i = 0; i < n; ++i) {
+        push_back(other[i]);
+    }
+}
+
+auto PersistentVector::reverse() -> void {
+    PersistentVector reversed;
+    for (size_t i = size(); i > 0; --i) {
+        reversed.push_back((*this)[i - 1]);
+    }
+    *this = std::move(reversed);
+}
+
+// ===== Iteration and comparison =====
+
+auto PersistentVector::begin() const -> const_iterator {
+    return const_iterator(this, 0);
+}
+
+auto PersistentVector::end() const -> const_iterator {
+    return const_iterator(this, size());
+}
+
+auto PersistentVector::to_vector() const -> std::vector<Value> {
+    return std::vector<Value>(begin(), end());
+}
+
+auto PersistentVector::operator==(const PersistentVector& other) const -> bool {
+    if (size() != other.size()) {
+        return false;
+    }
+    if (root_ == other.root_ && tail_ == other.tail_ && offset_ == other.offset_) {
+        return true;  // Same storage
+    }
+    return std::equal(begin(), end(), other.begin());
+}
+
+PersistentVector::const_iterator::const_iterator(const PersistentVector* vec, size_t index)
+    : vec_(vec)
+    , index_(index)
+{
+    if (index_ < vec_->size()) {
+        load_leaf();
+    }
+}
+
+auto PersistentVector::const_iterator::load_leaf() -> void {
+    const size_t physical = index_ + vec_->offset_;
+    const size_t tail_offset = vec_->tail_offset();
+    const bool in_tail = physical >= tail_offset;
+    const size_t base = in_tail ? tail_offset : (physical & ~kMask);
+    const Leaf* leaf = vec_->leaf_for(physical);
+
+    const Value* values = leaf_values(leaf);
+    current_ = values + (physical - base);
+    leaf_end_ = values + (in_tail ? vec_->count_ - tail_offset : kWidth);
+}
+
+auto PersistentVector::const_iterator::operator++() -> const_iterator& {
+    ++index_;
+    if (++current_ == leaf_end_ && index_ < vec_->size()) {
+        load_leaf();
+    }
+    return *this;
+}
+
+} // namespace lucid::backend
@@ -0,0 +1,118 @@
+#include <lucid/backend/profiler.hpp>
+#include <fmt/format.h>
+#include <algorithm>
+#include <map>
+#include <numeric>
+
+namespace lucid::backend {
+
+Profiler::Profiler(ProfileOptions options)
+    : options_(options)
+    , until_sample_(options.sample_interval)
+{}
+
+auto Profiler::enter(size_t function) -> void {
+    if (function >= functions_.size()) {
+        functions_.resize(function + 1);
+        active_.resize(function + 1);
+    }
+    ++functions_[function].calls;
+    ++active_[function];
+    open_.push_back({function, options_.timing ? Clock::now() : Clock::time_point{}, {}});
+}
+
+auto Profiler::leave() -> void {
+    if (open_.empty()) {
+        return;
+    }
+    const OpenFrame frame = open_.back();
+    open_.pop_back();
+    --active_[frame.function];
+    if (!options_.timing) {
+        return;
+    }
+
+    const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - frame.start);
+    auto& totals = functions_[frame.function];
+    totals.exclusive += elapsed - frame.callees;
+    if (active_[frame.function] == 0) {
+        totals.inclusive += elapsed;
+    }
+    if (!open_.empty()) {
+        open_.back().callees += elapsed;
+    }
+}
+
+auto Profiler::replace(size_t function) -> void {
+    leave();
+    enter(function);
+}
+
+auto Profiler::unwind(size_t depth) -> void {
+    while (open_.size() > depth) {
+        leave();
+    }
+}
+
+auto Profiler::add_sample(const std::string& stack) -> void {
+    ++samples_[stack];
+    ++sample_count_;
+}
+
+auto Profiler::report(const Bytecode& bytecode, size_t limit) const -> std::string {
+    std::vector<size_t> order(functions_.size());
+    std::iota(order.begin(), order.end(), size_t{0});
+    std::erase_if(order, [&](size_t index) { return functions_[index].calls == 0; });
+    std::sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) {
+        if (functions_[lhs].exclusive != functions_[rhs].exclusive) {
+            return functions_[lhs].exclusive > functions_[rhs].exclusive;
+        }
+        return functions_[lhs].calls > functions_[rhs].calls;
+    });
+
+    auto ms = [](std::chrono::nanoseconds time) {
+        return std::chrono::duration<double, std::milli>(time).count();
+    };
+
+    std::string result = "=== Functions ===\n";
+    result += fmt::format("{:>12}  {:>14}  {:>14}  {}\n", "calls", "inclusive ms", "exclusive ms", "function");
+    for (size_t i = 0; i < order.size() && i < limit; ++i) {
+        const auto& totals = functions_[order[i]];
+        const auto& name = order[i] < bytecode.functions.size()
+            ? bytecode.functions[order[i]].name
+            : std::string("?");
+        result += fmt::format("{:>12}  {:>14.3f}  {:>14.3f}  {}\n",
+                              totals.calls, ms(totals.inclusive), ms(totals.exclusive), name);
+    }
+
+    std::vector<std::pair<uint64_t, size_t>> opcodes;
+    uint64_t total = 0;
+    for (size_t opcode = 0; opcode < kOpCodeCount; ++opcode) {
+        if (opcodes_[opcode] > 0) {
+            opcodes.emplace_back(opcodes_[opcode], opcode);
+            total += opcodes_[opcode];
+        }
+    }
+    std::sort(opcodes.begin(), opcodes.end(), std::greater<>());
+
+    result += fmt::format("=== Opcodes ({} total) ===\n", total);
+    for (size_t i = 0; i < opcodes.size() && i < limit; ++i) {
+        const auto& [count, opcode] = opcodes[i];
+        result += fmt::format("{:>12}  {:5.1f}%  {}\n",
+                              count, 100.0 * static_cast<double>(count) / static_cast<double>(total),
+                              opcode_name(static_cast<OpCode>(opcode)));
+    }
+    return result;
+}
+
+auto Profiler::folded_stacks() const -> std::string {
+    // Sorted, so the same run always writes the same file
+    std::map<std::string_view, uint64_t> sorted(samples_.begin(), samples_.end());
+    std::string result;
+    for (const auto& [stack, count] : sorted) {
+        result += fmt::format("{} {}\n", stack, count);
+    }
+    return result;
+}
+
+} // namespace lucid::backend
@@ -0,0 +1,141 @@
+#include <lucid/backend/thread_pool.hpp>
+#include <algorithm>
+#include <utility>
+
+namespace lucid::backend {
+
+ThreadPool::ThreadPool(size_t threads) {
+    if (threads == 0) {
+        threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    }
+    for (size_t i = 0; i < threads; ++i) {
+        queues_.push_back(std::make_unique<Queue>());
+    }
+    for (size_t i = 1; i < threads; ++i) {
+        threads_.emplace_back([this, i] { worker_loop(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+auto ThreadPool::parallel_for(size_t count, const std::function<void(size_t)>& task) -> void {
+    if (count == 0) {
+        return;
+    }
+
+    // Contiguous runs keep neighbouring indices on one thread until stolen
+    size_t workers = queues_.size();
+    for (size_t q = 0; q < workers; ++q) {
+        std::lock_guard lock(queues_[q]->mutex);
+        for (size_t i = q * count / workers; i < (q + 1) * count / workers; ++i) {
+            queues_[q]->indices.push_back(i);
+        }
+    }
+
+    {
+        std::lock_guard lock(mutex_);
+        task_ = &task;
+        error_ = nullptr;
+        remaining_.store(count);
+        generation_++;
+    }
+    wake_.notify_all();
+
+    run_tasks(0, task);
+
+    std::exception_ptr error;
+    {
+        std::unique_lock lock(mutex_);
+        // Workers still inside the job may hold `task`; wait them out too
+        done_.wait(lock, [this] { return remaining_.load() == 0 && active_ == 0; });
+        task_ = nullptr;
+        error = std::exchange(error_, nullptr);
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+auto ThreadPool::worker_loop(size_t queue) -> void {
+    uint64_t seen = 0;
+    while (true) {
+        const std::function<void(size_t)>* task = nullptr;
+        {
+            std::unique_lock lock(mutex_);
+            wake_.wait(lock, [&] { return stopping_ || generation_ != seen; });
+            if (stopping_) {
+                return;
+            }
+            seen = generation_;
+            // A worker waking after the job ended has nothing to join
+            if (remaining_.load() == 0) {
+                continue;
+            }
+            task = task_;
+            active_++;
+        }
+
+        run_tasks(queue, *task);
+
+        {
+            std::lock_guard lock(mutex_);
+            active_--;
+        }
+        done_.notify_all();
+    }
+}
+
+auto ThreadPool::run_tasks(size_t queue, const std::function<void(size_t)>& task) -> void {
+    size_t index = 0;
+    while (next_index(queue, index)) {
+        try {
+            task(index);
+        } catch (...) {
+            std::lock_guard lock(mutex_);
+            if (!error_) {
+                error_ = std::current_exception();
+            }
+        }
+        if (remaining_.fetch_sub(1) == 1) {
+            std::lock_guard lock(mutex_);
+            done_.notify_all();
+        }
+    }
+}
+
+auto ThreadPool::next_index(size_t queue, size_t& index) -> bool {
+    // Own run first, from the front
+    {
+        auto& own = *queues_[queue];
+        std::lock_guard lock(own.mutex);
+        if (!own.indices.empty()) {
+            index = own.indices.front();
+            own.indices.pop_front();
+            return true;
+        }
+    }
+
+    // Then steal from the back of the others, starting with the neighbour
+    size_t workers = queues_.size();
+    for (size_t offset = 1; offset < workers; ++offset) {
+        auto& victim = *queues_[(queue + offset) % workers];
+        std::lock_guard lock(victim.mutex);
+        if (!victim.indices.empty()) {
+            index = victim.indices.back();
+            victim.indices.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace lucid::backend
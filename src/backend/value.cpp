@@ -1,206 +1,330 @@
 #include <lucid/backend/value.hpp>
+#include <lucid/backend/file_io.hpp>
 #include <fmt/format.h>
 #include <stdexcept>
 #include <algorithm>
+#include <cstddef>
+#include <cstring>
 
 namespace lucid::backend {
 
-// Default constructor
-Value::Value() : type_(ValueType::Int), int_val(0) {}
+// ===== Strings =====
 
-// Int constructor
-Value::Value(int64_t value) : type_(ValueType::Int), int_val(value) {}
+StringObject::StringObject(std::shared_ptr<const MappedFile> file)
+    : mapping(std::move(file))
+    , length(mapping->text().size())
+{}
 
-// Float constructor
-Value::Value(double value) : type_(ValueType::Float), float_val(value) {}
+auto StringObject::text() const -> std::string_view {
+    if (mapping) {
+        return mapping->text();
+    }
+    if (is_rope()) {
+        std::string flat;
+        flat.reserve(length);
+        append_to(flat);
+        value = std::move(flat);
+        for (StringObject* half : {left, right}) {
+            if (--half->refcount == 0) {
+                destroy(half);
+            }
+        }
+        left = nullptr;
+        right = nullptr;
+    }
+    return value;
+}
 
-// Bool constructor
-Value::Value(bool value) : type_(ValueType::Bool), bool_val(value) {}
+auto StringObject::own() -> std::string& {
+    if (mapping) {
+        value.assign(mapping->text());
+        mapping.reset();
+    }
+    text();
+    return value;
+}
 
-// String constructor
-Value::Value(std::string value) : type_(ValueType::String) {
-    string_val = new std::string(std::move(value));
+auto StringObject::append_to(std::string& out) const -> void {
+    if (mapping) {
+        out += mapping->text();
+        return;
+    }
+    if (!is_rope()) {
+        out += value;
+        return;
+    }
+    std::vector<const StringObject*> pending{this};
+    while (!pending.empty()) {
+        const StringObject* node = pending.back();
+        pending.pop_back();
+        if (node->is_rope()) {
+            pending.push_back(node->right);
+            pending.push_back(node->left);
+        } else {
+            node->append_to(out);  // A flat or mapped leaf
+        }
+    }
 }
 
-// List/Tuple constructor
-Value::Value(std::vector<Value> elements, bool is_tuple) {
-    if (is_tuple) {
-        type_ = ValueType::Tuple;
-        tuple_val = new std::vector<Value>(std::move(elements));
-    } else {
-        type_ = ValueType::List;
-        list_val = new std::vector<Value>(std::move(elements));
+auto StringObject::destroy(StringObject* object) -> void {
+    std::vector<StringObject*> pending;
+    for (;;) {
+        if (object->is_rope()) {
+            for (StringObject* half : {object->left, object->right}) {
+                if (--half->refcount == 0) {
+                    pending.push_back(half);
+                }
+            }
+        }
+        delete object;
+        if (pending.empty()) {
+            return;
+        }
+        object = pending.back();
+        pending.pop_back();
     }
 }
 
-// Function value constructor
-auto Value::make_function(size_t function_index, std::string name) -> Value {
-    Value val;
-    val.type_ = ValueType::Function;
-    val.function_val.index = function_index;
-    val.function_val.name = new std::string(std::move(name));
-    return val;
+// String constructor
+Value::Value(std::string value) : type_(ValueType::String) {
+#if LUCID_COMPACT_VALUE
+    static_assert(offsetof(Value, small_head_) == kSmallStringOffset);
+    static_assert(offsetof(Value, int_val) + sizeof(int_val) ==
+                  kSmallStringOffset + kSmallStringCapacity);
+    if (value.size() <= kSmallStringCapacity) {
+        small_len_ = static_cast<uint8_t>(value.size());
+        std::memcpy(small_data(), value.data(), value.size());
+        return;
+    }
+#endif
+    heap_ = new StringObject(std::move(value));
 }
 
-// Destructor
-Value::~Value() {
-    clear();
+auto Value::concat(const Value& a, const Value& b) -> Value {
+    const size_t length = a.string_length() + b.string_length();
+    if (length == a.string_length()) {
+        return a;
+    }
+    if (length == b.string_length()) {
+        return b;
+    }
+    if (length <= kFlatConcatLength) {
+        std::string text;
+        text.reserve(length);
+        text += a.string_data();
+        text += b.string_data();
+        return Value(std::move(text));
+    }
+
+    Value result;
+    result.type_ = ValueType::String;
+#if LUCID_COMPACT_VALUE
+    result.small_len_ = kHeapString;
+#endif
+    result.heap_ = new StringObject(a.string_object(), b.string_object());
+    return result;
 }
 
-// Copy constructor
-Value::Value(const Value& other) : type_(other.type_) {
-    copy_from(other);
+auto Value::from_mapping(std::shared_ptr<const MappedFile> file) -> Value {
+    Value result;
+    result.type_ = ValueType::String;
+#if LUCID_COMPACT_VALUE
+    result.small_len_ = kHeapString;
+#endif
+    result.heap_ = new StringObject(std::move(file));
+    return result;
 }
 
-// Move constructor
-Value::Value(Value&& other) noexcept : type_(other.type_) {
-    // Move the union data
-    switch (type_) {
-        case ValueType::Int:
-            int_val = other.int_val;
-            break;
-        case ValueType::Float:
-            float_val = other.float_val;
-            break;
-        case ValueType::Bool:
-            bool_val = other.bool_val;
-            break;
-        case ValueType::String:
-            string_val = other.string_val;
-            other.string_val = nullptr;
-            break;
-        case ValueType::List:
-            list_val = other.list_val;
-            other.list_val = nullptr;
-            break;
-        case ValueType::Tuple:
-            tuple_val = other.tuple_val;
-            other.tuple_val = nullptr;
-            break;
-        case ValueType::Function:
-            function_val = other.function_val;
-            other.function_val.name = nullptr;
-            break;
+// List/Tuple constructor
+Value::Value(std::vector<Value> elements, bool is_tuple)
+    : type_(is_tuple ? ValueType::Tuple : ValueType::List)
+{
+    if (is_tuple) {
+        heap_ = new ArrayObject(std::move(elements));
+    } else {
+        heap_ = new ListObject(PersistentVector(std::move(elements)));
     }
 }
 
-// Copy assignment
-auto Value::operator=(const Value& other) -> Value& {
-    if (this != &other) {
-        clear();
-        type_ = other.type_;
-        copy_from(other);
-    }
-    return *this;
-}
-
-// Move assignment
-auto Value::operator=(Value&& other) noexcept -> Value& {
-    if (this != &other) {
-        clear();
-        type_ = other.type_;
-
-        switch (type_) {
-            case ValueType::Int:
-                int_val = other.int_val;
-                break;
-            case ValueType::Float:
-                float_val = other.float_val;
-                break;
-            case ValueType::Bool:
-                bool_val = other.bool_val;
-                break;
-            case ValueType::String:
-                string_val = other.string_val;
-                other.string_val = nullptr;
-                break;
-            case ValueType::List:
-                list_val = other.list_val;
-                other.list_val = nullptr;
-                break;
-            case ValueType::Tuple:
-                tuple_val = other.tuple_val;
-                other.tuple_val = nullptr;
-                break;
-            case ValueType::Function:
-                function_val = other.function_val;
-                other.function_val.name = nullptr;
-                break;
-        }
-    }
-    return *this;
+// List constructor from an existing persistent vector
+Value::Value(PersistentVector elements) : type_(ValueType::List) {
+    heap_ = new ListObject(std::move(elements));
 }
 
-// Type conversions
-auto Value::as_int() const -> int64_t {
-    if (type_ != ValueType::Int) {
-        throw std::runtime_error(fmt::format("Expected Int, got {}", type_name()));
-    }
-    return int_val;
+// Function value constructor
+auto Value::make_function(size_t function_index, std::string name) -> Value {
+    return make_closure(function_index, std::move(name), {});
 }
 
-auto Value::as_float() const -> double {
-    if (type_ != ValueType::Float) {
-        throw std::runtime_error(fmt::format("Expected Float, got {}", type_name()));
-    }
-    return float_val;
+auto Value::make_closure(size_t function_index, std::string name, std::vector<Value> captures) -> Value {
+    Value val;
+    val.type_ = ValueType::Function;
+    val.heap_ = new FunctionObject(function_index, std::move(name), std::move(captures));
+    return val;
+}
+
+// Type conversions
+auto Value::type_error(std::string_view expected) const -> void {
+    throw std::runtime_error(fmt::format("Expected {}, got {}", expected, type_name()));
 }
 
-auto Value::as_bool() const -> bool {
-    if (type_ != ValueType::Bool) {
-        throw std::runtime_error(fmt::format("Expected Bool, got {}", type_name()));
+auto Value::as_string() const -> std::string_view {
+    if (type_ != ValueType::String) {
+        throw std::runtime_error(fmt::format("Expected String, got {}", type_name()));
     }
-    return bool_val;
+    return string_data();
 }
 
-auto Value::as_string() const -> const std::string& {
+auto Value::string_length() const -> size_t {
     if (type_ != ValueType::String) {
         throw std::runtime_error(fmt::format("Expected String, got {}", type_name()));
     }
-    return *string_val;
+#if LUCID_COMPACT_VALUE
+    if (small_len_ != kHeapString) {
+        return small_len_;
+    }
+#endif
+    return static_cast<StringObject*>(heap_)->length;
 }
 
-auto Value::as_list() const -> const std::vector<Value>& {
+auto Value::as_list() const -> const PersistentVector& {
     if (type_ != ValueType::List) {
         throw std::runtime_error(fmt::format("Expected List, got {}", type_name()));
     }
-    return *list_val;
+    return list();
 }
 
 auto Value::as_tuple() const -> const std::vector<Value>& {
     if (type_ != ValueType::Tuple) {
         throw std::runtime_error(fmt::format("Expected Tuple, got {}", type_name()));
     }
-    return *tuple_val;
+    return tuple();
 }
 
 auto Value::as_function_index() const -> size_t {
     if (type_ != ValueType::Function) {
         throw std::runtime_error(fmt::format("Expected Function, got {}", type_name()));
     }
-    return function_val.index;
+    return static_cast<FunctionObject*>(heap_)->index;
+}
+
+auto Value::as_function_name() const -> std::string_view {
+    if (type_ != ValueType::Function) {
+        throw std::runtime_error(fmt::format("Expected Function, got {}", type_name()));
+    }
+    return static_cast<FunctionObject*>(heap_)->name;
 }
 
-auto Value::as_function_name() const -> const std::string& {
+auto Value::as_captures() const -> std::span<const Value> {
     if (type_ != ValueType::Function) {
         throw std::runtime_error(fmt::format("Expected Function, got {}", type_name()));
     }
-    return *function_val.name;
+    return static_cast<FunctionObject*>(heap_)->captures;
+}
+
+auto Value::deep_copy() const -> Value {
+    if (!owns_heap()) {
+        return *this;
+    }
+    switch (type_) {
+        case ValueType::String: {
+            // Must not flatten: other threads may be copying the same rope
+            std::string text;
+            static_cast<const StringObject*>(heap_)->append_to(text);
+            return Value(std::move(text));
+        }
+        case ValueType::List: {
+            PersistentVector elements;
+            for (const auto& element : list()) {
+                elements.push_back(element.deep_copy());
+            }
+            return Value(std::move(elements));
+        }
+        case ValueType::Tuple: {
+            std::vector<Value> elements;
+            elements.reserve(tuple().size());
+            for (const auto& element : tuple()) {
+                elements.push_back(element.deep_copy());
+            }
+            return Value(std::move(elements), true);
+        }
+        case ValueType::Function: {
+            const auto* function = static_cast<const FunctionObject*>(heap_);
+            std::vector<Value> captures;
+            captures.reserve(function->captures.size());
+            for (const auto& capture : function->captures) {
+                captures.push_back(capture.deep_copy());
+            }
+            return make_closure(function->index, function->name, std::move(captures));
+        }
+        default:
+            return *this;
+    }
+}
+
+auto Value::shares_heap() const -> bool {
+    if (!owns_heap()) {
+        return false;
+    }
+    if (heap_->refcount != 1) {
+        return true;
+    }
+    switch (type_) {
+        case ValueType::String:
+            return static_cast<const StringObject*>(heap_)->is_rope();  // Its halves may be shared
+        case ValueType::List:
+            return list().shares_storage() ||
+                   std::any_of(list().begin(), list().end(),
+                               [](const Value& v) { return v.shares_heap(); });
+        case ValueType::Tuple:
+            return std::ranges::any_of(tuple(), [](const Value& v) { return v.shares_heap(); });
+        case ValueType::Function:
+            return std::ranges::any_of(static_cast<const FunctionObject*>(heap_)->captures,
+                                       [](const Value& v) { return v.shares_heap(); });
+        default:
+            return false;
+    }
+}
+
+auto Value::is_small_string() const -> bool {
+#if LUCID_COMPACT_VALUE
+    return type_ == ValueType::String && small_len_ != kHeapString;
+#else
+    return false;
+#endif
 }
 
 // Mutable accessors
-auto Value::as_list_mut() -> std::vector<Value>& {
+auto Value::as_list_mut() -> PersistentVector& {
     if (type_ != ValueType::List) {
         throw std::runtime_error(fmt::format("Expected List, got {}", type_name()));
     }
-    return *list_val;
+    make_unique_heap();
+    return static_cast<ListObject*>(heap_)->elements;
 }
 
 auto Value::as_tuple_mut() -> std::vector<Value>& {
     if (type_ != ValueType::Tuple) {
         throw std::runtime_error(fmt::format("Expected Tuple, got {}", type_name()));
     }
-    return *tuple_val;
+    make_unique_heap();
+    return static_cast<ArrayObject*>(heap_)->elements;
+}
+
+auto Value::as_string_mut() -> std::string& {
+    if (type_ != ValueType::String) {
+        throw std::runtime_error(fmt::format("Expected String, got {}", type_name()));
+    }
+#if LUCID_COMPACT_VALUE
+    if (small_len_ != kHeapString) {
+        // Promote the inline string so it can be edited through std::string
+        std::string promoted(string_data());
+        small_len_ = kHeapString;
+        heap_ = new StringObject(std::move(promoted));
+    }
+#endif
+    make_unique_heap();
+    return static_cast<StringObject*>(heap_)->own();
 }
 
 // Equality
@@ -217,13 +341,14 @@ auto Value::operator==(const Value& other) const -> bool {
         case ValueType::Bool:
             return bool_val == other.bool_val;
         case ValueType::String:
-            return *string_val == *other.string_val;
+            return string_data() == other.string_data();
         case ValueType::List:
-            return *list_val == *other.list_val;
+            return heap_ == other.heap_ || list() == other.list();
         case ValueType::Tuple:
-            return *tuple_val == *other.tuple_val;
+            return heap_ == other.heap_ || tuple() == other.tuple();
         case ValueType::Function:
-            return function_val.index == other.function_val.index;
+            return as_function_index() == other.as_function_index() &&
+                   std::ranges::equal(as_captures(), other.as_captures());
     }
     return false;
 }
@@ -242,7 +367,7 @@ auto Value::operator<(const Value& other) const -> bool {
         case ValueType::Float:
             return float_val < other.float_val;
         case ValueType::String:
-            return *string_val < *other.string_val;
+            return string_data() < other.string_data();
         default:
             throw std::runtime_error(
                 fmt::format("Type {} does not support ordering comparison", type_name())
@@ -260,11 +385,11 @@ auto Value::is_truthy() const -> bool {
         case ValueType::Float:
             return float_val != 0.0;
         case ValueType::String:
-            return !string_val->empty();
+            return !string_data().empty();
         case ValueType::List:
-            return !list_val->empty();
+            return !list().empty();
         case ValueType::Tuple:
-            return !tuple_val->empty();
+            return !tuple().empty();
         case ValueType::Function:
             return true;
     }
@@ -281,27 +406,30 @@ auto Value::to_string() const -> std::string {
         case ValueType::Bool:
             return bool_val ? "true" : "false";
         case ValueType::String:
-            return fmt::format("\"{}\"", *string_val);
+            return fmt::format("\"{}\"", string_data());
         case ValueType::List: {
             std::string result = "[";
-            for (size_t i = 0; i < list_val->size(); ++i) {
-                if (i > 0) result += ", ";
-                result += (*list_val)[i].to_string();
+            bool first = true;
+            for (const auto& element : list()) {
+                if (!first) result += ", ";
+                result += element.to_string();
+                first = false;
             }
             result += "]";
             return result;
         }
         case ValueType::Tuple: {
+            const auto& elements = tuple();
             std::string result = "(";
-            for (size_t i = 0; i < tuple_val->size(); ++i) {
+            for (size_t i = 0; i < elements.size(); ++i) {
                 if (i > 0) result += ", ";
-                result += (*tuple_val)[i].to_string();
+                result += elements[i].to_string();
             }
             result += ")";
             return result;
         }
         case ValueType::Function:
-            return fmt::format("<function {}>", *function_val.name);
+            return fmt::format("<function {}>", as_function_name());
     }
     return "<unknown>";
 }
@@ -320,54 +448,70 @@ auto Value::type_name() const -> std::string_view {
 }
 
 // Helper methods
-auto Value::clear() -> void {
+auto Value::string_data() const -> std::string_view {
+#if LUCID_COMPACT_VALUE
+    if (small_len_ != kHeapString) {
+        return {small_data(), small_len_};
+    }
+#endif
+    return static_cast<StringObject*>(heap_)->text();
+}
+
+auto Value::string_object() const -> StringObject* {
+    if (owns_heap()) {
+        ++heap_->refcount;
+        return static_cast<StringObject*>(heap_);
+    }
+    return new StringObject(std::string(string_data()));
+}
+
+// Free the heap object once its last reference is gone
+auto Value::destroy_heap() -> void {
     switch (type_) {
         case ValueType::String:
-            delete string_val;
-            string_val = nullptr;
+            StringObject::destroy(static_cast<StringObject*>(heap_));
             break;
         case ValueType::List:
-            delete list_val;
-            list_val = nullptr;
+            delete static_cast<ListObject*>(heap_);
             break;
         case ValueType::Tuple:
-            delete tuple_val;
-            tuple_val = nullptr;
+            delete static_cast<ArrayObject*>(heap_);
             break;
         case ValueType::Function:
-            delete function_val.name;
-            function_val.name = nullptr;
+            delete static_cast<FunctionObject*>(heap_);
             break;
         default:
             break;
     }
+    heap_ = nullptr;
 }
 
-auto Value::copy_from(const Value& other) -> void {
+// Copy-on-write: give this Value a private copy of a shared heap object
+auto Value::make_unique_heap() -> void {
+    if (is_unique()) {
+        return;
+    }
+
+    HeapObject* clone = nullptr;
     switch (type_) {
-        case ValueType::Int:
-            int_val = other.int_val;
-            break;
-        case ValueType::Float:
-            float_val = other.float_val;
-            break;
-        case ValueType::Bool:
-            bool_val = other.bool_val;
-            break;
         case ValueType::String:
-            string_val = new std::string(*other.string_val);
+            clone = new StringObject(std::string(string_data()));
             break;
         case ValueType::List:
-            list_val = new std::vector<Value>(*other.list_val);
+            clone = new ListObject(*static_cast<ListObject*>(heap_));  // O(1): shares nodes
             break;
         case ValueType::Tuple:
-            tuple_val = new std::vector<Value>(*other.tuple_val);
+            clone = new ArrayObject(*static_cast<ArrayObject*>(heap_));
             break;
         case ValueType::Function:
-            function_val.index = other.function_val.index;
-            function_val.name = new std::string(*other.function_val.name);
+            clone = new FunctionObject(*static_cast<FunctionObject*>(heap_));
             break;
+        default:
+            return;
     }
+    clone->refcount = 1;
+    --heap_->refcount;
+    heap_ = clone;
 }
 
 } // namespace lucid::backend
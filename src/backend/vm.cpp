@@ -1,25 +1,267 @@
 #include <lucid/backend/vm.hpp>
+#include <lucid/backend/builtin_methods.hpp>
+#include <lucid/backend/file_io.hpp>
+#include <lucid/backend/thread_pool.hpp>
 #include <fmt/format.h>
+#include <mutex>
 #include <stdexcept>
 #include <cmath>
 #include <algorithm>
 #include <cctype>
-#include <fstream>
 #include <filesystem>
 #include <sstream>
+#include <iterator>
 
 namespace lucid::backend {
 
+// Worker VMs for the par_* list methods, one per pool thread, so a task
+// always finds one idle
+struct VM::ParallelRuntime {
+    explicit ParallelRuntime(size_t threads) : pool(threads) {
+        for (size_t i = 0; i < pool.size(); ++i) {
+            auto worker = std::make_unique<VM>();
+            worker->is_worker_ = true;
+            worker->use_output_buffer();
+            idle.push_back(std::move(worker));
+        }
+    }
+
+    auto acquire() -> std::unique_ptr<VM> {
+        std::lock_guard lock(mutex);
+        auto worker = std::move(idle.back());
+        idle.pop_back();
+        return worker;
+    }
+
+    auto release(std::unique_ptr<VM> worker) -> void {
+        std::lock_guard lock(mutex);
+        idle.push_back(std::move(worker));
+    }
+
+    ThreadPool pool;
+    std::mutex mutex;  // Guards idle
+    std::vector<std::unique_ptr<VM>> idle;
+};
+
 // Constructor
-VM::VM() : bytecode_(nullptr) {}
+VM::VM()
+    : bytecode_(nullptr)
+    , dispatch_mode_(threaded_dispatch_available() ? DispatchMode::Threaded : DispatchMode::Switch)
+{
+    // The dispatch loop keeps a raw pointer into stack_, so it must never
+    // reallocate; reserving both up front also keeps calls allocation-free
+    stack_.reserve(kStackCapacity);
+    call_stack_.reserve(kMaxCallDepth);
+}
+
+VM::~VM() = default;
+
+auto VM::set_parallelism(size_t threshold, size_t threads) -> void {
+    parallel_threshold_ = threshold;
+    if (threads != parallel_threads_) {
+        parallel_threads_ = threads;
+        parallel_.reset();
+    }
+}
+
+auto VM::set_memoized(std::vector<std::string> functions, size_t capacity) -> void {
+    memo_names_ = std::move(functions);
+    memo_capacity_ = capacity;
+    memo_bytecode_ = nullptr;
+    memo_.clear();
+}
 
 // Main entry point - call a function by name
 auto VM::call_function(const Bytecode& bytecode,
                       const std::string& function_name,
                       std::vector<Value> args) -> Value {
     bytecode_ = &bytecode;
+    constants_ = bytecode.constants.data();
+    memo_bytecode_ = nullptr;  // May be a new program at the same address
+
+    // Method names are resolved lazily, the first time each is called
+    method_cache_.assign(bytecode.constants.size(), kUnresolvedMethod);
+
+    return execute(function_name, std::move(args));
+}
+
+auto VM::load(std::shared_ptr<const Bytecode> program) -> void {
+    if (!program) {
+        throw std::runtime_error("Cannot load a null program");
+    }
+    program_ = std::move(program);
+
+    // Copying a constant bumps its refcount, which other threads' VMs would
+    // race on; this VM pushes copies of its own instead
+    program_constants_.clear();
+    program_constants_.reserve(program_->constants.size());
+    for (const auto& constant : program_->constants) {
+        program_constants_.push_back(constant.deep_copy());
+    }
+
+    bytecode_ = program_.get();
+    method_cache_.assign(program_->constants.size(), kUnresolvedMethod);
+    memo_bytecode_ = nullptr;
+}
+
+auto VM::call(const std::string& function_name, std::vector<Value> args) -> Value {
+    use_program();
+    try {
+        return detach(execute(function_name, std::move(args)));
+    } catch (...) {
+        discard_stacks();
+        throw;
+    }
+}
+
+auto VM::function(const Bytecode& program, const std::string& function_name) -> FunctionHandle {
+    int func_idx = program.find_function(function_name);
+    if (func_idx < 0) {
+        throw std::runtime_error(fmt::format("Function '{}' not found", function_name));
+    }
+    const auto index = static_cast<size_t>(func_idx);
+    return FunctionHandle{&program, index, program.functions[index].param_count};
+}
+
+auto VM::function(const std::string& function_name) const -> FunctionHandle {
+    if (!program_) {
+        throw std::runtime_error("No program loaded");
+    }
+    return function(*program_, function_name);
+}
+
+auto VM::call(FunctionHandle function, std::span<const Value> args) -> Value {
+    use_program(function);
+    if (args.size() != function.param_count) {
+        throw std::runtime_error(fmt::format(
+            "Function '{}' expects {} arguments, got {}",
+            program_->functions[function.index].name, function.param_count, args.size()
+        ));
+    }
+    reset_execution();
+
+    try {
+        for (const auto& arg : args) {
+            push(arg);
+        }
+        Value result = detach(invoke(function.index, args.size()));
+        finish_call();
+        return result;
+    } catch (...) {
+        discard_stacks();
+        finish_call();
+        throw;
+    }
+}
+
+auto VM::call_batch(FunctionHandle function, std::span<const Value> args) -> std::vector<Value> {
+    use_program(function);
+    const size_t arity = function.param_count;
+    if (arity == 0 ? !args.empty() : args.size() % arity != 0) {
+        throw std::runtime_error(fmt::format(
+            "Function '{}' expects {} arguments per call, got {} in total",
+            program_->functions[function.index].name, arity, args.size()
+        ));
+    }
+    reset_execution();
+
+    // A function without parameters has nothing to batch over
+    const size_t calls = arity == 0 ? 0 : args.size() / arity;
+    std::vector<Value> results;
+    results.reserve(calls);
+    try {
+        for (size_t call = 0; call < calls; ++call) {
+            for (const auto& arg : args.subspan(call * arity, arity)) {
+                push(arg);
+            }
+            results.push_back(detach(invoke(function.index, arity)));
+        }
+    } catch (...) {
+        discard_stacks();
+        finish_call();
+        throw;
+    }
+    finish_call();
+    return results;
+}
+
+auto VM::use_program() -> void {
+    if (!program_) {
+        throw std::runtime_error("No program loaded");
+    }
+    // Method ids resolved by earlier calls stay valid unless call_function
+    // ran something else in between
+    if (bytecode_ != program_.get()) {
+        bytecode_ = program_.get();
+        method_cache_.assign(program_->constants.size(), kUnresolvedMethod);
+    }
+    constants_ = program_constants_.data();
+}
+
+auto VM::use_program(const FunctionHandle& function) -> void {
+    use_program();
+    if (function.program != program_.get() || function.index >= program_->functions.size()) {
+        throw std::runtime_error("Function handle does not belong to the loaded program");
+    }
+}
+
+auto VM::discard_stacks() -> void {
     stack_.clear();
     call_stack_.clear();
+    return_depth_ = 0;
+}
+
+auto VM::reset_execution() -> void {
+    discard_stacks();
+    ++generation_;
+
+    // Hotness counters, native code and memoized results last for this one call
+    jit_.reset();
+    if (jit_threshold_ > 0 && !profiler_ && memo_names_.empty()) {
+        jit_ = std::make_unique<Jit>(*bytecode_, jit_threshold_, jit_stats_);
+    }
+    if (!memo_names_.empty()) {
+        reset_memo();
+    }
+}
+
+auto VM::reset_memo() -> void {
+    if (memo_bytecode_ == bytecode_) {
+        for (auto& table : memo_) {
+            if (table) {
+                table->clear();
+            }
+        }
+        return;
+    }
+
+    memo_.clear();
+    const auto effects = find_effects(*bytecode_);
+    std::vector<std::unique_ptr<MemoTable>> tables(bytecode_->functions.size());
+    for (const auto& name : memo_names_) {
+        const int func_idx = bytecode_->find_function(name);
+        if (func_idx < 0) {
+            throw std::runtime_error(fmt::format("Cannot memoize '{}': no such function", name));
+        }
+        const auto index = static_cast<size_t>(func_idx);
+        if (!effects[index].empty()) {
+            throw std::runtime_error(fmt::format("Cannot memoize '{}': it can call {}", name, effects[index]));
+        }
+        tables[index] = std::make_unique<MemoTable>(memo_capacity_);
+    }
+    memo_ = std::move(tables);
+    memo_bytecode_ = bytecode_;
+}
+
+auto VM::detach(Value result) const -> Value {
+    if (constants_ != program_constants_.data() || !result.shares_heap()) {
+        return result;
+    }
+    return result.deep_copy();
+}
+
+auto VM::execute(const std::string& function_name, std::vector<Value> args) -> Value {
+    const Bytecode& bytecode = *bytecode_;
 
     // Find function by name
     int func_idx = bytecode.find_function(function_name);
@@ -37,23 +279,22 @@ auto VM::call_function(const Bytecode& bytecode,
         ));
     }
 
-    // Create initial call frame
-    CallFrame frame(
-        static_cast<size_t>(func_idx),
-        func_info.offset,
-        0,  // stack_base
-        func_info.local_count
-    );
+    reset_execution();
 
-    // Initialize parameters (first N locals) from arguments
-    for (size_t i = 0; i < args.size(); ++i) {
-        frame.locals[i] = std::move(args[i]);
+    // Arguments become the first locals of the entry frame
+    for (auto& arg : args) {
+        push(std::move(arg));
     }
-
-    call_stack_.push_back(std::move(frame));
+    enter_frame(static_cast<size_t>(func_idx), args.size());
 
     // Execute
-    run();
+    try {
+        run();
+    } catch (...) {
+        finish_call();
+        throw;
+    }
+    finish_call();
 
     // Return value should be on stack
     if (stack_.empty()) {
@@ -63,515 +304,1389 @@ auto VM::call_function(const Bytecode& bytecode,
     return pop();
 }
 
+// ===== Dispatch =====
+//
+// The interpreter loop is written once as a sequence of labelled opcode
+// bodies. Two dispatch strategies jump between them:
+//
+//   * Threaded (GCC/Clang computed goto): every body ends with an indirect
+//     jump through a label table, giving the branch predictor one dispatch
+//     site per opcode.
+//   * Switch: every body jumps back to a single `switch`, the portable
+//     fallback used when computed goto is unavailable or disabled.
+//
+// In both modes the instruction pointer, the current frame's locals and the
+// constant pool live in locals of run_dispatch() and are only written back
+// to the CallFrame on CALL and RETURN.
+//
+// A computed goto does not run destructors for objects that go out of scope,
+// so every body that declares a Value closes its block before DISPATCH().
+
+#if defined(LUCID_THREADED_DISPATCH) && (defined(__GNUC__) || defined(__clang__))
+#define LUCID_HAS_COMPUTED_GOTO 1
+#else
+#define LUCID_HAS_COMPUTED_GOTO 0
+#endif
+
+// Every opcode, in OpCode declaration order. Used to build the label table
+// and the fallback switch so the two cannot drift apart.
+#define LUCID_VM_OPCODES(X) \
+    X(CONSTANT) X(TRUE) X(FALSE) \
+    X(LOAD_LOCAL) X(STORE_LOCAL) X(LOAD_GLOBAL) \
+    X(ADD) X(SUB) X(MUL) X(DIV) X(MOD) X(POW) \
+    X(EQ) X(NE) X(LT) X(GT) X(LE) X(GE) \
+    X(AND) X(OR) X(NOT) \
+    X(NEGATE) X(POSITIVE) \
+    X(ADD_INT) X(SUB_INT) X(MUL_INT) X(DIV_INT) X(MOD_INT) \
+    X(ADD_FLOAT) X(SUB_FLOAT) X(MUL_FLOAT) X(DIV_FLOAT) \
+    X(EQ_INT) X(NE_INT) X(LT_INT) X(GT_INT) X(LE_INT) X(GE_INT) \
+    X(LT_FLOAT) X(GT_FLOAT) X(LE_FLOAT) X(GE_FLOAT) \
+    X(BUILD_LIST) X(BUILD_TUPLE) X(UNPACK_TUPLE) X(INDEX) X(CALL_METHOD) X(CALL_BUILTIN) \
+    X(JUMP) X(JUMP_IF_FALSE) X(JUMP_IF_TRUE) \
+    X(CALL) X(RETURN) X(RETURN_TUPLE) X(TAIL_CALL) X(MAKE_CLOSURE) X(CALL_VALUE) \
+    X(POP) X(DUP) \
+    X(LOAD_LOCAL2) X(LOAD_LOCAL_CONST) X(POP_JUMP_IF_FALSE) X(COMPARE_JUMP_IF_FALSE) \
+    X(HALT)
+
+namespace {
+
+#define LUCID_VM_OPCODE_ENTRY(name) OpCode::name,
+constexpr OpCode kDispatchOrder[] = { LUCID_VM_OPCODES(LUCID_VM_OPCODE_ENTRY) };
+#undef LUCID_VM_OPCODE_ENTRY
+
+constexpr auto dispatch_order_matches_enum() -> bool {
+    for (size_t i = 0; i < std::size(kDispatchOrder); ++i) {
+        if (static_cast<size_t>(kDispatchOrder[i]) != i) {
+            return false;
+        }
+    }
+    return std::size(kDispatchOrder) == static_cast<size_t>(OpCode::HALT) + 1;
+}
+
+static_assert(dispatch_order_matches_enum(),
+              "LUCID_VM_OPCODES must list every OpCode in declaration order");
+
+} // namespace
+
+auto VM::threaded_dispatch_available() -> bool {
+    return LUCID_HAS_COMPUTED_GOTO != 0;
+}
+
+auto VM::set_dispatch_mode(DispatchMode mode) -> void {
+    if (mode == DispatchMode::Threaded && !threaded_dispatch_available()) {
+        throw std::runtime_error("Threaded dispatch is not available in this build");
+    }
+    dispatch_mode_ = mode;
+}
+
+auto VM::set_opcode_pair_profiling(bool enabled) -> void {
+    opcode_pairs_.assign(enabled ? kOpCodeCount * kOpCodeCount : 0, 0);
+}
+
+auto VM::profiling_available() -> bool {
+#ifdef LUCID_PROFILER
+    return true;
+#else
+    return false;
+#endif
+}
+
+auto VM::enable_profiling(ProfileOptions options) -> void {
+    if (!profiling_available()) {
+        throw std::runtime_error("Profiling is not available in this build");
+    }
+    profiler_ = std::make_unique<Profiler>(options);
+}
+
+auto VM::set_jit_threshold(uint32_t threshold) -> void {
+    if (threshold > 0 && !jit_available()) {
+        throw std::runtime_error("JIT is not available in this build");
+    }
+    jit_threshold_ = threshold;
+}
+
 // Main execution loop
 auto VM::run() -> void {
-    while (true) {
-        uint8_t opcode_byte = read_byte();
-        OpCode opcode = static_cast<OpCode>(opcode_byte);
-
-        switch (opcode) {
-            // === Literals ===
-            case OpCode::CONSTANT: {
-                uint16_t idx = read_uint16();
-                push(bytecode_->constants[idx]);
-                break;
+#ifdef LUCID_PROFILER
+    if (profiler_) [[unlikely]] {
+        // Close the frames an error or HALT leaves open
+        const size_t depth = profiler_->depth();
+        try {
+            run_dispatch<false, true>();
+        } catch (...) {
+            profiler_->unwind(depth);
+            throw;
+        }
+        profiler_->unwind(depth);
+        return;
+    }
+#endif
+#if LUCID_HAS_COMPUTED_GOTO
+    // Pair profiling is only wired into the switch loop
+    if (dispatch_mode_ == DispatchMode::Threaded && opcode_pairs_.empty()) {
+        run_dispatch<true, false>();
+        return;
+    }
+#endif
+    run_dispatch<false, false>();
+}
+
+#if LUCID_HAS_COMPUTED_GOTO
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"      // labels as values
+#pragma GCC diagnostic ignored "-Wunused-label"  // dispatch_switch is dead in threaded mode
+#endif
+
+template <bool Threaded, bool Profiled>
+auto VM::run_dispatch() -> void {
+    const uint8_t* const code = bytecode_->code().data();  // May be a mapped file
+    const Value* const constants = constants_;
+    const uint8_t* ip = code + current_frame().instruction_pointer;
+    Value* locals = stack_.data() + current_frame().stack_base;
+    uint64_t executed = 0;
+    uint8_t opcode_byte = 0;
+    size_t previous_opcode = kOpCodeCount;  // For opcode pair profiling
+
+#define READ_BYTE() (*ip++)
+#define READ_UINT16() \
+    (ip += 2, static_cast<uint16_t>(static_cast<uint16_t>(ip[-2]) | (static_cast<uint16_t>(ip[-1]) << 8)))
+#define JUMP_BY(offset) (ip += (offset))
+#define SAVE_IP() (current_frame().instruction_pointer = static_cast<size_t>(ip - code))
+#define LOAD_FRAME() \
+    (ip = code + current_frame().instruction_pointer, locals = stack_.data() + current_frame().stack_base)
+
+#if LUCID_HAS_COMPUTED_GOTO
+#define LUCID_VM_LABEL_ADDRESS(name) &&op_##name,
+    static void* const dispatch_table[] = { LUCID_VM_OPCODES(LUCID_VM_LABEL_ADDRESS) };
+#undef LUCID_VM_LABEL_ADDRESS
+    static_assert(std::size(dispatch_table) == std::size(kDispatchOrder));
+#endif
+
+#if LUCID_HAS_COMPUTED_GOTO
+#define DISPATCH()                                                   \
+    do {                                                             \
+        if constexpr (Threaded) {                                    \
+            ++executed;                                              \
+            opcode_byte = *ip++;                                     \
+            if (opcode_byte >= std::size(dispatch_table)) {          \
+                goto op_unknown;                                     \
+            }                                                        \
+            goto *dispatch_table[opcode_byte];                       \
+        } else {                                                     \
+            goto dispatch_switch;                                    \
+        }                                                            \
+    } while (0)
+#else
+#define DISPATCH() goto dispatch_switch
+#endif
+
+    if constexpr (Profiled) {
+        // run() is entered right after its frame
+        profiler_->enter(current_frame().function_index);
+    }
+    DISPATCH();
+
+dispatch_switch:
+    ++executed;
+    opcode_byte = *ip++;
+    if constexpr (Profiled) {
+        profiler_->count(opcode_byte);
+        if (profiler_->tick()) {
+            profiler_->add_sample(sample_stack(static_cast<size_t>(ip - 1 - code)));
+        }
+    }
+    if (!opcode_pairs_.empty()) [[unlikely]] {
+        if (previous_opcode < kOpCodeCount && opcode_byte < kOpCodeCount) {
+            ++opcode_pairs_[previous_opcode * kOpCodeCount + opcode_byte];
+        }
+        previous_opcode = opcode_byte;
+    }
+    switch (static_cast<OpCode>(opcode_byte)) {
+#define LUCID_VM_SWITCH_CASE(name) case OpCode::name: goto op_##name;
+        LUCID_VM_OPCODES(LUCID_VM_SWITCH_CASE)
+#undef LUCID_VM_SWITCH_CASE
+        default:
+            goto op_unknown;
+    }
+
+    // === Literals ===
+op_CONSTANT: {
+        uint16_t idx = READ_UINT16();
+        push(constants[idx]);
+    }
+    DISPATCH();
+
+op_TRUE:
+    push(Value(true));
+    DISPATCH();
+
+op_FALSE:
+    push(Value(false));
+    DISPATCH();
+
+    // === Arithmetic Operations ===
+op_ADD: {
+        Value b = pop();
+        Value a = pop();
+        push(binary_add(a, b));
+    }
+    DISPATCH();
+
+op_SUB: {
+        Value b = pop();
+        Value a = pop();
+        push(binary_sub(a, b));
+    }
+    DISPATCH();
+
+op_MUL: {
+        Value b = pop();
+        Value a = pop();
+        push(binary_mul(a, b));
+    }
+    DISPATCH();
+
+op_DIV: {
+        Value b = pop();
+        Value a = pop();
+        push(binary_div(a, b));
+    }
+    DISPATCH();
+
+op_MOD: {
+        Value b = pop();
+        Value a = pop();
+        push(binary_mod(a, b));
+    }
+    DISPATCH();
+
+op_POW: {
+        Value b = pop();
+        Value a = pop();
+        push(binary_pow(a, b));
+    }
+    DISPATCH();
+
+    // === Comparison Operations ===
+op_EQ: {
+        Value b = pop();
+        Value a = pop();
+        push(binary_eq(a, b));
+    }
+    DISPATCH();
+
+op_NE: {
+        Value b = pop();
+        Value a = pop();
+        push(binary_ne(a, b));
+    }
+    DISPATCH();
+
+op_LT: {
+        Value b = pop();
+        Value a = pop();
+        push(binary_lt(a, b));
+    }
+    DISPATCH();
+
+op_GT: {
+        Value b = pop();
+        Value a = pop();
+        push(binary_gt(a, b));
+    }
+    DISPATCH();
+
+op_LE: {
+        Value b = pop();
+        Value a = pop();
+        push(binary_le(a, b));
+    }
+    DISPATCH();
+
+op_GE: {
+        Value b = pop();
+        Value a = pop();
+        push(binary_ge(a, b));
+    }
+    DISPATCH();
+
+    // === Logical Operations ===
+op_AND: {
+        Value b = pop();
+        Value a = pop();
+        push(binary_and(a, b));
+    }
+    DISPATCH();
+
+op_OR: {
+        Value b = pop();
+        Value a = pop();
+        push(binary_or(a, b));
+    }
+    DISPATCH();
+
+op_NOT: {
+        Value a = pop();
+        push(unary_not(a));
+    }
+    DISPATCH();
+
+    // === Unary Operations ===
+op_NEGATE: {
+        Value a = pop();
+        push(unary_negate(a));
+    }
+    DISPATCH();
+
+op_POSITIVE: {
+        Value a = pop();
+        push(unary_positive(a));
+    }
+    DISPATCH();
+
+    // === Type-Specialised Operations ===
+    // The compiler only emits these when both operand types are known, but
+    // the guard falls back to the generic helper (and its error messages)
+    // for anything else, so results never differ from ADD, LT and friends.
+#define TYPED_BINARY_OP(guard, fast, generic)            \
+    {                                                    \
+        if (stack_.size() < 2) {                         \
+            throw std::runtime_error("Stack underflow"); \
+        }                                                \
+        Value& b = stack_.back();                        \
+        Value& a = stack_[stack_.size() - 2];            \
+        if (guard) [[likely]] {                          \
+            a = Value(fast);                             \
+        } else {                                         \
+            a = generic(a, b);                           \
+        }                                                \
+        stack_.pop_back();                               \
+    }
+
+op_ADD_INT:
+    TYPED_BINARY_OP(a.is_int() && b.is_int(), int_add(a.as_int(), b.as_int()), binary_add)
+    DISPATCH();
+
+op_SUB_INT:
+    TYPED_BINARY_OP(a.is_int() && b.is_int(), int_sub(a.as_int(), b.as_int()), binary_sub)
+    DISPATCH();
+
+op_MUL_INT:
+    TYPED_BINARY_OP(a.is_int() && b.is_int(), int_mul(a.as_int(), b.as_int()), binary_mul)
+    DISPATCH();
+
+op_DIV_INT:
+    TYPED_BINARY_OP(a.is_int() && b.is_int() && b.as_int() != 0, int_div(a.as_int(), b.as_int()), binary_div)
+    DISPATCH();
+
+op_MOD_INT:
+    TYPED_BINARY_OP(a.is_int() && b.is_int() && b.as_int() != 0, int_mod(a.as_int(), b.as_int()), binary_mod)
+    DISPATCH();
+
+op_ADD_FLOAT:
+    TYPED_BINARY_OP(a.is_float() && b.is_float(), a.as_float() + b.as_float(), binary_add)
+    DISPATCH();
+
+op_SUB_FLOAT:
+    TYPED_BINARY_OP(a.is_float() && b.is_float(), a.as_float() - b.as_float(), binary_sub)
+    DISPATCH();
+
+op_MUL_FLOAT:
+    TYPED_BINARY_OP(a.is_float() && b.is_float(), a.as_float() * b.as_float(), binary_mul)
+    DISPATCH();
+
+op_DIV_FLOAT:
+    TYPED_BINARY_OP(a.is_float() && b.is_float() && b.as_float() != 0.0, a.as_float() / b.as_float(), binary_div)
+    DISPATCH();
+
+op_EQ_INT:
+    TYPED_BINARY_OP(a.is_int() && b.is_int(), a.as_int() == b.as_int(), binary_eq)
+    DISPATCH();
+
+op_NE_INT:
+    TYPED_BINARY_OP(a.is_int() && b.is_int(), a.as_int() != b.as_int(), binary_ne)
+    DISPATCH();
+
+op_LT_INT:
+    TYPED_BINARY_OP(a.is_int() && b.is_int(), a.as_int() < b.as_int(), binary_lt)
+    DISPATCH();
+
+op_GT_INT:
+    TYPED_BINARY_OP(a.is_int() && b.is_int(), a.as_int() > b.as_int(), binary_gt)
+    DISPATCH();
+
+op_LE_INT:
+    TYPED_BINARY_OP(a.is_int() && b.is_int(), a.as_int() <= b.as_int(), binary_le)
+    DISPATCH();
+
+op_GE_INT:
+    TYPED_BINARY_OP(a.is_int() && b.is_int(), a.as_int() >= b.as_int(), binary_ge)
+    DISPATCH();
+
+op_LT_FLOAT:
+    TYPED_BINARY_OP(a.is_float() && b.is_float(), a.as_float() < b.as_float(), binary_lt)
+    DISPATCH();
+
+op_GT_FLOAT:
+    TYPED_BINARY_OP(a.is_float() && b.is_float(), a.as_float() > b.as_float(), binary_gt)
+    DISPATCH();
+
+op_LE_FLOAT:
+    TYPED_BINARY_OP(a.is_float() && b.is_float(), a.as_float() <= b.as_float(), binary_le)
+    DISPATCH();
+
+op_GE_FLOAT:
+    TYPED_BINARY_OP(a.is_float() && b.is_float(), a.as_float() >= b.as_float(), binary_ge)
+    DISPATCH();
+
+#undef TYPED_BINARY_OP
+
+    // === Stack Operations ===
+op_POP:
+    pop();
+    DISPATCH();
+
+op_DUP:
+    push(peek());
+    DISPATCH();
+
+    // === Variables ===
+op_LOAD_LOCAL: {
+        uint16_t idx = READ_UINT16();
+        push(locals[idx]);
+    }
+    DISPATCH();
+
+op_STORE_LOCAL: {
+        uint16_t idx = READ_UINT16();
+        locals[idx] = peek();
+    }
+    DISPATCH();
+
+op_LOAD_GLOBAL: {
+        uint16_t func_idx = READ_UINT16();
+        if (func_idx >= bytecode_->functions.size()) {
+            throw std::runtime_error(fmt::format(
+                "Invalid function index: {}", func_idx
+            ));
+        }
+        push(Value::make_function(func_idx, bytecode_->functions[func_idx].name));
+    }
+    DISPATCH();
+
+    // === Function Calls ===
+op_CALL: {
+        // Read operands
+        uint16_t func_idx = READ_UINT16();
+        uint8_t arg_count = READ_BYTE();
+
+        // Validate function index
+        if (func_idx >= bytecode_->functions.size()) {
+            throw std::runtime_error(fmt::format(
+                "Invalid function index: {}", func_idx
+            ));
+        }
+
+        const auto& func_info = bytecode_->functions[func_idx];
+
+        // Validate argument count
+        if (arg_count != func_info.param_count) {
+            throw std::runtime_error(fmt::format(
+                "Function '{}' expects {} arguments, got {}",
+                func_info.name, func_info.param_count, arg_count
+            ));
+        }
+
+        if (!memo_.empty() && memo_lookup(func_idx, arg_count, true)) {
+            DISPATCH();
+        }
+        if (jit_ && jit_call(func_idx, arg_count)) {
+            DISPATCH();
+        }
+
+        // Save return address in current frame, then enter the callee.
+        // The arguments already on the stack become its first locals.
+        SAVE_IP();
+        enter_frame(func_idx, arg_count);
+        LOAD_FRAME();
+        if constexpr (Profiled) {
+            profiler_->enter(func_idx);
+        }
+    }
+    DISPATCH();
+
+op_RETURN: {
+        if constexpr (Profiled) {
+            profiler_->leave();
+        }
+        if (!memo_.empty()) {
+            memo_store(0);
+        }
+        // Return value is on top of stack; discard the callee's window
+        Value result = pop();
+        const size_t base = current_frame().stack_base;
+        stack_.erase(stack_.begin() + static_cast<std::ptrdiff_t>(base), stack_.end());
+        call_stack_.pop_back();
+        push(std::move(result));
+
+        if (call_stack_.size() == return_depth_) {
+            // Returning from the function this run() was entered for
+            instructions_executed_ += executed;
+            return;
+        }
+        // Continue execution in caller
+        LOAD_FRAME();
+    }
+    DISPATCH();
+
+op_RETURN_TUPLE: {
+        if constexpr (Profiled) {
+            profiler_->leave();
+        }
+        // The values move down over the callee's window, where the caller's
+        // pattern stores them; only a call made with CALL can have one
+        const size_t count = READ_UINT16();
+        if (stack_.size() < count) {
+            throw std::runtime_error("Stack underflow");
+        }
+        if (!memo_.empty()) {
+            memo_store(count);
+        }
+        const auto base = stack_.begin() + static_cast<std::ptrdiff_t>(current_frame().stack_base);
+        const auto values = stack_.end() - static_cast<std::ptrdiff_t>(count);
+        call_stack_.pop_back();
+
+        if (call_stack_.size() == return_depth_) {
+            // Returning to the host, which gets the tuple after all
+            std::vector<Value> elements(std::make_move_iterator(values), std::make_move_iterator(stack_.end()));
+            stack_.erase(base, stack_.end());
+            push(Value(std::move(elements), true));
+            instructions_executed_ += executed;
+            return;
+        }
+        stack_.erase(std::move(values, stack_.end(), base), stack_.end());
+        LOAD_FRAME();
+    }
+    DISPATCH();
+
+op_TAIL_CALL: {
+        uint16_t func_idx = READ_UINT16();
+        uint8_t arg_count = READ_BYTE();
+
+        if (func_idx >= bytecode_->functions.size()) {
+            throw std::runtime_error(fmt::format(
+                "Invalid function index: {}", func_idx
+            ));
+        }
+
+        const auto& func_info = bytecode_->functions[func_idx];
+        if (arg_count != func_info.param_count) {
+            throw std::runtime_error(fmt::format(
+                "Function '{}' expects {} arguments, got {}",
+                func_info.name, func_info.param_count, arg_count
+            ));
+        }
+
+        if ((!memo_.empty() && memo_lookup(func_idx, arg_count, false)) ||
+            (jit_ && jit_call(func_idx, arg_count))) {
+            goto op_RETURN;  // The callee's result is this frame's
+        }
+
+        // The callee takes over this frame: no return address to save
+        reuse_frame(func_idx, arg_count);
+        LOAD_FRAME();
+        if constexpr (Profiled) {
+            profiler_->replace(func_idx);
+        }
+    }
+    DISPATCH();
+
+op_MAKE_CLOSURE: {
+        uint16_t func_idx = READ_UINT16();
+        uint8_t capture_count = READ_BYTE();
+        if (func_idx >= bytecode_->functions.size()) {
+            throw std::runtime_error(fmt::format(
+                "Invalid function index: {}", func_idx
+            ));
+        }
+        if (stack_.size() < capture_count) {
+            throw std::runtime_error("Stack underflow");
+        }
+
+        auto first = stack_.end() - capture_count;
+        std::vector<Value> captures(std::make_move_iterator(first), std::make_move_iterator(stack_.end()));
+        stack_.erase(first, stack_.end());
+        push(Value::make_closure(func_idx, bytecode_->functions[func_idx].name, std::move(captures)));
+    }
+    DISPATCH();
+
+op_CALL_VALUE: {
+        uint8_t arg_count = READ_BYTE();
+        size_t func_idx = 0;
+        size_t total = 0;
+        {
+            Value callee = pop();
+            func_idx = push_captures(callee, arg_count);
+            total = bytecode_->functions[func_idx].param_count;
+        }
+
+        if (!memo_.empty() && memo_lookup(func_idx, total, false)) {
+            DISPATCH();
+        }
+        if (jit_ && jit_call(func_idx, total)) {
+            DISPATCH();
+        }
+
+        SAVE_IP();
+        enter_frame(func_idx, total);
+        LOAD_FRAME();
+        if constexpr (Profiled) {
+            profiler_->enter(func_idx);
+        }
+    }
+    DISPATCH();
+
+    // === Control Flow ===
+op_JUMP: {
+        // Read signed 16-bit offset
+        int16_t offset = static_cast<int16_t>(READ_UINT16());
+        JUMP_BY(offset);
+    }
+    DISPATCH();
+
+op_JUMP_IF_FALSE: {
+        // Read signed 16-bit offset
+        int16_t offset = static_cast<int16_t>(READ_UINT16());
+        const Value& condition = peek();  // Peek, don't pop
+        if (!condition.is_truthy()) {
+            JUMP_BY(offset);
+        }
+    }
+    DISPATCH();
+
+op_JUMP_IF_TRUE: {
+        // Read signed 16-bit offset
+        int16_t offset = static_cast<int16_t>(READ_UINT16());
+        const Value& condition = peek();  // Peek, don't pop
+        if (condition.is_truthy()) {
+            JUMP_BY(offset);
+        }
+    }
+    DISPATCH();
+
+    // === Collections ===
+op_BUILD_LIST: {
+        uint16_t count = READ_UINT16();
+        std::vector<Value> elements;
+        elements.reserve(count);
+
+        // Pop elements in reverse order
+        for (size_t i = 0; i < count; ++i) {
+            elements.push_back(pop());
+        }
+        // Reverse to get correct order
+        std::reverse(elements.begin(), elements.end());
+
+        push(Value(std::move(elements), false));  // false = list
+    }
+    DISPATCH();
+
+op_BUILD_TUPLE: {
+        uint16_t count = READ_UINT16();
+        std::vector<Value> elements;
+        elements.reserve(count);
+
+        // Pop elements in reverse order
+        for (size_t i = 0; i < count; ++i) {
+            elements.push_back(pop());
+        }
+        // Reverse to get correct order
+        std::reverse(elements.begin(), elements.end());
+
+        push(Value(std::move(elements), true));  // true = tuple
+    }
+    DISPATCH();
+
+op_UNPACK_TUPLE: {
+        uint16_t count = READ_UINT16();
+        Value tuple = pop();
+        if (!tuple.is_tuple() || tuple.as_tuple().size() != count) {
+            throw std::runtime_error(fmt::format(
+                "Cannot unpack {} into {} values", tuple.to_string(), count
+            ));
+        }
+        if (count > stack_.capacity() - stack_.size()) {
+            throw std::runtime_error("Stack overflow");
+        }
+        // A tuple nothing else holds gives up its elements
+        if (tuple.is_unique()) {
+            for (auto& element : tuple.as_tuple_mut()) {
+                stack_.push_back(std::move(element));
             }
+        } else {
+            for (const auto& element : tuple.as_tuple()) {
+                stack_.push_back(element);
+            }
+        }
+    }
+    DISPATCH();
 
-            case OpCode::TRUE:
-                push(Value(true));
-                break;
+op_INDEX: {
+        Value index = pop();
+        Value collection = pop();
+        push(index_value(collection, index));
+    }
+    DISPATCH();
 
-            case OpCode::FALSE:
-                push(Value(false));
-                break;
+op_CALL_METHOD: {
+        // Read operands
+        uint16_t name_idx = READ_UINT16();
+        uint8_t arg_count = READ_BYTE();
 
-            // === Arithmetic Operations ===
-            case OpCode::ADD: {
-                Value b = pop();
-                Value a = pop();
-                push(binary_add(a, b));
-                break;
+        if (name_idx >= method_cache_.size()) {
+            throw std::runtime_error(fmt::format(
+                "Invalid constant index for method name: {}", name_idx
+            ));
+        }
+        uint8_t method_id = method_cache_[name_idx];
+        if (method_id == kUnresolvedMethod) {
+            method_id = resolve_method(name_idx);
+        }
+        if (stack_.size() < size_t{arg_count} + 1) {
+            throw std::runtime_error("Stack underflow");
+        }
+
+        // Receiver and arguments stay in their stack slots; the method may
+        // consume them
+        Value* receiver = stack_.data() + stack_.size() - arg_count - 1;
+        std::span<Value> args(receiver + 1, arg_count);
+        Value result;
+        if (method_id < kMethodCount && is_callback_method(static_cast<MethodId>(method_id)) &&
+            receiver->is_list()) {
+            SAVE_IP();  // Call site of the callbacks' frames
+            result = call_list_method(static_cast<MethodId>(method_id), *receiver, args);
+        } else {
+            MethodFn method = method_id < kMethodCount
+                ? lookup_method(receiver->type(), static_cast<MethodId>(method_id))
+                : nullptr;
+            if (method == nullptr) {
+                throw_unknown_method(constants[name_idx].as_string(), *receiver);
+            }
+            result = method(*receiver, args);
+        }
+        stack_.erase(stack_.end() - arg_count - 1, stack_.end());
+        stack_.push_back(std::move(result));
+    }
+    DISPATCH();
+
+op_CALL_BUILTIN: {
+        // Read operands
+        uint16_t builtin_id = READ_UINT16();
+        uint8_t arg_count = READ_BYTE();
+
+        if ((builtin_id == static_cast<uint16_t>(BuiltinId::PRINT) ||
+             builtin_id == static_cast<uint16_t>(BuiltinId::PRINTLN)) && arg_count == 1) {
+            // Straight from the stack into the output buffer
+            if (builtin_id == static_cast<uint16_t>(BuiltinId::PRINTLN)) {
+                output_.println(peek());
+            } else {
+                output_.print(peek());
             }
+            stack_.back() = Value(int64_t{0});  // Unit placeholder
+        } else {
+            // Pop arguments (in reverse order)
+            std::vector<Value> args;
+            args.reserve(arg_count);
+            for (size_t i = 0; i < arg_count; ++i) {
+                args.push_back(pop());
+            }
+            std::reverse(args.begin(), args.end());
 
-            case OpCode::SUB: {
-                Value b = pop();
-                Value a = pop();
-                push(binary_sub(a, b));
-                break;
+            if (builtin_id == static_cast<uint16_t>(BuiltinId::FOR_EACH_LINE)) {
+                SAVE_IP();  // Call site of the callback's frames
+                push(for_each_line(args));
+            } else {
+                push(call_builtin(builtin_id, std::move(args), output_));
             }
+        }
+    }
+    DISPATCH();
+
+    // === Superinstructions ===
+op_LOAD_LOCAL2: {
+        uint16_t first = READ_UINT16();
+        uint16_t second = READ_UINT16();
+        push(locals[first]);
+        push(locals[second]);
+    }
+    DISPATCH();
 
-            case OpCode::MUL: {
-                Value b = pop();
-                Value a = pop();
-                push(binary_mul(a, b));
-                break;
+op_LOAD_LOCAL_CONST: {
+        uint16_t idx = READ_UINT16();
+        uint16_t const_idx = READ_UINT16();
+        push(locals[idx]);
+        push(constants[const_idx]);
+    }
+    DISPATCH();
+
+op_POP_JUMP_IF_FALSE: {
+        int16_t offset = static_cast<int16_t>(READ_UINT16());
+        if (!pop().is_truthy()) {
+            JUMP_BY(offset);
+        }
+    }
+    DISPATCH();
+
+op_COMPARE_JUMP_IF_FALSE: {
+        int16_t offset = static_cast<int16_t>(READ_UINT16());
+        auto compare = static_cast<OpCode>(READ_BYTE());
+        if (stack_.size() < 2) {
+            throw std::runtime_error("Stack underflow");
+        }
+        const Value& b = stack_.back();
+        const Value& a = stack_[stack_.size() - 2];
+        bool result = a.is_int() && b.is_int()
+            ? compare_ints(compare, a.as_int(), b.as_int())
+            : compare_values(compare, a, b);
+        stack_.pop_back();
+        stack_.pop_back();
+        if (!result) {
+            JUMP_BY(offset);
+        }
+    }
+    DISPATCH();
+
+op_HALT:
+    instructions_executed_ += executed;
+    return;
+
+op_unknown:
+    throw std::runtime_error(fmt::format(
+        "Unknown opcode: {}",
+        static_cast<int>(opcode_byte)
+    ));
+
+#undef DISPATCH
+#undef LOAD_FRAME
+#undef SAVE_IP
+#undef JUMP_BY
+#undef READ_UINT16
+#undef READ_BYTE
+}
+
+#if LUCID_HAS_COMPUTED_GOTO
+#pragma GCC diagnostic pop
+#endif
+
+// === Out-of-line opcode helpers ===
+
+auto VM::index_value(const Value& collection, const Value& index) -> Value {
+    if (!index.is_int()) {
+        throw std::runtime_error(fmt::format(
+            "Index must be Int, got {}",
+            index.type_name()
+        ));
+    }
+
+    int64_t idx = index.as_int();
+
+    if (collection.is_list()) {
+        const auto& list = collection.as_list();
+        if (idx < 0 || static_cast<size_t>(idx) >= list.size()) {
+            throw std::runtime_error(fmt::format(
+                "List index out of bounds: {} (size: {})",
+                idx, list.size()
+            ));
+        }
+        return list[static_cast<size_t>(idx)];
+    }
+    if (collection.is_tuple()) {
+        const auto& tuple = collection.as_tuple();
+        if (idx < 0 || static_cast<size_t>(idx) >= tuple.size()) {
+            throw std::runtime_error(fmt::format(
+                "Tuple index out of bounds: {} (size: {})",
+                idx, tuple.size()
+            ));
+        }
+        return tuple[static_cast<size_t>(idx)];
+    }
+    throw std::runtime_error(fmt::format(
+        "Cannot index into {}",
+        collection.type_name()
+    ));
+}
+
+auto VM::call_builtin(uint16_t builtin_id, std::vector<Value> args, OutputBuffer& out) -> Value {
+    // Dispatch based on builtin ID
+    switch (static_cast<BuiltinId>(builtin_id)) {
+        case BuiltinId::PRINT: {
+            if (args.size() != 1) {
+                throw std::runtime_error("print() expects 1 argument");
+            }
+            // Print without newline - strings printed without quotes
+            out.print(args[0]);
+            // Return Unit (push nothing or a placeholder)
+            return Value(int64_t{0});  // Unit placeholder
+        }
+        case BuiltinId::PRINTLN: {
+            if (args.size() != 1) {
+                throw std::runtime_error("println() expects 1 argument");
             }
-
-            case OpCode::DIV: {
-                Value b = pop();
-                Value a = pop();
-                push(binary_div(a, b));
-                break;
+            // Print with newline - strings printed without quotes
+            out.println(args[0]);
+            // Return Unit (push nothing or a placeholder)
+            return Value(int64_t{0});  // Unit placeholder
+        }
+        case BuiltinId::TO_STRING: {
+            if (args.size() != 1) {
+                throw std::runtime_error("to_string() expects 1 argument");
             }
-
-            case OpCode::MOD: {
-                Value b = pop();
-                Value a = pop();
-                push(binary_mod(a, b));
-                break;
+            return Value(args[0].to_string());
+        }
+        case BuiltinId::READ_FILE: {
+            if (args.size() != 1 || !args[0].is_string()) {
+                throw std::runtime_error("read_file() expects 1 string argument");
             }
-
-            case OpCode::POW: {
-                Value b = pop();
-                Value a = pop();
-                push(binary_pow(a, b));
-                break;
+            // Empty on error
+            return read_file_value(std::string(args[0].as_string()));
+        }
+        case BuiltinId::WRITE_FILE: {
+            if (args.size() != 2 || !args[0].is_string() || !args[1].is_string()) {
+                throw std::runtime_error("write_file() expects 2 string arguments");
             }
-
-            // === Comparison Operations ===
-            case OpCode::EQ: {
-                Value b = pop();
-                Value a = pop();
-                push(binary_eq(a, b));
-                break;
+            const std::string path(args[0].as_string());
+            std::string_view content = args[1].as_string();
+            flush_appended_files();
+            const auto error = replace_file(
+                path, {reinterpret_cast<const uint8_t*>(content.data()), content.size()});
+            return Value(!error);
+        }
+        case BuiltinId::APPEND_FILE: {
+            if (args.size() != 2 || !args[0].is_string() || !args[1].is_string()) {
+                throw std::runtime_error("append_file() expects 2 string arguments");
             }
-
-            case OpCode::NE: {
-                Value b = pop();
-                Value a = pop();
-                push(binary_ne(a, b));
-                break;
+            return Value(append_to_file(std::string(args[0].as_string()), args[1].as_string()));
+        }
+        case BuiltinId::FILE_EXISTS: {
+            if (args.size() != 1 || !args[0].is_string()) {
+                throw std::runtime_error("file_exists() expects 1 string argument");
             }
-
-            case OpCode::LT: {
-                Value b = pop();
-                Value a = pop();
-                push(binary_lt(a, b));
-                break;
+            const std::string path(args[0].as_string());
+            return Value(std::filesystem::exists(path));
+        }
+        case BuiltinId::READ_LINES: {
+            if (args.size() != 1 || !args[0].is_string()) {
+                throw std::runtime_error("read_lines() expects 1 string argument");
             }
-
-            case OpCode::GT: {
-                Value b = pop();
-                Value a = pop();
-                push(binary_gt(a, b));
-                break;
+            flush_appended_files();
+            // Empty on error, like read_file
+            LineReader reader{std::string(args[0].as_string())};
+            std::vector<Value> lines;
+            std::string_view line;
+            while (reader.next(line)) {
+                lines.emplace_back(std::string(line));
             }
+            return Value(std::move(lines), false);
+        }
+        case BuiltinId::FOR_EACH_LINE:
+            throw std::runtime_error("for_each_line() can only run in the VM");
+        default:
+            throw std::runtime_error(fmt::format(
+                "Unknown builtin ID: {}", builtin_id
+            ));
+    }
+}
 
-            case OpCode::LE: {
-                Value b = pop();
-                Value a = pop();
-                push(binary_le(a, b));
-                break;
-            }
+// Lines are read a chunk at a time and each is passed to the callback as
+// soon as it is complete, so only one chunk of the file is ever in memory
+auto VM::for_each_line(std::vector<Value>& args) -> Value {
+    if (args.size() != 2 || !args[0].is_string() || !args[1].is_function()) {
+        throw std::runtime_error("for_each_line() expects a string and a function");
+    }
+    flush_appended_files();
+    LineReader reader{std::string(args[0].as_string())};
+    const Value callback = std::move(args[1]);
+
+    int64_t count = 0;
+    std::string_view line;
+    while (reader.next(line)) {
+        push(Value(std::string(line)));
+        invoke(callback, 1);
+        ++count;
+    }
+    return Value(count);
+}
 
-            case OpCode::GE: {
-                Value b = pop();
-                Value a = pop();
-                push(binary_ge(a, b));
-                break;
-            }
+auto VM::finish_call() -> void {
+    output_.flush();
+    flush_appended_files();
+}
 
-            // === Logical Operations ===
-            case OpCode::AND: {
-                Value b = pop();
-                Value a = pop();
-                push(binary_and(a, b));
-                break;
-            }
+// === Helper Methods ===
 
-            case OpCode::OR: {
-                Value b = pop();
-                Value a = pop();
-                push(binary_or(a, b));
-                break;
-            }
+auto VM::sample_stack(size_t offset) -> std::string {
+    // Frames are "function:line" when the program has debug locations
+    const auto& locations = bytecode_->debug_locations;
+    const bool has_lines = !locations.empty() && locations.size() == bytecode_->code().size();
+    std::string stack;
+    for (size_t i = 0; i < call_stack_.size(); ++i) {
+        const auto& frame = call_stack_[i];
+        // Callers saved the offset just past their call instruction
+        const size_t at = i + 1 < call_stack_.size() ? frame.instruction_pointer - 1 : offset;
+        if (i > 0) {
+            stack += ';';
+        }
+        stack += bytecode_->functions[frame.function_index].name;
+        if (has_lines && at < locations.size()) {
+            stack += fmt::format(":{}", locations[at].line);
+        }
+    }
+    return stack;
+}
 
-            case OpCode::NOT: {
-                Value a = pop();
-                push(unary_not(a));
-                break;
-            }
+auto VM::current_frame() -> CallFrame& {
+    return call_stack_.back();
+}
 
-            // === Unary Operations ===
-            case OpCode::NEGATE: {
-                Value a = pop();
-                push(unary_negate(a));
-                break;
-            }
+auto VM::enter_frame(size_t func_idx, size_t arg_count) -> void {
+    const auto& func_info = bytecode_->functions[func_idx];
+    if (call_stack_.size() == kMaxCallDepth) {
+        throw std::runtime_error("Call stack overflow");
+    }
+    if (stack_.size() < arg_count) {
+        throw std::runtime_error("Stack underflow");
+    }
 
-            case OpCode::POSITIVE: {
-                Value a = pop();
-                push(unary_positive(a));
-                break;
-            }
+    // Reserve the non-parameter locals by bumping the stack top
+    const size_t base = stack_.size() - arg_count;
+    const size_t extra = func_info.local_count > arg_count ? func_info.local_count - arg_count : 0;
+    if (extra > stack_.capacity() - stack_.size()) {
+        throw std::runtime_error("Stack overflow");
+    }
+    stack_.resize(stack_.size() + extra);  // Locals start out as Int(0)
 
-            // === Stack Operations ===
-            case OpCode::POP:
-                pop();
-                break;
+    call_stack_.emplace_back(func_idx, func_info.offset, base);
+}
 
-            case OpCode::DUP:
-                push(peek());
-                break;
+auto VM::jit_call(size_t func_idx, size_t arg_count) -> bool {
+    if (stack_.size() < arg_count) {
+        throw std::runtime_error("Stack underflow");
+    }
+    const size_t base = stack_.size() - arg_count;
+    auto result = jit_->call(func_idx,
+                             std::span<const Value>(stack_).subspan(base),
+                             kMaxCallDepth - call_stack_.size(),
+                             stack_.capacity() - base);
+    if (!result) {
+        return false;
+    }
+    stack_.erase(stack_.begin() + static_cast<std::ptrdiff_t>(base), stack_.end());
+    push(std::move(*result));
+    return true;
+}
 
-            // === Variables ===
-            case OpCode::LOAD_LOCAL: {
-                uint16_t idx = read_uint16();
-                push(current_frame().locals[idx]);
-                break;
-            }
+auto VM::memo_lookup(size_t func_idx, size_t arg_count, bool spread) -> bool {
+    MemoTable* table = memo_[func_idx].get();
+    if (!table) {
+        return false;
+    }
+    if (stack_.size() < arg_count) {
+        throw std::runtime_error("Stack underflow");
+    }
+    const size_t base = stack_.size() - arg_count;
+    const auto* entry = table->find(std::span<const Value>(stack_).subspan(base));
+    if (!entry) {
+        return false;
+    }
 
-            case OpCode::STORE_LOCAL: {
-                uint16_t idx = read_uint16();
-                current_frame().locals[idx] = peek();
-                break;
-            }
+    stack_.erase(stack_.begin() + static_cast<std::ptrdiff_t>(base), stack_.end());
+    if (spread && entry->unpacked) {
+        for (const auto& element : entry->result.as_tuple()) {
+            push(element);
+        }
+    } else {
+        push(entry->result);
+    }
+    return true;
+}
 
-            case OpCode::LOAD_GLOBAL: {
-                // Load function reference (push function index as value)
-                uint16_t func_idx = read_uint16();
-                push(Value(static_cast<int64_t>(func_idx)));
-                break;
-            }
+// The parameters are still the arguments the frame was entered with (or
+// reused with, by TAIL_CALL): locals are never stored to twice
+auto VM::memo_store(size_t unpacked) -> void {
+    const CallFrame& frame = current_frame();
+    MemoTable* table = memo_[frame.function_index].get();
+    if (!table) {
+        return;
+    }
+    const auto args = std::span<const Value>(stack_).subspan(
+        frame.stack_base, bytecode_->functions[frame.function_index].param_count);
+    if (unpacked == 0) {
+        table->insert(args, peek(), false);
+    } else {
+        std::vector<Value> elements(stack_.end() - static_cast<std::ptrdiff_t>(unpacked), stack_.end());
+        table->insert(args, Value(std::move(elements), true), true);
+    }
+}
 
-            // === Function Calls ===
-            case OpCode::CALL: {
-                // Read operands
-                uint16_t func_idx = read_uint16();
-                uint8_t arg_count = read_byte();
-
-                // Validate function index
-                if (func_idx >= bytecode_->functions.size()) {
-                    throw std::runtime_error(fmt::format(
-                        "Invalid function index: {}", func_idx
-                    ));
-                }
+auto VM::push_captures(const Value& callee, size_t arg_count) -> size_t {
+    if (!callee.is_function()) {
+        throw std::runtime_error(fmt::format("Cannot call {}", callee.type_name()));
+    }
+    const size_t func_idx = callee.as_function_index();
+    if (func_idx >= bytecode_->functions.size()) {
+        throw std::runtime_error(fmt::format("Invalid function index: {}", func_idx));
+    }
 
-                const auto& func_info = bytecode_->functions[func_idx];
+    // A closure's parameters are its arguments followed by its captures
+    const auto& func_info = bytecode_->functions[func_idx];
+    auto captures = callee.as_captures();
+    if (arg_count + captures.size() != func_info.param_count) {
+        throw std::runtime_error(fmt::format(
+            "Function '{}' expects {} arguments, got {}",
+            func_info.name, func_info.param_count - std::min(func_info.param_count, captures.size()),
+            arg_count
+        ));
+    }
+    if (captures.size() > stack_.capacity() - stack_.size()) {
+        throw std::runtime_error("Stack overflow");
+    }
+    stack_.insert(stack_.end(), captures.begin(), captures.end());
+    return func_idx;
+}
 
-                // Validate argument count
-                if (arg_count != func_info.param_count) {
-                    throw std::runtime_error(fmt::format(
-                        "Function '{}' expects {} arguments, got {}",
-                        func_info.name, func_info.param_count, arg_count
-                    ));
-                }
+auto VM::invoke(const Value& callee, size_t arg_count) -> Value {
+    const size_t func_idx = push_captures(callee, arg_count);
+    return invoke(func_idx, bytecode_->functions[func_idx].param_count);
+}
 
-                // Pop arguments from stack (in reverse order)
-                std::vector<Value> args;
-                args.reserve(arg_count);
-                for (size_t i = 0; i < arg_count; ++i) {
-                    args.push_back(pop());
-                }
-                // Reverse to get correct order
-                std::reverse(args.begin(), args.end());
-
-                // Create new call frame
-                size_t return_address = ip();
-                CallFrame new_frame(
-                    func_idx,
-                    func_info.offset,
-                    stack_.size(),  // stack_base for new frame
-                    func_info.local_count
-                );
-
-                // Initialize parameters from arguments
-                for (size_t i = 0; i < args.size(); ++i) {
-                    new_frame.locals[i] = std::move(args[i]);
-                }
+auto VM::invoke(size_t func_idx, size_t arg_count) -> Value {
+    if ((!memo_.empty() && memo_lookup(func_idx, arg_count, false)) ||
+        (jit_ && jit_call(func_idx, arg_count))) {
+        return pop();
+    }
 
-                // Save return address in current frame
-                if (!call_stack_.empty()) {
-                    current_frame().instruction_pointer = return_address;
-                }
+    // The callee's frame sits on the caller's stack like any other; run()
+    // comes back here when it returns instead of carrying on in the caller
+    const size_t saved_depth = return_depth_;
+    return_depth_ = call_stack_.size();
+    enter_frame(func_idx, arg_count);
+    run();
+    return_depth_ = saved_depth;
+    return pop();
+}
 
-                // Push new frame and jump to function
-                call_stack_.push_back(std::move(new_frame));
-                break;
-            }
+// The loops below replace the per-element recursion a Lucid program would
+// otherwise write with head()/tail(). Each callback runs directly in a frame
+// on the VM's preallocated stack: the element is pushed as its argument, no
+// argument vector is built and no name is looked up per element.
+auto VM::call_list_method(MethodId id, Value& receiver, std::span<Value> args) -> Value {
+    const size_t expected_args = id == MethodId::FOLD ? 2 : 1;
+    const auto name = method_name(id);
+    if (args.size() != expected_args || !args.back().is_function()) {
+        throw std::runtime_error(fmt::format(
+            "List.{}() takes {}a function argument", name, id == MethodId::FOLD ? "an initial value and " : ""
+        ));
+    }
+    // Keep the list and callback alive whatever the callback does to the stack
+    const Value list = std::move(receiver);
+    const Value callback = std::move(args.back());
+    const auto& elements = list.as_list();
+
+    // par_* on short lists, or inside a worker, run like map and filter
+    if (id >= MethodId::PAR_MAP && !is_worker_ && !profiler_ && parallel_threshold_ > 0 &&
+        elements.size() >= parallel_threshold_) {
+        return call_list_parallel(id, elements, callback);
+    }
 
-            case OpCode::RETURN: {
-                // Return value should be on top of stack
-                // Pop the call frame and return
-                call_stack_.pop_back();
-                if (call_stack_.empty()) {
-                    // Returning from top-level function
-                    return;
+    switch (id) {
+        case MethodId::MAP:
+        case MethodId::PAR_MAP: {
+            std::vector<Value> mapped;
+            mapped.reserve(elements.size());
+            for (const Value& element : elements) {
+                push(element);
+                mapped.push_back(invoke(callback, 1));
+            }
+            return Value(std::move(mapped), false);
+        }
+        case MethodId::FILTER:
+        case MethodId::PAR_FILTER: {
+            std::vector<Value> kept;
+            for (const Value& element : elements) {
+                push(element);
+                if (invoke(callback, 1).is_truthy()) {
+                    kept.push_back(element);
                 }
-                // Continue execution in caller
-                break;
             }
-
-            // === Control Flow ===
-            case OpCode::JUMP: {
-                // Read signed 16-bit offset
-                int16_t offset = static_cast<int16_t>(read_uint16());
-                ip() = static_cast<size_t>(static_cast<int64_t>(ip()) + offset);
-                break;
+            return Value(std::move(kept), false);
+        }
+        case MethodId::FOLD: {
+            Value accumulator = std::move(args[0]);
+            for (const Value& element : elements) {
+                push(std::move(accumulator));
+                push(element);
+                accumulator = invoke(callback, 2);
             }
-
-            case OpCode::JUMP_IF_FALSE: {
-                // Read signed 16-bit offset
-                int16_t offset = static_cast<int16_t>(read_uint16());
-                const Value& condition = peek();  // Peek, don't pop
-                if (!condition.is_truthy()) {
-                    ip() = static_cast<size_t>(static_cast<int64_t>(ip()) + offset);
-                }
-                break;
+            return accumulator;
+        }
+        case MethodId::PAR_REDUCE: {
+            if (elements.empty()) {
+                throw std::runtime_error("List.par_reduce() of an empty list");
             }
-
-            case OpCode::JUMP_IF_TRUE: {
-                // Read signed 16-bit offset
-                int16_t offset = static_cast<int16_t>(read_uint16());
-                const Value& condition = peek();  // Peek, don't pop
-                if (condition.is_truthy()) {
-                    ip() = static_cast<size_t>(static_cast<int64_t>(ip()) + offset);
-                }
-                break;
+            Value accumulator = elements.front();
+            for (size_t i = 1; i < elements.size(); ++i) {
+                push(std::move(accumulator));
+                push(elements[i]);
+                accumulator = invoke(callback, 2);
             }
+            return accumulator;
+        }
+        default:
+            throw std::runtime_error(fmt::format("List.{}() is not a callback method", name));
+    }
+}
 
-            // === Collections ===
-            case OpCode::BUILD_LIST: {
-                uint16_t count = read_uint16();
-                std::vector<Value> elements;
-                elements.reserve(count);
-
-                // Pop elements in reverse order
-                for (size_t i = 0; i < count; ++i) {
-                    elements.push_back(pop());
-                }
-                // Reverse to get correct order
-                std::reverse(elements.begin(), elements.end());
-
-                push(Value(std::move(elements), false));  // false = list
-                break;
+// The list is cut into contiguous shares, a few per pool thread so that
+// stealing evens out uneven callbacks. Shares keep list order, so par_map
+// and par_filter return exactly what map and filter would; par_reduce
+// relies on the callback being associative.
+auto VM::call_list_parallel(MethodId id, const PersistentVector& elements, const Value& callback)
+    -> Value {
+    if (!parallel_) {
+        parallel_ = std::make_unique<ParallelRuntime>(parallel_threads_);
+    }
+    auto& runtime = *parallel_;
+
+    const size_t count = elements.size();
+    const size_t shares = std::min(count, runtime.pool.size() * 4);
+    std::vector<std::vector<Value>> results(shares);
+    std::vector<std::string> output(shares);
+    runtime.pool.parallel_for(shares, [&](size_t share) {
+        auto worker = runtime.acquire();
+        struct Release {
+            ParallelRuntime& runtime;
+            std::unique_ptr<VM>& worker;
+            ~Release() {
+                worker->clear_output();
+                runtime.release(std::move(worker));
             }
+        } release{runtime, worker};
 
-            case OpCode::BUILD_TUPLE: {
-                uint16_t count = read_uint16();
-                std::vector<Value> elements;
-                elements.reserve(count);
-
-                // Pop elements in reverse order
-                for (size_t i = 0; i < count; ++i) {
-                    elements.push_back(pop());
-                }
-                // Reverse to get correct order
-                std::reverse(elements.begin(), elements.end());
-
-                push(Value(std::move(elements), true));  // true = tuple
-                break;
-            }
+        results[share] = worker->run_share(*this, id, callback, elements,
+                                           share * count / shares, (share + 1) * count / shares);
+        output[share] = worker->get_output();
+    });
 
-            case OpCode::INDEX: {
-                Value index = pop();
-                Value collection = pop();
+    for (const auto& text : output) {
+        output_.write(text);
+    }
 
-                if (!index.is_int()) {
-                    throw std::runtime_error(fmt::format(
-                        "Index must be Int, got {}",
-                        index.type_name()
-                    ));
-                }
+    if (id == MethodId::PAR_REDUCE) {
+        // Each share reduced its own elements; combine them in order
+        Value accumulator = std::move(results[0][0]);
+        for (size_t share = 1; share < shares; ++share) {
+            push(std::move(accumulator));
+            push(std::move(results[share][0]));
+            accumulator = invoke(callback, 2);
+        }
+        return accumulator;
+    }
 
-                int64_t idx = index.as_int();
+    std::vector<Value> combined;
+    combined.reserve(id == MethodId::PAR_MAP ? count : 0);
+    for (auto& part : results) {
+        std::move(part.begin(), part.end(), std::back_inserter(combined));
+    }
+    return Value(std::move(combined), false);
+}
 
-                if (collection.is_list()) {
-                    const auto& list = collection.as_list();
-                    if (idx < 0 || static_cast<size_t>(idx) >= list.size()) {
-                        throw std::runtime_error(fmt::format(
-                            "List index out of bounds: {} (size: {})",
-                            idx, list.size()
-                        ));
-                    }
-                    push(list[static_cast<size_t>(idx)]);
-                } else if (collection.is_tuple()) {
-                    const auto& tuple = collection.as_tuple();
-                    if (idx < 0 || static_cast<size_t>(idx) >= tuple.size()) {
-                        throw std::runtime_error(fmt::format(
-                            "Tuple index out of bounds: {} (size: {})",
-                            idx, tuple.size()
-                        ));
-                    }
-                    push(tuple[static_cast<size_t>(idx)]);
-                } else {
-                    throw std::runtime_error(fmt::format(
-                        "Cannot index into {}",
-                        collection.type_name()
-                    ));
+auto VM::run_share(const VM& parent, MethodId id, const Value& callback,
+                   const PersistentVector& elements, size_t begin, size_t end) -> std::vector<Value> {
+    // Private copies of the parent's constants, refreshed per top-level call
+    if (bytecode_ != parent.bytecode_ || bound_generation_ != parent.generation_) {
+        bytecode_ = parent.bytecode_;
+        bound_generation_ = parent.generation_;
+        const size_t constant_count = parent.bytecode_->constants.size();
+        program_constants_.clear();
+        program_constants_.reserve(constant_count);
+        for (size_t i = 0; i < constant_count; ++i) {
+            program_constants_.push_back(parent.constants_[i].deep_copy());
+        }
+        method_cache_.assign(constant_count, kUnresolvedMethod);
+    }
+    constants_ = program_constants_.data();
+    dispatch_mode_ = parent.dispatch_mode_;
+    jit_threshold_ = parent.jit_threshold_;
+    reset_execution();
+
+    const Value function = callback.deep_copy();
+    std::vector<Value> results;
+    try {
+        switch (id) {
+            case MethodId::PAR_MAP:
+                results.reserve(end - begin);
+                for (size_t i = begin; i < end; ++i) {
+                    push(elements[i].deep_copy());
+                    results.push_back(detach(invoke(function, 1)));
                 }
                 break;
-            }
-
-            case OpCode::CALL_METHOD: {
-                // Read operands
-                uint16_t name_idx = read_uint16();
-                uint8_t arg_count = read_byte();
-
-                // Get method name from constant pool
-                if (name_idx >= bytecode_->constants.size()) {
-                    throw std::runtime_error(fmt::format(
-                        "Invalid constant index for method name: {}", name_idx
-                    ));
-                }
-                const Value& name_val = bytecode_->constants[name_idx];
-                if (!name_val.is_string()) {
-                    throw std::runtime_error("Method name must be a string");
-                }
-                const std::string& method_name = name_val.as_string();
-
-                // Pop arguments (in reverse order)
-                std::vector<Value> args;
-                args.reserve(arg_count);
-                for (size_t i = 0; i < arg_count; ++i) {
-                    args.push_back(pop());
+            case MethodId::PAR_FILTER:
+                for (size_t i = begin; i < end; ++i) {
+                    Value element = elements[i].deep_copy();
+                    push(element);
+                    if (invoke(function, 1).is_truthy()) {
+                        results.push_back(std::move(element));
+                    }
                 }
-                std::reverse(args.begin(), args.end());
-
-                // Pop the receiver object
-                Value receiver = pop();
-
-                // Dispatch to built-in method
-                Value result = call_builtin_method(method_name, receiver, std::move(args));
-                push(std::move(result));
                 break;
-            }
-
-            case OpCode::CALL_BUILTIN: {
-                // Read operands
-                uint16_t builtin_id = read_uint16();
-                uint8_t arg_count = read_byte();
-
-                // Pop arguments (in reverse order)
-                std::vector<Value> args;
-                args.reserve(arg_count);
-                for (size_t i = 0; i < arg_count; ++i) {
-                    args.push_back(pop());
-                }
-                std::reverse(args.begin(), args.end());
-
-                // Dispatch based on builtin ID
-                switch (static_cast<BuiltinId>(builtin_id)) {
-                    case BuiltinId::PRINT: {
-                        if (args.size() != 1) {
-                            throw std::runtime_error("print() expects 1 argument");
-                        }
-                        // Print without newline - strings printed without quotes
-                        if (args[0].is_string()) {
-                            output_stream_ << args[0].as_string();
-                        } else {
-                            output_stream_ << args[0].to_string();
-                        }
-                        // Return Unit (push nothing or a placeholder)
-                        push(Value(int64_t{0}));  // Unit placeholder
-                        break;
-                    }
-                    case BuiltinId::PRINTLN: {
-                        if (args.size() != 1) {
-                            throw std::runtime_error("println() expects 1 argument");
-                        }
-                        // Print with newline - strings printed without quotes
-                        if (args[0].is_string()) {
-                            output_stream_ << args[0].as_string() << "\n";
-                        } else {
-                            output_stream_ << args[0].to_string() << "\n";
-                        }
-                        // Return Unit (push nothing or a placeholder)
-                        push(Value(int64_t{0}));  // Unit placeholder
-                        break;
-                    }
-                    case BuiltinId::TO_STRING: {
-                        if (args.size() != 1) {
-                            throw std::runtime_error("to_string() expects 1 argument");
-                        }
-                        push(Value(args[0].to_string()));
-                        break;
-                    }
-                    case BuiltinId::READ_FILE: {
-                        if (args.size() != 1 || !args[0].is_string()) {
-                            throw std::runtime_error("read_file() expects 1 string argument");
-                        }
-                        const std::string& path = args[0].as_string();
-                        std::ifstream file(path);
-                        if (!file.is_open()) {
-                            // Return empty string on error
-                            push(Value(std::string{}));
-                        } else {
-                            std::stringstream buffer;
-                            buffer << file.rdbuf();
-                            push(Value(buffer.str()));
-                        }
-                        break;
-                    }
-                    case BuiltinId::WRITE_FILE: {
-                        if (args.size() != 2 || !args[0].is_string() || !args[1].is_string()) {
-                            throw std::runtime_error("write_file() expects 2 string arguments");
-                        }
-                        const std::string& path = args[0].as_string();
-                        const std::string& content = args[1].as_string();
-                        std::ofstream file(path);
-                        if (!file.is_open()) {
-                            push(Value(false));
-                        } else {
-                            file << content;
-                            push(Value(file.good()));
-                        }
-                        break;
-                    }
-                    case BuiltinId::APPEND_FILE: {
-                        if (args.size() != 2 || !args[0].is_string() || !args[1].is_string()) {
-                            throw std::runtime_error("append_file() expects 2 string arguments");
-                        }
-                        const std::string& path = args[0].as_string();
-                        const std::string& content = args[1].as_string();
-                        std::ofstream file(path, std::ios::app);
-                        if (!file.is_open()) {
-                            push(Value(false));
-                        } else {
-                            file << content;
-                            push(Value(file.good()));
-                        }
-                        break;
-                    }
-                    case BuiltinId::FILE_EXISTS: {
-                        if (args.size() != 1 || !args[0].is_string()) {
-                            throw std::runtime_error("file_exists() expects 1 string argument");
-                        }
-                        const std::string& path = args[0].as_string();
-                        push(Value(std::filesystem::exists(path)));
-                        break;
-                    }
-                    default:
-                        throw std::runtime_error(fmt::format(
-                            "Unknown builtin ID: {}", builtin_id
-                        ));
+            default: {
+                Value accumulator = elements[begin].deep_copy();
+                for (size_t i = begin + 1; i < end; ++i) {
+                    push(std::move(accumulator));
+                    push(elements[i].deep_copy());
+                    accumulator = invoke(function, 2);
                 }
+                results.push_back(detach(std::move(accumulator)));
                 break;
             }
-
-            case OpCode::HALT:
-                return;
-
-            default:
-                throw std::runtime_error(fmt::format(
-                    "Unknown opcode: {}",
-                    static_cast<int>(opcode_byte)
-                ));
         }
+    } catch (...) {
+        discard_stacks();
+        throw;
     }
+    return results;
 }
 
-// === Helper Methods ===
+// TAIL_CALL: the arguments on top of the stack replace the current frame's
+// window, so the call stack does not grow
+auto VM::reuse_frame(size_t func_idx, size_t arg_count) -> void {
+    const auto& func_info = bytecode_->functions[func_idx];
+    CallFrame& frame = current_frame();
+    if (stack_.size() < frame.stack_base + arg_count) {
+        throw std::runtime_error("Stack underflow");
+    }
 
-auto VM::current_frame() -> CallFrame& {
-    return call_stack_.back();
-}
+    // Move the arguments down to local 0 and drop everything above them
+    auto args = stack_.begin() + static_cast<std::ptrdiff_t>(stack_.size() - arg_count);
+    auto base = stack_.begin() + static_cast<std::ptrdiff_t>(frame.stack_base);
+    std::move(args, stack_.end(), base);
+    stack_.erase(base + static_cast<std::ptrdiff_t>(arg_count), stack_.end());
 
-auto VM::ip() -> size_t& {
-    return current_frame().instruction_pointer;
+    // Fresh non-parameter locals, as on entry
+    const size_t extra = func_info.local_count > arg_count ? func_info.local_count - arg_count : 0;
+    if (extra > stack_.capacity() - stack_.size()) {
+        throw std::runtime_error("Stack overflow");
+    }
+    stack_.resize(stack_.size() + extra);
+
+    frame.function_index = func_idx;
+    frame.instruction_pointer = func_info.offset;
 }
 
 auto VM::push(Value val) -> void {
+    if (stack_.size() == stack_.capacity()) {
+        throw std::runtime_error("Stack overflow");
+    }
     stack_.push_back(std::move(val));
 }
 
@@ -591,23 +1706,11 @@ auto VM::peek() const -> const Value& {
     return stack_.back();
 }
 
-auto VM::read_byte() -> uint8_t {
-    return bytecode_->instructions[ip()++];
-}
-
-auto VM::read_uint16() -> uint16_t {
-    // Little-endian
-    uint8_t low = read_byte();
-    uint8_t high = read_byte();
-    uint16_t result = static_cast<uint16_t>(static_cast<uint16_t>(low) | (static_cast<uint16_t>(high) << 8));
-    return result;
-}
-
 // === Arithmetic Operations ===
 
 auto VM::binary_add(const Value& a, const Value& b) -> Value {
     if (a.is_int() && b.is_int()) {
-        return Value(a.as_int() + b.as_int());
+        return Value(int_add(a.as_int(), b.as_int()));
     }
     if (a.is_float() && b.is_float()) {
         return Value(a.as_float() + b.as_float());
@@ -618,6 +1721,9 @@ auto VM::binary_add(const Value& a, const Value& b) -> Value {
     if (a.is_float() && b.is_int()) {
         return Value(a.as_float() + static_cast<double>(b.as_int()));
     }
+    if (a.is_string() && b.is_string()) {
+        return Value::concat(a, b);
+    }
     throw std::runtime_error(fmt::format(
         "Cannot add {} and {}",
         a.type_name(), b.type_name()
@@ -626,7 +1732,7 @@ auto VM::binary_add(const Value& a, const Value& b) -> Value {
 
 auto VM::binary_sub(const Value& a, const Value& b) -> Value {
     if (a.is_int() && b.is_int()) {
-        return Value(a.as_int() - b.as_int());
+        return Value(int_sub(a.as_int(), b.as_int()));
     }
     if (a.is_float() && b.is_float()) {
         return Value(a.as_float() - b.as_float());
@@ -645,7 +1751,7 @@ auto VM::binary_sub(const Value& a, const Value& b) -> Value {
 
 auto VM::binary_mul(const Value& a, const Value& b) -> Value {
     if (a.is_int() && b.is_int()) {
-        return Value(a.as_int() * b.as_int());
+        return Value(int_mul(a.as_int(), b.as_int()));
     }
     if (a.is_float() && b.is_float()) {
         return Value(a.as_float() * b.as_float());
@@ -667,7 +1773,7 @@ auto VM::binary_div(const Value& a, const Value& b) -> Value {
         if (b.as_int() == 0) {
             throw std::runtime_error("Division by zero");
         }
-        return Value(a.as_int() / b.as_int());
+        return Value(int_div(a.as_int(), b.as_int()));
     }
     if (a.is_float() && b.is_float()) {
         if (b.as_float() == 0.0) {
@@ -698,7 +1804,7 @@ auto VM::binary_mod(const Value& a, const Value& b) -> Value {
         if (b.as_int() == 0) {
             throw std::runtime_error("Modulo by zero");
         }
-        return Value(a.as_int() % b.as_int());
+        return Value(int_mod(a.as_int(), b.as_int()));
     }
     throw std::runtime_error(fmt::format(
         "Modulo requires two integers, got {} and {}",
@@ -751,6 +1857,38 @@ auto VM::binary_ge(const Value& a, const Value& b) -> Value {
     return Value(a >= b);
 }
 
+// Comparison fused into COMPARE_JUMP_IF_FALSE. Typed and generic forms of
+// the same comparison agree, so only the relation matters here.
+auto VM::compare_ints(OpCode compare, int64_t a, int64_t b) -> bool {
+    switch (compare) {
+        case OpCode::EQ: case OpCode::EQ_INT: return a == b;
+        case OpCode::NE: case OpCode::NE_INT: return a != b;
+        case OpCode::LT: case OpCode::LT_INT: case OpCode::LT_FLOAT: return a < b;
+        case OpCode::GT: case OpCode::GT_INT: case OpCode::GT_FLOAT: return a > b;
+        case OpCode::LE: case OpCode::LE_INT: case OpCode::LE_FLOAT: return a <= b;
+        case OpCode::GE: case OpCode::GE_INT: case OpCode::GE_FLOAT: return a >= b;
+        default: break;
+    }
+    throw std::runtime_error(fmt::format(
+        "Invalid comparison for COMPARE_JUMP_IF_FALSE: {}", opcode_name(compare)
+    ));
+}
+
+auto VM::compare_values(OpCode compare, const Value& a, const Value& b) -> bool {
+    switch (compare) {
+        case OpCode::EQ: case OpCode::EQ_INT: return a == b;
+        case OpCode::NE: case OpCode::NE_INT: return a != b;
+        case OpCode::LT: case OpCode::LT_INT: case OpCode::LT_FLOAT: return a < b;
+        case OpCode::GT: case OpCode::GT_INT: case OpCode::GT_FLOAT: return a > b;
+        case OpCode::LE: case OpCode::LE_INT: case OpCode::LE_FLOAT: return a <= b;
+        case OpCode::GE: case OpCode::GE_INT: case OpCode::GE_FLOAT: return a >= b;
+        default: break;
+    }
+    throw std::runtime_error(fmt::format(
+        "Invalid comparison for COMPARE_JUMP_IF_FALSE: {}", opcode_name(compare)
+    ));
+}
+
 // === Logical Operations ===
 
 auto VM::binary_and(const Value& a, const Value& b) -> Value {
@@ -769,7 +1907,7 @@ auto VM::unary_not(const Value& a) -> Value {
 
 auto VM::unary_negate(const Value& a) -> Value {
     if (a.is_int()) {
-        return Value(-a.as_int());
+        return Value(int_negate(a.as_int()));
     }
     if (a.is_float()) {
         return Value(-a.as_float());
@@ -792,224 +1930,16 @@ auto VM::unary_positive(const Value& a) -> Value {
 
 // === Built-in Methods ===
 
-auto VM::call_builtin_method(const std::string& method,
-                             Value& object,
-                             std::vector<Value> args) -> Value {
-    // List methods
-    if (object.is_list()) {
-        if (method == "length") {
-            if (!args.empty()) {
-                throw std::runtime_error("List.length() takes no arguments");
-            }
-            return Value(static_cast<int64_t>(object.as_list().size()));
-        }
-        if (method == "append") {
-            if (args.size() != 1) {
-                throw std::runtime_error("List.append() takes exactly 1 argument");
-            }
-            // Create a new list with the element appended (immutable)
-            std::vector<Value> new_list = object.as_list();
-            new_list.push_back(std::move(args[0]));
-            return Value(std::move(new_list), false);  // false = list
-        }
-        if (method == "head") {
-            if (!args.empty()) {
-                throw std::runtime_error("List.head() takes no arguments");
-            }
-            const auto& list = object.as_list();
-            if (list.empty()) {
-                throw std::runtime_error("List.head() on empty list");
-            }
-            return list[0];
-        }
-        if (method == "tail") {
-            if (!args.empty()) {
-                throw std::runtime_error("List.tail() takes no arguments");
-            }
-            const auto& list = object.as_list();
-            if (list.empty()) {
-                throw std::runtime_error("List.tail() on empty list");
-            }
-            std::vector<Value> new_list(list.begin() + 1, list.end());
-            return Value(std::move(new_list), false);  // false = list
-        }
-        if (method == "is_empty") {
-            if (!args.empty()) {
-                throw std::runtime_error("List.is_empty() takes no arguments");
-            }
-            return Value(object.as_list().empty());
-        }
-        if (method == "reverse") {
-            if (!args.empty()) {
-                throw std::runtime_error("List.reverse() takes no arguments");
-            }
-            std::vector<Value> new_list = object.as_list();
-            std::reverse(new_list.begin(), new_list.end());
-            return Value(std::move(new_list), false);  // false = list
-        }
-        if (method == "concat") {
-            if (args.size() != 1 || !args[0].is_list()) {
-                throw std::runtime_error("List.concat() takes 1 list argument");
-            }
-            std::vector<Value> new_list = object.as_list();
-            const auto& other = args[0].as_list();
-            new_list.insert(new_list.end(), other.begin(), other.end());
-            return Value(std::move(new_list), false);  // false = list
-        }
-        throw std::runtime_error(fmt::format(
-            "Unknown method '{}' on List", method
-        ));
-    }
-
-    // Tuple methods
-    if (object.is_tuple()) {
-        if (method == "length") {
-            if (!args.empty()) {
-                throw std::runtime_error("Tuple.length() takes no arguments");
-            }
-            return Value(static_cast<int64_t>(object.as_tuple().size()));
-        }
-        throw std::runtime_error(fmt::format(
-            "Unknown method '{}' on Tuple", method
-        ));
-    }
-
-    // String methods
-    if (object.is_string()) {
-        if (method == "length") {
-            if (!args.empty()) {
-                throw std::runtime_error("String.length() takes no arguments");
-            }
-            return Value(static_cast<int64_t>(object.as_string().size()));
-        }
-        if (method == "is_empty") {
-            if (!args.empty()) {
-                throw std::runtime_error("String.is_empty() takes no arguments");
-            }
-            return Value(object.as_string().empty());
-        }
-        if (method == "contains") {
-            if (args.size() != 1 || !args[0].is_string()) {
-                throw std::runtime_error("String.contains() takes 1 string argument");
-            }
-            return Value(object.as_string().find(args[0].as_string()) != std::string::npos);
-        }
-        if (method == "starts_with") {
-            if (args.size() != 1 || !args[0].is_string()) {
-                throw std::runtime_error("String.starts_with() takes 1 string argument");
-            }
-            const auto& str = object.as_string();
-            const auto& prefix = args[0].as_string();
-            return Value(str.size() >= prefix.size() &&
-                        str.compare(0, prefix.size(), prefix) == 0);
-        }
-        if (method == "ends_with") {
-            if (args.size() != 1 || !args[0].is_string()) {
-                throw std::runtime_error("String.ends_with() takes 1 string argument");
-            }
-            const auto& str = object.as_string();
-            const auto& suffix = args[0].as_string();
-            return Value(str.size() >= suffix.size() &&
-                        str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0);
-        }
-        if (method == "to_upper") {
-            if (!args.empty()) {
-                throw std::runtime_error("String.to_upper() takes no arguments");
-            }
-            std::string result = object.as_string();
-            std::transform(result.begin(), result.end(), result.begin(),
-                          [](unsigned char c) { return std::toupper(c); });
-            return Value(std::move(result));
-        }
-        if (method == "to_lower") {
-            if (!args.empty()) {
-                throw std::runtime_error("String.to_lower() takes no arguments");
-            }
-            std::string result = object.as_string();
-            std::transform(result.begin(), result.end(), result.begin(),
-                          [](unsigned char c) { return std::tolower(c); });
-            return Value(std::move(result));
-        }
-        if (method == "trim") {
-            if (!args.empty()) {
-                throw std::runtime_error("String.trim() takes no arguments");
-            }
-            std::string result = object.as_string();
-            // Trim leading whitespace
-            auto start = result.find_first_not_of(" \t\n\r");
-            if (start == std::string::npos) {
-                return Value(std::string{});
-            }
-            // Trim trailing whitespace
-            auto end = result.find_last_not_of(" \t\n\r");
-            return Value(result.substr(start, end - start + 1));
-        }
-        throw std::runtime_error(fmt::format(
-            "Unknown method '{}' on String", method
-        ));
-    }
-
-    // Int methods
-    if (object.is_int()) {
-        if (method == "to_string") {
-            if (!args.empty()) {
-                throw std::runtime_error("Int.to_string() takes no arguments");
-            }
-            return Value(std::to_string(object.as_int()));
-        }
-        if (method == "abs") {
-            if (!args.empty()) {
-                throw std::runtime_error("Int.abs() takes no arguments");
-            }
-            int64_t val = object.as_int();
-            return Value(val < 0 ? -val : val);
-        }
-        throw std::runtime_error(fmt::format(
-            "Unknown method '{}' on Int", method
-        ));
-    }
-
-    // Float methods
-    if (object.is_float()) {
-        if (method == "to_string") {
-            if (!args.empty()) {
-                throw std::runtime_error("Float.to_string() takes no arguments");
-            }
-            return Value(fmt::format("{}", object.as_float()));
-        }
-        if (method == "abs") {
-            if (!args.empty()) {
-                throw std::runtime_error("Float.abs() takes no arguments");
-            }
-            return Value(std::abs(object.as_float()));
-        }
-        if (method == "floor") {
-            if (!args.empty()) {
-                throw std::runtime_error("Float.floor() takes no arguments");
-            }
-            return Value(static_cast<int64_t>(std::floor(object.as_float())));
-        }
-        if (method == "ceil") {
-            if (!args.empty()) {
-                throw std::runtime_error("Float.ceil() takes no arguments");
-            }
-            return Value(static_cast<int64_t>(std::ceil(object.as_float())));
-        }
-        if (method == "round") {
-            if (!args.empty()) {
-                throw std::runtime_error("Float.round() takes no arguments");
-            }
-            return Value(static_cast<int64_t>(std::round(object.as_float())));
-        }
-        throw std::runtime_error(fmt::format(
-            "Unknown method '{}' on Float", method
-        ));
+// Resolve a CALL_METHOD name constant to its MethodId, once per constant
+auto VM::resolve_method(uint16_t name_idx) -> uint8_t {
+    const Value& name_val = constants_[name_idx];
+    if (!name_val.is_string()) {
+        throw std::runtime_error("Method name must be a string");
     }
-
-    throw std::runtime_error(fmt::format(
-        "Cannot call method '{}' on {}",
-        method, object.type_name()
-    ));
+    auto id = method_id_from_name(name_val.as_string());
+    uint8_t resolved = id ? static_cast<uint8_t>(*id) : kUnknownMethod;
+    method_cache_[name_idx] = resolved;
+    return resolved;
 }
 
 } // namespace lucid::backend
@@ -0,0 +1,86 @@
+#include <lucid/backend/vm_pool.hpp>
+#include <algorithm>
+#include <thread>
+#include <utility>
+
+namespace lucid::backend {
+
+VMPool::VMPool(std::shared_ptr<const Bytecode> program, size_t size)
+    : program_(std::move(program))
+    , size_(size == 0 ? std::max<size_t>(std::thread::hardware_concurrency(), 1) : size)
+{
+    idle_.reserve(size_);
+    for (size_t i = 0; i < size_; ++i) {
+        auto vm = std::make_unique<VM>();
+        vm->load(program_);
+        idle_.push_back(std::move(vm));
+    }
+}
+
+auto VMPool::acquire() -> Lease {
+    std::unique_lock lock(mutex_);
+    released_.wait(lock, [this] { return !idle_.empty(); });
+    auto vm = std::move(idle_.back());
+    idle_.pop_back();
+    return Lease(this, std::move(vm));
+}
+
+auto VMPool::call_batch(FunctionHandle function, std::span<const Value> args, ThreadPool& threads)
+    -> std::vector<Value> {
+    const size_t arity = function.param_count;
+    if (arity == 0 || args.size() % arity != 0 || threads.size() == 1) {
+        return acquire()->call_batch(function, args);  // Including its errors
+    }
+
+    // A few tasks per thread so that stealing evens out slow calls
+    const size_t calls = args.size() / arity;
+    const size_t tasks = std::min(calls, threads.size() * 4);
+    std::vector<Value> results(calls);
+    threads.parallel_for(tasks, [&](size_t task) {
+        const size_t begin = task * calls / tasks;
+        const size_t end = (task + 1) * calls / tasks;
+
+        std::vector<Value> share;
+        share.reserve((end - begin) * arity);
+        for (const auto& arg : args.subspan(begin * arity, (end - begin) * arity)) {
+            share.push_back(arg.deep_copy());
+        }
+        auto part = acquire()->call_batch(function, share);
+        std::move(part.begin(), part.end(), results.begin() + static_cast<std::ptrdiff_t>(begin));
+    });
+    return results;
+}
+
+auto VMPool::release(std::unique_ptr<VM> vm) -> void {
+    {
+        std::lock_guard lock(mutex_);
+        idle_.push_back(std::move(vm));
+    }
+    released_.notify_one();
+}
+
+// ===== Lease =====
+
+VMPool::Lease::Lease(Lease&& other) noexcept
+    : pool_(std::exchange(other.pool_, nullptr))
+    , vm_(std::move(other.vm_))
+{}
+
+VMPool::Lease& VMPool::Lease::operator=(Lease&& other) noexcept {
+    if (this != &other) {
+        if (vm_) {
+            pool_->release(std::move(vm_));
+        }
+        pool_ = std::exchange(other.pool_, nullptr);
+        vm_ = std::move(other.vm_);
+    }
+    return *this;
+}
+
+VMPool::Lease::~Lease() {
+    if (vm_) {
+        pool_->release(std::move(vm_));
+    }
+}
+
+} // namespace lucid::backend
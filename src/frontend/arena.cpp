@@ -0,0 +1,78 @@
+#include <lucid/frontend/arena.hpp>
+#include <new>
+
+namespace lucid {
+
+namespace {
+
+constexpr size_t kAlignment = alignof(std::max_align_t);
+
+thread_local Arena* current_arena = nullptr;
+
+constexpr auto align_up(size_t size) -> size_t {
+    return (size + kAlignment - 1) & ~(kAlignment - 1);
+}
+
+// Each ArenaNode allocation starts with the arena it came from (nullptr for
+// the heap), padded so the node itself stays aligned
+constexpr size_t kHeaderSize = align_up(sizeof(Arena*));
+
+} // namespace
+
+// ===== Arena =====
+
+Arena::~Arena() = default;
+
+auto Arena::allocate(size_t size) -> void* {
+    size = align_up(size);
+    if (static_cast<size_t>(end_ - next_) < size) {
+        // Oversized requests get a chunk of their own, so the rest of the
+        // current chunk is not wasted
+        if (size > kChunkSize / 4) {
+            chunks_.push_back(std::make_unique_for_overwrite<std::byte[]>(size));
+            bytes_allocated_ += size;
+            return chunks_.back().get();
+        }
+        chunks_.push_back(std::make_unique_for_overwrite<std::byte[]>(kChunkSize));
+        next_ = chunks_.back().get();
+        end_ = next_ + kChunkSize;
+    }
+    void* block = next_;
+    next_ += size;
+    bytes_allocated_ += size;
+    return block;
+}
+
+auto Arena::current() -> Arena* {
+    return current_arena;
+}
+
+ArenaScope::ArenaScope(Arena& arena) : previous_(current_arena) {
+    current_arena = &arena;
+}
+
+ArenaScope::~ArenaScope() {
+    current_arena = previous_;
+}
+
+// ===== Arena Nodes =====
+
+auto ArenaNode::operator new(size_t size) -> void* {
+    Arena* arena = current_arena;
+    void* block = arena != nullptr ? arena->allocate(kHeaderSize + size)
+                                   : ::operator new(kHeaderSize + size);
+    *static_cast<Arena**>(block) = arena;
+    return static_cast<std::byte*>(block) + kHeaderSize;
+}
+
+auto ArenaNode::operator delete(void* pointer) noexcept -> void {
+    if (pointer == nullptr) {
+        return;
+    }
+    auto* block = static_cast<std::byte*>(pointer) - kHeaderSize;
+    if (*reinterpret_cast<Arena**>(block) == nullptr) {
+        ::operator delete(block);
+    }
+}
+
+} // namespace lucid
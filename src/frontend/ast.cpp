@@ -1,4 +1,5 @@
 #include <lucid/frontend/ast.hpp>
+#include <algorithm>
 
 namespace lucid::ast {
 
@@ -160,4 +161,100 @@ auto unary_op_name(UnaryOp op) -> std::string_view {
     }
 }
 
+// ===== Name collection =====
+
+namespace {
+
+auto collect_identifiers(const Stmt& stmt, std::vector<const IdentifierExpr*>& names) -> void {
+    switch (stmt.kind) {
+        case StmtKind::Let:
+            collect_identifiers(*static_cast<const LetStmt&>(stmt).initializer, names);
+            break;
+        case StmtKind::Return:
+            collect_identifiers(*static_cast<const ReturnStmt&>(stmt).value, names);
+            break;
+        case StmtKind::ExprStmt:
+            collect_identifiers(*static_cast<const ExprStmt&>(stmt).expression, names);
+            break;
+    }
+}
+
+} // namespace
+
+auto collect_identifiers(const Expr& expr, std::vector<const IdentifierExpr*>& names) -> void {
+    auto all = [&](const std::vector<std::unique_ptr<Expr>>& exprs) {
+        for (const auto& element : exprs) {
+            collect_identifiers(*element, names);
+        }
+    };
+    switch (expr.kind) {
+        case ExprKind::Identifier: {
+            const auto& identifier = static_cast<const IdentifierExpr&>(expr);
+            auto same = [&](const IdentifierExpr* seen) {
+                return seen->id != kNoName && identifier.id != kNoName ? seen->id == identifier.id
+                                                                       : seen->name == identifier.name;
+            };
+            if (std::none_of(names.begin(), names.end(), same)) {
+                names.push_back(&identifier);
+            }
+            break;
+        }
+        case ExprKind::Tuple:
+            all(static_cast<const TupleExpr&>(expr).elements);
+            break;
+        case ExprKind::List:
+            all(static_cast<const ListExpr&>(expr).elements);
+            break;
+        case ExprKind::Binary: {
+            const auto& binary = static_cast<const BinaryExpr&>(expr);
+            collect_identifiers(*binary.left, names);
+            collect_identifiers(*binary.right, names);
+            break;
+        }
+        case ExprKind::Unary:
+            collect_identifiers(*static_cast<const UnaryExpr&>(expr).operand, names);
+            break;
+        case ExprKind::Call: {
+            const auto& call = static_cast<const CallExpr&>(expr);
+            collect_identifiers(*call.callee, names);
+            all(call.arguments);
+            break;
+        }
+        case ExprKind::MethodCall: {
+            const auto& call = static_cast<const MethodCallExpr&>(expr);
+            collect_identifiers(*call.object, names);
+            all(call.arguments);
+            break;
+        }
+        case ExprKind::Index: {
+            const auto& index = static_cast<const IndexExpr&>(expr);
+            collect_identifiers(*index.object, names);
+            collect_identifiers(*index.index, names);
+            break;
+        }
+        case ExprKind::Lambda:
+            collect_identifiers(*static_cast<const LambdaExpr&>(expr).body, names);
+            break;
+        case ExprKind::If: {
+            const auto& if_expr = static_cast<const IfExpr&>(expr);
+            collect_identifiers(*if_expr.condition, names);
+            collect_identifiers(*if_expr.then_branch, names);
+            if (if_expr.else_branch.has_value()) {
+                collect_identifiers(**if_expr.else_branch, names);
+            }
+            break;
+        }
+        case ExprKind::Block:
+            for (const auto& stmt : static_cast<const BlockExpr&>(expr).statements) {
+                collect_identifiers(*stmt, names);
+            }
+            break;
+        case ExprKind::IntLiteral:
+        case ExprKind::FloatLiteral:
+        case ExprKind::StringLiteral:
+        case ExprKind::BoolLiteral:
+            break;
+    }
+}
+
 } // namespace lucid::ast
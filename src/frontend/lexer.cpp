@@ -1,12 +1,267 @@
 #include <lucid/frontend/lexer.hpp>
 #include <lucid/frontend/token.hpp>
+#include <array>
+#include <bit>
 #include <charconv>
-#include <unordered_map>
+#include <cstdint>
 #include <string>
 #include <cctype>
 
+#if defined(__SSE2__)
+    #include <emmintrin.h>
+#elif defined(__ARM_NEON)
+    #include <arm_neon.h>
+#endif
+
 namespace lucid {
 
+namespace {
+
+// ===== Keyword table =====
+//
+// Keywords are found with a perfect hash generated at compile time: the
+// hash of a word's length, first two and last characters gives each
+// keyword a slot of its own, so classifying an identifier is one hash and
+// at most one string comparison.
+
+struct Keyword {
+    std::string_view text;
+    TokenType type;
+};
+
+constexpr std::array<Keyword, 17> kKeywords = {{
+    {"function", TokenType::Function},
+    {"returns", TokenType::Returns},
+    {"let", TokenType::Let},
+    {"if", TokenType::If},
+    {"else", TokenType::Else},
+    {"return", TokenType::Return},
+    {"lambda", TokenType::Lambda},
+    {"Int", TokenType::TypeInt},
+    {"Float", TokenType::TypeFloat},
+    {"String", TokenType::TypeString},
+    {"Bool", TokenType::TypeBool},
+    {"List", TokenType::TypeList},
+    {"true", TokenType::True},
+    {"false", TokenType::False},
+    {"and", TokenType::And},
+    {"or", TokenType::Or},
+    {"not", TokenType::Not},
+}};
+
+constexpr size_t kMinKeywordLength = 2;
+constexpr size_t kMaxKeywordLength = 8;
+constexpr unsigned kKeywordSlotBits = 6;
+
+constexpr auto keyword_hash(std::string_view word, uint32_t seed) -> size_t {
+    constexpr uint32_t kPrime = 0x01000193;  // FNV-1a
+    uint32_t hash = seed;
+    hash = (hash ^ static_cast<uint8_t>(word[0])) * kPrime;
+    hash = (hash ^ static_cast<uint8_t>(word[1])) * kPrime;
+    hash = (hash ^ static_cast<uint8_t>(word.back())) * kPrime;
+    hash = (hash ^ static_cast<uint32_t>(word.size())) * kPrime;
+    return hash >> (32 - kKeywordSlotBits);
+}
+
+// The first seed under which no two keywords share a slot
+consteval auto find_keyword_seed() -> uint32_t {
+    for (uint32_t seed = 1; seed < 100'000; ++seed) {
+        std::array<bool, size_t{1} << kKeywordSlotBits> used{};
+        bool collision = false;
+        for (const auto& keyword : kKeywords) {
+            auto slot = keyword_hash(keyword.text, seed);
+            collision = collision || used[slot];
+            used[slot] = true;
+        }
+        if (!collision) {
+            return seed;
+        }
+    }
+    return 0;
+}
+
+constexpr uint32_t kKeywordSeed = find_keyword_seed();
+static_assert(kKeywordSeed != 0, "no perfect hash seed for the keyword set");
+
+// Slot -> index into kKeywords plus one, or 0 for no keyword
+constexpr auto kKeywordSlots = [] {
+    std::array<uint8_t, size_t{1} << kKeywordSlotBits> slots{};
+    for (size_t i = 0; i < kKeywords.size(); ++i) {
+        slots[keyword_hash(kKeywords[i].text, kKeywordSeed)] = static_cast<uint8_t>(i + 1);
+    }
+    return slots;
+}();
+
+// ===== Block scanning =====
+//
+// The scanners compare 16 source bytes at a time and reduce each byte class
+// to a bitmask with kMaskBits bits per byte: SSE2 on x86-64, NEON on ARM, a
+// plain loop elsewhere. The last bytes of the source, fewer than a block,
+// are handled one at a time.
+
+constexpr size_t kBlockSize = 16;
+
+#if defined(__SSE2__)
+
+using Block = __m128i;
+constexpr unsigned kMaskBits = 1;
+
+inline auto load_block(const char* bytes) -> Block {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes));
+}
+inline auto bytes_equal(Block block, char c) -> Block {
+    return _mm_cmpeq_epi8(block, _mm_set1_epi8(c));
+}
+// lo <= byte <= hi, for ASCII bounds (bytes >= 0x80 compare as negative)
+inline auto bytes_between(Block block, char lo, char hi) -> Block {
+    return _mm_and_si128(_mm_cmpgt_epi8(block, _mm_set1_epi8(static_cast<char>(lo - 1))),
+                         _mm_cmplt_epi8(block, _mm_set1_epi8(static_cast<char>(hi + 1))));
+}
+inline auto either(Block a, Block b) -> Block { return _mm_or_si128(a, b); }
+inline auto set_bit_5(Block block) -> Block { return _mm_or_si128(block, _mm_set1_epi8(0x20)); }
+inline auto to_mask(Block block) -> uint64_t {
+    return static_cast<uint32_t>(_mm_movemask_epi8(block));
+}
+
+#elif defined(__ARM_NEON)
+
+using Block = uint8x16_t;
+constexpr unsigned kMaskBits = 4;
+
+inline auto load_block(const char* bytes) -> Block {
+    return vld1q_u8(reinterpret_cast<const uint8_t*>(bytes));
+}
+inline auto bytes_equal(Block block, char c) -> Block {
+    return vceqq_u8(block, vdupq_n_u8(static_cast<uint8_t>(c)));
+}
+inline auto bytes_between(Block block, char lo, char hi) -> Block {
+    return vandq_u8(vcgeq_u8(block, vdupq_n_u8(static_cast<uint8_t>(lo))),
+                    vcleq_u8(block, vdupq_n_u8(static_cast<uint8_t>(hi))));
+}
+inline auto either(Block a, Block b) -> Block { return vorrq_u8(a, b); }
+inline auto set_bit_5(Block block) -> Block { return vorrq_u8(block, vdupq_n_u8(0x20)); }
+// NEON has no movemask; narrowing each 16-bit lane by 4 leaves a nibble per byte
+inline auto to_mask(Block block) -> uint64_t {
+    return vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(block), 4)), 0);
+}
+
+#else
+
+struct Block {
+    std::array<uint8_t, kBlockSize> bytes;
+};
+constexpr unsigned kMaskBits = 1;
+
+template <typename Predicate>
+inline auto bytes_where(const Block& block, Predicate predicate) -> Block {
+    Block result{};
+    for (size_t i = 0; i < kBlockSize; ++i) {
+        result.bytes[i] = predicate(block.bytes[i]) ? 0xFF : 0;
+    }
+    return result;
+}
+inline auto load_block(const char* bytes) -> Block {
+    Block block;
+    for (size_t i = 0; i < kBlockSize; ++i) {
+        block.bytes[i] = static_cast<uint8_t>(bytes[i]);
+    }
+    return block;
+}
+inline auto bytes_equal(const Block& block, char c) -> Block {
+    return bytes_where(block, [c](uint8_t byte) { return byte == static_cast<uint8_t>(c); });
+}
+inline auto bytes_between(const Block& block, char lo, char hi) -> Block {
+    return bytes_where(block, [lo, hi](uint8_t byte) {
+        return byte >= static_cast<uint8_t>(lo) && byte <= static_cast<uint8_t>(hi);
+    });
+}
+inline auto either(const Block& a, const Block& b) -> Block {
+    Block result;
+    for (size_t i = 0; i < kBlockSize; ++i) {
+        result.bytes[i] = a.bytes[i] | b.bytes[i];
+    }
+    return result;
+}
+inline auto set_bit_5(const Block& block) -> Block {
+    Block result;
+    for (size_t i = 0; i < kBlockSize; ++i) {
+        result.bytes[i] = static_cast<uint8_t>(block.bytes[i] | 0x20);
+    }
+    return result;
+}
+inline auto to_mask(const Block& block) -> uint64_t {
+    uint64_t mask = 0;
+    for (size_t i = 0; i < kBlockSize; ++i) {
+        mask |= static_cast<uint64_t>(block.bytes[i] & 1) << i;
+    }
+    return mask;
+}
+
+#endif
+
+constexpr uint64_t kBlockMask = kMaskBits * kBlockSize == 64 ? ~uint64_t{0}
+                                                             : (uint64_t{1} << (kMaskBits * kBlockSize)) - 1;
+
+// Position of the first / last byte set in a non-empty mask, and the count
+inline auto first_byte(uint64_t mask) -> size_t {
+    return static_cast<size_t>(std::countr_zero(mask)) / kMaskBits;
+}
+inline auto last_byte(uint64_t mask) -> size_t {
+    return static_cast<size_t>(63 - std::countl_zero(mask)) / kMaskBits;
+}
+inline auto byte_count(uint64_t mask) -> size_t {
+    return static_cast<size_t>(std::popcount(mask)) / kMaskBits;
+}
+// The bytes before `count`
+inline auto prefix_mask(size_t count) -> uint64_t {
+    return count * kMaskBits >= 64 ? ~uint64_t{0} : (uint64_t{1} << (count * kMaskBits)) - 1;
+}
+
+inline auto is_identifier_char(char c) -> bool {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+// Position of the first byte from `pos` on matching `block_match` (per
+// block) / `byte_match` (per byte), or `end`
+template <typename BlockMatch, typename ByteMatch>
+auto find_first(std::string_view source, size_t pos, BlockMatch block_match, ByteMatch byte_match)
+    -> size_t {
+    const char* data = source.data();
+    size_t end = source.size();
+    for (; pos + kBlockSize <= end; pos += kBlockSize) {
+        uint64_t mask = to_mask(block_match(load_block(data + pos)));
+        if (mask != 0) {
+            return pos + first_byte(mask);
+        }
+    }
+    while (pos < end && !byte_match(data[pos])) {
+        ++pos;
+    }
+    return pos;
+}
+
+// End of the identifier characters starting at `pos`
+auto identifier_end(std::string_view source, size_t pos) -> size_t {
+    const char* data = source.data();
+    size_t end = source.size();
+    for (; pos + kBlockSize <= end; pos += kBlockSize) {
+        Block block = load_block(data + pos);
+        Block word = either(either(bytes_between(set_bit_5(block), 'a', 'z'),
+                                   bytes_between(block, '0', '9')),
+                            bytes_equal(block, '_'));
+        uint64_t other = ~to_mask(word) & kBlockMask;
+        if (other != 0) {
+            return pos + first_byte(other);
+        }
+    }
+    while (pos < end && is_identifier_char(data[pos])) {
+        ++pos;
+    }
+    return pos;
+}
+
+} // namespace
+
 // ===== Token type name utility =====
 
 auto token_type_name(TokenType type) -> std::string_view {
@@ -66,14 +321,23 @@ auto token_type_name(TokenType type) -> std::string_view {
 Lexer::Lexer(std::string_view source, std::string_view filename)
     : source_(source), filename_(filename) {}
 
+Lexer::Lexer(std::string_view source, std::string_view filename, size_t begin, size_t line)
+    : source_(source), filename_(filename), current_(begin), line_(line) {
+    const size_t newline = begin == 0 ? std::string_view::npos : source.rfind('\n', begin - 1);
+    line_start_ = newline == std::string_view::npos ? 0 : newline + 1;
+}
+
 auto Lexer::tokenize() -> std::vector<Token> {
+    // Typical sources average about eight bytes per token; starting near
+    // the final size saves most of the regrowth copies
     std::vector<Token> tokens;
+    tokens.reserve(source_.size() / 8 + 1);
 
     while (!is_at_end()) {
-        Token token = next_token();
-        tokens.push_back(token);
+        tokens.push_back(next_token());
 
-        if (token.type == TokenType::Eof || token.type == TokenType::Error) {
+        TokenType type = tokens.back().type;
+        if (type == TokenType::Eof || type == TokenType::Error) {
             break;
         }
     }
@@ -125,57 +389,85 @@ auto Lexer::match(char expected) -> bool {
 // ===== Token creation =====
 
 auto Lexer::make_token(TokenType type) -> Token {
-    size_t length = current_ - start_;
-    std::string_view lexeme = source_.substr(start_, length);
-    size_t column = start_ - line_start_ + 1;
-
-    SourceLocation loc(filename_, line_, column, start_, length);
-    return Token(type, lexeme, loc);
+    Token token;
+    token.type = type;
+    token.offset = static_cast<uint32_t>(start_);
+    token.length = static_cast<uint32_t>(current_ - start_);
+    token.line = static_cast<uint32_t>(line_);
+    token.column = static_cast<uint32_t>(start_ - line_start_ + 1);
+    return token;
 }
 
 auto Lexer::make_token(TokenType type, int64_t value) -> Token {
-    size_t length = current_ - start_;
-    std::string_view lexeme = source_.substr(start_, length);
-    size_t column = start_ - line_start_ + 1;
-
-    SourceLocation loc(filename_, line_, column, start_, length);
-    return Token(type, lexeme, loc, value);
+    Token token = make_token(type);
+    token.literal = add_literal(value);
+    return token;
 }
 
 auto Lexer::make_token(TokenType type, double value) -> Token {
-    size_t length = current_ - start_;
-    std::string_view lexeme = source_.substr(start_, length);
-    size_t column = start_ - line_start_ + 1;
-
-    SourceLocation loc(filename_, line_, column, start_, length);
-    return Token(type, lexeme, loc, value);
+    Token token = make_token(type);
+    token.literal = add_literal(value);
+    return token;
 }
 
 auto Lexer::make_token(TokenType type, std::string value) -> Token {
-    size_t length = current_ - start_;
-    std::string_view lexeme = source_.substr(start_, length);
-    size_t column = start_ - line_start_ + 1;
-
-    SourceLocation loc(filename_, line_, column, start_, length);
-    return Token(type, lexeme, loc, std::move(value));
+    Token token = make_token(type);
+    token.literal = add_literal(std::move(value));
+    return token;
 }
 
 auto Lexer::error_token(std::string_view message) -> Token {
-    size_t length = current_ - start_;
-    size_t column = start_ - line_start_ + 1;
+    return make_token(TokenType::Error, std::string(message));
+}
+
+auto Lexer::add_literal(Literal value) -> uint32_t {
+    literals_.push_back(std::move(value));
+    return static_cast<uint32_t>(literals_.size() - 1);
+}
+
+// ===== Token details =====
 
-    SourceLocation loc(filename_, line_, column, start_, length);
-    return Token(TokenType::Error, "", loc, std::string(message));
+auto Lexer::lexeme(const Token& token) const -> std::string_view {
+    return source_.substr(token.offset, token.length);
 }
 
-auto Lexer::current_location(size_t start_offset, size_t length) -> SourceLocation {
-    size_t column = start_offset - line_start_ + 1;
-    return SourceLocation(filename_, line_, column, start_offset, length);
+auto Lexer::location(const Token& token) const -> SourceLocation {
+    return SourceLocation(filename_, token.line, token.column, token.offset, token.length);
+}
+
+auto Lexer::literal(const Token& token) const -> const Literal& {
+    return literals_[token.literal];
+}
+
+auto Lexer::name(const Token& token) const -> NameId {
+    return token.type == TokenType::Identifier ? token.literal : kNoName;
 }
 
 // ===== Whitespace and comments =====
 
 auto Lexer::skip_whitespace() -> void {
+    // Whole blocks of blanks at a time, counting the newlines among them
+    const char* data = source_.data();
+    while (current_ + kBlockSize <= source_.size()) {
+        Block block = load_block(data + current_);
+        uint64_t newlines = to_mask(bytes_equal(block, '\n'));
+        uint64_t blanks = newlines | to_mask(either(either(bytes_equal(block, ' '),
+                                                            bytes_equal(block, '\t')),
+                                                     bytes_equal(block, '\r')));
+        uint64_t other = ~blanks & kBlockMask;
+        size_t run = other != 0 ? first_byte(other) : kBlockSize;
+
+        newlines &= prefix_mask(run);
+        if (newlines != 0) {
+            line_ += byte_count(newlines);
+            line_start_ = current_ + last_byte(newlines) + 1;
+        }
+        current_ += run;
+        if (other != 0) {
+            return;
+        }
+    }
+
     while (!is_at_end()) {
         char c = peek();
 
@@ -200,16 +492,26 @@ auto Lexer::skip_whitespace() -> void {
 
 auto Lexer::skip_comment() -> void {
     // Skip until end of line
-    while (!is_at_end() && peek() != '\n') {
-        advance();
-    }
+    current_ = find_first(source_, current_,
+                          [](Block block) { return bytes_equal(block, '\n'); },
+                          [](char c) { return c == '\n'; });
 }
 
 auto Lexer::skip_multiline_comment() -> void {
     // Already consumed '#['
     int depth = 1;  // For potential nesting support later
 
-    while (!is_at_end() && depth > 0) {
+    while (depth > 0) {
+        // Only ']' and newlines matter inside the comment
+        current_ = find_first(source_, current_,
+                              [](Block block) {
+                                  return either(bytes_equal(block, ']'), bytes_equal(block, '\n'));
+                              },
+                              [](char c) { return c == ']' || c == '\n'; });
+        if (is_at_end()) {
+            break;
+        }
+
         if (peek() == ']' && peek_next() == '#') {
             advance();  // consume ']'
             advance();  // consume '#'
@@ -241,28 +543,13 @@ auto Lexer::is_alnum(char c) -> bool {
 // ===== Keyword recognition =====
 
 auto Lexer::identifier_type(std::string_view lexeme) -> TokenType {
-    static const std::unordered_map<std::string_view, TokenType> keywords = {
-        {"function", TokenType::Function},
-        {"returns", TokenType::Returns},
-        {"let", TokenType::Let},
-        {"if", TokenType::If},
-        {"else", TokenType::Else},
-        {"return", TokenType::Return},
-        {"lambda", TokenType::Lambda},
-        {"Int", TokenType::TypeInt},
-        {"Float", TokenType::TypeFloat},
-        {"String", TokenType::TypeString},
-        {"Bool", TokenType::TypeBool},
-        {"List", TokenType::TypeList},
-        {"true", TokenType::True},
-        {"false", TokenType::False},
-        {"and", TokenType::And},
-        {"or", TokenType::Or},
-        {"not", TokenType::Not},
-    };
-
-    if (auto it = keywords.find(lexeme); it != keywords.end()) {
-        return it->second;
+    if (lexeme.size() < kMinKeywordLength || lexeme.size() > kMaxKeywordLength) {
+        return TokenType::Identifier;
+    }
+
+    uint8_t slot = kKeywordSlots[keyword_hash(lexeme, kKeywordSeed)];
+    if (slot != 0 && kKeywords[slot - 1].text == lexeme) {
+        return kKeywords[slot - 1].type;
     }
 
     return TokenType::Identifier;
@@ -272,14 +559,17 @@ auto Lexer::identifier_type(std::string_view lexeme) -> TokenType {
 
 auto Lexer::scan_identifier() -> Token {
     // Scan [a-zA-Z_][a-zA-Z0-9_]*
-    while (is_alnum(peek()) || peek() == '_') {
-        advance();
-    }
+    current_ = identifier_end(source_, current_);
 
     std::string_view lexeme = source_.substr(start_, current_ - start_);
     TokenType type = identifier_type(lexeme);
 
-    return make_token(type);
+    Token token = make_token(type);
+    if (type == TokenType::Identifier) {
+        auto [name, inserted] = names_.try_emplace(lexeme, static_cast<NameId>(names_.size()));
+        token.literal = name->second;
+    }
+    return token;
 }
 
 auto Lexer::scan_number() -> Token {
@@ -356,7 +646,21 @@ auto Lexer::scan_string() -> Token {
     // Already consumed opening '"'
     std::string value;
 
-    while (!is_at_end() && peek() != '"') {
+    while (true) {
+        // Copy the run up to the next character needing attention
+        size_t run_end = find_first(source_, current_,
+                                    [](Block block) {
+                                        return either(either(bytes_equal(block, '"'),
+                                                             bytes_equal(block, '\\')),
+                                                      bytes_equal(block, '\n'));
+                                    },
+                                    [](char c) { return c == '"' || c == '\\' || c == '\n'; });
+        value.append(source_.substr(current_, run_end - current_));
+        current_ = run_end;
+        if (is_at_end() || peek() == '"') {
+            break;
+        }
+
         if (peek() == '\n') {
             line_++;
             line_start_ = current_ + 1;
@@ -382,8 +686,6 @@ auto Lexer::scan_string() -> Token {
                     value += c;
                     break;
             }
-        } else {
-            value += advance();
         }
     }
 
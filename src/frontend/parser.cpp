@@ -18,8 +18,8 @@ namespace {
 
 // ===== Constructor =====
 
-Parser::Parser(std::vector<Token> tokens)
-    : tokens_(std::move(tokens)) {}
+Parser::Parser(Lexer& lexer)
+    : lexer_(lexer) {}
 
 // ===== Main Parse Method =====
 
@@ -38,42 +38,66 @@ auto Parser::parse() -> ParseResult {
 
 // ===== Token Stream Management =====
 
-auto Parser::peek() const -> const Token& {
-    if (current_ >= tokens_.size()) {
-        // Return EOF token
-        return tokens_.back();
+auto Parser::fill(size_t index) -> void {
+    while (pulled_ <= index) {
+        Token token;
+        if (lexer_done_) {
+            // Past the end: repeat the final EOF
+            token = ring_[(pulled_ - 1) % kTokenRingSize];
+        } else {
+            token = lexer_.next_token();
+            if (token.type == TokenType::Error) {
+                // Report the lexer error and end the stream there
+                errors_.emplace_back(location(token),
+                                     std::get<std::string>(lexer_.literal(token)));
+                lexer_failed_ = true;
+                token.type = TokenType::Eof;
+            }
+            lexer_done_ = token.type == TokenType::Eof;
+        }
+        ring_[pulled_ % kTokenRingSize] = token;
+        pulled_++;
     }
-    return tokens_[current_];
 }
 
-auto Parser::peek_ahead(size_t offset) const -> const Token& {
-    size_t index = current_ + offset;
-    if (index >= tokens_.size()) {
-        return tokens_.back();
-    }
-    return tokens_[index];
+auto Parser::peek() -> Token {
+    fill(current_);
+    return ring_[current_ % kTokenRingSize];
+}
+
+auto Parser::peek_ahead(size_t offset) -> Token {
+    fill(current_ + offset);
+    return ring_[(current_ + offset) % kTokenRingSize];
 }
 
-auto Parser::previous() const -> const Token& {
+auto Parser::previous() const -> Token {
     if (current_ == 0) {
-        return tokens_[0];
+        return ring_[0];
     }
-    return tokens_[current_ - 1];
+    return ring_[(current_ - 1) % kTokenRingSize];
 }
 
-auto Parser::advance() -> const Token& {
+auto Parser::advance() -> Token {
     if (!is_at_end()) {
         current_++;
     }
     return previous();
 }
 
-auto Parser::check(TokenType type) const -> bool {
+auto Parser::lexeme(const Token& token) const -> std::string_view {
+    return lexer_.lexeme(token);
+}
+
+auto Parser::location(const Token& token) const -> SourceLocation {
+    return lexer_.location(token);
+}
+
+auto Parser::check(TokenType type) -> bool {
     if (is_at_end()) return false;
     return peek().type == type;
 }
 
-auto Parser::check_any(std::initializer_list<TokenType> types) const -> bool {
+auto Parser::check_any(std::initializer_list<TokenType> types) -> bool {
     for (auto type : types) {
         if (check(type)) return true;
     }
@@ -95,7 +119,7 @@ auto Parser::match_any(std::initializer_list<TokenType> types) -> bool {
     return false;
 }
 
-auto Parser::is_at_end() const -> bool {
+auto Parser::is_at_end() -> bool {
     return peek().type == TokenType::Eof;
 }
 
@@ -116,7 +140,9 @@ auto Parser::error(std::string message) -> void {
 }
 
 auto Parser::error_at(const Token& token, std::string message) -> void {
-    errors_.emplace_back(token.location, std::move(message));
+    // Anything after a lexer error comes from the cut-short token stream
+    if (lexer_failed_) return;
+    errors_.emplace_back(location(token), std::move(message));
 }
 
 auto Parser::synchronize() -> void {
@@ -176,7 +202,7 @@ auto Parser::is_right_associative(TokenType type) const -> bool {
 // ===== Parsing Methods (Stubs for now, to be implemented) =====
 
 auto Parser::parse_program() -> std::unique_ptr<ast::Program> {
-    auto start_loc = peek().location;
+    auto start_loc = location(peek());
     std::vector<std::unique_ptr<ast::FunctionDef>> functions;
 
     // Parse all functions until EOF
@@ -200,14 +226,14 @@ auto Parser::parse_program() -> std::unique_ptr<ast::Program> {
 
 auto Parser::parse_function() -> std::unique_ptr<ast::FunctionDef> {
     // 'function' already consumed
-    auto start_loc = previous().location;
+    auto start_loc = location(previous());
 
     // Function name
     if (!check(TokenType::Identifier)) {
         error("Expected function name");
         return nullptr;
     }
-    auto name = std::string(advance().lexeme);
+    auto name = std::string(lexeme(advance()));
 
     // Parameter list: (param1: Type1, param2: Type2, ...)
     if (!expect(TokenType::LeftParen, "Expected '(' after function name")) {
@@ -256,14 +282,16 @@ auto Parser::parse_function() -> std::unique_ptr<ast::FunctionDef> {
 }
 
 auto Parser::parse_parameter() -> std::unique_ptr<ast::Parameter> {
-    auto start_loc = peek().location;
+    auto start_loc = location(peek());
 
     // Parameter name
     if (!check(TokenType::Identifier)) {
         error("Expected parameter name");
         return nullptr;
     }
-    auto name = std::string(advance().lexeme);
+    const Token name_token = advance();
+    auto name = std::string(lexeme(name_token));
+    const NameId id = lexer_.name(name_token);
 
     // Type annotation (required for parameters)
     if (!expect(TokenType::Colon, "Expected ':' after parameter name")) {
@@ -273,7 +301,9 @@ auto Parser::parse_parameter() -> std::unique_ptr<ast::Parameter> {
     auto type = parse_type();
     if (!type) return nullptr;
 
-    return std::make_unique<ast::Parameter>(name, std::move(type), start_loc);
+    auto parameter = std::make_unique<ast::Parameter>(name, std::move(type), start_loc);
+    parameter->id = id;
+    return parameter;
 }
 
 auto Parser::parse_statement() -> std::unique_ptr<ast::Stmt> {
@@ -296,7 +326,7 @@ auto Parser::parse_statement() -> std::unique_ptr<ast::Stmt> {
 
 auto Parser::parse_let_statement() -> std::unique_ptr<ast::LetStmt> {
     // 'let' already consumed
-    auto start_loc = previous().location;
+    auto start_loc = location(previous());
 
     // Parse pattern (identifier or tuple destructuring)
     auto pattern = parse_pattern();
@@ -327,7 +357,7 @@ auto Parser::parse_let_statement() -> std::unique_ptr<ast::LetStmt> {
 
 auto Parser::parse_return_statement() -> std::unique_ptr<ast::ReturnStmt> {
     // 'return' already consumed
-    auto start_loc = previous().location;
+    auto start_loc = location(previous());
 
     auto value = parse_expression();
     if (!value) return nullptr;
@@ -399,7 +429,7 @@ auto Parser::parse_precedence(int min_prec) -> std::unique_ptr<ast::Expr> {
         }
 
         left = std::make_unique<ast::BinaryExpr>(
-            *op, std::move(left), std::move(right), op_token.location
+            *op, std::move(left), std::move(right), location(op_token)
         );
     }
 
@@ -420,7 +450,7 @@ auto Parser::parse_prefix() -> std::unique_ptr<ast::Expr> {
         }
 
         return std::make_unique<ast::UnaryExpr>(
-            *op, std::move(operand), op_token.location
+            *op, std::move(operand), location(op_token)
         );
     }
 
@@ -434,9 +464,9 @@ auto Parser::parse_primary() -> std::unique_ptr<ast::Expr> {
     // Integer literal
     if (token.type == TokenType::IntLiteral) {
         advance();
-        if (token.value.has_value()) {
-            int64_t value = std::get<int64_t>(*token.value);
-            return std::make_unique<ast::IntLiteralExpr>(value, token.location);
+        if (token.has_literal()) {
+            int64_t value = std::get<int64_t>(lexer_.literal(token));
+            return std::make_unique<ast::IntLiteralExpr>(value, location(token));
         } else {
             error_at(token, "Integer literal missing value");
             return nullptr;
@@ -446,9 +476,9 @@ auto Parser::parse_primary() -> std::unique_ptr<ast::Expr> {
     // Float literal
     if (token.type == TokenType::FloatLiteral) {
         advance();
-        if (token.value.has_value()) {
-            double value = std::get<double>(*token.value);
-            return std::make_unique<ast::FloatLiteralExpr>(value, token.location);
+        if (token.has_literal()) {
+            double value = std::get<double>(lexer_.literal(token));
+            return std::make_unique<ast::FloatLiteralExpr>(value, location(token));
         } else {
             error_at(token, "Float literal missing value");
             return nullptr;
@@ -458,9 +488,9 @@ auto Parser::parse_primary() -> std::unique_ptr<ast::Expr> {
     // String literal
     if (token.type == TokenType::StringLiteral) {
         advance();
-        if (token.value.has_value()) {
-            std::string value = std::get<std::string>(*token.value);
-            return std::make_unique<ast::StringLiteralExpr>(std::move(value), token.location);
+        if (token.has_literal()) {
+            std::string value = std::get<std::string>(lexer_.literal(token));
+            return std::make_unique<ast::StringLiteralExpr>(std::move(value), location(token));
         } else {
             error_at(token, "String literal missing value");
             return nullptr;
@@ -470,19 +500,21 @@ auto Parser::parse_primary() -> std::unique_ptr<ast::Expr> {
     // Boolean literals
     if (token.type == TokenType::True) {
         advance();
-        return std::make_unique<ast::BoolLiteralExpr>(true, token.location);
+        return std::make_unique<ast::BoolLiteralExpr>(true, location(token));
     }
 
     if (token.type == TokenType::False) {
         advance();
-        return std::make_unique<ast::BoolLiteralExpr>(false, token.location);
+        return std::make_unique<ast::BoolLiteralExpr>(false, location(token));
     }
 
     // Identifier
     if (token.type == TokenType::Identifier) {
         advance();
-        std::string name(token.lexeme);
-        return std::make_unique<ast::IdentifierExpr>(std::move(name), token.location);
+        std::string name(lexeme(token));
+        auto identifier = std::make_unique<ast::IdentifierExpr>(std::move(name), location(token));
+        identifier->id = lexer_.name(token);
+        return identifier;
     }
 
     // Parenthesized expression or tuple
@@ -516,7 +548,7 @@ auto Parser::parse_primary() -> std::unique_ptr<ast::Expr> {
     }
 
     // Error: unexpected token - advance to avoid infinite loop
-    error(fmt::format("Unexpected token in expression: '{}'", std::string(token.lexeme)));
+    error(fmt::format("Unexpected token in expression: '{}'", std::string(lexeme(token))));
     advance();
     return nullptr;
 }
@@ -530,7 +562,7 @@ auto Parser::parse_postfix(std::unique_ptr<ast::Expr> expr) -> std::unique_ptr<a
                 return nullptr;
             }
             expr = std::make_unique<ast::CallExpr>(
-                std::move(expr), std::move(args), previous().location
+                std::move(expr), std::move(args), location(previous())
             );
         } else if (match(TokenType::Dot)) {
             // Method call: expr.method(args)
@@ -538,7 +570,7 @@ auto Parser::parse_postfix(std::unique_ptr<ast::Expr> expr) -> std::unique_ptr<a
                 error("Expected method name after '.'");
                 return nullptr;
             }
-            auto method_name = std::string(advance().lexeme);
+            auto method_name = std::string(lexeme(advance()));
 
             if (match(TokenType::LeftParen)) {
                 auto args = parse_call_arguments();
@@ -547,7 +579,7 @@ auto Parser::parse_postfix(std::unique_ptr<ast::Expr> expr) -> std::unique_ptr<a
                 }
                 expr = std::make_unique<ast::MethodCallExpr>(
                     std::move(expr), std::move(method_name),
-                    std::move(args), previous().location
+                    std::move(args), location(previous())
                 );
             } else {
                 // Field access would go here in future phases
@@ -563,7 +595,7 @@ auto Parser::parse_postfix(std::unique_ptr<ast::Expr> expr) -> std::unique_ptr<a
                 return nullptr;
             }
             expr = std::make_unique<ast::IndexExpr>(
-                std::move(expr), std::move(index), previous().location
+                std::move(expr), std::move(index), location(previous())
             );
         } else {
             break;
@@ -575,7 +607,7 @@ auto Parser::parse_postfix(std::unique_ptr<ast::Expr> expr) -> std::unique_ptr<a
 
 auto Parser::parse_if_expression() -> std::unique_ptr<ast::IfExpr> {
     // 'if' already consumed
-    auto start_loc = previous().location;
+    auto start_loc = location(previous());
 
     // Parse condition
     auto condition = parse_expression();
@@ -613,8 +645,9 @@ auto Parser::parse_if_expression() -> std::unique_ptr<ast::IfExpr> {
 
 auto Parser::parse_lambda_expression() -> std::unique_ptr<ast::LambdaExpr> {
     // 'lambda' already consumed
-    auto start_loc = previous().location;
+    auto start_loc = location(previous());
     std::vector<std::string> params;
+    std::vector<NameId> ids;
 
     // Parse parameter list (untyped identifiers)
     if (!check(TokenType::Colon)) {
@@ -623,7 +656,8 @@ auto Parser::parse_lambda_expression() -> std::unique_ptr<ast::LambdaExpr> {
             error("Expected parameter name after 'lambda'");
             return nullptr;
         }
-        params.push_back(std::string(advance().lexeme));
+        ids.push_back(lexer_.name(peek()));
+        params.push_back(std::string(lexeme(advance())));
 
         // Parse remaining parameters
         while (match(TokenType::Comma)) {
@@ -631,7 +665,8 @@ auto Parser::parse_lambda_expression() -> std::unique_ptr<ast::LambdaExpr> {
                 error("Expected parameter name after ','");
                 return nullptr;
             }
-            params.push_back(std::string(advance().lexeme));
+            ids.push_back(lexer_.name(peek()));
+            params.push_back(std::string(lexeme(advance())));
         }
     }
 
@@ -652,14 +687,16 @@ auto Parser::parse_lambda_expression() -> std::unique_ptr<ast::LambdaExpr> {
 
     if (!body) return nullptr;
 
-    return std::make_unique<ast::LambdaExpr>(
+    auto lambda = std::make_unique<ast::LambdaExpr>(
         std::move(params), std::move(body), start_loc
     );
+    lambda->parameter_ids = std::move(ids);
+    return lambda;
 }
 
 auto Parser::parse_block_expression() -> std::unique_ptr<ast::BlockExpr> {
     // '{' already consumed
-    auto start_loc = previous().location;
+    auto start_loc = location(previous());
     std::vector<std::unique_ptr<ast::Stmt>> statements;
 
     // Skip any leading newlines
@@ -692,7 +729,7 @@ auto Parser::parse_block_expression() -> std::unique_ptr<ast::BlockExpr> {
 
 auto Parser::parse_tuple_or_grouped() -> std::unique_ptr<ast::Expr> {
     // '(' already consumed
-    auto start_loc = previous().location;
+    auto start_loc = location(previous());
 
     // Empty tuple: ()
     if (check(TokenType::RightParen)) {
@@ -738,7 +775,7 @@ auto Parser::parse_tuple_or_grouped() -> std::unique_ptr<ast::Expr> {
 
 auto Parser::parse_list_literal() -> std::unique_ptr<ast::ListExpr> {
     // '[' already consumed
-    auto start_loc = previous().location;
+    auto start_loc = location(previous());
     std::vector<std::unique_ptr<ast::Expr>> elements;
 
     // Empty list: []
@@ -797,7 +834,7 @@ auto Parser::parse_type() -> std::unique_ptr<ast::Type> {
 }
 
 auto Parser::parse_primary_type() -> std::unique_ptr<ast::Type> {
-    auto start_loc = peek().location;
+    auto start_loc = location(peek());
 
     // Built-in type keywords: Int, Float, String, Bool
     if (check(TokenType::TypeInt)) {
@@ -835,7 +872,7 @@ auto Parser::parse_primary_type() -> std::unique_ptr<ast::Type> {
 
     // Named type: custom types (identifiers)
     if (check(TokenType::Identifier)) {
-        auto name = std::string(advance().lexeme);
+        auto name = std::string(lexeme(advance()));
 
         // Check for Generic[T] syntax
         if (match(TokenType::LeftBracket)) {
@@ -882,12 +919,14 @@ auto Parser::parse_primary_type() -> std::unique_ptr<ast::Type> {
 }
 
 auto Parser::parse_pattern() -> std::unique_ptr<ast::Pattern> {
-    auto start_loc = peek().location;
+    auto start_loc = location(peek());
 
     // Identifier pattern: x
     if (check(TokenType::Identifier)) {
-        auto name = std::string(advance().lexeme);
-        return std::make_unique<ast::IdentifierPattern>(name, start_loc);
+        const Token name_token = advance();
+        auto pattern = std::make_unique<ast::IdentifierPattern>(std::string(lexeme(name_token)), start_loc);
+        pattern->id = lexer_.name(name_token);
+        return pattern;
     }
 
     // Tuple destructuring pattern: (x, y, ...)
@@ -921,8 +960,7 @@ auto Parser::parse_pattern() -> std::unique_ptr<ast::Pattern> {
 
 auto parse_source(std::string_view source, std::string_view filename) -> ParseResult {
     Lexer lexer(source, filename);
-    auto tokens = lexer.tokenize();
-    Parser parser(std::move(tokens));
+    Parser parser(lexer);
     return parser.parse();
 }
 
@@ -1,14 +1,30 @@
+#include <lucid/frontend/arena.hpp>
 #include <lucid/frontend/lexer.hpp>
 #include <lucid/frontend/parser.hpp>
 #include <lucid/semantic/type_checker.hpp>
+#include <lucid/backend/compile_cache.hpp>
+#include <lucid/backend/compile_server.hpp>
 #include <lucid/backend/compiler.hpp>
+#include <lucid/backend/constant_folder.hpp>
+#include <lucid/backend/cpp_emitter.hpp>
+#include <lucid/backend/inliner.hpp>
+#include <lucid/backend/optimizer.hpp>
+#include <lucid/backend/parallel_compiler.hpp>
 #include <lucid/backend/vm.hpp>
 #include <fmt/core.h>
 #include <fmt/format.h>
+#include <charconv>
+#include <cstdio>
+#include <chrono>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <optional>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <vector>
 #include <cstdlib>
 
 auto read_file(const std::string& path) -> std::string {
@@ -22,10 +38,264 @@ auto read_file(const std::string& path) -> std::string {
     return buffer.str();
 }
 
+using Clock = std::chrono::steady_clock;
+
+auto elapsed_ms(Clock::time_point start) -> double {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// The lucid-run stub that -c appends programs to: installed beside lucidc,
+// else the one from this build tree
+auto find_runner() -> std::optional<std::filesystem::path> {
+    std::error_code ec;
+    auto self = std::filesystem::read_symlink("/proc/self/exe", ec);
+    if (!ec) {
+        auto beside = self.parent_path() / "lucid-run";
+        if (std::filesystem::is_regular_file(beside, ec)) {
+            return beside;
+        }
+    }
+#ifdef LUCID_RUNNER_PATH
+    if (std::filesystem::is_regular_file(LUCID_RUNNER_PATH, ec)) {
+        return std::filesystem::path(LUCID_RUNNER_PATH);
+    }
+#endif
+    return std::nullopt;
+}
+
+// Executes main() and reports its result; returns the process exit code
+auto run_main(const lucid::backend::Bytecode& bytecode, bool verbose, bool opcode_pairs,
+              uint32_t jit_threshold, size_t par_threshold, size_t output_buffer, bool profile,
+              const std::string& folded_file, const std::vector<std::string>& memoized,
+              size_t memo_size) -> int {
+    lucid::backend::VM vm;
+    vm.set_output_buffer_size(output_buffer);
+    vm.set_opcode_pair_profiling(opcode_pairs);
+    vm.set_jit_threshold(jit_threshold);
+    vm.set_parallelism(par_threshold);
+    vm.set_memoized(memoized, memo_size);
+    if (profile || !folded_file.empty()) {
+        vm.enable_profiling({
+            .timing = profile,
+            .sample_interval = folded_file.empty() ? 0 : lucid::backend::Profiler::kDefaultSampleInterval,
+        });
+    }
+    auto result = vm.call_function(bytecode, "main", {});
+
+    if (profile) {
+        fmt::print(stderr, "{}", vm.profiler()->report(bytecode));
+    }
+    if (!folded_file.empty()) {
+        std::ofstream folded(folded_file);
+        folded << vm.profiler()->folded_stacks();
+        if (!folded) {
+            throw std::runtime_error(fmt::format("Could not write profile: {}", folded_file));
+        }
+        if (verbose) {
+            fmt::print("Profile: {} samples written to {}\n", vm.profiler()->sample_count(), folded_file);
+        }
+    }
+
+    if (verbose && jit_threshold > 0) {
+        const auto& stats = vm.jit_stats();
+        fmt::print("JIT: {} functions compiled, {} rejected, {} native calls, {} deopts\n",
+                   stats.compiled, stats.rejected, stats.native_calls, stats.deopts);
+    }
+
+    if (opcode_pairs) {
+        fmt::print(stderr, "{}", lucid::backend::format_opcode_pairs(vm.opcode_pair_counts()));
+    }
+
+    // Print result
+    if (verbose) {
+        fmt::print("Program returned: ");
+    }
+
+    if (result.is_int()) {
+        fmt::print("{}\n", result.as_int());
+        return static_cast<int>(result.as_int());
+    } else if (result.is_float()) {
+        fmt::print("{}\n", result.as_float());
+        return 0;
+    } else if (result.is_string()) {
+        fmt::print("\"{}\"\n", result.as_string());
+        return 0;
+    } else if (result.is_bool()) {
+        fmt::print("{}\n", result.as_bool() ? "true" : "false");
+        return result.as_bool() ? 0 : 1;
+    } else {
+        fmt::print("<unknown type>\n");
+        return 0;
+    }
+}
+
+auto report_parse_errors(const std::vector<lucid::ParseError>& errors) -> void {
+    fmt::print(stderr, "Parse errors:\n");
+    for (const auto& error : errors) {
+        fmt::print(stderr, "  {}:{}:{}: {}\n",
+            error.location.filename,
+            error.location.line,
+            error.location.column,
+            error.message
+        );
+    }
+}
+
+// Phases 1-2: source to an AST. Reports errors and returns nullptr on failure
+auto parse_program(const std::string& source, const std::string& input_file,
+                   bool verbose) -> std::unique_ptr<lucid::ast::Program> {
+    // The parser pulls tokens from the lexer as it goes and reports lexer
+    // errors with its own
+    if (verbose) fmt::print("--- Phases 1-2: Lexing and parsing ---\n");
+    lucid::Lexer lexer(source, input_file);
+    lucid::Parser parser(lexer);
+    auto parse_result = parser.parse();
+
+    if (!parse_result.is_ok()) {
+        report_parse_errors(parse_result.errors);
+        return nullptr;
+    }
+
+    auto program = std::move(parse_result.program.value());
+    if (verbose) fmt::print("✓ Parsed {} functions\n\n", program->functions.size());
+    return program;
+}
+
+auto report_type_errors(const std::vector<lucid::semantic::TypeError>& errors) -> void {
+    fmt::print(stderr, "Type errors:\n");
+    for (const auto& error : errors) {
+        fmt::print(stderr, "  {}:{}:{}: {}\n",
+            error.location.filename,
+            error.location.line,
+            error.location.column,
+            error.message
+        );
+    }
+}
+
+// Phases 1-3: source to a type-checked AST. Reports errors and returns
+// nullptr on failure
+auto check_source(const std::string& source, const std::string& input_file,
+                  bool verbose) -> std::unique_ptr<lucid::ast::Program> {
+    auto program = parse_program(source, input_file, verbose);
+    if (!program) {
+        return nullptr;
+    }
+
+    // Phase 3: Type Checking
+    if (verbose) fmt::print("--- Phase 3: Type Checking ---\n");
+    lucid::semantic::TypeChecker type_checker;
+    auto type_result = type_checker.check_program(*program);
+
+    if (!type_result.success) {
+        report_type_errors(type_result.errors);
+        return nullptr;
+    }
+
+    if (verbose) fmt::print("✓ Type checking passed\n\n");
+    return program;
+}
+
+// Phases 1-4: source to bytecode. Reports errors and returns nullopt on failure
+auto compile_source(const std::string& source, const std::string& input_file, bool optimize,
+                    std::optional<size_t> jobs, bool verbose)
+    -> std::optional<lucid::backend::Bytecode> {
+    // The AST and types only live until the bytecode is built
+    lucid::Arena arena;
+    lucid::ArenaScope arena_scope(arena);
+    lucid::backend::Bytecode bytecode;
+
+    if (jobs) {
+        auto program = parse_program(source, input_file, verbose);
+        if (!program) {
+            return std::nullopt;
+        }
+
+        // Phases 3-4 with one task per function
+        lucid::backend::ThreadPool pool(*jobs);
+        if (verbose) {
+            fmt::print("--- Phases 3-4: Type Checking and Compilation ({} threads) ---\n", pool.size());
+        }
+        auto result = lucid::backend::compile_parallel(*program, pool, optimize);
+        if (!result.bytecode) {
+            report_type_errors(result.errors);
+            return std::nullopt;
+        }
+        if (verbose) {
+            fmt::print("✓ Type checking passed\n");
+            if (optimize) {
+                fmt::print("✓ Inlined {} calls\n", result.inline_stats.inlined);
+            }
+            fmt::print("✓ Folded {} expressions, pruned {} branches, {} constant literals\n",
+                result.fold_stats.folded, result.fold_stats.branches_pruned,
+                result.fold_stats.constant_literals);
+        }
+        bytecode = std::move(*result.bytecode);
+    } else {
+        auto checked = check_source(source, input_file, verbose);
+        if (!checked) {
+            return std::nullopt;
+        }
+        auto& program = *checked;
+
+        // Phase 4: Bytecode Compilation
+        if (verbose) fmt::print("--- Phase 4: Bytecode Compilation ---\n");
+        if (optimize) {
+            // Before folding, so the folder sees through the inlined calls
+            auto inline_stats = lucid::backend::inline_functions(program);
+            if (verbose) fmt::print("✓ Inlined {} calls\n", inline_stats.inlined);
+        }
+        auto fold_stats = lucid::backend::fold_constants(program);
+        if (verbose) {
+            fmt::print("✓ Folded {} expressions, pruned {} branches, {} constant literals\n",
+                fold_stats.folded, fold_stats.branches_pruned, fold_stats.constant_literals);
+        }
+
+        lucid::backend::Compiler compiler;
+        bytecode = compiler.compile(&program);
+    }
+
+    if (verbose) {
+        fmt::print("✓ Compiled successfully!\n");
+        fmt::print("  - Functions: {}\n", bytecode.functions.size());
+        fmt::print("  - Constants: {}\n", bytecode.constants.size());
+        fmt::print("  - Instructions: {} bytes\n\n", bytecode.instructions.size());
+    }
+
+    if (optimize) {
+        auto stats = lucid::backend::optimize(bytecode);
+        if (verbose) {
+            fmt::print("✓ Optimised: {} -> {} bytes\n", stats.bytes_before, stats.bytes_after);
+            fmt::print("  - Superinstructions: {}\n", stats.fused);
+            fmt::print("  - Instructions removed: {}\n", stats.removed);
+            fmt::print("  - Jumps threaded: {}\n\n", stats.jumps_threaded);
+        }
+    }
+
+    return bytecode;
+}
+
 auto main(int argc, char* argv[]) -> int {
     bool verbose = false;
     bool compile_only = false;
+    bool optimize = false;
+    bool opcode_pairs = false;
+    bool profile = false;
+    bool emit_bytecode = false;
+    bool run_bytecode = false;
+    bool emit_cpp = false;
+    bool aot = false;
+    bool use_cache = true;
+    bool serve = false;
+    uint32_t jit_threshold = 0;
+    size_t par_threshold = lucid::backend::VM::kDefaultParallelThreshold;
+    size_t output_buffer = lucid::backend::OutputBuffer::kDefaultCapacity;
+    std::vector<std::string> memoized;
+    size_t memo_size = lucid::backend::MemoTable::kDefaultCapacity;
+    std::optional<size_t> jobs;
+    std::string cache_dir;
     std::string input_file;
+    std::string folded_file;
     std::string output_file;
 
     // Parse command line arguments
@@ -35,6 +305,91 @@ auto main(int argc, char* argv[]) -> int {
             verbose = true;
         } else if (arg == "-c") {
             compile_only = true;
+        } else if (arg == "-O") {
+            optimize = true;
+        } else if (arg == "--opcode-pairs") {
+            opcode_pairs = true;
+        } else if (arg == "--profile") {
+            profile = true;
+        } else if (arg == "--profile-folded") {
+            if (i + 1 < argc) {
+                folded_file = argv[++i];
+            } else {
+                fmt::print(stderr, "Error: --profile-folded requires an argument\n");
+                return 1;
+            }
+        } else if (arg == "--emit-bytecode") {
+            emit_bytecode = true;
+        } else if (arg == "--run-bytecode") {
+            run_bytecode = true;
+        } else if (arg == "--emit-cpp") {
+            emit_cpp = true;
+        } else if (arg == "--aot") {
+            aot = true;
+            compile_only = true;
+        } else if (arg == "--jit") {
+            jit_threshold = lucid::backend::Jit::kDefaultThreshold;
+        } else if (arg == "--jit-threshold") {
+            std::string_view value = i + 1 < argc ? argv[++i] : "";
+            auto [end, ec] = std::from_chars(value.data(), value.data() + value.size(), jit_threshold);
+            if (value.empty() || ec != std::errc() || end != value.data() + value.size()) {
+                fmt::print(stderr, "Error: --jit-threshold requires a call count\n");
+                return 1;
+            }
+        } else if (arg == "--par-threshold") {
+            std::string_view value = i + 1 < argc ? argv[++i] : "";
+            auto [end, ec] = std::from_chars(value.data(), value.data() + value.size(), par_threshold);
+            if (value.empty() || ec != std::errc() || end != value.data() + value.size()) {
+                fmt::print(stderr, "Error: --par-threshold requires a list length\n");
+                return 1;
+            }
+        } else if (arg == "--output-buffer") {
+            std::string_view value = i + 1 < argc ? argv[++i] : "";
+            auto [end, ec] = std::from_chars(value.data(), value.data() + value.size(), output_buffer);
+            if (value.empty() || ec != std::errc() || end != value.data() + value.size()) {
+                fmt::print(stderr, "Error: --output-buffer requires a size in bytes\n");
+                return 1;
+            }
+        } else if (arg.starts_with("--memoize=")) {
+            std::string_view names = std::string_view(arg).substr(std::string_view("--memoize=").size());
+            while (!names.empty()) {
+                const size_t comma = names.find(',');
+                if (comma != 0) {
+                    memoized.emplace_back(names.substr(0, comma));
+                }
+                names = comma == std::string_view::npos ? std::string_view() : names.substr(comma + 1);
+            }
+            if (memoized.empty()) {
+                fmt::print(stderr, "Error: --memoize requires function names\n");
+                return 1;
+            }
+        } else if (arg == "--memo-size") {
+            std::string_view value = i + 1 < argc ? argv[++i] : "";
+            auto [end, ec] = std::from_chars(value.data(), value.data() + value.size(), memo_size);
+            if (value.empty() || ec != std::errc() || end != value.data() + value.size()) {
+                fmt::print(stderr, "Error: --memo-size requires an entry count\n");
+                return 1;
+            }
+        } else if (arg == "-j" || arg == "--jobs") {
+            std::string_view value = i + 1 < argc ? argv[++i] : "";
+            size_t count = 0;
+            auto [end, ec] = std::from_chars(value.data(), value.data() + value.size(), count);
+            if (value.empty() || ec != std::errc() || end != value.data() + value.size()) {
+                fmt::print(stderr, "Error: -j requires a thread count\n");
+                return 1;
+            }
+            jobs = count;
+        } else if (arg == "--serve") {
+            serve = true;
+        } else if (arg == "--no-cache") {
+            use_cache = false;
+        } else if (arg == "--cache-dir") {
+            if (i + 1 < argc) {
+                cache_dir = argv[++i];
+            } else {
+                fmt::print(stderr, "Error: --cache-dir requires an argument\n");
+                return 1;
+            }
         } else if (arg == "-o") {
             if (i + 1 < argc) {
                 output_file = argv[++i];
@@ -45,13 +400,40 @@ auto main(int argc, char* argv[]) -> int {
         } else if (arg == "-h" || arg == "--help") {
             fmt::print("Usage: lucidc [options] <file.lucid>\n");
             fmt::print("Options:\n");
-            fmt::print("  -c               Compile to standalone executable\n");
+            fmt::print("  -c               Compile to standalone executable (lucid-run + bytecode)\n");
+            fmt::print("  --aot            Compile to a native executable through C++ (implies -c)\n");
+            fmt::print("  --emit-cpp       Write the program as C++ (.cpp) instead of running\n");
+            fmt::print("  --emit-bytecode  Write compiled bytecode (.lbc) instead of running\n");
+            fmt::print("  --run-bytecode   Run a .lbc file written by --emit-bytecode\n");
             fmt::print("  -o <file>        Specify output file name\n");
+            fmt::print("  -O               Run the peephole optimiser over the bytecode\n");
+            fmt::print("  --opcode-pairs   Print the most frequent opcode pairs executed\n");
+            fmt::print("  --profile        Print per-function times and opcode counts of the run\n");
+            fmt::print("  --profile-folded <f>  Write sampled call stacks to f in folded (flamegraph) form\n");
+            fmt::print("  --jit            Compile hot functions to native code\n");
+            fmt::print("  --jit-threshold <n>  Calls before a function is compiled (default {}, 0 = off)\n",
+                       lucid::backend::Jit::kDefaultThreshold);
+            fmt::print("  --par-threshold <n>  List length from which par_map/par_filter/par_reduce use\n"
+                       "                   all cores (default {}, 0 = never)\n",
+                       lucid::backend::VM::kDefaultParallelThreshold);
+            fmt::print("  --output-buffer <n>  Bytes of print output held before writing (default {},\n"
+                       "                   0 = unbuffered); a terminal still sees every line at once\n",
+                       lucid::backend::OutputBuffer::kDefaultCapacity);
+            fmt::print("  --memoize=f,g    Cache the results of the pure functions f and g\n");
+            fmt::print("  --memo-size <n>  Results cached per memoized function (default {})\n",
+                       lucid::backend::MemoTable::kDefaultCapacity);
+            fmt::print("  -j <n>           Type-check and compile functions on n threads (0 = all cores)\n");
+            fmt::print("  --serve          Stay running: recompile and run the file again on each line\n"
+                       "                   read from stdin, checking only the functions that changed\n");
+            fmt::print("  --no-cache       Always compile, bypassing the compilation cache\n");
+            fmt::print("  --cache-dir <d>  Cache directory (default $LUCID_CACHE_DIR or ~/.cache/lucid)\n");
             fmt::print("  -v, --verbose    Show detailed compilation information\n");
             fmt::print("  -h, --help       Show this help message\n");
             fmt::print("\nExamples:\n");
             fmt::print("  lucidc hello.lucid              # Run directly (interpreter mode)\n");
             fmt::print("  lucidc -c hello.lucid -o hello  # Create standalone executable\n");
+            fmt::print("  lucidc --aot hello.lucid        # Create native executable\n");
+            fmt::print("  lucidc --emit-bytecode hello.lucid && lucidc --run-bytecode hello.lbc\n");
             return 0;
         } else {
             input_file = arg;
@@ -75,8 +457,64 @@ auto main(int argc, char* argv[]) -> int {
             output_file = input_file + ".out";
         }
     }
+    if (emit_bytecode && output_file.empty()) {
+        size_t dot_pos = input_file.find_last_of('.');
+        output_file = input_file.substr(0, dot_pos) + ".lbc";
+    }
+    if (emit_cpp && output_file.empty()) {
+        size_t dot_pos = input_file.find_last_of('.');
+        output_file = input_file.substr(0, dot_pos) + ".cpp";
+    }
 
     try {
+        // Precompiled bytecode skips the whole front end
+        if (run_bytecode) {
+            if (verbose) fmt::print("Loading bytecode: {}\n\n", input_file);
+            auto bytecode = lucid::backend::Bytecode::load_from_file(input_file);
+            if (!bytecode.has_function("main")) {
+                fmt::print(stderr, "Error: No main() function found\n");
+                return 1;
+            }
+            if (verbose) fmt::print("--- Execution ---\n");
+            return run_main(bytecode, verbose, opcode_pairs, jit_threshold, par_threshold, output_buffer, profile,
+                            folded_file, memoized, memo_size);
+        }
+
+        // Compile server: the program stays in memory between rounds, and a
+        // round only redoes the functions the edit touched
+        if (serve) {
+            lucid::backend::CompileServer server(input_file);
+            std::string request;
+            do {
+                try {
+                    auto start = Clock::now();
+                    auto update = server.update(read_file(input_file));
+                    if (!update.parse_errors.empty()) {
+                        report_parse_errors(update.parse_errors);
+                    } else if (!update.type_errors.empty()) {
+                        report_type_errors(update.type_errors);
+                    } else {
+                        auto& bytecode = *update.bytecode;
+                        if (optimize) {
+                            lucid::backend::optimize(bytecode);
+                        }
+                        fmt::print(stderr, "✓ Compiled in {:.2f} ms: {} of {} functions checked, {} compiled\n",
+                            elapsed_ms(start), update.reparsed, update.functions, update.recompiled);
+                        if (!bytecode.has_function("main")) {
+                            fmt::print(stderr, "Error: No main() function found\n");
+                        } else {
+                            run_main(bytecode, verbose, opcode_pairs, jit_threshold, par_threshold, output_buffer,
+                                     profile, folded_file, memoized, memo_size);
+                        }
+                    }
+                } catch (const std::exception& e) {
+                    fmt::print(stderr, "Error: {}\n", e.what());
+                }
+                std::fflush(stdout);
+            } while (std::getline(std::cin, request));
+            return 0;
+        }
+
         // Read source file
         std::string source = read_file(input_file);
 
@@ -85,78 +523,88 @@ auto main(int argc, char* argv[]) -> int {
             fmt::print("Compiling: {}\n\n", input_file);
         }
 
-        // Phase 1: Lexing
-        if (verbose) fmt::print("--- Phase 1: Lexing ---\n");
-        lucid::Lexer lexer(source, input_file);
-        auto tokens = lexer.tokenize();
-
-        // Check for lexer errors
-        for (const auto& token : tokens) {
-            if (token.type == lucid::TokenType::Error) {
-                fmt::print(stderr, "Lexer error at {}:{}:{}: {}\n",
-                    token.location.filename,
-                    token.location.line,
-                    token.location.column,
-                    std::get<std::string>(*token.value)
-                );
+        // The C++ backend works on the AST, so it bypasses the bytecode cache
+        if (emit_cpp || aot) {
+            lucid::Arena arena;
+            lucid::ArenaScope arena_scope(arena);
+            auto program = check_source(source, input_file, verbose);
+            if (!program) {
+                return 1;
+            }
+            bool has_main = false;
+            for (const auto& function : program->functions) {
+                has_main = has_main || function->name == "main";
+            }
+            if (!has_main) {
+                fmt::print(stderr, "Error: No main() function found\n");
                 return 1;
             }
-        }
 
-        if (verbose) fmt::print("✓ Lexed {} tokens\n\n", tokens.size());
+            if (verbose) fmt::print("--- Phase 4: C++ Generation ---\n");
+            lucid::backend::fold_constants(*program);
+            lucid::backend::CppEmitter emitter;
+            std::string cpp = emitter.emit(*program);
+
+            if (emit_cpp) {
+                std::ofstream file(output_file, std::ios::binary);
+                if (!file || !(file << cpp)) {
+                    throw std::runtime_error(fmt::format("Could not write file: {}", output_file));
+                }
+                fmt::print("Wrote C++: {}\n", output_file);
+                return 0;
+            }
 
-        // Phase 2: Parsing
-        if (verbose) fmt::print("--- Phase 2: Parsing ---\n");
-        lucid::Parser parser(tokens);
-        auto parse_result = parser.parse();
+            if (verbose) fmt::print("--- Phase 5: Building Native Executable ---\n");
+            lucid::backend::CppEmitter::build_executable(cpp, output_file, verbose);
+            fmt::print("Created executable: {}\n", output_file);
+            return 0;
+        }
 
-        if (!parse_result.is_ok()) {
-            fmt::print(stderr, "Parse errors:\n");
-            for (const auto& error : parse_result.errors) {
-                fmt::print(stderr, "  {}:{}:{}: {}\n",
-                    error.location.filename,
-                    error.location.line,
-                    error.location.column,
-                    error.message
-                );
+        std::optional<lucid::backend::CompileCache> cache;
+        if (use_cache) {
+            auto directory = cache_dir.empty() ? lucid::backend::CompileCache::default_directory()
+                                               : std::optional<std::filesystem::path>(cache_dir);
+            if (directory) {
+                // -O changes the bytecode, so it is part of the key
+                cache.emplace(*directory, lucid::backend::CompileCache::compiler_identity() +
+                                              (optimize ? " -O" : ""));
             }
-            return 1;
         }
 
-        auto& program = *parse_result.program.value();
-        if (verbose) fmt::print("✓ Parsed {} functions\n\n", program.functions.size());
-
-        // Phase 3: Type Checking
-        if (verbose) fmt::print("--- Phase 3: Type Checking ---\n");
-        lucid::semantic::TypeChecker type_checker;
-        auto type_result = type_checker.check_program(program);
-
-        if (!type_result.success) {
-            fmt::print(stderr, "Type errors:\n");
-            for (const auto& error : type_result.errors) {
-                fmt::print(stderr, "  {}:{}:{}: {}\n",
-                    error.location.filename,
-                    error.location.line,
-                    error.location.column,
-                    error.message
-                );
+        std::optional<lucid::backend::Bytecode> compiled;
+        if (cache) {
+            auto start = Clock::now();
+            compiled = cache->load(input_file, source);
+            if (verbose && compiled) {
+                fmt::print("✓ Cache hit: {} ({:.2f} ms)\n\n",
+                    cache->entry_path(input_file, source).string(), elapsed_ms(start));
             }
-            return 1;
         }
 
-        if (verbose) fmt::print("✓ Type checking passed\n\n");
-
-        // Phase 4: Bytecode Compilation
-        if (verbose) fmt::print("--- Phase 4: Bytecode Compilation ---\n");
-        lucid::backend::Compiler compiler;
-        auto bytecode = compiler.compile(&program);
-
-        if (verbose) {
-            fmt::print("✓ Compiled successfully!\n");
-            fmt::print("  - Functions: {}\n", bytecode.functions.size());
-            fmt::print("  - Constants: {}\n", bytecode.constants.size());
-            fmt::print("  - Instructions: {} bytes\n\n", bytecode.instructions.size());
+        if (!compiled) {
+            auto start = Clock::now();
+            compiled = compile_source(source, input_file, optimize, jobs, verbose);
+            if (!compiled) {
+                return 1;
+            }
+            double compile_ms = elapsed_ms(start);
+
+            if (cache) {
+                start = Clock::now();
+                try {
+                    cache->store(input_file, source, *compiled);
+                    if (verbose) {
+                        fmt::print("✓ Cache miss: compiled in {:.2f} ms, stored {} ({:.2f} ms)\n\n",
+                            compile_ms, cache->entry_path(input_file, source).string(), elapsed_ms(start));
+                    }
+                } catch (const std::runtime_error& e) {
+                    // A read-only or full cache only costs the next run a recompile
+                    if (verbose) fmt::print("✗ Cache miss: compiled in {:.2f} ms, not stored: {}\n\n",
+                        compile_ms, e.what());
+                }
+            }
         }
+        auto& bytecode = *compiled;
 
         // Check for main() function
         if (!bytecode.has_function("main")) {
@@ -165,41 +613,26 @@ auto main(int argc, char* argv[]) -> int {
         }
 
         // Phase 5: Compilation or Execution
-        if (compile_only) {
+        if (emit_bytecode) {
+            bytecode.save_to_file(output_file);
+            if (verbose) {
+                fmt::print("✓ Bytecode written: {}\n", output_file);
+            } else {
+                fmt::print("Wrote bytecode: {}\n", output_file);
+            }
+            return 0;
+        } else if (compile_only) {
             // Compile to standalone executable
             if (verbose) fmt::print("--- Phase 5: Generating Executable ---\n");
 
-            // Generate C++ source with embedded bytecode
-            std::string cpp_source = bytecode.generate_executable_source();
-
-            // Write to temporary file
-            std::string temp_source = output_file + ".tmp.cpp";
-            std::ofstream out_file(temp_source);
-            if (!out_file.is_open()) {
-                fmt::print(stderr, "Error: Could not create temporary file: {}\n", temp_source);
+            auto runner = find_runner();
+            if (!runner) {
+                fmt::print(stderr, "Error: Could not find the lucid-run stub next to lucidc\n");
                 return 1;
             }
-            out_file << cpp_source;
-            out_file.close();
-
-            if (verbose) fmt::print("Generated C++ source: {}\n", temp_source);
+            if (verbose) fmt::print("Runner: {}\n", runner->string());
 
-            // Compile with g++ (match CMake flags)
-            std::string compile_cmd = fmt::format(
-                "g++ -std=c++20 -O2 -fsanitize=address,undefined -I../include {} -L. -llucid-core -lfmt -o {} 2>&1",
-                temp_source, output_file
-            );
-
-            if (verbose) fmt::print("Compiling: {}\n", compile_cmd);
-
-            int result = system(compile_cmd.c_str());
-            if (result != 0) {
-                fmt::print(stderr, "Error: Compilation failed\n");
-                return 1;
-            }
-
-            // Clean up temporary file
-            std::remove(temp_source.c_str());
+            bytecode.save_as_executable(runner->string(), output_file);
 
             if (verbose) {
                 fmt::print("✓ Executable created: {}\n", output_file);
@@ -213,30 +646,8 @@ auto main(int argc, char* argv[]) -> int {
             // Execute directly (interpreter mode)
             if (verbose) fmt::print("--- Phase 5: Execution ---\n");
 
-            lucid::backend::VM vm;
-            auto result = vm.call_function(bytecode, "main", {});
-
-            // Print result
-            if (verbose) {
-                fmt::print("Program returned: ");
-            }
-
-            if (result.is_int()) {
-                fmt::print("{}\n", result.as_int());
-                return static_cast<int>(result.as_int());
-            } else if (result.is_float()) {
-                fmt::print("{}\n", result.as_float());
-                return 0;
-            } else if (result.is_string()) {
-                fmt::print("\"{}\"\n", result.as_string());
-                return 0;
-            } else if (result.is_bool()) {
-                fmt::print("{}\n", result.as_bool() ? "true" : "false");
-                return result.as_bool() ? 0 : 1;
-            } else {
-                fmt::print("<unknown type>\n");
-                return 0;
-            }
+            return run_main(bytecode, verbose, opcode_pairs, jit_threshold, par_threshold, output_buffer, profile,
+                            folded_file, memoized, memo_size);
         }
 
     } catch (const std::exception& e) {
@@ -0,0 +1,57 @@
+// lucid-run: the stub behind `lucidc -c`.
+//
+// lucidc copies this executable and appends a compiled program to the copy
+// (Bytecode::save_as_executable). At startup the stub maps its own file and
+// runs main() straight out of the appended image. Run bare, it executes a
+// .lbc file written by `lucidc --emit-bytecode`.
+
+#include <lucid/backend/bytecode.hpp>
+#include <lucid/backend/vm.hpp>
+#include <fmt/core.h>
+#include <filesystem>
+#include <string>
+#include <system_error>
+
+namespace {
+
+// Path of the running executable; argv[0] where /proc is unavailable
+auto self_path(const char* argv0) -> std::string {
+    std::error_code ec;
+    auto path = std::filesystem::read_symlink("/proc/self/exe", ec);
+    return ec ? std::string(argv0) : path.string();
+}
+
+auto load_program(int argc, char* argv[]) -> lucid::backend::Bytecode {
+    const std::string self = self_path(argv[0]);
+    if (lucid::backend::Bytecode::has_appended_program(self)) {
+        return lucid::backend::Bytecode::load_from_executable(self);
+    }
+    if (argc == 2) {
+        return lucid::backend::Bytecode::load_from_file(argv[1]);
+    }
+    throw std::runtime_error("No program to run (usage: lucid-run <file.lbc>, or build one with lucidc -c)");
+}
+
+} // namespace
+
+auto main(int argc, char* argv[]) -> int {
+    try {
+        auto bytecode = load_program(argc, argv);
+        if (!bytecode.has_function("main")) {
+            fmt::print(stderr, "Error: No main() function found\n");
+            return 1;
+        }
+
+        lucid::backend::VM vm;
+        auto result = vm.call_function(bytecode, "main", {});
+
+        // An Int result is the exit code, as with lucidc
+        if (result.is_int()) {
+            return static_cast<int>(result.as_int());
+        }
+        return 0;
+    } catch (const std::exception& e) {
+        fmt::print(stderr, "Runtime error: {}\n", e.what());
+        return 1;
+    }
+}
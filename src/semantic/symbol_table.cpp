@@ -1,4 +1,6 @@
 #include <lucid/semantic/symbol_table.hpp>
+#include <algorithm>
+#include <utility>
 
 namespace lucid {
 namespace semantic {
@@ -22,6 +24,22 @@ auto Scope::declare(std::string name, SymbolKind kind,
     return true;
 }
 
+auto Scope::declare(std::string name, SymbolKind kind,
+                    const SemanticType* type,
+                    SourceLocation location,
+                    bool is_mutable) -> bool {
+    auto [it, inserted] = symbols.try_emplace(name);
+    if (!inserted) {
+        return false;  // Redeclaration error
+    }
+    it->second = std::make_unique<Symbol>(std::move(name), kind, type, location, is_mutable);
+    return true;
+}
+
+auto Scope::remove(const std::string& name) -> bool {
+    return symbols.erase(name) > 0;
+}
+
 auto Scope::lookup_local(const std::string& name) -> Symbol* {
     auto it = symbols.find(name);
     if (it != symbols.end()) {
@@ -44,67 +62,136 @@ auto Scope::exists_local(const std::string& name) const -> bool {
 
 // ===== SymbolTable Implementation =====
 
-SymbolTable::SymbolTable() {
-    // Create global scope
-    auto global_scope = std::make_unique<Scope>(Scope::ScopeKind::Global);
-    current_ = global_scope.get();
-    scopes_.push_back(std::move(global_scope));
-}
+SymbolTable::SymbolTable()
+    : owned_globals_(std::make_unique<Scope>(Scope::ScopeKind::Global)),
+      globals_(owned_globals_.get()) {}
+
+SymbolTable::SymbolTable(Scope* globals) : globals_(globals) {}
 
 auto SymbolTable::enter_scope(Scope::ScopeKind kind) -> void {
-    auto new_scope = std::make_unique<Scope>(kind, current_);
-    current_ = new_scope.get();
-    scopes_.push_back(std::move(new_scope));
+    marks_.push_back(Mark{kind, locals_.size(), frame_size_});
+    if (kind == Scope::ScopeKind::Function || kind == Scope::ScopeKind::Lambda) {
+        frame_size_ = 0;
+    }
 }
 
 auto SymbolTable::exit_scope() -> void {
-    if (current_->parent != nullptr) {
-        current_ = current_->parent;
-        // Note: We keep all scopes in scopes_ for debugging/analysis
-        // They'll be cleaned up when SymbolTable is destroyed
+    if (marks_.empty()) {
+        return;
+    }
+    const Mark mark = marks_.back();
+    marks_.pop_back();
+    while (locals_.size() > mark.first) {
+        const Local& local = locals_.back();
+        if (local.symbol.id == kNoName) {
+            --unnamed_;
+        } else {
+            innermost_[local.symbol.id] = local.shadowed;
+        }
+        locals_.pop_back();
+    }
+    if (mark.kind == Scope::ScopeKind::Function || mark.kind == Scope::ScopeKind::Lambda) {
+        frame_size_ = mark.frame_size;
     }
 }
 
-auto SymbolTable::current_scope() -> Scope* {
-    return current_;
+auto SymbolTable::current_kind() const -> Scope::ScopeKind {
+    return marks_.empty() ? globals_->kind : marks_.back().kind;
 }
 
-auto SymbolTable::current_scope() const -> const Scope* {
-    return current_;
+auto SymbolTable::globals() -> Scope* {
+    return globals_;
 }
 
 auto SymbolTable::declare(std::string name, SymbolKind kind,
                           std::unique_ptr<SemanticType> type,
                           SourceLocation location,
                           bool is_mutable) -> bool {
-    return current_->declare(std::move(name), kind, std::move(type),
-                            location, is_mutable);
+    if (marks_.empty()) {
+        return globals_->declare(std::move(name), kind, std::move(type), location, is_mutable);
+    }
+    if (find_local(kNoName, name, marks_.back().first) != nullptr) {
+        return false;  // Redeclaration error
+    }
+    push_local(Symbol(std::move(name), kind, std::move(type), location, is_mutable));
+    return true;
 }
 
-auto SymbolTable::lookup(const std::string& name) -> Symbol* {
-    // Search from current scope up to global scope
-    Scope* scope = current_;
-    while (scope != nullptr) {
-        auto* symbol = scope->lookup_local(name);
-        if (symbol != nullptr) {
-            return symbol;
+auto SymbolTable::declare(std::string name, SymbolKind kind,
+                          const SemanticType* type,
+                          SourceLocation location,
+                          bool is_mutable) -> bool {
+    if (marks_.empty()) {
+        return globals_->declare(std::move(name), kind, type, location, is_mutable);
+    }
+    if (find_local(kNoName, name, marks_.back().first) != nullptr) {
+        return false;  // Redeclaration error
+    }
+    push_local(Symbol(std::move(name), kind, type, location, is_mutable));
+    return true;
+}
+
+auto SymbolTable::declare_local(std::string name, NameId id, SymbolKind kind,
+                                const SemanticType* type, SourceLocation location) -> const Symbol* {
+    if (find_local(id, name, marks_.back().first) != nullptr) {
+        return nullptr;
+    }
+    Symbol symbol(std::move(name), kind, type, location);
+    symbol.id = id;
+    return push_local(std::move(symbol));
+}
+
+auto SymbolTable::push_local(Symbol symbol) -> Symbol* {
+    symbol.slot = frame_size_++;
+    const NameId id = symbol.id;
+    uint32_t shadowed = kNone;
+    if (id == kNoName) {
+        ++unnamed_;
+    } else {
+        if (id >= innermost_.size()) {
+            innermost_.resize(id + 1, kNone);
         }
-        scope = scope->parent;
+        shadowed = innermost_[id];
+        innermost_[id] = static_cast<uint32_t>(locals_.size());
     }
-    return nullptr;
+    locals_.push_back(Local{std::move(symbol), shadowed});
+    return &locals_.back().symbol;
 }
 
-auto SymbolTable::lookup(const std::string& name) const -> const Symbol* {
-    // Search from current scope up to global scope
-    const Scope* scope = current_;
-    while (scope != nullptr) {
-        auto* symbol = scope->lookup_local(name);
-        if (symbol != nullptr) {
-            return symbol;
+// The innermost local from index `first` on with this id, or this name
+// where either has no id
+auto SymbolTable::find_local(NameId id, const std::string& name, size_t first) const -> const Symbol* {
+    size_t found = kNone;
+    if (id != kNoName && id < innermost_.size()) {
+        found = innermost_[id];
+    }
+    if (id == kNoName || unnamed_ > 0) {
+        // Scan down to the innermost local found by id, if any
+        const size_t end = found == kNone ? first : std::max(first, found + 1);
+        for (size_t i = locals_.size(); i-- > end;) {
+            const Symbol& local = locals_[i].symbol;
+            if ((id == kNoName || local.id == kNoName) && local.name == name) {
+                found = i;
+                break;
+            }
         }
-        scope = scope->parent;
     }
-    return nullptr;
+    return found == kNone || found < first ? nullptr : &locals_[found].symbol;
+}
+
+auto SymbolTable::lookup(const std::string& name) -> Symbol* {
+    return const_cast<Symbol*>(std::as_const(*this).lookup(kNoName, name));
+}
+
+auto SymbolTable::lookup(const std::string& name) const -> const Symbol* {
+    return lookup(kNoName, name);
+}
+
+auto SymbolTable::lookup(NameId id, const std::string& name) const -> const Symbol* {
+    if (const auto* local = find_local(id, name, 0)) {
+        return local;
+    }
+    return globals_->lookup_local(name);
 }
 
 auto SymbolTable::exists(const std::string& name) const -> bool {
@@ -112,17 +199,14 @@ auto SymbolTable::exists(const std::string& name) const -> bool {
 }
 
 auto SymbolTable::exists_in_current_scope(const std::string& name) const -> bool {
-    return current_->exists_local(name);
+    if (marks_.empty()) {
+        return globals_->exists_local(name);
+    }
+    return find_local(kNoName, name, marks_.back().first) != nullptr;
 }
 
 auto SymbolTable::scope_depth() const -> size_t {
-    size_t depth = 0;
-    const Scope* scope = current_;
-    while (scope->parent != nullptr) {
-        depth++;
-        scope = scope->parent;
-    }
-    return depth;
+    return marks_.size();
 }
 
 // ===== Symbol Table Utilities =====
@@ -1,5 +1,6 @@
 #include <lucid/semantic/type_checker.hpp>
 #include <fmt/format.h>
+#include <algorithm>
 
 namespace lucid {
 namespace semantic {
@@ -9,46 +10,64 @@ namespace semantic {
 TypeChecker::TypeChecker()
     : current_function_return_type_(nullptr) {}
 
+TypeChecker::TypeChecker(TypeChecker* globals)
+    : types_(&globals->types_),
+      symbol_table_(globals->symbol_table_.globals()),
+      current_function_return_type_(nullptr) {}
+
 // ===== Main Entry Points =====
 
 auto TypeChecker::check_program(ast::Program& program) -> TypeCheckResult {
     // First pass: collect all function signatures
-    for (auto& func : program.functions) {
-        // Convert parameter types
-        std::vector<std::unique_ptr<SemanticType>> param_types;
-        for (auto& param : func->parameters) {
-            param_types.push_back(ast_type_to_semantic(*param->type));
-        }
+    declare_functions(program);
 
-        // Convert return type
-        auto return_type = ast_type_to_semantic(*func->return_type);
+    // Second pass: type check function bodies
+    for (auto& func : program.functions) {
+        check_function(*func);
+    }
 
-        // Create function symbol
-        auto func_type = std::make_unique<FunctionType>(
-            std::move(param_types),
-            return_type->clone()
-        );
+    return std::move(result_);
+}
 
-        // Declare function in global scope
-        bool success = symbol_table_.declare(
-            func->name,
-            SymbolKind::Function,
-            std::move(func_type),
-            func->location
-        );
+auto TypeChecker::declare_functions(ast::Program& program) -> void {
+    for (auto& func : program.functions) {
+        declare_function(*func);
+    }
+}
 
-        if (!success) {
-            error(func->location,
-                  fmt::format("Function '{}' is already declared", func->name));
-        }
+auto TypeChecker::declare_function(ast::FunctionDef& func) -> bool {
+    // Convert parameter types
+    std::vector<const SemanticType*> param_types;
+    for (auto& param : func.parameters) {
+        param_types.push_back(ast_type_to_semantic(*param->type));
     }
 
-    // Second pass: type check function bodies
-    for (auto& func : program.functions) {
-        check_function(*func);
+    // Convert return type
+    auto* return_type = ast_type_to_semantic(*func.return_type);
+
+    // Declare function in global scope
+    bool success = symbol_table_.declare(
+        func.name,
+        SymbolKind::Function,
+        types_.function(param_types, return_type),
+        func.location
+    );
+
+    if (!success) {
+        error(func.location,
+              fmt::format("Function '{}' is already declared", func.name));
     }
+    return success;
+}
 
-    return std::move(result_);
+auto TypeChecker::undeclare_function(const std::string& name) -> void {
+    symbol_table_.globals()->remove(name);
+}
+
+auto TypeChecker::take_errors() -> std::vector<TypeError> {
+    auto errors = std::move(result_.errors);
+    result_ = TypeCheckResult{};
+    return errors;
 }
 
 auto TypeChecker::check_function(ast::FunctionDef& func) -> void {
@@ -56,20 +75,19 @@ auto TypeChecker::check_function(ast::FunctionDef& func) -> void {
     symbol_table_.enter_scope(Scope::ScopeKind::Function);
 
     // Set current function return type
-    auto return_type = ast_type_to_semantic(*func.return_type);
-    current_function_return_type_ = return_type.get();
+    current_function_return_type_ = ast_type_to_semantic(*func.return_type);
 
-    // Declare parameters in function scope
+    // Declare parameters in function scope; they take the first slots
     for (auto& param : func.parameters) {
-        auto param_type = ast_type_to_semantic(*param->type);
-        bool success = symbol_table_.declare(
+        const auto* symbol = symbol_table_.declare_local(
             param->name,
+            param->id,
             SymbolKind::Parameter,
-            std::move(param_type),
+            ast_type_to_semantic(*param->type),
             param->location
         );
 
-        if (!success) {
+        if (!symbol) {
             error(param->location,
                   fmt::format("Parameter '{}' is already declared", param->name));
         }
@@ -80,21 +98,42 @@ auto TypeChecker::check_function(ast::FunctionDef& func) -> void {
     // functions use explicit return statements. The return type is validated
     // in visit_return() for each return statement.
     check_expression(*func.body);
+    func.local_count = symbol_table_.frame_size();
 
     // Exit function scope
     symbol_table_.exit_scope();
     current_function_return_type_ = nullptr;
 }
 
-auto TypeChecker::check_expression(ast::Expr& expr) -> std::unique_ptr<SemanticType> {
+namespace {
+
+// Scalar type recorded on the AST for the code generator
+auto static_type_of(const SemanticType& type) -> ast::StaticType {
+    if (type.kind != TypeKind::Primitive) {
+        return ast::StaticType::Unknown;
+    }
+    switch (static_cast<const PrimitiveType&>(type).primitive_kind) {
+        case PrimitiveKind::Int: return ast::StaticType::Int;
+        case PrimitiveKind::Float: return ast::StaticType::Float;
+        case PrimitiveKind::Bool: return ast::StaticType::Bool;
+        case PrimitiveKind::String: return ast::StaticType::String;
+    }
+    return ast::StaticType::Unknown;
+}
+
+} // namespace
+
+auto TypeChecker::check_expression(ast::Expr& expr) -> const SemanticType* {
     // Visit the expression (sets current_type_)
+    current_type_ = nullptr;
     expr.accept(*this);
 
     // Return the type (or Unknown if there was an error)
     if (current_type_) {
-        return std::move(current_type_);
+        expr.static_type = static_type_of(*current_type_);
+        return current_type_;
     }
-    return std::make_unique<UnknownType>();
+    return types_.unknown();
 }
 
 auto TypeChecker::check_statement(ast::Stmt& stmt) -> void {
@@ -104,67 +143,64 @@ auto TypeChecker::check_statement(ast::Stmt& stmt) -> void {
 // ===== Expression Visitors =====
 
 auto TypeChecker::visit_int_literal(ast::IntLiteralExpr* /* expr */) -> void {
-    current_type_ = std::make_unique<PrimitiveType>(PrimitiveKind::Int);
+    current_type_ = types_.primitive(PrimitiveKind::Int);
 }
 
 auto TypeChecker::visit_float_literal(ast::FloatLiteralExpr* /* expr */) -> void {
-    current_type_ = std::make_unique<PrimitiveType>(PrimitiveKind::Float);
+    current_type_ = types_.primitive(PrimitiveKind::Float);
 }
 
 auto TypeChecker::visit_string_literal(ast::StringLiteralExpr* /* expr */) -> void {
-    current_type_ = std::make_unique<PrimitiveType>(PrimitiveKind::String);
+    current_type_ = types_.primitive(PrimitiveKind::String);
 }
 
 auto TypeChecker::visit_bool_literal(ast::BoolLiteralExpr* /* expr */) -> void {
-    current_type_ = std::make_unique<PrimitiveType>(PrimitiveKind::Bool);
+    current_type_ = types_.primitive(PrimitiveKind::Bool);
 }
 
 auto TypeChecker::visit_identifier(ast::IdentifierExpr* expr) -> void {
     // Lookup identifier in symbol table
-    auto* symbol = symbol_table_.lookup(expr->name);
+    auto* symbol = symbol_table_.lookup(expr->id, expr->name);
 
     if (!symbol) {
         error(expr->location, fmt::format("Undefined variable '{}'", expr->name));
-        current_type_ = std::make_unique<UnknownType>();
+        current_type_ = types_.unknown();
         return;
     }
 
-    // Return a clone of the symbol's type
-    current_type_ = symbol->type->clone();
+    expr->slot = symbol->slot;
+    current_type_ = symbol->type;
 }
 
 auto TypeChecker::visit_tuple(ast::TupleExpr* expr) -> void {
-    std::vector<std::unique_ptr<SemanticType>> elem_types;
+    std::vector<const SemanticType*> elem_types;
 
     for (auto& elem : expr->elements) {
-        auto elem_type = check_expression(*elem);
-        elem_types.push_back(std::move(elem_type));
+        elem_types.push_back(check_expression(*elem));
     }
 
-    current_type_ = std::make_unique<TupleType>(std::move(elem_types));
+    current_type_ = types_.tuple(elem_types);
 }
 
 auto TypeChecker::visit_list(ast::ListExpr* expr) -> void {
     if (expr->elements.empty()) {
         // Empty list - infer as List[Unknown]
-        current_type_ = std::make_unique<ListType>(
-            std::make_unique<UnknownType>()
-        );
+        current_type_ = types_.list(types_.unknown());
         return;
     }
 
     // Check first element to get element type
-    auto first_type = check_expression(*expr->elements[0]);
+    auto* first_type = check_expression(*expr->elements[0]);
 
     // Check remaining elements have same type
     for (size_t i = 1; i < expr->elements.size(); ++i) {
-        auto elem_type = check_expression(*expr->elements[i]);
-        if (!elem_type->equals(*first_type)) {
+        auto* elem_type = check_expression(*expr->elements[i]);
+        if (!TypeContext::compatible(elem_type, first_type)) {
             type_mismatch_error(expr->elements[i]->location, *first_type, *elem_type);
         }
     }
 
-    current_type_ = std::make_unique<ListType>(std::move(first_type));
+    current_type_ = types_.list(first_type);
 }
 
 auto TypeChecker::visit_binary(ast::BinaryExpr* expr) -> void {
@@ -219,7 +255,7 @@ auto TypeChecker::visit_call(ast::CallExpr* expr) -> void {
     // In the future, we could support calling lambdas or function expressions
     if (expr->callee->kind != ast::ExprKind::Identifier) {
         error(expr->location, "Only function names can be called for now");
-        current_type_ = std::make_unique<UnknownType>();
+        current_type_ = types_.unknown();
         return;
     }
 
@@ -234,13 +270,13 @@ auto TypeChecker::visit_call(ast::CallExpr* expr) -> void {
             error(expr->location,
                   fmt::format("Function '{}' expects 1 argument, got {}",
                              func_name, expr->arguments.size()));
-            current_type_ = std::make_unique<UnknownType>();
+            current_type_ = types_.unknown();
             return;
         }
         // Type check the argument (any type is valid)
         check_expression(*expr->arguments[0]);
         // Return Int as placeholder for Unit (print returns nothing meaningful)
-        current_type_ = std::make_unique<PrimitiveType>(PrimitiveKind::Int);
+        current_type_ = types_.primitive(PrimitiveKind::Int);
         return;
     }
 
@@ -251,32 +287,52 @@ auto TypeChecker::visit_call(ast::CallExpr* expr) -> void {
             error(expr->location,
                   fmt::format("Function 'to_string' expects 1 argument, got {}",
                              expr->arguments.size()));
-            current_type_ = std::make_unique<UnknownType>();
+            current_type_ = types_.unknown();
             return;
         }
         // Type check the argument (any type is valid)
         check_expression(*expr->arguments[0]);
         // Return String
-        current_type_ = std::make_unique<PrimitiveType>(PrimitiveKind::String);
+        current_type_ = types_.primitive(PrimitiveKind::String);
         return;
     }
 
-    if (func_name == "read_file") {
+    if (func_name == "read_file" || func_name == "read_lines") {
         // read_file(path: String) -> String
+        // read_lines(path: String) -> List[String]
         if (expr->arguments.size() != 1) {
             error(expr->location,
-                  fmt::format("Function 'read_file' expects 1 argument, got {}",
+                  fmt::format("Function '{}' expects 1 argument, got {}",
+                             func_name, expr->arguments.size()));
+            current_type_ = types_.unknown();
+            return;
+        }
+        const auto* string_type = types_.primitive(PrimitiveKind::String);
+        auto* arg_type = check_expression(*expr->arguments[0]);
+        if (arg_type != string_type) {
+            type_mismatch_error(expr->arguments[0]->location, *string_type, *arg_type);
+        }
+        current_type_ = func_name == "read_file" ? string_type : types_.list(string_type);
+        return;
+    }
+
+    if (func_name == "for_each_line") {
+        // for_each_line(path: String, f: (String) -> T) -> Int, the number of lines
+        if (expr->arguments.size() != 2) {
+            error(expr->location,
+                  fmt::format("Function 'for_each_line' expects 2 arguments, got {}",
                              expr->arguments.size()));
-            current_type_ = std::make_unique<UnknownType>();
+            current_type_ = types_.unknown();
             return;
         }
-        auto arg_type = check_expression(*expr->arguments[0]);
-        if (arg_type->kind != TypeKind::Primitive ||
-            static_cast<PrimitiveType*>(arg_type.get())->primitive_kind != PrimitiveKind::String) {
-            type_mismatch_error(expr->arguments[0]->location,
-                              PrimitiveType(PrimitiveKind::String), *arg_type);
+        const auto* string_type = types_.primitive(PrimitiveKind::String);
+        auto* path_type = check_expression(*expr->arguments[0]);
+        if (path_type != string_type) {
+            type_mismatch_error(expr->arguments[0]->location, *string_type, *path_type);
         }
-        current_type_ = std::make_unique<PrimitiveType>(PrimitiveKind::String);
+        const SemanticType* params[] = {string_type};
+        check_callback(*expr->arguments[1], params, func_name);
+        current_type_ = types_.primitive(PrimitiveKind::Int);
         return;
     }
 
@@ -287,19 +343,18 @@ auto TypeChecker::visit_call(ast::CallExpr* expr) -> void {
             error(expr->location,
                   fmt::format("Function '{}' expects 2 arguments, got {}",
                              func_name, expr->arguments.size()));
-            current_type_ = std::make_unique<UnknownType>();
+            current_type_ = types_.unknown();
             return;
         }
         // Check both arguments are strings
         for (size_t i = 0; i < 2; ++i) {
-            auto arg_type = check_expression(*expr->arguments[i]);
-            if (arg_type->kind != TypeKind::Primitive ||
-                static_cast<PrimitiveType*>(arg_type.get())->primitive_kind != PrimitiveKind::String) {
+            auto* arg_type = check_expression(*expr->arguments[i]);
+            if (arg_type != types_.primitive(PrimitiveKind::String)) {
                 type_mismatch_error(expr->arguments[i]->location,
-                                  PrimitiveType(PrimitiveKind::String), *arg_type);
+                                  *types_.primitive(PrimitiveKind::String), *arg_type);
             }
         }
-        current_type_ = std::make_unique<PrimitiveType>(PrimitiveKind::Bool);
+        current_type_ = types_.primitive(PrimitiveKind::Bool);
         return;
     }
 
@@ -309,69 +364,69 @@ auto TypeChecker::visit_call(ast::CallExpr* expr) -> void {
             error(expr->location,
                   fmt::format("Function 'file_exists' expects 1 argument, got {}",
                              expr->arguments.size()));
-            current_type_ = std::make_unique<UnknownType>();
+            current_type_ = types_.unknown();
             return;
         }
-        auto arg_type = check_expression(*expr->arguments[0]);
-        if (arg_type->kind != TypeKind::Primitive ||
-            static_cast<PrimitiveType*>(arg_type.get())->primitive_kind != PrimitiveKind::String) {
+        auto* arg_type = check_expression(*expr->arguments[0]);
+        if (arg_type != types_.primitive(PrimitiveKind::String)) {
             type_mismatch_error(expr->arguments[0]->location,
-                              PrimitiveType(PrimitiveKind::String), *arg_type);
+                              *types_.primitive(PrimitiveKind::String), *arg_type);
         }
-        current_type_ = std::make_unique<PrimitiveType>(PrimitiveKind::Bool);
+        current_type_ = types_.primitive(PrimitiveKind::Bool);
         return;
     }
 
     // Lookup function in symbol table
-    auto* func_symbol = symbol_table_.lookup(func_name);
+    auto* func_symbol = symbol_table_.lookup(identifier->id, func_name);
 
     if (!func_symbol) {
         error(expr->location, fmt::format("Undefined function '{}'", func_name));
-        current_type_ = std::make_unique<UnknownType>();
+        current_type_ = types_.unknown();
         return;
     }
+    identifier->slot = func_symbol->slot;
 
     // Function symbol must have function type
     if (func_symbol->type->kind != TypeKind::Function) {
         error(expr->location, fmt::format("'{}' is not a function", func_name));
-        current_type_ = std::make_unique<UnknownType>();
+        current_type_ = types_.unknown();
         return;
     }
 
-    auto* func_type = static_cast<FunctionType*>(func_symbol->type.get());
+    auto param_types = TypeContext::param_types(func_symbol->type);
 
     // Check argument count
-    if (expr->arguments.size() != func_type->param_types.size()) {
+    if (expr->arguments.size() != param_types.size()) {
         error(expr->location,
               fmt::format("Function '{}' expects {} arguments, got {}",
                          func_name,
-                         func_type->param_types.size(),
+                         param_types.size(),
                          expr->arguments.size()));
-        current_type_ = std::make_unique<UnknownType>();
+        current_type_ = types_.unknown();
         return;
     }
 
     // Type check each argument
     for (size_t i = 0; i < expr->arguments.size(); ++i) {
-        auto arg_type = check_expression(*expr->arguments[i]);
-        auto& param_type = func_type->param_types[i];
+        auto* arg_type = check_expression(*expr->arguments[i]);
+        auto* param_type = param_types[i];
 
-        if (!arg_type->equals(*param_type)) {
+        if (!TypeContext::compatible(arg_type, param_type)) {
             type_mismatch_error(expr->arguments[i]->location, *param_type, *arg_type);
         }
     }
 
     // Return type is function's return type
-    current_type_ = func_type->return_type->clone();
+    current_type_ = TypeContext::return_type(func_symbol->type);
 }
 
 auto TypeChecker::visit_method_call(ast::MethodCallExpr* expr) -> void {
     // Type check the object
-    auto object_type = check_expression(*expr->object);
+    auto* object_type = check_expression(*expr->object);
 
     // Check methods based on object type
     if (object_type->kind == TypeKind::List) {
-        auto* list_type = static_cast<ListType*>(object_type.get());
+        auto* element_type = TypeContext::element_type(object_type);
 
         if (expr->method_name == "append") {
             // append(element) -> List[T] (immutable, returns new list)
@@ -379,18 +434,18 @@ auto TypeChecker::visit_method_call(ast::MethodCallExpr* expr) -> void {
                 error(expr->location,
                       fmt::format("Method 'append' expects 1 argument, got {}",
                                  expr->arguments.size()));
-                current_type_ = std::make_unique<UnknownType>();
+                current_type_ = types_.unknown();
                 return;
             }
 
-            auto arg_type = check_expression(*expr->arguments[0]);
-            if (!arg_type->equals(*list_type->element_type)) {
+            auto* arg_type = check_expression(*expr->arguments[0]);
+            if (!TypeContext::compatible(arg_type, element_type)) {
                 type_mismatch_error(expr->arguments[0]->location,
-                                   *list_type->element_type, *arg_type);
+                                   *element_type, *arg_type);
             }
 
             // Returns a new list with the same element type
-            current_type_ = std::make_unique<ListType>(list_type->element_type->clone());
+            current_type_ = types_.list(element_type);
         } else if (expr->method_name == "length") {
             // length() -> Int
             if (!expr->arguments.empty()) {
@@ -398,7 +453,7 @@ auto TypeChecker::visit_method_call(ast::MethodCallExpr* expr) -> void {
                       fmt::format("Method 'length' expects 0 arguments, got {}",
                                  expr->arguments.size()));
             }
-            current_type_ = std::make_unique<PrimitiveType>(PrimitiveKind::Int);
+            current_type_ = types_.primitive(PrimitiveKind::Int);
         } else if (expr->method_name == "head") {
             // head() -> T (first element)
             if (!expr->arguments.empty()) {
@@ -406,7 +461,7 @@ auto TypeChecker::visit_method_call(ast::MethodCallExpr* expr) -> void {
                       fmt::format("Method 'head' expects 0 arguments, got {}",
                                  expr->arguments.size()));
             }
-            current_type_ = list_type->element_type->clone();
+            current_type_ = element_type;
         } else if (expr->method_name == "tail") {
             // tail() -> List[T] (all elements except first)
             if (!expr->arguments.empty()) {
@@ -414,7 +469,7 @@ auto TypeChecker::visit_method_call(ast::MethodCallExpr* expr) -> void {
                       fmt::format("Method 'tail' expects 0 arguments, got {}",
                                  expr->arguments.size()));
             }
-            current_type_ = std::make_unique<ListType>(list_type->element_type->clone());
+            current_type_ = types_.list(element_type);
         } else if (expr->method_name == "is_empty") {
             // is_empty() -> Bool
             if (!expr->arguments.empty()) {
@@ -422,7 +477,7 @@ auto TypeChecker::visit_method_call(ast::MethodCallExpr* expr) -> void {
                       fmt::format("Method 'is_empty' expects 0 arguments, got {}",
                                  expr->arguments.size()));
             }
-            current_type_ = std::make_unique<PrimitiveType>(PrimitiveKind::Bool);
+            current_type_ = types_.primitive(PrimitiveKind::Bool);
         } else if (expr->method_name == "reverse") {
             // reverse() -> List[T]
             if (!expr->arguments.empty()) {
@@ -430,36 +485,127 @@ auto TypeChecker::visit_method_call(ast::MethodCallExpr* expr) -> void {
                       fmt::format("Method 'reverse' expects 0 arguments, got {}",
                                  expr->arguments.size()));
             }
-            current_type_ = std::make_unique<ListType>(list_type->element_type->clone());
+            current_type_ = types_.list(element_type);
         } else if (expr->method_name == "concat") {
             // concat(other: List[T]) -> List[T]
             if (expr->arguments.size() != 1) {
                 error(expr->location,
                       fmt::format("Method 'concat' expects 1 argument, got {}",
                                  expr->arguments.size()));
-                current_type_ = std::make_unique<UnknownType>();
+                current_type_ = types_.unknown();
             } else {
-                auto arg_type = check_expression(*expr->arguments[0]);
+                auto* arg_type = check_expression(*expr->arguments[0]);
                 if (arg_type->kind != TypeKind::List) {
                     error(expr->arguments[0]->location,
                           fmt::format("Method 'concat' expects List argument, got {}",
                                      arg_type->to_string()));
                 } else {
-                    auto* arg_list_type = static_cast<ListType*>(arg_type.get());
-                    if (!arg_list_type->element_type->equals(*list_type->element_type)) {
+                    if (!TypeContext::compatible(TypeContext::element_type(arg_type), element_type)) {
                         type_mismatch_error(expr->arguments[0]->location,
-                                          *list_type, *arg_type);
+                                          *object_type, *arg_type);
                     }
                 }
-                current_type_ = std::make_unique<ListType>(list_type->element_type->clone());
+                current_type_ = types_.list(element_type);
+            }
+        } else if (expr->method_name == "sum") {
+            // sum() -> T, for List[Int] and List[Float]
+            if (!expr->arguments.empty()) {
+                error(expr->location,
+                      fmt::format("Method 'sum' expects 0 arguments, got {}",
+                                 expr->arguments.size()));
+            }
+            if (is_numeric(element_type)) {
+                current_type_ = element_type;
+            } else {
+                error(expr->location,
+                      fmt::format("Method 'sum' requires List[Int] or List[Float], got {}",
+                                 object_type->to_string()));
+                current_type_ = types_.unknown();
+            }
+        } else if (expr->method_name == "join") {
+            // join(separator: String) -> String, for List[String]
+            const auto* string_type = types_.primitive(PrimitiveKind::String);
+            if (expr->arguments.size() != 1) {
+                error(expr->location,
+                      fmt::format("Method 'join' expects 1 argument, got {}",
+                                 expr->arguments.size()));
+            } else {
+                auto* arg_type = check_expression(*expr->arguments[0]);
+                if (arg_type != string_type) {
+                    type_mismatch_error(expr->arguments[0]->location, *string_type, *arg_type);
+                }
+            }
+            if (element_type != string_type) {
+                error(expr->location,
+                      fmt::format("Method 'join' requires List[String], got {}",
+                                 object_type->to_string()));
+            }
+            current_type_ = string_type;
+        } else if (expr->method_name == "map" || expr->method_name == "par_map") {
+            // map(f: (T) -> U) -> List[U]
+            if (expr->arguments.size() != 1) {
+                error(expr->location,
+                      fmt::format("Method '{}' expects 1 argument, got {}",
+                                 expr->method_name, expr->arguments.size()));
+                current_type_ = types_.unknown();
+            } else {
+                const SemanticType* params[] = {element_type};
+                current_type_ = types_.list(check_callback(*expr->arguments[0], params, expr->method_name));
+            }
+        } else if (expr->method_name == "filter" || expr->method_name == "par_filter") {
+            // filter(f: (T) -> Bool) -> List[T]
+            if (expr->arguments.size() != 1) {
+                error(expr->location,
+                      fmt::format("Method '{}' expects 1 argument, got {}",
+                                 expr->method_name, expr->arguments.size()));
+                current_type_ = types_.unknown();
+            } else {
+                const SemanticType* params[] = {element_type};
+                auto* result_type = check_callback(*expr->arguments[0], params, expr->method_name);
+                const auto* bool_type = types_.primitive(PrimitiveKind::Bool);
+                if (result_type != types_.unknown() && !TypeContext::compatible(result_type, bool_type)) {
+                    type_mismatch_error(expr->arguments[0]->location, *bool_type, *result_type);
+                }
+                current_type_ = types_.list(element_type);
+            }
+        } else if (expr->method_name == "par_reduce") {
+            // par_reduce(f: (T, T) -> T) -> T, f associative
+            if (expr->arguments.size() != 1) {
+                error(expr->location,
+                      fmt::format("Method 'par_reduce' expects 1 argument, got {}",
+                                 expr->arguments.size()));
+                current_type_ = types_.unknown();
+            } else {
+                const SemanticType* params[] = {element_type, element_type};
+                auto* result_type = check_callback(*expr->arguments[0], params, "par_reduce");
+                if (result_type != types_.unknown() && !TypeContext::compatible(result_type, element_type)) {
+                    type_mismatch_error(expr->arguments[0]->location, *element_type, *result_type);
+                }
+                current_type_ = element_type;
+            }
+        } else if (expr->method_name == "fold") {
+            // fold(initial: A, f: (A, T) -> A) -> A
+            if (expr->arguments.size() != 2) {
+                error(expr->location,
+                      fmt::format("Method 'fold' expects 2 arguments, got {}",
+                                 expr->arguments.size()));
+                current_type_ = types_.unknown();
+            } else {
+                auto* acc_type = check_expression(*expr->arguments[0]);
+                const SemanticType* params[] = {acc_type, element_type};
+                auto* result_type = check_callback(*expr->arguments[1], params, "fold");
+                if (result_type != types_.unknown() && !TypeContext::compatible(result_type, acc_type)) {
+                    type_mismatch_error(expr->arguments[1]->location, *acc_type, *result_type);
+                }
+                current_type_ = acc_type;
             }
         } else {
             error(expr->location,
                   fmt::format("List type has no method '{}'", expr->method_name));
-            current_type_ = std::make_unique<UnknownType>();
+            current_type_ = types_.unknown();
         }
     } else if (object_type->kind == TypeKind::Primitive) {
-        auto* prim_type = static_cast<PrimitiveType*>(object_type.get());
+        auto* prim_type = static_cast<const PrimitiveType*>(object_type);
 
         if (prim_type->primitive_kind == PrimitiveKind::String) {
             if (expr->method_name == "length") {
@@ -469,7 +615,7 @@ auto TypeChecker::visit_method_call(ast::MethodCallExpr* expr) -> void {
                           fmt::format("Method 'length' expects 0 arguments, got {}",
                                      expr->arguments.size()));
                 }
-                current_type_ = std::make_unique<PrimitiveType>(PrimitiveKind::Int);
+                current_type_ = types_.primitive(PrimitiveKind::Int);
             } else if (expr->method_name == "is_empty") {
                 // is_empty() -> Bool
                 if (!expr->arguments.empty()) {
@@ -477,7 +623,7 @@ auto TypeChecker::visit_method_call(ast::MethodCallExpr* expr) -> void {
                           fmt::format("Method 'is_empty' expects 0 arguments, got {}",
                                      expr->arguments.size()));
                 }
-                current_type_ = std::make_unique<PrimitiveType>(PrimitiveKind::Bool);
+                current_type_ = types_.primitive(PrimitiveKind::Bool);
             } else if (expr->method_name == "contains" ||
                        expr->method_name == "starts_with" ||
                        expr->method_name == "ends_with") {
@@ -487,14 +633,13 @@ auto TypeChecker::visit_method_call(ast::MethodCallExpr* expr) -> void {
                           fmt::format("Method '{}' expects 1 argument, got {}",
                                      expr->method_name, expr->arguments.size()));
                 } else {
-                    auto arg_type = check_expression(*expr->arguments[0]);
-                    if (arg_type->kind != TypeKind::Primitive ||
-                        static_cast<PrimitiveType*>(arg_type.get())->primitive_kind != PrimitiveKind::String) {
+                    auto* arg_type = check_expression(*expr->arguments[0]);
+                    if (arg_type != types_.primitive(PrimitiveKind::String)) {
                         type_mismatch_error(expr->arguments[0]->location,
-                                          PrimitiveType(PrimitiveKind::String), *arg_type);
+                                          *types_.primitive(PrimitiveKind::String), *arg_type);
                     }
                 }
-                current_type_ = std::make_unique<PrimitiveType>(PrimitiveKind::Bool);
+                current_type_ = types_.primitive(PrimitiveKind::Bool);
             } else if (expr->method_name == "to_upper" ||
                        expr->method_name == "to_lower" ||
                        expr->method_name == "trim") {
@@ -504,11 +649,11 @@ auto TypeChecker::visit_method_call(ast::MethodCallExpr* expr) -> void {
                           fmt::format("Method '{}' expects 0 arguments, got {}",
                                      expr->method_name, expr->arguments.size()));
                 }
-                current_type_ = std::make_unique<PrimitiveType>(PrimitiveKind::String);
+                current_type_ = types_.primitive(PrimitiveKind::String);
             } else {
                 error(expr->location,
                       fmt::format("String type has no method '{}'", expr->method_name));
-                current_type_ = std::make_unique<UnknownType>();
+                current_type_ = types_.unknown();
             }
         } else if (prim_type->primitive_kind == PrimitiveKind::Int) {
             if (expr->method_name == "to_string") {
@@ -518,7 +663,7 @@ auto TypeChecker::visit_method_call(ast::MethodCallExpr* expr) -> void {
                           fmt::format("Method 'to_string' expects 0 arguments, got {}",
                                      expr->arguments.size()));
                 }
-                current_type_ = std::make_unique<PrimitiveType>(PrimitiveKind::String);
+                current_type_ = types_.primitive(PrimitiveKind::String);
             } else if (expr->method_name == "abs") {
                 // abs() -> Int
                 if (!expr->arguments.empty()) {
@@ -526,11 +671,11 @@ auto TypeChecker::visit_method_call(ast::MethodCallExpr* expr) -> void {
                           fmt::format("Method 'abs' expects 0 arguments, got {}",
                                      expr->arguments.size()));
                 }
-                current_type_ = std::make_unique<PrimitiveType>(PrimitiveKind::Int);
+                current_type_ = types_.primitive(PrimitiveKind::Int);
             } else {
                 error(expr->location,
                       fmt::format("Int type has no method '{}'", expr->method_name));
-                current_type_ = std::make_unique<UnknownType>();
+                current_type_ = types_.unknown();
             }
         } else if (prim_type->primitive_kind == PrimitiveKind::Float) {
             if (expr->method_name == "to_string") {
@@ -540,7 +685,7 @@ auto TypeChecker::visit_method_call(ast::MethodCallExpr* expr) -> void {
                           fmt::format("Method 'to_string' expects 0 arguments, got {}",
                                      expr->arguments.size()));
                 }
-                current_type_ = std::make_unique<PrimitiveType>(PrimitiveKind::String);
+                current_type_ = types_.primitive(PrimitiveKind::String);
             } else if (expr->method_name == "abs") {
                 // abs() -> Float
                 if (!expr->arguments.empty()) {
@@ -548,7 +693,7 @@ auto TypeChecker::visit_method_call(ast::MethodCallExpr* expr) -> void {
                           fmt::format("Method 'abs' expects 0 arguments, got {}",
                                      expr->arguments.size()));
                 }
-                current_type_ = std::make_unique<PrimitiveType>(PrimitiveKind::Float);
+                current_type_ = types_.primitive(PrimitiveKind::Float);
             } else if (expr->method_name == "floor" ||
                        expr->method_name == "ceil" ||
                        expr->method_name == "round") {
@@ -558,16 +703,16 @@ auto TypeChecker::visit_method_call(ast::MethodCallExpr* expr) -> void {
                           fmt::format("Method '{}' expects 0 arguments, got {}",
                                      expr->method_name, expr->arguments.size()));
                 }
-                current_type_ = std::make_unique<PrimitiveType>(PrimitiveKind::Int);
+                current_type_ = types_.primitive(PrimitiveKind::Int);
             } else {
                 error(expr->location,
                       fmt::format("Float type has no method '{}'", expr->method_name));
-                current_type_ = std::make_unique<UnknownType>();
+                current_type_ = types_.unknown();
             }
         } else {
             error(expr->location,
                   fmt::format("Type '{}' has no methods", object_type->to_string()));
-            current_type_ = std::make_unique<UnknownType>();
+            current_type_ = types_.unknown();
         }
     } else if (object_type->kind == TypeKind::Tuple) {
         if (expr->method_name == "length") {
@@ -577,39 +722,38 @@ auto TypeChecker::visit_method_call(ast::MethodCallExpr* expr) -> void {
                       fmt::format("Method 'length' expects 0 arguments, got {}",
                                  expr->arguments.size()));
             }
-            current_type_ = std::make_unique<PrimitiveType>(PrimitiveKind::Int);
+            current_type_ = types_.primitive(PrimitiveKind::Int);
         } else {
             error(expr->location,
                   fmt::format("Tuple type has no method '{}'", expr->method_name));
-            current_type_ = std::make_unique<UnknownType>();
+            current_type_ = types_.unknown();
         }
     } else {
         error(expr->location,
               fmt::format("Type '{}' has no methods", object_type->to_string()));
-        current_type_ = std::make_unique<UnknownType>();
+        current_type_ = types_.unknown();
     }
 }
 
 auto TypeChecker::visit_index(ast::IndexExpr* expr) -> void {
     // Type check the object being indexed
-    auto object_type = check_expression(*expr->object);
+    auto* object_type = check_expression(*expr->object);
 
     // Type check the index expression
-    auto index_type = check_expression(*expr->index);
+    auto* index_type = check_expression(*expr->index);
 
     // Index must be Int
-    auto int_type = PrimitiveType(PrimitiveKind::Int);
-    if (!index_type->equals(int_type)) {
-        type_mismatch_error(expr->index->location, int_type, *index_type);
+    const auto* int_type = types_.primitive(PrimitiveKind::Int);
+    if (!TypeContext::compatible(index_type, int_type)) {
+        type_mismatch_error(expr->index->location, *int_type, *index_type);
     }
 
     // Check what we're indexing
     if (object_type->kind == TypeKind::List) {
         // List[T][Int] -> T
-        auto* list_type = static_cast<ListType*>(object_type.get());
-        current_type_ = list_type->element_type->clone();
+        current_type_ = TypeContext::element_type(object_type);
     } else if (object_type->kind == TypeKind::Tuple) {
-        auto* tuple_type = static_cast<TupleType*>(object_type.get());
+        auto element_types = TypeContext::element_types(object_type);
 
         // Check if index is a constant integer literal
         if (expr->index->kind == ast::ExprKind::IntLiteral) {
@@ -617,91 +761,158 @@ auto TypeChecker::visit_index(ast::IndexExpr* expr) -> void {
             int64_t index = int_literal->value;
 
             // Check bounds
-            if (index < 0 || static_cast<size_t>(index) >= tuple_type->element_types.size()) {
+            if (index < 0 || static_cast<size_t>(index) >= element_types.size()) {
                 error(expr->index->location,
                       fmt::format("Tuple index {} out of bounds (tuple has {} elements)",
-                                 index, tuple_type->element_types.size()));
-                current_type_ = std::make_unique<UnknownType>();
+                                 index, element_types.size()));
+                current_type_ = types_.unknown();
             } else {
                 // Return the type of the indexed element
-                current_type_ = tuple_type->element_types[static_cast<size_t>(index)]->clone();
+                current_type_ = element_types[static_cast<size_t>(index)];
             }
         } else {
             error(expr->location,
                   "Tuple indexing requires a constant integer literal index");
-            current_type_ = std::make_unique<UnknownType>();
+            current_type_ = types_.unknown();
         }
     } else {
         error(expr->object->location,
               fmt::format("Cannot index into type '{}'", object_type->to_string()));
-        current_type_ = std::make_unique<UnknownType>();
+        current_type_ = types_.unknown();
     }
 }
 
 auto TypeChecker::visit_lambda(ast::LambdaExpr* expr) -> void {
-    // Enter lambda scope
-    symbol_table_.enter_scope(Scope::ScopeKind::Lambda);
+    // Without annotations or a context to infer them from (see
+    // check_callback), lambda parameters have Unknown type
+    std::vector<const SemanticType*> param_types(expr->parameters.size(), types_.unknown());
+    current_type_ = check_lambda(expr, param_types);
+}
 
-    // For now, we'll use Unknown for parameter types since we don't have
-    // type annotations on lambda parameters and full type inference is complex
-    std::vector<std::unique_ptr<SemanticType>> param_types;
+auto TypeChecker::check_lambda(ast::LambdaExpr* expr,
+                               std::span<const SemanticType* const> param_types)
+    -> const SemanticType* {
+    // The enclosing locals the body mentions are captured: copied into the
+    // closure and declared again in its frame, after the parameters
+    std::vector<const ast::IdentifierExpr*> mentioned;
+    ast::collect_identifiers(*expr->body, mentioned);
+    std::vector<Symbol> captures;
+    expr->captures.clear();
+    for (const auto* identifier : mentioned) {
+        if (std::find(expr->parameters.begin(), expr->parameters.end(), identifier->name) !=
+            expr->parameters.end()) {
+            continue;
+        }
+        const auto* symbol = symbol_table_.lookup(identifier->id, identifier->name);
+        if (symbol != nullptr && symbol->slot != ast::kNoSlot) {
+            expr->captures.push_back(symbol->slot);
+            captures.emplace_back(symbol->name, symbol->kind, symbol->type, symbol->location);
+            captures.back().id = symbol->id;
+        }
+    }
 
-    // Declare lambda parameters with Unknown type
-    for (auto& param : expr->parameters) {
-        auto param_type = std::make_unique<UnknownType>();
-        param_types.push_back(param_type->clone());
+    symbol_table_.enter_scope(Scope::ScopeKind::Lambda);
 
-        symbol_table_.declare(
-            param,
+    for (size_t i = 0; i < expr->parameters.size(); ++i) {
+        const auto* symbol = symbol_table_.declare_local(
+            expr->parameters[i],
+            i < expr->parameter_ids.size() ? expr->parameter_ids[i] : kNoName,
             SymbolKind::Parameter,
-            std::move(param_type),
+            param_types[i],
             expr->location
         );
+        if (!symbol) {
+            error(expr->location,
+                  fmt::format("Parameter '{}' is already declared", expr->parameters[i]));
+        }
+    }
+    for (auto& capture : captures) {
+        symbol_table_.declare_local(std::move(capture.name), capture.id, capture.kind,
+                                    capture.type, capture.location);
     }
 
-    // Type check lambda body
-    auto body_type = check_expression(*expr->body);
+    // The body's value is the lambda's result; `return` would leave the
+    // enclosing function, which a closure cannot do
+    bool saved_in_lambda = in_lambda_;
+    in_lambda_ = true;
+    auto* body_type = check_expression(*expr->body);
+    in_lambda_ = saved_in_lambda;
+    expr->local_count = symbol_table_.frame_size();
 
     // Exit lambda scope
     symbol_table_.exit_scope();
 
-    // Create function type for the lambda
-    current_type_ = std::make_unique<FunctionType>(
-        std::move(param_types),
-        std::move(body_type)
-    );
+    return types_.function(param_types, body_type);
+}
+
+auto TypeChecker::check_callback(ast::Expr& argument,
+                                 std::span<const SemanticType* const> param_types,
+                                 const std::string& method) -> const SemanticType* {
+    // A lambda written in place takes its parameter types from the call
+    if (argument.kind == ast::ExprKind::Lambda) {
+        auto* lambda = static_cast<ast::LambdaExpr*>(&argument);
+        if (lambda->parameters.size() != param_types.size()) {
+            error(argument.location,
+                  fmt::format("Method '{}' expects a function of {} parameters, got {}",
+                             method, param_types.size(), lambda->parameters.size()));
+            return types_.unknown();
+        }
+        return TypeContext::return_type(check_lambda(lambda, param_types));
+    }
+
+    // Any other function value must accept them
+    auto* type = check_expression(argument);
+    if (type->kind != TypeKind::Function) {
+        error(argument.location,
+              fmt::format("Method '{}' expects a function argument, got '{}'",
+                         method, type->to_string()));
+        return types_.unknown();
+    }
+    auto params = TypeContext::param_types(type);
+    if (params.size() != param_types.size()) {
+        error(argument.location,
+              fmt::format("Method '{}' expects a function of {} parameters, got {}",
+                         method, param_types.size(), params.size()));
+        return types_.unknown();
+    }
+    for (size_t i = 0; i < params.size(); ++i) {
+        if (!TypeContext::compatible(param_types[i], params[i])) {
+            type_mismatch_error(argument.location, *params[i], *param_types[i]);
+        }
+    }
+    return TypeContext::return_type(type);
 }
 
 auto TypeChecker::visit_if(ast::IfExpr* expr) -> void {
     // Type check condition - must be Bool
-    auto cond_type = check_expression(*expr->condition);
-    auto bool_type = PrimitiveType(PrimitiveKind::Bool);
+    auto* cond_type = check_expression(*expr->condition);
+    const auto* bool_type = types_.primitive(PrimitiveKind::Bool);
 
-    if (!cond_type->equals(bool_type)) {
-        type_mismatch_error(expr->condition->location, bool_type, *cond_type);
+    if (!TypeContext::compatible(cond_type, bool_type)) {
+        type_mismatch_error(expr->condition->location, *bool_type, *cond_type);
     }
 
     // Type check then branch
-    auto then_type = check_expression(*expr->then_branch);
+    auto* then_type = check_expression(*expr->then_branch);
 
     // Type check else branch if present
     if (expr->else_branch.has_value()) {
-        auto else_type = check_expression(**expr->else_branch);
+        auto* else_type = check_expression(**expr->else_branch);
 
         // Both branches must have compatible types
-        if (!then_type->equals(*else_type)) {
+        if (!TypeContext::compatible(then_type, else_type)) {
             error((*expr->else_branch)->location,
                   fmt::format("If expression branches have incompatible types: '{}' and '{}'",
                              then_type->to_string(), else_type->to_string()));
-            current_type_ = std::make_unique<UnknownType>();
+            current_type_ = types_.unknown();
             return;
         }
 
-        current_type_ = std::move(then_type);
+        current_type_ = then_type;
     } else {
         // If without else - result type is then_type but could be Unit
         // For now, we'll use the then type
-        current_type_ = std::move(then_type);
+        current_type_ = then_type;
     }
 }
 
@@ -723,11 +934,11 @@ auto TypeChecker::visit_block(ast::BlockExpr* expr) -> void {
             current_type_ = check_expression(*expr_stmt->expression);
         } else {
             // Block ends with non-expression statement, has Unit type
-            current_type_ = std::make_unique<UnknownType>();
+            current_type_ = types_.unknown();
         }
     } else {
         // Empty block has Unit type
-        current_type_ = std::make_unique<UnknownType>();
+        current_type_ = types_.unknown();
     }
 
     // Exit block scope
@@ -738,24 +949,29 @@ auto TypeChecker::visit_block(ast::BlockExpr* expr) -> void {
 
 auto TypeChecker::visit_let(ast::LetStmt* stmt) -> void {
     // Type check the initializer expression
-    auto init_type = check_expression(*stmt->initializer);
+    auto* init_type = check_expression(*stmt->initializer);
 
     // If there's a type annotation, check that initializer matches it
     if (stmt->type_annotation.has_value()) {
         auto declared_type = ast_type_to_semantic(**stmt->type_annotation);
 
-        if (!init_type->equals(*declared_type)) {
+        if (!TypeContext::compatible(init_type, declared_type)) {
             type_mismatch_error(stmt->initializer->location, *declared_type, *init_type);
             // Use declared type for error recovery
-            init_type = std::move(declared_type);
+            init_type = declared_type;
         }
     }
 
     // Type check the pattern and bind variables
-    check_pattern(*stmt->pattern, *init_type);
+    check_pattern(*stmt->pattern, init_type);
 }
 
 auto TypeChecker::visit_return(ast::ReturnStmt* stmt) -> void {
+    if (in_lambda_) {
+        error(stmt->location, "Return statement inside a lambda");
+        return;
+    }
+
     // Check that we're inside a function
     if (!current_function_return_type_) {
         error(stmt->location, "Return statement outside of function");
@@ -763,10 +979,10 @@ auto TypeChecker::visit_return(ast::ReturnStmt* stmt) -> void {
     }
 
     // Type check the return value
-    auto return_type = check_expression(*stmt->value);
+    auto* return_type = check_expression(*stmt->value);
 
     // Check that return type matches function's declared return type
-    if (!return_type->equals(*current_function_return_type_)) {
+    if (!TypeContext::compatible(return_type, current_function_return_type_)) {
         type_mismatch_error(stmt->value->location,
                            *current_function_return_type_,
                            *return_type);
@@ -791,82 +1007,85 @@ auto TypeChecker::type_mismatch_error(SourceLocation location,
                                 expected.to_string(), actual.to_string()));
 }
 
-auto TypeChecker::ast_type_to_semantic(const ast::Type& ast_type) -> std::unique_ptr<SemanticType> {
+auto TypeChecker::ast_type_to_semantic(const ast::Type& ast_type) -> const SemanticType* {
     switch (ast_type.kind) {
         case ast::TypeKind::Named: {
             auto& named = static_cast<const ast::NamedType&>(ast_type);
-            auto builtin = type_env_.get_builtin(named.name);
+            auto builtin = type_env_.builtin_kind(named.name);
             if (builtin) {
-                return std::move(*builtin);
+                return types_.primitive(*builtin);
             }
             // Unknown type - could be user-defined (not supported yet)
-            return std::make_unique<UnknownType>();
+            return types_.unknown();
         }
 
         case ast::TypeKind::List: {
             auto& list = static_cast<const ast::ListType&>(ast_type);
-            auto elem_type = ast_type_to_semantic(*list.element_type);
-            return std::make_unique<ListType>(std::move(elem_type));
+            return types_.list(ast_type_to_semantic(*list.element_type));
         }
 
         case ast::TypeKind::Tuple: {
             auto& tuple = static_cast<const ast::TupleType&>(ast_type);
-            std::vector<std::unique_ptr<SemanticType>> elem_types;
+            std::vector<const SemanticType*> elem_types;
             for (auto& elem : tuple.element_types) {
                 elem_types.push_back(ast_type_to_semantic(*elem));
             }
-            return std::make_unique<TupleType>(std::move(elem_types));
+            return types_.tuple(elem_types);
         }
     }
 
-    return std::make_unique<UnknownType>();
+    return types_.unknown();
+}
+
+auto TypeChecker::is_numeric(const SemanticType* type) const -> bool {
+    return type == types_.primitive(PrimitiveKind::Int) ||
+           type == types_.primitive(PrimitiveKind::Float);
 }
 
 // ===== Binary Operator Type Checking =====
 
-auto TypeChecker::check_binary_arithmetic(ast::BinaryExpr* expr) -> std::unique_ptr<SemanticType> {
-    auto left_type = check_expression(*expr->left);
-    auto right_type = check_expression(*expr->right);
+auto TypeChecker::check_binary_arithmetic(ast::BinaryExpr* expr) -> const SemanticType* {
+    auto* left_type = check_expression(*expr->left);
+    auto* right_type = check_expression(*expr->right);
+
+    // String + String concatenates
+    const auto* string_type = types_.primitive(PrimitiveKind::String);
+    if (expr->op == ast::BinaryOp::Add && left_type == string_type && right_type == string_type) {
+        return string_type;
+    }
 
     // Both operands must be Int or Float
-    bool left_is_numeric = (left_type->kind == TypeKind::Primitive &&
-        (static_cast<PrimitiveType*>(left_type.get())->primitive_kind == PrimitiveKind::Int ||
-         static_cast<PrimitiveType*>(left_type.get())->primitive_kind == PrimitiveKind::Float));
+    bool left_is_numeric = is_numeric(left_type);
 
-    bool right_is_numeric = (right_type->kind == TypeKind::Primitive &&
-        (static_cast<PrimitiveType*>(right_type.get())->primitive_kind == PrimitiveKind::Int ||
-         static_cast<PrimitiveType*>(right_type.get())->primitive_kind == PrimitiveKind::Float));
+    bool right_is_numeric = is_numeric(right_type);
 
     if (!left_is_numeric) {
         error(expr->left->location,
               fmt::format("Arithmetic operator requires numeric type, got '{}'",
                          left_type->to_string()));
-        return std::make_unique<UnknownType>();
+        return types_.unknown();
     }
 
     if (!right_is_numeric) {
         error(expr->right->location,
               fmt::format("Arithmetic operator requires numeric type, got '{}'",
                          right_type->to_string()));
-        return std::make_unique<UnknownType>();
+        return types_.unknown();
     }
 
     // If both are Int, result is Int
     // If either is Float, result is Float (type promotion)
-    auto* left_prim = static_cast<PrimitiveType*>(left_type.get());
-    auto* right_prim = static_cast<PrimitiveType*>(right_type.get());
-
-    if (left_prim->primitive_kind == PrimitiveKind::Float ||
-        right_prim->primitive_kind == PrimitiveKind::Float) {
-        return std::make_unique<PrimitiveType>(PrimitiveKind::Float);
+    const auto* float_type = types_.primitive(PrimitiveKind::Float);
+    if (left_type == float_type || right_type == float_type) {
+        return types_.primitive(PrimitiveKind::Float);
     }
 
-    return std::make_unique<PrimitiveType>(PrimitiveKind::Int);
+    return types_.primitive(PrimitiveKind::Int);
 }
 
-auto TypeChecker::check_binary_comparison(ast::BinaryExpr* expr) -> std::unique_ptr<SemanticType> {
-    auto left_type = check_expression(*expr->left);
-    auto right_type = check_expression(*expr->right);
+auto TypeChecker::check_binary_comparison(ast::BinaryExpr* expr) -> const SemanticType* {
+    auto* left_type = check_expression(*expr->left);
+    auto* right_type = check_expression(*expr->right);
 
     using Op = ast::BinaryOp;
 
@@ -874,104 +1093,99 @@ auto TypeChecker::check_binary_comparison(ast::BinaryExpr* expr) -> std::unique_
     if (expr->op == Op::Lt || expr->op == Op::Gt ||
         expr->op == Op::Le || expr->op == Op::Ge) {
 
-        bool left_is_numeric = (left_type->kind == TypeKind::Primitive &&
-            (static_cast<PrimitiveType*>(left_type.get())->primitive_kind == PrimitiveKind::Int ||
-             static_cast<PrimitiveType*>(left_type.get())->primitive_kind == PrimitiveKind::Float));
+        bool left_is_numeric = is_numeric(left_type);
 
-        bool right_is_numeric = (right_type->kind == TypeKind::Primitive &&
-            (static_cast<PrimitiveType*>(right_type.get())->primitive_kind == PrimitiveKind::Int ||
-             static_cast<PrimitiveType*>(right_type.get())->primitive_kind == PrimitiveKind::Float));
+        bool right_is_numeric = is_numeric(right_type);
 
         if (!left_is_numeric || !right_is_numeric) {
             error(expr->location,
                   "Ordering comparison requires numeric types");
-            return std::make_unique<PrimitiveType>(PrimitiveKind::Bool);
+            return types_.primitive(PrimitiveKind::Bool);
         }
     }
 
     // For equality comparisons (==, !=), both sides must have same type
     if (expr->op == Op::Eq || expr->op == Op::Ne) {
-        if (!left_type->equals(*right_type)) {
+        if (!TypeContext::compatible(left_type, right_type)) {
             type_mismatch_error(expr->right->location, *left_type, *right_type);
         }
     }
 
     // All comparisons return Bool
-    return std::make_unique<PrimitiveType>(PrimitiveKind::Bool);
+    return types_.primitive(PrimitiveKind::Bool);
 }
 
-auto TypeChecker::check_binary_logical(ast::BinaryExpr* expr) -> std::unique_ptr<SemanticType> {
-    auto left_type = check_expression(*expr->left);
-    auto right_type = check_expression(*expr->right);
+auto TypeChecker::check_binary_logical(ast::BinaryExpr* expr) -> const SemanticType* {
+    auto* left_type = check_expression(*expr->left);
+    auto* right_type = check_expression(*expr->right);
 
     // Both operands must be Bool
-    auto bool_type = PrimitiveType(PrimitiveKind::Bool);
+    const auto* bool_type = types_.primitive(PrimitiveKind::Bool);
 
-    if (!left_type->equals(bool_type)) {
-        type_mismatch_error(expr->left->location, bool_type, *left_type);
+    if (!TypeContext::compatible(left_type, bool_type)) {
+        type_mismatch_error(expr->left->location, *bool_type, *left_type);
     }
 
-    if (!right_type->equals(bool_type)) {
-        type_mismatch_error(expr->right->location, bool_type, *right_type);
+    if (!TypeContext::compatible(right_type, bool_type)) {
+        type_mismatch_error(expr->right->location, *bool_type, *right_type);
     }
 
-    return std::make_unique<PrimitiveType>(PrimitiveKind::Bool);
+    return types_.primitive(PrimitiveKind::Bool);
 }
 
 // ===== Unary Operator Type Checking =====
 
-auto TypeChecker::check_unary_arithmetic(ast::UnaryExpr* expr) -> std::unique_ptr<SemanticType> {
-    auto operand_type = check_expression(*expr->operand);
+auto TypeChecker::check_unary_arithmetic(ast::UnaryExpr* expr) -> const SemanticType* {
+    auto* operand_type = check_expression(*expr->operand);
 
     // Operand must be Int or Float
-    bool is_numeric = (operand_type->kind == TypeKind::Primitive &&
-        (static_cast<PrimitiveType*>(operand_type.get())->primitive_kind == PrimitiveKind::Int ||
-         static_cast<PrimitiveType*>(operand_type.get())->primitive_kind == PrimitiveKind::Float));
-
-    if (!is_numeric) {
+    if (!is_numeric(operand_type)) {
         error(expr->operand->location,
               fmt::format("Unary arithmetic operator requires numeric type, got '{}'",
                          operand_type->to_string()));
-        return std::make_unique<UnknownType>();
+        return types_.unknown();
     }
 
     // Result has same type as operand
     return operand_type;
 }
 
-auto TypeChecker::check_unary_logical(ast::UnaryExpr* expr) -> std::unique_ptr<SemanticType> {
-    auto operand_type = check_expression(*expr->operand);
+auto TypeChecker::check_unary_logical(ast::UnaryExpr* expr) -> const SemanticType* {
+    auto* operand_type = check_expression(*expr->operand);
 
     // Operand must be Bool
-    auto bool_type = PrimitiveType(PrimitiveKind::Bool);
+    const auto* bool_type = types_.primitive(PrimitiveKind::Bool);
 
-    if (!operand_type->equals(bool_type)) {
-        type_mismatch_error(expr->operand->location, bool_type, *operand_type);
+    if (!TypeContext::compatible(operand_type, bool_type)) {
+        type_mismatch_error(expr->operand->location, *bool_type, *operand_type);
     }
 
-    return std::make_unique<PrimitiveType>(PrimitiveKind::Bool);
+    return types_.primitive(PrimitiveKind::Bool);
 }
 
 // ===== Pattern Checking =====
 
-auto TypeChecker::check_pattern(ast::Pattern& pattern, const SemanticType& expected_type) -> void {
+auto TypeChecker::check_pattern(ast::Pattern& pattern, const SemanticType* expected_type) -> void {
     switch (pattern.kind) {
         case ast::PatternKind::Identifier: {
             auto* id_pattern = static_cast<ast::IdentifierPattern*>(&pattern);
 
             // Declare the identifier with the expected type
-            bool success = symbol_table_.declare(
+            const auto* symbol = symbol_table_.declare_local(
                 id_pattern->name,
+                id_pattern->id,
                 SymbolKind::Variable,
-                expected_type.clone(),
+                expected_type,
                 pattern.location
             );
 
-            if (!success) {
+            if (!symbol) {
                 error(pattern.location,
                       fmt::format("Variable '{}' is already declared in this scope",
                                  id_pattern->name));
+                break;
             }
+            id_pattern->slot = symbol->slot;
             break;
         }
 
@@ -979,27 +1193,27 @@ auto TypeChecker::check_pattern(ast::Pattern& pattern, const SemanticType& expec
             auto* tuple_pattern = static_cast<ast::TuplePattern*>(&pattern);
 
             // Expected type must be a tuple
-            if (expected_type.kind != TypeKind::Tuple) {
+            if (expected_type->kind != TypeKind::Tuple) {
                 error(pattern.location,
                       fmt::format("Cannot destructure non-tuple type '{}' with tuple pattern",
-                                 expected_type.to_string()));
+                                 expected_type->to_string()));
                 return;
             }
 
-            auto& tuple_type = static_cast<const TupleType&>(expected_type);
+            auto element_types = TypeContext::element_types(expected_type);
 
             // Check that pattern arity matches tuple arity
-            if (tuple_pattern->elements.size() != tuple_type.element_types.size()) {
+            if (tuple_pattern->elements.size() != element_types.size()) {
                 error(pattern.location,
                       fmt::format("Tuple pattern has {} elements but type has {} elements",
                                  tuple_pattern->elements.size(),
-                                 tuple_type.element_types.size()));
+                                 element_types.size()));
                 return;
             }
 
             // Recursively check each element pattern
             for (size_t i = 0; i < tuple_pattern->elements.size(); ++i) {
-                check_pattern(*tuple_pattern->elements[i], *tuple_type.element_types[i]);
+                check_pattern(*tuple_pattern->elements[i], element_types[i]);
             }
             break;
         }
@@ -1,4 +1,6 @@
 #include <lucid/semantic/type_system.hpp>
+#include <algorithm>
+#include <functional>
 #include <sstream>
 
 namespace lucid {
@@ -219,6 +221,217 @@ auto unify_types(const SemanticType& t1, const SemanticType& t2)
     return std::nullopt;
 }
 
+// ===== TypeContext Implementation =====
+
+namespace {
+
+// What TypeContext keeps beside each interned type
+struct InternedInfo {
+    std::vector<const SemanticType*> components;  // Interned element, parameter and result types
+    bool has_unknown;                             // Unknown occurs somewhere in the type
+};
+
+// Concrete class of every interned type: an ordinary type object, so
+// to_string() and friends keep working, plus its InternedInfo
+template <typename T>
+class Interned final : public T, public InternedInfo {
+public:
+    template <typename... Args>
+    explicit Interned(InternedInfo info, Args&&... args)
+        : T(std::forward<Args>(args)...), InternedInfo(std::move(info)) {}
+};
+
+auto info(const SemanticType* type) -> const InternedInfo& {
+    switch (type->kind) {
+        case TypeKind::Primitive: return static_cast<const Interned<PrimitiveType>&>(*type);
+        case TypeKind::List: return static_cast<const Interned<ListType>&>(*type);
+        case TypeKind::Tuple: return static_cast<const Interned<TupleType>&>(*type);
+        case TypeKind::Function: return static_cast<const Interned<FunctionType>&>(*type);
+        case TypeKind::TypeVariable: return static_cast<const Interned<TypeVariable>&>(*type);
+        case TypeKind::Unknown: break;
+    }
+    return static_cast<const Interned<UnknownType>&>(*type);
+}
+
+auto any_unknown(std::span<const SemanticType* const> types) -> bool {
+    for (const auto* type : types) {
+        if (info(type).has_unknown) return true;
+    }
+    return false;
+}
+
+auto clone_all(std::span<const SemanticType* const> types)
+    -> std::vector<std::unique_ptr<SemanticType>> {
+    std::vector<std::unique_ptr<SemanticType>> clones;
+    clones.reserve(types.size());
+    for (const auto* type : types) {
+        clones.push_back(type->clone());
+    }
+    return clones;
+}
+
+} // namespace
+
+TypeContext::TypeContext() {
+    for (auto kind : {PrimitiveKind::Int, PrimitiveKind::Float,
+                      PrimitiveKind::String, PrimitiveKind::Bool}) {
+        types_.push_back(std::make_unique<Interned<PrimitiveType>>(InternedInfo{{}, false}, kind));
+        primitives_[static_cast<size_t>(kind)] = types_.back().get();
+    }
+    types_.push_back(std::make_unique<Interned<UnknownType>>(InternedInfo{{}, true}));
+    unknown_ = types_.back().get();
+}
+
+TypeContext::TypeContext(const TypeContext* parent)
+    : parent_(parent), primitives_(parent->primitives_), unknown_(parent->unknown_) {}
+
+TypeContext::~TypeContext() = default;
+
+auto TypeContext::list(const SemanticType* element) -> const SemanticType* {
+    for (const auto* context = parent_; context != nullptr; context = context->parent_) {
+        if (auto it = context->lists_.find(element); it != context->lists_.end()) {
+            return it->second;
+        }
+    }
+
+    auto [it, inserted] = lists_.try_emplace(element, nullptr);
+    if (inserted) {
+        types_.push_back(std::make_unique<Interned<ListType>>(
+            InternedInfo{{element}, info(element).has_unknown}, element->clone()));
+        it->second = types_.back().get();
+    }
+    return it->second;
+}
+
+auto TypeContext::tuple(std::span<const SemanticType* const> elements) -> const SemanticType* {
+    return composite(TypeKind::Tuple, elements);
+}
+
+auto TypeContext::function(std::span<const SemanticType* const> params,
+                           const SemanticType* result) -> const SemanticType* {
+    std::vector<const SemanticType*> components(params.begin(), params.end());
+    components.push_back(result);
+    return composite(TypeKind::Function, components);
+}
+
+auto TypeContext::composite(TypeKind kind, std::span<const SemanticType* const> components)
+    -> const SemanticType* {
+    for (const auto* context = this; context != nullptr; context = context->parent_) {
+        auto it = context->composites_.find(KeyView{kind, components});
+        if (it != context->composites_.end()) {
+            return it->second;
+        }
+    }
+
+    InternedInfo interned{{components.begin(), components.end()}, any_unknown(components)};
+    if (kind == TypeKind::Tuple) {
+        types_.push_back(std::make_unique<Interned<TupleType>>(
+            std::move(interned), clone_all(components)));
+    } else {
+        types_.push_back(std::make_unique<Interned<FunctionType>>(
+            std::move(interned), clone_all(components.first(components.size() - 1)),
+            components.back()->clone()));
+    }
+    const SemanticType* type = types_.back().get();
+    composites_.emplace(Key{kind, {components.begin(), components.end()}}, type);
+    return type;
+}
+
+auto TypeContext::type_variable(const std::string& name) -> const SemanticType* {
+    for (const auto* context = parent_; context != nullptr; context = context->parent_) {
+        if (auto it = context->variables_.find(name); it != context->variables_.end()) {
+            return it->second;
+        }
+    }
+
+    auto [it, inserted] = variables_.try_emplace(name, nullptr);
+    if (inserted) {
+        types_.push_back(std::make_unique<Interned<TypeVariable>>(InternedInfo{{}, false}, name));
+        it->second = types_.back().get();
+    }
+    return it->second;
+}
+
+auto TypeContext::intern(const SemanticType& type) -> const SemanticType* {
+    switch (type.kind) {
+        case TypeKind::Primitive:
+            return primitive(static_cast<const PrimitiveType&>(type).primitive_kind);
+        case TypeKind::List:
+            return list(intern(*static_cast<const ListType&>(type).element_type));
+        case TypeKind::Tuple: {
+            std::vector<const SemanticType*> elements;
+            for (const auto& element : static_cast<const TupleType&>(type).element_types) {
+                elements.push_back(intern(*element));
+            }
+            return tuple(elements);
+        }
+        case TypeKind::Function: {
+            const auto& function_type = static_cast<const FunctionType&>(type);
+            std::vector<const SemanticType*> params;
+            for (const auto& param : function_type.param_types) {
+                params.push_back(intern(*param));
+            }
+            return function(params, intern(*function_type.return_type));
+        }
+        case TypeKind::TypeVariable:
+            return type_variable(static_cast<const TypeVariable&>(type).name);
+        case TypeKind::Unknown:
+            break;
+    }
+    return unknown_;
+}
+
+auto TypeContext::element_type(const SemanticType* list) -> const SemanticType* {
+    return info(list).components.front();
+}
+
+auto TypeContext::element_types(const SemanticType* tuple) -> std::span<const SemanticType* const> {
+    return info(tuple).components;
+}
+
+auto TypeContext::param_types(const SemanticType* function) -> std::span<const SemanticType* const> {
+    const auto& components = info(function).components;
+    return std::span(components).first(components.size() - 1);
+}
+
+auto TypeContext::return_type(const SemanticType* function) -> const SemanticType* {
+    return info(function).components.back();
+}
+
+auto TypeContext::compatible(const SemanticType* t1, const SemanticType* t2) -> bool {
+    return t1 == t2 && !info(t1).has_unknown;
+}
+
+auto TypeContext::unify(const SemanticType* t1, const SemanticType* t2) const
+    -> const SemanticType* {
+    if (compatible(t1, t2)) {
+        return t1;
+    }
+    if (t1->kind == TypeKind::TypeVariable) {
+        return t2;
+    }
+    if (t2->kind == TypeKind::TypeVariable) {
+        return t1;
+    }
+    if (t1->kind == TypeKind::Unknown || t2->kind == TypeKind::Unknown) {
+        return unknown_;
+    }
+    return nullptr;
+}
+
+auto TypeContext::KeyHash::operator()(const KeyView& key) const -> size_t {
+    size_t hash = std::hash<int>{}(static_cast<int>(key.kind));
+    for (const auto* component : key.components) {
+        hash = hash * 31 + std::hash<const SemanticType*>{}(component);
+    }
+    return hash;
+}
+
+auto TypeContext::KeyEqual::operator()(const KeyView& a, const KeyView& b) const -> bool {
+    return a.kind == b.kind && std::equal(a.components.begin(), a.components.end(),
+                                          b.components.begin(), b.components.end());
+}
+
 // ===== TypeEnvironment Implementation =====
 
 TypeEnvironment::TypeEnvironment() {
@@ -244,6 +457,15 @@ auto TypeEnvironment::get_builtin(const std::string& name)
     return std::nullopt;
 }
 
+auto TypeEnvironment::builtin_kind(const std::string& name) const
+    -> std::optional<PrimitiveKind> {
+    if (name == "Int") return PrimitiveKind::Int;
+    if (name == "Float") return PrimitiveKind::Float;
+    if (name == "String") return PrimitiveKind::String;
+    if (name == "Bool") return PrimitiveKind::Bool;
+    return std::nullopt;
+}
+
 auto TypeEnvironment::is_builtin(const std::string& name) const -> bool {
     for (const auto& builtin : builtin_names_) {
         if (builtin == name) return true;
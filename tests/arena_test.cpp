@@ -0,0 +1,123 @@
+#include <lucid/frontend/arena.hpp>
+#include <lucid/frontend/parser.hpp>
+#include <lucid/semantic/type_checker.hpp>
+
+// Support both system Catch2 and amalgamated version
+#if __has_include(<catch2/catch_test_macros.hpp>)
+    #include <catch2/catch_test_macros.hpp>
+#else
+    #include <catch_amalgamated.hpp>
+#endif
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+using namespace lucid;
+
+namespace {
+
+constexpr const char* kProgram = R"(
+    function sum(xs: List[Int], acc: Int) returns Int {
+        return if xs.is_empty() { acc } else { sum(xs.tail(), acc + xs.head()) }
+    }
+
+    function main() returns Int {
+        let pair = (1, [2, 3])
+        return sum([1, 2, 3, 4], 0)
+    }
+)";
+
+auto is_aligned(void* pointer) -> bool {
+    return reinterpret_cast<uintptr_t>(pointer) % alignof(std::max_align_t) == 0;
+}
+
+} // namespace
+
+// ===== Arena =====
+
+TEST_CASE("Arena: Bump allocation", "[arena]") {
+    Arena arena;
+    REQUIRE(arena.chunk_count() == 0);
+
+    SECTION("allocations are aligned and distinct") {
+        auto* a = static_cast<std::byte*>(arena.allocate(1));
+        auto* b = static_cast<std::byte*>(arena.allocate(24));
+        auto* c = static_cast<std::byte*>(arena.allocate(8));
+        REQUIRE(is_aligned(a));
+        REQUIRE(is_aligned(b));
+        REQUIRE(is_aligned(c));
+        REQUIRE(b >= a + 1);
+        REQUIRE(c >= b + 24);
+        REQUIRE(arena.chunk_count() == 1);
+    }
+
+    SECTION("a full chunk starts a new one") {
+        for (size_t i = 0; i < Arena::kChunkSize / 64 + 1; ++i) {
+            arena.allocate(64);
+        }
+        REQUIRE(arena.chunk_count() == 2);
+    }
+
+    SECTION("oversized allocations get their own chunk") {
+        arena.allocate(16);
+        auto* big = arena.allocate(Arena::kChunkSize * 2);
+        REQUIRE(is_aligned(big));
+        REQUIRE(arena.chunk_count() == 2);
+
+        // The partly used chunk is still the one being filled
+        arena.allocate(16);
+        REQUIRE(arena.chunk_count() == 2);
+    }
+}
+
+TEST_CASE("Arena: Scopes nest", "[arena]") {
+    REQUIRE(Arena::current() == nullptr);
+
+    Arena outer;
+    {
+        ArenaScope outer_scope(outer);
+        REQUIRE(Arena::current() == &outer);
+
+        Arena inner;
+        {
+            ArenaScope inner_scope(inner);
+            REQUIRE(Arena::current() == &inner);
+        }
+        REQUIRE(Arena::current() == &outer);
+    }
+    REQUIRE(Arena::current() == nullptr);
+}
+
+// ===== Arena Nodes =====
+
+TEST_CASE("Arena: AST nodes come from the current arena", "[arena]") {
+    Arena arena;
+
+    SECTION("inside a scope") {
+        ArenaScope scope(arena);
+        auto result = parse_source(kProgram);
+        REQUIRE(result.is_ok());
+        auto program = std::move(*result.program);
+        REQUIRE(arena.bytes_allocated() > 0);
+
+        // Checking and freeing arena nodes works as for heap ones
+        semantic::TypeChecker checker;
+        REQUIRE(checker.check_program(*program).success);
+        program.reset();
+    }
+
+    SECTION("outside a scope") {
+        auto result = parse_source(kProgram);
+        REQUIRE(result.is_ok());
+        auto expr = std::make_unique<ast::IntLiteralExpr>(42, SourceLocation("test", 1, 1, 0, 2));
+        REQUIRE(arena.bytes_allocated() == 0);
+    }
+
+    SECTION("heap nodes can be freed inside a scope") {
+        auto expr = std::make_unique<ast::IntLiteralExpr>(42, SourceLocation("test", 1, 1, 0, 2));
+        ArenaScope scope(arena);
+        expr.reset();
+        REQUIRE(arena.bytes_allocated() == 0);
+    }
+}
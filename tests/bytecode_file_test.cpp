@@ -0,0 +1,246 @@
+// Support both system Catch2 and amalgamated version
+#if __has_include(<catch2/catch_test_macros.hpp>)
+    #include <catch2/catch_test_macros.hpp>
+#else
+    #include "catch_amalgamated.hpp"
+#endif
+
+#include <lucid/backend/bytecode.hpp>
+#include <lucid/backend/compiler.hpp>
+#include <lucid/backend/constant_folder.hpp>
+#include <lucid/backend/optimizer.hpp>
+#include <lucid/backend/vm.hpp>
+#include <fmt/format.h>
+#include <filesystem>
+#include <fstream>
+
+#include "test_support.hpp"
+
+using namespace lucid::backend;
+using namespace lucid;
+using namespace lucid::test;
+
+namespace {
+
+// Message of the exception load_from_file throws, or "" if it loads
+auto load_error(const std::string& path) -> std::string {
+    try {
+        Bytecode::load_from_file(path);
+    } catch (const std::runtime_error& e) {
+        return e.what();
+    }
+    return "";
+}
+
+constexpr const char* kProgram = R"(
+    function sum_to(n: Int, acc: Int) returns Int {
+        return if n == 0 { acc } else { sum_to(n - 1, acc + n) }
+    }
+
+    function main() returns Int {
+        let xs = [1, 2, 3]
+        let pair = (0.5, "half")
+        return sum_to(100, 0) + xs.length() + pair[1].length()
+    }
+)";
+
+} // namespace
+
+// ===== Round Trip =====
+
+TEST_CASE("Bytecode file: Round trip preserves the program", "[bytecode][file]") {
+    TempFile file("round_trip.lbc");
+    auto original = compile_source(kProgram, true);
+    original.save_to_file(file.path());
+
+    auto loaded = Bytecode::load_from_file(file.path());
+
+    REQUIRE(loaded.is_mapped());
+    REQUIRE(loaded.instructions.empty());
+    REQUIRE(std::equal(loaded.code().begin(), loaded.code().end(),
+                       original.instructions.begin(), original.instructions.end()));
+    REQUIRE(loaded.constants.size() == original.constants.size());
+    for (size_t i = 0; i < original.constants.size(); ++i) {
+        REQUIRE(loaded.constants[i] == original.constants[i]);
+    }
+    REQUIRE(loaded.functions.size() == original.functions.size());
+    for (size_t i = 0; i < original.functions.size(); ++i) {
+        REQUIRE(loaded.functions[i].name == original.functions[i].name);
+        REQUIRE(loaded.functions[i].offset == original.functions[i].offset);
+        REQUIRE(loaded.functions[i].param_count == original.functions[i].param_count);
+        REQUIRE(loaded.functions[i].local_count == original.functions[i].local_count);
+    }
+
+    VM vm;
+    REQUIRE(vm.call_function(loaded, "main", {}).as_int() == 5050 + 3 + 4);
+    REQUIRE(loaded.disassemble() == original.disassemble());
+}
+
+TEST_CASE("Bytecode file: Debug locations survive and own their filenames", "[bytecode][file]") {
+    TempFile file("debug.lbc");
+    Bytecode loaded;
+    {
+        auto original = compile_source(kProgram, true);
+        REQUIRE(original.debug_locations.size() == original.instructions.size());
+        original.save_to_file(file.path());
+        loaded = Bytecode::load_from_file(file.path());
+    }
+
+    REQUIRE(loaded.debug_locations.size() == loaded.code().size());
+    auto main = static_cast<size_t>(loaded.find_function("main"));
+    const auto& entry = loaded.debug_locations[loaded.functions[main].offset];
+    REQUIRE(entry.filename == "program.lucid");
+    REQUIRE(entry.line == 7);
+}
+
+TEST_CASE("Bytecode file: The code section is aligned for in-place execution", "[bytecode][file]") {
+    TempFile file("aligned.lbc");
+    compile_source(kProgram, true).save_to_file(file.path());
+
+    auto loaded = Bytecode::load_from_file(file.path());
+    REQUIRE(reinterpret_cast<uintptr_t>(loaded.code().data()) % 64 == 0);
+
+    // Editing copies the stream out of the mapping first
+    auto optimized = loaded;
+    optimize(optimized);
+    REQUIRE_FALSE(optimized.is_mapped());
+    REQUIRE(loaded.is_mapped());
+    VM vm;
+    REQUIRE(vm.call_function(optimized, "main", {}) == vm.call_function(loaded, "main", {}));
+}
+
+TEST_CASE("Bytecode file: A tag must match to load", "[bytecode][file]") {
+    TempFile file("tagged.lbc");
+    compile_source(kProgram, true).save_to_file(file.path(), std::string("key\0with nul", 12));
+
+    REQUIRE(Bytecode::load_from_file(file.path(), std::string("key\0with nul", 12)).is_mapped());
+    REQUIRE(load_error(file.path()).find("tag does not match") != std::string::npos);
+    REQUIRE_THROWS_AS(Bytecode::load_from_file(file.path(), "key"), std::runtime_error);
+}
+
+// ===== Rejection =====
+
+TEST_CASE("Bytecode file: Damaged files are rejected", "[bytecode][file]") {
+    TempFile file("damaged.lbc");
+    compile_source(kProgram, true).save_to_file(file.path());
+    const std::string good = file.read();
+
+    SECTION("truncated") {
+        file.write(good.substr(0, good.size() - 1));
+        REQUIRE(load_error(file.path()).find("truncated") != std::string::npos);
+    }
+
+    SECTION("flipped byte") {
+        std::string bad = good;
+        bad[bad.size() / 2] = static_cast<char>(bad[bad.size() / 2] ^ 0x40);
+        file.write(bad);
+        REQUIRE(load_error(file.path()).find("checksum mismatch") != std::string::npos);
+    }
+
+    SECTION("newer format version") {
+        std::string bad = good;
+        bad[8] = static_cast<char>(bad[8] + 1);
+        file.write(bad);
+        REQUIRE(load_error(file.path()).find(fmt::format("format version {} is not supported",
+                                                          kBytecodeFormatVersion + 1)) != std::string::npos);
+    }
+
+    SECTION("not bytecode") {
+        file.write("function main() returns Int { return 0 }");
+        REQUIRE(load_error(file.path()).find("not a Lucid bytecode file") != std::string::npos);
+    }
+
+    SECTION("missing") {
+        std::filesystem::remove(file.path());
+        REQUIRE(load_error(file.path()).find("Cannot open bytecode file") != std::string::npos);
+    }
+}
+
+TEST_CASE("Bytecode file: Out-of-range operands are rejected on load", "[bytecode][file]") {
+    TempFile file("operands.lbc");
+    Bytecode bc;
+    bc.add_function("main", 0, 0, 0);
+    bc.emit(OpCode::CONSTANT, uint16_t{3});  // Empty constant pool
+    bc.emit(OpCode::RETURN);
+    bc.save_to_file(file.path());
+
+    REQUIRE(load_error(file.path()).find("CONSTANT operand out of range") != std::string::npos);
+}
+
+TEST_CASE("Bytecode file: Jumps must land on an instruction of their function", "[bytecode][file]") {
+    TempFile file("jumps.lbc");
+    Bytecode bc;
+    bc.add_constant(Value(int64_t{1}));
+    bc.add_function("main", 0, 0, 0);
+    bc.emit(OpCode::CONSTANT, uint16_t{0});
+    bc.emit(OpCode::JUMP, uint16_t{0});
+    bc.emit(OpCode::RETURN);
+    bc.add_function("other", bc.instructions.size(), 0, 0);
+    bc.emit(OpCode::CONSTANT, uint16_t{0});
+    bc.emit(OpCode::RETURN);
+
+    SECTION("into an operand") {
+        bc.patch_jump(3, -5);  // Offset 1, CONSTANT's operand
+    }
+    SECTION("into another function") {
+        bc.patch_jump(3, 1);  // Offset 7, the start of other
+    }
+    bc.save_to_file(file.path());
+
+    REQUIRE(load_error(file.path()).find("JUMP operand out of range") != std::string::npos);
+}
+
+TEST_CASE("Bytecode file: Malformed function entries are rejected on load", "[bytecode][file]") {
+    TempFile file("functions.lbc");
+    Bytecode bc;
+    bc.add_constant(Value(int64_t{1}));
+    bc.emit(OpCode::CONSTANT, uint16_t{0});
+    bc.emit(OpCode::RETURN);
+
+    SECTION("entry inside an operand") {
+        bc.add_function("main", 1, 0, 0);
+        bc.save_to_file(file.path());
+        REQUIRE(load_error(file.path()).find("function 'main' does not start at an instruction") != std::string::npos);
+    }
+    SECTION("more parameters than locals") {
+        bc.add_function("main", 0, 2, 1);
+        bc.save_to_file(file.path());
+        REQUIRE(load_error(file.path()).find("function 'main' has more parameters than locals") != std::string::npos);
+    }
+}
+
+TEST_CASE("Bytecode file: Local slots beyond the frame are rejected on load", "[bytecode][file]") {
+    TempFile file("locals.lbc");
+    Bytecode bc;
+    bc.add_function("main", 0, 1, 1);
+
+    SECTION("load") {
+        bc.emit(OpCode::LOAD_LOCAL, uint16_t{1});
+        bc.emit(OpCode::RETURN);
+        bc.save_to_file(file.path());
+        REQUIRE(load_error(file.path()).find("LOAD_LOCAL operand out of range") != std::string::npos);
+    }
+    SECTION("store") {
+        bc.emit(OpCode::LOAD_LOCAL, uint16_t{0});
+        bc.emit(OpCode::STORE_LOCAL, uint16_t{1});
+        bc.emit(OpCode::RETURN);
+        bc.save_to_file(file.path());
+        REQUIRE(load_error(file.path()).find("STORE_LOCAL operand out of range") != std::string::npos);
+    }
+}
+
+TEST_CASE("Bytecode file: Deeply nested constants are rejected on load", "[bytecode][file]") {
+    TempFile file("nested.lbc");
+    Value nested(int64_t{1});
+    for (int i = 0; i < 1000; ++i) {
+        nested = Value(std::vector<Value>{nested});
+    }
+    Bytecode bc;
+    bc.add_constant(nested);
+    bc.add_function("main", 0, 0, 0);
+    bc.emit(OpCode::CONSTANT, uint16_t{0});
+    bc.emit(OpCode::RETURN);
+    bc.save_to_file(file.path());
+
+    REQUIRE(load_error(file.path()).find("constant nested deeper than") != std::string::npos);
+}
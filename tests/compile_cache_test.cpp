@@ -0,0 +1,202 @@
+// Support both system Catch2 and amalgamated version
+#if __has_include(<catch2/catch_test_macros.hpp>)
+    #include <catch2/catch_test_macros.hpp>
+#else
+    #include "catch_amalgamated.hpp"
+#endif
+
+#include <lucid/backend/compile_cache.hpp>
+#include <lucid/backend/compiler.hpp>
+#include <lucid/backend/vm.hpp>
+#include <fmt/format.h>
+#include <atomic>
+#include <chrono>
+#include <iterator>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+#include "test_support.hpp"
+
+using namespace lucid::backend;
+using namespace lucid;
+using namespace lucid::test;
+
+namespace {
+
+// A fresh cache directory, removed when the test ends
+class TempDir {
+public:
+    explicit TempDir(const std::string& name)
+        : path_(std::filesystem::temp_directory_path() / ("lucid_test_" + name)) {
+        std::filesystem::remove_all(path_);
+    }
+    ~TempDir() { std::filesystem::remove_all(path_); }
+
+    auto path() const -> const std::filesystem::path& { return path_; }
+
+private:
+    std::filesystem::path path_;
+};
+
+constexpr const char* kProgram = R"(
+    function main() returns Int {
+        let xs = [1, 2, 3]
+        return xs.length() * 14
+    }
+)";
+
+constexpr const char* kEdited = R"(
+    function main() returns Int {
+        let xs = [1, 2, 3]
+        return xs.length() * 15
+    }
+)";
+
+} // namespace
+
+// ===== Hits and Misses =====
+
+TEST_CASE("CompileCache: A stored program is found again", "[cache]") {
+    TempDir dir("cache_hit");
+    CompileCache cache(dir.path(), "test");
+
+    REQUIRE_FALSE(cache.load("cached.lucid", kProgram).has_value());
+
+    cache.store("cached.lucid", kProgram, compile_source(kProgram));
+    REQUIRE(std::filesystem::exists(cache.entry_path("cached.lucid", kProgram)));
+
+    auto hit = cache.load("cached.lucid", kProgram);
+    REQUIRE(hit.has_value());
+    REQUIRE(run_main(*hit).as_int() == 42);
+}
+
+TEST_CASE("CompileCache: Any change to the key is a miss", "[cache]") {
+    TempDir dir("cache_key");
+    CompileCache cache(dir.path(), "test");
+    cache.store("cached.lucid", kProgram, compile_source(kProgram));
+
+    REQUIRE_FALSE(cache.load("cached.lucid", kEdited).has_value());
+    REQUIRE_FALSE(cache.load("other.lucid", kProgram).has_value());
+    REQUIRE_FALSE(CompileCache(dir.path(), "test -O").load("cached.lucid", kProgram).has_value());
+
+    // Editing the source picks up the new program
+    cache.store("cached.lucid", kEdited, compile_source(kEdited));
+    REQUIRE(run_main(*cache.load("cached.lucid", kEdited)).as_int() == 45);
+    REQUIRE(run_main(*cache.load("cached.lucid", kProgram)).as_int() == 42);
+}
+
+TEST_CASE("CompileCache: An entry holding another key is a miss", "[cache]") {
+    TempDir dir("cache_collision");
+    CompileCache cache(dir.path(), "test");
+    cache.store("cached.lucid", kEdited, compile_source(kEdited));
+
+    // As if kEdited's key hashed to kProgram's entry name
+    std::filesystem::copy_file(cache.entry_path("cached.lucid", kEdited),
+                               cache.entry_path("cached.lucid", kProgram));
+    REQUIRE_FALSE(cache.load("cached.lucid", kProgram).has_value());
+
+    cache.store("cached.lucid", kProgram, compile_source(kProgram));
+    REQUIRE(run_main(*cache.load("cached.lucid", kProgram)).as_int() == 42);
+}
+
+TEST_CASE("CompileCache: A damaged entry is a miss and is replaced", "[cache]") {
+    TempDir dir("cache_damaged");
+    CompileCache cache(dir.path(), "test");
+    cache.store("cached.lucid", kProgram, compile_source(kProgram));
+
+    {
+        std::ofstream entry(cache.entry_path("cached.lucid", kProgram), std::ios::binary | std::ios::trunc);
+        entry << "LUCIDBC";
+    }
+    REQUIRE_FALSE(cache.load("cached.lucid", kProgram).has_value());
+
+    cache.store("cached.lucid", kProgram, compile_source(kProgram));
+    REQUIRE(cache.load("cached.lucid", kProgram).has_value());
+}
+
+TEST_CASE("CompileCache: The compiler identity names the format version", "[cache]") {
+    auto identity = CompileCache::compiler_identity();
+    REQUIRE(identity.find(fmt::format("bytecode v{}", kBytecodeFormatVersion)) != std::string::npos);
+    REQUIRE(identity == CompileCache::compiler_identity());
+}
+
+// ===== Pruning =====
+
+TEST_CASE("CompileCache: Least recently used entries are pruned on store", "[cache]") {
+    TempDir dir("cache_prune");
+    CompileCache cache(dir.path(), "test");
+    auto entries = [&dir] {
+        auto files = std::filesystem::directory_iterator(dir.path());
+        return std::distance(std::filesystem::begin(files), std::filesystem::end(files));
+    };
+    auto age = [](const std::filesystem::path& path, int hours) {
+        std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now() - std::chrono::hours(hours));
+    };
+    const auto first = cache.entry_path("a.lucid", kProgram);
+    const auto second = cache.entry_path("b.lucid", kProgram);
+    const auto third = cache.entry_path("c.lucid", kProgram);
+
+    SECTION("past the entry limit") {
+        cache.set_limits(2, CompileCache::kDefaultMaxBytes);
+        cache.store("a.lucid", kProgram, compile_source(kProgram));
+        cache.store("b.lucid", kProgram, compile_source(kProgram));
+        age(first, 2);
+        age(second, 1);
+        REQUIRE(cache.load("a.lucid", kProgram).has_value());  // Now the most recent
+
+        cache.store("c.lucid", kProgram, compile_source(kProgram));
+        REQUIRE(entries() == 2);
+        REQUIRE(std::filesystem::exists(first));
+        REQUIRE_FALSE(std::filesystem::exists(second));
+        REQUIRE(std::filesystem::exists(third));
+    }
+
+    SECTION("past the byte limit") {
+        cache.store("a.lucid", kProgram, compile_source(kProgram));
+        cache.set_limits(CompileCache::kDefaultMaxEntries, std::filesystem::file_size(first));
+        age(first, 1);
+
+        cache.store("b.lucid", kProgram, compile_source(kProgram));
+        REQUIRE(entries() == 1);
+        REQUIRE(std::filesystem::exists(second));
+
+        // The entry just written stays even when it alone is too big
+        cache.set_limits(0, 0);
+        cache.store("c.lucid", kProgram, compile_source(kProgram));
+        REQUIRE(entries() == 1);
+        REQUIRE(run_main(*cache.load("c.lucid", kProgram)).as_int() == 42);
+    }
+}
+
+// ===== Concurrency =====
+
+TEST_CASE("CompileCache: Concurrent writers and readers never see a partial entry", "[cache]") {
+    TempDir dir("cache_concurrent");
+    CompileCache cache(dir.path(), "test");
+    const Bytecode bytecode = compile_source(kProgram);
+
+    std::atomic<int> bad_loads{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < 20; ++i) {
+                cache.store("cached.lucid", kProgram, bytecode);
+                auto hit = cache.load("cached.lucid", kProgram);
+                if (!hit || run_main(*hit).as_int() != 42) {
+                    ++bad_loads;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    REQUIRE(bad_loads == 0);
+    // Only the entry itself is left behind, no temporaries
+    auto entries = std::distance(std::filesystem::directory_iterator(dir.path()),
+                                 std::filesystem::directory_iterator());
+    REQUIRE(entries == 1);
+}
@@ -0,0 +1,227 @@
+// Support both system Catch2 and amalgamated version
+#if __has_include(<catch2/catch_test_macros.hpp>)
+    #include <catch2/catch_test_macros.hpp>
+#else
+    #include "catch_amalgamated.hpp"
+#endif
+
+#include <lucid/backend/compile_server.hpp>
+#include <lucid/backend/compiler.hpp>
+#include <lucid/backend/constant_folder.hpp>
+#include <lucid/backend/vm.hpp>
+#include <stdexcept>
+#include <string>
+
+#include "test_support.hpp"
+
+using namespace lucid::backend;
+using namespace lucid;
+using namespace lucid::test;
+
+namespace {
+
+const std::string kProgram = R"(# Helpers first
+function square(x: Int) returns Int {
+    return x * x
+}
+
+function split(n: Int) returns (Int, Int) {
+    return (n / 10, n % 10)
+}
+
+function digits(n: Int) returns Int {
+    let (tens, ones) = split(n)
+    return tens + ones
+}
+
+function main() returns Int {
+    return square(7) + digits(42)
+}
+)";
+
+// The update succeeded with what compiling the whole source makes
+auto require_same(const CompileUpdate& update, const std::string& source) -> void {
+    REQUIRE(update.parse_errors.empty());
+    REQUIRE(update.type_errors.empty());
+    REQUIRE(update.bytecode.has_value());
+    const auto& bytecode = *update.bytecode;
+    auto expected = compile_source(source, true);
+
+    REQUIRE(bytecode.instructions == expected.instructions);
+    REQUIRE(bytecode.constants.size() == expected.constants.size());
+    for (size_t i = 0; i < expected.constants.size(); ++i) {
+        REQUIRE(bytecode.constants[i] == expected.constants[i]);
+    }
+    REQUIRE(bytecode.functions.size() == expected.functions.size());
+    for (size_t i = 0; i < expected.functions.size(); ++i) {
+        REQUIRE(bytecode.functions[i].name == expected.functions[i].name);
+        REQUIRE(bytecode.functions[i].offset == expected.functions[i].offset);
+        REQUIRE(bytecode.functions[i].local_count == expected.functions[i].local_count);
+    }
+    REQUIRE(bytecode.debug_locations.size() == expected.debug_locations.size());
+    for (size_t i = 0; i < expected.debug_locations.size(); ++i) {
+        REQUIRE(bytecode.debug_locations[i].line == expected.debug_locations[i].line);
+        REQUIRE(bytecode.debug_locations[i].column == expected.debug_locations[i].column);
+        REQUIRE(bytecode.debug_locations[i].offset == expected.debug_locations[i].offset);
+    }
+}
+
+auto replace(std::string source, const std::string& from, const std::string& to) -> std::string {
+    auto at = source.find(from);
+    if (at == std::string::npos) {
+        throw std::runtime_error("Not in the source: " + from);
+    }
+    return source.replace(at, from.size(), to);
+}
+
+auto run_main(const CompileUpdate& update) -> int64_t {
+    return test::run_main(*update.bytecode).as_int();
+}
+
+} // namespace
+
+TEST_CASE("CompileServer: The first update compiles everything", "[server]") {
+    CompileServer server("test");
+    auto update = server.update(kProgram);
+    require_same(update, kProgram);
+    REQUIRE(update.functions == 4);
+    REQUIRE(update.reparsed == 4);
+    REQUIRE(update.recompiled == 4);
+    REQUIRE(run_main(update) == 49 + 6);
+
+    // Nothing changed, nothing done
+    update = server.update(kProgram);
+    REQUIRE(update.reparsed == 0);
+    REQUIRE(update.recompiled == 0);
+    REQUIRE(run_main(update) == 55);
+}
+
+TEST_CASE("CompileServer: A body edit redoes that function only", "[server]") {
+    CompileServer server("test");
+    server.update(kProgram);
+
+    auto source = replace(kProgram, "return x * x", "let y = x + 1\n    return y * y");
+    auto update = server.update(source);
+    require_same(update, source);
+    REQUIRE(update.reparsed == 1);
+    REQUIRE(update.recompiled == 1);
+    REQUIRE(run_main(update) == 64 + 6);
+
+    // Lines added above move everything after, which is not recompiled
+    source = replace(source, "# Helpers first\n", "# Helpers first\n\n\n# and more\n");
+    update = server.update(source);
+    require_same(update, source);
+    REQUIRE(update.reparsed == 1);
+    REQUIRE(update.recompiled == 1);
+
+    // An edit ending on the line the next function starts on takes it too
+    source = replace(source, "}\n\nfunction split", "}  function split");
+    update = server.update(source);
+    require_same(update, source);
+    REQUIRE(update.reparsed == 2);
+}
+
+TEST_CASE("CompileServer: A signature edit checks the callers again", "[server]") {
+    CompileServer server("test");
+    server.update(kProgram);
+
+    // square's callers no longer type check
+    auto broken = replace(kProgram, "square(x: Int) returns Int {\n    return x * x",
+                          "square(x: Int, y: Int) returns Int {\n    return x * y");
+    auto update = server.update(broken);
+    REQUIRE(!update.bytecode.has_value());
+    REQUIRE(!update.type_errors.empty());
+    REQUIRE(update.type_errors.front().location.line == 16);
+    REQUIRE(update.reparsed == 2);
+
+    // The program that compiled is kept, and the next edit is compared with
+    // it: one span from square to main
+    auto fixed = replace(broken, "square(7)", "square(7, 3)");
+    update = server.update(fixed);
+    require_same(update, fixed);
+    REQUIRE(update.reparsed == 4);
+    REQUIRE(run_main(update) == 21 + 6);
+}
+
+TEST_CASE("CompileServer: Adding and removing functions renumbers the calls", "[server]") {
+    CompileServer server("test");
+    server.update(kProgram);
+
+    auto source = replace(kProgram, "function main()",
+                          "function cube(x: Int) returns Int {\n    return x * square(x)\n}\n\nfunction main()");
+    source = replace(source, "square(7) + digits(42)", "cube(3) + digits(42)");
+    auto update = server.update(source);
+    require_same(update, source);
+    REQUIRE(update.functions == 5);
+    REQUIRE(update.recompiled == 2);  // cube and main
+    REQUIRE(run_main(update) == 27 + 6);
+
+    source = replace(source, "function cube(x: Int) returns Int {\n    return x * square(x)\n}\n\n", "");
+    source = replace(source, "cube(3)", "square(3)");
+    update = server.update(source);
+    require_same(update, source);
+    REQUIRE(update.functions == 4);
+    REQUIRE(update.recompiled == 1);
+    REQUIRE(run_main(update) == 9 + 6);
+
+    // Every index moves; the chunks of split, digits and main are renumbered,
+    // not compiled. square's is, as its unit held the text inserted.
+    source = replace(source, "function square", "function zero() returns Int {\n    return 0\n}\n\nfunction square");
+    update = server.update(source);
+    require_same(update, source);
+    REQUIRE(update.recompiled == 2);
+
+    // split's result stays unpacked under its new name
+    source = replace(source, "function split(", "function halves(");
+    source = replace(source, "= split(n)", "= halves(n)");
+    update = server.update(source);
+    require_same(update, source);
+    REQUIRE(update.recompiled == 2);
+    REQUIRE(count_opcode(*update.bytecode, "halves", OpCode::RETURN_TUPLE) > 0);
+    REQUIRE(run_main(update) == 9 + 6);
+}
+
+TEST_CASE("CompileServer: A tuple that starts escaping recompiles the callers", "[server]") {
+    CompileServer server("test");
+    server.update(kProgram);
+
+    // split's result is now kept whole, so it is built again, and digits,
+    // which destructures it, takes it apart from a tuple
+    auto source = replace(kProgram, "return square(7) + digits(42)",
+                          "let pair = split(42)\n    return square(7) + digits(42) + pair[0]");
+    auto update = server.update(source);
+    require_same(update, source);
+    REQUIRE(update.reparsed == 1);
+    REQUIRE(update.recompiled == 3);
+    REQUIRE(run_main(update) == 49 + 6 + 4);
+}
+
+TEST_CASE("CompileServer: Parse errors leave the program as it was", "[server]") {
+    CompileServer server("test");
+    server.update(kProgram);
+
+    auto update = server.update(replace(kProgram, "return tens + ones", "return tens +"));
+    REQUIRE(!update.parse_errors.empty());
+    REQUIRE(!update.bytecode.has_value());
+
+    auto source = replace(kProgram, "return tens + ones", "return tens * ones");
+    update = server.update(source);
+    require_same(update, source);
+    REQUIRE(update.reparsed == 1);
+    REQUIRE(run_main(update) == 49 + 8);
+
+    // Deleting everything before main leaves it owning the start of the file
+    source = replace(source, "return square(7) + digits(42)", "return 3");
+    server.update(source);
+    source = replace(source, source.substr(source.find("function square"),
+                                           source.find("function main") - source.find("function square")), "");
+    update = server.update(source);
+    require_same(update, source);
+    REQUIRE(update.reparsed == 0);
+    REQUIRE(run_main(update) == 3);
+
+    source = replace(source, "# Helpers first", "# Only main");
+    update = server.update(source);
+    require_same(update, source);
+    REQUIRE(update.reparsed == 1);
+}
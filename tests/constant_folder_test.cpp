@@ -0,0 +1,195 @@
+// Support both system Catch2 and amalgamated version
+#if __has_include(<catch2/catch_test_macros.hpp>)
+    #include <catch2/catch_test_macros.hpp>
+#else
+    #include "catch_amalgamated.hpp"
+#endif
+
+#include <lucid/backend/constant_folder.hpp>
+#include <lucid/backend/compiler.hpp>
+#include <lucid/backend/vm.hpp>
+#include <lucid/frontend/parser.hpp>
+#include <lucid/frontend/lexer.hpp>
+#include <lucid/semantic/type_checker.hpp>
+
+#include "test_support.hpp"
+
+using namespace lucid::backend;
+using namespace lucid;
+using namespace lucid::test;
+
+namespace {
+
+struct Folded {
+    Bytecode bytecode;
+    FoldStats stats;
+};
+
+auto compile_folded(const std::string& source, bool fold = true) -> Folded {
+    Lexer lexer(source, "test");
+    Parser parser(lexer);
+    auto parse_result = parser.parse();
+    if (!parse_result.is_ok()) {
+        throw std::runtime_error("Parse error");
+    }
+
+    auto& program = *parse_result.program.value();
+    semantic::TypeChecker checker;
+    auto type_result = checker.check_program(program);
+    if (!type_result.errors.empty()) {
+        throw std::runtime_error("Type check error: " + type_result.errors.front().message);
+    }
+
+    FoldStats stats;
+    if (fold) {
+        stats = fold_constants(program);
+    }
+    Compiler compiler;
+    return {compiler.compile(&program), stats};
+}
+
+} // namespace
+
+// ===== Expressions =====
+
+TEST_CASE("ConstantFolder: Literal arithmetic becomes one constant", "[folder]") {
+    auto [bc, stats] = compile_folded(R"(
+        function main() returns Int {
+            return (2 + 3) * 4 - 10 / 5 % 3
+        }
+    )");
+
+    REQUIRE(stats.folded == 5);
+    REQUIRE(count_opcode(bc, OpCode::CONSTANT) == 1);
+    REQUIRE(count_opcode(bc, OpCode::MUL_INT) == 0);
+    REQUIRE(bc.constants.size() == 1);
+    REQUIRE(run_main(bc).as_int() == 18);
+}
+
+TEST_CASE("ConstantFolder: Folding matches the VM's results", "[folder]") {
+    const char* programs[] = {
+        "function main() returns Float { return 1.5 * 4.0 - 0.25 }",
+        "function main() returns Float { return 2 * 1.5 }",
+        "function main() returns Int { return 2 ** 10 }",
+        "function main() returns Int { return 0 - 7 / 2 }",
+        "function main() returns Int { return -(3 % 2) }",
+        "function main() returns Bool { return 1 < 2 and not (2.5 >= 3.0) }",
+        "function main() returns Bool { return \"abc\" != \"abd\" or false }",
+        "function main() returns Bool { return \"x\" == \"x\" }",
+        "function main() returns Bool { return true != false }",
+        "function main() returns String { return \"ab\" + \"c\" + \"\" }",
+    };
+
+    for (const char* source : programs) {
+        auto plain = compile_folded(source, false);
+        auto folded = compile_folded(source);
+        REQUIRE(folded.stats.folded > 0);
+        REQUIRE(run_main(folded.bytecode) == run_main(plain.bytecode));
+    }
+}
+
+TEST_CASE("ConstantFolder: Run-time errors are not folded away", "[folder]") {
+    auto [bc, stats] = compile_folded(R"(
+        function main() returns Int {
+            return 1 / 0
+        }
+    )");
+
+    REQUIRE(stats.folded == 0);
+    REQUIRE_THROWS_WITH(run_main(bc), "Division by zero");
+}
+
+TEST_CASE("ConstantFolder: Int overflow wraps as at run time", "[folder]") {
+    auto [bc, stats] = compile_folded(R"(
+        function main() returns Bool {
+            return 9223372036854775807 + 1 == 0 - 9223372036854775807 - 1
+                and (0 - 9223372036854775807 - 1) / (0 - 1) == 0 - 9223372036854775807 - 1
+                and (0 - 9223372036854775807 - 1) % (0 - 1) == 0
+        }
+    )");
+
+    REQUIRE(stats.folded > 0);
+    REQUIRE(count_opcode(bc, OpCode::ADD_INT) == 0);
+    REQUIRE(count_opcode(bc, OpCode::DIV_INT) == 0);
+    REQUIRE(run_main(bc).as_bool());
+}
+
+// ===== Branches =====
+
+TEST_CASE("ConstantFolder: Statically known branches are pruned", "[folder]") {
+    auto [bc, stats] = compile_folded(R"(
+        function main() returns Int {
+            let x = if 1 < 2 { 10 } else { 20 }
+            return if false { x } else { x + 1 }
+        }
+    )");
+
+    REQUIRE(stats.branches_pruned == 2);
+    REQUIRE(count_opcode(bc, OpCode::JUMP_IF_FALSE) == 0);
+    REQUIRE(count_opcode(bc, OpCode::JUMP) == 0);
+    REQUIRE(run_main(bc).as_int() == 11);
+}
+
+TEST_CASE("ConstantFolder: Unknown conditions keep both branches", "[folder]") {
+    auto [bc, stats] = compile_folded(R"(
+        function pick(n: Int) returns Int {
+            return if n > 0 { 1 + 1 } else { 3 * 3 }
+        }
+
+        function main() returns Int {
+            return pick(1) + pick(0)
+        }
+    )");
+
+    REQUIRE(stats.branches_pruned == 0);
+    REQUIRE(stats.folded == 2);
+    REQUIRE(count_opcode(bc, OpCode::JUMP_IF_FALSE) == 1);
+    REQUIRE(run_main(bc).as_int() == 11);
+}
+
+// ===== Constant Pool =====
+
+TEST_CASE("ConstantFolder: Literal tuples and lists load from the pool", "[folder]") {
+    auto [bc, stats] = compile_folded(R"(
+        function main() returns Int {
+            let xs = [1, 2, 3 * 4]
+            let ys = xs.append(5)
+            let pair = (1 + 1, "two")
+            return xs.length() + ys.length() + xs[2] + pair[0]
+        }
+    )");
+
+    REQUIRE(stats.constant_literals == 2);
+    REQUIRE(count_opcode(bc, OpCode::BUILD_LIST) == 0);
+    REQUIRE(count_opcode(bc, OpCode::BUILD_TUPLE) == 0);
+    // Appending to the shared constant copies it
+    REQUIRE(run_main(bc).as_int() == 3 + 4 + 12 + 2);
+    REQUIRE(run_main(bc).as_int() == 3 + 4 + 12 + 2);
+}
+
+TEST_CASE("ConstantFolder: Identical constants share a pool slot", "[folder]") {
+    Bytecode bc;
+    uint16_t a = bc.add_constant(Value(int64_t{7}));
+    uint16_t b = bc.add_constant(Value(int64_t{7}));
+    uint16_t c = bc.add_constant(Value(7.0));
+    uint16_t d = bc.add_constant(Value(std::string("7")));
+    uint16_t e = bc.add_constant(Value(std::string("7")));
+    uint16_t f = bc.add_constant(Value(0.0));
+    uint16_t g = bc.add_constant(Value(-0.0));
+
+    REQUIRE(a == b);
+    REQUIRE(d == e);
+    REQUIRE(a != c);
+    REQUIRE(c != d);
+    REQUIRE(f != g);
+    REQUIRE(bc.constants.size() == 5);
+
+    auto compiled = compile_folded(R"(
+        function main() returns Int {
+            let a = 5
+            let b = 5
+            return a + b + 5
+        }
+    )", false);
+    REQUIRE(compiled.bytecode.constants.size() == 1);
+}
@@ -0,0 +1,159 @@
+// Support both system Catch2 and amalgamated version
+#if __has_include(<catch2/catch_test_macros.hpp>)
+    #include <catch2/catch_test_macros.hpp>
+    #include <catch2/matchers/catch_matchers_string.hpp>
+#else
+    #include "catch_amalgamated.hpp"
+#endif
+
+#include <lucid/backend/compiler.hpp>
+#include <lucid/backend/constant_folder.hpp>
+#include <lucid/backend/cpp_emitter.hpp>
+#include <lucid/backend/vm.hpp>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <sys/wait.h>
+
+#include "test_support.hpp"
+
+using namespace lucid::backend;
+using namespace lucid;
+using namespace lucid::test;
+using Catch::Matchers::ContainsSubstring;
+
+namespace {
+
+auto emit_cpp(const std::string& source) -> std::string {
+    auto program = parse_checked(source, true);
+    CppEmitter emitter;
+    return emitter.emit(*program);
+}
+
+auto exit_status(const std::string& command) -> int {
+    int status = std::system(command.c_str());
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+constexpr const char* kProgram = R"(
+    function fib(n: Int) returns Int {
+        return if n <= 1 { n } else { fib(n - 1) + fib(n - 2) }
+    }
+
+    function sum_to(n: Int, acc: Int) returns Int {
+        return if n == 0 { acc } else { sum_to(n - 1, acc + n) }
+    }
+
+    function harmonic(n: Int, acc: Float) returns Float {
+        return if n == 0 { acc } else { harmonic(n - 1, acc + 1.0 / (n * 1.0)) }
+    }
+
+    function describe(xs: List[Int]) returns String {
+        let rest = xs.tail()
+        return to_string((xs.head(), rest.length(), rest.reverse()))
+    }
+
+    function main() returns Int {
+        let xs = [3, 1, 4, 1, 5]
+        println(describe(xs.append(9)))
+        println(to_string(harmonic(4, 0.0)))
+        let big = sum_to(1000000, 0)
+        println(big)
+        let flag = not (big < 0) and xs.length() == 5
+        return if flag { fib(15) % 256 } else { 0 }
+    }
+)";
+
+} // namespace
+
+// ===== Emission =====
+
+TEST_CASE("C++ emitter: Scalars become native C++ types", "[cpp_emitter]") {
+    auto cpp = emit_cpp(kProgram);
+
+    REQUIRE_THAT(cpp, ContainsSubstring("auto f_fib(int64_t v_n) -> int64_t"));
+    REQUIRE_THAT(cpp, ContainsSubstring("auto f_harmonic(int64_t v_n, double v_acc) -> double"));
+    REQUIRE_THAT(cpp, ContainsSubstring("auto f_describe(rt::Value v_xs) -> rt::Value"));
+    REQUIRE_THAT(cpp, ContainsSubstring("rt::sub(v_n, int64_t{1})"));
+    REQUIRE_THAT(cpp, ContainsSubstring(" = f_fib("));
+    REQUIRE_THAT(cpp, ContainsSubstring("int main()"));
+}
+
+TEST_CASE("C++ emitter: Self tail calls become loops", "[cpp_emitter]") {
+    auto cpp = emit_cpp(kProgram);
+
+    auto sum_to = cpp.substr(cpp.find("auto f_sum_to(int64_t v_n, int64_t v_acc) -> int64_t {"));
+    sum_to = sum_to.substr(0, sum_to.find("\n}\n"));
+    REQUIRE_THAT(sum_to, ContainsSubstring("for (;;) {"));
+    REQUIRE_THAT(sum_to, ContainsSubstring("v_acc = std::move("));
+    REQUIRE_THAT(sum_to, ContainsSubstring("continue;"));
+    REQUIRE_THAT(sum_to.substr(sum_to.find('{')), !ContainsSubstring("f_sum_to("));
+
+    // fib's calls are not in tail position
+    auto fib = cpp.substr(cpp.find("auto f_fib(int64_t v_n) -> int64_t {"));
+    fib = fib.substr(0, fib.find("\n}\n"));
+    REQUIRE_THAT(fib, !ContainsSubstring("for (;;)"));
+}
+
+TEST_CASE("C++ emitter: Lambdas are rejected", "[cpp_emitter]") {
+    REQUIRE_THROWS_WITH(emit_cpp(R"(
+        function main() returns Int {
+            let f = lambda x: x
+            return 0
+        }
+    )"), ContainsSubstring("Lambda expressions are not supported by the C++ backend"));
+}
+
+// ===== Native Build =====
+
+TEST_CASE("C++ emitter: Native executables behave like the VM", "[cpp_emitter]") {
+    auto program = parse_checked(kProgram, true);
+    CppEmitter emitter;
+    std::string cpp = emitter.emit(*program);
+
+    Compiler compiler;
+    auto bytecode = compiler.compile(program.get());
+    std::ostringstream expected_output;
+    VM vm;
+    vm.set_output_stream(expected_output);
+    auto expected = vm.call_function(bytecode, "main", {});
+
+    TempFile executable("aot_program");
+    TempFile output("aot_program.out");
+    CppEmitter::build_executable(cpp, executable.path(), false);
+
+    REQUIRE(exit_status(executable.path() + " > " + output.path()) == expected.as_int());
+    REQUIRE(output.read() == expected_output.str());
+    REQUIRE(output.read() == "(3, 5, [9, 5, 1, 4, 1])\n2.083333333333333\n500000500000\n");
+}
+
+TEST_CASE("C++ emitter: Native Int arithmetic wraps like the VM", "[cpp_emitter]") {
+    TempFile executable("aot_int_edges");
+    TempFile output("aot_int_edges.out");
+    CppEmitter::build_executable(emit_cpp(kIntEdgeCases), executable.path(), false);
+
+    REQUIRE(exit_status(executable.path() + " > " + output.path()) == (-7 & 0xFF));
+    REQUIRE(output.read() == kIntEdgeOutput);
+}
+
+TEST_CASE("C++ emitter: Native executables report runtime errors", "[cpp_emitter]") {
+    auto cpp = emit_cpp(R"(
+        function divide(a: Int, b: Int) returns Int {
+            return a / b
+        }
+
+        function main() returns Int {
+            println("before")
+            return divide(7, 0)
+        }
+    )");
+
+    TempFile executable("aot_error");
+    TempFile output("aot_error.out");
+    CppEmitter::build_executable(cpp, executable.path(), false);
+
+    REQUIRE(exit_status(executable.path() + " > " + output.path() + " 2>&1") == 1);
+    REQUIRE(output.read() == "before\nRuntime error: Division by zero\n");
+}
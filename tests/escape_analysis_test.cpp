@@ -0,0 +1,159 @@
+// Support both system Catch2 and amalgamated version
+#if __has_include(<catch2/catch_test_macros.hpp>)
+    #include <catch2/catch_test_macros.hpp>
+#else
+    #include "catch_amalgamated.hpp"
+#endif
+
+#include <lucid/backend/escape_analysis.hpp>
+#include <lucid/backend/compiler.hpp>
+#include <lucid/backend/constant_folder.hpp>
+#include <lucid/backend/optimizer.hpp>
+#include <lucid/backend/vm.hpp>
+
+#include "test_support.hpp"
+
+using namespace lucid::backend;
+using namespace lucid;
+using namespace lucid::test;
+
+namespace {
+
+constexpr const char* kDivMod = R"(
+    function divmod(a: Int, b: Int) returns (Int, Int) {
+        if a < b {
+            return (0, a)
+        }
+        let (q, r) = divmod(a - b, b)
+        return (q + 1, r)
+    }
+
+    function main() returns Int {
+        let (q, r) = divmod(47, 5)
+        return q * 100 + r
+    }
+)";
+
+} // namespace
+
+// ===== Analysis =====
+
+TEST_CASE("EscapeAnalysis: Tuples only ever destructured are returned unpacked", "[escape]") {
+    auto program = parse_checked(kDivMod, true);
+    auto unpacked = find_unpacked_results(*program);
+    REQUIRE(unpacked.size() == 1);
+    REQUIRE(unpacked.at("divmod") == 2);
+}
+
+TEST_CASE("EscapeAnalysis: A tuple that can escape is built", "[escape]") {
+    // Kept whole, passed as a value, or returned as something not a literal
+    auto program = parse_checked(R"(
+        function kept() returns (Int, Int) {
+            return (1, 2)
+        }
+
+        function passed() returns (Int, Int) {
+            return (3, 4)
+        }
+
+        function forwarded() returns (Int, Int) {
+            kept()
+        }
+
+        function bound() returns (Int, Int) {
+            let pair = (5, 6)
+            return pair
+        }
+
+        function main() returns Int {
+            let pair = kept()
+            let (a, b) = forwarded()
+            let (c, d) = bound()
+            let f = passed
+            return pair[0] + a + c
+        }
+    )", true);
+    REQUIRE(find_unpacked_results(*program).empty());
+}
+
+TEST_CASE("EscapeAnalysis: Returns inside lambdas are the lambda's", "[escape]") {
+    auto program = parse_checked(R"(
+        function pair(n: Int) returns (Int, Int) {
+            let doubled = [n].map(lambda x: x * 2)
+            return (n, doubled[0])
+        }
+
+        function main() returns Int {
+            let (a, b) = pair(4)
+            return a + b
+        }
+    )", true);
+    REQUIRE(find_unpacked_results(*program).at("pair") == 2);
+}
+
+// ===== Code =====
+
+TEST_CASE("Compiler: Destructured tuples are never built", "[escape][compiler]") {
+    auto bc = compile_source(kDivMod, true);
+    REQUIRE(count_opcode(bc, OpCode::BUILD_TUPLE) == 0);
+    REQUIRE(count_opcode(bc, OpCode::UNPACK_TUPLE) == 0);
+    REQUIRE(count_opcode(bc, OpCode::RETURN_TUPLE) >= 2);
+    REQUIRE(run_main(bc).as_int() == 902);
+
+    optimize(bc);
+    REQUIRE(run_main(bc).as_int() == 902);
+
+    auto literal = compile_source(R"(
+        function main() returns Int {
+            let ((a, b), c) = ((1, 2), 3)
+            return a * 100 + b * 10 + c
+        }
+    )", true);
+    REQUIRE(count_opcode(literal, OpCode::BUILD_TUPLE) == 0);
+    REQUIRE(run_main(literal).as_int() == 123);
+}
+
+TEST_CASE("VM: Tuple values are destructured with UNPACK_TUPLE", "[escape][vm]") {
+    auto bc = compile_source(R"(
+        function pairs() returns List[(Int, (Int, Int))] {
+            return [(1, (2, 3)), (4, (5, 6))]
+        }
+
+        function main() returns Int {
+            let items = pairs()
+            let (a, (b, c)) = items[1]
+            let (x, y) = items[0][1]
+            return a * 10000 + b * 1000 + c * 100 + x * 10 + y
+        }
+    )", true);
+    REQUIRE(count_opcode(bc, OpCode::UNPACK_TUPLE) == 3);
+    REQUIRE(run_main(bc).as_int() == 45623);
+}
+
+TEST_CASE("VM: Every element is evaluated before the pattern binds", "[escape][vm]") {
+    auto bc = compile_source(R"(
+        function swap(a: Int, b: Int) returns Int {
+            if a > 0 {
+                let (a, b) = (b, a)
+                a * 10 + b
+            } else {
+                0
+            }
+        }
+
+        function main() returns Int {
+            return swap(1, 2)
+        }
+    )", true);
+    REQUIRE(run_main(bc).as_int() == 21);
+}
+
+TEST_CASE("VM: An unpacked function called from the host returns a tuple", "[escape][vm]") {
+    auto bc = compile_source(kDivMod, true);
+    VM vm;
+    auto result = vm.call_function(bc, "divmod", {Value(int64_t{23}), Value(int64_t{7})});
+    REQUIRE(result.is_tuple());
+    REQUIRE(result.as_tuple().size() == 2);
+    REQUIRE(result.as_tuple()[0].as_int() == 3);
+    REQUIRE(result.as_tuple()[1].as_int() == 2);
+}
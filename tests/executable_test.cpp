@@ -0,0 +1,110 @@
+// Support both system Catch2 and amalgamated version
+#if __has_include(<catch2/catch_test_macros.hpp>)
+    #include <catch2/catch_test_macros.hpp>
+#else
+    #include "catch_amalgamated.hpp"
+#endif
+
+#include <lucid/backend/bytecode.hpp>
+#include <lucid/backend/compiler.hpp>
+#include <lucid/backend/vm.hpp>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sys/wait.h>
+
+#include "test_support.hpp"
+
+using namespace lucid::backend;
+using namespace lucid;
+using namespace lucid::test;
+
+namespace {
+
+auto exit_status(const std::string& command) -> int {
+    int status = std::system(command.c_str());
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+constexpr const char* kProgram = R"(
+    function triple(n: Int) returns Int {
+        return n * 3
+    }
+
+    function main() returns Int {
+        let xs = [1, 2, 3]
+        return triple(xs.length() + 11)
+    }
+)";
+
+} // namespace
+
+// ===== Payload =====
+
+TEST_CASE("Executable: An appended program loads back in place", "[bytecode][executable]") {
+    TempFile stub("stub.bin");
+    TempFile exe("payload.exe");
+    stub.write("not really an executable");
+
+    auto original = compile_source(kProgram);
+    original.save_as_executable(stub.path(), exe.path());
+
+    REQUIRE_FALSE(Bytecode::has_appended_program(stub.path()));
+    REQUIRE(Bytecode::has_appended_program(exe.path()));
+    REQUIRE(exe.read().starts_with("not really an executable"));
+    auto perms = std::filesystem::status(exe.path()).permissions();
+    REQUIRE((perms & std::filesystem::perms::owner_exec) != std::filesystem::perms::none);
+
+    auto loaded = Bytecode::load_from_executable(exe.path());
+    REQUIRE(loaded.is_mapped());
+    REQUIRE(reinterpret_cast<uintptr_t>(loaded.code().data()) % 64 == 0);
+    REQUIRE(loaded.disassemble() == original.disassemble());
+    VM vm;
+    REQUIRE(vm.call_function(loaded, "main", {}).as_int() == 42);
+}
+
+TEST_CASE("Executable: Building from an executable replaces its program", "[bytecode][executable]") {
+    TempFile stub("stub2.bin");
+    TempFile first("first.exe");
+    TempFile second("second.exe");
+    stub.write("stub");
+
+    compile_source(kProgram).save_as_executable(stub.path(), first.path());
+    compile_source("function main() returns Int { return 7 }").save_as_executable(first.path(), second.path());
+
+    REQUIRE(second.read().size() < first.read().size());
+    VM vm;
+    REQUIRE(vm.call_function(Bytecode::load_from_executable(second.path()), "main", {}).as_int() == 7);
+}
+
+TEST_CASE("Executable: A damaged payload is rejected", "[bytecode][executable]") {
+    TempFile stub("stub3.bin");
+    TempFile exe("damaged.exe");
+    stub.write("stub");
+    compile_source(kProgram).save_as_executable(stub.path(), exe.path());
+
+    std::string bytes = exe.read();
+    bytes[bytes.size() / 2] = static_cast<char>(bytes[bytes.size() / 2] ^ 0x40);
+    exe.write(bytes);
+
+    REQUIRE(Bytecode::has_appended_program(exe.path()));
+    REQUIRE_THROWS_WITH(Bytecode::load_from_executable(exe.path()),
+                        "Invalid program appended to '" + exe.path() + "': checksum mismatch");
+    REQUIRE_THROWS_WITH(Bytecode::load_from_executable(stub.path()),
+                        "No Lucid program is appended to '" + stub.path() + "'");
+}
+
+// ===== lucid-run =====
+
+#ifdef LUCID_RUNNER_PATH
+TEST_CASE("Executable: lucid-run executes the program appended to it", "[bytecode][executable]") {
+    TempFile exe("program.exe");
+    compile_source(kProgram).save_as_executable(LUCID_RUNNER_PATH, exe.path());
+    REQUIRE(exit_status(exe.path()) == 42);
+
+    // Bare, it runs a .lbc file
+    TempFile lbc("program.lbc");
+    compile_source(kProgram).save_to_file(lbc.path());
+    REQUIRE(exit_status(std::string(LUCID_RUNNER_PATH) + " " + lbc.path()) == 42);
+}
+#endif
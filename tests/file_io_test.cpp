@@ -0,0 +1,192 @@
+// Support both system Catch2 and amalgamated version
+#if __has_include(<catch2/catch_test_macros.hpp>)
+    #include <catch2/catch_test_macros.hpp>
+#else
+    #include "catch_amalgamated.hpp"
+#endif
+
+#include <lucid/backend/compiler.hpp>
+#include <lucid/backend/file_io.hpp>
+#include <lucid/backend/vm.hpp>
+#include <fmt/format.h>
+#include <filesystem>
+#include <fstream>
+
+#include "test_support.hpp"
+
+using namespace lucid::backend;
+using namespace lucid;
+using namespace lucid::test;
+
+namespace {
+
+auto run_main(const std::string& source) -> Value {
+    return test::run_main(compile_source(source));
+}
+
+auto read_all_lines(const std::string& path) -> std::vector<std::string> {
+    LineReader reader(path);
+    std::vector<std::string> lines;
+    std::string_view line;
+    while (reader.next(line)) {
+        lines.emplace_back(line);
+    }
+    return lines;
+}
+
+} // namespace
+
+// ===== LineReader =====
+
+TEST_CASE("LineReader: Splits on LF and CRLF, keeping a last unterminated line", "[file_io]") {
+    TempFile file("lines.txt");
+    file.write("one\r\ntwo\n\nthree");
+
+    REQUIRE(read_all_lines(file.path()) == std::vector<std::string>{"one", "two", "", "three"});
+
+    file.write("");
+    REQUIRE(read_all_lines(file.path()).empty());
+
+    LineReader missing("/nonexistent/lucid/file.txt");
+    std::string_view line;
+    REQUIRE_FALSE(missing.is_open());
+    REQUIRE_FALSE(missing.next(line));
+}
+
+TEST_CASE("LineReader: Lines longer than a chunk and across chunk boundaries", "[file_io]") {
+    TempFile file("long_lines.txt");
+    const std::string long_line(LineReader::kChunkSize * 2 + 17, 'x');
+    std::string contents = long_line + "\n";
+    for (int i = 0; i < 20000; ++i) {
+        contents += fmt::format("line {}\n", i);
+    }
+    file.write(contents);
+
+    auto lines = read_all_lines(file.path());
+    REQUIRE(lines.size() == 20001);
+    REQUIRE(lines[0] == long_line);
+    REQUIRE(lines[1] == "line 0");
+    REQUIRE(lines.back() == "line 19999");
+}
+
+// ===== Files =====
+
+TEST_CASE("MappedFile: A mapping outlives the file being replaced", "[file_io]") {
+    TempFile file("mapped.txt");
+    file.write("original contents");
+
+    MappedFile mapping(file.path());
+    REQUIRE(mapping.text() == "original contents");
+
+    const std::string replacement = "new";
+    auto error = replace_file(file.path(), {reinterpret_cast<const uint8_t*>(replacement.data()),
+                                            replacement.size()});
+    REQUIRE_FALSE(error);
+    REQUIRE(file.read() == "new");
+    REQUIRE(mapping.text() == "original contents");
+
+    REQUIRE_THROWS_WITH(MappedFile("/nonexistent/lucid/file.txt"),
+                        "Cannot open file: /nonexistent/lucid/file.txt");
+}
+
+TEST_CASE("read_file_value: Large files are mapped, small ones copied", "[file_io]") {
+    TempFile file("large.txt");
+    const std::string large(kMapThreshold + 100, 'a');
+    file.write(large);
+
+    Value mapped = read_file_value(file.path());
+    REQUIRE(mapped.string_length() == large.size());
+    REQUIRE(mapped.as_string() == large);
+
+    // Strings built from a mapped one are ordinary strings
+    Value longer = Value::concat(mapped, Value(std::string("!")));
+    REQUIRE(longer.as_string().size() == large.size() + 1);
+    Value copy = mapped.deep_copy();
+    REQUIRE(copy == mapped);
+
+    file.write("small");
+    REQUIRE(read_file_value(file.path()).as_string() == "small");
+    REQUIRE(read_file_value("/nonexistent/lucid/file.txt").as_string().empty());
+}
+
+TEST_CASE("append_to_file: Appends are buffered until something reads", "[file_io]") {
+    TempFile file("appended.txt");
+    file.write("start\n");
+
+    for (int i = 0; i < 3; ++i) {
+        REQUIRE(append_to_file(file.path(), fmt::format("{}\n", i)));
+    }
+    // read_file flushes first, so a program always sees its own appends
+    REQUIRE(read_file_value(file.path()).as_string() == "start\n0\n1\n2\n");
+
+    REQUIRE(append_to_file(file.path(), "3\n"));
+    flush_appended_files();
+    REQUIRE(file.read() == "start\n0\n1\n2\n3\n");
+
+    REQUIRE_FALSE(append_to_file("/nonexistent/lucid/file.txt", "x"));
+}
+
+// ===== Builtins =====
+
+TEST_CASE("VM: read_lines and for_each_line", "[file_io][vm]") {
+    TempFile input("input.txt");
+    TempFile output("output.txt");
+    input.write("alpha\nbeta\r\ngamma");
+
+    auto lines = run_main(fmt::format(R"(
+        function main() returns List[String] {{
+            return read_lines("{}")
+        }}
+    )", input.path()));
+    REQUIRE(lines.as_list().size() == 3);
+    REQUIRE(lines.as_list()[1].as_string() == "beta");
+
+    // The appends are flushed when main returns
+    auto count = run_main(fmt::format(R"(
+        function copy(line: String) returns Bool {{
+            return append_file("{}", line.to_upper() + "\n")
+        }}
+
+        function main() returns Int {{
+            return for_each_line("{}", copy)
+        }}
+    )", output.path(), input.path()));
+    REQUIRE(count.as_int() == 3);
+    REQUIRE(output.read() == "ALPHA\nBETA\nGAMMA\n");
+
+    auto missing = run_main(R"(
+        function main() returns Int {
+            return for_each_line("/nonexistent/lucid/file.txt", lambda line: line.length()) +
+                   read_lines("/nonexistent/lucid/file.txt").length()
+        }
+    )");
+    REQUIRE(missing.as_int() == 0);
+}
+
+TEST_CASE("VM: write_file replaces a file a read_file string still views", "[file_io][vm]") {
+    TempFile file("replaced.txt");
+    file.write(std::string(kMapThreshold, 'a'));
+
+    auto result = run_main(fmt::format(R"(
+        function main() returns Int {{
+            let before = read_file("{0}")
+            let written = write_file("{0}", "short")
+            return before.length() + read_file("{0}").length()
+        }}
+    )", file.path()));
+    REQUIRE(result.as_int() == static_cast<int64_t>(kMapThreshold) + 5);
+}
+
+TEST_CASE("Type checking: read_lines and for_each_line", "[file_io][type_checker]") {
+    REQUIRE_THROWS_WITH(compile_source(R"(
+        function main() returns Int {
+            return for_each_line("x", lambda a, b: a)
+        }
+    )"), "Type check error: Method 'for_each_line' expects a function of 1 parameters, got 2");
+
+    REQUIRE_THROWS_WITH(compile_source(R"(
+        function main() returns Int {
+            return read_lines(1).length()
+        }
+    )"), "Type check error: Type mismatch: expected 'String', got 'Int'");
+}
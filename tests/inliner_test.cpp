@@ -0,0 +1,221 @@
+// Support both system Catch2 and amalgamated version
+#if __has_include(<catch2/catch_test_macros.hpp>)
+    #include <catch2/catch_test_macros.hpp>
+#else
+    #include "catch_amalgamated.hpp"
+#endif
+
+#include <lucid/backend/inliner.hpp>
+#include <lucid/backend/compiler.hpp>
+#include <lucid/backend/constant_folder.hpp>
+#include <lucid/backend/optimizer.hpp>
+#include <lucid/backend/parallel_compiler.hpp>
+#include <lucid/backend/vm.hpp>
+#include <algorithm>
+
+#include "test_support.hpp"
+
+using namespace lucid::backend;
+using namespace lucid;
+using namespace lucid::test;
+
+namespace {
+
+struct Inlined {
+    Bytecode bytecode;
+    InlineStats stats;
+};
+
+auto compile_inlined(const std::string& source) -> Inlined {
+    auto program = parse_checked(source);
+    auto stats = inline_functions(*program);
+    fold_constants(*program);
+    Compiler compiler;
+    return {compiler.compile(program.get()), stats};
+}
+
+constexpr const char* kHelpers = R"(
+    function square(x: Int) returns Int {
+        x * x
+    }
+
+    function hypot2(a: Int, b: Int) returns Int {
+        let aa = square(a)
+        let bb = square(b)
+        aa + bb
+    }
+
+    function fib(n: Int) returns Int {
+        if n < 2 { n } else { fib(n - 1) + fib(n - 2) }
+    }
+
+    function main() returns Int {
+        let x = 3
+        let f = fib(10)
+        return hypot2(x, 4) + square(fib(5)) + hypot2(1, 2) + f
+    }
+)";
+
+} // namespace
+
+TEST_CASE("Inliner: Constant arguments fold through the inlined body", "[inliner]") {
+    auto [bc, stats] = compile_inlined(R"(
+        function square(x: Int) returns Int {
+            x * x
+        }
+
+        function main() returns Int {
+            return square(3) + 1
+        }
+    )");
+    REQUIRE(stats.inlined == 1);
+    REQUIRE(count_opcode(bc, "main", OpCode::CALL) == 0);
+    REQUIRE(count_opcode(bc, "main", OpCode::MUL_INT) == 0);
+    REQUIRE(run_main(bc).as_int() == 10);
+}
+
+TEST_CASE("Inliner: Locals move into the caller's frame", "[inliner]") {
+    auto [bc, stats] = compile_inlined(kHelpers);
+
+    // Both squares inside hypot2, then both calls in main to hypot2 (already
+    // flattened) and the one to square; fib calls itself and stays a call
+    REQUIRE(stats.inlined == 5);
+    REQUIRE(count_opcode(bc, "main", OpCode::CALL) + count_opcode(bc, "main", OpCode::TAIL_CALL) == 2);
+    REQUIRE(count_opcode(bc, "fib", OpCode::CALL) + count_opcode(bc, "fib", OpCode::TAIL_CALL) == 2);
+
+    const Bytecode::FunctionInfo* main = nullptr;
+    for (const auto& function : bc.functions) {
+        if (function.name == "main") {
+            main = &function;
+        }
+    }
+    REQUIRE(main != nullptr);
+    REQUIRE(main->local_count > 2);
+
+    // 25 + 25 + 5 + 55
+    REQUIRE(run_main(bc).as_int() == 110);
+}
+
+TEST_CASE("Inliner: Other arguments are evaluated once, in order", "[inliner]") {
+    auto [bc, stats] = compile_inlined(R"(
+        function twice(x: Int) returns Int {
+            x + x
+        }
+
+        function count(n: Int) returns Int {
+            if n == 0 { 0 } else { 1 + count(n - 1) }
+        }
+
+        function main() returns Int {
+            return twice(count(21))
+        }
+    )");
+    REQUIRE(stats.inlined == 1);
+    REQUIRE(count_opcode(bc, "main", OpCode::CALL) == 1);
+    REQUIRE(run_main(bc).as_int() == 42);
+}
+
+TEST_CASE("Inliner: Calls that cannot be inlined are kept", "[inliner]") {
+    auto program = parse_checked(R"(
+        function factor(n: Int) returns Int {
+            if n == 0 { 3 } else { factor(n - 1) }
+        }
+
+        function scale(x: Int) returns Int {
+            x * factor(1)
+        }
+
+        function early(x: Int) returns Int {
+            if x > 0 {
+                return x
+            }
+            0
+        }
+
+        function apply(x: Int) returns List[Int] {
+            [x].map(lambda y: y + 1)
+        }
+
+        function big(x: Int) returns Int {
+            let a = x * x + x * x + x * x
+            let b = a * a + a * a + a * a
+            a + b
+        }
+
+        function main() returns Int {
+            let factor = 5
+            return scale(factor) + early(2) + apply(1)[0] + big(1)
+        }
+    )");
+    auto stats = inline_functions(*program);
+    // Recursive, shadowed by main's `factor`, returning early, holding a
+    // lambda, too big
+    REQUIRE(stats.inlined == 0);
+
+    Compiler compiler;
+    auto bc = compiler.compile(program.get());
+    REQUIRE(count_opcode(bc, "main", OpCode::CALL) + count_opcode(bc, "main", OpCode::TAIL_CALL) == 4);
+    // 15 + 2 + 2 + (3 + 27)
+    REQUIRE(run_main(bc).as_int() == 49);
+}
+
+TEST_CASE("Inliner: Destructured calls are left to the escape analysis", "[inliner]") {
+    auto [bc, stats] = compile_inlined(R"(
+        function pair(n: Int) returns (Int, Int) {
+            (n, n + 1)
+        }
+
+        function main() returns Int {
+            let (a, b) = pair(4)
+            let whole = pair(a + b)
+            return whole[0] * 10 + whole[1]
+        }
+    )");
+    REQUIRE(stats.inlined == 1);
+    REQUIRE(count_opcode(bc, "main", OpCode::CALL) == 1);
+    REQUIRE(run_main(bc).as_int() == 100);
+}
+
+TEST_CASE("Compiler: A let inside an expression block leaves nothing behind", "[inliner][compiler]") {
+    auto program = parse_checked(R"(
+        function main() returns Int {
+            let c = true
+            return 1 + if c { let t = 2
+                              t * 10 } else { 0 }
+        }
+    )");
+    Compiler compiler;
+    auto bc = compiler.compile(program.get());
+    REQUIRE(run_main(bc).as_int() == 21);
+}
+
+TEST_CASE("Optimizer: Inlined code forms superinstructions with the caller's", "[inliner][optimizer]") {
+    auto [bc, stats] = compile_inlined(R"(
+        function add(a: Int, b: Int) returns Int {
+            a + b
+        }
+
+        function main() returns Int {
+            let x = 20
+            let y = 22
+            return add(x, y)
+        }
+    )");
+    REQUIRE(stats.inlined == 1);
+    optimize(bc);
+    REQUIRE(count_opcode(bc, "main", OpCode::CALL) == 0);
+    REQUIRE(count_opcode(bc, "main", OpCode::LOAD_LOCAL2) == 1);
+    REQUIRE(run_main(bc).as_int() == 42);
+}
+
+TEST_CASE("ParallelCompiler: Inlining gives the sequential bytecode", "[inliner][parallel]") {
+    auto sequential = compile_inlined(kHelpers);
+
+    auto program = parse_program(kHelpers);
+    ThreadPool pool(4);
+    auto result = compile_parallel(*program, pool, true);
+    REQUIRE(result.errors.empty());
+    REQUIRE(result.inline_stats.inlined == sequential.stats.inlined);
+    REQUIRE(result.bytecode->instructions == sequential.bytecode.instructions);
+    REQUIRE(run_main(*result.bytecode).as_int() == 110);
+}
@@ -0,0 +1,240 @@
+// Support both system Catch2 and amalgamated version
+#if __has_include(<catch2/catch_test_macros.hpp>)
+    #include <catch2/catch_test_macros.hpp>
+#else
+    #include "catch_amalgamated.hpp"
+#endif
+
+#include <lucid/backend/compiler.hpp>
+#include <lucid/backend/jit.hpp>
+#include <lucid/backend/optimizer.hpp>
+#include <lucid/backend/vm.hpp>
+#include <sstream>
+
+#include "test_support.hpp"
+
+using namespace lucid::backend;
+using namespace lucid;
+using namespace lucid::test;
+
+namespace {
+
+// Runs main() in the interpreter and with every function hot from its
+// first call, and requires the two to agree
+auto run_both(const Bytecode& bytecode) -> JitStats {
+    VM interpreter;
+    Value expected = interpreter.call_function(bytecode, "main", {});
+
+    VM vm;
+    vm.set_jit_threshold(1);
+    Value actual = vm.call_function(bytecode, "main", {});
+    REQUIRE(actual.type() == expected.type());
+    REQUIRE(actual.to_string() == expected.to_string());
+    return vm.jit_stats();
+}
+
+constexpr const char* kKernels = R"(
+    function fib(n: Int) returns Int {
+        return if n <= 1 { n } else { fib(n - 1) + fib(n - 2) }
+    }
+
+    function collatz(n: Int, steps: Int) returns Int {
+        return if n == 1 { steps } else {
+            if n % 2 == 0 { collatz(n / 2, steps + 1) } else { collatz(3 * n + 1, steps + 1) }
+        }
+    }
+
+    function newton(x: Float, guess: Float, steps: Int) returns Float {
+        return if steps == 0 { guess } else {
+            let next = (guess + x / guess) / 2.0
+            newton(x, next, steps - 1)
+        }
+    }
+
+    function scaled(n: Int, x: Float) returns Float {
+        return n * x - -x / 4.0
+    }
+
+    function signs(a: Int, b: Int) returns Int {
+        let same = (a < 0) == (b < 0)
+        return if same and not (a == 0) or b >= 100 { a % 7 - b / -3 } else { -a }
+    }
+
+    function main() returns Int {
+        let root = newton(2.0, 1.0, 6)
+        let exact = if root * root - 2.0 < 0.000001 { 1 } else { 0 }
+        let mixed = if scaled(3, 1.5) == 4.875 { 10 } else { 0 }
+        return fib(18) + collatz(27, 0) + exact + mixed + signs(-50, 3) + signs(9, -100) + signs(40, 200)
+    }
+)";
+
+} // namespace
+
+// ===== Translation =====
+
+TEST_CASE("JIT: Compiled code matches the interpreter", "[vm][jit]") {
+    if (!VM::jit_available()) {
+        REQUIRE_THROWS_WITH(VM().set_jit_threshold(1), "JIT is not available in this build");
+        SKIP("JIT not available in this build");
+    }
+
+    auto bytecode = compile_source(kKernels);
+    auto stats = run_both(bytecode);
+    REQUIRE(stats.compiled == 5);
+    REQUIRE(stats.rejected == 0);
+    REQUIRE(stats.native_calls > 0);
+    REQUIRE(stats.deopts == 0);
+
+    // Superinstructions from the peephole pass
+    optimize(bytecode);
+    REQUIRE(run_both(bytecode).compiled == 5);
+}
+
+TEST_CASE("JIT: Int overflow and division by -1 match the interpreter", "[vm][jit]") {
+    if (!VM::jit_available()) {
+        SKIP("JIT not available in this build");
+    }
+
+    auto bytecode = compile_source(kIntEdgeCases);
+    std::ostringstream output;
+    VM vm;
+    vm.set_output_stream(output);
+    vm.set_jit_threshold(1);
+    REQUIRE(vm.call_function(bytecode, "main", {}).as_int() == -7);
+    REQUIRE(output.str() == kIntEdgeOutput);
+    REQUIRE(vm.jit_stats().compiled == 6);
+    REQUIRE(vm.jit_stats().deopts == 0);
+}
+
+TEST_CASE("JIT: Float comparisons follow the interpreter for NaN and infinity", "[vm][jit]") {
+    if (!VM::jit_available()) {
+        SKIP("JIT not available in this build");
+    }
+
+    auto bytecode = compile_source(R"(
+        function grow(x: Float, n: Int) returns Float {
+            return if n == 0 { x } else { grow(x * x, n - 1) }
+        }
+
+        function bits(a: Float, b: Float) returns Int {
+            let lt = if a < b { 1 } else { 0 }
+            let le = if a <= b { 2 } else { 0 }
+            let gt = if a > b { 4 } else { 0 }
+            let ge = if a >= b { 8 } else { 0 }
+            let eq = if a == b { 16 } else { 0 }
+            let ne = if a != b { 32 } else { 0 }
+            return lt + le + gt + ge + eq + ne
+        }
+
+        function main() returns Int {
+            let inf = grow(10.0, 12)
+            let nan = inf - inf
+            return bits(nan, 1.0) + bits(1.0, nan) * 64 + bits(inf, inf) * 4096 + bits(-0.0, 0.0) * 262144
+        }
+    )");
+
+    REQUIRE(run_both(bytecode).compiled == 2);
+    optimize(bytecode);
+    REQUIRE(run_both(bytecode).compiled == 2);
+}
+
+TEST_CASE("JIT: Functions using other values stay interpreted", "[vm][jit]") {
+    if (!VM::jit_available()) {
+        SKIP("JIT not available in this build");
+    }
+
+    auto bytecode = compile_source(R"(
+        function label(n: Int) returns String {
+            return if n == 0 { "zero" } else { "many" }
+        }
+
+        function total(n: Int) returns Int {
+            return if n == 0 { 0 } else { label(n).length() + total(n - 1) }
+        }
+
+        function main() returns Int {
+            return total(20)
+        }
+    )");
+
+    auto stats = run_both(bytecode);
+    REQUIRE(stats.compiled == 0);
+    REQUIRE(stats.rejected == 2);
+    REQUIRE(stats.native_calls == 0);
+}
+
+// ===== Deoptimisation =====
+
+TEST_CASE("JIT: Runtime errors re-run the call in the interpreter", "[vm][jit]") {
+    if (!VM::jit_available()) {
+        SKIP("JIT not available in this build");
+    }
+
+    auto bytecode = compile_source(R"(
+        function divide(n: Int, d: Int) returns Int {
+            return if n == 0 { 100 / d } else { divide(n - 1, d) + 1 }
+        }
+
+        function main() returns Int {
+            return divide(5, 4) + divide(5, 0)
+        }
+    )");
+
+    VM vm;
+    vm.set_jit_threshold(1);
+    REQUIRE_THROWS_WITH(vm.call_function(bytecode, "main", {}), "Division by zero");
+    REQUIRE(vm.jit_stats().native_calls == 2);
+    REQUIRE(vm.jit_stats().deopts == 1);
+}
+
+TEST_CASE("JIT: Deep recursion falls back to the interpreter's limits", "[vm][jit]") {
+    if (!VM::jit_available()) {
+        SKIP("JIT not available in this build");
+    }
+
+    auto bytecode = compile_source(R"(
+        function depth(n: Int) returns Int {
+            return if n == 0 { 0 } else { 1 + depth(n - 1) }
+        }
+
+        function deep() returns Int {
+            return depth(15000)
+        }
+
+        function endless() returns Int {
+            return depth(-1)
+        }
+    )");
+
+    VM vm;
+    vm.set_jit_threshold(1);
+    REQUIRE(vm.call_function(bytecode, "deep", {}).as_int() == 15000);
+    REQUIRE(vm.jit_stats().deopts == 1);
+    REQUIRE_THROWS_WITH(vm.call_function(bytecode, "endless", {}), "Call stack overflow");
+}
+
+TEST_CASE("JIT: Self tail calls become native loops", "[vm][jit]") {
+    if (!VM::jit_available()) {
+        SKIP("JIT not available in this build");
+    }
+
+    auto bytecode = compile_source(R"(
+        function sum_to(n: Int, acc: Int) returns Int {
+            return if n == 0 { acc } else { sum_to(n - 1, acc + n) }
+        }
+
+        function harmonic(n: Int, acc: Float) returns Float {
+            return if n == 0 { acc } else { harmonic(n - 1, acc + 1.0 / (acc + 1.0)) }
+        }
+
+        function main() returns Int {
+            let h = harmonic(1000, 0.0)
+            return if h > 40.0 and h < 50.0 { sum_to(1000000, 0) } else { 0 }
+        }
+    )");
+
+    auto stats = run_both(bytecode);
+    REQUIRE(stats.compiled == 2);
+    REQUIRE(stats.native_calls == 2);
+    REQUIRE(stats.deopts == 0);
+}
@@ -61,22 +61,22 @@ TEST_CASE("Lexer: Integer literals", "[lexer]") {
     auto tokens = lexer.tokenize();
     
     REQUIRE(tokens[0].type == TokenType::IntLiteral);
-    REQUIRE(tokens[0].lexeme == "0");
-    REQUIRE(std::get<int64_t>(*tokens[0].value) == 0);
+    REQUIRE(lexer.lexeme(tokens[0]) == "0");
+    REQUIRE(std::get<int64_t>(lexer.literal(tokens[0])) == 0);
     
     REQUIRE(tokens[1].type == TokenType::IntLiteral);
-    REQUIRE(std::get<int64_t>(*tokens[1].value) == 42);
+    REQUIRE(std::get<int64_t>(lexer.literal(tokens[1])) == 42);
     
     REQUIRE(tokens[2].type == TokenType::Minus);
     REQUIRE(tokens[3].type == TokenType::IntLiteral);
-    REQUIRE(std::get<int64_t>(*tokens[3].value) == 17);
+    REQUIRE(std::get<int64_t>(lexer.literal(tokens[3])) == 17);
     
     REQUIRE(tokens[4].type == TokenType::IntLiteral);
-    REQUIRE(std::get<int64_t>(*tokens[4].value) == 1000);
+    REQUIRE(std::get<int64_t>(lexer.literal(tokens[4])) == 1000);
     
     REQUIRE(tokens[5].type == TokenType::IntLiteral);
-    REQUIRE(tokens[5].lexeme == "1_000_000");
-    REQUIRE(std::get<int64_t>(*tokens[5].value) == 1000000);
+    REQUIRE(lexer.lexeme(tokens[5]) == "1_000_000");
+    REQUIRE(std::get<int64_t>(lexer.literal(tokens[5])) == 1000000);
 }
 
 TEST_CASE("Lexer: Float literals", "[lexer]") {
@@ -84,16 +84,16 @@ TEST_CASE("Lexer: Float literals", "[lexer]") {
     auto tokens = lexer.tokenize();
     
     REQUIRE(tokens[0].type == TokenType::FloatLiteral);
-    REQUIRE(std::get<double>(*tokens[0].value) == 3.14);
+    REQUIRE(std::get<double>(lexer.literal(tokens[0])) == 3.14);
     
     REQUIRE(tokens[1].type == TokenType::FloatLiteral);
-    REQUIRE(std::get<double>(*tokens[1].value) == 0.5);
+    REQUIRE(std::get<double>(lexer.literal(tokens[1])) == 0.5);
     
     REQUIRE(tokens[2].type == TokenType::FloatLiteral);
-    REQUIRE(std::get<double>(*tokens[2].value) == 1.5e10);
+    REQUIRE(std::get<double>(lexer.literal(tokens[2])) == 1.5e10);
     
     REQUIRE(tokens[3].type == TokenType::FloatLiteral);
-    REQUIRE(std::get<double>(*tokens[3].value) == 2.5e-3);
+    REQUIRE(std::get<double>(lexer.literal(tokens[3])) == 2.5e-3);
 }
 
 TEST_CASE("Lexer: String literals", "[lexer]") {
@@ -101,13 +101,13 @@ TEST_CASE("Lexer: String literals", "[lexer]") {
     auto tokens = lexer.tokenize();
     
     REQUIRE(tokens[0].type == TokenType::StringLiteral);
-    REQUIRE(std::get<std::string>(*tokens[0].value) == "hello");
+    REQUIRE(std::get<std::string>(lexer.literal(tokens[0])) == "hello");
     
     REQUIRE(tokens[1].type == TokenType::StringLiteral);
-    REQUIRE(std::get<std::string>(*tokens[1].value) == "world");
+    REQUIRE(std::get<std::string>(lexer.literal(tokens[1])) == "world");
     
     REQUIRE(tokens[2].type == TokenType::StringLiteral);
-    REQUIRE(std::get<std::string>(*tokens[2].value) == "with\nnewline");
+    REQUIRE(std::get<std::string>(lexer.literal(tokens[2])) == "with\nnewline");
 }
 
 TEST_CASE("Lexer: Identifiers", "[lexer]") {
@@ -115,16 +115,16 @@ TEST_CASE("Lexer: Identifiers", "[lexer]") {
     auto tokens = lexer.tokenize();
     
     REQUIRE(tokens[0].type == TokenType::Identifier);
-    REQUIRE(tokens[0].lexeme == "foo");
+    REQUIRE(lexer.lexeme(tokens[0]) == "foo");
     
     REQUIRE(tokens[1].type == TokenType::Identifier);
-    REQUIRE(tokens[1].lexeme == "bar_baz");
+    REQUIRE(lexer.lexeme(tokens[1]) == "bar_baz");
     
     REQUIRE(tokens[2].type == TokenType::Identifier);
-    REQUIRE(tokens[2].lexeme == "_internal");
+    REQUIRE(lexer.lexeme(tokens[2]) == "_internal");
     
     REQUIRE(tokens[3].type == TokenType::Identifier);
-    REQUIRE(tokens[3].lexeme == "x123");
+    REQUIRE(lexer.lexeme(tokens[3]) == "x123");
 }
 
 TEST_CASE("Lexer: Operators", "[lexer]") {
@@ -206,8 +206,8 @@ TEST_CASE("Lexer: Multi-line comments", "[lexer]") {
     bool found_y = false;
     for (const auto& token : tokens) {
         if (token.type == TokenType::Identifier) {
-            if (token.lexeme == "x") found_x = true;
-            if (token.lexeme == "y") found_y = true;
+            if (lexer.lexeme(token) == "x") found_x = true;
+            if (lexer.lexeme(token) == "y") found_y = true;
         }
     }
     
@@ -225,15 +225,15 @@ TEST_CASE("Lexer: Complete function", "[lexer]") {
     
     REQUIRE(tokens[0].type == TokenType::Function);
     REQUIRE(tokens[1].type == TokenType::Identifier);
-    REQUIRE(tokens[1].lexeme == "add");
+    REQUIRE(lexer.lexeme(tokens[1]) == "add");
     REQUIRE(tokens[2].type == TokenType::LeftParen);
     REQUIRE(tokens[3].type == TokenType::Identifier);
-    REQUIRE(tokens[3].lexeme == "x");
+    REQUIRE(lexer.lexeme(tokens[3]) == "x");
     REQUIRE(tokens[4].type == TokenType::Colon);
     REQUIRE(tokens[5].type == TokenType::TypeInt);
     REQUIRE(tokens[6].type == TokenType::Comma);
     REQUIRE(tokens[7].type == TokenType::Identifier);
-    REQUIRE(tokens[7].lexeme == "y");
+    REQUIRE(lexer.lexeme(tokens[7]) == "y");
     REQUIRE(tokens[8].type == TokenType::Colon);
     REQUIRE(tokens[9].type == TokenType::TypeInt);
     REQUIRE(tokens[10].type == TokenType::RightParen);
@@ -242,10 +242,10 @@ TEST_CASE("Lexer: Complete function", "[lexer]") {
     REQUIRE(tokens[13].type == TokenType::LeftBrace);
     REQUIRE(tokens[14].type == TokenType::Return);
     REQUIRE(tokens[15].type == TokenType::Identifier);
-    REQUIRE(tokens[15].lexeme == "x");
+    REQUIRE(lexer.lexeme(tokens[15]) == "x");
     REQUIRE(tokens[16].type == TokenType::Plus);
     REQUIRE(tokens[17].type == TokenType::Identifier);
-    REQUIRE(tokens[17].lexeme == "y");
+    REQUIRE(lexer.lexeme(tokens[17]) == "y");
     REQUIRE(tokens[18].type == TokenType::RightBrace);
 }
 
@@ -266,16 +266,16 @@ TEST_CASE("Lexer: Location tracking", "[lexer]") {
     auto tokens = lexer.tokenize();
     
     // First line
-    REQUIRE(tokens[0].location.line == 1);
-    REQUIRE(tokens[0].location.column == 1);
-    REQUIRE(tokens[0].location.filename == "test.lucid");
+    REQUIRE(tokens[0].line == 1);
+    REQUIRE(tokens[0].column == 1);
+    REQUIRE(lexer.location(tokens[0]).filename == "test.lucid");
     
-    REQUIRE(tokens[1].location.line == 1);
-    REQUIRE(tokens[1].location.column == 5);
+    REQUIRE(tokens[1].line == 1);
+    REQUIRE(tokens[1].column == 5);
     
     // Second line (after newline)
-    REQUIRE(tokens[4].location.line == 2);
-    REQUIRE(tokens[4].location.column == 1);
+    REQUIRE(tokens[4].line == 2);
+    REQUIRE(tokens[4].column == 1);
 }
 
 TEST_CASE("Lexer: Error - unterminated string", "[lexer]") {
@@ -283,7 +283,7 @@ TEST_CASE("Lexer: Error - unterminated string", "[lexer]") {
     auto tokens = lexer.tokenize();
     
     REQUIRE(tokens[0].type == TokenType::Error);
-    REQUIRE(tokens[0].value.has_value());
+    REQUIRE(tokens[0].has_literal());
     // Error message should mention unterminated string
 }
 
@@ -334,3 +334,39 @@ TEST_CASE("Lexer: Streaming API", "[lexer]") {
     auto tok6 = lexer.next_token();
     REQUIRE(tok6.type == TokenType::Eof);
 }
+
+TEST_CASE("Lexer: Long runs cross scan blocks", "[lexer]") {
+    // Identifiers, blanks, comments and string bodies longer than the
+    // 16-byte scan blocks, with newlines inside and after them
+    std::string source =
+        "let a_rather_long_identifier_name_spanning_blocks = 1\n"
+        "                                    \n\n   \t  \n"
+        "# a comment line that is longer than a single block\n"
+        "#[ block comment ] not closed yet\n"
+        "   still inside the comment ]#\n"
+        "\"a string body with an \\\"escape\\\" well past sixteen bytes\"\n"
+        "returnsx";
+    Lexer lexer(source);
+    auto tokens = lexer.tokenize();
+
+    REQUIRE(tokens.size() == 7);
+    REQUIRE(tokens[1].type == TokenType::Identifier);
+    REQUIRE(lexer.lexeme(tokens[1]) == "a_rather_long_identifier_name_spanning_blocks");
+    REQUIRE(tokens[4].type == TokenType::StringLiteral);
+    REQUIRE(std::get<std::string>(lexer.literal(tokens[4])) ==
+            "a string body with an \"escape\" well past sixteen bytes");
+    REQUIRE(tokens[4].line == 8);
+    REQUIRE(tokens[4].column == 1);
+    REQUIRE(tokens[5].type == TokenType::Identifier);
+    REQUIRE(tokens[5].line == 9);
+}
+
+TEST_CASE("Lexer: Keyword lookalikes stay identifiers", "[lexer]") {
+    Lexer lexer("lets iff Integer nots o an functions Lambda");
+    auto tokens = lexer.tokenize();
+
+    REQUIRE(tokens.size() == 9);
+    for (size_t i = 0; i + 1 < tokens.size(); ++i) {
+        REQUIRE(tokens[i].type == TokenType::Identifier);
+    }
+}
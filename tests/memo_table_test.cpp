@@ -0,0 +1,196 @@
+// Support both system Catch2 and amalgamated version
+#if __has_include(<catch2/catch_test_macros.hpp>)
+    #include <catch2/catch_test_macros.hpp>
+#else
+    #include "catch_amalgamated.hpp"
+#endif
+
+#include <lucid/backend/compiler.hpp>
+#include <lucid/backend/memo_table.hpp>
+#include <lucid/backend/vm.hpp>
+#include <stdexcept>
+#include <string>
+
+#include "test_support.hpp"
+
+using namespace lucid::backend;
+using namespace lucid;
+using namespace lucid::test;
+
+namespace {
+
+auto effect_of(const Bytecode& bytecode, const std::string& name) -> std::string {
+    auto effects = find_effects(bytecode);
+    return std::string(effects[static_cast<size_t>(bytecode.find_function(name))]);
+}
+
+const std::string kFib = R"(
+function fib(n: Int) returns Int {
+    return if n <= 1 { n } else { fib(n - 1) + fib(n - 2) }
+}
+)";
+
+} // namespace
+
+TEST_CASE("find_effects: Effects reach every caller", "[memo]") {
+    auto bytecode = compile_source(kFib + R"(
+function log(x: Int) returns Int {
+    println(x)
+    return x
+}
+
+function logged(n: Int) returns Int {
+    return log(n) + 1
+}
+
+function label(n: Int) returns String {
+    return to_string(n) + "!"
+}
+
+function doubled(xs: List[Int]) returns List[Int] {
+    return xs.map(lambda x: x * 2)
+}
+
+function loud(xs: List[Int]) returns List[Int] {
+    return xs.map(lambda x: log(x))
+}
+
+function via_value(n: Int) returns Int {
+    let f = log
+    return f(n)
+}
+
+function saves(text: String) returns Bool {
+    return write_file("out.txt", text)
+}
+)");
+
+    REQUIRE(effect_of(bytecode, "fib").empty());
+    REQUIRE(effect_of(bytecode, "log") == "println");
+    REQUIRE(effect_of(bytecode, "logged") == "println");
+    REQUIRE(effect_of(bytecode, "label").empty());
+    REQUIRE(effect_of(bytecode, "doubled").empty());
+    REQUIRE(effect_of(bytecode, "loud") == "println");
+    REQUIRE(effect_of(bytecode, "via_value") == "println");
+    REQUIRE(effect_of(bytecode, "saves") == "write_file");
+}
+
+TEST_CASE("MemoTable: Keeps the most recently used entries", "[memo]") {
+    MemoTable table(2);
+    const Value one[] = {Value(int64_t{1})};
+    const Value two[] = {Value(int64_t{2})};
+    const Value three[] = {Value(int64_t{3})};
+
+    table.insert(one, Value(int64_t{10}), false);
+    table.insert(two, Value(int64_t{20}), false);
+    REQUIRE(table.find(one)->result == Value(int64_t{10}));
+
+    // two is now the oldest
+    table.insert(three, Value(int64_t{30}), false);
+    REQUIRE(table.size() == 2);
+    REQUIRE(table.find(two) == nullptr);
+    REQUIRE(table.find(one)->result == Value(int64_t{10}));
+    REQUIRE(table.find(three)->result == Value(int64_t{30}));
+
+    table.clear();
+    REQUIRE(table.find(one) == nullptr);
+}
+
+TEST_CASE("MemoTable: Keys compare by content", "[memo]") {
+    MemoTable table;
+    const Value list[] = {Value(std::vector<Value>{Value(int64_t{1}), Value(std::string("a"))}, false)};
+    const Value same[] = {Value(std::vector<Value>{Value(int64_t{1}), Value(std::string("a"))}, false)};
+    const Value tuple[] = {Value(std::vector<Value>{Value(int64_t{1}), Value(std::string("a"))}, true)};
+    table.insert(list, Value(true), false);
+    REQUIRE(table.find(same) != nullptr);
+    REQUIRE(table.find(tuple) == nullptr);
+
+    // 0.0 == -0.0, but they print differently
+    const Value zero[] = {Value(0.0)};
+    const Value negative_zero[] = {Value(-0.0)};
+    table.insert(zero, Value(std::string("0")), false);
+    REQUIRE(table.find(negative_zero) == nullptr);
+
+    const Value function[] = {Value(int64_t{1}), Value::make_function(0, "f")};
+    REQUIRE_FALSE(MemoTable::cacheable(function));
+    table.insert(function, Value(int64_t{2}), false);
+    REQUIRE(table.find(function) == nullptr);
+}
+
+TEST_CASE("VM: Memoized recursion runs in linear time", "[memo]") {
+    auto bytecode = compile_source(kFib + R"(
+function main() returns Int {
+    return fib(25)
+}
+)");
+    VM vm;
+    REQUIRE(vm.call_function(bytecode, "main", {}).as_int() == 75025);
+    const auto plain = vm.instructions_executed();
+
+    vm.reset_instruction_count();
+    vm.set_memoized({"fib"});
+    REQUIRE(vm.call_function(bytecode, "main", {}).as_int() == 75025);
+    REQUIRE(vm.instructions_executed() * 100 < plain);
+
+    // Far out of reach without the cache
+    REQUIRE(vm.call_function(bytecode, "fib", {Value(int64_t{90})}).as_int() == 2880067194370816120);
+
+    // Three entries are enough: when fib(n - 1) returns, fib(n - 2) was
+    // used just before fib(n - 3)
+    vm.set_memoized({"fib"}, 3);
+    vm.reset_instruction_count();
+    REQUIRE(vm.call_function(bytecode, "fib", {Value(int64_t{25})}).as_int() == 75025);
+    REQUIRE(vm.instructions_executed() * 100 < plain);
+}
+
+TEST_CASE("VM: Memoized functions may return unpacked tuples and take lists", "[memo]") {
+    auto bytecode = compile_source(R"(
+function split(n: Int) returns (Int, Int) {
+    return (n / 10, n % 10)
+}
+
+function total(xs: List[Int]) returns Int {
+    return xs.fold(0, lambda acc, x: acc + x)
+}
+
+function main() returns Int {
+    let (a, b) = split(42)
+    let (c, d) = split(42)
+    let (e, f) = split(57)
+    return a * 1000 + b * 100 + c * 10 + d + e + f + total([1, 2, 3]) + total([1, 2, 3])
+}
+)");
+    VM vm;
+    vm.set_memoized({"split", "total"});
+    REQUIRE(vm.call_function(bytecode, "main", {}).as_int() == 4242 + 12 + 12);
+
+    // Called from the host, the tuple is built after all
+    auto pair = vm.call_function(bytecode, "split", {Value(int64_t{42})});
+    REQUIRE(pair.as_tuple().size() == 2);
+    REQUIRE(pair.as_tuple()[1].as_int() == 2);
+}
+
+TEST_CASE("VM: Memoisation refuses functions with effects", "[memo]") {
+    auto bytecode = compile_source(kFib + R"(
+function shout(n: Int) returns Int {
+    println(fib(n))
+    return n
+}
+
+function main() returns Int {
+    return shout(10) + shout(10)
+}
+)");
+    VM vm;
+    vm.use_output_buffer();
+    vm.set_memoized({"fib", "shout"});
+    REQUIRE_THROWS_WITH(vm.call_function(bytecode, "main", {}), "Cannot memoize 'shout': it can call println");
+
+    vm.set_memoized({"fob"});
+    REQUIRE_THROWS_WITH(vm.call_function(bytecode, "main", {}), "Cannot memoize 'fob': no such function");
+
+    // Callers keep their effects
+    vm.set_memoized({"fib"});
+    REQUIRE(vm.call_function(bytecode, "main", {}).as_int() == 20);
+    REQUIRE(vm.get_output() == "55\n55\n");
+}
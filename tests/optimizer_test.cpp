@@ -0,0 +1,232 @@
+// Support both system Catch2 and amalgamated version
+#if __has_include(<catch2/catch_test_macros.hpp>)
+    #include <catch2/catch_test_macros.hpp>
+#else
+    #include "catch_amalgamated.hpp"
+#endif
+
+#include <lucid/backend/optimizer.hpp>
+#include <lucid/backend/compiler.hpp>
+#include <lucid/backend/vm.hpp>
+
+#include "test_support.hpp"
+
+using namespace lucid::backend;
+using namespace lucid;
+using namespace lucid::test;
+
+namespace {
+
+constexpr const char* kFibonacci = R"(
+    function fib(n: Int) returns Int {
+        return if n <= 1 { n } else { fib(n - 1) + fib(n - 2) }
+    }
+
+    function main() returns Int {
+        return fib(15)
+    }
+)";
+
+} // namespace
+
+// ===== Semantics =====
+
+TEST_CASE("Optimizer: Optimised programs compute the same results", "[optimizer]") {
+    const char* programs[] = {
+        kFibonacci,
+        R"(
+            function classify(n: Int) returns Int {
+                return if n < 0 { 0 - 1 } else { if n == 0 { 0 } else { 1 } }
+            }
+
+            function main() returns Int {
+                return classify(0 - 5) * 100 + classify(0) * 10 + classify(7)
+            }
+        )",
+        R"(
+            function main() returns Int {
+                let xs = [1, 2, 3]
+                let pair = (10, 20)
+                let s = "hello"
+                return xs.append(4).length() + pair[0] + pair[1] + s.length() + xs[2]
+            }
+        )",
+        R"(
+            function scale(x: Float, y: Float) returns Float {
+                return if x >= y { x / y } else { y * x }
+            }
+
+            function main() returns Int {
+                return scale(9.0, 2.0).floor() + scale(1.5, 4.0).round()
+            }
+        )",
+        R"(
+            function pick(flag: Bool, a: Int, b: Int) returns Int {
+                return if flag and a > b { a } else { b }
+            }
+
+            function main() returns Int {
+                return pick(true, 3, 2) * 10 + pick(false, 3, 2)
+            }
+        )",
+    };
+
+    for (const char* source : programs) {
+        auto plain = compile_source(source);
+        auto optimized = compile_source(source);
+        optimize(optimized);
+
+        REQUIRE(run_main(optimized) == run_main(plain));
+        REQUIRE(optimized.instructions.size() <= plain.instructions.size());
+    }
+}
+
+TEST_CASE("Optimizer: Optimised bytecode executes fewer instructions", "[optimizer]") {
+    auto plain = compile_source(kFibonacci);
+    auto optimized = compile_source(kFibonacci);
+    auto stats = optimize(optimized);
+
+    REQUIRE(stats.bytes_before == plain.instructions.size());
+    REQUIRE(stats.bytes_after == optimized.instructions.size());
+    REQUIRE(stats.fused > 0);
+
+    VM vm;
+    REQUIRE(vm.call_function(plain, "main", {}).as_int() == 610);
+    uint64_t plain_count = vm.instructions_executed();
+    vm.reset_instruction_count();
+    REQUIRE(vm.call_function(optimized, "main", {}).as_int() == 610);
+    REQUIRE(vm.instructions_executed() < plain_count);
+}
+
+// ===== Rewrites =====
+
+TEST_CASE("Optimizer: If-expressions become compare-and-branch", "[optimizer]") {
+    auto bc = compile_source(kFibonacci);
+    REQUIRE(count_opcode(bc, OpCode::JUMP_IF_FALSE) == 1);
+
+    optimize(bc);
+
+    REQUIRE(count_opcode(bc, OpCode::JUMP_IF_FALSE) == 0);
+    REQUIRE(count_opcode(bc, OpCode::COMPARE_JUMP_IF_FALSE) == 1);
+    REQUIRE(count_opcode(bc, OpCode::LE_INT) == 0);
+    REQUIRE(count_opcode(bc, OpCode::POP) == 0);
+    REQUIRE(count_opcode(bc, OpCode::LOAD_LOCAL_CONST) >= 1);
+    // The then-branch jumped to a RETURN; it now returns directly
+    REQUIRE(count_opcode(bc, OpCode::JUMP) == 0);
+}
+
+TEST_CASE("Optimizer: Redundant push/POP pairs are dropped", "[optimizer]") {
+    Bytecode bc;
+    uint16_t one = bc.add_constant(Value(int64_t{1}));
+    bc.add_function("main", 0, 0, 0);
+    bc.emit(OpCode::CONSTANT, one);
+    bc.emit(OpCode::DUP);
+    bc.emit(OpCode::POP);
+    bc.emit(OpCode::TRUE);
+    bc.emit(OpCode::POP);
+    bc.emit(OpCode::RETURN);
+    bc.emit(OpCode::HALT);
+
+    auto stats = optimize(bc);
+
+    REQUIRE(stats.removed == 4);
+    REQUIRE(count_opcode(bc, OpCode::DUP) == 0);
+    REQUIRE(count_opcode(bc, OpCode::POP) == 0);
+    REQUIRE(count_opcode(bc, OpCode::HALT) == 1);
+    REQUIRE(run_main(bc).as_int() == 1);
+}
+
+TEST_CASE("Optimizer: Jumps to jumps are threaded", "[optimizer]") {
+    // main: TRUE; JUMP_IF_TRUE a; ...; a: JUMP b; ...; b: RETURN
+    Bytecode bc;
+    uint16_t seven = bc.add_constant(Value(int64_t{7}));
+    bc.add_function("main", 0, 0, 0);
+    bc.emit(OpCode::TRUE);                       // 0
+    bc.emit(OpCode::JUMP_IF_TRUE, uint16_t{1});  // 1 -> 5
+    bc.emit(OpCode::HALT);                       // 4
+    bc.emit(OpCode::JUMP, uint16_t{3});          // 5 -> 11
+    bc.emit(OpCode::CONSTANT, seven);            // 8 (unreachable)
+    bc.emit(OpCode::RETURN);                     // 11
+
+    auto stats = optimize(bc);
+
+    REQUIRE(stats.jumps_threaded >= 1);
+    REQUIRE(count_opcode(bc, OpCode::JUMP) == 0);
+    REQUIRE(count_opcode(bc, OpCode::CONSTANT) == 0);
+    REQUIRE(run_main(bc).as_bool());
+}
+
+TEST_CASE("Optimizer: Nothing is fused across a jump target", "[optimizer]") {
+    // main(flag): the jump lands between the two LOAD_LOCALs
+    Bytecode bc;
+    bc.add_function("main", 0, 1, 2);
+    bc.emit(OpCode::TRUE);                         // 0
+    bc.emit(OpCode::STORE_LOCAL, uint16_t{1});     // 1
+    bc.emit(OpCode::JUMP_IF_TRUE, uint16_t{3});    // 4 -> 10
+    bc.emit(OpCode::LOAD_LOCAL, uint16_t{0});      // 7
+    bc.emit(OpCode::LOAD_LOCAL, uint16_t{1});      // 10
+    bc.emit(OpCode::RETURN);                       // 13
+
+    optimize(bc);
+
+    REQUIRE(count_opcode(bc, OpCode::LOAD_LOCAL2) == 0);
+    REQUIRE(count_opcode(bc, OpCode::LOAD_LOCAL) == 2);
+
+    VM vm;
+    REQUIRE(vm.call_function(bc, "main", {Value(int64_t{4})}).as_bool());
+}
+
+// ===== Metadata =====
+
+TEST_CASE("Optimizer: Function offsets and debug locations follow the rewrite", "[optimizer]") {
+    auto bc = compile_source(R"(
+        function helper(n: Int) returns Int {
+            return if n > 0 { n } else { 0 }
+        }
+
+        function main() returns Int {
+            return helper(3) + helper(0 - 2)
+        }
+    )");
+    REQUIRE(bc.debug_locations.size() == bc.instructions.size());
+
+    optimize(bc);
+
+    REQUIRE(bc.debug_locations.size() == bc.instructions.size());
+    for (const auto& function : bc.functions) {
+        REQUIRE(function.offset < bc.instructions.size());
+    }
+    // Each function still starts on its own source line
+    auto helper = static_cast<size_t>(bc.find_function("helper"));
+    auto main = static_cast<size_t>(bc.find_function("main"));
+    REQUIRE(bc.debug_locations[bc.functions[helper].offset].line == 3);
+    REQUIRE(bc.debug_locations[bc.functions[main].offset].line == 7);
+
+    REQUIRE(run_main(bc).as_int() == 3);
+    REQUIRE_NOTHROW(bc.disassemble());
+}
+
+// ===== Pair Profile =====
+
+TEST_CASE("Optimizer: VM counts executed opcode pairs", "[optimizer][profile]") {
+    auto bc = compile_source(kFibonacci);
+
+    VM vm;
+    vm.set_opcode_pair_profiling(true);
+    REQUIRE(vm.call_function(bc, "main", {}).as_int() == 610);
+
+    auto counts = vm.opcode_pair_counts();
+    REQUIRE(counts.size() == kOpCodeCount * kOpCodeCount);
+    auto pair = [&](OpCode first, OpCode second) {
+        return counts[static_cast<size_t>(first) * kOpCodeCount + static_cast<size_t>(second)];
+    };
+    // fib(15) makes 1973 calls, each testing `n <= 1`
+    REQUIRE(pair(OpCode::LE_INT, OpCode::JUMP_IF_FALSE) == 1973);
+    REQUIRE(pair(OpCode::JUMP_IF_FALSE, OpCode::POP) > 0);
+
+    auto report = format_opcode_pairs(counts, 5);
+    REQUIRE(report.find("LE_INT -> JUMP_IF_FALSE") != std::string::npos);
+
+    vm.set_opcode_pair_profiling(false);
+    REQUIRE(vm.opcode_pair_counts().empty());
+}
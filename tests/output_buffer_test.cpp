@@ -0,0 +1,91 @@
+// Support both system Catch2 and amalgamated version
+#if __has_include(<catch2/catch_test_macros.hpp>)
+    #include <catch2/catch_test_macros.hpp>
+#else
+    #include "catch_amalgamated.hpp"
+#endif
+
+#include <lucid/backend/compiler.hpp>
+#include <lucid/backend/output_buffer.hpp>
+#include <lucid/backend/vm.hpp>
+#include <fmt/format.h>
+#include <sstream>
+
+#include "test_support.hpp"
+
+using namespace lucid::backend;
+using namespace lucid;
+using namespace lucid::test;
+
+TEST_CASE("OutputBuffer: Holds text back until full or flushed", "[output]") {
+    std::ostringstream sink;
+    OutputBuffer out(sink.rdbuf(), 16);
+    REQUIRE_FALSE(out.line_buffered());
+
+    out.println(Value(int64_t{42}));
+    out.print(Value(std::string("abc")));
+    REQUIRE(sink.str().empty());
+
+    out.println(Value(std::string("0123456789")));  // 17 bytes buffered
+    REQUIRE(sink.str() == "42\nabc0123456789\n");
+
+    out.print(Value(true));
+    out.flush();
+    REQUIRE(sink.str() == "42\nabc0123456789\ntrue");
+}
+
+TEST_CASE("OutputBuffer: Formats like to_string", "[output]") {
+    std::ostringstream sink;
+    {
+        OutputBuffer out(sink.rdbuf());
+        const Value values[] = {
+            Value(int64_t{-7}), Value(2.5), Value(0.1 + 0.2), Value(1e300), Value(false),
+            Value(std::vector<Value>{Value(int64_t{1}), Value(std::string("x"))}, false),
+        };
+        for (const auto& value : values) {
+            out.println(value);
+        }
+    }  // Flushed on destruction
+    REQUIRE(sink.str() == fmt::format("-7\n2.5\n{}\n{}\nfalse\n[1, \"x\"]\n",
+                                      Value(0.1 + 0.2).to_string(), Value(1e300).to_string()));
+}
+
+TEST_CASE("OutputBuffer: Line buffering and unbuffered output", "[output]") {
+    std::ostringstream sink;
+    OutputBuffer out(sink.rdbuf());
+    out.set_line_buffered(true);
+    out.print(Value(std::string("partial")));
+    REQUIRE(sink.str().empty());
+    out.println(Value(std::string(" line")));
+    REQUIRE(sink.str() == "partial line\n");
+
+    out.set_line_buffered(false);
+    out.set_capacity(0);
+    out.print(Value(int64_t{1}));
+    REQUIRE(sink.str() == "partial line\n1");
+}
+
+TEST_CASE("VM: Output is written when the call returns or fails", "[output][vm]") {
+    auto bytecode = compile_source(R"(
+        function main() returns Int {
+            println("before")
+            print(1)
+            return 1 / 0
+        }
+    )");
+
+    std::ostringstream sink;
+    VM vm;
+    vm.set_output_stream(sink);
+    REQUIRE_THROWS_WITH(vm.call_function(bytecode, "main", {}), "Division by zero");
+    REQUIRE(sink.str() == "before\n1");
+
+    auto fine = compile_source(R"(
+        function main() returns Int {
+            println(2.5)
+            return 0
+        }
+    )");
+    vm.call_function(fine, "main", {});
+    REQUIRE(sink.str() == "before\n12.5\n");
+}
@@ -0,0 +1,178 @@
+// Support both system Catch2 and amalgamated version
+#if __has_include(<catch2/catch_test_macros.hpp>)
+    #include <catch2/catch_test_macros.hpp>
+#else
+    #include "catch_amalgamated.hpp"
+#endif
+
+#include <lucid/backend/parallel_compiler.hpp>
+#include <lucid/backend/compiler.hpp>
+#include <lucid/backend/constant_folder.hpp>
+#include <lucid/backend/thread_pool.hpp>
+#include <lucid/backend/vm.hpp>
+#include <lucid/semantic/type_checker.hpp>
+#include <atomic>
+#include <stdexcept>
+#include <string>
+
+#include "test_support.hpp"
+
+using namespace lucid::backend;
+using namespace lucid;
+using namespace lucid::test;
+
+namespace {
+
+const std::string kProgram = R"(
+function square(x: Int) returns Int {
+    return x * x
+}
+
+function describe(n: Int) returns Int {
+    let labels = ["value", "units"]
+    let unit = "units"
+    return labels.length() + to_string(n).length() + unit.length()
+}
+
+function sum_to(n: Int, acc: Int) returns Int {
+    return if n == 0 { acc } else { sum_to(n - 1, acc + n) }
+}
+
+function shifted(values: List[Int], k: Int) returns Int {
+    return values.map(lambda v: v + k).filter(lambda v: v > 2).sum()
+}
+
+function scaled(values: List[Float]) returns Float {
+    return values.head() * 2.5 + (1.0 + 2.0)
+}
+
+function main() returns Int {
+    let total = sum_to(100, 0) + describe(square(4)) + shifted([1, 2], 1) - [1, 2].fold(0, lambda a, x: a + x)
+    return if scaled([1.0, 2.0]) > 5.0 { total } else { 0 }
+}
+)";
+
+// Many small functions calling their neighbours, so tasks get stolen
+auto generated_program(int count) -> std::string {
+    std::string source;
+    for (int i = 0; i < count; ++i) {
+        source += "function f" + std::to_string(i) + "(x: Int) returns Int {\n";
+        if (i == 0) {
+            source += "    return x + 1\n}\n";
+        } else {
+            source += "    let label = \"step " + std::to_string(i % 7) + "\"\n";
+            source += "    return f" + std::to_string(i - 1) + "(x) + label.length()\n}\n";
+        }
+    }
+    source += "function main() returns Int {\n    return f" + std::to_string(count - 1) + "(0)\n}\n";
+    return source;
+}
+
+} // namespace
+
+// ===== ThreadPool =====
+
+TEST_CASE("ThreadPool: Runs every index exactly once", "[parallel]") {
+    for (size_t threads : {size_t{1}, size_t{2}, size_t{4}}) {
+        ThreadPool pool(threads);
+        REQUIRE(pool.size() == threads);
+
+        std::vector<std::atomic<int>> runs(1000);
+        pool.parallel_for(runs.size(), [&](size_t i) { runs[i]++; });
+        for (const auto& count : runs) {
+            REQUIRE(count.load() == 1);
+        }
+
+        // The pool is reusable
+        std::atomic<size_t> total{0};
+        pool.parallel_for(10, [&](size_t i) { total += i; });
+        REQUIRE(total.load() == 45);
+    }
+}
+
+TEST_CASE("ThreadPool: Rethrows a task's exception after the rest ran", "[parallel]") {
+    ThreadPool pool(4);
+    std::atomic<int> ran{0};
+    REQUIRE_THROWS_AS(pool.parallel_for(100, [&](size_t i) {
+        ran++;
+        if (i == 17) {
+            throw std::runtime_error("task failed");
+        }
+    }), std::runtime_error);
+    REQUIRE(ran.load() == 100);
+}
+
+// ===== compile_parallel =====
+
+TEST_CASE("Parallel compile: Same bytecode as the sequential pipeline", "[parallel]") {
+    for (const auto& source : {kProgram, generated_program(300)}) {
+        auto expected = compile_source(source, true);
+
+        auto program = parse_program(source);
+        ThreadPool pool(4);
+        auto result = compile_parallel(*program, pool);
+        REQUIRE(result.errors.empty());
+        REQUIRE(result.bytecode.has_value());
+        auto& bytecode = *result.bytecode;
+
+        REQUIRE(bytecode.instructions == expected.instructions);
+        REQUIRE(bytecode.constants.size() == expected.constants.size());
+        for (size_t i = 0; i < expected.constants.size(); ++i) {
+            REQUIRE(bytecode.constants[i] == expected.constants[i]);
+        }
+        REQUIRE(bytecode.functions.size() == expected.functions.size());
+        for (size_t i = 0; i < expected.functions.size(); ++i) {
+            REQUIRE(bytecode.functions[i].name == expected.functions[i].name);
+            REQUIRE(bytecode.functions[i].offset == expected.functions[i].offset);
+            REQUIRE(bytecode.functions[i].local_count == expected.functions[i].local_count);
+        }
+        REQUIRE(bytecode.debug_locations.size() == expected.debug_locations.size());
+        for (size_t i = 0; i < expected.debug_locations.size(); ++i) {
+            REQUIRE(bytecode.debug_locations[i].line == expected.debug_locations[i].line);
+            REQUIRE(bytecode.debug_locations[i].column == expected.debug_locations[i].column);
+        }
+    }
+}
+
+TEST_CASE("Parallel compile: Linked program runs", "[parallel]") {
+    auto program = parse_program(kProgram);
+    ThreadPool pool(3);
+    auto result = compile_parallel(*program, pool);
+    REQUIRE(result.bytecode.has_value());
+    REQUIRE(result.fold_stats.folded == 1);
+
+    VM vm;
+    auto value = vm.call_function(*result.bytecode, "main", {});
+    REQUIRE(value.is_int());
+    REQUIRE(value.as_int() == 5050 + 9);
+}
+
+TEST_CASE("Parallel compile: Type errors as check_program reports them", "[parallel]") {
+    const std::string source = R"(
+function first() returns Int {
+    return "not an int"
+}
+
+function first() returns Int {
+    return 1
+}
+
+function second() returns Int {
+    return missing
+}
+)";
+    auto sequential = parse_program(source);
+    semantic::TypeChecker checker;
+    auto expected = checker.check_program(*sequential).errors;
+    REQUIRE(expected.size() > 2);
+
+    auto program = parse_program(source);
+    ThreadPool pool(4);
+    auto result = compile_parallel(*program, pool);
+    REQUIRE(!result.bytecode.has_value());
+    REQUIRE(result.errors.size() == expected.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        REQUIRE(result.errors[i].message == expected[i].message);
+        REQUIRE(result.errors[i].location.line == expected[i].location.line);
+    }
+}
@@ -38,8 +38,7 @@ auto parse_error(std::string_view source) -> std::vector<ParseError> {
 // Helper to parse just an expression (for testing)
 auto parse_expr(std::string_view source) -> std::unique_ptr<Expr> {
     Lexer lexer(source);
-    auto tokens = lexer.tokenize();
-    Parser parser(std::move(tokens));
+    Parser parser(lexer);
 
     // Manually call parse_expression
     auto expr = parser.parse_expression();
@@ -627,6 +626,26 @@ TEST_CASE("Parser: Error on unexpected token", "[parser]") {
     REQUIRE(!errors.empty());
 }
 
+TEST_CASE("Parser: Lexer errors are reported as parse errors", "[parser]") {
+    auto errors = parse_error(R"(
+function main() returns String {
+    return "unterminated
+})");
+    REQUIRE(errors.size() == 1);
+    REQUIRE(errors[0].message == "Unterminated string literal");
+}
+
+TEST_CASE("Parser: Streams programs longer than its lookahead", "[parser]") {
+    std::string source;
+    for (int i = 0; i < 200; ++i) {
+        source += "function f" + std::to_string(i) + "(x: Int) returns Int { return x + " +
+                  std::to_string(i) + " }\n";
+    }
+    auto program = parse_ok(source);
+    REQUIRE(program->functions.size() == 200);
+    REQUIRE(program->functions[199]->name == "f199");
+}
+
 // ===== AST Printer Tests (Day 6) =====
 
 TEST_CASE("AST Printer: Simple expression", "[parser][printer]") {
@@ -0,0 +1,154 @@
+// Support both system Catch2 and amalgamated version
+#if __has_include(<catch2/catch_test_macros.hpp>)
+    #include <catch2/catch_test_macros.hpp>
+#else
+    #include "catch_amalgamated.hpp"
+#endif
+
+#include <lucid/backend/persistent_vector.hpp>
+#include <lucid/backend/value.hpp>
+
+using namespace lucid::backend;
+
+namespace {
+
+auto make_range(size_t n) -> PersistentVector {
+    PersistentVector vec;
+    for (size_t i = 0; i < n; ++i) {
+        vec.push_back(Value(static_cast<int64_t>(i)));
+    }
+    return vec;
+}
+
+} // namespace
+
+TEST_CASE("PersistentVector: Empty vector", "[persistent_vector]") {
+    PersistentVector vec;
+    REQUIRE(vec.empty());
+    REQUIRE(vec.size() == 0);
+    REQUIRE(vec.begin() == vec.end());
+}
+
+TEST_CASE("PersistentVector: Push and index across trie levels", "[persistent_vector]") {
+    // 40000 elements needs a three-level trie (32 * 32 * 32 = 32768)
+    const size_t n = 40000;
+    auto vec = make_range(n);
+
+    REQUIRE(vec.size() == n);
+    for (size_t i = 0; i < n; ++i) {
+        REQUIRE(vec[i].as_int() == static_cast<int64_t>(i));
+    }
+    REQUIRE(vec.front().as_int() == 0);
+    REQUIRE(vec.back().as_int() == static_cast<int64_t>(n - 1));
+}
+
+TEST_CASE("PersistentVector: Iteration", "[persistent_vector]") {
+    auto vec = make_range(1000);
+
+    int64_t expected = 0;
+    for (const auto& value : vec) {
+        REQUIRE(value.as_int() == expected);
+        ++expected;
+    }
+    REQUIRE(expected == 1000);
+    REQUIRE(vec.to_vector().size() == 1000);
+}
+
+TEST_CASE("PersistentVector: Copies are independent", "[persistent_vector]") {
+    auto original = make_range(100);
+    auto copy = original;
+
+    copy.push_back(Value(int64_t{100}));
+    original.push_back(Value(int64_t{-1}));
+
+    REQUIRE(copy.size() == 101);
+    REQUIRE(original.size() == 101);
+    REQUIRE(copy[100].as_int() == 100);
+    REQUIRE(original[100].as_int() == -1);
+    for (size_t i = 0; i < 100; ++i) {
+        REQUIRE(copy[i] == original[i]);
+    }
+}
+
+TEST_CASE("PersistentVector: Shared trie survives divergent pushes", "[persistent_vector]") {
+    auto base = make_range(2000);
+    auto a = base;
+    auto b = base;
+    for (int64_t i = 0; i < 2000; ++i) {
+        a.push_back(Value(i));
+        b.push_back(Value(-i));
+    }
+
+    REQUIRE(base.size() == 2000);
+    REQUIRE(a[3999].as_int() == 1999);
+    REQUIRE(b[3999].as_int() == -1999);
+    REQUIRE(base[1999].as_int() == 1999);
+}
+
+TEST_CASE("PersistentVector: pop_front is an offset view", "[persistent_vector]") {
+    auto vec = make_range(100);
+    auto rest = vec;
+    rest.pop_front();
+    rest.pop_front();
+
+    REQUIRE(vec.size() == 100);
+    REQUIRE(rest.size() == 98);
+    REQUIRE(rest.front().as_int() == 2);
+    REQUIRE(rest[97].as_int() == 99);
+
+    int64_t expected = 2;
+    for (const auto& value : rest) {
+        REQUIRE(value.as_int() == expected++);
+    }
+
+    rest.push_back(Value(int64_t{100}));
+    REQUIRE(rest.size() == 99);
+    REQUIRE(rest.back().as_int() == 100);
+    REQUIRE(vec.size() == 100);
+
+    while (!rest.empty()) {
+        rest.pop_front();
+    }
+    REQUIRE(rest.begin() == rest.end());
+}
+
+TEST_CASE("PersistentVector: append and reverse", "[persistent_vector]") {
+    auto a = make_range(50);
+    auto b = make_range(70);
+    a.append(b);
+
+    REQUIRE(a.size() == 120);
+    REQUIRE(a[49].as_int() == 49);
+    REQUIRE(a[50].as_int() == 0);
+    REQUIRE(a[119].as_int() == 69);
+
+    auto reversed = make_range(40);
+    reversed.reverse();
+    REQUIRE(reversed.front().as_int() == 39);
+    REQUIRE(reversed.back().as_int() == 0);
+}
+
+TEST_CASE("PersistentVector: Equality", "[persistent_vector]") {
+    auto a = make_range(300);
+    auto b = make_range(300);
+    REQUIRE(a == b);
+
+    b.push_back(Value(int64_t{0}));
+    REQUIRE(a != b);
+
+    auto c = make_range(301);
+    c.pop_front();
+    REQUIRE(c != a);
+}
+
+TEST_CASE("PersistentVector: Holds heap values", "[persistent_vector]") {
+    PersistentVector vec;
+    for (int i = 0; i < 100; ++i) {
+        vec.push_back(Value(std::string("element number ") + std::to_string(i)));
+    }
+    auto copy = vec;
+    copy.reverse();
+
+    REQUIRE(vec[0].as_string() == "element number 0");
+    REQUIRE(copy[0].as_string() == "element number 99");
+}
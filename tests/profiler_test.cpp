@@ -0,0 +1,135 @@
+// Support both system Catch2 and amalgamated version
+#if __has_include(<catch2/catch_test_macros.hpp>)
+    #include <catch2/catch_test_macros.hpp>
+#else
+    #include "catch_amalgamated.hpp"
+#endif
+
+#include <lucid/backend/compiler.hpp>
+#include <lucid/backend/profiler.hpp>
+#include <lucid/backend/vm.hpp>
+#include <numeric>
+#include <sstream>
+
+#include "test_support.hpp"
+
+using namespace lucid::backend;
+using namespace lucid;
+using namespace lucid::test;
+
+namespace {
+
+auto function_profile(const Profiler& profiler, const Bytecode& bytecode, const std::string& name)
+    -> FunctionProfile {
+    const auto index = static_cast<size_t>(bytecode.find_function(name));
+    return index < profiler.functions().size() ? profiler.functions()[index] : FunctionProfile{};
+}
+
+constexpr const char* kProgram = R"(
+function fib(n: Int) returns Int {
+    return if n < 2 { n } else { fib(n - 1) + fib(n - 2) }
+}
+
+function countdown(n: Int) returns Int {
+    return if n == 0 { 0 } else { countdown(n - 1) }
+}
+
+function main() returns Int {
+    let scaled = [1, 2, 3].map(lambda x: fib(x + 5))
+    return fib(15) + countdown(100) + scaled.length()
+}
+)";
+
+} // namespace
+
+TEST_CASE("Profiler: Function calls, times and opcode counts", "[profiler]") {
+    if (!VM::profiling_available()) {
+        SKIP("Profiler not built");
+    }
+    auto bytecode = compile_source(kProgram);
+
+    VM plain;
+    const int64_t expected = plain.call_function(bytecode, "main", {}).as_int();
+
+    VM vm;
+    vm.enable_profiling();
+    REQUIRE(vm.call_function(bytecode, "main", {}).as_int() == expected);
+
+    const Profiler& profiler = *vm.profiler();
+    // fib(15) makes 1973 calls; the lambda tail-calls fib(6), fib(7), fib(8)
+    // for another 25 + 41 + 67
+    const auto fib = function_profile(profiler, bytecode, "fib");
+    REQUIRE(fib.calls == 1973 + 25 + 41 + 67);
+    REQUIRE(fib.exclusive.count() > 0);
+    REQUIRE(fib.exclusive <= fib.inclusive);
+
+    // Tail calls replace the frame but still count as calls
+    REQUIRE(function_profile(profiler, bytecode, "countdown").calls == 101);
+
+    const auto main = function_profile(profiler, bytecode, "main");
+    REQUIRE(main.calls == 1);
+    REQUIRE(main.inclusive >= fib.inclusive);
+
+    // Every executed instruction was counted once
+    const auto& opcodes = profiler.opcode_counts();
+    REQUIRE(std::accumulate(opcodes.begin(), opcodes.end(), uint64_t{0}) == vm.instructions_executed());
+    REQUIRE(opcodes[static_cast<size_t>(OpCode::TAIL_CALL)] >= 100);
+
+    const std::string report = profiler.report(bytecode);
+    REQUIRE(report.find("fib") != std::string::npos);
+    REQUIRE(report.find("LOAD_LOCAL") != std::string::npos);
+    REQUIRE(profiler.sample_count() == 0);
+}
+
+TEST_CASE("Profiler: Sampled stacks map to source lines", "[profiler]") {
+    if (!VM::profiling_available()) {
+        SKIP("Profiler not built");
+    }
+    auto bytecode = compile_source(kProgram);
+
+    VM vm;
+    vm.enable_profiling({.timing = false, .sample_interval = 7});
+    vm.call_function(bytecode, "main", {});
+
+    const Profiler& profiler = *vm.profiler();
+    REQUIRE(profiler.sample_count() == vm.instructions_executed() / 7);
+    REQUIRE(profiler.functions()[static_cast<size_t>(bytecode.find_function("fib"))].inclusive.count() == 0);
+
+    // "frame;frame count" lines whose counts add up to the samples taken
+    std::istringstream folded(profiler.folded_stacks());
+    std::string line;
+    uint64_t total = 0;
+    bool saw_recursion = false;
+    while (std::getline(folded, line)) {
+        const auto space = line.rfind(' ');
+        REQUIRE(space != std::string::npos);
+        REQUIRE(line.starts_with("main:"));
+        total += std::stoull(line.substr(space + 1));
+        saw_recursion = saw_recursion || line.find("main:12;fib:3;fib:3") == 0;
+    }
+    REQUIRE(total == profiler.sample_count());
+    REQUIRE(saw_recursion);
+}
+
+TEST_CASE("Profiler: Errors close the open frames", "[profiler]") {
+    if (!VM::profiling_available()) {
+        SKIP("Profiler not built");
+    }
+    auto bytecode = compile_source(R"(
+        function divide(d: Int) returns List[Int] {
+            return [1, 2].map(lambda x: x / d)
+        }
+    )");
+
+    VM vm;
+    vm.enable_profiling();
+    REQUIRE_THROWS_WITH(vm.call_function(bytecode, "divide", {Value(int64_t{0})}), "Division by zero");
+    REQUIRE(vm.profiler()->depth() == 0);
+
+    REQUIRE(vm.call_function(bytecode, "divide", {Value(int64_t{1})}).as_list().size() == 2);
+    REQUIRE(vm.profiler()->depth() == 0);
+    REQUIRE(function_profile(*vm.profiler(), bytecode, "divide").calls == 2);
+
+    vm.disable_profiling();
+    REQUIRE(vm.profiler() == nullptr);
+}
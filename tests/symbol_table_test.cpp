@@ -82,7 +82,7 @@ TEST_CASE("Symbol Table: Global scope", "[symbol_table]") {
 
     SECTION("starts with global scope") {
         REQUIRE(table.scope_depth() == 0);
-        REQUIRE(table.current_scope()->kind == Scope::ScopeKind::Global);
+        REQUIRE(table.current_kind() == Scope::ScopeKind::Global);
     }
 
     SECTION("declare in global scope") {
@@ -118,11 +118,11 @@ TEST_CASE("Symbol Table: Nested scopes", "[symbol_table]") {
 
         table.enter_scope(Scope::ScopeKind::Function);
         REQUIRE(table.scope_depth() == 1);
-        REQUIRE(table.current_scope()->kind == Scope::ScopeKind::Function);
+        REQUIRE(table.current_kind() == Scope::ScopeKind::Function);
 
         table.enter_scope(Scope::ScopeKind::Block);
         REQUIRE(table.scope_depth() == 2);
-        REQUIRE(table.current_scope()->kind == Scope::ScopeKind::Block);
+        REQUIRE(table.current_kind() == Scope::ScopeKind::Block);
 
         table.exit_scope();
         REQUIRE(table.scope_depth() == 1);
@@ -330,3 +330,32 @@ TEST_CASE("Symbol Table: Multiple scope kinds", "[symbol_table]") {
     REQUIRE(!table.exists("func_y"));
     REQUIRE(table.exists("global_x"));
 }
+
+TEST_CASE("Symbol Table: Locals take slots in their frame", "[symbol_table]") {
+    SymbolTable table;
+    const PrimitiveType int_type(PrimitiveKind::Int);
+
+    table.enter_scope(Scope::ScopeKind::Function);
+    REQUIRE(table.declare_local("a", 0, SymbolKind::Parameter, &int_type, make_location())->slot == 0);
+
+    // Blocks share the frame and do not give slots back
+    table.enter_scope(Scope::ScopeKind::Block);
+    REQUIRE(table.declare_local("b", 1, SymbolKind::Variable, &int_type, make_location())->slot == 1);
+    REQUIRE(table.declare_local("b", 1, SymbolKind::Variable, &int_type, make_location()) == nullptr);
+    table.exit_scope();
+    REQUIRE(table.lookup(1, "b") == nullptr);
+
+    // A lambda starts a frame of its own, and the enclosing one resumes after
+    table.enter_scope(Scope::ScopeKind::Lambda);
+    REQUIRE(table.declare_local("a", 0, SymbolKind::Parameter, &int_type, make_location())->slot == 0);
+    REQUIRE(table.frame_size() == 1);
+    table.exit_scope();
+    REQUIRE(table.frame_size() == 2);
+
+    // Ids are compared when both sides have one, names otherwise
+    REQUIRE(table.lookup(0, "a")->slot == 0);
+    REQUIRE(table.lookup(kNoName, "a")->slot == 0);
+    REQUIRE(table.lookup(7, "a") == nullptr);
+    REQUIRE(table.declare_local("c", kNoName, SymbolKind::Variable, &int_type, make_location())->slot == 2);
+    REQUIRE(table.lookup(9, "c")->slot == 2);
+}
@@ -0,0 +1,150 @@
+#pragma once
+
+// Helpers shared by the test files: the front end run on a source string,
+// throwing on the first error, as lucidc runs it without -O, looks at the
+// bytecode it makes, and scratch files
+
+#include <lucid/backend/bytecode.hpp>
+#include <lucid/backend/compiler.hpp>
+#include <lucid/backend/constant_folder.hpp>
+#include <lucid/backend/vm.hpp>
+#include <lucid/frontend/lexer.hpp>
+#include <lucid/frontend/parser.hpp>
+#include <lucid/semantic/type_checker.hpp>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace lucid::test {
+
+inline auto parse_program(const std::string& source) -> std::unique_ptr<ast::Program> {
+    Lexer lexer(source, "program.lucid");
+    Parser parser(lexer);
+    auto parse_result = parser.parse();
+    if (!parse_result.is_ok()) {
+        throw std::runtime_error("Parse error");
+    }
+    return std::move(*parse_result.program);
+}
+
+// Type checked, and with constants folded when `fold` is set
+inline auto parse_checked(const std::string& source, bool fold = false) -> std::unique_ptr<ast::Program> {
+    auto program = parse_program(source);
+    semantic::TypeChecker checker;
+    auto type_result = checker.check_program(*program);
+    if (!type_result.errors.empty()) {
+        throw std::runtime_error("Type check error: " + type_result.errors.front().message);
+    }
+    if (fold) {
+        backend::fold_constants(*program);
+    }
+    return program;
+}
+
+inline auto compile_source(const std::string& source, bool fold = false) -> backend::Bytecode {
+    auto program = parse_checked(source, fold);
+    backend::Compiler compiler;
+    return compiler.compile(program.get());
+}
+
+// The opcodes of `name`'s code, which runs up to the next function's, or of
+// the whole program when `name` is empty
+inline auto function_opcodes(const backend::Bytecode& bc, const std::string& name = "")
+    -> std::vector<backend::OpCode> {
+    size_t start = 0;
+    size_t end = bc.instructions.size();
+    if (!name.empty()) {
+        for (const auto& function : bc.functions) {
+            if (function.name == name) {
+                start = function.offset;
+            }
+        }
+        for (const auto& function : bc.functions) {
+            if (function.offset > start && function.offset < end) {
+                end = function.offset;
+            }
+        }
+    }
+    std::vector<backend::OpCode> opcodes;
+    for (size_t offset = start; offset < end;) {
+        auto current = static_cast<backend::OpCode>(bc.instructions[offset]);
+        opcodes.push_back(current);
+        offset += 1 + backend::opcode_operand_size(current);
+    }
+    return opcodes;
+}
+
+inline auto count_opcode(const backend::Bytecode& bc, const std::string& function, backend::OpCode op) -> size_t {
+    auto opcodes = function_opcodes(bc, function);
+    return static_cast<size_t>(std::count(opcodes.begin(), opcodes.end(), op));
+}
+
+inline auto count_opcode(const backend::Bytecode& bc, backend::OpCode op) -> size_t {
+    return count_opcode(bc, "", op);
+}
+
+// Int edge cases every backend must agree on: arithmetic wraps, and
+// INT64_MIN / -1 is INT64_MIN. Prints kIntEdgeOutput and returns -7.
+constexpr const char* kIntEdgeCases = R"(
+    function add(a: Int, b: Int) returns Int { return a + b }
+    function sub(a: Int, b: Int) returns Int { return a - b }
+    function mul(a: Int, b: Int) returns Int { return a * b }
+    function div(a: Int, b: Int) returns Int { return a / b }
+    function mod(a: Int, b: Int) returns Int { return a % b }
+    function neg(a: Int) returns Int { return -a }
+
+    function main() returns Int {
+        let max = 9223372036854775807
+        let min = 0 - max - 1
+        println(add(max, 1))
+        println(sub(min, 1))
+        println(mul(max, 2))
+        println(mul(min, -1))
+        println(div(min, -1))
+        println(mod(min, -1))
+        println(neg(min))
+        return div(7, -1) + mod(7, -1)
+    }
+)";
+
+constexpr const char* kIntEdgeOutput =
+    "-9223372036854775808\n9223372036854775807\n-2\n-9223372036854775808\n"
+    "-9223372036854775808\n0\n-9223372036854775808\n";
+
+inline auto run_main(const backend::Bytecode& bc) -> backend::Value {
+    backend::VM vm;
+    return vm.call_function(bc, "main", {});
+}
+
+// A file in the temp directory, removed when the test ends
+class TempFile {
+public:
+    explicit TempFile(const std::string& name)
+        : path_((std::filesystem::temp_directory_path() / ("lucid_test_" + name)).string()) {}
+    ~TempFile() { std::filesystem::remove(path_); }
+
+    TempFile(const TempFile&) = delete;
+    auto operator=(const TempFile&) -> TempFile& = delete;
+
+    auto path() const -> const std::string& { return path_; }
+
+    auto read() const -> std::string {
+        std::ifstream file(path_, std::ios::binary);
+        return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+    }
+
+    auto write(const std::string& bytes) const -> void {
+        std::ofstream file(path_, std::ios::binary | std::ios::trunc);
+        file << bytes;
+    }
+
+private:
+    std::string path_;
+};
+
+} // namespace lucid::test
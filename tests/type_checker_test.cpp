@@ -23,9 +23,7 @@ auto type_check_expr(const std::string& expr_str) -> std::pair<std::unique_ptr<S
     )", expr_str);
 
     Lexer lexer(program);
-    auto tokens = lexer.tokenize();
-
-    Parser parser(tokens);
+    Parser parser(lexer);
     auto parse_result = parser.parse();
 
     if (!parse_result.is_ok() || !parse_result.program.has_value()) {
@@ -58,9 +56,10 @@ auto type_check_expr(const std::string& expr_str) -> std::pair<std::unique_ptr<S
     }
 
     // Type check the return expression
-    auto expr_type = checker.check_expression(*return_stmt.value);
+    // The checker owns the types it returns, so hand back a copy
+    auto* expr_type = checker.check_expression(*return_stmt.value);
 
-    return {std::move(expr_type), std::move(result)};
+    return {expr_type->clone(), std::move(result)};
 }
 
 // ===== Literal Type Inference Tests =====
@@ -358,6 +357,14 @@ TEST_CASE("Type checking: String + Int error", "[type_checker][errors]") {
     REQUIRE(result.errors.size() >= 1);
 }
 
+TEST_CASE("Type checking: String + String = String", "[type_checker][binary][arithmetic]") {
+    auto [type, result] = type_check_expr(R"(("a" + "b").length())");
+    REQUIRE_FALSE(result.has_errors());
+
+    auto [sub_type, sub] = type_check_expr(R"(("a" - "b").length())");
+    REQUIRE(sub.has_errors());
+}
+
 TEST_CASE("Type checking: not Int error", "[type_checker][errors]") {
     auto [type, result] = type_check_expr("not 42");
 
@@ -442,3 +449,96 @@ TEST_CASE("Type checking: List of tuples [(1, 2), (3, 4)]", "[type_checker][comp
     auto* tuple = static_cast<TupleType*>(list->element_type.get());
     REQUIRE(tuple->element_types.size() == 2);
 }
+
+// ===== Lambda Tests =====
+
+TEST_CASE("Type checking: Lambda parameters typed from map and sum", "[type_checker][lambda]") {
+    auto [type, result] = type_check_expr("[1, 2].map(lambda x: x * 3).sum()");
+
+    REQUIRE_FALSE(result.has_errors());
+    REQUIRE(type->kind == TypeKind::Primitive);
+    REQUIRE(static_cast<PrimitiveType*>(type.get())->primitive_kind == PrimitiveKind::Int);
+}
+
+TEST_CASE("Type checking: fold returns the accumulator type", "[type_checker][lambda]") {
+    auto [type, result] = type_check_expr("[1, 2].filter(lambda x: x > 1).fold(0, lambda acc, x: acc + x)");
+
+    REQUIRE_FALSE(result.has_errors());
+    REQUIRE(type->kind == TypeKind::Primitive);
+    REQUIRE(static_cast<PrimitiveType*>(type.get())->primitive_kind == PrimitiveKind::Int);
+}
+
+TEST_CASE("Type checking: sum of non-numeric list error", "[type_checker][lambda][errors]") {
+    auto [type, result] = type_check_expr("[\"a\"].sum().length()");
+
+    REQUIRE(result.has_errors());
+    REQUIRE(result.errors[0].message == "Method 'sum' requires List[Int] or List[Float], got List[String]");
+}
+
+TEST_CASE("Type checking: join needs List[String] and a String separator", "[type_checker][errors]") {
+    auto [type, result] = type_check_expr(R"(["a", "b"].join(", ").length())");
+    REQUIRE_FALSE(result.has_errors());
+
+    auto [ints_type, ints] = type_check_expr(R"([1, 2].join(", ").length())");
+    REQUIRE(ints.has_errors());
+    REQUIRE(ints.errors[0].message == "Method 'join' requires List[String], got List[Int]");
+
+    auto [sep_type, sep] = type_check_expr(R"(["a"].join(1).length())");
+    REQUIRE(sep.has_errors());
+}
+
+TEST_CASE("Type checking: filter predicate must return Bool", "[type_checker][lambda][errors]") {
+    auto [type, result] = type_check_expr("[1].filter(lambda x: x + 1).length()");
+
+    REQUIRE(result.has_errors());
+}
+
+TEST_CASE("Type checking: Callback arity error", "[type_checker][lambda][errors]") {
+    auto [type, result] = type_check_expr("[1].map(lambda x, y: x).length()");
+
+    REQUIRE(result.has_errors());
+    REQUIRE(result.errors[0].message == "Method 'map' expects a function of 1 parameters, got 2");
+}
+
+TEST_CASE("Type checking: par_reduce combines two elements", "[type_checker][lambda]") {
+    auto [type, result] = type_check_expr("[1, 2].par_map(lambda x: x * 2).par_reduce(lambda a, b: a + b)");
+
+    REQUIRE_FALSE(result.has_errors());
+    REQUIRE(type->kind == TypeKind::Primitive);
+    REQUIRE(static_cast<PrimitiveType*>(type.get())->primitive_kind == PrimitiveKind::Int);
+
+    auto [bad_type, bad] = type_check_expr("[1].par_reduce(lambda a: a).length()");
+    REQUIRE(bad.has_errors());
+    REQUIRE(bad.errors[0].message == "Method 'par_reduce' expects a function of 2 parameters, got 1");
+}
+
+TEST_CASE("Type checking: Names resolve to frame slots", "[type_checker][lambda]") {
+    Lexer lexer(R"(
+        function f(a: Int) returns Int {
+            let b = a + 1
+            let g = [b].map(lambda x: x + a + b)
+            return g[0] + b + f(1)
+        }
+    )");
+    Parser parser(lexer);
+    auto parse_result = parser.parse();
+    REQUIRE(parse_result.is_ok());
+    auto& function = *parse_result.program.value()->functions[0];
+
+    TypeChecker checker;
+    REQUIRE(checker.check_program(*parse_result.program.value()).errors.empty());
+    REQUIRE(function.local_count == 3);  // a, b, g
+
+    // The lambda copies a and b in after its parameter
+    auto& statements = function.body->statements;
+    auto& map = static_cast<ast::MethodCallExpr&>(*static_cast<ast::LetStmt&>(*statements[1]).initializer);
+    auto& lambda = static_cast<ast::LambdaExpr&>(*map.arguments[0]);
+    REQUIRE(lambda.captures == std::vector<uint32_t>{0, 1});
+    REQUIRE(lambda.local_count == 3);
+
+    auto& sum = static_cast<ast::BinaryExpr&>(*static_cast<ast::ReturnStmt&>(*statements[2]).value);
+    auto& call = static_cast<ast::CallExpr&>(*sum.right);
+    auto& b = static_cast<ast::IdentifierExpr&>(*static_cast<ast::BinaryExpr&>(*sum.left).right);
+    REQUIRE(b.slot == 1);
+    REQUIRE(static_cast<ast::IdentifierExpr&>(*call.callee).slot == ast::kNoSlot);
+}
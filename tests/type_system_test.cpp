@@ -228,6 +228,82 @@ TEST_CASE("Type System: Type unification", "[type_system]") {
     }
 }
 
+// ===== Type Context Tests =====
+
+TEST_CASE("Type System: Interned types", "[type_system][type_context]") {
+    TypeContext types;
+    auto* int_type = types.primitive(PrimitiveKind::Int);
+    auto* string_type = types.primitive(PrimitiveKind::String);
+
+    SECTION("structurally equal types are the same object") {
+        REQUIRE(types.list(int_type) == types.list(int_type));
+        REQUIRE(types.list(int_type) != types.list(string_type));
+
+        std::vector<const SemanticType*> pair = {int_type, types.list(string_type)};
+        auto* tuple = types.tuple(pair);
+        REQUIRE(types.tuple(pair) == tuple);
+        REQUIRE(tuple->to_string() == "(Int, List[String])");
+
+        auto* function = types.function(pair, int_type);
+        REQUIRE(function != tuple);
+        REQUIRE(function->to_string() == "(Int, List[String]) -> Int");
+    }
+
+    SECTION("intern maps ordinary types onto their interned form") {
+        std::vector<std::unique_ptr<SemanticType>> elements;
+        elements.push_back(std::make_unique<PrimitiveType>(PrimitiveKind::Int));
+        elements.push_back(std::make_unique<ListType>(std::make_unique<PrimitiveType>(PrimitiveKind::String)));
+        TupleType tuple(std::move(elements));
+
+        std::vector<const SemanticType*> pair = {int_type, types.list(string_type)};
+        REQUIRE(types.intern(tuple) == types.tuple(pair));
+        REQUIRE(types.intern(PrimitiveType(PrimitiveKind::Int)) == int_type);
+        REQUIRE(types.intern(TypeVariable("'a")) == types.type_variable("'a"));
+    }
+
+    SECTION("components are interned") {
+        auto* list = types.list(types.list(int_type));
+        REQUIRE(TypeContext::element_type(list) == types.list(int_type));
+
+        std::vector<const SemanticType*> params = {string_type, int_type};
+        auto* function = types.function(params, types.primitive(PrimitiveKind::Bool));
+        REQUIRE(TypeContext::param_types(function).size() == 2);
+        REQUIRE(TypeContext::param_types(function)[0] == string_type);
+        REQUIRE(TypeContext::return_type(function) == types.primitive(PrimitiveKind::Bool));
+
+        auto* tuple = types.tuple(params);
+        REQUIRE(TypeContext::element_types(tuple).size() == 2);
+        REQUIRE(TypeContext::element_types(tuple)[1] == int_type);
+    }
+
+    SECTION("each shape is allocated once") {
+        size_t before = types.size();
+        for (int i = 0; i < 100; ++i) {
+            types.list(types.list(int_type));
+        }
+        REQUIRE(types.size() == before + 2);
+    }
+
+    SECTION("compatibility matches types_compatible") {
+        REQUIRE(TypeContext::compatible(int_type, types.primitive(PrimitiveKind::Int)));
+        REQUIRE(!TypeContext::compatible(int_type, string_type));
+
+        // Unknown equals nothing, not even itself
+        auto* unknown_list = types.list(types.unknown());
+        REQUIRE(!TypeContext::compatible(types.unknown(), types.unknown()));
+        REQUIRE(!TypeContext::compatible(unknown_list, unknown_list));
+        REQUIRE(!unknown_list->equals(*unknown_list));
+    }
+
+    SECTION("unification matches unify_types") {
+        REQUIRE(types.unify(int_type, int_type) == int_type);
+        REQUIRE(types.unify(int_type, string_type) == nullptr);
+        REQUIRE(types.unify(types.type_variable("'a"), int_type) == int_type);
+        REQUIRE(types.unify(int_type, types.type_variable("'a")) == int_type);
+        REQUIRE(types.unify(types.unknown(), int_type) == types.unknown());
+    }
+}
+
 // ===== Type Environment Tests =====
 
 TEST_CASE("Type System: Type environment", "[type_system]") {
@@ -0,0 +1,199 @@
+// Support both system Catch2 and amalgamated version
+#if __has_include(<catch2/catch_test_macros.hpp>)
+    #include <catch2/catch_test_macros.hpp>
+#else
+    #include "catch_amalgamated.hpp"
+#endif
+
+#include <lucid/backend/vm_pool.hpp>
+#include <lucid/backend/compiler.hpp>
+#include <fmt/format.h>
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "test_support.hpp"
+
+using namespace lucid::backend;
+using namespace lucid;
+using namespace lucid::test;
+
+namespace {
+
+// String constants and method calls, so concurrent VMs would race on
+// refcounts and method caches if they shared any
+const std::string kRules = R"(
+function label(n: Int) returns String {
+    let padded = "  odd  "
+    return if n % 2 == 0 { "even".to_upper() } else { padded.trim() }
+}
+
+function score(n: Int) returns Int {
+    return label(n).length() + [n, n + 1].map(lambda x: x * 2).sum()
+}
+)";
+
+auto compile_shared(const std::string& source) -> std::shared_ptr<const Bytecode> {
+    return std::make_shared<const Bytecode>(compile_source(source));
+}
+
+} // namespace
+
+TEST_CASE("VM: call runs the loaded program", "[vm_pool]") {
+    VM vm;
+    REQUIRE_THROWS_WITH(vm.call("score", {Value(int64_t{1})}), "No program loaded");
+
+    auto program = compile_shared(kRules);
+    vm.load(program);
+    program.reset();  // The VM keeps it alive
+
+    REQUIRE(vm.call("label", {Value(int64_t{4})}).as_string() == "EVEN");
+    REQUIRE(vm.call("score", {Value(int64_t{3})}).as_int() == 3 + 14);
+    REQUIRE_THROWS_WITH(vm.call("missing", {}), "Function 'missing' not found");
+
+    // call_function on another program in between does not disturb it
+    auto other = compile_shared("function one() returns Int { return 1 }");
+    REQUIRE(vm.call_function(*other, "one", {}).as_int() == 1);
+    REQUIRE(vm.call("label", {Value(int64_t{5})}).as_string() == "odd");
+}
+
+TEST_CASE("VMPool: Threads share one program", "[vm_pool]") {
+    auto program = compile_shared(kRules);
+    VMPool pool(program, 4);
+    REQUIRE(pool.size() == 4);
+
+    constexpr int kThreads = 8;  // More threads than VMs: some wait for a lease
+    constexpr int kCalls = 2000;
+    std::atomic<int> mismatches{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&pool, &mismatches, t] {
+            auto vm = pool.acquire();
+            for (int i = 0; i < kCalls; ++i) {
+                int64_t n = t * kCalls + i;
+                int64_t expected = (n % 2 == 0 ? 4 : 3) + 4 * n + 2;
+                if (vm->call("score", {Value(n)}).as_int() != expected) {
+                    ++mismatches;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    REQUIRE(mismatches == 0);
+}
+
+TEST_CASE("VMPool: Leases return their VM", "[vm_pool]") {
+    VMPool pool(compile_shared(kRules), 1);
+    {
+        auto first = pool.acquire();
+        auto moved = std::move(first);
+        REQUIRE(moved->call("label", {Value(int64_t{0})}).as_string() == "EVEN");
+    }
+    auto again = pool.acquire();  // Would block forever if the VM was lost
+    REQUIRE(again->call("label", {Value(int64_t{1})}).as_string() == "odd");
+}
+
+TEST_CASE("Value: deep_copy shares no heap objects", "[vm_pool]") {
+    Value text(std::string(64, 'x'));
+    Value list(std::vector<Value>{text, Value(int64_t{1})});
+    Value closure = Value::make_closure(3, "f", {list});
+
+    Value copy = closure.deep_copy();
+    REQUIRE(copy == closure);
+    REQUIRE(text.is_unique() == false);  // Still referenced by list only
+    REQUIRE(copy.as_captures()[0].as_list()[0] == text);
+    REQUIRE(closure.is_unique());
+    REQUIRE(copy.is_unique());
+
+    // Unique at the top, but the string inside is shared with `text`
+    REQUIRE(closure.shares_heap());
+    REQUIRE_FALSE(copy.shares_heap());
+}
+
+TEST_CASE("VM: Results never share the VM's constants", "[vm_pool]") {
+    VM vm;
+    vm.load(compile_shared(R"(
+        function banner() returns List[String] {
+            return ["a constant too long to be stored inline"]
+        }
+    )"));
+    auto first = vm.call("banner", {});
+    auto second = vm.call("banner", {});
+    REQUIRE(first == second);
+    REQUIRE_FALSE(first.shares_heap());
+    REQUIRE_FALSE(second.shares_heap());
+}
+
+// ===== Batches =====
+
+TEST_CASE("VM: call_batch matches one call per argument set", "[vm_pool][batch]") {
+    VM vm;
+    vm.load(compile_shared(kRules));
+    auto score = vm.function("score");
+    REQUIRE(score.param_count == 1);
+
+    std::vector<Value> args;
+    for (int64_t n = 0; n < 500; ++n) {
+        args.emplace_back(n);
+    }
+    auto results = vm.call_batch(score, args);
+    REQUIRE(results.size() == 500);
+    for (size_t i = 0; i < args.size(); ++i) {
+        REQUIRE(results[i] == vm.call(score, std::span(&args[i], 1)));
+    }
+
+    REQUIRE(vm.call_batch(score, {}).empty());
+    REQUIRE_THROWS_WITH(vm.call(score, {}), "Function 'score' expects 1 arguments, got 0");
+    REQUIRE_THROWS_WITH(vm.function("missing"), "Function 'missing' not found");
+
+    auto other = compile_shared("function one() returns Int { return 1 }");
+    REQUIRE_THROWS_WITH(vm.call(VM::function(*other, "one"), {}),
+                        "Function handle does not belong to the loaded program");
+}
+
+TEST_CASE("VM: call_batch stops at the first error", "[vm_pool][batch]") {
+    VM vm;
+    vm.load(compile_shared(R"(
+        function inverse(n: Int) returns Int {
+            return 100 / n
+        }
+    )"));
+    auto inverse = vm.function("inverse");
+
+    std::vector<Value> args{Value(int64_t{1}), Value(int64_t{0}), Value(int64_t{2})};
+    REQUIRE_THROWS_WITH(vm.call_batch(inverse, args), "Division by zero");
+    // The VM starts clean afterwards
+    REQUIRE(vm.call(inverse, std::span(&args[2], 1)).as_int() == 50);
+}
+
+TEST_CASE("VMPool: call_batch spreads the sets over threads", "[vm_pool][batch]") {
+    VMPool pool(compile_shared(R"(
+        function tag(name: String, n: Int) returns String {
+            return if n % 3 == 0 { name.to_upper() } else { name }
+        }
+    )"), 3);
+    auto tag = pool.function("tag");
+
+    // Heap strings, so the workers must copy rather than share them
+    std::vector<Value> args;
+    for (int64_t n = 0; n < 3000; ++n) {
+        args.emplace_back(fmt::format("a fairly long rule name {}", n % 10));
+        args.emplace_back(n);
+    }
+    ThreadPool threads(4);
+    auto results = pool.call_batch(tag, args, threads);
+
+    REQUIRE(results.size() == 3000);
+    for (size_t n = 0; n < results.size(); ++n) {
+        auto expected = fmt::format("a fairly long rule name {}", n % 10);
+        if (n % 3 == 0) {
+            expected = fmt::format("A FAIRLY LONG RULE NAME {}", n % 10);
+        }
+        REQUIRE(results[n].as_string() == expected);
+    }
+}
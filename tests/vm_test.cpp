@@ -7,14 +7,20 @@
 
 #include <lucid/backend/vm.hpp>
 #include <lucid/backend/bytecode.hpp>
+#include <lucid/backend/builtin_methods.hpp>
 #include <lucid/backend/compiler.hpp>
 #include <lucid/frontend/parser.hpp>
 #include <lucid/frontend/lexer.hpp>
 #include <lucid/semantic/type_checker.hpp>
 #include <fmt/format.h>
+#include <limits>
+#include <sstream>
+
+#include "test_support.hpp"
 
 using namespace lucid::backend;
 using namespace lucid;
+using namespace lucid::test;
 
 // Helper to compile a simple expression to bytecode
 auto compile_expression(const std::string& expr_source, const std::string& return_type = "Int") -> Bytecode {
@@ -26,7 +32,7 @@ auto compile_expression(const std::string& expr_source, const std::string& retur
     )", return_type, expr_source);
 
     Lexer lexer(source, "test");
-    Parser parser(lexer.tokenize());
+    Parser parser(lexer);
     auto parse_result = parser.parse();
 
     if (!parse_result.is_ok()) {
@@ -117,6 +123,21 @@ TEST_CASE("VM: Arithmetic - Modulo", "[vm][day1][arithmetic]") {
     REQUIRE(result.as_int() == 1);
 }
 
+TEST_CASE("VM: Arithmetic - Int overflow wraps", "[vm][day1][arithmetic]") {
+    std::ostringstream output;
+    VM vm;
+    vm.set_output_stream(output);
+    REQUIRE(vm.call_function(compile_source(kIntEdgeCases), "main", {}).as_int() == -7);
+    REQUIRE(output.str() == kIntEdgeOutput);
+
+    // The generic helpers behind ADD, DIV and MOD agree with the typed opcodes
+    Value min(std::numeric_limits<int64_t>::min());
+    REQUIRE(VM::binary_add(Value(std::numeric_limits<int64_t>::max()), Value(int64_t{1})) == min);
+    REQUIRE(VM::binary_div(min, Value(int64_t{-1})) == min);
+    REQUIRE(VM::binary_mod(min, Value(int64_t{-1})).as_int() == 0);
+    REQUIRE(VM::unary_negate(min) == min);
+}
+
 TEST_CASE("VM: Arithmetic - Power", "[vm][day1][arithmetic]") {
     auto result = execute_expression("2 ** 8");
     REQUIRE(result.is_int());
@@ -282,9 +303,9 @@ TEST_CASE("VM: Complex boolean expression", "[vm][day1]") {
 // ===== Day 2: Function Call Tests =====
 
 // Helper to compile and execute a full program
-auto execute_program(const std::string& source, const std::string& entry_func = "main") -> Value {
+auto compile_program(const std::string& source) -> Bytecode {
     Lexer lexer(source, "test");
-    Parser parser(lexer.tokenize());
+    Parser parser(lexer);
     auto parse_result = parser.parse();
 
     if (!parse_result.is_ok()) {
@@ -302,7 +323,11 @@ auto execute_program(const std::string& source, const std::string& entry_func =
     }
 
     Compiler compiler;
-    auto bytecode = compiler.compile(parse_result.program.value().get());
+    return compiler.compile(parse_result.program.value().get());
+}
+
+auto execute_program(const std::string& source, const std::string& entry_func = "main") -> Value {
+    auto bytecode = compile_program(source);
 
     VM vm;
     return vm.call_function(bytecode, entry_func, {});
@@ -410,6 +435,50 @@ TEST_CASE("VM: Multiple function calls in expression", "[vm][day2][functions]")
     REQUIRE(result.as_int() == 25);  // 9 + 16 = 25
 }
 
+TEST_CASE("VM: Callee locals do not leak into caller", "[vm][day2][functions]") {
+    auto result = execute_program(R"(
+        function f() returns Int {
+            let t = 5
+            return t
+        }
+
+        function main() returns Int {
+            return 1 + f()
+        }
+    )");
+
+    REQUIRE(result.is_int());
+    REQUIRE(result.as_int() == 6);
+}
+
+TEST_CASE("VM: Deep recursion reuses the value stack", "[vm][day2][functions]") {
+    auto result = execute_program(R"(
+        function count(n: Int, acc: Int) returns Int {
+            let next = acc + 1
+            return if n == 0 { acc } else { count(n - 1, next) }
+        }
+
+        function main() returns Int {
+            return count(5000, 0)
+        }
+    )");
+
+    REQUIRE(result.is_int());
+    REQUIRE(result.as_int() == 5000);
+}
+
+TEST_CASE("VM: Unbounded recursion reports overflow", "[vm][day2][functions]") {
+    REQUIRE_THROWS_AS(execute_program(R"(
+        function forever(n: Int) returns Int {
+            return 1 + forever(n + 1)  // Not a tail call, so frames pile up
+        }
+
+        function main() returns Int {
+            return forever(0)
+        }
+    )"), std::runtime_error);
+}
+
 // ===== Day 3: Control Flow Tests =====
 
 TEST_CASE("VM: If expression - true branch", "[vm][day3][control]") {
@@ -854,7 +923,7 @@ TEST_CASE("VM: Sum list elements", "[vm][integration]") {
 // Helper to execute program and capture output
 auto execute_with_output(const std::string& source) -> std::pair<Value, std::string> {
     Lexer lexer(source, "test");
-    Parser parser(lexer.tokenize());
+    Parser parser(lexer);
     auto parse_result = parser.parse();
 
     if (!parse_result.is_ok()) {
@@ -1023,6 +1092,55 @@ TEST_CASE("VM: println with function result", "[vm][phase6][print]") {
 
 // ===== String Methods Tests =====
 
+TEST_CASE("VM: String concatenation", "[vm][string]") {
+    auto result = execute_program(R"(
+        function main() returns String {
+            let greeting = "hello" + ", "
+            return greeting + "world" + ""
+        }
+    )");
+    REQUIRE(result.is_string());
+    REQUIRE(result.as_string() == "hello, world");
+}
+
+TEST_CASE("VM: Long strings built with + share their pieces", "[vm][string]") {
+    // 200000 appends: quadratic copying would be ~2e10 bytes
+    auto result = execute_program(R"(
+        function build(n: Int, acc: String) returns String {
+            if n == 0 { return acc }
+            return build(n - 1, acc + "ab")
+        }
+        function main() returns String {
+            return build(200000, "")
+        }
+    )");
+    REQUIRE(result.is_string());
+    REQUIRE(result.string_length() == 400000);
+    REQUIRE(result.shares_heap());
+
+    Value copy = result.deep_copy();
+    REQUIRE_FALSE(copy.shares_heap());
+    REQUIRE(copy == result);
+    REQUIRE(result.as_string().substr(0, 6) == "ababab");
+    REQUIRE_FALSE(result.shares_heap());  // Flat after the first read
+}
+
+TEST_CASE("VM: List.join", "[vm][string]") {
+    auto result = execute_program(R"(
+        function main() returns String {
+            return ["a", "bc", "d"].join(", ")
+        }
+    )");
+    REQUIRE(result.as_string() == "a, bc, d");
+
+    auto empty = execute_program(R"(
+        function main() returns String {
+            return ["x"].tail().join("-")
+        }
+    )");
+    REQUIRE(empty.as_string().empty());
+}
+
 TEST_CASE("VM: String.contains", "[vm][phase6][string]") {
     SECTION("Found") {
         auto result = execute_program(R"(
@@ -1192,6 +1310,41 @@ TEST_CASE("VM: List method chaining", "[vm][phase6][list]") {
     REQUIRE(result.as_int() == 4);  // [3, 2, 1, 0]
 }
 
+TEST_CASE("VM: List.append does not affect other bindings", "[vm][methods][list]") {
+    auto result = execute_program(R"(
+        function main() returns List[Int] {
+            let xs = [1, 2]
+            let ys = xs.append(3)
+            let zs = ys.concat([4]).reverse()
+            return [xs.length(), ys.length(), zs.length(), zs[0]]
+        }
+    )");
+
+    REQUIRE(result.is_list());
+    const auto& list = result.as_list();
+    REQUIRE(list.size() == 4);
+    REQUIRE(list[0].as_int() == 2);
+    REQUIRE(list[1].as_int() == 3);
+    REQUIRE(list[2].as_int() == 4);
+    REQUIRE(list[3].as_int() == 4);
+}
+
+TEST_CASE("VM: List.append on a temporary", "[vm][methods][list]") {
+    auto result = execute_program(R"(
+        function build(n: Int) returns List[Int] {
+            return if n == 0 { [0] } else { build(n - 1).append(n) }
+        }
+
+        function main() returns Int {
+            let xs = build(200)
+            return xs.length() + xs[200]
+        }
+    )");
+
+    REQUIRE(result.is_int());
+    REQUIRE(result.as_int() == 201 + 200);
+}
+
 // ===== Numeric Methods Tests =====
 
 TEST_CASE("VM: Int.to_string", "[vm][phase6][numeric]") {
@@ -1434,3 +1587,482 @@ TEST_CASE("VM: File I/O integration - read and write", "[vm][phase7][fileio]") {
     delete_test_file(src_path);
     delete_test_file(dst_path);
 }
+
+// ===== Dispatch Tests =====
+
+TEST_CASE("VM: Switch and threaded dispatch agree", "[vm][dispatch]") {
+    auto bytecode = compile_program(R"(
+        function fib(n: Int) returns Int {
+            return if n <= 1 { n } else { fib(n - 1) + fib(n - 2) }
+        }
+
+        function main() returns Int {
+            let xs = [fib(10), fib(12)]
+            return xs[0] * 1000 + xs.length() + fib(15) % 7
+        }
+    )");
+
+    VM switch_vm;
+    switch_vm.set_dispatch_mode(DispatchMode::Switch);
+    auto expected = switch_vm.call_function(bytecode, "main", {});
+    REQUIRE(expected.as_int() == 55 * 1000 + 2 + 610 % 7);
+
+    if (VM::threaded_dispatch_available()) {
+        VM threaded_vm;
+        threaded_vm.set_dispatch_mode(DispatchMode::Threaded);
+        REQUIRE(threaded_vm.call_function(bytecode, "main", {}) == expected);
+        REQUIRE(threaded_vm.instructions_executed() == switch_vm.instructions_executed());
+    } else {
+        REQUIRE_THROWS(switch_vm.set_dispatch_mode(DispatchMode::Threaded));
+    }
+}
+
+TEST_CASE("VM: Instruction counter", "[vm][dispatch]") {
+    auto bytecode = compile_expression("1 + 2");
+
+    VM vm;
+    REQUIRE(vm.instructions_executed() == 0);
+    vm.call_function(bytecode, "test", {});
+    // CONSTANT, CONSTANT, ADD, RETURN
+    REQUIRE(vm.instructions_executed() == 4);
+
+    vm.reset_instruction_count();
+    REQUIRE(vm.instructions_executed() == 0);
+}
+
+// ===== Method Dispatch Tests =====
+
+namespace {
+
+// Build `function test() returns ... { <receiver>.<method>() }` by hand, so the
+// VM sees method calls the type checker would have rejected
+auto method_call_bytecode(Value receiver, const std::string& method) -> Bytecode {
+    Bytecode bc;
+    uint16_t receiver_idx = bc.add_constant(std::move(receiver));
+    uint16_t name_idx = bc.add_constant(Value(method));
+    bc.add_function("test", 0, 0, 0);
+    bc.emit(OpCode::CONSTANT, receiver_idx);
+    bc.emit(OpCode::CALL_METHOD, name_idx, uint8_t{0});
+    bc.emit(OpCode::RETURN);
+    return bc;
+}
+
+} // namespace
+
+TEST_CASE("VM: Method names map to ids and back", "[vm][methods]") {
+    for (size_t i = 0; i < kMethodCount; ++i) {
+        auto id = static_cast<MethodId>(i);
+        auto resolved = method_id_from_name(method_name(id));
+        REQUIRE(resolved.has_value());
+        REQUIRE(*resolved == id);
+    }
+    REQUIRE_FALSE(method_id_from_name("frobnicate").has_value());
+}
+
+TEST_CASE("VM: Method table is indexed by receiver type", "[vm][methods]") {
+    REQUIRE(lookup_method(ValueType::List, MethodId::LENGTH) != nullptr);
+    REQUIRE(lookup_method(ValueType::String, MethodId::LENGTH) != nullptr);
+    REQUIRE(lookup_method(ValueType::Tuple, MethodId::LENGTH) != nullptr);
+    REQUIRE(lookup_method(ValueType::Int, MethodId::LENGTH) == nullptr);
+    REQUIRE(lookup_method(ValueType::Float, MethodId::FLOOR) != nullptr);
+    REQUIRE(lookup_method(ValueType::Int, MethodId::FLOOR) == nullptr);
+    for (size_t i = 0; i < kMethodCount; ++i) {
+        REQUIRE(lookup_method(ValueType::Bool, static_cast<MethodId>(i)) == nullptr);
+    }
+}
+
+TEST_CASE("VM: One method name dispatches on each receiver type", "[vm][methods]") {
+    auto bytecode = compile_program(R"(
+        function test() returns Int {
+            let s = "hello"
+            let xs = [1, 2, 3]
+            return s.length() * 10 + xs.length()
+        }
+    )");
+
+    VM vm;
+    REQUIRE(vm.call_function(bytecode, "test", {}).as_int() == 53);
+    // The resolved ids are reused on a second run
+    REQUIRE(vm.call_function(bytecode, "test", {}).as_int() == 53);
+}
+
+TEST_CASE("VM: Unknown methods report the receiver type", "[vm][methods]") {
+    VM vm;
+
+    auto unknown = method_call_bytecode(Value(std::vector<Value>{Value(int64_t{1})}), "frobnicate");
+    REQUIRE_THROWS_WITH(vm.call_function(unknown, "test", {}),
+                        "Unknown method 'frobnicate' on List");
+
+    auto wrong_type = method_call_bytecode(Value(int64_t{5}), "length");
+    REQUIRE_THROWS_WITH(vm.call_function(wrong_type, "test", {}),
+                        "Unknown method 'length' on Int");
+
+    auto no_methods = method_call_bytecode(Value(true), "length");
+    REQUIRE_THROWS_WITH(vm.call_function(no_methods, "test", {}),
+                        "Cannot call method 'length' on Bool");
+}
+
+// ===== Specialised Opcode Tests =====
+
+namespace {
+
+// `function test() returns ... { <a> <op> <b> }`, bypassing the type checker
+auto binary_op_bytecode(Value a, Value b, OpCode op) -> Bytecode {
+    Bytecode bc;
+    uint16_t a_idx = bc.add_constant(std::move(a));
+    uint16_t b_idx = bc.add_constant(std::move(b));
+    bc.add_function("test", 0, 0, 0);
+    bc.emit(OpCode::CONSTANT, a_idx);
+    bc.emit(OpCode::CONSTANT, b_idx);
+    bc.emit(op);
+    bc.emit(OpCode::RETURN);
+    return bc;
+}
+
+} // namespace
+
+TEST_CASE("VM: Statically typed arithmetic uses specialised opcodes", "[vm][specialised]") {
+    auto bytecode = compile_program(R"(
+        function fib(n: Int) returns Int {
+            return if n <= 1 { n } else { fib(n - 1) + fib(n - 2) }
+        }
+
+        function scale(x: Float, y: Float) returns Float {
+            return if x < y { x * y } else { x - y / 2.0 }
+        }
+    )");
+
+    REQUIRE(count_opcode(bytecode, OpCode::LE_INT) == 1);
+    REQUIRE(count_opcode(bytecode, OpCode::SUB_INT) == 2);
+    REQUIRE(count_opcode(bytecode, OpCode::ADD_INT) == 1);
+    REQUIRE(count_opcode(bytecode, OpCode::LT_FLOAT) == 1);
+    REQUIRE(count_opcode(bytecode, OpCode::MUL_FLOAT) == 1);
+    REQUIRE(count_opcode(bytecode, OpCode::DIV_FLOAT) == 1);
+    REQUIRE(count_opcode(bytecode, OpCode::ADD) == 0);
+    REQUIRE(count_opcode(bytecode, OpCode::LE) == 0);
+
+    VM vm;
+    REQUIRE(vm.call_function(bytecode, "fib", {Value(int64_t{15})}).as_int() == 610);
+    REQUIRE(vm.call_function(bytecode, "scale", {Value(2.0), Value(3.0)}).as_float() == 6.0);
+    REQUIRE(vm.call_function(bytecode, "scale", {Value(5.0), Value(4.0)}).as_float() == 3.0);
+}
+
+TEST_CASE("VM: Mixed Int and Float operands keep the generic opcodes", "[vm][specialised]") {
+    auto bytecode = compile_program(R"(
+        function mix(n: Int, x: Float) returns Float {
+            return n * x + 0.5
+        }
+    )");
+
+    REQUIRE(count_opcode(bytecode, OpCode::MUL) == 1);
+    // The promoted product is a Float, so the addition is specialised again
+    REQUIRE(count_opcode(bytecode, OpCode::ADD_FLOAT) == 1);
+
+    VM vm;
+    REQUIRE(vm.call_function(bytecode, "mix", {Value(int64_t{3}), Value(1.5)}).as_float() == 5.0);
+}
+
+TEST_CASE("VM: Specialised opcodes fall back on unexpected operands", "[vm][specialised]") {
+    VM vm;
+
+    auto mixed = binary_op_bytecode(Value(int64_t{1}), Value(2.5), OpCode::ADD_INT);
+    REQUIRE(vm.call_function(mixed, "test", {}).as_float() == 3.5);
+
+    auto div_zero = binary_op_bytecode(Value(int64_t{1}), Value(int64_t{0}), OpCode::DIV_INT);
+    REQUIRE_THROWS_WITH(vm.call_function(div_zero, "test", {}), "Division by zero");
+
+    auto mod_zero = binary_op_bytecode(Value(int64_t{1}), Value(int64_t{0}), OpCode::MOD_INT);
+    REQUIRE_THROWS_WITH(vm.call_function(mod_zero, "test", {}), "Modulo by zero");
+
+    auto bad = binary_op_bytecode(Value(true), Value(1.0), OpCode::ADD_FLOAT);
+    REQUIRE_THROWS_WITH(vm.call_function(bad, "test", {}), "Cannot add Bool and Float");
+
+    auto lt = binary_op_bytecode(Value(std::string("a")), Value(std::string("b")), OpCode::LT_INT);
+    REQUIRE(vm.call_function(lt, "test", {}).as_bool());
+}
+
+// ===== Tail Call Tests =====
+
+TEST_CASE("VM: Tail-recursive loops run in constant stack space", "[vm][tailcall]") {
+    auto bytecode = compile_program(R"(
+        function sum_to(n: Int, acc: Int) returns Int {
+            return if n == 0 { acc } else { sum_to(n - 1, acc + n) }
+        }
+
+        function main() returns Int {
+            return sum_to(100000, 0)
+        }
+    )");
+
+    REQUIRE(count_opcode(bytecode, OpCode::TAIL_CALL) == 2);
+    REQUIRE(count_opcode(bytecode, OpCode::CALL) == 0);
+
+    // Deeper than kMaxCallDepth frames would allow
+    VM vm;
+    REQUIRE(vm.call_function(bytecode, "main", {}).as_int() == int64_t{100000} * 100001 / 2);
+}
+
+TEST_CASE("VM: Mutually recursive tail calls", "[vm][tailcall]") {
+    auto bytecode = compile_program(R"(
+        function is_even(n: Int) returns Bool {
+            return if n == 0 { true } else { is_odd(n - 1) }
+        }
+
+        function is_odd(n: Int) returns Bool {
+            let done = n == 0
+            return if done { false } else { is_even(n - 1) }
+        }
+    )");
+
+    VM switch_vm;
+    switch_vm.set_dispatch_mode(DispatchMode::Switch);
+    REQUIRE(switch_vm.call_function(bytecode, "is_even", {Value(int64_t{50001})}).as_bool() == false);
+    REQUIRE(switch_vm.call_function(bytecode, "is_odd", {Value(int64_t{50001})}).as_bool() == true);
+
+    if (VM::threaded_dispatch_available()) {
+        VM threaded_vm;
+        threaded_vm.set_dispatch_mode(DispatchMode::Threaded);
+        REQUIRE(threaded_vm.call_function(bytecode, "is_even", {Value(int64_t{50000})}).as_bool());
+    }
+}
+
+TEST_CASE("VM: Calls outside tail position still push frames", "[vm][tailcall]") {
+    auto bytecode = compile_program(R"(
+        function depth(n: Int) returns Int {
+            return if n == 0 { 0 } else { 1 + depth(n - 1) }
+        }
+    )");
+
+    REQUIRE(count_opcode(bytecode, OpCode::TAIL_CALL) == 0);
+    REQUIRE(count_opcode(bytecode, OpCode::CALL) == 1);
+
+    VM vm;
+    REQUIRE(vm.call_function(bytecode, "depth", {Value(int64_t{100})}).as_int() == 100);
+    REQUIRE_THROWS_WITH(vm.call_function(bytecode, "depth", {Value(int64_t{100000})}),
+                        "Call stack overflow");
+}
+
+// ===== Closures and List Callbacks =====
+
+TEST_CASE("VM: List.map, filter and fold with lambdas", "[vm][closures]") {
+    auto bytecode = compile_program(R"(
+        function squares(n: Int) returns List[Int] {
+            return [1, 2, 3, 4].map(lambda x: x * n)
+        }
+        function evens() returns List[Int] {
+            return [1, 2, 3, 4, 5, 6].filter(lambda x: x % 2 == 0)
+        }
+        function total() returns Int {
+            return [1, 2, 3, 4].fold(10, lambda acc, x: acc + x)
+        }
+    )");
+
+    REQUIRE(count_opcode(bytecode, OpCode::MAKE_CLOSURE) == 3);
+
+    VM vm;
+    auto scaled = vm.call_function(bytecode, "squares", {Value(int64_t{3})});
+    REQUIRE(scaled.as_list().size() == 4);
+    REQUIRE(scaled.as_list()[3].as_int() == 12);
+
+    auto evens = vm.call_function(bytecode, "evens", {});
+    REQUIRE(evens.as_list().size() == 3);
+    REQUIRE(evens.as_list()[0].as_int() == 2);
+    REQUIRE(evens.as_list()[2].as_int() == 6);
+
+    REQUIRE(vm.call_function(bytecode, "total", {}).as_int() == 20);
+
+    if (VM::jit_available()) {
+        // The callbacks are compiled once hot and then called natively
+        VM jit_vm;
+        jit_vm.set_jit_threshold(1);
+        REQUIRE(jit_vm.call_function(bytecode, "total", {}).as_int() == 20);
+        REQUIRE(jit_vm.call_function(bytecode, "squares", {Value(int64_t{2})}).as_list()[1].as_int() == 4);
+    }
+}
+
+TEST_CASE("VM: List.sum keeps the element type", "[vm][closures]") {
+    auto bytecode = compile_program(R"(
+        function ints() returns Int {
+            return [1, 2, 3].sum()
+        }
+        function floats() returns Float {
+            return [0.5, 1.5, 2.0].sum()
+        }
+        function empty(xs: List[Float]) returns Float {
+            return xs.sum()
+        }
+    )");
+
+    VM vm;
+    REQUIRE(vm.call_function(bytecode, "ints", {}).as_int() == 6);
+    REQUIRE(vm.call_function(bytecode, "floats", {}).as_float() == 4.0);
+
+    auto zero = vm.call_function(bytecode, "empty", {Value(std::vector<Value>{}, false)});
+    REQUIRE(zero.is_float());
+    REQUIRE(zero.as_float() == 0.0);
+}
+
+TEST_CASE("VM: Functions are values", "[vm][closures]") {
+    auto bytecode = compile_program(R"(
+        function square(x: Int) returns Int {
+            return x * x
+        }
+        function apply_twice() returns Int {
+            let f = square
+            return f(f(3))
+        }
+        function squares() returns List[Int] {
+            return [1, 2, 3].map(square)
+        }
+    )");
+
+    VM vm;
+    REQUIRE(vm.call_function(bytecode, "apply_twice", {}).as_int() == 81);
+    auto squares = vm.call_function(bytecode, "squares", {});
+    REQUIRE(squares.as_list()[2].as_int() == 9);
+}
+
+TEST_CASE("VM: Nested lambdas capture by value", "[vm][closures]") {
+    auto bytecode = compile_program(R"(
+        function pairs(n: Int) returns Int {
+            let offset = 100
+            return [1, 2].fold(0, lambda acc, x: acc + [10, 20].map(lambda y: x * y + offset + n).sum())
+        }
+    )");
+
+    REQUIRE(count_opcode(bytecode, OpCode::MAKE_CLOSURE) == 2);
+
+    // x=1: 110+n + 120+n, x=2: 120+n + 140+n
+    VM vm;
+    REQUIRE(vm.call_function(bytecode, "pairs", {Value(int64_t{1})}).as_int() == 494);
+
+    VM switch_vm;
+    switch_vm.set_dispatch_mode(DispatchMode::Switch);
+    REQUIRE(switch_vm.call_function(bytecode, "pairs", {Value(int64_t{1})}).as_int() == 494);
+}
+
+TEST_CASE("VM: A block's let shadows only inside the block", "[vm][closures]") {
+    auto result = execute_program(R"(
+        function main() returns Int {
+            let x = 1
+            let c = true
+            let y = if c { let x = 20
+                           x + 1 } else { 0 }
+            let shifted = [y, x].map(lambda k: k * 100 + x)
+            return shifted[0] + shifted[1] + x
+        }
+    )");
+
+    // 2101 + 101 + 1; the block's x is a local of its own
+    REQUIRE(result.as_int() == 2203);
+}
+
+TEST_CASE("VM: Callback errors", "[vm][closures]") {
+    auto bytecode = compile_program(R"(
+        function divide(d: Int) returns List[Int] {
+            return [1, 2].map(lambda x: x / d)
+        }
+    )");
+
+    VM vm;
+    REQUIRE_THROWS_WITH(vm.call_function(bytecode, "divide", {Value(int64_t{0})}),
+                        "Division by zero");
+    // The VM is usable after an exception unwinds a callback
+    REQUIRE(vm.call_function(bytecode, "divide", {Value(int64_t{1})}).as_list().size() == 2);
+}
+
+// ===== Parallel List Methods =====
+
+namespace {
+
+auto int_list(int64_t count) -> Value {
+    std::vector<Value> elements;
+    for (int64_t i = 1; i <= count; ++i) {
+        elements.emplace_back(i);
+    }
+    return Value(std::move(elements), false);
+}
+
+} // namespace
+
+TEST_CASE("VM: par_map, par_filter and par_reduce match the sequential methods", "[vm][closures][parallel]") {
+    auto bytecode = compile_program(R"(
+        function scaled(xs: List[Int], n: Int) returns List[Int] {
+            return xs.par_map(lambda x: x * n)
+        }
+        function evens(xs: List[Int]) returns List[Int] {
+            return xs.par_filter(lambda x: x % 2 == 0)
+        }
+        function total(xs: List[Int]) returns Int {
+            return xs.par_reduce(lambda a, b: a + b)
+        }
+        function labels(xs: List[Int]) returns List[String] {
+            return xs.par_map(lambda x: x.to_string())
+        }
+    )");
+
+    VM vm;
+    vm.set_parallelism(16, 4);
+    REQUIRE(vm.parallel_threshold() == 16);
+
+    // 1000 elements run in shares; 10 stay below the threshold
+    for (int64_t count : {int64_t{10}, int64_t{1000}}) {
+        auto xs = int_list(count);
+
+        auto mapped = vm.call_function(bytecode, "scaled", {xs, Value(int64_t{3})});
+        REQUIRE(mapped.as_list().size() == static_cast<size_t>(count));
+        for (size_t i = 0; i < mapped.as_list().size(); ++i) {
+            REQUIRE(mapped.as_list()[i].as_int() == static_cast<int64_t>(i + 1) * 3);
+        }
+
+        auto kept = vm.call_function(bytecode, "evens", {xs});
+        REQUIRE(kept.as_list().size() == static_cast<size_t>(count / 2));
+        REQUIRE(kept.as_list()[0].as_int() == 2);
+        REQUIRE(kept.as_list()[kept.as_list().size() - 1].as_int() == count);
+
+        REQUIRE(vm.call_function(bytecode, "total", {xs}).as_int() == count * (count + 1) / 2);
+
+        auto strings = vm.call_function(bytecode, "labels", {xs});
+        REQUIRE(strings.as_list()[static_cast<size_t>(count - 1)].as_string() == std::to_string(count));
+    }
+}
+
+TEST_CASE("VM: par_reduce of an empty list", "[vm][closures][parallel]") {
+    auto bytecode = compile_program(R"(
+        function total(xs: List[Int]) returns Int {
+            return xs.par_reduce(lambda a, b: a + b)
+        }
+    )");
+
+    VM vm;
+    REQUIRE_THROWS_WITH(vm.call_function(bytecode, "total", {Value(std::vector<Value>{}, false)}),
+                        "List.par_reduce() of an empty list");
+    REQUIRE(vm.call_function(bytecode, "total", {int_list(1)}).as_int() == 1);
+}
+
+TEST_CASE("VM: Parallel callbacks print in list order and report errors", "[vm][closures][parallel]") {
+    auto bytecode = compile_program(R"(
+        function show(x: Int) returns Int {
+            println(x)
+            return 10 / (x - 77)
+        }
+        function shown(xs: List[Int]) returns Int {
+            return xs.par_map(show).length()
+        }
+    )");
+
+    VM vm;
+    vm.use_output_buffer();
+    vm.set_parallelism(8, 4);
+
+    REQUIRE(vm.call_function(bytecode, "shown", {int_list(64)}).as_int() == 64);
+    std::string expected;
+    for (int i = 1; i <= 64; ++i) {
+        expected += std::to_string(i) + "\n";
+    }
+    REQUIRE(vm.get_output() == expected);
+
+    // A failing callback on a worker surfaces in the caller, which stays usable
+    REQUIRE_THROWS_WITH(vm.call_function(bytecode, "shown", {int_list(100)}), "Division by zero");
+    REQUIRE(vm.call_function(bytecode, "shown", {int_list(20)}).as_int() == 20);
+}